@@ -1,19 +1,25 @@
 #include "Application.h"
 
 #include <QFile>
-#include <QTextStream>
-#include <QStyle>
-#include <QWidget>
+#include <QTimer>
 
+#include "core/trace/Trace.h"
 #include "ui/window/MainWindow.h"
 
 Application::Application(int &argc, char **argv)
-    : QApplication(argc, argv), m_mainWindow(std::make_unique<MainWindow>()), m_currentTheme(QStringLiteral("light")) {
+    : QApplication(argc, argv), m_currentTheme(QStringLiteral("light")) {
+  m_startupTimer.start();
+  // Lets startup itself be traced; the Help menu covers everything later.
+  if (qEnvironmentVariableIsSet("KAFKA_VIEWER_TRACE"))
+    kafka::Trace::setEnabled(true);
+  m_mainWindow = std::make_unique<MainWindow>();
   setApplicationName(QStringLiteral("kafka-viewer"));
   setApplicationDisplayName(QStringLiteral("Kafka Viewer"));
   setOrganizationName(QStringLiteral("Kafka Viewer"));
-  
-  // Load default theme
+  // Settings and cache paths depend on the names above.
+  m_mainWindow->restoreSession();
+
+  // Load default theme; before the first show, so widgets polish once.
   loadTheme(m_currentTheme);
 }
 
@@ -21,48 +27,49 @@ Application::~Application() = default;
 
 int Application::run() {
   m_mainWindow->show();
+  // Queued behind the show and polish events, so it runs once the window
+  // has been laid out and handed to the window system.
+  QTimer::singleShot(0, this, [this]() { m_metrics.startupMs = m_startupTimer.elapsed(); });
   return exec();
 }
 
-void Application::loadTheme(const QString &themeName) {
-  // Always reload theme to ensure stylesheet is reapplied
-  // (even if themeName is the same, we need to force reapply)
-  m_currentTheme = themeName;
+const QString &Application::themeStyleSheet(const QString &themeName) {
+  auto it = m_themeStyleSheets.find(themeName);
+  if (it != m_themeStyleSheets.end())
+    return it.value();
 
-  // Clear existing stylesheet first to force reapply
-  setStyleSheet(QString());
-
-  // Load base app stylesheet
   QString combinedStylesheet;
   QFile appFile(QStringLiteral(":/styles/app.qss"));
-  if (appFile.open(QFile::ReadOnly | QFile::Text)) {
-    QTextStream appStream(&appFile);
-    combinedStylesheet += appStream.readAll();
-    combinedStylesheet += QStringLiteral("\n");
-    appFile.close();
+  if (appFile.open(QFile::ReadOnly)) {
+    combinedStylesheet += QString::fromUtf8(appFile.readAll());
+    combinedStylesheet += QLatin1Char('\n');
   }
+  QFile themeFile(QStringLiteral(":/themes/%1.qss").arg(themeName));
+  if (themeFile.open(QFile::ReadOnly))
+    combinedStylesheet += QString::fromUtf8(themeFile.readAll());
+  return m_themeStyleSheets.insert(themeName, combinedStylesheet).value();
+}
 
-  // Load theme stylesheet
-  const QString themePath = QStringLiteral(":/themes/%1.qss").arg(themeName);
-  QFile themeFile(themePath);
-  if (themeFile.open(QFile::ReadOnly | QFile::Text)) {
-    QTextStream themeStream(&themeFile);
-    combinedStylesheet += themeStream.readAll();
-    themeFile.close();
-  }
+// Setting the application stylesheet repolishes every widget by itself,
+// so there is nothing to clear first and nothing to polish afterwards.
+void Application::loadTheme(const QString &themeName) {
+  m_currentTheme = themeName;
+  if (m_appliedTheme == themeName)
+    return;
 
-  // Apply combined stylesheet
-  setStyleSheet(combinedStylesheet);
-  
-  // Force style update on all top-level widgets
-  // This ensures stylesheet changes are properly applied
-  for (QWidget *widget : allWidgets()) {
-    if (widget && widget->isWindow()) {
-      widget->style()->unpolish(widget);
-      widget->style()->polish(widget);
-      widget->update();
-    }
-  }
+  QElapsedTimer timer;
+  timer.start();
+  setStyleSheet(themeStyleSheet(themeName));
+  m_appliedTheme = themeName;
+
+  m_metrics.lastThemeSwitchMs = timer.elapsed();
+  m_metrics.slowestThemeSwitchMs =
+      qMax(m_metrics.slowestThemeSwitchMs, m_metrics.lastThemeSwitchMs);
+  ++m_metrics.themeSwitchCount;
+  if (m_metrics.lastThemeSwitchMs > kThemeSwitchBudgetMs)
+    qWarning("Theme %s took %lld ms to apply (budget %lld ms)", qPrintable(themeName),
+             static_cast<long long>(m_metrics.lastThemeSwitchMs),
+             static_cast<long long>(kThemeSwitchBudgetMs));
 }
 
 void Application::onThemeChanged(const QString &themeName) {
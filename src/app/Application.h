@@ -1,10 +1,25 @@
 #pragma once
 
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QHash>
 #include <memory>
 
 class MainWindow;
 
+/**
+ * @brief Startup and theme timings, measured by Application.
+ */
+struct UiMetrics {
+  /** From the end of QApplication setup to the first event loop turn with
+   *  the main window shown; -1 until then. */
+  qint64 startupMs = -1;
+  /** Time spent in the last and the slowest loadTheme(); -1 before any. */
+  qint64 lastThemeSwitchMs = -1;
+  qint64 slowestThemeSwitchMs = -1;
+  int themeSwitchCount = 0;
+};
+
 /**
  * @brief Thin wrapper around QApplication that owns the main window.
  */
@@ -12,6 +27,9 @@ class Application final : public QApplication {
   Q_OBJECT
 
 public:
+  /** Theme switches slower than this are reported with qWarning(). */
+  static constexpr qint64 kThemeSwitchBudgetMs = 50;
+
   Application(int &argc, char **argv);
   ~Application();
 
@@ -22,6 +40,10 @@ public:
 
   /**
    * @brief Loads and applies a theme.
+   *
+   * The theme's stylesheet, app.qss followed by the theme file, is read
+   * from the resources once and kept; switching back to a theme costs one
+   * setStyleSheet(). Applying the theme already in use does nothing.
    * @param themeName Theme name: "light" or "dark"
    */
   void loadTheme(const QString &themeName);
@@ -32,10 +54,18 @@ public:
    */
   QString currentTheme() const { return m_currentTheme; }
 
+  const UiMetrics &metrics() const { return m_metrics; }
+
 public slots:
   void onThemeChanged(const QString &themeName);
 
 private:
+  const QString &themeStyleSheet(const QString &themeName);
+
+  QElapsedTimer m_startupTimer;
   std::unique_ptr<MainWindow> m_mainWindow;
   QString m_currentTheme;
+  QString m_appliedTheme;
+  QHash<QString, QString> m_themeStyleSheets;
+  UiMetrics m_metrics;
 };
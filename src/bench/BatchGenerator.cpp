@@ -0,0 +1,95 @@
+#include "bench/BatchGenerator.h"
+
+#include <cstdio>
+#include <vector>
+
+#include "core/codec/Compressor.h"
+
+namespace kafka {
+
+namespace {
+constexpr qint64 kFirstTimestamp = 1700000000000;
+constexpr int kKeyspace = 1000;
+constexpr int kErrorEvery = 10;
+constexpr char kAlphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+} // namespace
+
+BatchGenerator::BatchGenerator(const GeneratorOptions &options)
+    : m_options(options), m_state(options.seed) {}
+
+// splitmix64: tiny, fast and identical everywhere, unlike std:: engines
+// whose distributions differ between standard libraries.
+quint64 BatchGenerator::nextRandom() {
+  quint64 z = (m_state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+void BatchGenerator::fill(std::string *out, std::size_t size) {
+  for (std::size_t i = 0; i < size; ++i)
+    out->push_back(kAlphabet[nextRandom() % (sizeof(kAlphabet) - 1)]);
+}
+
+std::string BatchGenerator::makeValue(qint64 offset) {
+  char prefix[96];
+  const int length = std::snprintf(
+      prefix, sizeof(prefix), R"({"id":%lld,"user":"user-%03d","status":"%s","payload":")",
+      static_cast<long long>(offset), static_cast<int>(nextRandom() % kKeyspace),
+      offset % kErrorEvery == 0 ? "error" : "ok");
+  std::string value(prefix, static_cast<std::size_t>(length));
+  const std::size_t wanted = static_cast<std::size_t>(qMax(0, m_options.valueBytes));
+  const std::size_t closing = 2;
+  fill(&value, wanted > value.size() + closing ? wanted - value.size() - closing : 0);
+  value += "\"}";
+  return value;
+}
+
+bool BatchGenerator::generate(qint64 baseOffset, int batchCount, std::string *output,
+                              QString *error) {
+  const auto keyBytes = static_cast<std::size_t>(qMax(0, m_options.keyBytes));
+  const auto headerBytes = static_cast<std::size_t>(qMax(0, m_options.headerValueBytes));
+  qint64 offset = baseOffset;
+  std::string key;
+  std::vector<std::string> headerValues(static_cast<std::size_t>(qMax(0, m_options.headerCount)));
+  for (int b = 0; b < batchCount; ++b) {
+    RecordBatchBuilder builder(offset);
+    for (int r = 0; r < m_options.recordsPerBatch; ++r, ++offset) {
+      char prefix[32];
+      const int length = std::snprintf(prefix, sizeof(prefix), "key-%06d",
+                                       static_cast<int>(nextRandom() % kKeyspace));
+      key.assign(prefix, static_cast<std::size_t>(length));
+      key.resize(keyBytes, '_');
+      const std::string value = makeValue(offset);
+
+      // append() copies, so the views only have to live until it returns.
+      RecordData record;
+      record.timestamp = kFirstTimestamp + offset;
+      record.key = key;
+      record.value = value;
+      for (std::string &headerValue : headerValues) {
+        headerValue.clear();
+        fill(&headerValue, headerBytes);
+        record.headers.push_back(RecordHeader{"trace-id", headerValue});
+      }
+      builder.append(record);
+    }
+
+    const std::string plain = builder.build();
+    if (m_options.compression == Compression::None) {
+      output->append(plain);
+      continue;
+    }
+    std::string compressed;
+    std::string compressError;
+    if (!Compressor::compressBatch(plain, m_options.compression, &compressed, &compressError)) {
+      if (error)
+        *error = QString::fromStdString(compressError);
+      return false;
+    }
+    output->append(compressed);
+  }
+  return true;
+}
+
+} // namespace kafka
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+#include <string>
+
+#include "core/protocol/RecordBatch.h"
+
+namespace kafka {
+
+struct GeneratorOptions {
+  int recordsPerBatch = 500;
+  int keyBytes = 16;
+  /** Values are JSON objects padded to this size, so JSON paths find something. */
+  int valueBytes = 256;
+  int headerCount = 0;
+  int headerValueBytes = 16;
+  Compression compression = Compression::None;
+  quint64 seed = 42;
+};
+
+/**
+ * @brief Builds record batches that look like a busy topic, from a seed.
+ *
+ * The same options and seed give the same bytes on every machine and run,
+ * so benchmark inputs can be compared across builds. Keys repeat over a
+ * keyspace of a thousand, and one value in ten has "status":"error".
+ */
+class BatchGenerator {
+public:
+  explicit BatchGenerator(const GeneratorOptions &options);
+
+  const GeneratorOptions &options() const { return m_options; }
+
+  /**
+   * @brief @p batchCount batches back to back, starting at @p baseOffset,
+   * as a Fetch response or a .log segment holds them.
+   */
+  bool generate(qint64 baseOffset, int batchCount, std::string *output, QString *error);
+
+private:
+  quint64 nextRandom();
+  void fill(std::string *out, std::size_t size);
+  std::string makeValue(qint64 offset);
+
+  GeneratorOptions m_options;
+  quint64 m_state = 0;
+};
+
+} // namespace kafka
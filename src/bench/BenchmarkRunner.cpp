@@ -0,0 +1,85 @@
+#include "bench/BenchmarkRunner.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace kafka {
+
+namespace {
+constexpr int kSamples = 5;
+
+// Written so results feeding it count as used; never read.
+volatile quint64 g_sink = 0;
+
+double nsPerOp(const std::function<quint64()> &body, qint64 iterations) {
+  QElapsedTimer timer;
+  timer.start();
+  quint64 sink = 0;
+  for (qint64 i = 0; i < iterations; ++i)
+    sink += body();
+  const qint64 elapsed = timer.nsecsElapsed();
+  g_sink = g_sink + sink;
+  return static_cast<double>(elapsed) / static_cast<double>(iterations);
+}
+} // namespace
+
+bool BenchmarkRunner::wants(const QString &name) const {
+  return m_filter.isEmpty() || name.contains(m_filter);
+}
+
+void BenchmarkRunner::run(const QString &name, qint64 bytesPerOp, qint64 recordsPerOp,
+                          const std::function<quint64()> &body) {
+  if (!wants(name))
+    return;
+
+  // Doubles the iteration count until one sample takes its share of the
+  // minimum time; the first call doubles as the warm-up.
+  const double sampleNs = m_minTimeMs * 1e6 / kSamples;
+  qint64 iterations = 1;
+  double perOp = nsPerOp(body, iterations);
+  while (perOp * static_cast<double>(iterations) < sampleNs && iterations < (qint64(1) << 40)) {
+    iterations = qMax(iterations * 2,
+                      static_cast<qint64>(sampleNs / qMax(perOp, 1.0) * 0.5));
+    perOp = nsPerOp(body, iterations);
+  }
+
+  std::vector<double> samples;
+  for (int i = 0; i < kSamples; ++i)
+    samples.push_back(nsPerOp(body, iterations));
+  std::sort(samples.begin(), samples.end());
+  const double median = samples[samples.size() / 2];
+  const double fastest = samples.front();
+
+  QJsonObject result;
+  result.insert(QStringLiteral("name"), name);
+  result.insert(QStringLiteral("iterations"), iterations);
+  result.insert(QStringLiteral("nsPerOp"), median);
+  result.insert(QStringLiteral("nsPerOpMin"), fastest);
+  if (bytesPerOp > 0) {
+    result.insert(QStringLiteral("bytesPerOp"), bytesPerOp);
+    result.insert(QStringLiteral("mbPerSecond"), static_cast<double>(bytesPerOp) * 1e3 / median);
+  }
+  if (recordsPerOp > 0) {
+    result.insert(QStringLiteral("recordsPerOp"), recordsPerOp);
+    result.insert(QStringLiteral("recordsPerSecond"),
+                  static_cast<double>(recordsPerOp) * 1e9 / median);
+  }
+  m_results.append(result);
+
+  // Progress goes to stderr so stdout stays valid JSON.
+  std::fprintf(stderr, "%-36s %14.0f ns/op\n", qPrintable(name), median);
+}
+
+QJsonObject BenchmarkRunner::report(const QJsonObject &generator) const {
+  QJsonObject report;
+  report.insert(QStringLiteral("schemaVersion"), 1);
+  report.insert(QStringLiteral("machine"), m_environment);
+  report.insert(QStringLiteral("generator"), generator);
+  report.insert(QStringLiteral("results"), m_results);
+  return report;
+}
+
+} // namespace kafka
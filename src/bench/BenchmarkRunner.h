@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QtGlobal>
+
+#include <functional>
+
+namespace kafka {
+
+/**
+ * @brief Times benchmark bodies and collects the results as JSON.
+ *
+ * Each body runs once to warm caches, then in a loop calibrated to take
+ * about a fifth of the minimum time; five such samples are taken and the
+ * median and fastest are reported, so one preempted sample does not skew
+ * the result.
+ */
+class BenchmarkRunner {
+public:
+  /** Runs only benchmarks whose name contains @p filter; empty runs all. */
+  void setFilter(const QString &filter) { m_filter = filter; }
+  void setMinTimeMs(int ms) { m_minTimeMs = qMax(1, ms); }
+  /** Extra fields for the "machine" object of the report. */
+  void setEnvironment(const QJsonObject &environment) { m_environment = environment; }
+
+  bool wants(const QString &name) const;
+
+  /**
+   * @brief Times @p body, which processes @p bytesPerOp bytes and
+   * @p recordsPerOp records per call (0 when not meaningful). The body
+   * returns a value derived from its work, so the compiler cannot drop it.
+   */
+  void run(const QString &name, qint64 bytesPerOp, qint64 recordsPerOp,
+           const std::function<quint64()> &body);
+
+  QJsonObject report(const QJsonObject &generator) const;
+
+private:
+  QString m_filter;
+  int m_minTimeMs = 500;
+  QJsonObject m_environment;
+  QJsonArray m_results;
+};
+
+} // namespace kafka
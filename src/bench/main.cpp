@@ -0,0 +1,491 @@
+// Microbenchmarks for the hot paths, over batches from BatchGenerator.
+//
+//   kafka-viewer-bench [--filter crc] [--min-time 500] [--output results.json]
+//
+// Results go to stdout (or --output) as JSON, progress to stderr. Numbers
+// are only comparable between runs with the same generator options on the
+// same machine, and only meaningful from a Release build.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QSysInfo>
+#include <QThread>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bench/BatchGenerator.h"
+#include "bench/BenchmarkRunner.h"
+#include "core/checksum/Crc32c.h"
+#include "core/codec/Decompressor.h"
+#include "core/filter/RecordFilter.h"
+#include "core/json/JsonPath.h"
+#include "core/network/FetchSession.h"
+#include "core/protocol/Messages.h"
+#include "core/protocol/RecordBatch.h"
+#include "core/search/PatternMatcher.h"
+#include "core/storage/AllocationCounter.h"
+#include "core/storage/RecordArena.h"
+
+#ifdef KAFKA_VIEWER_BENCH_MOCK_BROKER
+#include <QEventLoop>
+#include <QTemporaryDir>
+
+#include "core/network/KafkaClient.h"
+#include "core/network/KafkaSession.h"
+#include "core/replay/TopicReplay.h"
+#include "mock/MockBroker.h"
+#include "mock/MockCluster.h"
+#endif
+
+#ifndef KAFKA_VIEWER_BUILD_TYPE
+#define KAFKA_VIEWER_BUILD_TYPE ""
+#endif
+
+using namespace kafka;
+
+namespace {
+
+struct Corpus {
+  std::string bytes;
+  std::vector<RecordBatch> batches;
+  qint64 recordCount = 0;
+  qint64 recordBytes = 0;
+};
+
+bool makeCorpus(GeneratorOptions options, Compression compression, int batchCount,
+                Corpus *corpus, QString *error) {
+  options.compression = compression;
+  BatchGenerator generator(options);
+  if (!generator.generate(0, batchCount, &corpus->bytes, error))
+    return false;
+  BatchReader reader(corpus->bytes);
+  RecordBatch batch;
+  while (reader.next(batch) == ParseStatus::Ok) {
+    corpus->batches.push_back(batch);
+    corpus->recordCount += batch.recordCount();
+  }
+  return true;
+}
+
+std::vector<Record> recordsOf(const Corpus &plain) {
+  std::vector<Record> records;
+  records.reserve(static_cast<std::size_t>(plain.recordCount));
+  for (const RecordBatch &batch : plain.batches) {
+    RecordReader reader(batch, batch.recordsSection());
+    Record record;
+    while (reader.next(record))
+      records.push_back(record);
+  }
+  return records;
+}
+
+void benchParsing(BenchmarkRunner &runner, const Corpus &plain) {
+  const auto bytes = static_cast<qint64>(plain.bytes.size());
+  runner.run(QStringLiteral("parse/batches"), bytes, plain.recordCount, [&]() {
+    BatchReader reader(plain.bytes);
+    RecordBatch batch;
+    quint64 count = 0;
+    while (reader.next(batch) == ParseStatus::Ok)
+      count += static_cast<quint64>(batch.recordCount());
+    return count;
+  });
+  runner.run(QStringLiteral("parse/records"), bytes, plain.recordCount, [&]() {
+    BatchReader reader(plain.bytes);
+    RecordBatch batch;
+    quint64 sum = 0;
+    while (reader.next(batch) == ParseStatus::Ok) {
+      RecordReader records(batch, batch.recordsSection());
+      Record record;
+      while (records.next(record))
+        sum += record.value.size();
+    }
+    return sum;
+  });
+}
+
+void benchCrc(BenchmarkRunner &runner, const Corpus &plain) {
+  const Crc32c::Implementation implementations[] = {Crc32c::Implementation::Portable,
+                                                    Crc32c::Implementation::Sse42,
+                                                    Crc32c::Implementation::Sse42Clmul};
+  qint64 covered = 0;
+  for (const RecordBatch &batch : plain.batches)
+    covered += static_cast<qint64>(batch.crcCoveredBytes().size());
+
+  for (Crc32c::Implementation implementation : implementations) {
+    if (!Crc32c::isSupported(implementation))
+      continue;
+    const QString name = QStringLiteral("crc32c/%1")
+                             .arg(QString::fromLatin1(Crc32c::implementationName(implementation)));
+    runner.run(name, covered, plain.recordCount, [&]() {
+      quint64 sum = 0;
+      for (const RecordBatch &batch : plain.batches) {
+        const std::string_view bytes = batch.crcCoveredBytes();
+        sum += Crc32c::extendWith(implementation, 0, bytes.data(), bytes.size());
+      }
+      return sum;
+    });
+  }
+}
+
+// Throughput is given in uncompressed bytes, so codecs compare directly.
+void benchDecompression(BenchmarkRunner &runner, const GeneratorOptions &options, int batchCount,
+                        const Corpus &plain) {
+  qint64 uncompressed = 0;
+  for (const RecordBatch &batch : plain.batches)
+    uncompressed += static_cast<qint64>(batch.recordsSection().size());
+
+  const Compression codecs[] = {Compression::Gzip, Compression::Snappy, Compression::Lz4,
+                                Compression::Zstd};
+  for (Compression codec : codecs) {
+    const QString name =
+        QStringLiteral("decompress/%1").arg(QString::fromLatin1(compressionName(codec)));
+    if (!runner.wants(name))
+      continue;
+    Corpus corpus;
+    QString error;
+    if (!makeCorpus(options, codec, batchCount, &corpus, &error)) {
+      std::fprintf(stderr, "%s: %s\n", qPrintable(name), qPrintable(error));
+      continue;
+    }
+    std::string output;
+    std::string decodeError;
+    runner.run(name, uncompressed, corpus.recordCount, [&]() {
+      quint64 size = 0;
+      for (const RecordBatch &batch : corpus.batches) {
+        output.clear();
+        Decompressor::decompress(codec, batch.recordsSection(), &output, &decodeError);
+        size += output.size();
+      }
+      return size;
+    });
+  }
+}
+
+void benchSearch(BenchmarkRunner &runner, const std::vector<Record> &records, qint64 bytes) {
+  struct Pattern {
+    const char *name;
+    const char *text;
+    PatternMatcher::Syntax syntax;
+    bool caseSensitive;
+  };
+  const Pattern patterns[] = {
+      {"search/literal", "user-999\"", PatternMatcher::Syntax::Literal, true},
+      {"search/literal-nocase", "USER-999\"", PatternMatcher::Syntax::Literal, false},
+      {"search/regex", "user-99[0-9]\",\"status\":\"error", PatternMatcher::Syntax::Regex, true},
+  };
+  for (const Pattern &pattern : patterns) {
+    QString error;
+    const auto matcher = PatternMatcher::compile(QString::fromLatin1(pattern.text),
+                                                 pattern.syntax, pattern.caseSensitive, &error);
+    if (!matcher) {
+      std::fprintf(stderr, "%s: %s\n", pattern.name, qPrintable(error));
+      continue;
+    }
+    PatternMatcher::Scanner scanner(matcher);
+    runner.run(QString::fromLatin1(pattern.name), bytes,
+               static_cast<qint64>(records.size()), [&]() {
+                 quint64 matches = 0;
+                 PatternMatcher::Match match;
+                 for (const Record &record : records) {
+                   if (scanner.find(record.value, &match))
+                     ++matches;
+                 }
+                 return matches;
+               });
+  }
+}
+
+void benchFilter(BenchmarkRunner &runner, const std::vector<Record> &records, qint64 bytes) {
+  QString error;
+  const auto path = JsonPath::compile(QStringLiteral("$.status"), &error);
+  if (!path) {
+    std::fprintf(stderr, "filter/json-path: %s\n", qPrintable(error));
+    return;
+  }
+  runner.run(QStringLiteral("filter/json-path"), bytes, static_cast<qint64>(records.size()),
+             [&]() {
+               quint64 kept = 0;
+               for (const Record &record : records) {
+                 if (path->extract(record.value).raw == "\"error\"")
+                   ++kept;
+               }
+               return kept;
+             });
+
+  // The same test through the filter language, plus what a typical filter
+  // adds around it; compare with filter/json-path for the evaluator's cost.
+  const auto filter = RecordFilter::compile(
+      QStringLiteral("$.status == \"error\" && ts > 0 && offset >= 0"), 0, &error);
+  if (!filter) {
+    std::fprintf(stderr, "filter/expression: %s\n", qPrintable(error));
+    return;
+  }
+  RecordFilter::Evaluator evaluator(filter);
+  runner.run(QStringLiteral("filter/expression"), bytes, static_cast<qint64>(records.size()),
+             [&]() {
+               quint64 kept = 0;
+               for (const Record &record : records) {
+                 if (evaluator.matches(0, record))
+                   ++kept;
+               }
+               return kept;
+             });
+}
+
+// What MessageTableModel does with a loaded page: one arena per page,
+// every record stored into its slot.
+void benchModelInsert(BenchmarkRunner &runner, const Corpus &plain) {
+  const auto owner = std::make_shared<const std::string>(plain.bytes);
+  std::vector<RecordBatch> batches;
+  BatchReader reader(*owner);
+  RecordBatch batch;
+  while (reader.next(batch) == ParseStatus::Ok)
+    batches.push_back(batch);
+
+  runner.run(QStringLiteral("model/arena-insert"), static_cast<qint64>(owner->size()),
+             plain.recordCount, [&]() {
+               RecordArena arena(0, plain.recordCount);
+               arena.retain(owner, owner->size());
+               for (const RecordBatch &current : batches) {
+                 RecordReader records(current, current.recordsSection());
+                 Record record;
+                 while (records.next(record))
+                   arena.store(record, false);
+               }
+               return static_cast<quint64>(arena.recordCount());
+             });
+}
+
+// Fetch requests of a reader following 2000 partitions of which 40 got
+// records since the last round; bytesPerOp is the request body size, the
+// number to compare between the two. tests/tst_fetchsession.cpp checks the
+// same savings, and the fallback to full requests, against MockBroker.
+void benchFetchSession(BenchmarkRunner &runner) {
+  constexpr int kPartitions = 2000;
+  constexpr int kChangedPerRound = 40;
+  constexpr qint16 kVersion = 7;
+  QVector<FetchTarget> targets(kPartitions);
+  for (int i = 0; i < kPartitions; ++i)
+    targets[i].tp = TopicPartition{QStringLiteral("bench-tail"), i};
+
+  // Encodes the next request; an answered one moves the session on.
+  auto encode = [&](FetchSession &session, bool answered) {
+    FetchRequest request;
+    const quint64 serial = session.buildRequest(targets, kVersion, &request);
+    WireWriter writer;
+    request.encode(writer, kVersion);
+    if (answered)
+      session.commit(serial, /*sessionId=*/1);
+    return static_cast<qint64>(writer.size());
+  };
+
+  FetchSession full;
+  runner.run(QStringLiteral("fetch/session-full"), encode(full, false), 0,
+             [&]() { return static_cast<quint64>(encode(full, false)); });
+
+  FetchSession incremental;
+  encode(incremental, true);
+  int round = 0;
+  auto advance = [&]() {
+    for (int i = 0; i < kChangedPerRound; ++i)
+      targets[(round * kChangedPerRound + i) % kPartitions].offset += 1;
+    ++round;
+  };
+  advance();
+  const qint64 incrementalBytes = encode(incremental, true);
+  runner.run(QStringLiteral("fetch/session-incremental"), incrementalBytes, 0, [&]() {
+    advance();
+    return static_cast<quint64>(encode(incremental, true));
+  });
+}
+
+#ifdef KAFKA_VIEWER_BENCH_MOCK_BROKER
+// The corpus as JSON Lines over four partitions, replayed with the default
+// batching and LZ4 into an in-process MockBroker: reading, batching,
+// compression and Produce round trips over loopback. The mock broker comes
+// with the tests, so this is only built with KAFKA_VIEWER_BUILD_TESTS.
+void benchReplay(BenchmarkRunner &runner, const std::vector<Record> &records) {
+  const QString name = QStringLiteral("replay/mock-broker");
+  if (!runner.wants(name))
+    return;
+  constexpr int kPartitions = 4;
+  const QString topic = QStringLiteral("bench-replay");
+
+  QTemporaryDir directory;
+  QFile file(directory.filePath(QStringLiteral("replay.jsonl")));
+  if (!directory.isValid() || !file.open(QIODevice::WriteOnly)) {
+    std::fprintf(stderr, "%s: cannot write %s\n", qPrintable(name), qPrintable(file.fileName()));
+    return;
+  }
+  // Generated keys need no escaping, and values are JSON objects, which
+  // the reader keeps as their text.
+  std::string line;
+  for (std::size_t i = 0; i < records.size(); ++i) {
+    line.assign("{\"partition\":");
+    line += std::to_string(i % kPartitions);
+    line += ",\"key\":\"";
+    line += records[i].key;
+    line += "\",\"value\":";
+    line += records[i].value;
+    line += "}\n";
+    file.write(line.data(), static_cast<qint64>(line.size()));
+  }
+  file.close();
+
+  MockCluster cluster;
+  cluster.run([&](MockBroker &broker) { broker.createTopic(topic, kPartitions); });
+  KafkaSession session;
+  session.client()->setBootstrapServers(cluster.bootstrapServers());
+
+  ReplayRequest request;
+  request.path = file.fileName();
+  request.topic = topic;
+  TopicReplay replay;
+  runner.run(name, file.size(), static_cast<qint64>(records.size()), [&]() {
+    QEventLoop loop;
+    QObject::connect(&replay, &TopicReplay::finished, &loop, &QEventLoop::quit);
+    replay.start(session.client(), request);
+    loop.exec();
+    if (!replay.errorString().isEmpty())
+      std::fprintf(stderr, "%s: %s\n", qPrintable(name), qPrintable(replay.errorString()));
+    return static_cast<quint64>(replay.recordCount());
+  });
+}
+#endif
+
+QJsonObject environment() {
+  QJsonObject machine;
+  machine.insert(QStringLiteral("os"), QSysInfo::prettyProductName());
+  machine.insert(QStringLiteral("cpuArchitecture"), QSysInfo::currentCpuArchitecture());
+  machine.insert(QStringLiteral("threads"), QThread::idealThreadCount());
+  machine.insert(QStringLiteral("crc32c"),
+                 QString::fromLatin1(Crc32c::implementationName(Crc32c::implementation())));
+  machine.insert(QStringLiteral("qt"), QString::fromLatin1(qVersion()));
+  machine.insert(QStringLiteral("buildType"), QStringLiteral(KAFKA_VIEWER_BUILD_TYPE));
+  machine.insert(QStringLiteral("countAllocations"), AllocationCounter::isEnabled());
+#if defined(__clang__)
+  machine.insert(QStringLiteral("compiler"), QStringLiteral("clang " __clang_version__));
+#elif defined(__GNUC__)
+  machine.insert(QStringLiteral("compiler"), QStringLiteral("gcc " __VERSION__));
+#elif defined(_MSC_VER)
+  machine.insert(QStringLiteral("compiler"), QStringLiteral("msvc %1").arg(_MSC_VER));
+#endif
+  return machine;
+}
+
+QJsonObject describe(const GeneratorOptions &options, int batchCount, const Corpus &plain) {
+  QJsonObject generator;
+  generator.insert(QStringLiteral("seed"), QString::number(options.seed));
+  generator.insert(QStringLiteral("batches"), batchCount);
+  generator.insert(QStringLiteral("recordsPerBatch"), options.recordsPerBatch);
+  generator.insert(QStringLiteral("keyBytes"), options.keyBytes);
+  generator.insert(QStringLiteral("valueBytes"), options.valueBytes);
+  generator.insert(QStringLiteral("headers"), options.headerCount);
+  generator.insert(QStringLiteral("headerValueBytes"), options.headerValueBytes);
+  generator.insert(QStringLiteral("corpusBytes"), static_cast<qint64>(plain.bytes.size()));
+  return generator;
+}
+
+int intOption(const QCommandLineParser &parser, const QCommandLineOption &option) {
+  return parser.value(option).toInt();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName(QStringLiteral("kafka-viewer-bench"));
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      QStringLiteral("Microbenchmarks over synthetic record batches; JSON on stdout."));
+  parser.addHelpOption();
+  const QCommandLineOption filterOption(
+      QStringLiteral("filter"), QStringLiteral("Run benchmarks whose name contains <text>."),
+      QStringLiteral("text"));
+  const QCommandLineOption minTimeOption(QStringLiteral("min-time"),
+                                         QStringLiteral("Time per benchmark in ms."),
+                                         QStringLiteral("ms"), QStringLiteral("500"));
+  const QCommandLineOption outputOption(QStringLiteral("output"),
+                                        QStringLiteral("Write the JSON report to <file>."),
+                                        QStringLiteral("file"));
+  const QCommandLineOption batchesOption(QStringLiteral("batches"),
+                                         QStringLiteral("Batches in the corpus."),
+                                         QStringLiteral("n"), QStringLiteral("64"));
+  const QCommandLineOption recordsOption(QStringLiteral("records-per-batch"),
+                                         QStringLiteral("Records per batch."),
+                                         QStringLiteral("n"), QStringLiteral("500"));
+  const QCommandLineOption keyBytesOption(QStringLiteral("key-bytes"),
+                                          QStringLiteral("Key size."), QStringLiteral("n"),
+                                          QStringLiteral("16"));
+  const QCommandLineOption valueBytesOption(QStringLiteral("value-bytes"),
+                                            QStringLiteral("Value size."), QStringLiteral("n"),
+                                            QStringLiteral("256"));
+  const QCommandLineOption headersOption(QStringLiteral("headers"),
+                                         QStringLiteral("Headers per record."),
+                                         QStringLiteral("n"), QStringLiteral("0"));
+  const QCommandLineOption seedOption(QStringLiteral("seed"),
+                                      QStringLiteral("Generator seed."), QStringLiteral("n"),
+                                      QStringLiteral("42"));
+  parser.addOptions({filterOption, minTimeOption, outputOption, batchesOption, recordsOption,
+                     keyBytesOption, valueBytesOption, headersOption, seedOption});
+  parser.process(app);
+
+  GeneratorOptions options;
+  options.recordsPerBatch = qMax(1, intOption(parser, recordsOption));
+  options.keyBytes = intOption(parser, keyBytesOption);
+  options.valueBytes = intOption(parser, valueBytesOption);
+  options.headerCount = intOption(parser, headersOption);
+  options.seed = parser.value(seedOption).toULongLong();
+  const int batchCount = qMax(1, intOption(parser, batchesOption));
+
+  if (QStringLiteral(KAFKA_VIEWER_BUILD_TYPE) != QStringLiteral("Release"))
+    std::fprintf(stderr, "warning: not a Release build; numbers are not representative\n");
+
+  Corpus plain;
+  QString error;
+  if (!makeCorpus(options, Compression::None, batchCount, &plain, &error)) {
+    std::fprintf(stderr, "cannot generate batches: %s\n", qPrintable(error));
+    return 1;
+  }
+  const std::vector<Record> records = recordsOf(plain);
+  qint64 valueBytes = 0;
+  for (const Record &record : records)
+    valueBytes += static_cast<qint64>(record.value.size());
+
+  BenchmarkRunner runner;
+  runner.setFilter(parser.value(filterOption));
+  runner.setMinTimeMs(intOption(parser, minTimeOption));
+  runner.setEnvironment(environment());
+
+  benchParsing(runner, plain);
+  benchCrc(runner, plain);
+  benchDecompression(runner, options, batchCount, plain);
+  benchSearch(runner, records, valueBytes);
+  benchFilter(runner, records, valueBytes);
+  benchModelInsert(runner, plain);
+  benchFetchSession(runner);
+#ifdef KAFKA_VIEWER_BENCH_MOCK_BROKER
+  benchReplay(runner, records);
+#endif
+
+  const QByteArray json =
+      QJsonDocument(runner.report(describe(options, batchCount, plain))).toJson();
+  if (!parser.isSet(outputOption)) {
+    std::fwrite(json.constData(), 1, static_cast<std::size_t>(json.size()), stdout);
+    return 0;
+  }
+  QFile file(parser.value(outputOption));
+  if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+    std::fprintf(stderr, "cannot write %s: %s\n", qPrintable(file.fileName()),
+                 qPrintable(file.errorString()));
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,306 @@
+#include "core/cache/BatchCache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "core/protocol/RecordBatch.h"
+#include "core/source/BatchSource.h"
+#include "core/trace/Trace.h"
+
+namespace kafka {
+
+namespace {
+constexpr quint32 kVersion = 1;
+constexpr char kMagic[4] = {'K', 'V', 'B', 'C'};
+// Reads within this long of the last recorded use do not touch the file.
+constexpr qint64 kTouchIntervalMs = 60 * 1000;
+
+// Written in host byte order; the cache never leaves the machine.
+struct FileHeader {
+  char magic[4];
+  quint32 version;
+  qint64 first;
+  qint64 next;
+  quint64 size;
+};
+static_assert(sizeof(FileHeader) == 32, "FileHeader is part of the file format");
+
+QString fileName(qint64 first, qint64 next) {
+  return QStringLiteral("%1-%2.batches")
+      .arg(first, 20, 10, QLatin1Char('0'))
+      .arg(next, 20, 10, QLatin1Char('0'));
+}
+} // namespace
+
+BatchCache::BatchCache(const QString &root, qint64 budget) : m_root(root), m_budget(budget) {}
+
+QString BatchCache::defaultRoot() {
+  return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
+      .filePath(QStringLiteral("batches"));
+}
+
+QString BatchCache::directoryFor(const QString &key, qint32 partition) const {
+  const QByteArray digest =
+      QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+  return QStringLiteral("%1/%2").arg(QString::fromLatin1(digest)).arg(partition);
+}
+
+QString BatchCache::pathOf(const Entry &entry) const {
+  return QDir(m_root).filePath(entry.directory + QLatin1Char('/') +
+                               fileName(entry.first, entry.next));
+}
+
+bool BatchCache::read(const QString &key, qint32 partition, qint64 offset, BatchChunk *chunk) {
+  if (!isEnabled())
+    return false;
+  KAFKA_TRACE_SCOPE("batch cache read");
+
+  const QString directory = directoryFor(key, partition);
+  Entry entry;
+  bool touch = false;
+  {
+    QMutexLocker locker(&m_mutex);
+    ensureLoaded();
+    const auto it = find(directory, offset);
+    if (it == m_lru.end())
+      return false;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    touch = now - it->lastUsed >= kTouchIntervalMs;
+    it->lastUsed = now;
+    m_lru.splice(m_lru.end(), m_lru, it);
+    entry = *it;
+  }
+
+  const QString path = pathOf(entry);
+  auto file = std::make_shared<QFile>(path);
+  const qint64 size = file->open(QIODevice::ReadOnly) ? file->size() : 0;
+  const uchar *data = size > qint64(sizeof(FileHeader)) ? file->map(0, size) : nullptr;
+  FileHeader header{};
+  if (data)
+    std::memcpy(&header, data, sizeof(header));
+  if (!data || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion || header.first != entry.first || header.next != entry.next ||
+      size != qint64(sizeof(FileHeader)) + qint64(header.size)) {
+    // Closed first; a mapped or open file cannot be removed everywhere.
+    file.reset();
+    QMutexLocker locker(&m_mutex);
+    const auto it = find(directory, offset);
+    if (it != m_lru.end() && it->first == entry.first && it->next == entry.next)
+      erase(it);
+    return false;
+  }
+  if (touch)
+    file->setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+
+  const std::string_view body(reinterpret_cast<const char *>(data) + sizeof(FileHeader),
+                              static_cast<std::size_t>(header.size));
+  BatchReader batches(body);
+  RecordBatch batch;
+  std::size_t start = body.size();
+  while (batches.next(batch) == ParseStatus::Ok) {
+    if (batch.nextOffset() > offset) {
+      start = static_cast<std::size_t>(batch.bytes().data() - body.data());
+      break;
+    }
+  }
+  if (start >= body.size())
+    return false;
+
+  chunk->owner = std::move(file);
+  chunk->bytes = body.substr(start);
+  chunk->errorCode = 0;
+  return true;
+}
+
+void BatchCache::store(const QString &key, qint32 partition, qint64 offset,
+                       const BatchChunk &chunk) {
+  const qint64 budget = m_budget.load();
+  if (budget <= 0 || chunk.errorCode != 0 || chunk.isEmpty())
+    return;
+
+  // Only complete batches; legacy message sets between them are kept and
+  // stepped over again when read.
+  BatchReader batches(chunk.bytes);
+  RecordBatch batch;
+  const char *begin = nullptr;
+  const char *end = nullptr;
+  Entry entry;
+  while (batches.next(batch) == ParseStatus::Ok) {
+    if (!begin) {
+      begin = batch.bytes().data();
+      entry.first = std::min<qint64>(offset, batch.baseOffset());
+    }
+    end = batch.bytes().data() + batch.size();
+    entry.next = batch.nextOffset();
+  }
+  if (!begin || entry.next <= offset)
+    return;
+  const std::string_view body(begin, static_cast<std::size_t>(end - begin));
+  entry.size = qint64(sizeof(FileHeader)) + qint64(body.size());
+  // One fetch may not push out most of what is cached.
+  if (entry.size > budget / 4)
+    return;
+
+  KAFKA_TRACE_SCOPE("batch cache store");
+  entry.directory = directoryFor(key, partition);
+  {
+    QMutexLocker locker(&m_mutex);
+    ensureLoaded();
+    // Another reader fetched the same offsets meanwhile, or is storing
+    // them now; without the reservation both would write the same file.
+    if (find(entry.directory, offset) != m_lru.end() ||
+        isWriting(entry.directory, entry.first, entry.next))
+      return;
+    m_writing[entry.directory].emplace(entry.first, entry.next);
+  }
+
+  QSaveFile file(pathOf(entry));
+  FileHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.first = entry.first;
+  header.next = entry.next;
+  header.size = body.size();
+  const bool written =
+      QDir().mkpath(QDir(m_root).filePath(entry.directory)) &&
+      file.open(QIODevice::WriteOnly) &&
+      file.write(reinterpret_cast<const char *>(&header), sizeof(header)) ==
+          qint64(sizeof(header)) &&
+      file.write(body.data(), qint64(body.size())) == qint64(body.size()) && file.commit();
+
+  entry.lastUsed = QDateTime::currentMSecsSinceEpoch();
+  QMutexLocker locker(&m_mutex);
+  const auto writing = m_writing.find(entry.directory);
+  writing->erase(entry.first);
+  if (writing->empty())
+    m_writing.erase(writing);
+  if (!written)
+    return;
+  insert(std::move(entry));
+  evict(budget);
+}
+
+qint64 BatchCache::size() {
+  QMutexLocker locker(&m_mutex);
+  ensureLoaded();
+  return m_size;
+}
+
+// Rebuilds the recency order from the modification times the files were
+// last touched at.
+void BatchCache::ensureLoaded() {
+  if (m_loaded)
+    return;
+  m_loaded = true;
+
+  const QDir root(m_root);
+  std::vector<Entry> entries;
+  QDirIterator files(m_root, {QStringLiteral("*.batches")}, QDir::Files,
+                     QDirIterator::Subdirectories);
+  while (files.hasNext()) {
+    files.next();
+    const QFileInfo info = files.fileInfo();
+    const QStringList bounds = info.completeBaseName().split(QLatin1Char('-'));
+    bool firstOk = false;
+    bool nextOk = false;
+    Entry entry;
+    if (bounds.size() == 2) {
+      entry.first = bounds[0].toLongLong(&firstOk);
+      entry.next = bounds[1].toLongLong(&nextOk);
+    }
+    if (!firstOk || !nextOk || entry.first >= entry.next)
+      continue;
+    entry.directory = root.relativeFilePath(info.path());
+    entry.size = info.size();
+    entry.lastUsed = info.lastModified().toMSecsSinceEpoch();
+    entries.push_back(std::move(entry));
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry &a, const Entry &b) { return a.lastUsed < b.lastUsed; });
+  for (Entry &entry : entries)
+    insert(std::move(entry));
+
+  const qint64 budget = m_budget.load();
+  if (budget > 0)
+    evict(budget);
+}
+
+// The file with the highest first offset at or below @p offset; a file it
+// overlaps with is not looked at.
+BatchCache::Lru::iterator BatchCache::find(const QString &directory, qint64 offset) {
+  const auto ranges = m_ranges.constFind(directory);
+  if (ranges == m_ranges.cend())
+    return m_lru.end();
+  auto it = ranges->upper_bound(offset);
+  if (it == ranges->begin())
+    return m_lru.end();
+  --it;
+  return it->second->next > offset ? it->second : m_lru.end();
+}
+
+// Ranges being written never overlap, so only the last one starting
+// before @p next can reach into [first, next).
+bool BatchCache::isWriting(const QString &directory, qint64 first, qint64 next) const {
+  const auto ranges = m_writing.constFind(directory);
+  if (ranges == m_writing.cend())
+    return false;
+  auto it = ranges->lower_bound(next);
+  if (it == ranges->begin())
+    return false;
+  --it;
+  return it->second > first;
+}
+
+void BatchCache::insert(Entry entry) {
+  std::map<qint64, Lru::iterator> &ranges = m_ranges[entry.directory];
+  const auto existing = ranges.find(entry.first);
+  if (existing != ranges.end()) {
+    const Lru::iterator old = existing->second;
+    // The same file, rewritten in place.
+    if (old->next == entry.next) {
+      old->lastUsed = entry.lastUsed;
+      m_lru.splice(m_lru.end(), m_lru, old);
+      return;
+    }
+    erase(old);
+  }
+  m_size += entry.size;
+  const QString directory = entry.directory;
+  const qint64 first = entry.first;
+  m_lru.push_back(std::move(entry));
+  m_ranges[directory].emplace(first, std::prev(m_lru.end()));
+}
+
+// A file still mapped by a chunk cannot be removed on Windows; it is
+// dropped from the index anyway and found again by the next scan.
+void BatchCache::erase(Lru::iterator it) {
+  QFile::remove(pathOf(*it));
+  m_size -= it->size;
+  const auto ranges = m_ranges.find(it->directory);
+  if (ranges != m_ranges.end()) {
+    ranges->erase(it->first);
+    if (ranges->empty())
+      m_ranges.erase(ranges);
+  }
+  m_lru.erase(it);
+}
+
+void BatchCache::evict(qint64 budget) {
+  while (m_size > budget && !m_lru.empty())
+    erase(m_lru.begin());
+}
+
+} // namespace kafka
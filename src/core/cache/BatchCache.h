@@ -0,0 +1,108 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include <atomic>
+#include <iterator>
+#include <list>
+#include <map>
+
+namespace kafka {
+
+struct BatchChunk;
+
+/**
+ * @brief Raw record batches fetched from a cluster, kept on disk so that
+ * reading the same offsets again, in this run or a later one, needs no
+ * fetch.
+ *
+ * Every stored fetch becomes one immutable file holding the complete
+ * batches of the answer as they came off the wire. The file is named by
+ * the offsets [first, next) it covers, in a directory per partition under
+ * a digest of the source's persistent key (cluster and topic), so a read
+ * finds its file from the offset alone. Files are memory-mapped when read
+ * back and handed out as the chunk's owner, as LogDirectorySource does
+ * with segments.
+ *
+ * The files together stay within a size budget; the least recently read
+ * ones go first. A file's modification time records its last use, which
+ * carries the order across restarts. A truncated trailing batch is never
+ * stored, so a range at the end of a partition is fetched again once it
+ * has grown. Batches are stored as fetched: what compaction or retention
+ * removes later stays readable here until evicted. A topic deleted and
+ * created again under the same name gets a new key where the key holds
+ * the topic id, as KafkaBatchSource's does with brokers that have one.
+ *
+ * Thread-safe. The directory is scanned on first use, from whichever
+ * thread reads first; call read() and store() from worker threads only.
+ */
+class BatchCache {
+public:
+  static constexpr qint64 kDefaultBudget = qint64(1) << 30;
+
+  BatchCache(const QString &root, qint64 budget);
+
+  /** The application's cache directory plus "batches". */
+  static QString defaultRoot();
+
+  QString root() const { return m_root; }
+  qint64 budget() const { return m_budget.load(); }
+  /**
+   * @brief Bytes the files may take; 0 turns the cache off. A smaller
+   * budget evicts on the next store().
+   */
+  void setBudget(qint64 bytes) { m_budget.store(bytes); }
+  bool isEnabled() const { return m_budget.load() > 0; }
+
+  /**
+   * @brief Fills @p chunk from the file covering @p offset of @p partition,
+   * starting at the batch that contains it. Returns false on a miss.
+   */
+  bool read(const QString &key, qint32 partition, qint64 offset, BatchChunk *chunk);
+  /**
+   * @brief Keeps what a fetch at @p offset returned. Nothing at all before
+   * the chunk's first batch means the file covers the offsets from
+   * @p offset on, so a gap left by compaction is not fetched again.
+   */
+  void store(const QString &key, qint32 partition, qint64 offset, const BatchChunk &chunk);
+  /** Bytes held on disk; scans the directory if nothing did yet. */
+  qint64 size();
+
+private:
+  struct Entry {
+    QString directory;
+    qint64 first = 0;
+    qint64 next = 0;
+    qint64 size = 0;
+    qint64 lastUsed = 0;
+  };
+  // Least recently used first.
+  using Lru = std::list<Entry>;
+
+  QString directoryFor(const QString &key, qint32 partition) const;
+  QString pathOf(const Entry &entry) const;
+  void ensureLoaded();
+  Lru::iterator find(const QString &directory, qint64 offset);
+  /** Whether a store() is writing a file overlapping [first, next). */
+  bool isWriting(const QString &directory, qint64 first, qint64 next) const;
+  void insert(Entry entry);
+  void erase(Lru::iterator it);
+  void evict(qint64 budget);
+
+  const QString m_root;
+  std::atomic<qint64> m_budget;
+
+  QMutex m_mutex;
+  bool m_loaded = false;
+  qint64 m_size = 0;
+  Lru m_lru;
+  // Per partition directory, the files by first offset.
+  QHash<QString, std::map<qint64, Lru::iterator>> m_ranges;
+  // Per partition directory, the [first, next) ranges store() has reserved
+  // and is writing outside the lock.
+  QHash<QString, std::map<qint64, qint64>> m_writing;
+};
+
+} // namespace kafka
@@ -0,0 +1,264 @@
+#include "core/checksum/Crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define KAFKA_CRC32C_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define KAFKA_TARGET_SSE42
+#define KAFKA_TARGET_SSE42_CLMUL
+#else
+#include <cpuid.h>
+#define KAFKA_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define KAFKA_TARGET_SSE42_CLMUL __attribute__((target("sse4.2,pclmul")))
+#endif
+#endif
+
+namespace kafka {
+
+namespace {
+constexpr std::uint32_t kCastagnoliReflected = 0x82F63B78u;
+
+// Slicing-by-8 tables: kTables[0] is the classic byte table, kTables[k]
+// advances a byte that sits k positions further back in the stream.
+struct CrcTables {
+  std::array<std::array<std::uint32_t, 256>, 8> table{};
+
+  constexpr CrcTables() {
+    for (std::uint32_t i = 0; i < 256; ++i) {
+      std::uint32_t crc = i;
+      for (int bit = 0; bit < 8; ++bit)
+        crc = (crc >> 1) ^ ((crc & 1u) ? kCastagnoliReflected : 0u);
+      table[0][i] = crc;
+    }
+    for (std::size_t k = 1; k < 8; ++k) {
+      for (std::size_t i = 0; i < 256; ++i) {
+        const std::uint32_t previous = table[k - 1][i];
+        table[k][i] = (previous >> 8) ^ table[0][previous & 0xFF];
+      }
+    }
+  }
+};
+
+constexpr CrcTables kTables;
+
+inline std::uint32_t loadLittleEndian32(const unsigned char *p) {
+  return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+         (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+// Works on the raw register (pre- and post-inversion are left to callers)
+// so the hardware paths can reuse it for their tails.
+std::uint32_t extendPortable(std::uint32_t state, const unsigned char *p, std::size_t size) {
+  const auto &t = kTables.table;
+  while (size >= 8) {
+    const std::uint32_t low = loadLittleEndian32(p) ^ state;
+    const std::uint32_t high = loadLittleEndian32(p + 4);
+    state = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^
+            t[4][low >> 24] ^ t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^
+            t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+    p += 8;
+    size -= 8;
+  }
+  while (size-- > 0)
+    state = (state >> 8) ^ t[0][(state ^ *p++) & 0xFF];
+  return state;
+}
+
+#ifdef KAFKA_CRC32C_X86
+
+// Lane sizes for the three-stream loop. crc32 has a latency of three
+// cycles and a throughput of one, so three independent streams keep the
+// unit busy; each group of lanes is then merged with two multiplications.
+constexpr std::size_t kLongLane = 8192;
+constexpr std::size_t kShortLane = 256;
+
+// x^n mod P in the reflected representation (bit 31 is x^0).
+std::uint32_t xPowModP(std::size_t n) {
+  std::uint32_t value = 0x80000000u;
+  while (n-- > 0)
+    value = (value & 1u) ? (value >> 1) ^ kCastagnoliReflected : value >> 1;
+  return value;
+}
+
+// Multiplying a register by x^(8n - 33) with pclmul and folding the 64-bit
+// product with crc32 (which itself multiplies by x^32, and the reflected
+// product carries one more x) advances it over n zero bytes.
+struct ShiftConstants {
+  std::uint64_t longOnce = xPowModP(8 * kLongLane - 33);
+  std::uint64_t longTwice = xPowModP(16 * kLongLane - 33);
+  std::uint64_t shortOnce = xPowModP(8 * kShortLane - 33);
+  std::uint64_t shortTwice = xPowModP(16 * kShortLane - 33);
+};
+
+const ShiftConstants &shiftConstants() {
+  static const ShiftConstants constants;
+  return constants;
+}
+
+inline std::uint64_t load64(const unsigned char *p) {
+  std::uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+KAFKA_TARGET_SSE42
+std::uint32_t extendSse42(std::uint32_t state, const unsigned char *p, std::size_t size) {
+  while (size > 0 && (reinterpret_cast<std::uintptr_t>(p) & 7u) != 0) {
+    state = _mm_crc32_u8(state, *p++);
+    --size;
+  }
+  std::uint64_t wide = state;
+  while (size >= 8) {
+    wide = _mm_crc32_u64(wide, load64(p));
+    p += 8;
+    size -= 8;
+  }
+  state = static_cast<std::uint32_t>(wide);
+  while (size-- > 0)
+    state = _mm_crc32_u8(state, *p++);
+  return state;
+}
+
+KAFKA_TARGET_SSE42_CLMUL
+inline std::uint32_t shiftClmul(std::uint64_t crc, std::uint64_t constant) {
+  const __m128i product = _mm_clmulepi64_si128(_mm_cvtsi64_si128(static_cast<long long>(crc)),
+                                               _mm_cvtsi64_si128(static_cast<long long>(constant)),
+                                               0x00);
+  return static_cast<std::uint32_t>(
+      _mm_crc32_u64(0, static_cast<std::uint64_t>(_mm_cvtsi128_si64(product))));
+}
+
+KAFKA_TARGET_SSE42_CLMUL
+std::uint64_t threeLanes(std::uint64_t crc0, const unsigned char *p, std::size_t lane,
+                         std::uint64_t once, std::uint64_t twice) {
+  std::uint64_t crc1 = 0;
+  std::uint64_t crc2 = 0;
+  for (std::size_t i = 0; i < lane; i += 8) {
+    crc0 = _mm_crc32_u64(crc0, load64(p + i));
+    crc1 = _mm_crc32_u64(crc1, load64(p + lane + i));
+    crc2 = _mm_crc32_u64(crc2, load64(p + 2 * lane + i));
+  }
+  return shiftClmul(crc0, twice) ^ shiftClmul(crc1, once) ^ crc2;
+}
+
+KAFKA_TARGET_SSE42_CLMUL
+std::uint32_t extendSse42Clmul(std::uint32_t state, const unsigned char *p, std::size_t size) {
+  while (size > 0 && (reinterpret_cast<std::uintptr_t>(p) & 7u) != 0) {
+    state = _mm_crc32_u8(state, *p++);
+    --size;
+  }
+
+  const ShiftConstants &k = shiftConstants();
+  std::uint64_t wide = state;
+  while (size >= 3 * kLongLane) {
+    wide = threeLanes(wide, p, kLongLane, k.longOnce, k.longTwice);
+    p += 3 * kLongLane;
+    size -= 3 * kLongLane;
+  }
+  while (size >= 3 * kShortLane) {
+    wide = threeLanes(wide, p, kShortLane, k.shortOnce, k.shortTwice);
+    p += 3 * kShortLane;
+    size -= 3 * kShortLane;
+  }
+  return extendSse42(static_cast<std::uint32_t>(wide), p, size);
+}
+
+struct CpuFeatures {
+  bool sse42 = false;
+  bool pclmul = false;
+};
+
+CpuFeatures detectCpuFeatures() {
+  unsigned int ecx = 0;
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4] = {};
+  __cpuid(info, 1);
+  ecx = static_cast<unsigned int>(info[2]);
+#else
+  unsigned int eax = 0;
+  unsigned int ebx = 0;
+  unsigned int edx = 0;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return {};
+#endif
+  CpuFeatures features;
+  features.sse42 = (ecx & (1u << 20)) != 0;
+  features.pclmul = (ecx & (1u << 1)) != 0;
+  return features;
+}
+
+#endif // KAFKA_CRC32C_X86
+
+using ExtendFunction = std::uint32_t (*)(std::uint32_t, const unsigned char *, std::size_t);
+
+ExtendFunction functionFor(Crc32c::Implementation implementation) {
+  switch (implementation) {
+#ifdef KAFKA_CRC32C_X86
+  case Crc32c::Implementation::Sse42Clmul:
+    return &extendSse42Clmul;
+  case Crc32c::Implementation::Sse42:
+    return &extendSse42;
+#endif
+  default:
+    return &extendPortable;
+  }
+}
+
+Crc32c::Implementation detectImplementation() {
+#ifdef KAFKA_CRC32C_X86
+  const CpuFeatures features = detectCpuFeatures();
+  if (features.sse42 && features.pclmul)
+    return Crc32c::Implementation::Sse42Clmul;
+  if (features.sse42)
+    return Crc32c::Implementation::Sse42;
+#endif
+  return Crc32c::Implementation::Portable;
+}
+} // namespace
+
+Crc32c::Implementation Crc32c::implementation() {
+  static const Implementation detected = detectImplementation();
+  return detected;
+}
+
+const char *Crc32c::implementationName(Implementation implementation) {
+  switch (implementation) {
+  case Implementation::Portable:
+    return "portable";
+  case Implementation::Sse42:
+    return "sse4.2";
+  case Implementation::Sse42Clmul:
+    return "sse4.2+pclmul";
+  }
+  return "unknown";
+}
+
+bool Crc32c::isSupported(Implementation candidate) {
+  switch (candidate) {
+  case Implementation::Portable:
+    return true;
+  case Implementation::Sse42:
+    return implementation() != Implementation::Portable;
+  case Implementation::Sse42Clmul:
+    return implementation() == Implementation::Sse42Clmul;
+  }
+  return false;
+}
+
+std::uint32_t Crc32c::extend(std::uint32_t crc, const void *data, std::size_t size) {
+  static const ExtendFunction function = functionFor(implementation());
+  return ~function(~crc, static_cast<const unsigned char *>(data), size);
+}
+
+std::uint32_t Crc32c::extendWith(Implementation candidate, std::uint32_t crc, const void *data,
+                                 std::size_t size) {
+  const ExtendFunction function =
+      functionFor(isSupported(candidate) ? candidate : Implementation::Portable);
+  return ~function(~crc, static_cast<const unsigned char *>(data), size);
+}
+
+} // namespace kafka
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace kafka {
+
+/**
+ * @brief CRC32C (Castagnoli), the checksum carried by v2 record batches.
+ *
+ * extend() runs on the fastest implementation the CPU supports, picked
+ * once on first use: SSE4.2 crc32 over three interleaved streams merged
+ * with carry-less multiplication, SSE4.2 alone, or a portable
+ * slicing-by-8 table.
+ */
+class Crc32c {
+public:
+  enum class Implementation {
+    Portable,
+    Sse42,
+    Sse42Clmul,
+  };
+
+  /**
+   * @brief Extends @p crc (0 for a fresh checksum) over @p size bytes.
+   */
+  static std::uint32_t extend(std::uint32_t crc, const void *data, std::size_t size);
+
+  static std::uint32_t compute(const void *data, std::size_t size) {
+    return extend(0, data, size);
+  }
+  static std::uint32_t compute(std::string_view data) {
+    return extend(0, data.data(), data.size());
+  }
+
+  /** The implementation extend() dispatches to on this machine. */
+  static Implementation implementation();
+  static const char *implementationName(Implementation implementation);
+  static bool isSupported(Implementation implementation);
+  /**
+   * @brief extend() on a specific implementation, for benchmarks and
+   * cross-checks; unsupported ones fall back to Portable.
+   */
+  static std::uint32_t extendWith(Implementation implementation, std::uint32_t crc,
+                                  const void *data, std::size_t size);
+};
+
+} // namespace kafka
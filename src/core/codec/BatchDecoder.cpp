@@ -0,0 +1,80 @@
+#include "core/codec/BatchDecoder.h"
+
+#include <QSemaphore>
+#include <QThread>
+
+#include "core/codec/Decompressor.h"
+#include "core/trace/Trace.h"
+
+namespace kafka {
+
+BatchDecoder::BatchDecoder(int threadCount, qint64 cacheBytes) : m_cache(cacheBytes) {
+  m_pool.setObjectName(QStringLiteral("kafka-decode"));
+  m_pool.setMaxThreadCount(qMax(1, threadCount));
+}
+
+BatchDecoder::~BatchDecoder() { m_pool.waitForDone(); }
+
+BatchDecoder &BatchDecoder::shared() {
+  static BatchDecoder decoder(QThread::idealThreadCount());
+  return decoder;
+}
+
+std::shared_ptr<const DecodedBatch> BatchDecoder::decodeOne(const RecordBatch &batch,
+                                                            std::string *error) {
+  KAFKA_TRACE_SCOPE("decode batch");
+  auto decoded = std::make_shared<DecodedBatch>();
+  decoded->header.assign(batch.bytes().data(), RecordBatch::kHeaderSize);
+  if (!Decompressor::decompress(batch.compression(), batch.recordsSection(), &decoded->records,
+                                error))
+    return nullptr;
+  decoded->records.shrink_to_fit();
+  return decoded;
+}
+
+std::vector<std::shared_ptr<const DecodedBatch>>
+BatchDecoder::decode(quint64 sourceId, qint32 partition, const std::vector<RecordBatch> &batches,
+                     QString *error) {
+  KAFKA_TRACE_SCOPE("decode batches");
+  std::vector<std::shared_ptr<const DecodedBatch>> results(batches.size());
+  std::vector<std::string> errors(batches.size());
+  std::vector<std::size_t> misses;
+
+  for (std::size_t i = 0; i < batches.size(); ++i) {
+    results[i] = m_cache.find({sourceId, partition, batches[i].baseOffset()});
+    if (!results[i])
+      misses.push_back(i);
+  }
+  KAFKA_TRACE_COUNTER("decode cache misses", misses.size());
+
+  auto decodeAt = [&](std::size_t i) { results[i] = decodeOne(batches[i], &errors[i]); };
+
+  if (misses.size() == 1) {
+    // Not worth a thread hop.
+    decodeAt(misses.front());
+  } else if (!misses.empty()) {
+    // The tasks borrow this frame's vectors; the semaphore keeps it alive
+    // until every one of them is done.
+    QSemaphore done;
+    for (std::size_t i : misses) {
+      m_pool.start([&decodeAt, &done, i]() {
+        decodeAt(i);
+        done.release();
+      });
+    }
+    done.acquire(static_cast<int>(misses.size()));
+  }
+
+  for (std::size_t i : misses) {
+    if (results[i]) {
+      m_cache.insert({sourceId, partition, batches[i].baseOffset()}, results[i]);
+    } else if (error && error->isEmpty()) {
+      *error = QStringLiteral("Batch at offset %1: %2")
+                   .arg(batches[i].baseOffset())
+                   .arg(QString::fromStdString(errors[i]));
+    }
+  }
+  return results;
+}
+
+} // namespace kafka
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QString>
+#include <QThreadPool>
+
+#include <memory>
+#include <vector>
+
+#include "core/codec/DecodedBatchCache.h"
+#include "core/protocol/RecordBatch.h"
+
+namespace kafka {
+
+/**
+ * @brief Decompresses record batches on a dedicated thread pool, backed by
+ * a byte-bounded DecodedBatchCache.
+ *
+ * decode() blocks its caller (a loader thread, never the GUI thread) while
+ * the misses of one call are inflated in parallel.
+ */
+class BatchDecoder {
+public:
+  static constexpr qint64 kDefaultCacheBytes = qint64(256) << 20;
+
+  explicit BatchDecoder(int threadCount, qint64 cacheBytes = kDefaultCacheBytes);
+  ~BatchDecoder();
+
+  BatchDecoder(const BatchDecoder &) = delete;
+  BatchDecoder &operator=(const BatchDecoder &) = delete;
+
+  /** Process-wide decoder sized to the machine. */
+  static BatchDecoder &shared();
+
+  /**
+   * @brief Returns the decoded form of each of @p batches, in order. Failed
+   * entries are null and the first failure is reported in @p error.
+   */
+  std::vector<std::shared_ptr<const DecodedBatch>>
+  decode(quint64 sourceId, qint32 partition, const std::vector<RecordBatch> &batches,
+         QString *error);
+
+  DecodedBatchCache &cache() { return m_cache; }
+
+  static std::shared_ptr<const DecodedBatch> decodeOne(const RecordBatch &batch,
+                                                       std::string *error);
+
+private:
+  QThreadPool m_pool;
+  DecodedBatchCache m_cache;
+};
+
+} // namespace kafka
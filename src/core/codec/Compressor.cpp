@@ -0,0 +1,138 @@
+#include "core/codec/Compressor.h"
+
+#include <lz4frame.h>
+#include <snappy.h>
+#include <zlib.h>
+#include <zstd.h>
+
+#include <cstdint>
+#include <utility>
+
+#include "core/checksum/Crc32c.h"
+
+namespace kafka {
+
+namespace {
+constexpr int kZstdLevel = 3;
+constexpr std::size_t kBatchLengthOffset = 8;
+
+void writeBigEndian(std::string *bytes, std::size_t position, std::uint32_t value, int size) {
+  for (int i = size - 1; i >= 0; --i) {
+    (*bytes)[position + static_cast<std::size_t>(i)] = static_cast<char>(value & 0xff);
+    value >>= 8;
+  }
+}
+
+bool gzip(std::string_view input, std::string *output, std::string *error) {
+  z_stream stream{};
+  // 16 + MAX_WBITS writes a gzip header and trailer instead of zlib's.
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    *error = "gzip: deflateInit2 failed";
+    return false;
+  }
+  const std::size_t used = output->size();
+  const uLong bound = deflateBound(&stream, static_cast<uLong>(input.size()));
+  output->resize(used + bound);
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+  stream.avail_in = static_cast<uInt>(input.size());
+  stream.next_out = reinterpret_cast<Bytef *>(&(*output)[used]);
+  stream.avail_out = static_cast<uInt>(bound);
+  const int status = deflate(&stream, Z_FINISH);
+  output->resize(used + stream.total_out);
+  deflateEnd(&stream);
+  if (status != Z_STREAM_END) {
+    output->resize(used);
+    *error = "gzip: deflate failed";
+    return false;
+  }
+  return true;
+}
+
+bool snappyBlock(std::string_view input, std::string *output) {
+  const std::size_t used = output->size();
+  output->resize(used + snappy::MaxCompressedLength(input.size()));
+  std::size_t written = 0;
+  snappy::RawCompress(input.data(), input.size(), &(*output)[used], &written);
+  output->resize(used + written);
+  return true;
+}
+
+bool lz4(std::string_view input, std::string *output, std::string *error) {
+  LZ4F_preferences_t preferences{};
+  preferences.frameInfo.contentSize = input.size();
+  const std::size_t used = output->size();
+  const std::size_t bound = LZ4F_compressFrameBound(input.size(), &preferences);
+  output->resize(used + bound);
+  const std::size_t written =
+      LZ4F_compressFrame(&(*output)[used], bound, input.data(), input.size(), &preferences);
+  if (LZ4F_isError(written)) {
+    output->resize(used);
+    *error = std::string("lz4: ") + LZ4F_getErrorName(written);
+    return false;
+  }
+  output->resize(used + written);
+  return true;
+}
+
+bool zstd(std::string_view input, std::string *output, std::string *error) {
+  const std::size_t used = output->size();
+  const std::size_t bound = ZSTD_compressBound(input.size());
+  output->resize(used + bound);
+  const std::size_t written =
+      ZSTD_compress(&(*output)[used], bound, input.data(), input.size(), kZstdLevel);
+  if (ZSTD_isError(written)) {
+    output->resize(used);
+    *error = std::string("zstd: ") + ZSTD_getErrorName(written);
+    return false;
+  }
+  output->resize(used + written);
+  return true;
+}
+} // namespace
+
+bool Compressor::compress(Compression compression, std::string_view input, std::string *output,
+                          std::string *error) {
+  switch (compression) {
+  case Compression::None:
+    output->append(input.data(), input.size());
+    return true;
+  case Compression::Gzip:
+    return gzip(input, output, error);
+  case Compression::Snappy:
+    return snappyBlock(input, output);
+  case Compression::Lz4:
+    return lz4(input, output, error);
+  case Compression::Zstd:
+    return zstd(input, output, error);
+  }
+  *error = "unknown compression codec";
+  return false;
+}
+
+bool Compressor::compressBatch(std::string_view batch, Compression compression,
+                               std::string *output, std::string *error) {
+  RecordBatch parsed;
+  if (RecordBatch::parse(batch, parsed) != ParseStatus::Ok ||
+      parsed.compression() != Compression::None) {
+    *error = "not an uncompressed v2 batch";
+    return false;
+  }
+
+  std::string bytes(batch.substr(0, RecordBatch::kHeaderSize));
+  if (!compress(compression, parsed.recordsSection(), &bytes, error))
+    return false;
+
+  const std::uint32_t attributes = (static_cast<std::uint16_t>(parsed.attributes()) & ~0x07u) |
+                                   static_cast<std::uint32_t>(compression);
+  const auto batchLength = static_cast<std::uint32_t>(bytes.size() - RecordBatch::kLogOverhead);
+  writeBigEndian(&bytes, RecordBatch::kAttributesOffset, attributes, 2);
+  writeBigEndian(&bytes, kBatchLengthOffset, batchLength, 4);
+  const std::uint32_t crc =
+      Crc32c::compute(std::string_view(bytes).substr(RecordBatch::kAttributesOffset));
+  writeBigEndian(&bytes, RecordBatch::kCrcOffset, crc, 4);
+  *output = std::move(bytes);
+  return true;
+}
+
+} // namespace kafka
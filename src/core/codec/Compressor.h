@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "core/protocol/RecordBatch.h"
+
+namespace kafka {
+
+/**
+ * @brief Deflates record sections the way Kafka producers do; the
+ * counterpart of Decompressor.
+ *
+ * Writes the formats the Java client writes, except Snappy: gzip streams,
+ * raw Snappy blocks (which every client reads), LZ4 frames and Zstandard
+ * frames with the content size recorded.
+ */
+class Compressor {
+public:
+  /**
+   * @brief Appends the compressed form of @p input to @p output. Returns
+   * false with @p error set when the codec fails.
+   */
+  static bool compress(Compression compression, std::string_view input, std::string *output,
+                       std::string *error);
+
+  /**
+   * @brief Rewrites the uncompressed v2 batch @p batch, e.g. from
+   * RecordBatchBuilder, with its record section compressed, and fixes up
+   * the attributes, length and CRC. @p batch must not be compressed yet.
+   */
+  static bool compressBatch(std::string_view batch, Compression compression, std::string *output,
+                            std::string *error);
+};
+
+} // namespace kafka
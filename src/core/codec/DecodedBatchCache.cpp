@@ -0,0 +1,54 @@
+#include "core/codec/DecodedBatchCache.h"
+
+#include <QMutexLocker>
+
+#include <limits>
+
+namespace kafka {
+
+namespace {
+// QCache counts cost in int.
+int clampCost(qint64 bytes) {
+  return static_cast<int>(qBound<qint64>(0, bytes, std::numeric_limits<int>::max()));
+}
+} // namespace
+
+DecodedBatchCache::DecodedBatchCache(qint64 maxBytes) : m_cache(clampCost(maxBytes)) {}
+
+std::shared_ptr<const DecodedBatch> DecodedBatchCache::find(const Key &key) {
+  QMutexLocker locker(&m_mutex);
+  // object() refreshes the entry's position in the LRU order.
+  if (const auto *entry = m_cache.object(key)) {
+    ++m_hits;
+    return *entry;
+  }
+  ++m_misses;
+  return nullptr;
+}
+
+void DecodedBatchCache::insert(const Key &key, std::shared_ptr<const DecodedBatch> batch) {
+  if (!batch)
+    return;
+  const int cost = clampCost(static_cast<qint64>(batch->cost()));
+  QMutexLocker locker(&m_mutex);
+  if (cost > m_cache.maxCost())
+    return;
+  m_cache.insert(key, new std::shared_ptr<const DecodedBatch>(std::move(batch)), cost);
+}
+
+void DecodedBatchCache::setMaxBytes(qint64 maxBytes) {
+  QMutexLocker locker(&m_mutex);
+  m_cache.setMaxCost(clampCost(maxBytes));
+}
+
+qint64 DecodedBatchCache::maxBytes() const {
+  QMutexLocker locker(&m_mutex);
+  return m_cache.maxCost();
+}
+
+qint64 DecodedBatchCache::totalBytes() const {
+  QMutexLocker locker(&m_mutex);
+  return m_cache.totalCost();
+}
+
+} // namespace kafka
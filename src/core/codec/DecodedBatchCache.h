@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QCache>
+#include <QMutex>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "core/protocol/RecordBatch.h"
+
+namespace kafka {
+
+/**
+ * @brief A compressed batch after decompression: a copy of its header and
+ * the inflated record section, ready for RecordReader.
+ */
+struct DecodedBatch {
+  std::string header;
+  std::string records;
+
+  RecordBatch batch() const {
+    RecordBatch parsed;
+    RecordBatch::parseHeader(header, parsed);
+    return parsed;
+  }
+  std::size_t cost() const { return sizeof(*this) + header.capacity() + records.capacity(); }
+};
+
+/**
+ * @brief Thread-safe LRU of decoded batches bounded by their size in
+ * bytes, so scrolling back over a range never inflates it twice.
+ */
+class DecodedBatchCache {
+public:
+  struct Key {
+    quint64 sourceId = 0;
+    qint32 partition = 0;
+    qint64 baseOffset = 0;
+
+    bool operator==(const Key &other) const {
+      return sourceId == other.sourceId && partition == other.partition &&
+             baseOffset == other.baseOffset;
+    }
+  };
+
+  explicit DecodedBatchCache(qint64 maxBytes);
+
+  std::shared_ptr<const DecodedBatch> find(const Key &key);
+  /** Batches larger than the whole budget are not cached. */
+  void insert(const Key &key, std::shared_ptr<const DecodedBatch> batch);
+
+  void setMaxBytes(qint64 maxBytes);
+  qint64 maxBytes() const;
+  qint64 totalBytes() const;
+  quint64 hits() const { return m_hits.load(); }
+  quint64 misses() const { return m_misses.load(); }
+
+private:
+  mutable QMutex m_mutex;
+  // QCache deletes entries on eviction; the shared_ptr keeps a batch alive
+  // for readers that still hold it.
+  QCache<Key, std::shared_ptr<const DecodedBatch>> m_cache;
+  std::atomic<quint64> m_hits{0};
+  std::atomic<quint64> m_misses{0};
+};
+
+inline uint qHash(const DecodedBatchCache::Key &key, uint seed = 0) {
+  return qHash(key.sourceId, seed) ^ qHash(key.partition, seed) ^
+         qHash(key.baseOffset, seed + 0x9e3779b9u);
+}
+
+} // namespace kafka
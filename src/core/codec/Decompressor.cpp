@@ -0,0 +1,216 @@
+#include "core/codec/Decompressor.h"
+
+#include <lz4frame.h>
+#include <snappy.h>
+#include <zlib.h>
+#include <zstd.h>
+
+#include <algorithm>
+
+#include "core/protocol/Wire.h"
+#include "core/trace/Trace.h"
+
+namespace kafka {
+
+namespace {
+constexpr std::size_t kGrowStep = 64 * 1024;
+// Refuse to inflate past this; a corrupt length must not exhaust memory.
+constexpr std::size_t kMaxOutput = std::size_t(1) << 30;
+
+constexpr std::string_view kXerialMagic("\x82SNAPPY\0", 8);
+constexpr std::size_t kXerialHeaderSize = 16; // magic + version + compatible version
+
+// Grows @p output by up to kGrowStep and returns the writable tail.
+char *growTail(std::string *output, std::size_t *available) {
+  const std::size_t used = output->size();
+  output->resize(used + kGrowStep);
+  *available = kGrowStep;
+  return &(*output)[used];
+}
+} // namespace
+
+bool Decompressor::decompress(Compression compression, std::string_view input,
+                              std::string *output, std::string *error) {
+  KAFKA_TRACE_SCOPE("decompress");
+  switch (compression) {
+  case Compression::None:
+    output->append(input.data(), input.size());
+    return true;
+  case Compression::Gzip:
+    return gunzip(input, output, error);
+  case Compression::Snappy:
+    return unsnappy(input, output, error);
+  case Compression::Lz4:
+    return unlz4(input, output, error);
+  case Compression::Zstd:
+    return unzstd(input, output, error);
+  }
+  *error = "unknown compression codec";
+  return false;
+}
+
+bool Decompressor::gunzip(std::string_view input, std::string *output, std::string *error) {
+  z_stream stream{};
+  // 32 + MAX_WBITS accepts gzip and zlib headers alike.
+  if (inflateInit2(&stream, 32 + MAX_WBITS) != Z_OK) {
+    *error = "gzip: inflateInit2 failed";
+    return false;
+  }
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+  stream.avail_in = static_cast<uInt>(input.size());
+
+  const std::size_t start = output->size();
+  int status = Z_OK;
+  while (status != Z_STREAM_END) {
+    std::size_t available = 0;
+    char *tail = growTail(output, &available);
+    stream.next_out = reinterpret_cast<Bytef *>(tail);
+    stream.avail_out = static_cast<uInt>(available);
+    status = inflate(&stream, Z_NO_FLUSH);
+    output->resize(output->size() - stream.avail_out);
+    if (status != Z_OK && status != Z_STREAM_END) {
+      *error = std::string("gzip: ") + (stream.msg ? stream.msg : "corrupt stream");
+      break;
+    }
+    if (status == Z_OK && stream.avail_in == 0 && stream.avail_out != 0) {
+      *error = "gzip: truncated stream";
+      break;
+    }
+    if (output->size() - start > kMaxOutput) {
+      *error = "gzip: output too large";
+      break;
+    }
+  }
+  inflateEnd(&stream);
+  return status == Z_STREAM_END;
+}
+
+bool Decompressor::unsnappy(std::string_view input, std::string *output, std::string *error) {
+  auto uncompressBlock = [&](std::string_view block) {
+    std::size_t length = 0;
+    if (!snappy::GetUncompressedLength(block.data(), block.size(), &length) ||
+        length > kMaxOutput) {
+      *error = "snappy: corrupt block header";
+      return false;
+    }
+    const std::size_t used = output->size();
+    output->resize(used + length);
+    if (!snappy::RawUncompress(block.data(), block.size(), &(*output)[used])) {
+      *error = "snappy: corrupt block";
+      return false;
+    }
+    return true;
+  };
+
+  if (input.substr(0, kXerialMagic.size()) != kXerialMagic)
+    return uncompressBlock(input);
+
+  // xerial framing: a 16-byte header, then (int32 length, block) pairs.
+  WireReader reader(input.substr(std::min(input.size(), kXerialHeaderSize)));
+  while (!reader.atEnd()) {
+    const std::int32_t length = reader.readInt32();
+    if (!reader.ok() || length < 0 || static_cast<std::size_t>(length) > reader.remaining()) {
+      *error = "snappy: truncated xerial block";
+      return false;
+    }
+    if (!uncompressBlock(reader.readRaw(static_cast<std::size_t>(length))))
+      return false;
+  }
+  return true;
+}
+
+bool Decompressor::unlz4(std::string_view input, std::string *output, std::string *error) {
+  LZ4F_dctx *context = nullptr;
+  if (LZ4F_isError(LZ4F_createDecompressionContext(&context, LZ4F_VERSION))) {
+    *error = "lz4: cannot create context";
+    return false;
+  }
+
+  const std::size_t start = output->size();
+  const char *in = input.data();
+  std::size_t remaining = input.size();
+  bool ok = true;
+  for (;;) {
+    std::size_t available = 0;
+    char *tail = growTail(output, &available);
+    std::size_t consumed = remaining;
+    const std::size_t hint = LZ4F_decompress(context, tail, &available, in, &consumed, nullptr);
+    output->resize(output->size() - kGrowStep + available);
+    if (LZ4F_isError(hint)) {
+      *error = std::string("lz4: ") + LZ4F_getErrorName(hint);
+      ok = false;
+      break;
+    }
+    in += consumed;
+    remaining -= consumed;
+    if (hint == 0)
+      break;
+    if (consumed == 0 && available == 0) {
+      *error = "lz4: truncated frame";
+      ok = false;
+      break;
+    }
+    if (output->size() - start > kMaxOutput) {
+      *error = "lz4: output too large";
+      ok = false;
+      break;
+    }
+  }
+  LZ4F_freeDecompressionContext(context);
+  return ok;
+}
+
+bool Decompressor::unzstd(std::string_view input, std::string *output, std::string *error) {
+  // Producers usually record the content size; decode in one call then.
+  const unsigned long long contentSize = ZSTD_getFrameContentSize(input.data(), input.size());
+  if (contentSize != ZSTD_CONTENTSIZE_UNKNOWN && contentSize != ZSTD_CONTENTSIZE_ERROR &&
+      contentSize <= kMaxOutput) {
+    const std::size_t used = output->size();
+    output->resize(used + static_cast<std::size_t>(contentSize));
+    const std::size_t written = ZSTD_decompress(
+        &(*output)[used], static_cast<std::size_t>(contentSize), input.data(), input.size());
+    if (ZSTD_isError(written)) {
+      output->resize(used);
+      *error = std::string("zstd: ") + ZSTD_getErrorName(written);
+      return false;
+    }
+    output->resize(used + written);
+    return true;
+  }
+
+  ZSTD_DCtx *context = ZSTD_createDCtx();
+  if (!context) {
+    *error = "zstd: cannot create context";
+    return false;
+  }
+  const std::size_t start = output->size();
+  ZSTD_inBuffer in{input.data(), input.size(), 0};
+  bool ok = true;
+  std::size_t hint = 1;
+  while (in.pos < in.size || hint != 0) {
+    std::size_t available = 0;
+    char *tail = growTail(output, &available);
+    ZSTD_outBuffer out{tail, available, 0};
+    hint = ZSTD_decompressStream(context, &out, &in);
+    output->resize(output->size() - available + out.pos);
+    if (ZSTD_isError(hint)) {
+      *error = std::string("zstd: ") + ZSTD_getErrorName(hint);
+      ok = false;
+      break;
+    }
+    if (in.pos == in.size && out.pos == 0 && hint != 0) {
+      *error = "zstd: truncated frame";
+      ok = false;
+      break;
+    }
+    if (output->size() - start > kMaxOutput) {
+      *error = "zstd: output too large";
+      ok = false;
+      break;
+    }
+  }
+  ZSTD_freeDCtx(context);
+  return ok;
+}
+
+} // namespace kafka
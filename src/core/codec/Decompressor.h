@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "core/protocol/RecordBatch.h"
+
+namespace kafka {
+
+/**
+ * @brief Inflates the record section of compressed batches.
+ *
+ * Handles the container formats Kafka clients actually write: gzip
+ * streams, Snappy either raw or in xerial blocks (the Java client), LZ4
+ * frames and Zstandard frames, including frames without a content size.
+ */
+class Decompressor {
+public:
+  /**
+   * @brief Appends the uncompressed form of @p input to @p output. Returns
+   * false with @p error set for corrupt input or an unknown codec.
+   */
+  static bool decompress(Compression compression, std::string_view input, std::string *output,
+                         std::string *error);
+
+private:
+  static bool gunzip(std::string_view input, std::string *output, std::string *error);
+  static bool unsnappy(std::string_view input, std::string *output, std::string *error);
+  static bool unlz4(std::string_view input, std::string *output, std::string *error);
+  static bool unzstd(std::string_view input, std::string *output, std::string *error);
+};
+
+} // namespace kafka
@@ -0,0 +1,189 @@
+#include "core/correlate/CorrelationScan.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/protocol/RecordBatch.h"
+#include "core/scan/BatchWalk.h"
+#include "core/stats/Sketches.h"
+
+namespace kafka {
+
+namespace {
+// A power of two; shards are picked by the top bits of the value's hash.
+constexpr int kShardBits = 6;
+
+// Everything known about one correlation value.
+struct Group {
+  std::string value;
+  // Bit i is set once the value was seen in target i.
+  quint64 targets = 0;
+  bool joined = false;
+  // Records kept until the value joins; empty afterwards.
+  std::vector<CorrelationHit> held;
+};
+
+// One lock per shard, so workers only contend when their values hash to
+// the same shard. Hashes are kept in the map and values compared on
+// lookup, which finds a group without building a string per record.
+struct Shard {
+  QMutex mutex;
+  std::unordered_multimap<quint64, Group> groups;
+};
+
+int popCount(quint64 bits) {
+  int count = 0;
+  for (; bits != 0; bits &= bits - 1)
+    ++count;
+  return count;
+}
+} // namespace
+
+// The join table shared by the workers of one scan.
+struct CorrelationScan::Table {
+  int minTopics = 2;
+  std::array<Shard, 1 << kShardBits> shards;
+  // Records and values held by the table.
+  std::atomic<int> held{0};
+
+  // Adds @p hit to its value's group; appends to @p out whatever the
+  // group releases. Returns false once the table is full.
+  bool join(std::string_view value, CorrelationHit hit, QVector<CorrelationHit> *out) {
+    const quint64 hash = sketchHash(value);
+    Shard &shard = shards[static_cast<std::size_t>(hash >> (64 - kShardBits))];
+    const quint64 targetBit = quint64(1) << hit.target;
+
+    QMutexLocker locker(&shard.mutex);
+    Group *group = nullptr;
+    const auto range = shard.groups.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.value == value) {
+        group = &it->second;
+        break;
+      }
+    }
+    if (!group) {
+      group = &shard.groups.emplace(hash, Group())->second;
+      group->value.assign(value.data(), value.size());
+      ++held;
+    }
+
+    group->targets |= targetBit;
+    if (group->joined) {
+      out->append(std::move(hit));
+      return true;
+    }
+    group->held.push_back(std::move(hit));
+    if (popCount(group->targets) < minTopics)
+      return held.fetch_add(1) + 1 < kMaxHeldRecords;
+    group->joined = true;
+    held -= static_cast<int>(group->held.size()) - 1;
+    for (CorrelationHit &released : group->held)
+      out->append(std::move(released));
+    std::vector<CorrelationHit>().swap(group->held);
+    return true;
+  }
+};
+
+class CorrelationScan::Worker final : public SliceScan::Worker {
+public:
+  Worker(CorrelationScan *owner, const CorrelationRequest &request, std::shared_ptr<Table> table)
+      : m_owner(owner), m_field(request.field), m_header(request.header),
+        m_wanted(request.value), m_table(std::move(table)) {}
+
+  bool add(int target, qint32 partition, const Record &record) override {
+    const std::string_view value = correlationValue(record);
+    if (value.empty() || (!m_wanted.isEmpty() && value != view(m_wanted)))
+      return true;
+
+    CorrelationHit hit;
+    hit.target = target;
+    hit.partition = partition;
+    hit.offset = record.offset;
+    hit.timestamp = record.timestamp;
+    hit.value = copyOf(value, value.size());
+    hit.preview = copyOf(record.value, kMaxPreviewBytes);
+    hit.previewTruncated = record.value.size() > static_cast<std::size_t>(kMaxPreviewBytes);
+    // A value that needs no partner is reported straight away.
+    if (m_table->minTopics <= 1) {
+      m_pending.append(std::move(hit));
+      return true;
+    }
+    return m_table->join(value, std::move(hit), &m_pending);
+  }
+
+  std::function<void()> take() override {
+    if (m_pending.isEmpty())
+      return nullptr;
+    return [owner = m_owner, hits = std::exchange(m_pending, {})]() {
+      owner->m_hitCount += hits.size();
+      emit owner->hitsFound(hits);
+    };
+  }
+
+private:
+  static std::string_view view(const QByteArray &bytes) {
+    return std::string_view(bytes.constData(), static_cast<std::size_t>(bytes.size()));
+  }
+
+  std::string_view correlationValue(const Record &record) const {
+    if (m_field == CorrelationRequest::Key)
+      return record.key;
+    HeaderReader headers(record);
+    RecordHeader entry;
+    while (headers.next(entry)) {
+      if (entry.key == view(m_header))
+        return entry.value;
+    }
+    return std::string_view();
+  }
+
+  CorrelationScan *m_owner;
+  const CorrelationRequest::Field m_field;
+  const QByteArray m_header;
+  const QByteArray m_wanted;
+  std::shared_ptr<Table> m_table;
+  QVector<CorrelationHit> m_pending;
+};
+
+CorrelationScan::CorrelationScan(QObject *parent)
+    : QObject(parent),
+      m_scan(
+          this, QStringLiteral("kafka-correlate"), "correlate worker",
+          [this](qint64 scanned, qint64 total) { emit progressChanged(scanned, total); },
+          [this]() { emit finished(); }) {}
+
+void CorrelationScan::start(const CorrelationRequest &request) {
+  cancel();
+  if (request.targets.isEmpty() || request.targets.size() > kMaxTargets)
+    return;
+  if (request.field == CorrelationRequest::Header && request.header.isEmpty())
+    return;
+
+  m_request = request;
+  m_request.minTopics = qBound(1, request.minTopics, request.targets.size());
+  m_hitCount = 0;
+
+  SliceScan::Request scan;
+  for (const CorrelationTarget &target : request.targets)
+    scan.targets.append({target.topic, target.source, target.partitions});
+  scan.from = request.from;
+  scan.to = request.to;
+  auto table = std::make_shared<Table>();
+  table->minTopics = m_request.minTopics;
+  m_scan.start(std::move(scan), [this, request = m_request, table]() {
+    return std::make_unique<Worker>(this, request, table);
+  });
+}
+
+void CorrelationScan::cancel() { m_scan.cancel(); }
+
+} // namespace kafka
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+#include "core/scan/SliceScan.h"
+
+namespace kafka {
+
+class BatchSource;
+
+/** One topic taking part in a CorrelationScan. */
+struct CorrelationTarget {
+  QString topic;
+  std::shared_ptr<BatchSource> source;
+  QVector<qint32> partitions;
+};
+
+/**
+ * @brief What a CorrelationScan joins on and where it looks.
+ *
+ * Records are correlated by their key or by the value of the header named
+ * @c header. With a @c value, only records carrying exactly that value are
+ * kept; without one, every value is joined and reported once it occurs in
+ * at least @c minTopics of the targets. @c from and @c to bound every
+ * partition by timestamp in ms since the epoch; -1 stands for the
+ * partition's start or end.
+ */
+struct CorrelationRequest {
+  enum Field {
+    Key,
+    Header,
+  };
+
+  QVector<CorrelationTarget> targets;
+  Field field = Header;
+  QByteArray header;
+  QByteArray value;
+  int minTopics = 2;
+  qint64 from = -1;
+  qint64 to = -1;
+};
+
+/**
+ * @brief A record sharing its correlation value with records of other
+ * topics. A null preview means a null record value.
+ */
+struct CorrelationHit {
+  /** Index into CorrelationRequest::targets. */
+  int target = 0;
+  qint32 partition = 0;
+  qint64 offset = 0;
+  qint64 timestamp = 0;
+  QByteArray value;
+  QByteArray preview;
+  bool previewTruncated = false;
+};
+
+/**
+ * @brief Finds the records of several topics that share a key or header
+ * value, in one parallel pass.
+ *
+ * Every partition of every target is read on one SliceScan, as in
+ * TopicSearch. Workers join as they read: each value goes into a hash table split into shards with a lock of
+ * their own, which records the topics the value was seen in and holds its
+ * records until it occurs in enough of them. From then on the value's
+ * records, the held ones first, stream out through hitsFound(); values
+ * that never join are dropped with the table at the end.
+ *
+ * The table stops growing at kMaxHeldRecords records; the scan then ends
+ * early with limitReached().
+ */
+class CorrelationScan final : public QObject {
+  Q_OBJECT
+
+public:
+  static constexpr int kMaxHeldRecords = 500000;
+  static constexpr int kMaxPreviewBytes = 256;
+  /** Topics are tracked in a 64-bit mask per value. */
+  static constexpr int kMaxTargets = 64;
+
+  explicit CorrelationScan(QObject *parent = nullptr);
+
+  void start(const CorrelationRequest &request);
+  void cancel();
+
+  bool isRunning() const { return m_scan.isRunning(); }
+  const CorrelationRequest &request() const { return m_request; }
+  /** Records reported so far. */
+  int hitCount() const { return m_hitCount; }
+  /** Valid after finished(). */
+  bool wasCancelled() const { return m_scan.wasCancelled(); }
+  bool limitReached() const { return m_scan.stoppedByWorker(); }
+  QString errorString() const { return m_scan.errorString(); }
+  /** Compressed batches that could not be inflated and were skipped. */
+  qint64 skippedBatches() const { return m_scan.skippedBatches(); }
+
+signals:
+  void hitsFound(const QVector<kafka::CorrelationHit> &hits);
+  /** Offsets scanned so far out of @p total across all partitions. */
+  void progressChanged(qint64 scanned, qint64 total);
+  void finished();
+
+private:
+  class Worker;
+  struct Table;
+
+  CorrelationRequest m_request;
+  int m_hitCount = 0;
+  // Last, so the workers stop before anything else goes.
+  SliceScan m_scan;
+};
+
+} // namespace kafka
@@ -0,0 +1,662 @@
+#include "core/export/TopicExport.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSemaphore>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <zstd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "core/codec/DecodedBatchCache.h"
+#include "core/protocol/RecordBatch.h"
+#include "core/scan/BatchWalk.h"
+#include "core/source/BatchSource.h"
+#include "core/trace/Trace.h"
+
+namespace kafka {
+
+namespace {
+constexpr int kMaxWorkers = 8;
+// Blocks alive per worker: one being formatted and one queued for it or
+// for the writer. Bounds memory at roughly this many chunks, inflated.
+constexpr int kBlocksPerWorker = 2;
+constexpr std::size_t kWriteChunk = std::size_t(4) << 20;
+constexpr int kPostIntervalMs = 100;
+constexpr int kZstdLevel = 3;
+// Lets the reader notice a stop while it waits for a free block.
+constexpr int kWaitSliceMs = 100;
+
+struct PartitionRange {
+  qint32 partition = 0;
+  qint64 start = 0;
+  qint64 end = 0;
+};
+
+bool isValidUtf8(std::string_view text) {
+  const auto *bytes = reinterpret_cast<const unsigned char *>(text.data());
+  const std::size_t size = text.size();
+  std::size_t i = 0;
+  while (i < size) {
+    const unsigned char lead = bytes[i];
+    if (lead < 0x80) {
+      ++i;
+      continue;
+    }
+    std::size_t length = 0;
+    unsigned int codePoint = 0;
+    if ((lead & 0xe0) == 0xc0) {
+      length = 2;
+      codePoint = lead & 0x1fu;
+    } else if ((lead & 0xf0) == 0xe0) {
+      length = 3;
+      codePoint = lead & 0x0fu;
+    } else if ((lead & 0xf8) == 0xf0) {
+      length = 4;
+      codePoint = lead & 0x07u;
+    } else {
+      return false;
+    }
+    if (i + length > size)
+      return false;
+    for (std::size_t k = 1; k < length; ++k) {
+      if ((bytes[i + k] & 0xc0) != 0x80)
+        return false;
+      codePoint = (codePoint << 6) | (bytes[i + k] & 0x3fu);
+    }
+    // Overlong forms, surrogates and values past U+10FFFF.
+    const unsigned int minimum = length == 2 ? 0x80u : length == 3 ? 0x800u : 0x10000u;
+    if (codePoint < minimum || codePoint > 0x10ffff ||
+        (codePoint >= 0xd800 && codePoint <= 0xdfff))
+      return false;
+    i += length;
+  }
+  return true;
+}
+
+void appendBase64(std::string &out, std::string_view bytes) {
+  static constexpr char kAlphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  const auto *data = reinterpret_cast<const unsigned char *>(bytes.data());
+  std::size_t i = 0;
+  for (; i + 3 <= bytes.size(); i += 3) {
+    const unsigned int triple = (static_cast<unsigned int>(data[i]) << 16) |
+                                (static_cast<unsigned int>(data[i + 1]) << 8) | data[i + 2];
+    out += kAlphabet[(triple >> 18) & 0x3f];
+    out += kAlphabet[(triple >> 12) & 0x3f];
+    out += kAlphabet[(triple >> 6) & 0x3f];
+    out += kAlphabet[triple & 0x3f];
+  }
+  const std::size_t rest = bytes.size() - i;
+  if (rest == 0)
+    return;
+  unsigned int triple = static_cast<unsigned int>(data[i]) << 16;
+  if (rest == 2)
+    triple |= static_cast<unsigned int>(data[i + 1]) << 8;
+  out += kAlphabet[(triple >> 18) & 0x3f];
+  out += kAlphabet[(triple >> 12) & 0x3f];
+  out += rest == 2 ? kAlphabet[(triple >> 6) & 0x3f] : '=';
+  out += '=';
+}
+
+void appendInteger(std::string &out, qint64 value) {
+  char digits[24];
+  const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+  out.append(digits, static_cast<std::size_t>(result.ptr - digits));
+}
+
+// @p text must be valid UTF-8; it is copied through except for what JSON
+// requires escaped.
+void appendJsonString(std::string &out, std::string_view text) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  out += '"';
+  std::size_t run = 0;
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    const auto ch = static_cast<unsigned char>(text[i]);
+    if (ch >= 0x20 && ch != '"' && ch != '\\')
+      continue;
+    out.append(text.data() + run, i - run);
+    run = i + 1;
+    switch (ch) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      out += "\\u00";
+      out += kHex[ch >> 4];
+      out += kHex[ch & 0x0f];
+    }
+  }
+  out.append(text.data() + run, text.size() - run);
+  out += '"';
+}
+
+// Writes "name":value, null or base64 with a "nameEncoding" marker.
+void appendJsonBytes(std::string &out, std::string_view name, std::string_view bytes) {
+  out += '"';
+  out += name;
+  out += "\":";
+  if (!bytes.data()) {
+    out += "null";
+  } else if (isValidUtf8(bytes)) {
+    appendJsonString(out, bytes);
+  } else {
+    out += '"';
+    appendBase64(out, bytes);
+    out += "\",\"";
+    out += name;
+    out += "Encoding\":\"base64\"";
+  }
+}
+
+void appendJsonHeaders(std::string &out, const Record &record) {
+  out += '[';
+  HeaderReader headers(record);
+  RecordHeader header;
+  bool first = true;
+  while (headers.next(header)) {
+    if (!first)
+      out += ',';
+    first = false;
+    out += '{';
+    appendJsonBytes(out, "key", header.key);
+    out += ',';
+    appendJsonBytes(out, "value", header.value);
+    out += '}';
+  }
+  out += ']';
+}
+
+void appendCsvField(std::string &out, std::string_view text) {
+  if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+    out += text;
+    return;
+  }
+  out += '"';
+  std::size_t run = 0;
+  for (std::size_t quote = text.find('"'); quote != std::string_view::npos;
+       quote = text.find('"', quote + 1)) {
+    out.append(text.data() + run, quote + 1 - run);
+    out += '"';
+    run = quote + 1;
+  }
+  out.append(text.data() + run, text.size() - run);
+  out += '"';
+}
+
+void appendCsvBytes(std::string &out, std::string_view bytes) {
+  if (!bytes.data())
+    return;
+  if (isValidUtf8(bytes)) {
+    appendCsvField(out, bytes);
+    return;
+  }
+  out += "base64:";
+  appendBase64(out, bytes);
+}
+
+void appendRecord(std::string &out, ExportRequest::Format format, qint32 partition,
+                  const Record &record, std::string &scratch) {
+  if (format == ExportRequest::JsonLines) {
+    out += "{\"partition\":";
+    appendInteger(out, partition);
+    out += ",\"offset\":";
+    appendInteger(out, record.offset);
+    out += ",\"timestamp\":";
+    appendInteger(out, record.timestamp);
+    out += ',';
+    appendJsonBytes(out, "key", record.key);
+    out += ',';
+    appendJsonBytes(out, "value", record.value);
+    out += ",\"headers\":";
+    appendJsonHeaders(out, record);
+    out += "}\n";
+    return;
+  }
+
+  appendInteger(out, partition);
+  out += ',';
+  appendInteger(out, record.offset);
+  out += ',';
+  appendInteger(out, record.timestamp);
+  out += ',';
+  appendCsvBytes(out, record.key);
+  out += ',';
+  appendCsvBytes(out, record.value);
+  out += ',';
+  if (record.headerCount > 0) {
+    scratch.clear();
+    appendJsonHeaders(scratch, record);
+    appendCsvField(out, scratch);
+  }
+  out += "\r\n";
+}
+
+/**
+ * Buffers the output and hands it to the file in kWriteChunk pieces,
+ * compressing on the way when asked to.
+ */
+class OutputStream {
+public:
+  OutputStream(QSaveFile *file, bool zstd) : m_file(file) {
+    if (zstd) {
+      m_zstd = ZSTD_createCCtx();
+      if (m_zstd)
+        ZSTD_CCtx_setParameter(m_zstd, ZSTD_c_compressionLevel, kZstdLevel);
+    }
+    m_buffer.reserve(kWriteChunk + ZSTD_CStreamOutSize());
+  }
+  ~OutputStream() { ZSTD_freeCCtx(m_zstd); }
+
+  OutputStream(const OutputStream &) = delete;
+  OutputStream &operator=(const OutputStream &) = delete;
+
+  bool isValid(bool zstd) const { return !zstd || m_zstd; }
+  qint64 written() const { return m_written; }
+
+  bool append(std::string_view data) { return feed(data, ZSTD_e_continue); }
+
+  bool finish() { return feed({}, ZSTD_e_end) && flush(); }
+
+private:
+  bool feed(std::string_view data, ZSTD_EndDirective mode) {
+    if (!m_zstd) {
+      m_buffer += data;
+      return m_buffer.size() < kWriteChunk || flush();
+    }
+    ZSTD_inBuffer in{data.data(), data.size(), 0};
+    for (;;) {
+      const std::size_t used = m_buffer.size();
+      m_buffer.resize(used + ZSTD_CStreamOutSize());
+      ZSTD_outBuffer out{&m_buffer[used], ZSTD_CStreamOutSize(), 0};
+      const std::size_t remaining = ZSTD_compressStream2(m_zstd, &out, &in, mode);
+      m_buffer.resize(used + out.pos);
+      if (ZSTD_isError(remaining))
+        return false;
+      if (m_buffer.size() >= kWriteChunk && !flush())
+        return false;
+      const bool drained = mode == ZSTD_e_end ? remaining == 0 : in.pos == in.size;
+      if (drained)
+        return true;
+    }
+  }
+
+  bool flush() {
+    if (m_buffer.empty())
+      return true;
+    const auto size = static_cast<qint64>(m_buffer.size());
+    if (m_file->write(m_buffer.data(), size) != size)
+      return false;
+    m_written += size;
+    m_buffer.clear();
+    return true;
+  }
+
+  QSaveFile *m_file = nullptr;
+  ZSTD_CCtx *m_zstd = nullptr;
+  std::string m_buffer;
+  qint64 m_written = 0;
+};
+} // namespace
+
+struct TopicExport::Block {
+  quint64 sequence = 0;
+  qint32 partition = 0;
+  // Records in [from, end) of the chunk belong to the export.
+  qint64 from = 0;
+  qint64 end = 0;
+  BatchChunk chunk;
+
+  std::string text;
+  qint64 records = 0;
+  qint64 skippedBatches = 0;
+};
+
+struct TopicExport::Run {
+  TopicExport *owner = nullptr;
+  quint64 generation = 0;
+  std::shared_ptr<BatchSource> source;
+  ExportRequest request;
+
+  QSemaphore freeBlocks;
+  std::atomic<bool> stop{false};
+  std::atomic<bool> cancelled{false};
+  std::atomic<qint64> total{0};
+  std::atomic<qint64> done{0};
+  std::atomic<qint64> records{0};
+  std::atomic<qint64> bytesWritten{0};
+  std::atomic<qint64> skippedBatches{0};
+
+  // Guards the fields below; ready is signalled whenever one changes.
+  QMutex mutex;
+  QWaitCondition ready;
+  std::map<quint64, std::shared_ptr<Block>> formatted;
+  quint64 blockCount = 0;
+  bool readerDone = false;
+  QString error;
+
+  void halt() {
+    stop.store(true);
+    QMutexLocker locker(&mutex);
+    ready.wakeAll();
+  }
+
+  void fail(const QString &message) {
+    {
+      QMutexLocker locker(&mutex);
+      if (error.isEmpty())
+        error = message;
+    }
+    halt();
+  }
+};
+
+TopicExport::TopicExport(QObject *parent) : QObject(parent) {
+  m_pool.setObjectName(QStringLiteral("kafka-export"));
+  // The reader and the writer hold a thread each for the whole export.
+  m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), kMaxWorkers) + 2);
+}
+
+// Stops the pipeline without cancel(), which would emit finished() to
+// receivers that may already be half destroyed.
+TopicExport::~TopicExport() {
+  if (m_run) {
+    m_run->cancelled.store(true);
+    m_run->halt();
+  }
+  m_pool.waitForDone();
+}
+
+void TopicExport::start(std::shared_ptr<BatchSource> source, const ExportRequest &request) {
+  cancel();
+  if (!source || request.partitions.isEmpty() || request.path.isEmpty())
+    return;
+
+  auto run = std::make_shared<Run>();
+  run->owner = this;
+  run->generation = ++m_generation;
+  run->source = std::move(source);
+  run->request = request;
+  run->freeBlocks.release((m_pool.maxThreadCount() - 2) * kBlocksPerWorker);
+
+  m_run = run;
+  m_running = true;
+  m_cancelled = false;
+  m_records = 0;
+  m_bytesWritten = 0;
+  m_skippedBatches = 0;
+  m_error.clear();
+  emit progressChanged(0, 0);
+
+  m_pool.start([run]() { read(run); });
+  m_pool.start([run]() { write(run); });
+}
+
+void TopicExport::cancel() {
+  if (!m_run)
+    return;
+  m_run->cancelled.store(true);
+  m_run->halt();
+  // Bumping the generation drops whatever the old run still posts.
+  ++m_generation;
+  const std::shared_ptr<Run> run = std::move(m_run);
+  if (m_running) {
+    m_running = false;
+    m_cancelled = true;
+    emit finished();
+  }
+}
+
+// Runs on the pool: resolves the ranges, which may block on the network,
+// then reads them chunk by chunk in order and hands each chunk to a
+// formatting task as soon as a block is free.
+void TopicExport::read(const std::shared_ptr<Run> &run) {
+  KAFKA_TRACE_SCOPE("export reader");
+  const ExportRequest &request = run->request;
+  std::vector<PartitionRange> ranges;
+  for (qint32 partition : request.partitions) {
+    OffsetRange range;
+    QString error;
+    bool ok = run->source->offsetRange(partition, &range, &error);
+    qint64 start = range.start;
+    qint64 end = range.end;
+    if (ok && request.byTime) {
+      if (request.from >= 0)
+        ok = run->source->offsetForTimestamp(partition, request.from, &start, &error);
+      if (ok && request.to >= 0)
+        ok = run->source->offsetForTimestamp(partition, request.to, &end, &error);
+    } else if (ok) {
+      if (request.from >= 0)
+        start = request.from;
+      if (request.to >= 0)
+        end = request.to;
+    }
+    if (!ok) {
+      run->fail(QStringLiteral("Partition %1: %2").arg(partition).arg(error));
+      break;
+    }
+    start = qBound(range.start, start, range.end);
+    end = qBound(start, end, range.end);
+    ranges.push_back({partition, start, end});
+    run->total += end - start;
+  }
+
+  quint64 sequence = 0;
+  for (const PartitionRange &range : ranges) {
+    BatchWalk walk(*run->source, range.partition, range.start, range.end);
+    while (!run->stop.load()) {
+      while (!run->freeBlocks.tryAcquire(1, kWaitSliceMs)) {
+        if (run->stop.load())
+          break;
+      }
+      if (run->stop.load())
+        break;
+
+      // Only the headers are looked at here; the workers do the rest.
+      QString error;
+      if (!walk.nextChunk(&error)) {
+        run->freeBlocks.release();
+        if (walk.failed())
+          run->fail(QStringLiteral("Partition %1: %2").arg(range.partition).arg(error));
+        break;
+      }
+
+      auto block = std::make_shared<Block>();
+      block->chunk = walk.chunk();
+      block->sequence = sequence++;
+      block->partition = range.partition;
+      block->from = walk.chunkStart();
+      block->end = walk.position();
+      {
+        QMutexLocker locker(&run->mutex);
+        ++run->blockCount;
+      }
+      run->owner->m_pool.start([run, block]() { format(run, block); });
+    }
+    if (run->stop.load())
+      break;
+  }
+
+  QMutexLocker locker(&run->mutex);
+  run->readerDone = true;
+  run->ready.wakeAll();
+}
+
+void TopicExport::format(const std::shared_ptr<Run> &run, const std::shared_ptr<Block> &block) {
+  KAFKA_TRACE_SCOPE("export format");
+  const ExportRequest::Format format = run->request.format;
+  std::string scratch;
+  BatchReader batches(block->chunk.bytes);
+  RecordBatch batch;
+  while (!run->stop.load() && batches.next(batch) == ParseStatus::Ok) {
+    if (batch.nextOffset() <= block->from)
+      continue;
+    if (batch.baseOffset() >= block->end)
+      break;
+    if (batch.isControl())
+      continue;
+
+    std::shared_ptr<const DecodedBatch> decoded;
+    std::string_view section;
+    if (!recordsOf(batch, &decoded, &section)) {
+      ++block->skippedBatches;
+      continue;
+    }
+    if (block->text.empty())
+      block->text.reserve(section.size() * 5 / 4);
+
+    RecordReader records(batch, section);
+    Record record;
+    while (records.next(record)) {
+      if (record.offset < block->from)
+        continue;
+      if (record.offset >= block->end)
+        break;
+      appendRecord(block->text, format, block->partition, record, scratch);
+      ++block->records;
+    }
+  }
+  // The fetched bytes are not needed any more; only the text waits.
+  block->chunk = BatchChunk();
+
+  QMutexLocker locker(&run->mutex);
+  run->formatted.emplace(block->sequence, block);
+  run->ready.wakeAll();
+}
+
+// Runs on the pool for the whole export: writes the blocks in reading
+// order and frees each one for the reader once written.
+void TopicExport::write(const std::shared_ptr<Run> &run) {
+  KAFKA_TRACE_SCOPE("export writer");
+  const ExportRequest &request = run->request;
+  QSaveFile file(request.path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    run->fail(QStringLiteral("Cannot write %1: %2").arg(request.path, file.errorString()));
+    run->owner->finish(run);
+    return;
+  }
+  OutputStream output(&file, request.zstd);
+  if (!output.isValid(request.zstd)) {
+    run->fail(QStringLiteral("Cannot create a zstd compressor"));
+    run->owner->finish(run);
+    return;
+  }
+
+  bool ok = true;
+  if (request.format == ExportRequest::Csv)
+    ok = output.append("partition,offset,timestamp,key,value,headers\r\n");
+
+  QElapsedTimer sincePost;
+  sincePost.start();
+  quint64 next = 0;
+  while (ok) {
+    std::shared_ptr<Block> block;
+    {
+      QMutexLocker locker(&run->mutex);
+      for (;;) {
+        if (run->stop.load())
+          break;
+        const auto it = run->formatted.find(next);
+        if (it != run->formatted.end()) {
+          block = std::move(it->second);
+          run->formatted.erase(it);
+          break;
+        }
+        if (run->readerDone && next == run->blockCount)
+          break;
+        run->ready.wait(&run->mutex);
+      }
+    }
+    if (!block)
+      break;
+
+    ++next;
+    ok = output.append(block->text);
+    run->records += block->records;
+    run->skippedBatches += block->skippedBatches;
+    run->done += block->end - block->from;
+    run->bytesWritten.store(output.written());
+    block.reset();
+    run->freeBlocks.release();
+
+    if (sincePost.elapsed() >= kPostIntervalMs) {
+      run->owner->post(run);
+      sincePost.restart();
+    }
+  }
+
+  if (ok && !run->stop.load()) {
+    if (!output.finish() || !file.commit())
+      run->fail(QStringLiteral("Cannot write %1: %2").arg(request.path, file.errorString()));
+    run->bytesWritten.store(output.written());
+  } else {
+    if (!ok)
+      run->fail(QStringLiteral("Cannot write %1: %2").arg(request.path, file.errorString()));
+    // Leaves whatever file was at the path untouched.
+    file.cancelWriting();
+  }
+  run->owner->finish(run);
+}
+
+// Called from the writer; everything touching the object happens in the
+// queued call. The destructor drains the pool, so the owner outlives every
+// task, and Qt drops the call if the owner is gone before it runs.
+void TopicExport::post(const std::shared_ptr<Run> &run) {
+  QMetaObject::invokeMethod(
+      this,
+      [this, run]() {
+        if (run->generation != m_generation)
+          return;
+        m_records = run->records.load();
+        m_bytesWritten = run->bytesWritten.load();
+        emit progressChanged(run->done.load(), run->total.load());
+      },
+      Qt::QueuedConnection);
+}
+
+void TopicExport::finish(const std::shared_ptr<Run> &run) {
+  QMetaObject::invokeMethod(
+      this,
+      [this, run]() {
+        if (run->generation != m_generation)
+          return;
+        m_run.reset();
+        m_running = false;
+        m_cancelled = run->cancelled.load();
+        m_records = run->records.load();
+        m_bytesWritten = run->bytesWritten.load();
+        m_skippedBatches = run->skippedBatches.load();
+        {
+          QMutexLocker locker(&run->mutex);
+          m_error = run->error;
+        }
+        emit progressChanged(run->done.load(), run->total.load());
+        emit finished();
+      },
+      Qt::QueuedConnection);
+}
+
+} // namespace kafka
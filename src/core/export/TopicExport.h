@@ -0,0 +1,101 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+#include <memory>
+
+namespace kafka {
+
+class BatchSource;
+
+/**
+ * @brief What a TopicExport writes: which records, in which format, where.
+ *
+ * @c from and @c to bound every partition by offset or, with @c byTime, by
+ * timestamp in ms since the epoch; -1 stands for the partition's start and
+ * end. Both ranges are half-open.
+ */
+struct ExportRequest {
+  enum Format {
+    JsonLines,
+    Csv,
+  };
+
+  QVector<qint32> partitions;
+  bool byTime = false;
+  qint64 from = -1;
+  qint64 to = -1;
+  Format format = JsonLines;
+  /** Zstandard-compresses the output stream. */
+  bool zstd = false;
+  QString path;
+};
+
+/**
+ * @brief Writes a range of records of one or more partitions to a file.
+ *
+ * Records flow through a pipeline. A reader thread fetches chunks in
+ * partition and offset order. Worker threads decompress and format the
+ * chunks in parallel. A writer thread puts the formatted blocks back in
+ * reading order, optionally compresses them, and writes them in large
+ * chunks.
+ *
+ * Only a fixed number of blocks exists at any time, and the reader waits
+ * for the writer to free one. Memory therefore depends on the worker
+ * count, not on the size of the range.
+ *
+ * Keys, values and header values that are not valid UTF-8 are written as
+ * base64: JSON Lines marks them with a "keyEncoding" / "valueEncoding"
+ * field, and CSV prefixes them with "base64:". The file is written to a
+ * temporary name and only replaces @c path once the export completes.
+ */
+class TopicExport final : public QObject {
+  Q_OBJECT
+
+public:
+  explicit TopicExport(QObject *parent = nullptr);
+  ~TopicExport() override;
+
+  void start(std::shared_ptr<BatchSource> source, const ExportRequest &request);
+  void cancel();
+
+  bool isRunning() const { return m_running; }
+  /** Valid after finished(). */
+  bool wasCancelled() const { return m_cancelled; }
+  QString errorString() const { return m_error; }
+  qint64 recordCount() const { return m_records; }
+  /** Bytes written to the file, after compression. */
+  qint64 bytesWritten() const { return m_bytesWritten; }
+  /** Compressed batches that could not be inflated and were skipped. */
+  qint64 skippedBatches() const { return m_skippedBatches; }
+
+signals:
+  /** Offsets exported so far out of @p total across all partitions. */
+  void progressChanged(qint64 done, qint64 total);
+  void finished();
+
+private:
+  struct Run;
+  struct Block;
+
+  static void read(const std::shared_ptr<Run> &run);
+  static void format(const std::shared_ptr<Run> &run, const std::shared_ptr<Block> &block);
+  static void write(const std::shared_ptr<Run> &run);
+  void post(const std::shared_ptr<Run> &run);
+  void finish(const std::shared_ptr<Run> &run);
+
+  QThreadPool m_pool;
+  std::shared_ptr<Run> m_run;
+  quint64 m_generation = 0;
+  bool m_running = false;
+  bool m_cancelled = false;
+  qint64 m_records = 0;
+  qint64 m_bytesWritten = 0;
+  qint64 m_skippedBatches = 0;
+  QString m_error;
+};
+
+} // namespace kafka
@@ -0,0 +1,739 @@
+#include "core/filter/RecordFilter.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "core/json/JsonPath.h"
+
+namespace kafka {
+
+namespace {
+struct Token {
+  enum Type {
+    End,
+    Number,
+    String,
+    Identifier,
+    Path,
+    Symbol,
+  };
+
+  Type type = End;
+  // Identifier, symbol or JSONPath text.
+  QString text;
+  // UTF-8 body of a string literal.
+  std::string string;
+  double number = 0;
+  int position = 0;
+};
+
+bool isIdentifierChar(QChar ch) {
+  return ch.isLetterOrNumber() || ch == QLatin1Char('_');
+}
+
+double durationUnit(const QString &unit, bool *ok) {
+  *ok = true;
+  if (unit.isEmpty())
+    return 1;
+  if (unit == QLatin1String("ms"))
+    return 1;
+  if (unit == QLatin1String("s"))
+    return 1000;
+  if (unit == QLatin1String("m"))
+    return 60.0 * 1000;
+  if (unit == QLatin1String("h"))
+    return 3600.0 * 1000;
+  if (unit == QLatin1String("d"))
+    return 24.0 * 3600 * 1000;
+  *ok = false;
+  return 0;
+}
+
+// The character a backslash followed by @p ch stands for in a string.
+QChar unescape(QChar ch) {
+  switch (ch.unicode()) {
+  case 'n':
+    return QLatin1Char('\n');
+  case 'r':
+    return QLatin1Char('\r');
+  case 't':
+    return QLatin1Char('\t');
+  case '0':
+    return QChar(0);
+  default:
+    return ch;
+  }
+}
+
+bool tokenize(const QString &text, QVector<Token> *tokens, QString *error) {
+  static const char *const kSymbols[] = {"&&", "||", "==", "!=", "<=", ">=", "<", ">",
+                                         "!",  "+",  "-",  "(",  ")",  "[",  "]"};
+  int i = 0;
+  const int size = text.size();
+  while (i < size) {
+    const QChar ch = text.at(i);
+    if (ch.isSpace()) {
+      ++i;
+      continue;
+    }
+
+    Token token;
+    token.position = i;
+    if (ch.isDigit()) {
+      int end = i;
+      while (end < size && (text.at(end).isDigit() || text.at(end) == QLatin1Char('.')))
+        ++end;
+      bool ok = false;
+      token.number = text.mid(i, end - i).toDouble(&ok);
+      int unitEnd = end;
+      while (unitEnd < size && text.at(unitEnd).isLetter())
+        ++unitEnd;
+      bool unitOk = false;
+      const double unit = durationUnit(text.mid(end, unitEnd - end), &unitOk);
+      if (!ok || !unitOk) {
+        *error = QStringLiteral("Invalid number at %1").arg(i + 1);
+        return false;
+      }
+      token.type = Token::Number;
+      token.number *= unit;
+      i = unitEnd;
+    } else if (ch == QLatin1Char('"') || ch == QLatin1Char('\'')) {
+      QString body;
+      int end = i + 1;
+      while (end < size && text.at(end) != ch) {
+        if (text.at(end) == QLatin1Char('\\') && end + 1 < size) {
+          ++end;
+          body += unescape(text.at(end));
+        } else {
+          body += text.at(end);
+        }
+        ++end;
+      }
+      if (end >= size) {
+        *error = QStringLiteral("Unterminated string at %1").arg(i + 1);
+        return false;
+      }
+      token.type = Token::String;
+      token.string = body.toStdString();
+      i = end + 1;
+    } else if (ch == QLatin1Char('$')) {
+      // $ followed by .member and [...] steps; JsonPath checks the rest.
+      int end = i + 1;
+      while (end < size) {
+        const QChar next = text.at(end);
+        if (next == QLatin1Char('.')) {
+          ++end;
+          while (end < size && (isIdentifierChar(text.at(end)) || text.at(end) == QLatin1Char('-')))
+            ++end;
+        } else if (next == QLatin1Char('[')) {
+          QChar quote;
+          while (end < size) {
+            const QChar c = text.at(end++);
+            if (!quote.isNull()) {
+              if (c == quote)
+                quote = QChar();
+            } else if (c == QLatin1Char('\'') || c == QLatin1Char('"')) {
+              quote = c;
+            } else if (c == QLatin1Char(']')) {
+              break;
+            }
+          }
+        } else {
+          break;
+        }
+      }
+      token.type = Token::Path;
+      token.text = text.mid(i, end - i);
+      i = end;
+    } else if (ch.isLetter() || ch == QLatin1Char('_')) {
+      int end = i;
+      while (end < size && isIdentifierChar(text.at(end)))
+        ++end;
+      token.type = Token::Identifier;
+      token.text = text.mid(i, end - i).toLower();
+      i = end;
+    } else {
+      for (const char *symbol : kSymbols) {
+        const QLatin1String candidate(symbol);
+        if (text.midRef(i, candidate.size()) == candidate) {
+          token.type = Token::Symbol;
+          token.text = candidate;
+          i += candidate.size();
+          break;
+        }
+      }
+      if (token.type != Token::Symbol) {
+        *error = QStringLiteral("Unexpected \"%1\" at %2").arg(ch).arg(i + 1);
+        return false;
+      }
+    }
+    tokens->append(std::move(token));
+  }
+
+  Token end;
+  end.position = size;
+  tokens->append(end);
+  return true;
+}
+} // namespace
+
+// Recursive descent straight to bytecode, one token of lookahead. Each
+// parse function reports what it emitted, so constants can be folded and
+// rewritten in place.
+class FilterCompiler {
+public:
+  FilterCompiler(RecordFilter *filter, QVector<Token> tokens, qint64 nowMs)
+      : m_filter(filter), m_tokens(std::move(tokens)), m_now(static_cast<double>(nowMs)) {}
+
+  bool compile(QString *error) {
+    parseOr(/*topLevel=*/true);
+    if (m_error.isEmpty() && peek().type != Token::End)
+      fail(QStringLiteral("Unexpected \"%1\"").arg(describe(peek())));
+    if (!m_error.isEmpty()) {
+      *error = m_error;
+      return false;
+    }
+    if (m_boundsValid && !m_bounds.empty())
+      m_filter->m_minTimestamp =
+          static_cast<qint64>(*std::max_element(m_bounds.begin(), m_bounds.end()));
+    return true;
+  }
+
+private:
+  using Op = RecordFilter::Op;
+
+  // What an operand emitted. Constants and the timestamp field are always a
+  // single instruction, the last one emitted.
+  struct Operand {
+    enum Kind {
+      Other,
+      Timestamp,
+      Number,
+      String,
+    };
+    Kind kind = Other;
+    double number = 0;
+  };
+
+  const Token &peek() const { return m_tokens.at(qMin(m_next, m_tokens.size() - 1)); }
+  Token take() {
+    const Token token = peek();
+    if (m_next < m_tokens.size() - 1)
+      ++m_next;
+    return token;
+  }
+  bool isSymbol(const char *symbol) const {
+    return peek().type == Token::Symbol && peek().text == QLatin1String(symbol);
+  }
+  bool isKeyword(const char *keyword) const {
+    return peek().type == Token::Identifier && peek().text == QLatin1String(keyword);
+  }
+  static QString describe(const Token &token) {
+    switch (token.type) {
+    case Token::End:
+      return QStringLiteral("end of filter");
+    case Token::Number:
+      return QString::number(token.number);
+    case Token::String:
+      return QString::fromStdString(token.string);
+    default:
+      return token.text;
+    }
+  }
+  void fail(const QString &message) {
+    if (m_error.isEmpty())
+      m_error = QStringLiteral("%1 at %2").arg(message).arg(peek().position + 1);
+  }
+
+  std::size_t emitOp(Op op, quint32 arg = 0) {
+    m_filter->m_code.push_back(RecordFilter::Instruction{op, arg});
+    return m_filter->m_code.size() - 1;
+  }
+  static quint32 indexOf(std::size_t size) { return static_cast<quint32>(size - 1); }
+  Operand emitNumber(double value) {
+    m_filter->m_numbers.push_back(value);
+    emitOp(Op::PushNumber, indexOf(m_filter->m_numbers.size()));
+    return Operand{Operand::Number, value};
+  }
+  void patchJump(std::size_t jump) {
+    m_filter->m_code[jump].arg = static_cast<quint32>(m_filter->m_code.size());
+  }
+
+  Operand parseOr(bool topLevel) {
+    Operand left = parseAnd(topLevel);
+    while (m_error.isEmpty() && (isSymbol("||") || isKeyword("or"))) {
+      take();
+      // Either side may match on its own; no bound holds for the whole.
+      if (topLevel)
+        m_boundsValid = false;
+      const std::size_t jump = emitOp(Op::JumpIfTrue);
+      emitOp(Op::Pop);
+      parseAnd(/*topLevel=*/false);
+      patchJump(jump);
+      left = Operand();
+    }
+    return left;
+  }
+
+  Operand parseAnd(bool topLevel) {
+    Operand left = parseNot(topLevel);
+    while (m_error.isEmpty() && (isSymbol("&&") || isKeyword("and"))) {
+      take();
+      const std::size_t jump = emitOp(Op::JumpIfFalse);
+      emitOp(Op::Pop);
+      parseNot(topLevel);
+      patchJump(jump);
+      left = Operand();
+    }
+    return left;
+  }
+
+  Operand parseNot(bool topLevel) {
+    if (isSymbol("!") || isKeyword("not")) {
+      take();
+      parseNot(/*topLevel=*/false);
+      emitOp(Op::Not);
+      return Operand();
+    }
+    return parseComparison(topLevel);
+  }
+
+  Operand parseComparison(bool topLevel) {
+    Operand left = parseSum();
+    Op op;
+    if (isSymbol("=="))
+      op = Op::Equal;
+    else if (isSymbol("!="))
+      op = Op::NotEqual;
+    else if (isSymbol("<"))
+      op = Op::Less;
+    else if (isSymbol("<="))
+      op = Op::LessEqual;
+    else if (isSymbol(">"))
+      op = Op::Greater;
+    else if (isSymbol(">="))
+      op = Op::GreaterEqual;
+    else if (isKeyword("contains"))
+      op = Op::Contains;
+    else
+      return left;
+    take();
+    Operand right = parseSum();
+    if (!m_error.isEmpty())
+      return Operand();
+
+    std::vector<RecordFilter::Instruction> &code = m_filter->m_code;
+    if (left.kind == Operand::Timestamp && right.kind == Operand::String)
+      right = timeConstant(code.size() - 1);
+    else if (right.kind == Operand::Timestamp && left.kind == Operand::String)
+      left = timeConstant(code.size() - 2);
+    emitOp(op);
+
+    if (topLevel) {
+      if (left.kind == Operand::Timestamp && right.kind == Operand::Number &&
+          (op == Op::Greater || op == Op::GreaterEqual || op == Op::Equal))
+        m_bounds.push_back(right.number);
+      else if (right.kind == Operand::Timestamp && left.kind == Operand::Number &&
+               (op == Op::Less || op == Op::LessEqual || op == Op::Equal))
+        m_bounds.push_back(left.number);
+    }
+    return Operand();
+  }
+
+  // Rewrites the string constant at @p at into the time it names.
+  Operand timeConstant(std::size_t at) {
+    RecordFilter::Instruction &instruction = m_filter->m_code[at];
+    const QString text = QString::fromStdString(m_filter->m_strings[instruction.arg]);
+    QDateTime time = QDateTime::fromString(text, Qt::ISODateWithMs);
+    if (!time.isValid())
+      time = QDateTime::fromString(text, Qt::ISODate);
+    if (!time.isValid()) {
+      fail(QStringLiteral("\"%1\" is not an ISO 8601 time").arg(text));
+      return Operand();
+    }
+    const auto value = static_cast<double>(time.toMSecsSinceEpoch());
+    m_filter->m_numbers.push_back(value);
+    instruction = RecordFilter::Instruction{Op::PushNumber, indexOf(m_filter->m_numbers.size())};
+    return Operand{Operand::Number, value};
+  }
+
+  Operand parseSum() {
+    Operand left = parsePrimary();
+    while (m_error.isEmpty() && (isSymbol("+") || isSymbol("-"))) {
+      const bool add = take().text == QLatin1String("+");
+      const Operand right = parsePrimary();
+      if (!m_error.isEmpty())
+        break;
+      if (left.kind == Operand::Number && right.kind == Operand::Number) {
+        m_filter->m_code.pop_back();
+        m_filter->m_code.pop_back();
+        left = emitNumber(add ? left.number + right.number : left.number - right.number);
+      } else {
+        emitOp(add ? Op::Add : Op::Subtract);
+        left = Operand();
+      }
+    }
+    return left;
+  }
+
+  Operand parsePrimary() {
+    const Token token = take();
+    switch (token.type) {
+    case Token::Number:
+      return emitNumber(token.number);
+    case Token::String:
+      m_filter->m_strings.push_back(token.string);
+      emitOp(Op::PushString, indexOf(m_filter->m_strings.size()));
+      return Operand{Operand::String, 0};
+    case Token::Path: {
+      QString pathError;
+      std::shared_ptr<const JsonPath> path = JsonPath::compile(token.text, &pathError);
+      if (!path) {
+        fail(pathError);
+        return Operand();
+      }
+      m_filter->m_paths.push_back(std::move(path));
+      emitOp(Op::LoadJson, indexOf(m_filter->m_paths.size()));
+      return Operand();
+    }
+    case Token::Symbol:
+      if (token.text == QLatin1String("(")) {
+        parseOr(/*topLevel=*/false);
+        if (!isSymbol(")"))
+          fail(QStringLiteral("Expected \")\""));
+        take();
+        return Operand();
+      }
+      if (token.text == QLatin1String("-")) {
+        const Operand operand = parsePrimary();
+        if (operand.kind != Operand::Number) {
+          fail(QStringLiteral("Only numbers can be negated"));
+          return Operand();
+        }
+        m_filter->m_code.pop_back();
+        return emitNumber(-operand.number);
+      }
+      break;
+    case Token::Identifier:
+      return parseField(token);
+    case Token::End:
+      break;
+    }
+    fail(QStringLiteral("Unexpected \"%1\"").arg(describe(token)));
+    return Operand();
+  }
+
+  Operand parseField(const Token &token) {
+    const QString &name = token.text;
+    if (name == QLatin1String("offset")) {
+      emitOp(Op::LoadOffset);
+    } else if (name == QLatin1String("ts") || name == QLatin1String("timestamp")) {
+      emitOp(Op::LoadTimestamp);
+      return Operand{Operand::Timestamp, 0};
+    } else if (name == QLatin1String("partition")) {
+      emitOp(Op::LoadPartition);
+    } else if (name == QLatin1String("size")) {
+      emitOp(Op::LoadSize);
+    } else if (name == QLatin1String("key")) {
+      emitOp(Op::LoadKey);
+    } else if (name == QLatin1String("value")) {
+      emitOp(Op::LoadValue);
+    } else if (name == QLatin1String("now")) {
+      return emitNumber(m_now);
+    } else if (name == QLatin1String("true") || name == QLatin1String("false")) {
+      return emitNumber(name == QLatin1String("true") ? 1 : 0);
+    } else if (name == QLatin1String("header") || name == QLatin1String("headers")) {
+      if (!isSymbol("[")) {
+        fail(QStringLiteral("Expected [\"name\"] after header"));
+        return Operand();
+      }
+      take();
+      const Token key = take();
+      if (key.type != Token::String || !isSymbol("]")) {
+        fail(QStringLiteral("Expected header[\"name\"]"));
+        return Operand();
+      }
+      take();
+      m_filter->m_headers.push_back(key.string);
+      emitOp(Op::LoadHeader, indexOf(m_filter->m_headers.size()));
+    } else {
+      fail(QStringLiteral("Unknown field \"%1\"").arg(name));
+    }
+    return Operand();
+  }
+
+  RecordFilter *m_filter;
+  QVector<Token> m_tokens;
+  int m_next = 0;
+  double m_now = 0;
+  QString m_error;
+  // Lower timestamp bounds of top-level conjuncts.
+  std::vector<double> m_bounds;
+  bool m_boundsValid = true;
+};
+
+std::shared_ptr<const RecordFilter> RecordFilter::compile(const QString &expression,
+                                                          qint64 nowMs, QString *error) {
+  QVector<Token> tokens;
+  QString message;
+  if (!tokenize(expression, &tokens, &message)) {
+    if (error)
+      *error = message;
+    return nullptr;
+  }
+  if (tokens.size() == 1) {
+    if (error)
+      *error = QStringLiteral("Empty filter");
+    return nullptr;
+  }
+
+  std::shared_ptr<RecordFilter> filter(new RecordFilter());
+  filter->m_expression = expression;
+  FilterCompiler compiler(filter.get(), std::move(tokens), nowMs);
+  if (!compiler.compile(&message)) {
+    if (error)
+      *error = message;
+    return nullptr;
+  }
+  return filter;
+}
+
+struct RecordFilter::Evaluator::Value {
+  enum Type : quint8 {
+    Missing,
+    Boolean,
+    Number,
+    String,
+  };
+
+  Type type = Missing;
+  double number = 0;
+  std::string_view text;
+
+  static Value ofNumber(double number) { return Value{Number, number, std::string_view()}; }
+  static Value ofBoolean(bool value) { return Value{Boolean, value ? 1.0 : 0.0, {}}; }
+  static Value ofText(std::string_view text) {
+    return text.data() ? Value{String, 0, text} : Value();
+  }
+};
+
+RecordFilter::Evaluator::Evaluator(std::shared_ptr<const RecordFilter> filter)
+    : m_filter(std::move(filter)) {
+  m_stack.reserve(16);
+}
+
+RecordFilter::Evaluator::~Evaluator() = default;
+
+bool RecordFilter::Evaluator::matches(qint32 partition, const Record &record) {
+  const std::vector<Instruction> &code = m_filter->m_code;
+  m_stack.clear();
+  m_scratchUsed = 0;
+
+  std::size_t pc = 0;
+  while (pc < code.size()) {
+    const Instruction &instruction = code[pc++];
+    switch (instruction.op) {
+    case Op::PushNumber:
+      m_stack.push_back(Value::ofNumber(m_filter->m_numbers[instruction.arg]));
+      break;
+    case Op::PushString:
+      m_stack.push_back(Value::ofText(m_filter->m_strings[instruction.arg]));
+      break;
+    case Op::LoadOffset:
+    case Op::LoadTimestamp:
+    case Op::LoadPartition:
+    case Op::LoadSize:
+    case Op::LoadKey:
+    case Op::LoadValue:
+    case Op::LoadHeader:
+    case Op::LoadJson:
+      m_stack.push_back(load(instruction, partition, record));
+      break;
+    case Op::Add:
+    case Op::Subtract: {
+      const Value right = m_stack.back();
+      m_stack.pop_back();
+      Value &left = m_stack.back();
+      double a = 0;
+      double b = 0;
+      if (toNumber(left, &a) && toNumber(right, &b))
+        left = Value::ofNumber(instruction.op == Op::Add ? a + b : a - b);
+      else
+        left = Value();
+      break;
+    }
+    case Op::Equal:
+    case Op::NotEqual:
+    case Op::Less:
+    case Op::LessEqual:
+    case Op::Greater:
+    case Op::GreaterEqual:
+    case Op::Contains: {
+      const Value right = m_stack.back();
+      m_stack.pop_back();
+      m_stack.back() = Value::ofBoolean(compare(instruction.op, m_stack.back(), right));
+      break;
+    }
+    case Op::Not:
+      m_stack.back() = Value::ofBoolean(!truthy(m_stack.back()));
+      break;
+    case Op::JumpIfFalse:
+      if (!truthy(m_stack.back()))
+        pc = instruction.arg;
+      break;
+    case Op::JumpIfTrue:
+      if (truthy(m_stack.back()))
+        pc = instruction.arg;
+      break;
+    case Op::Pop:
+      m_stack.pop_back();
+      break;
+    }
+  }
+  return !m_stack.empty() && truthy(m_stack.back());
+}
+
+bool RecordFilter::Evaluator::truthy(const Value &value) {
+  switch (value.type) {
+  case Value::Missing:
+    return false;
+  case Value::Boolean:
+  case Value::Number:
+    return value.number != 0;
+  case Value::String:
+    return true;
+  }
+  return false;
+}
+
+bool RecordFilter::Evaluator::toNumber(const Value &value, double *number) {
+  if (value.type == Value::Number || value.type == Value::Boolean) {
+    *number = value.number;
+    return true;
+  }
+  if (value.type != Value::String || value.text.empty())
+    return false;
+  bool ok = false;
+  *number = QByteArray::fromRawData(value.text.data(), static_cast<int>(value.text.size()))
+                .toDouble(&ok);
+  return ok;
+}
+
+bool RecordFilter::Evaluator::compare(Op op, const Value &left, const Value &right) {
+  if (left.type == Value::Missing || right.type == Value::Missing)
+    return false;
+  if (op == Op::Contains) {
+    return left.type == Value::String && right.type == Value::String &&
+           left.text.find(right.text) != std::string_view::npos;
+  }
+
+  int order = 0;
+  if (left.type == Value::String && right.type == Value::String) {
+    order = left.text.compare(right.text);
+  } else {
+    double a = 0;
+    double b = 0;
+    if (!toNumber(left, &a) || !toNumber(right, &b))
+      return false;
+    // NaN is neither equal nor ordered.
+    if (std::isnan(a) || std::isnan(b))
+      return op == Op::NotEqual;
+    order = a < b ? -1 : (a > b ? 1 : 0);
+  }
+
+  switch (op) {
+  case Op::Equal:
+    return order == 0;
+  case Op::NotEqual:
+    return order != 0;
+  case Op::Less:
+    return order < 0;
+  case Op::LessEqual:
+    return order <= 0;
+  case Op::Greater:
+    return order > 0;
+  case Op::GreaterEqual:
+    return order >= 0;
+  default:
+    return false;
+  }
+}
+
+RecordFilter::Evaluator::Value
+RecordFilter::Evaluator::load(const Instruction &instruction, qint32 partition,
+                              const Record &record) {
+  switch (instruction.op) {
+  case Op::LoadOffset:
+    return Value::ofNumber(static_cast<double>(record.offset));
+  case Op::LoadTimestamp:
+    return Value::ofNumber(static_cast<double>(record.timestamp));
+  case Op::LoadPartition:
+    return Value::ofNumber(partition);
+  case Op::LoadSize:
+    return Value::ofNumber(static_cast<double>(record.encoded.size()));
+  case Op::LoadKey:
+    return Value::ofText(record.key);
+  case Op::LoadValue:
+    return Value::ofText(record.value);
+  case Op::LoadHeader: {
+    const std::string &name = m_filter->m_headers[instruction.arg];
+    HeaderReader headers(record);
+    RecordHeader header;
+    while (headers.next(header)) {
+      if (header.key == name)
+        return Value::ofText(header.value);
+    }
+    return Value();
+  }
+  case Op::LoadJson:
+    if (!record.value.data())
+      return Value();
+    return jsonValue(record.value, *m_filter->m_paths[instruction.arg]);
+  default:
+    return Value();
+  }
+}
+
+RecordFilter::Evaluator::Value RecordFilter::Evaluator::jsonValue(std::string_view document,
+                                                                  const JsonPath &path) {
+  const JsonValue found = path.extract(document);
+  switch (found.type) {
+  case JsonValue::Missing:
+  case JsonValue::Null:
+    return Value();
+  case JsonValue::Boolean:
+    return Value::ofBoolean(found.raw == "true");
+  case JsonValue::Number: {
+    bool ok = false;
+    const double number =
+        QByteArray::fromRawData(found.raw.data(), static_cast<int>(found.raw.size()))
+            .toDouble(&ok);
+    return ok ? Value::ofNumber(number) : Value();
+  }
+  case JsonValue::String: {
+    if (found.raw.size() < 2)
+      return Value();
+    const std::string_view body = found.raw.substr(1, found.raw.size() - 2);
+    if (body.find('\\') == std::string_view::npos)
+      return Value::ofText(body);
+    if (m_scratchUsed == m_scratch.size())
+      m_scratch.emplace_back();
+    std::string &unescaped = m_scratch[m_scratchUsed++];
+    unescaped.clear();
+    if (!JsonPath::unescape(body, body.size(), &unescaped))
+      return Value();
+    return Value::ofText(unescaped);
+  }
+  case JsonValue::Object:
+  case JsonValue::Array:
+    return Value::ofText(found.raw);
+  }
+  return Value();
+}
+
+} // namespace kafka
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <QString>
+
+#include <deque>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/protocol/RecordBatch.h"
+
+namespace kafka {
+
+class JsonPath;
+
+/**
+ * @brief A filter expression over records, compiled once into a small
+ * stack bytecode.
+ *
+ * The language:
+ *   - fields: offset, partition, ts (or timestamp), size, key, value,
+ *     header["name"], and JSONPath into the value such as $.order.amount;
+ *   - literals: numbers, "strings" or 'strings', true, false, now (the
+ *     compile time in ms), and durations such as 500ms, 30s, 5m, 2h, 1d.
+ *     In strings \n, \r, \t and \0 stand for those characters, and a
+ *     backslash before any other character stands for that character;
+ *   - operators, loosest first: || (or), && (and), ! (not), the
+ *     comparisons == != < <= > >= and contains, then + and -.
+ *
+ * Example: ts > now-5m && header["tenant"] == "acme" && $.amount > 1000
+ *
+ * Constant arithmetic is folded, and a string compared with ts is read as
+ * an ISO 8601 time, both at compile time. A comparison involving a field
+ * the record lacks (a null key, a missing header or JSON member) is false,
+ * != included. Strings compare byte by byte; a string compared with a
+ * number is parsed as one.
+ *
+ * Evaluation reads the record's raw views and allocates nothing except to
+ * unescape a JSON string. The compiled filter is immutable and shared
+ * between threads; each thread evaluates through its own Evaluator.
+ */
+class RecordFilter {
+private:
+  enum class Op : quint8 {
+    PushNumber,
+    PushString,
+    LoadOffset,
+    LoadTimestamp,
+    LoadPartition,
+    LoadSize,
+    LoadKey,
+    LoadValue,
+    LoadHeader,
+    LoadJson,
+    Add,
+    Subtract,
+    Equal,
+    NotEqual,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Contains,
+    Not,
+    // Jump to @c arg when the top of the stack is false (true), keeping it.
+    JumpIfFalse,
+    JumpIfTrue,
+    Pop,
+  };
+
+  struct Instruction {
+    Op op = Op::Pop;
+    // Constant, header, path or jump target index, depending on @c op.
+    quint32 arg = 0;
+  };
+
+public:
+  /** Per-thread evaluation state. */
+  class Evaluator {
+  public:
+    explicit Evaluator(std::shared_ptr<const RecordFilter> filter);
+    ~Evaluator();
+
+    bool matches(qint32 partition, const Record &record);
+
+  private:
+    struct Value;
+
+    static bool truthy(const Value &value);
+    static bool toNumber(const Value &value, double *number);
+    static bool compare(Op op, const Value &left, const Value &right);
+
+    Value load(const Instruction &instruction, qint32 partition, const Record &record);
+    Value jsonValue(std::string_view document, const JsonPath &path);
+
+    std::shared_ptr<const RecordFilter> m_filter;
+    std::vector<Value> m_stack;
+    // Unescaped JSON strings of the record being evaluated. A deque keeps
+    // earlier ones in place while later ones are added.
+    std::deque<std::string> m_scratch;
+    std::size_t m_scratchUsed = 0;
+  };
+
+  static constexpr qint64 kNoTimestampBound = std::numeric_limits<qint64>::min();
+
+  /**
+   * @brief Returns null and sets @p error (with the position) for an
+   * invalid expression. @p nowMs is what "now" stands for.
+   */
+  static std::shared_ptr<const RecordFilter> compile(const QString &expression, qint64 nowMs,
+                                                     QString *error);
+
+  QString expression() const { return m_expression; }
+  /**
+   * @brief Lowest timestamp a matching record can have, from a top-level
+   * "ts > ..." or "ts >= ..." term; kNoTimestampBound when there is none.
+   * Lets a scan start at that time instead of the beginning.
+   */
+  qint64 minTimestamp() const { return m_minTimestamp; }
+
+private:
+  friend class FilterCompiler;
+
+  RecordFilter() = default;
+
+  QString m_expression;
+  std::vector<Instruction> m_code;
+  std::vector<double> m_numbers;
+  std::vector<std::string> m_strings;
+  std::vector<std::string> m_headers;
+  std::vector<std::shared_ptr<const JsonPath>> m_paths;
+  qint64 m_minTimestamp = kNoTimestampBound;
+};
+
+} // namespace kafka
@@ -0,0 +1,87 @@
+#include "core/filter/TopicFilter.h"
+
+#include <atomic>
+#include <utility>
+
+#include "core/protocol/RecordBatch.h"
+#include "core/scan/BatchWalk.h"
+
+namespace kafka {
+
+class TopicFilter::Worker final : public SliceScan::Worker {
+public:
+  Worker(TopicFilter *owner, std::shared_ptr<const RecordFilter> filter,
+         std::shared_ptr<std::atomic<int>> matches)
+      : m_owner(owner), m_minTimestamp(filter->minTimestamp()), m_evaluator(std::move(filter)),
+        m_matches(std::move(matches)) {}
+
+  // No record of the batch is as new as the bound.
+  bool wantsBatch(const RecordBatch &batch) override {
+    return batch.maxTimestamp() >= m_minTimestamp;
+  }
+
+  bool add(int, qint32 partition, const Record &record) override {
+    if (!m_evaluator.matches(partition, record))
+      return true;
+
+    FilterMatch match;
+    match.partition = partition;
+    match.offset = record.offset;
+    match.timestamp = record.timestamp;
+    match.size = static_cast<qint32>(record.encoded.size());
+    match.key = copyOf(record.key, record.key.size());
+    match.value = copyOf(record.value, kMaxValueBytes);
+    match.valueTruncated = record.value.size() > static_cast<std::size_t>(kMaxValueBytes);
+    m_pending.append(std::move(match));
+    return m_matches->fetch_add(1) + 1 < kMaxMatches;
+  }
+
+  std::function<void()> take() override {
+    if (m_pending.isEmpty())
+      return nullptr;
+    return [owner = m_owner, matches = std::exchange(m_pending, {})]() {
+      owner->m_matchCount += matches.size();
+      emit owner->matchesFound(matches);
+    };
+  }
+
+private:
+  TopicFilter *m_owner;
+  const qint64 m_minTimestamp;
+  RecordFilter::Evaluator m_evaluator;
+  // Shared by the workers of one run.
+  std::shared_ptr<std::atomic<int>> m_matches;
+  QVector<FilterMatch> m_pending;
+};
+
+TopicFilter::TopicFilter(QObject *parent)
+    : QObject(parent),
+      m_scan(
+          this, QStringLiteral("kafka-filter"), "filter worker",
+          [this](qint64 scanned, qint64 total) { emit progressChanged(scanned, total); },
+          [this]() { emit finished(); }) {}
+
+// With a lower timestamp bound, each partition is scanned from the first
+// offset at that time.
+void TopicFilter::start(std::shared_ptr<BatchSource> source, const QVector<qint32> &partitions,
+                        std::shared_ptr<const RecordFilter> filter) {
+  cancel();
+  if (!source || !filter || partitions.isEmpty())
+    return;
+
+  m_matchCount = 0;
+  SliceScan::Request request;
+  request.targets.append({QString(), std::move(source), partitions});
+  // SliceScan reads a negative bound as none, and no record with a
+  // timestamp is older than one anyway.
+  if (filter->minTimestamp() >= 0)
+    request.from = filter->minTimestamp();
+  auto matches = std::make_shared<std::atomic<int>>(0);
+  m_scan.start(std::move(request), [this, filter = std::move(filter), matches]() {
+    return std::make_unique<Worker>(this, filter, matches);
+  });
+}
+
+void TopicFilter::cancel() { m_scan.cancel(); }
+
+} // namespace kafka
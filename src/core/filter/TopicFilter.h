@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+#include "core/filter/RecordFilter.h"
+#include "core/scan/SliceScan.h"
+
+namespace kafka {
+
+class BatchSource;
+
+/**
+ * @brief A record that passed a TopicFilter, copied out of its batch.
+ *
+ * Values longer than TopicFilter::kMaxValueBytes are cut; @c size keeps the
+ * size of the whole record. A null key or value is a null QByteArray.
+ */
+struct FilterMatch {
+  qint32 partition = 0;
+  qint64 offset = 0;
+  qint64 timestamp = 0;
+  qint32 size = 0;
+  QByteArray key;
+  QByteArray value;
+  bool valueTruncated = false;
+};
+
+/**
+ * @brief Runs a RecordFilter over every record of a set of partitions.
+ *
+ * Runs on a SliceScan like TopicSearch; each worker evaluates the filter
+ * on the raw record views through its own RecordFilter::Evaluator. Only
+ * records that pass are copied, so the GUI thread never sees the rest.
+ * Matches reach matchesFound() in batches while the scan runs, in no
+ * particular order.
+ *
+ * When the filter has a lower timestamp bound, each partition is scanned
+ * from the first offset at that time, found with one
+ * BatchSource::offsetsForTimestamp() call, and batches whose newest record
+ * is older are skipped without being decoded.
+ */
+class TopicFilter final : public QObject {
+  Q_OBJECT
+
+public:
+  /** The scan stops once this many records matched. */
+  static constexpr int kMaxMatches = 100000;
+  static constexpr int kMaxValueBytes = 256;
+
+  explicit TopicFilter(QObject *parent = nullptr);
+
+  void start(std::shared_ptr<BatchSource> source, const QVector<qint32> &partitions,
+             std::shared_ptr<const RecordFilter> filter);
+  void cancel();
+
+  bool isRunning() const { return m_scan.isRunning(); }
+  int matchCount() const { return m_matchCount; }
+  /** Valid after finished(). */
+  bool wasCancelled() const { return m_scan.wasCancelled(); }
+  bool limitReached() const { return m_scan.stoppedByWorker(); }
+  QString errorString() const { return m_scan.errorString(); }
+  /** Compressed batches that could not be inflated and were skipped. */
+  qint64 skippedBatches() const { return m_scan.skippedBatches(); }
+
+signals:
+  void matchesFound(const QVector<kafka::FilterMatch> &matches);
+  /** Offsets scanned so far out of @p total across all partitions. */
+  void progressChanged(qint64 scanned, qint64 total);
+  void finished();
+
+private:
+  class Worker;
+
+  int m_matchCount = 0;
+  // Last, so the workers stop before anything else goes.
+  SliceScan m_scan;
+};
+
+} // namespace kafka
@@ -0,0 +1,154 @@
+#include "core/groups/LagMonitor.h"
+
+#include <QElapsedTimer>
+#include <QSet>
+
+#include "core/network/KafkaClient.h"
+#include "core/protocol/ApiKeys.h"
+#include "core/protocol/Messages.h"
+#include "core/trace/Trace.h"
+
+namespace kafka {
+
+struct LagMonitor::Run {
+  LagMonitor *owner = nullptr;
+  quint64 generation = 0;
+  KafkaClient *client = nullptr;
+  std::shared_ptr<const Rows> previous;
+
+  std::shared_ptr<const Rows> rows;
+  LagDelta delta;
+  QString error;
+};
+
+LagMonitor::LagMonitor(KafkaClient *client, QObject *parent)
+    : QObject(parent), m_client(client) {
+  m_pool.setObjectName(QStringLiteral("kafka-lag-monitor"));
+  m_pool.setMaxThreadCount(1);
+}
+
+LagMonitor::~LagMonitor() {
+  ++m_generation;
+  m_pool.waitForDone();
+}
+
+void LagMonitor::refresh() {
+  if (m_running || !m_client)
+    return;
+  auto run = std::make_shared<Run>();
+  run->owner = this;
+  run->generation = ++m_generation;
+  run->client = m_client;
+  run->previous = m_previous;
+  m_running = true;
+
+  // Everything touching the object happens in the queued call; the
+  // destructor drains the pool, so the owner outlives the worker.
+  m_pool.start([run]() {
+    LagMonitor::run(run);
+    LagMonitor *owner = run->owner;
+    QMetaObject::invokeMethod(
+        owner,
+        [owner, run]() {
+          if (run->generation != owner->m_generation)
+            return;
+          owner->m_running = false;
+          if (!run->rows) {
+            emit owner->failed(run->error);
+            return;
+          }
+          owner->m_previous = run->rows;
+          emit owner->updated(run->delta);
+        },
+        Qt::QueuedConnection);
+  });
+}
+
+void LagMonitor::reset() {
+  // A refresh still running compared against the old rows; drop it.
+  ++m_generation;
+  m_running = false;
+  m_previous.reset();
+}
+
+void LagMonitor::run(const std::shared_ptr<Run> &run) {
+  KAFKA_TRACE_SCOPE("lag refresh");
+  QElapsedTimer elapsed;
+  elapsed.start();
+
+  GroupOffsetsSnapshot snapshot;
+  if (!run->client->groupOffsetsBlocking(&snapshot, &run->error))
+    return;
+
+  // One end offset per partition, however many groups read it.
+  QSet<TopicPartition> committedSet;
+  QVector<TopicPartition> partitions;
+  for (const GroupOffsets &group : std::as_const(snapshot.groups)) {
+    for (const CommittedOffset &committed : group.offsets) {
+      if (!committedSet.contains(committed.tp)) {
+        committedSet.insert(committed.tp);
+        partitions.append(committed.tp);
+      }
+    }
+  }
+
+  QHash<TopicPartition, PartitionOffset> ends;
+  int listRequests = 0;
+  if (!partitions.isEmpty()) {
+    QVector<PartitionOffset> offsets;
+    if (!run->client->listOffsetsBlocking(partitions, kLatestTimestamp, &offsets, &listRequests,
+                                          &run->error))
+      return;
+    ends.reserve(offsets.size());
+    for (const PartitionOffset &offset : std::as_const(offsets))
+      ends.insert(offset.tp, offset);
+  }
+
+  auto rows = std::make_shared<Rows>();
+  LagDelta &delta = run->delta;
+  for (const GroupOffsets &group : std::as_const(snapshot.groups)) {
+    for (const CommittedOffset &committed : group.offsets) {
+      LagRow row;
+      row.group = group.groupId;
+      row.tp = committed.tp;
+      row.coordinator = group.coordinator;
+      row.committed = committed.offset;
+      row.errorCode = group.errorCode != 0 ? group.errorCode : committed.errorCode;
+      const auto end = ends.constFind(committed.tp);
+      if (end != ends.cend()) {
+        if (end->errorCode == 0)
+          row.endOffset = end->offset;
+        else if (row.errorCode == 0)
+          row.errorCode = end->errorCode;
+      }
+
+      LagKey key{row.group, row.tp};
+      if (run->previous) {
+        const auto before = run->previous->constFind(key);
+        if (before == run->previous->cend() || *before != row)
+          delta.changed.append(row);
+      } else {
+        delta.changed.append(row);
+      }
+      rows->insert(std::move(key), std::move(row));
+    }
+    if (group.errorCode != 0 && group.offsets.isEmpty())
+      delta.errors.append(QStringLiteral("Group %1: %2").arg(
+          group.groupId, QString::fromLatin1(errorName(group.errorCode))));
+  }
+  if (run->previous) {
+    for (auto it = run->previous->cbegin(); it != run->previous->cend(); ++it) {
+      if (!rows->contains(it.key()))
+        delta.removed.append(it.key());
+    }
+  }
+
+  delta.groupCount = snapshot.groups.size();
+  delta.rowCount = rows->size();
+  delta.requestCount = snapshot.requestCount + listRequests;
+  delta.errors += snapshot.brokerErrors;
+  delta.elapsedMs = elapsed.elapsed();
+  run->rows = std::move(rows);
+}
+
+} // namespace kafka
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+#include <memory>
+
+#include "core/network/ClientTypes.h"
+
+namespace kafka {
+
+class KafkaClient;
+
+/**
+ * @brief Lag of one consumer group on one partition.
+ */
+struct LagRow {
+  QString group;
+  TopicPartition tp;
+  qint32 coordinator = -1;
+  /** -1 when the group has no offset for the partition. */
+  qint64 committed = -1;
+  /** -1 when the end offset could not be listed. */
+  qint64 endOffset = -1;
+  /** The first error met for the row: group, committed offset or end offset. */
+  qint16 errorCode = 0;
+
+  /** Messages behind the end, or -1 when either offset is unknown. */
+  qint64 lag() const {
+    return committed >= 0 && endOffset >= 0 ? qMax<qint64>(0, endOffset - committed) : -1;
+  }
+  bool operator==(const LagRow &other) const {
+    return committed == other.committed && endOffset == other.endOffset &&
+           errorCode == other.errorCode && coordinator == other.coordinator;
+  }
+  bool operator!=(const LagRow &other) const { return !(*this == other); }
+};
+
+struct LagKey {
+  QString group;
+  TopicPartition tp;
+
+  bool operator==(const LagKey &other) const {
+    return tp == other.tp && group == other.group;
+  }
+};
+
+inline uint qHash(const LagKey &key, uint seed = 0) {
+  return ::qHash(key.group, seed) ^ qHash(key.tp, seed);
+}
+
+/**
+ * @brief What one refresh changed compared with the previous one.
+ */
+struct LagDelta {
+  /** Rows that are new or whose offsets or error changed. */
+  QVector<LagRow> changed;
+  QVector<LagKey> removed;
+  int groupCount = 0;
+  int rowCount = 0;
+  /** ListGroups, OffsetFetch and ListOffsets requests the refresh sent. */
+  int requestCount = 0;
+  qint64 elapsedMs = 0;
+  QStringList errors;
+};
+
+/**
+ * @brief Computes the lag of every consumer group in the cluster.
+ *
+ * A refresh collects all committed offsets with
+ * KafkaClient::fetchGroupOffsets() and the end offset of every partition
+ * any group committed with one ListOffsets request per partition leader,
+ * so its request count grows with the number of brokers, not groups. The
+ * worker keeps the rows of the previous refresh and delivers only the
+ * difference through updated(), so views repaint only rows that moved.
+ */
+class LagMonitor final : public QObject {
+  Q_OBJECT
+
+public:
+  explicit LagMonitor(KafkaClient *client, QObject *parent = nullptr);
+  ~LagMonitor() override;
+
+  /** Starts a refresh unless one is running. */
+  void refresh();
+  /** Forgets the previous rows; the next refresh reports every row as new. */
+  void reset();
+  bool isRunning() const { return m_running; }
+
+signals:
+  void updated(const kafka::LagDelta &delta);
+  void failed(const QString &error);
+
+private:
+  using Rows = QHash<LagKey, LagRow>;
+  struct Run;
+
+  static void run(const std::shared_ptr<Run> &run);
+
+  KafkaClient *m_client = nullptr;
+  QThreadPool m_pool;
+  std::shared_ptr<const Rows> m_previous;
+  quint64 m_generation = 0;
+  bool m_running = false;
+};
+
+} // namespace kafka
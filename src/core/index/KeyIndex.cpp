@@ -0,0 +1,347 @@
+#include "core/index/KeyIndex.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "core/codec/DecodedBatchCache.h"
+#include "core/protocol/RecordBatch.h"
+#include "core/scan/BatchWalk.h"
+#include "core/source/BatchSource.h"
+
+namespace kafka {
+
+namespace {
+constexpr int kLockTimeoutMs = 30000;
+constexpr quint32 kVersion = 1;
+constexpr char kMagic[4] = {'K', 'V', 'K', 'I'};
+constexpr std::size_t kMergeBufferEntries = 1 << 16;
+
+// Runs are written in host byte order; the cache never leaves the machine.
+struct RunHeader {
+  char magic[4];
+  quint32 version;
+  qint64 first;
+  qint64 next;
+  quint64 count;
+};
+static_assert(sizeof(RunHeader) == 32, "RunHeader is part of the file format");
+
+constexpr qint64 kEntrySize = 16;
+
+bool writeHeader(QSaveFile &file, qint64 first, qint64 next, quint64 count) {
+  RunHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.first = first;
+  header.next = next;
+  header.count = count;
+  return file.write(reinterpret_cast<const char *>(&header), sizeof(header)) ==
+         qint64(sizeof(header));
+}
+
+QString runFileName(qint64 first, qint64 next) {
+  return QStringLiteral("%1-%2.run")
+      .arg(first, 20, 10, QLatin1Char('0'))
+      .arg(next, 20, 10, QLatin1Char('0'));
+}
+
+// A mapped run file; entries are read with memcpy since the mapping gives
+// no alignment guarantee worth relying on.
+class MappedRun {
+public:
+  bool open(const QString &path, QString *error) {
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+      if (error)
+        *error = QStringLiteral("Cannot open %1: %2").arg(path, m_file.errorString());
+      return false;
+    }
+    const qint64 size = m_file.size();
+    const uchar *data = size > 0 ? m_file.map(0, size) : nullptr;
+    RunHeader header{};
+    if (data && size >= qint64(sizeof(RunHeader)))
+      std::memcpy(&header, data, sizeof(header));
+    if (!data || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kVersion ||
+        size != qint64(sizeof(RunHeader)) + qint64(header.count) * kEntrySize) {
+      if (error)
+        *error = QStringLiteral("%1 is not a valid key index run").arg(path);
+      return false;
+    }
+    m_entries = data + sizeof(RunHeader);
+    m_count = header.count;
+    return true;
+  }
+
+  quint64 count() const { return m_count; }
+  quint64 hashAt(quint64 i) const {
+    quint64 hash = 0;
+    std::memcpy(&hash, m_entries + i * kEntrySize, sizeof(hash));
+    return hash;
+  }
+  qint64 offsetAt(quint64 i) const {
+    qint64 offset = 0;
+    std::memcpy(&offset, m_entries + i * kEntrySize + sizeof(quint64), sizeof(offset));
+    return offset;
+  }
+  quint64 lowerBound(quint64 hash) const {
+    quint64 low = 0;
+    quint64 high = m_count;
+    while (low < high) {
+      const quint64 mid = low + (high - low) / 2;
+      if (hashAt(mid) < hash)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+    return low;
+  }
+
+private:
+  QFile m_file;
+  const uchar *m_entries = nullptr;
+  quint64 m_count = 0;
+};
+} // namespace
+
+KeyIndex::KeyIndex(const QString &directory) : m_directory(directory) {}
+
+QString KeyIndex::defaultRoot() {
+  return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
+      .filePath(QStringLiteral("key-index"));
+}
+
+QString KeyIndex::directoryFor(const QString &root, const QString &persistentKey,
+                               qint32 partition) {
+  const QByteArray digest =
+      QCryptographicHash::hash(persistentKey.toUtf8(), QCryptographicHash::Sha1).toHex();
+  return QDir(root).filePath(
+      QStringLiteral("%1/%2").arg(QString::fromLatin1(digest)).arg(partition));
+}
+
+quint64 KeyIndex::hashKey(std::string_view key) {
+  quint64 hash = 14695981039346656037ull;
+  for (char c : key) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+QVector<KeyIndex::Run> KeyIndex::runs() const {
+  QVector<Run> result;
+  const QStringList names =
+      QDir(m_directory).entryList({QStringLiteral("*.run")}, QDir::Files, QDir::Name);
+  for (const QString &name : names) {
+    const QStringList bounds = name.chopped(4).split(QLatin1Char('-'));
+    bool firstOk = false;
+    bool nextOk = false;
+    Run run;
+    run.path = QDir(m_directory).filePath(name);
+    if (bounds.size() == 2) {
+      run.first = bounds[0].toLongLong(&firstOk);
+      run.next = bounds[1].toLongLong(&nextOk);
+    }
+    if (firstOk && nextOk && run.first <= run.next)
+      result.append(run);
+  }
+  return result;
+}
+
+qint64 KeyIndex::indexedUntil() const {
+  qint64 until = -1;
+  for (const Run &run : runs())
+    until = std::max(until, run.next);
+  return until;
+}
+
+bool KeyIndex::clear(QString *error) {
+  for (const Run &run : runs()) {
+    if (!QFile::remove(run.path)) {
+      if (error)
+        *error = QStringLiteral("Cannot remove %1").arg(run.path);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool KeyIndex::update(BatchSource &source, qint32 partition, const Progress &progress,
+                      QString *error) {
+  if (!QDir().mkpath(m_directory)) {
+    if (error)
+      *error = QStringLiteral("Cannot create %1").arg(m_directory);
+    return false;
+  }
+  // Guards against a second window or a concurrent lookup on the same
+  // partition writing overlapping runs.
+  QLockFile lock(QDir(m_directory).filePath(QStringLiteral(".lock")));
+  if (!lock.tryLock(kLockTimeoutMs)) {
+    if (error)
+      *error = QStringLiteral("The key index in %1 is locked").arg(m_directory);
+    return false;
+  }
+
+  OffsetRange range;
+  if (!source.offsetRange(partition, &range, error))
+    return false;
+
+  qint64 offset = indexedUntil();
+  // Indexed past the end means the topic was deleted and recreated.
+  if (offset > range.end) {
+    if (!clear(error))
+      return false;
+    offset = -1;
+  }
+  // Retention may have removed what lies between the index and the log.
+  offset = std::max(offset, range.start);
+
+  std::vector<Entry> entries;
+  qint64 runFirst = offset;
+  BatchWalk walk(source, partition, offset, range.end);
+  while (walk.nextChunk(error)) {
+    RecordBatch batch;
+    while (walk.nextBatch(batch)) {
+      if (batch.isControl())
+        continue;
+      std::shared_ptr<const DecodedBatch> decoded;
+      std::string_view section;
+      // The batch's keys stay unindexed; its rows show the failure when
+      // browsed.
+      if (!recordsOf(batch, &decoded, &section))
+        continue;
+      walk.forEachRecord(batch, section, [&](const Record &record) {
+        if (record.key.data())
+          entries.push_back({hashKey(record.key), record.offset});
+        return true;
+      });
+    }
+    offset = walk.position();
+
+    if (entries.size() >= kEntriesPerRun) {
+      if (!writeRun(entries, runFirst, offset, error))
+        return false;
+      entries.clear();
+      runFirst = offset;
+    }
+    if (progress && !progress(offset, range.end))
+      break;
+  }
+  const bool ok = !walk.failed();
+
+  // Whatever was read is kept, also when the read failed half way.
+  if (offset > runFirst && !writeRun(entries, runFirst, offset, error))
+    return false;
+  if (runs().size() > kMaxRuns && !mergeRuns(ok ? error : nullptr))
+    return false;
+  return ok;
+}
+
+bool KeyIndex::writeRun(std::vector<Entry> &entries, qint64 first, qint64 next,
+                        QString *error) const {
+  std::sort(entries.begin(), entries.end());
+
+  const QString path = QDir(m_directory).filePath(runFileName(first, next));
+  QSaveFile file(path);
+  const qint64 bytes = qint64(entries.size()) * kEntrySize;
+  const bool written =
+      file.open(QIODevice::WriteOnly) && writeHeader(file, first, next, entries.size()) &&
+      file.write(reinterpret_cast<const char *>(entries.data()), bytes) == bytes;
+  if (!written || !file.commit()) {
+    if (error)
+      *error = QStringLiteral("Cannot write %1: %2").arg(path, file.errorString());
+    return false;
+  }
+  return true;
+}
+
+// k-way merge of every run into one. The merged run is committed before the
+// old ones are removed, so a crash in between only leaves overlapping runs,
+// whose duplicate offsets lookup() drops.
+bool KeyIndex::mergeRuns(QString *error) const {
+  const QVector<Run> inputs = runs();
+  std::vector<std::unique_ptr<MappedRun>> mapped;
+  qint64 first = inputs.isEmpty() ? 0 : inputs.first().first;
+  qint64 next = 0;
+  quint64 total = 0;
+  for (const Run &run : inputs) {
+    auto file = std::make_unique<MappedRun>();
+    if (!file->open(run.path, error))
+      return false;
+    first = std::min(first, run.first);
+    next = std::max(next, run.next);
+    total += file->count();
+    mapped.push_back(std::move(file));
+  }
+
+  const QString path = QDir(m_directory).filePath(runFileName(first, next));
+  QSaveFile file(path);
+  bool written = file.open(QIODevice::WriteOnly) && writeHeader(file, first, next, total);
+
+  std::vector<quint64> positions(mapped.size(), 0);
+  std::vector<Entry> buffer;
+  buffer.reserve(kMergeBufferEntries);
+  auto flush = [&]() {
+    const qint64 bytes = qint64(buffer.size()) * kEntrySize;
+    written = file.write(reinterpret_cast<const char *>(buffer.data()), bytes) == bytes;
+    buffer.clear();
+  };
+  while (written) {
+    std::size_t best = mapped.size();
+    Entry bestEntry{};
+    for (std::size_t i = 0; i < mapped.size(); ++i) {
+      if (positions[i] >= mapped[i]->count())
+        continue;
+      const Entry candidate{mapped[i]->hashAt(positions[i]), mapped[i]->offsetAt(positions[i])};
+      if (best == mapped.size() || candidate < bestEntry) {
+        best = i;
+        bestEntry = candidate;
+      }
+    }
+    if (best == mapped.size())
+      break;
+    ++positions[best];
+    buffer.push_back(bestEntry);
+    if (buffer.size() >= kMergeBufferEntries)
+      flush();
+  }
+  if (written && !buffer.empty())
+    flush();
+  mapped.clear();
+  if (!written || !file.commit()) {
+    if (error)
+      *error = QStringLiteral("Cannot write %1: %2").arg(path, file.errorString());
+    return false;
+  }
+
+  for (const Run &run : inputs) {
+    if (run.path != path)
+      QFile::remove(run.path);
+  }
+  return true;
+}
+
+QVector<qint64> KeyIndex::lookup(std::string_view key, QString *error) const {
+  const quint64 hash = hashKey(key);
+  QVector<qint64> offsets;
+  for (const Run &run : runs()) {
+    MappedRun mapped;
+    if (!mapped.open(run.path, error))
+      return {};
+    for (quint64 i = mapped.lowerBound(hash); i < mapped.count() && mapped.hashAt(i) == hash; ++i)
+      offsets.append(mapped.offsetAt(i));
+  }
+  std::sort(offsets.begin(), offsets.end());
+  offsets.erase(std::unique(offsets.begin(), offsets.end()), offsets.end());
+  return offsets;
+}
+
+} // namespace kafka
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace kafka {
+
+class BatchSource;
+
+/**
+ * @brief On-disk map from message key hash to offsets for one partition.
+ *
+ * The index is a directory of immutable runs, each covering the offsets
+ * [first, next) it was built from and holding (hash, offset) pairs sorted
+ * by hash. update() indexes only what lies past the newest run and writes
+ * it as a new run; once there are more than kMaxRuns they are merged into
+ * one. lookup() binary-searches every run, so a key costs a handful of
+ * page reads however large the partition is.
+ *
+ * Keys are identified by a 64-bit hash, so a lookup can return offsets of
+ * a different key; callers fetch the records and compare keys anyway.
+ * Offsets removed by compaction or retention stay in the index until the
+ * directory is cleared and are simply not found when fetched.
+ */
+class KeyIndex {
+public:
+  static constexpr int kMaxRuns = 8;
+  /** Entries buffered before update() writes a run (16 bytes each). */
+  static constexpr std::size_t kEntriesPerRun = std::size_t(1) << 22;
+
+  /**
+   * @brief Called during update() with the offset indexed so far; return
+   * false to stop early (what was indexed is kept).
+   */
+  using Progress = std::function<bool(qint64 indexedUntil, qint64 end)>;
+
+  explicit KeyIndex(const QString &directory);
+
+  /** The application's cache directory plus "key-index". */
+  static QString defaultRoot();
+  /** Per-partition directory under @p root for a BatchSource::persistentKey(). */
+  static QString directoryFor(const QString &root, const QString &persistentKey,
+                              qint32 partition);
+  /** Stable across runs and machines (FNV-1a). */
+  static quint64 hashKey(std::string_view key);
+
+  QString directory() const { return m_directory; }
+  /** Offset the next update() resumes from, or -1 when nothing is indexed. */
+  qint64 indexedUntil() const;
+
+  bool update(BatchSource &source, qint32 partition, const Progress &progress, QString *error);
+  /** Offsets whose key hashes like @p key, ascending. */
+  QVector<qint64> lookup(std::string_view key, QString *error) const;
+  bool clear(QString *error);
+
+private:
+  // Written to run files as is.
+  struct Entry {
+    quint64 hash = 0;
+    qint64 offset = 0;
+
+    bool operator<(const Entry &other) const {
+      return hash != other.hash ? hash < other.hash : offset < other.offset;
+    }
+  };
+  static_assert(sizeof(Entry) == 16, "Entry is part of the file format");
+
+  struct Run {
+    QString path;
+    qint64 first = 0;
+    qint64 next = 0;
+  };
+
+  QVector<Run> runs() const;
+  bool writeRun(std::vector<Entry> &entries, qint64 first, qint64 next, QString *error) const;
+  bool mergeRuns(QString *error) const;
+
+  QString m_directory;
+};
+
+} // namespace kafka
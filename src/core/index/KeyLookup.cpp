@@ -0,0 +1,221 @@
+#include "core/index/KeyLookup.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <atomic>
+
+#include "core/codec/DecodedBatchCache.h"
+#include "core/index/KeyIndex.h"
+#include "core/protocol/RecordBatch.h"
+#include "core/scan/BatchWalk.h"
+#include "core/source/BatchSource.h"
+
+namespace kafka {
+
+namespace {
+// Versions of a compacted key are usually far apart, so each read only
+// needs to cover the batch holding the next candidate.
+constexpr qint32 kLookupReadBytes = 64 * 1024;
+constexpr int kPostIntervalMs = 100;
+constexpr int kPreviewBytes = 160;
+
+QString valuePreview(const Record &record) {
+  if (!record.value.data())
+    return QStringLiteral("(null)");
+  const int size = static_cast<int>(std::min<std::size_t>(record.value.size(), kPreviewBytes));
+  QString preview = QString::fromUtf8(record.value.data(), size);
+  for (QChar &ch : preview) {
+    if (ch.category() == QChar::Other_Control)
+      ch = QLatin1Char(' ');
+  }
+  if (record.value.size() > static_cast<std::size_t>(kPreviewBytes))
+    preview.append(QChar(0x2026));
+  return preview;
+}
+} // namespace
+
+struct KeyLookup::Run {
+  KeyLookup *owner = nullptr;
+  quint64 generation = 0;
+  std::shared_ptr<BatchSource> source;
+  qint32 partition = 0;
+  QByteArray key;
+  QString indexRoot;
+  std::atomic<bool> stop{false};
+
+  // Queues @p function on the owner's thread unless the run was replaced.
+  template <typename Function> void post(Function function) const {
+    KeyLookup *target = owner;
+    const quint64 expected = generation;
+    QMetaObject::invokeMethod(
+        target,
+        [target, expected, function]() {
+          if (target->m_generation == expected)
+            function();
+        },
+        Qt::QueuedConnection);
+  }
+};
+
+KeyLookup::KeyLookup(QObject *parent) : QObject(parent), m_indexRoot(KeyIndex::defaultRoot()) {
+  m_pool.setObjectName(QStringLiteral("kafka-key-lookup"));
+  m_pool.setMaxThreadCount(1);
+}
+
+// Like TopicSearch, stops without emitting to half destroyed receivers.
+KeyLookup::~KeyLookup() {
+  if (m_run)
+    m_run->stop.store(true);
+  m_pool.waitForDone();
+}
+
+void KeyLookup::start(std::shared_ptr<BatchSource> source, qint32 partition,
+                      const QByteArray &key) {
+  cancel();
+  if (!source)
+    return;
+
+  auto lookup = std::make_shared<Run>();
+  lookup->owner = this;
+  lookup->generation = ++m_generation;
+  lookup->source = std::move(source);
+  lookup->partition = partition;
+  lookup->key = key;
+  lookup->indexRoot = m_indexRoot;
+
+  m_run = lookup;
+  m_running = true;
+  m_cancelled = false;
+  m_error.clear();
+  m_candidates = 0;
+  m_versions = 0;
+  m_pool.start([lookup]() { run(lookup); });
+}
+
+void KeyLookup::cancel() {
+  if (!m_run)
+    return;
+  m_run->stop.store(true);
+  ++m_generation;
+  m_run.reset();
+  if (m_running) {
+    m_running = false;
+    m_cancelled = true;
+    emit finished();
+  }
+}
+
+void KeyLookup::run(const std::shared_ptr<Run> &lookup) {
+  KeyLookup *owner = lookup->owner;
+  QString error;
+  int candidates = 0;
+
+  auto finish = [&]() {
+    lookup->post([owner, lookup, error, candidates]() {
+      owner->m_run.reset();
+      owner->m_running = false;
+      owner->m_cancelled = lookup->stop.load();
+      owner->m_error = error;
+      owner->m_candidates = candidates;
+      emit owner->finished();
+    });
+  };
+
+  const QString persistentKey = lookup->source->persistentKey();
+  if (persistentKey.isEmpty()) {
+    error = QStringLiteral("This topic cannot be identified for indexing");
+    finish();
+    return;
+  }
+
+  KeyIndex index(KeyIndex::directoryFor(lookup->indexRoot, persistentKey, lookup->partition));
+  QElapsedTimer sincePost;
+  sincePost.start();
+  const auto progress = [&](qint64 indexedUntil, qint64 end) {
+    if (sincePost.elapsed() >= kPostIntervalMs) {
+      lookup->post([owner, indexedUntil, end]() { emit owner->indexProgress(indexedUntil, end); });
+      sincePost.restart();
+    }
+    return !lookup->stop.load();
+  };
+  // A failed update still leaves what was indexed before usable.
+  index.update(*lookup->source, lookup->partition, progress, &error);
+  if (lookup->stop.load()) {
+    finish();
+    return;
+  }
+
+  const std::string_view key(lookup->key.constData(), static_cast<std::size_t>(lookup->key.size()));
+  QString lookupError;
+  const QVector<qint64> offsets = index.lookup(key, &lookupError);
+  if (error.isEmpty())
+    error = lookupError;
+  candidates = offsets.size();
+
+  int next = 0;
+  while (next < offsets.size() && !lookup->stop.load()) {
+    BatchChunk chunk;
+    QString readError;
+    if (!lookup->source->read(lookup->partition, offsets[next], kLookupReadBytes, &chunk,
+                              &readError)) {
+      if (error.isEmpty())
+        error = readError;
+      break;
+    }
+    if (chunk.isEmpty())
+      break;
+
+    QVector<SearchMatch> versions;
+    qint64 covered = offsets[next];
+    BatchReader batches(chunk.bytes);
+    RecordBatch batch;
+    while (batches.next(batch) == ParseStatus::Ok) {
+      if (batch.nextOffset() <= offsets[next])
+        continue;
+      covered = std::max(covered, batch.nextOffset());
+      // Only batches holding a candidate are worth inflating.
+      const auto candidate =
+          std::lower_bound(offsets.cbegin() + next, offsets.cend(), batch.baseOffset());
+      if (batch.isControl() || candidate == offsets.cend() || *candidate >= batch.nextOffset())
+        continue;
+
+      std::shared_ptr<const DecodedBatch> decoded;
+      std::string_view section;
+      if (!recordsOf(batch, &decoded, &section))
+        continue;
+
+      RecordReader records(batch, section);
+      Record record;
+      while (records.next(record)) {
+        // The hash may collide, so the key itself decides.
+        if (!record.key.data() || record.key != key ||
+            !std::binary_search(offsets.cbegin() + next, offsets.cend(), record.offset))
+          continue;
+        SearchMatch version;
+        version.partition = lookup->partition;
+        version.offset = record.offset;
+        version.timestamp = record.timestamp;
+        version.field = SearchMatch::Value;
+        version.preview = valuePreview(record);
+        versions.append(std::move(version));
+      }
+    }
+
+    if (!versions.isEmpty()) {
+      lookup->post([owner, versions]() {
+        owner->m_versions += versions.size();
+        emit owner->versionsFound(versions);
+      });
+    }
+    // Candidates the chunk skipped over were compacted away.
+    const int before = next;
+    while (next < offsets.size() && offsets[next] < covered)
+      ++next;
+    if (next == before)
+      ++next;
+  }
+  finish();
+}
+
+} // namespace kafka
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+#include <memory>
+
+#include "core/search/TopicSearch.h"
+
+namespace kafka {
+
+class BatchSource;
+
+/**
+ * @brief Finds every version of one key in a partition through KeyIndex.
+ *
+ * A lookup first brings the partition's index up to date, which only reads
+ * what was produced since the last lookup, then fetches just the offsets
+ * the index names and keeps the records whose key really matches. Versions
+ * arrive through versionsFound() as SearchMatch values carrying a preview
+ * of the record value.
+ */
+class KeyLookup final : public QObject {
+  Q_OBJECT
+
+public:
+  explicit KeyLookup(QObject *parent = nullptr);
+  ~KeyLookup() override;
+
+  /** Uses KeyIndex::defaultRoot() unless set. */
+  void setIndexRoot(const QString &root) { m_indexRoot = root; }
+
+  void start(std::shared_ptr<BatchSource> source, qint32 partition, const QByteArray &key);
+  void cancel();
+
+  bool isRunning() const { return m_running; }
+  /** Valid after finished(). */
+  bool wasCancelled() const { return m_cancelled; }
+  QString errorString() const { return m_error; }
+  /** Offsets the index named, including hash collisions and removed records. */
+  int candidateCount() const { return m_candidates; }
+  int versionCount() const { return m_versions; }
+
+signals:
+  /** Progress of the index update that precedes every lookup. */
+  void indexProgress(qint64 indexedUntil, qint64 end);
+  void versionsFound(const QVector<kafka::SearchMatch> &versions);
+  void finished();
+
+private:
+  struct Run;
+
+  static void run(const std::shared_ptr<Run> &run);
+
+  QThreadPool m_pool;
+  std::shared_ptr<Run> m_run;
+  QString m_indexRoot;
+  quint64 m_generation = 0;
+  bool m_running = false;
+  bool m_cancelled = false;
+  QString m_error;
+  int m_candidates = 0;
+  int m_versions = 0;
+};
+
+} // namespace kafka
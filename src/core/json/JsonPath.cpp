@@ -0,0 +1,346 @@
+#include "core/json/JsonPath.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace kafka {
+
+namespace {
+bool isWhitespace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+// Reads a JSON document front to back; every skip stops at the end of the
+// input instead of failing, and the caller checks what it landed on.
+class Cursor {
+public:
+  explicit Cursor(std::string_view text) : m_p(text.data()), m_end(text.data() + text.size()) {}
+
+  const char *position() const { return m_p; }
+  char peek() const { return m_p < m_end ? *m_p : '\0'; }
+
+  void skipWhitespace() {
+    while (m_p < m_end && isWhitespace(*m_p))
+      ++m_p;
+  }
+
+  bool consume(char c) {
+    skipWhitespace();
+    if (m_p == m_end || *m_p != c)
+      return false;
+    ++m_p;
+    return true;
+  }
+
+  // At an opening quote; leaves the cursor after the closing one and
+  // @p body on what lies between.
+  bool readString(std::string_view *body) {
+    if (m_p == m_end || *m_p != '"')
+      return false;
+    const char *start = ++m_p;
+    while (m_p < m_end) {
+      const auto *quote =
+          static_cast<const char *>(std::memchr(m_p, '"', static_cast<std::size_t>(m_end - m_p)));
+      if (!quote)
+        break;
+      // A quote preceded by an odd run of backslashes is escaped.
+      const char *scan = quote;
+      while (scan > start && scan[-1] == '\\')
+        --scan;
+      m_p = quote + 1;
+      if ((quote - scan) % 2 == 0) {
+        if (body)
+          *body = std::string_view(start, static_cast<std::size_t>(quote - start));
+        return true;
+      }
+    }
+    m_p = m_end;
+    return false;
+  }
+
+  // Skips the value at the cursor. Containers are skipped by bracket
+  // depth alone; only strings need care, for the brackets they contain.
+  bool skipValue() {
+    skipWhitespace();
+    if (m_p == m_end)
+      return false;
+    const char c = *m_p;
+    if (c == '"')
+      return readString(nullptr);
+    if (c == '{' || c == '[') {
+      int depth = 0;
+      while (m_p < m_end) {
+        const char ch = *m_p;
+        if (ch == '"') {
+          if (!readString(nullptr))
+            return false;
+          continue;
+        }
+        ++m_p;
+        if (ch == '{' || ch == '[') {
+          ++depth;
+        } else if (ch == '}' || ch == ']') {
+          if (--depth == 0)
+            return true;
+        }
+      }
+      return false;
+    }
+    const char *start = m_p;
+    while (m_p < m_end && *m_p != ',' && *m_p != '}' && *m_p != ']' && !isWhitespace(*m_p))
+      ++m_p;
+    return m_p > start;
+  }
+
+private:
+  const char *m_p;
+  const char *m_end;
+};
+
+JsonValue::Type typeOf(char first) {
+  switch (first) {
+  case '"':
+    return JsonValue::String;
+  case '{':
+    return JsonValue::Object;
+  case '[':
+    return JsonValue::Array;
+  case 't':
+  case 'f':
+    return JsonValue::Boolean;
+  case 'n':
+    return JsonValue::Null;
+  default:
+    return (first == '-' || (first >= '0' && first <= '9')) ? JsonValue::Number
+                                                           : JsonValue::Missing;
+  }
+}
+
+void appendUtf8(std::string *out, char32_t codePoint) {
+  if (codePoint < 0x80) {
+    out->push_back(static_cast<char>(codePoint));
+  } else if (codePoint < 0x800) {
+    out->push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+    out->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  } else if (codePoint < 0x10000) {
+    out->push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+    out->push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  } else {
+    out->push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+    out->push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  }
+}
+
+bool readHex4(std::string_view raw, std::size_t at, char32_t *value) {
+  if (at + 4 > raw.size())
+    return false;
+  char32_t result = 0;
+  for (std::size_t i = at; i < at + 4; ++i) {
+    const char c = raw[i];
+    result <<= 4;
+    if (c >= '0' && c <= '9')
+      result |= static_cast<char32_t>(c - '0');
+    else if (c >= 'a' && c <= 'f')
+      result |= static_cast<char32_t>(c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F')
+      result |= static_cast<char32_t>(c - 'A' + 10);
+    else
+      return false;
+  }
+  *value = result;
+  return true;
+}
+
+// Compares a member name as written in the document with the step's name.
+bool memberEquals(std::string_view raw, const std::string &name, std::string *scratch) {
+  if (raw.find('\\') == std::string_view::npos)
+    return raw == name;
+  scratch->clear();
+  return JsonPath::unescape(raw, raw.size(), scratch) && *scratch == name;
+}
+} // namespace
+
+QString JsonValue::toDisplayString(std::size_t maxBytes) const {
+  if (type == Missing)
+    return QString();
+  QString result;
+  bool truncated = raw.size() > maxBytes;
+  std::string text;
+  if (type == String && raw.size() >= 2 &&
+      JsonPath::unescape(raw.substr(1, raw.size() - 2), maxBytes, &text)) {
+    result = QString::fromUtf8(text.data(), static_cast<int>(text.size()));
+    truncated = raw.size() - 2 > maxBytes;
+  } else {
+    result = QString::fromUtf8(raw.data(), static_cast<int>(std::min(raw.size(), maxBytes)));
+  }
+  // Escaped newlines and tabs would break the single-line cell.
+  for (QChar &ch : result) {
+    if (ch.category() == QChar::Other_Control)
+      ch = QLatin1Char(' ');
+  }
+  if (truncated)
+    result += QChar(0x2026);
+  return result;
+}
+
+std::shared_ptr<const JsonPath> JsonPath::compile(const QString &expression, QString *error) {
+  auto fail = [error](const QString &message) {
+    if (error)
+      *error = message;
+    return std::shared_ptr<const JsonPath>();
+  };
+
+  const QString text = expression.trimmed();
+  if (!text.startsWith(QLatin1Char('$')))
+    return fail(QStringLiteral("A JSONPath starts with $"));
+
+  std::shared_ptr<JsonPath> path(new JsonPath());
+  path->m_expression = text;
+  int i = 1;
+  while (i < text.size()) {
+    const QChar c = text.at(i);
+    if (c == QLatin1Char('.')) {
+      if (i + 1 < text.size() && text.at(i + 1) == QLatin1Char('.'))
+        return fail(QStringLiteral("Recursive descent (..) is not supported"));
+      int end = i + 1;
+      while (end < text.size() && text.at(end) != QLatin1Char('.') &&
+             text.at(end) != QLatin1Char('['))
+        ++end;
+      const QString name = text.mid(i + 1, end - i - 1);
+      if (name.isEmpty())
+        return fail(QStringLiteral("Missing member name at position %1").arg(i + 1));
+      if (name == QLatin1String("*"))
+        return fail(QStringLiteral("Wildcards are not supported"));
+      path->m_steps.push_back({name.toStdString(), -1});
+      i = end;
+    } else if (c == QLatin1Char('[')) {
+      const int close = text.indexOf(QLatin1Char(']'), i);
+      if (close < 0)
+        return fail(QStringLiteral("Missing ] after position %1").arg(i));
+      const QString inner = text.mid(i + 1, close - i - 1).trimmed();
+      if (inner.size() >= 2 && (inner.startsWith(QLatin1Char('\'')) ||
+                                inner.startsWith(QLatin1Char('"'))) &&
+          inner.endsWith(inner.at(0))) {
+        path->m_steps.push_back({inner.mid(1, inner.size() - 2).toStdString(), -1});
+      } else {
+        bool ok = false;
+        const qint64 index = inner.toLongLong(&ok);
+        if (!ok || index < 0)
+          return fail(QStringLiteral("Unsupported subscript [%1]; use a name or an index >= 0")
+                          .arg(inner));
+        path->m_steps.push_back({std::string(), index});
+      }
+      i = close + 1;
+    } else {
+      return fail(QStringLiteral("Unexpected '%1' at position %2").arg(c).arg(i));
+    }
+  }
+  return path;
+}
+
+JsonValue JsonPath::extract(std::string_view document) const {
+  Cursor cursor(document);
+  std::string scratch;
+  for (const Step &step : m_steps) {
+    if (step.index < 0) {
+      if (!cursor.consume('{'))
+        return {};
+      bool found = false;
+      cursor.skipWhitespace();
+      if (cursor.peek() == '}')
+        return {};
+      while (!found) {
+        cursor.skipWhitespace();
+        std::string_view name;
+        if (!cursor.readString(&name) || !cursor.consume(':'))
+          return {};
+        if (memberEquals(name, step.member, &scratch)) {
+          found = true;
+        } else if (!cursor.skipValue() || !cursor.consume(',')) {
+          return {};
+        }
+      }
+    } else {
+      if (!cursor.consume('['))
+        return {};
+      cursor.skipWhitespace();
+      if (cursor.peek() == ']')
+        return {};
+      for (qint64 element = 0; element < step.index; ++element) {
+        if (!cursor.skipValue() || !cursor.consume(','))
+          return {};
+      }
+    }
+  }
+
+  cursor.skipWhitespace();
+  const char *start = cursor.position();
+  const JsonValue::Type type = typeOf(cursor.peek());
+  if (type == JsonValue::Missing || !cursor.skipValue())
+    return {};
+  JsonValue value;
+  value.type = type;
+  value.raw = std::string_view(start, static_cast<std::size_t>(cursor.position() - start));
+  return value;
+}
+
+bool JsonPath::unescape(std::string_view raw, std::size_t maxBytes, std::string *out) {
+  const std::size_t end = std::min(raw.size(), maxBytes);
+  std::size_t i = 0;
+  while (i < end) {
+    const std::size_t backslash = raw.find('\\', i);
+    if (backslash == std::string_view::npos || backslash >= end) {
+      out->append(raw.data() + i, end - i);
+      return true;
+    }
+    out->append(raw.data() + i, backslash - i);
+    if (backslash + 1 >= raw.size())
+      return false;
+    i = backslash + 2;
+    switch (raw[backslash + 1]) {
+    case '"':
+    case '\\':
+    case '/':
+      out->push_back(raw[backslash + 1]);
+      break;
+    case 'b':
+      out->push_back('\b');
+      break;
+    case 'f':
+      out->push_back('\f');
+      break;
+    case 'n':
+      out->push_back('\n');
+      break;
+    case 'r':
+      out->push_back('\r');
+      break;
+    case 't':
+      out->push_back('\t');
+      break;
+    case 'u': {
+      char32_t codePoint = 0;
+      if (!readHex4(raw, i, &codePoint))
+        return false;
+      i += 4;
+      // A high surrogate followed by an escaped low one forms one code point.
+      char32_t low = 0;
+      if (codePoint >= 0xD800 && codePoint < 0xDC00 && i + 6 <= raw.size() && raw[i] == '\\' &&
+          raw[i + 1] == 'u' && readHex4(raw, i + 2, &low) && low >= 0xDC00 && low < 0xE000) {
+        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+        i += 6;
+      } else if (codePoint >= 0xD800 && codePoint < 0xE000) {
+        codePoint = 0xFFFD;
+      }
+      appendUtf8(out, codePoint);
+      break;
+    }
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace kafka
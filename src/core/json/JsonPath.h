@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QString>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kafka {
+
+/**
+ * @brief Where a JsonPath landed in a document.
+ *
+ * @c raw is the value's text as it appears in the document, strings with
+ * their quotes and escapes, so it stays a view into the record bytes.
+ */
+struct JsonValue {
+  enum Type : quint8 {
+    Missing,
+    Null,
+    Boolean,
+    Number,
+    String,
+    Object,
+    Array,
+  };
+
+  Type type = Missing;
+  std::string_view raw;
+
+  /**
+   * @brief Display text: strings unescaped, anything else as written. At
+   * most about @p maxBytes of the document are converted.
+   */
+  QString toDisplayString(std::size_t maxBytes) const;
+};
+
+/**
+ * @brief A compiled JSONPath expression evaluated on demand.
+ *
+ * Supports the subset that selects one value: $, .member, ['member'] and
+ * [index]. extract() walks the document without building a tree: members
+ * and elements that are not on the path are skipped by scanning for their
+ * end, so a lookup costs one pass over the bytes before the value and
+ * nothing after it. Nothing is allocated unless a member name holds
+ * escapes.
+ *
+ * Immutable once compiled and shared between threads.
+ */
+class JsonPath {
+public:
+  /** Returns null and sets @p error for an empty or unsupported expression. */
+  static std::shared_ptr<const JsonPath> compile(const QString &expression, QString *error);
+
+  QString expression() const { return m_expression; }
+
+  /**
+   * @brief Finds the value the path selects in @p document; Missing when
+   * the document is not JSON or lacks the value.
+   */
+  JsonValue extract(std::string_view document) const;
+
+  /**
+   * @brief Appends the UTF-8 text of the JSON string body @p raw (without
+   * quotes) to @p out, decoding escapes; stops after @p maxBytes of input.
+   * False on a malformed escape.
+   */
+  static bool unescape(std::string_view raw, std::size_t maxBytes, std::string *out);
+
+private:
+  struct Step {
+    std::string member;
+    // -1 for a member step.
+    qint64 index = -1;
+  };
+
+  JsonPath() = default;
+
+  QString m_expression;
+  std::vector<Step> m_steps;
+};
+
+} // namespace kafka
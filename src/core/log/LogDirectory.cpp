@@ -0,0 +1,70 @@
+#include "core/log/LogDirectory.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+#include <algorithm>
+
+namespace kafka {
+
+namespace {
+bool hasSegments(const QDir &dir) {
+  return !dir.entryList({QStringLiteral("*.log")}, QDir::Files).isEmpty();
+}
+} // namespace
+
+bool LogDirectory::parsePartitionDirName(const QString &name, QString *topic,
+                                         qint32 *partition) {
+  const int dash = name.lastIndexOf(QLatin1Char('-'));
+  if (dash <= 0 || dash == name.size() - 1)
+    return false;
+
+  bool ok = false;
+  const int number = name.mid(dash + 1).toInt(&ok);
+  if (!ok || number < 0)
+    return false;
+  *topic = name.left(dash);
+  *partition = number;
+  return true;
+}
+
+QStringList LogDirectory::segmentFiles(const QString &partitionPath) {
+  // Segment names are zero-padded base offsets, so name order is offset
+  // order.
+  QStringList files;
+  const QDir dir(partitionPath);
+  for (const QString &name : dir.entryList({QStringLiteral("*.log")}, QDir::Files, QDir::Name))
+    files.append(dir.filePath(name));
+  return files;
+}
+
+QVector<LogPartitionDirectory> LogDirectory::scan(const QString &path) {
+  QVector<LogPartitionDirectory> result;
+  const QDir root(path);
+
+  auto add = [&result](const QDir &dir) {
+    LogPartitionDirectory entry;
+    if (parsePartitionDirName(dir.dirName(), &entry.topic, &entry.partition) &&
+        hasSegments(dir)) {
+      entry.path = dir.absolutePath();
+      result.append(entry);
+    }
+  };
+
+  if (hasSegments(root)) {
+    add(root);
+  } else {
+    for (const QFileInfo &info : root.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot))
+      add(QDir(info.absoluteFilePath()));
+  }
+
+  std::sort(result.begin(), result.end(),
+            [](const LogPartitionDirectory &a, const LogPartitionDirectory &b) {
+              if (a.topic != b.topic)
+                return a.topic < b.topic;
+              return a.partition < b.partition;
+            });
+  return result;
+}
+
+} // namespace kafka
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace kafka {
+
+/**
+ * @brief A "<topic>-<partition>" directory holding a partition's segments.
+ */
+struct LogPartitionDirectory {
+  QString topic;
+  qint32 partition = 0;
+  QString path;
+};
+
+/**
+ * @brief Finds partition directories on disk, laid out as a broker's
+ * log.dirs entry or copied from one.
+ */
+class LogDirectory {
+public:
+  /**
+   * @brief Scans @p path, which may itself be a partition directory or a
+   * directory containing partition directories. Directories being deleted
+   * or moved by the broker ("-delete", "-future") are skipped. The result
+   * is sorted by topic, then partition.
+   */
+  static QVector<LogPartitionDirectory> scan(const QString &path);
+
+  /** Splits "orders-12" into "orders" and 12. */
+  static bool parsePartitionDirName(const QString &name, QString *topic, qint32 *partition);
+
+  /** Segment log files in @p partitionPath, oldest first. */
+  static QStringList segmentFiles(const QString &partitionPath);
+};
+
+} // namespace kafka
@@ -0,0 +1,88 @@
+#include "core/log/LogIndex.h"
+
+#include "core/protocol/Wire.h"
+
+namespace kafka {
+
+namespace {
+// First index in [0, capacity) for which isPadding holds, assuming padding
+// only ever forms a suffix.
+template <typename Predicate>
+std::size_t paddedEntryStart(std::size_t capacity, Predicate isPadding) {
+  std::size_t low = 0;
+  std::size_t high = capacity;
+  while (low < high) {
+    const std::size_t mid = low + (high - low) / 2;
+    if (isPadding(mid))
+      high = mid;
+    else
+      low = mid + 1;
+  }
+  return low;
+}
+} // namespace
+
+OffsetIndexView::OffsetIndexView(std::string_view bytes, std::int64_t baseOffset)
+    : m_bytes(bytes), m_baseOffset(baseOffset) {
+  // Real entries after the first have a non-zero relative offset, the
+  // zero-filled tail does not; binary search keeps the pages of large
+  // preallocated files untouched.
+  m_entryCount = paddedEntryStart(bytes.size() / kEntrySize, [this](std::size_t i) {
+    return i > 0 && entry(i).offset == m_baseOffset;
+  });
+}
+
+OffsetIndexView::Entry OffsetIndexView::entry(std::size_t index) const {
+  WireReader reader(m_bytes.substr(index * kEntrySize, kEntrySize));
+  Entry result;
+  result.offset = m_baseOffset + reader.readInt32();
+  result.position = reader.readUInt32();
+  return result;
+}
+
+OffsetIndexView::Entry OffsetIndexView::lookup(std::int64_t offset) const {
+  // Binary search for the last entry whose offset is <= the target.
+  std::size_t low = 0;
+  std::size_t high = m_entryCount;
+  while (low < high) {
+    const std::size_t mid = low + (high - low) / 2;
+    if (entry(mid).offset <= offset)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  if (low == 0)
+    return Entry{m_baseOffset, 0};
+  return entry(low - 1);
+}
+
+TimeIndexView::TimeIndexView(std::string_view bytes, std::int64_t baseOffset)
+    : m_bytes(bytes), m_baseOffset(baseOffset) {
+  m_entryCount = paddedEntryStart(bytes.size() / kEntrySize,
+                                  [this](std::size_t i) { return entry(i).timestamp == 0; });
+}
+
+TimeIndexView::Entry TimeIndexView::entry(std::size_t index) const {
+  WireReader reader(m_bytes.substr(index * kEntrySize, kEntrySize));
+  Entry result;
+  result.timestamp = reader.readInt64();
+  result.offset = m_baseOffset + reader.readInt32();
+  return result;
+}
+
+TimeIndexView::Entry TimeIndexView::lookup(std::int64_t timestamp) const {
+  std::size_t low = 0;
+  std::size_t high = m_entryCount;
+  while (low < high) {
+    const std::size_t mid = low + (high - low) / 2;
+    if (entry(mid).timestamp < timestamp)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  if (low == 0)
+    return Entry{-1, m_baseOffset};
+  return entry(low - 1);
+}
+
+} // namespace kafka
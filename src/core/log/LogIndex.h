@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace kafka {
+
+/**
+ * @brief Read-only view over a segment's sparse offset index (.index).
+ *
+ * Each 8-byte entry is a big-endian (relativeOffset, position) pair with
+ * both fields increasing. Index files of the active segment are
+ * preallocated and zero-filled, so the view ends at the first entry that
+ * breaks the ordering.
+ */
+class OffsetIndexView {
+public:
+  static constexpr std::size_t kEntrySize = 8;
+
+  struct Entry {
+    std::int64_t offset = 0;
+    std::uint32_t position = 0;
+  };
+
+  OffsetIndexView() = default;
+  OffsetIndexView(std::string_view bytes, std::int64_t baseOffset);
+
+  std::size_t entryCount() const { return m_entryCount; }
+  Entry entry(std::size_t index) const;
+  /**
+   * @brief Largest entry with offset <= @p offset, or {baseOffset, 0} when
+   * there is none; scanning the log from its position finds @p offset.
+   */
+  Entry lookup(std::int64_t offset) const;
+
+private:
+  std::string_view m_bytes;
+  std::int64_t m_baseOffset = 0;
+  std::size_t m_entryCount = 0;
+};
+
+/**
+ * @brief Read-only view over a segment's sparse time index (.timeindex).
+ *
+ * Each 12-byte entry is a big-endian (timestamp, relativeOffset) pair: the
+ * largest timestamp seen so far and the offset it was seen at.
+ */
+class TimeIndexView {
+public:
+  static constexpr std::size_t kEntrySize = 12;
+
+  struct Entry {
+    std::int64_t timestamp = -1;
+    std::int64_t offset = 0;
+  };
+
+  TimeIndexView() = default;
+  TimeIndexView(std::string_view bytes, std::int64_t baseOffset);
+
+  std::size_t entryCount() const { return m_entryCount; }
+  Entry entry(std::size_t index) const;
+  /**
+   * @brief Largest entry with timestamp < @p timestamp, or {-1, baseOffset}
+   * when there is none. Every record before the returned offset has a
+   * smaller timestamp, so the first match is at or after it.
+   */
+  Entry lookup(std::int64_t timestamp) const;
+
+private:
+  std::string_view m_bytes;
+  std::int64_t m_baseOffset = 0;
+  std::size_t m_entryCount = 0;
+};
+
+} // namespace kafka
@@ -0,0 +1,152 @@
+#include "core/log/LogSegment.h"
+
+#include <QFileInfo>
+#include <QMutexLocker>
+
+#include "core/protocol/RecordBatch.h"
+
+namespace kafka {
+
+namespace {
+constexpr int kSegmentNameDigits = 20;
+} // namespace
+
+LogSegment::LogSegment(const QString &logPath, qint64 baseOffset)
+    : m_baseOffset(baseOffset), m_log(logPath) {
+  const QString stem = logPath.left(logPath.size() - 4);
+  m_index.setFileName(stem + QStringLiteral(".index"));
+  m_timeIndex.setFileName(stem + QStringLiteral(".timeindex"));
+}
+
+std::shared_ptr<LogSegment> LogSegment::forLogFile(const QString &logPath) {
+  const QFileInfo info(logPath);
+  const QString name = info.completeBaseName();
+  if (info.suffix() != QLatin1String("log") || name.size() != kSegmentNameDigits)
+    return nullptr;
+
+  bool ok = false;
+  const qint64 baseOffset = name.toLongLong(&ok);
+  if (!ok || baseOffset < 0)
+    return nullptr;
+  return std::shared_ptr<LogSegment>(new LogSegment(logPath, baseOffset));
+}
+
+std::string_view LogSegment::mapFile(QFile &file, QString *error, bool required) {
+  if (!file.exists() && !required)
+    return {};
+  if (!file.open(QIODevice::ReadOnly)) {
+    if (error)
+      *error = QStringLiteral("%1: %2").arg(file.fileName(), file.errorString());
+    return {};
+  }
+  const qint64 size = file.size();
+  if (size == 0)
+    return {};
+  const uchar *data = file.map(0, size);
+  if (!data) {
+    if (error)
+      *error = QStringLiteral("%1: %2").arg(file.fileName(), file.errorString());
+    return {};
+  }
+  return std::string_view(reinterpret_cast<const char *>(data), static_cast<std::size_t>(size));
+}
+
+bool LogSegment::map(QString *error) {
+  QMutexLocker locker(&m_mutex);
+  if (m_mapped)
+    return true;
+
+  QString mapError;
+  m_logBytes = mapFile(m_log, &mapError, /*required=*/true);
+  if (!mapError.isEmpty()) {
+    if (error)
+      *error = mapError;
+    return false;
+  }
+  // Without its indexes a segment is still readable, only lookups fall
+  // back to scanning batch headers from the start.
+  m_offsetIndex = OffsetIndexView(mapFile(m_index, nullptr, false), m_baseOffset);
+  m_timeIndexView = TimeIndexView(mapFile(m_timeIndex, nullptr, false), m_baseOffset);
+  m_mapped = true;
+  return true;
+}
+
+std::size_t LogSegment::positionForOffset(qint64 offset) const {
+  std::size_t position = m_offsetIndex.lookup(offset).position;
+  if (position > m_logBytes.size())
+    position = 0;
+
+  RecordBatch batch;
+  while (position < m_logBytes.size()) {
+    const ParseStatus status = RecordBatch::parse(m_logBytes.substr(position), batch);
+    if (status == ParseStatus::Ok && batch.lastOffset() >= offset)
+      return position;
+    if (status != ParseStatus::Ok && status != ParseStatus::UnsupportedMagic)
+      break;
+    position += batch.size();
+  }
+  return m_logBytes.size();
+}
+
+bool LogSegment::offsetForTimestamp(qint64 timestamp, qint64 *offset) const {
+  const TimeIndexView::Entry start = m_timeIndexView.lookup(timestamp);
+  std::size_t position = positionForOffset(start.offset);
+
+  RecordBatch batch;
+  while (position < m_logBytes.size()) {
+    const ParseStatus status = RecordBatch::parse(m_logBytes.substr(position), batch);
+    if (status == ParseStatus::UnsupportedMagic) {
+      position += batch.size();
+      continue;
+    }
+    if (status != ParseStatus::Ok)
+      break;
+    position += batch.size();
+    if (batch.maxTimestamp() < timestamp)
+      continue;
+
+    if (batch.compression() == Compression::None) {
+      RecordReader records(batch, batch.recordsSection());
+      Record record;
+      while (records.next(record)) {
+        if (record.timestamp >= timestamp) {
+          *offset = record.offset;
+          return true;
+        }
+      }
+    }
+    *offset = batch.baseOffset();
+    return true;
+  }
+  return false;
+}
+
+qint64 LogSegment::firstOffset() const {
+  BatchReader batches(m_logBytes);
+  RecordBatch batch;
+  if (batches.next(batch) == ParseStatus::Ok)
+    return batch.baseOffset();
+  return m_baseOffset;
+}
+
+qint64 LogSegment::nextOffset() const {
+  QMutexLocker locker(&m_mutex);
+  if (m_nextOffset >= 0)
+    return m_nextOffset;
+
+  // Only the tail after the last index entry needs walking.
+  qint64 next = m_baseOffset;
+  const OffsetIndexView::Entry last =
+      m_offsetIndex.entryCount() > 0 ? m_offsetIndex.entry(m_offsetIndex.entryCount() - 1)
+                                     : OffsetIndexView::Entry{m_baseOffset, 0};
+  const std::size_t start = last.position <= m_logBytes.size() ? last.position : 0;
+  BatchReader batches(m_logBytes.substr(start));
+  RecordBatch batch;
+  while (batches.next(batch) == ParseStatus::Ok)
+    next = batch.nextOffset();
+
+  m_nextOffset = next;
+  return next;
+}
+
+} // namespace kafka
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QFile>
+#include <QMutex>
+#include <QString>
+
+#include <memory>
+#include <string_view>
+
+#include "core/log/LogIndex.h"
+
+namespace kafka {
+
+/**
+ * @brief One on-disk segment of a partition: the .log file and its sparse
+ * .index and .timeindex companions, memory-mapped read-only.
+ *
+ * Files are mapped on first use, never read into the heap; batches are
+ * parsed straight out of the mapping and the views handed out stay valid
+ * for as long as the segment object lives. All methods are thread-safe.
+ */
+class LogSegment {
+public:
+  /**
+   * @brief Describes the segment whose log file is @p logPath (named after
+   * its 20-digit base offset) without touching the files yet. Returns null
+   * when the name is not a segment name.
+   */
+  static std::shared_ptr<LogSegment> forLogFile(const QString &logPath);
+
+  qint64 baseOffset() const { return m_baseOffset; }
+  QString logPath() const { return m_log.fileName(); }
+
+  /** Maps the files; cheap once done. Missing index files are tolerated. */
+  bool map(QString *error);
+
+  /** The mapped log; empty until map() succeeded. */
+  std::string_view log() const { return m_logBytes; }
+
+  /**
+   * @brief Position of the first batch that ends at or after @p offset,
+   * found through the offset index, or log().size() when there is none.
+   */
+  std::size_t positionForOffset(qint64 offset) const;
+  /**
+   * @brief First offset whose record timestamp is >= @p timestamp, found
+   * through the time index. For compressed batches the batch's base offset
+   * is reported. Returns false when the segment has no such record.
+   */
+  bool offsetForTimestamp(qint64 timestamp, qint64 *offset) const;
+  /** Offset of the first batch, baseOffset() for an empty segment. */
+  qint64 firstOffset() const;
+  /** One past the last offset of the last complete batch. */
+  qint64 nextOffset() const;
+
+private:
+  LogSegment(const QString &logPath, qint64 baseOffset);
+  static std::string_view mapFile(QFile &file, QString *error, bool required);
+
+  const qint64 m_baseOffset;
+  QFile m_log;
+  QFile m_index;
+  QFile m_timeIndex;
+
+  mutable QMutex m_mutex;
+  bool m_mapped = false;
+  std::string_view m_logBytes;
+  OffsetIndexView m_offsetIndex;
+  TimeIndexView m_timeIndexView;
+  mutable qint64 m_nextOffset = -1;
+};
+
+} // namespace kafka
@@ -0,0 +1,234 @@
+#include "core/merge/TimestampMerge.h"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+#include "core/codec/DecodedBatchCache.h"
+#include "core/protocol/ApiKeys.h"
+#include "core/scan/BatchWalk.h"
+#include "core/source/BatchSource.h"
+#include "core/trace/Trace.h"
+
+namespace kafka {
+
+struct TimestampMerge::Stream {
+  qint32 partition = 0;
+  // Next offset to take; records below it were taken or skipped.
+  qint64 next = 0;
+  bool exhausted = false;
+  BatchChunk chunk;
+  BatchReader batches{std::string_view()};
+  // Reads the batch being taken from; its records point into @c owner.
+  std::optional<RecordReader> records;
+  qint64 batchEnd = 0;
+  std::shared_ptr<const void> owner;
+  std::size_t ownerBytes = 0;
+  Record head;
+  bool hasHead = false;
+
+  void setChunk(BatchChunk read) {
+    chunk = std::move(read);
+    batches = BatchReader(chunk.bytes);
+    records.reset();
+  }
+};
+
+TimestampMerge::TimestampMerge(std::shared_ptr<BatchSource> source,
+                               const QVector<qint32> &partitions)
+    : m_source(std::move(source)), m_poller(m_source->createPoller()) {
+  m_streams.resize(static_cast<std::size_t>(partitions.size()));
+  for (int i = 0; i < partitions.size(); ++i)
+    m_streams[static_cast<std::size_t>(i)].partition = partitions.at(i);
+  m_heap.reserve(m_streams.size());
+}
+
+TimestampMerge::~TimestampMerge() = default;
+
+bool TimestampMerge::seek(qint64 timestamp, QString *error) {
+  KAFKA_TRACE_SCOPE("merge seek");
+  QVector<qint32> partitions;
+  partitions.reserve(static_cast<int>(m_streams.size()));
+  for (const Stream &stream : m_streams)
+    partitions.append(stream.partition);
+
+  QVector<qint64> offsets;
+  if (!m_source->offsetsForTimestamp(partitions, timestamp, &offsets, error))
+    return false;
+  QVector<MergePosition> positions;
+  positions.reserve(partitions.size());
+  for (int i = 0; i < partitions.size() && i < offsets.size(); ++i)
+    positions.append(MergePosition{partitions.at(i), offsets.at(i)});
+  return restore(positions, error);
+}
+
+bool TimestampMerge::restore(const QVector<MergePosition> &positions, QString *error) {
+  KAFKA_TRACE_SCOPE("merge restore");
+  m_heap.clear();
+  m_refill = -1;
+  QVector<PollTarget> targets;
+  targets.reserve(static_cast<int>(m_streams.size()));
+  for (Stream &stream : m_streams) {
+    const auto it = std::find_if(positions.cbegin(), positions.cend(),
+                                 [&](const MergePosition &p) {
+                                   return p.partition == stream.partition;
+                                 });
+    stream.next = it != positions.cend() ? it->offset : 0;
+    stream.exhausted = false;
+    stream.hasHead = false;
+    stream.owner.reset();
+    stream.setChunk(BatchChunk());
+    targets.append(PollTarget{stream.partition, stream.next, kReadBytes});
+  }
+
+  // One poll reads the first chunk of every partition, a request per
+  // broker for a cluster.
+  QVector<BatchChunk> chunks;
+  if (!m_poller->poll(targets, &chunks, error))
+    return false;
+  for (std::size_t i = 0; i < m_streams.size(); ++i) {
+    Stream &stream = m_streams[i];
+    const int index = static_cast<int>(i);
+    if (index >= chunks.size() || chunks.at(index).errorCode != 0) {
+      if (error && index < chunks.size() && error->isEmpty())
+        *error = QStringLiteral("Partition %1: error %2 (%3)")
+                     .arg(stream.partition)
+                     .arg(chunks.at(index).errorCode)
+                     .arg(QLatin1String(errorName(chunks.at(index).errorCode)));
+      return false;
+    }
+    stream.setChunk(chunks.at(index));
+    if (stream.chunk.isEmpty())
+      stream.exhausted = true;
+    else if (!fill(stream, /*freshChunk=*/true, error))
+      return false;
+    if (stream.hasHead)
+      push(index);
+  }
+  return true;
+}
+
+QVector<MergePosition> TimestampMerge::position() const {
+  QVector<MergePosition> positions;
+  positions.reserve(static_cast<int>(m_streams.size()));
+  for (const Stream &stream : m_streams)
+    positions.append(
+        MergePosition{stream.partition, stream.hasHead ? stream.head.offset : stream.next});
+  return positions;
+}
+
+bool TimestampMerge::next(MergedRecord *record, QString *error) {
+  if (m_refill >= 0) {
+    Stream &stream = m_streams[static_cast<std::size_t>(m_refill)];
+    if (!fill(stream, /*freshChunk=*/false, error))
+      return false;
+    if (stream.hasHead)
+      push(m_refill);
+    m_refill = -1;
+  }
+  if (m_heap.empty())
+    return false;
+
+  const auto later = [this](int a, int b) { return before(b, a); };
+  std::pop_heap(m_heap.begin(), m_heap.end(), later);
+  const int index = m_heap.back();
+  m_heap.pop_back();
+
+  Stream &stream = m_streams[static_cast<std::size_t>(index)];
+  record->partition = stream.partition;
+  record->record = stream.head;
+  record->owner = stream.owner;
+  record->ownerBytes = stream.ownerBytes;
+  stream.next = stream.head.offset + 1;
+  stream.hasHead = false;
+  m_refill = index;
+  return true;
+}
+
+// Moves to the next record at or after stream.next within the chunk held.
+bool TimestampMerge::takeRecord(Stream &stream) {
+  for (;;) {
+    if (stream.records) {
+      Record record;
+      while (stream.records->next(record)) {
+        if (record.offset >= stream.next) {
+          stream.head = record;
+          stream.hasHead = true;
+          return true;
+        }
+      }
+      stream.records.reset();
+      // Compaction may have removed the last offsets of the batch.
+      stream.next = std::max(stream.next, stream.batchEnd);
+    }
+
+    RecordBatch batch;
+    if (stream.batches.next(batch) != ParseStatus::Ok)
+      return false;
+    if (batch.nextOffset() <= stream.next)
+      continue;
+    if (batch.isControl()) {
+      stream.next = batch.nextOffset();
+      continue;
+    }
+
+    std::shared_ptr<const DecodedBatch> decoded;
+    std::string_view section;
+    if (!recordsOf(batch, &decoded, &section)) {
+      ++m_undecodableBatches;
+      stream.next = batch.nextOffset();
+      continue;
+    }
+    stream.owner = stream.chunk.owner;
+    stream.ownerBytes = stream.chunk.bytes.size();
+    if (decoded) {
+      stream.ownerBytes = decoded->header.size() + decoded->records.size();
+      stream.owner = std::move(decoded);
+    }
+    stream.batchEnd = batch.nextOffset();
+    stream.records.emplace(batch, section);
+  }
+}
+
+bool TimestampMerge::fill(Stream &stream, bool freshChunk, QString *error) {
+  stream.hasHead = false;
+  while (!stream.exhausted) {
+    const qint64 start = stream.next;
+    if (takeRecord(stream))
+      return true;
+    // A chunk that moved nothing forward (a batch larger than the read, a
+    // corrupt one) would be read again forever.
+    if (freshChunk && stream.next == start) {
+      stream.exhausted = true;
+      break;
+    }
+
+    BatchChunk chunk;
+    if (!m_source->read(stream.partition, stream.next, kReadBytes, &chunk, error))
+      return false;
+    stream.setChunk(std::move(chunk));
+    stream.exhausted = stream.chunk.isEmpty();
+    freshChunk = true;
+  }
+  stream.setChunk(BatchChunk());
+  stream.owner.reset();
+  return true;
+}
+
+void TimestampMerge::push(int stream) {
+  m_heap.push_back(stream);
+  std::push_heap(m_heap.begin(), m_heap.end(),
+                 [this](int a, int b) { return before(b, a); });
+}
+
+bool TimestampMerge::before(int a, int b) const {
+  const Stream &left = m_streams[static_cast<std::size_t>(a)];
+  const Stream &right = m_streams[static_cast<std::size_t>(b)];
+  if (left.head.timestamp != right.head.timestamp)
+    return left.head.timestamp < right.head.timestamp;
+  if (left.partition != right.partition)
+    return left.partition < right.partition;
+  return left.head.offset < right.head.offset;
+}
+
+} // namespace kafka
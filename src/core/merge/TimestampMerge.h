@@ -0,0 +1,108 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+#include "core/protocol/RecordBatch.h"
+
+namespace kafka {
+
+class BatchPoller;
+class BatchSource;
+
+/**
+ * @brief A record of the merged sequence. @c record points into @c owner,
+ * which keeps its buffer (a fetch frame, a mapped segment, a decoded batch)
+ * alive for as long as the copy exists.
+ */
+struct MergedRecord {
+  qint32 partition = 0;
+  Record record;
+  std::shared_ptr<const void> owner;
+  /** Size of the buffer @c owner keeps alive, for accounting. */
+  std::size_t ownerBytes = 0;
+};
+
+/**
+ * @brief Where a merge stands in one partition: the next offset it would
+ * take from it.
+ */
+struct MergePosition {
+  qint32 partition = 0;
+  qint64 offset = 0;
+};
+
+/**
+ * @brief Reads several partitions of a source as one sequence ordered by
+ * record timestamp.
+ *
+ * Each partition is a stream in offset order that holds one read chunk at
+ * a time; a binary heap keyed by (timestamp, partition, offset) picks the
+ * stream whose next record comes first. Taking a record costs O(log k) for
+ * k partitions and memory stays at one chunk per partition, however long
+ * the merged range is; nothing is ever sorted as a whole. Records of one
+ * partition keep their offset order even where their timestamps do not.
+ *
+ * position() is a checkpoint of a few bytes per partition from which
+ * restore() resumes the sequence exactly, so callers can page through it
+ * and rebuild a page they dropped without keeping its records.
+ *
+ * Blocking and not thread-safe; use from one worker thread at a time.
+ */
+class TimestampMerge {
+public:
+  static constexpr qint32 kReadBytes = 256 * 1024;
+
+  TimestampMerge(std::shared_ptr<BatchSource> source, const QVector<qint32> &partitions);
+  ~TimestampMerge();
+
+  TimestampMerge(const TimestampMerge &) = delete;
+  TimestampMerge &operator=(const TimestampMerge &) = delete;
+
+  /**
+   * @brief Starts every partition at its first record at or after
+   * @p timestamp (ms since epoch), looked up for all partitions at once.
+   */
+  bool seek(qint64 timestamp, QString *error);
+  /**
+   * @brief Resumes from a position() taken earlier. The first chunk of
+   * every partition is read in one poll of the source.
+   */
+  bool restore(const QVector<MergePosition> &positions, QString *error);
+  QVector<MergePosition> position() const;
+
+  /**
+   * @brief Takes the next record in timestamp order. Returns false at the
+   * end of every partition, or with @p error set when a read failed; the
+   * failed read is retried by the next call.
+   */
+  bool next(MergedRecord *record, QString *error);
+  bool atEnd() const { return m_heap.empty() && m_refill < 0; }
+
+  /** Compressed batches that could not be decoded and were skipped. */
+  int undecodableBatchCount() const { return m_undecodableBatches; }
+
+private:
+  struct Stream;
+
+  bool takeRecord(Stream &stream);
+  bool fill(Stream &stream, bool freshChunk, QString *error);
+  void push(int stream);
+  bool before(int a, int b) const;
+
+  std::shared_ptr<BatchSource> m_source;
+  std::unique_ptr<BatchPoller> m_poller;
+  std::vector<Stream> m_streams;
+  // Streams with a record to give, as a min-heap through before().
+  std::vector<int> m_heap;
+  // The stream whose record next() returned last. It is refilled by the
+  // following call, which can then report a failed read without having
+  // lost a record.
+  int m_refill = -1;
+  int m_undecodableBatches = 0;
+};
+
+} // namespace kafka
@@ -0,0 +1,228 @@
+#include "core/network/BrokerConnection.h"
+
+#include <QTcpSocket>
+#include <QtEndian>
+
+#include <limits>
+#include <utility>
+
+#include "core/protocol/Messages.h"
+
+namespace kafka {
+
+namespace {
+// Fetch responses are bounded by FetchRequest::maxBytes; anything far above
+// that is a desynchronised stream rather than a real frame.
+constexpr qint32 kMaxFrameSize = 256 * 1024 * 1024;
+} // namespace
+
+BrokerConnection::BrokerConnection(qint32 nodeId, const QString &host, quint16 port,
+                                   QObject *parent)
+    : QObject(parent), m_nodeId(nodeId), m_host(host), m_port(port) {}
+
+BrokerConnection::~BrokerConnection() = default;
+
+qint16 BrokerConnection::negotiatedVersion(ApiKey key) const {
+  return m_versions.value(static_cast<qint16>(key), -1);
+}
+
+void BrokerConnection::send(ApiKey key, BodyEncoder encoder, ResponseHandler handler) {
+  m_queued.push_back(Request{key, std::move(encoder), std::move(handler)});
+  ensureConnected();
+  flushQueue();
+}
+
+void BrokerConnection::close() {
+  if (m_socket)
+    m_socket->abort();
+  failAll(tr("Connection closed"));
+}
+
+void BrokerConnection::ensureConnected() {
+  if (m_state != State::Disconnected)
+    return;
+
+  if (!m_socket) {
+    m_socket = new QTcpSocket(this);
+    connect(m_socket, &QTcpSocket::connected, this, &BrokerConnection::onConnected);
+    connect(m_socket, &QTcpSocket::readyRead, this, &BrokerConnection::onReadyRead);
+    connect(m_socket, &QTcpSocket::disconnected, this, &BrokerConnection::onDisconnected);
+    connect(m_socket, &QTcpSocket::errorOccurred, this, &BrokerConnection::onSocketError);
+  }
+
+  m_state = State::Connecting;
+  m_sizePrefixFilled = 0;
+  m_frame.clear();
+  m_frameFilled = 0;
+  m_socket->connectToHost(m_host, m_port);
+}
+
+void BrokerConnection::onConnected() {
+  m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+  m_state = State::Negotiating;
+  negotiateVersions();
+}
+
+void BrokerConnection::negotiateVersions() {
+  Request request;
+  request.apiKey = ApiKey::ApiVersions;
+  request.encoder = [](qint16) { return std::string(); };
+  request.handler = [this](const BrokerResponse &response) {
+    if (!response.ok)
+      return;
+
+    ApiVersionsResponse decoded;
+    WireReader reader(response.body);
+    if (!decoded.decode(reader, 0) || decoded.errorCode != 0) {
+      m_socket->abort();
+      failAll(tr("ApiVersions negotiation with broker %1 failed").arg(m_nodeId));
+      return;
+    }
+
+    m_versions.clear();
+    for (const SupportedVersion &ours : supportedVersions()) {
+      for (const ApiVersionRange &theirs : decoded.apiKeys) {
+        if (theirs.apiKey != static_cast<qint16>(ours.apiKey))
+          continue;
+        const qint16 version = qMin(ours.maxVersion, theirs.maxVersion);
+        if (version >= qMax(ours.minVersion, theirs.minVersion))
+          m_versions.insert(theirs.apiKey, version);
+      }
+    }
+
+    m_state = State::Ready;
+    emit ready();
+    flushQueue();
+  };
+  dispatch(request, 0);
+}
+
+void BrokerConnection::flushQueue() {
+  while (m_state == State::Ready && !m_queued.empty() && m_inFlight.size() < m_maxInFlight) {
+    Request request = std::move(m_queued.front());
+    m_queued.pop_front();
+
+    const qint16 version = negotiatedVersion(request.apiKey);
+    if (version < 0) {
+      BrokerResponse response;
+      response.error = tr("Broker %1 does not support %2")
+                           .arg(m_nodeId)
+                           .arg(QLatin1String(apiKeyName(request.apiKey)));
+      request.handler(response);
+      continue;
+    }
+    dispatch(request, version);
+  }
+}
+
+void BrokerConnection::dispatch(const Request &request, qint16 version) {
+  RequestHeader header;
+  header.apiKey = request.apiKey;
+  header.apiVersion = version;
+  header.correlationId = m_nextCorrelationId;
+  header.clientId = m_clientId;
+  m_nextCorrelationId = m_nextCorrelationId == std::numeric_limits<qint32>::max()
+                            ? 1
+                            : m_nextCorrelationId + 1;
+
+  const std::string frame = encodeRequestFrame(header, request.encoder(version));
+  m_inFlight.insert(header.correlationId,
+                    InFlight{version, isFlexibleVersion(request.apiKey, version), request.handler});
+  m_socket->write(frame.data(), static_cast<qint64>(frame.size()));
+}
+
+void BrokerConnection::onReadyRead() {
+  while (m_socket && m_socket->bytesAvailable() > 0) {
+    if (m_sizePrefixFilled < 4) {
+      const qint64 read =
+          m_socket->read(m_sizePrefix + m_sizePrefixFilled, 4 - m_sizePrefixFilled);
+      if (read <= 0)
+        return;
+      m_sizePrefixFilled += static_cast<int>(read);
+      if (m_sizePrefixFilled < 4)
+        return;
+
+      const qint32 size = qFromBigEndian<qint32>(m_sizePrefix);
+      if (size < 4 || size > kMaxFrameSize) {
+        m_socket->abort();
+        failAll(tr("Broker %1 sent an invalid frame size (%2)").arg(m_nodeId).arg(size));
+        return;
+      }
+      m_frame = QByteArray(size, Qt::Uninitialized);
+      m_frameFilled = 0;
+    }
+
+    const qint64 read = m_socket->read(m_frame.data() + m_frameFilled,
+                                       m_frame.size() - m_frameFilled);
+    if (read <= 0)
+      return;
+    m_frameFilled += static_cast<int>(read);
+    if (m_frameFilled < m_frame.size())
+      continue;
+
+    const QByteArray frame = std::move(m_frame);
+    m_frame = QByteArray();
+    m_frameFilled = 0;
+    m_sizePrefixFilled = 0;
+    handleFrame(frame);
+  }
+}
+
+void BrokerConnection::handleFrame(const QByteArray &frame) {
+  const qint32 correlationId = qFromBigEndian<qint32>(frame.constData());
+  const auto it = m_inFlight.find(correlationId);
+  if (it == m_inFlight.end())
+    return;
+
+  const InFlight inFlight = it.value();
+  m_inFlight.erase(it);
+
+  BrokerResponse response;
+  response.ok = true;
+  response.apiVersion = inFlight.apiVersion;
+  response.frame = frame;
+  response.body = std::string_view(frame.constData() + 4, static_cast<std::size_t>(frame.size() - 4));
+  if (inFlight.flexible) {
+    WireReader header(response.body);
+    header.skipTaggedFields();
+    if (!header.ok()) {
+      response.ok = false;
+      response.error = tr("Broker %1 sent a malformed response header").arg(m_nodeId);
+    }
+    response.body.remove_prefix(header.position());
+  }
+  inFlight.handler(response);
+
+  flushQueue();
+}
+
+void BrokerConnection::onSocketError(QAbstractSocket::SocketError) {
+  const QString error =
+      tr("Broker %1 (%2:%3): %4").arg(m_nodeId).arg(m_host).arg(m_port).arg(m_socket->errorString());
+  failAll(error);
+}
+
+void BrokerConnection::onDisconnected() {
+  failAll(tr("Broker %1 closed the connection").arg(m_nodeId));
+}
+
+void BrokerConnection::failAll(const QString &error) {
+  const bool wasActive = m_state != State::Disconnected;
+  m_state = State::Disconnected;
+
+  BrokerResponse response;
+  response.error = error;
+
+  // Handlers may queue follow-up requests, so detach both containers first.
+  const QHash<qint32, InFlight> inFlight = std::exchange(m_inFlight, {});
+  std::deque<Request> queued = std::exchange(m_queued, {});
+  for (const InFlight &pending : inFlight)
+    pending.handler(response);
+  for (const Request &request : queued)
+    request.handler(response);
+
+  if (wasActive)
+    emit failed(error);
+}
+
+} // namespace kafka
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <QAbstractSocket>
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QString>
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "core/protocol/ApiKeys.h"
+
+class QTcpSocket;
+
+namespace kafka {
+
+/**
+ * @brief Response delivered to a BrokerConnection request handler.
+ *
+ * @c body views into @c frame, which is implicitly shared, so handlers can
+ * keep the frame (and any views into it) alive simply by copying it.
+ */
+struct BrokerResponse {
+  bool ok = false;
+  QString error;
+  qint16 apiVersion = 0;
+  QByteArray frame;
+  std::string_view body;
+};
+
+/**
+ * @brief One non-blocking TCP connection to a broker.
+ *
+ * Requests are pipelined: up to maxInFlight() requests are written before
+ * their responses arrive, and Kafka guarantees responses come back in order
+ * on a connection. Requests issued before the connection is up are queued
+ * and sent once ApiVersions negotiation completes.
+ *
+ * Not thread-safe; lives on the thread of the owning KafkaClient.
+ */
+class BrokerConnection final : public QObject {
+  Q_OBJECT
+
+public:
+  using ResponseHandler = std::function<void(const BrokerResponse &)>;
+  /**
+   * @brief Encodes a request body for the negotiated @p version. Invoked
+   * when the request is dispatched, so versions are known by then.
+   */
+  using BodyEncoder = std::function<std::string(qint16 version)>;
+
+  BrokerConnection(qint32 nodeId, const QString &host, quint16 port,
+                   QObject *parent = nullptr);
+  ~BrokerConnection() override;
+
+  qint32 nodeId() const { return m_nodeId; }
+  QString host() const { return m_host; }
+  quint16 port() const { return m_port; }
+
+  void setClientId(const QString &clientId) { m_clientId = clientId.toStdString(); }
+  void setMaxInFlight(int maxInFlight) { m_maxInFlight = qMax(1, maxInFlight); }
+  int maxInFlight() const { return m_maxInFlight; }
+  int inFlightCount() const { return m_inFlight.size(); }
+  int queuedCount() const { return static_cast<int>(m_queued.size()); }
+
+  bool isReady() const { return m_state == State::Ready; }
+
+  /**
+   * @brief Highest version of @p key both sides support, or -1.
+   */
+  qint16 negotiatedVersion(ApiKey key) const;
+
+  /**
+   * @brief Queues a request; connects on first use.
+   */
+  void send(ApiKey key, BodyEncoder encoder, ResponseHandler handler);
+
+  void close();
+
+signals:
+  void ready();
+  void failed(const QString &error);
+
+private slots:
+  void onConnected();
+  void onReadyRead();
+  void onSocketError(QAbstractSocket::SocketError error);
+  void onDisconnected();
+
+private:
+  enum class State { Disconnected, Connecting, Negotiating, Ready };
+
+  struct Request {
+    ApiKey apiKey = ApiKey::ApiVersions;
+    BodyEncoder encoder;
+    ResponseHandler handler;
+  };
+
+  struct InFlight {
+    qint16 apiVersion = 0;
+    // Flexible responses carry a tagged field section after the
+    // correlation id.
+    bool flexible = false;
+    ResponseHandler handler;
+  };
+
+  void ensureConnected();
+  void negotiateVersions();
+  void dispatch(const Request &request, qint16 version);
+  void flushQueue();
+  void handleFrame(const QByteArray &frame);
+  void failAll(const QString &error);
+
+  qint32 m_nodeId = -1;
+  QString m_host;
+  quint16 m_port = 0;
+  std::string m_clientId = "kafka-viewer";
+  QTcpSocket *m_socket = nullptr;
+  State m_state = State::Disconnected;
+
+  std::deque<Request> m_queued;
+  QHash<qint32, InFlight> m_inFlight;
+  int m_maxInFlight = 5;
+  qint32 m_nextCorrelationId = 1;
+  QHash<qint16, qint16> m_versions;
+
+  // Frames are read straight into their own buffer once the size prefix is
+  // known, so a response is copied out of the socket exactly once.
+  char m_sizePrefix[4] = {};
+  int m_sizePrefixFilled = 0;
+  QByteArray m_frame;
+  int m_frameFilled = 0;
+};
+
+} // namespace kafka
@@ -0,0 +1,69 @@
+#include "core/network/ClientTypes.h"
+
+namespace kafka {
+
+const BrokerInfo *ClusterMetadata::broker(qint32 nodeId) const {
+  for (const BrokerInfo &info : brokers) {
+    if (info.nodeId == nodeId)
+      return &info;
+  }
+  return nullptr;
+}
+
+const TopicInfo *ClusterMetadata::topic(const QString &name) const {
+  for (const TopicInfo &info : topics) {
+    if (info.name == name)
+      return &info;
+  }
+  return nullptr;
+}
+
+qint32 ClusterMetadata::leaderFor(const TopicPartition &tp) const {
+  const TopicInfo *info = topic(tp.topic);
+  if (!info)
+    return -1;
+  for (const PartitionInfo &partition : info->partitions) {
+    if (partition.partition == tp.partition)
+      return partition.leader;
+  }
+  return -1;
+}
+
+MetadataDiff diffMetadata(const ClusterMetadata &before, const ClusterMetadata &after) {
+  MetadataDiff diff;
+  diff.brokersChanged =
+      before.brokers != after.brokers || before.controllerId != after.controllerId;
+  if (diff.brokersChanged) {
+    diff.brokers = after.brokers;
+    diff.controllerId = after.controllerId;
+  }
+
+  // Both sides can hold tens of thousands of partitions; index by name
+  // once instead of calling topic() per topic.
+  QHash<QString, const TopicInfo *> previous;
+  previous.reserve(before.topics.size());
+  for (const TopicInfo &topic : before.topics)
+    previous.insert(topic.name, &topic);
+
+  for (const TopicInfo &topic : after.topics) {
+    const TopicInfo *old = previous.take(topic.name);
+    if (!old || *old != topic)
+      diff.changedTopics.append(topic);
+  }
+  for (auto it = previous.cbegin(); it != previous.cend(); ++it)
+    diff.removedTopics.append(it.key());
+  return diff;
+}
+
+void registerClientMetaTypes() {
+  qRegisterMetaType<kafka::TopicPartition>();
+  qRegisterMetaType<kafka::ClusterMetadata>();
+  qRegisterMetaType<kafka::MetadataDiff>();
+  qRegisterMetaType<kafka::PartitionOffset>();
+  qRegisterMetaType<kafka::FetchedPartition>();
+  qRegisterMetaType<kafka::GroupOffsetsSnapshot>();
+  qRegisterMetaType<QVector<kafka::PartitionOffset>>();
+  qRegisterMetaType<QVector<kafka::FetchedPartition>>();
+}
+
+} // namespace kafka
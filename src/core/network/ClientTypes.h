@@ -0,0 +1,227 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QUuid>
+#include <QVector>
+
+#include <string_view>
+
+namespace kafka {
+
+struct TopicPartition {
+  QString topic;
+  qint32 partition = 0;
+
+  bool operator==(const TopicPartition &other) const {
+    return partition == other.partition && topic == other.topic;
+  }
+  bool operator!=(const TopicPartition &other) const { return !(*this == other); }
+};
+
+inline uint qHash(const TopicPartition &tp, uint seed = 0) {
+  return ::qHash(tp.topic, seed) ^ ::qHash(tp.partition, seed);
+}
+
+struct BrokerInfo {
+  qint32 nodeId = -1;
+  QString host;
+  quint16 port = 0;
+  QString rack;
+
+  bool operator==(const BrokerInfo &other) const {
+    return nodeId == other.nodeId && port == other.port && host == other.host &&
+           rack == other.rack;
+  }
+  bool operator!=(const BrokerInfo &other) const { return !(*this == other); }
+};
+
+struct PartitionInfo {
+  qint32 partition = 0;
+  qint32 leader = -1;
+  qint16 errorCode = 0;
+  QVector<qint32> replicas;
+  QVector<qint32> isr;
+
+  bool operator==(const PartitionInfo &other) const {
+    return partition == other.partition && leader == other.leader &&
+           errorCode == other.errorCode && replicas == other.replicas && isr == other.isr;
+  }
+  bool operator!=(const PartitionInfo &other) const { return !(*this == other); }
+};
+
+struct TopicInfo {
+  QString name;
+  /**
+   * @brief Differs between a topic and one created again under its name;
+   * null when the broker predates topic ids (Metadata v10, Kafka 2.8).
+   */
+  QUuid topicId;
+  bool isInternal = false;
+  qint16 errorCode = 0;
+  QVector<PartitionInfo> partitions;
+
+  bool operator==(const TopicInfo &other) const {
+    return isInternal == other.isInternal && errorCode == other.errorCode &&
+           name == other.name && topicId == other.topicId && partitions == other.partitions;
+  }
+  bool operator!=(const TopicInfo &other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Snapshot of the cluster topology as returned by a Metadata request.
+ */
+struct ClusterMetadata {
+  QVector<BrokerInfo> brokers;
+  qint32 controllerId = -1;
+  QVector<TopicInfo> topics;
+
+  const BrokerInfo *broker(qint32 nodeId) const;
+  const TopicInfo *topic(const QString &name) const;
+  /**
+   * @brief Returns the leader node of @p tp, or -1 when unknown.
+   */
+  qint32 leaderFor(const TopicPartition &tp) const;
+};
+
+/**
+ * @brief What changed between two metadata snapshots.
+ *
+ * Applying a diff to the snapshot it was computed from gives the newer
+ * one: brokers and controller are replaced when brokersChanged is set,
+ * changedTopics are added or replace the topic of the same name, and
+ * removedTopics are dropped.
+ */
+struct MetadataDiff {
+  /** Set when the diff carries a tree read from the on-disk cache. */
+  bool fromCache = false;
+  bool brokersChanged = false;
+  QVector<BrokerInfo> brokers;
+  qint32 controllerId = -1;
+  QVector<TopicInfo> changedTopics;
+  QStringList removedTopics;
+
+  bool isEmpty() const {
+    return !brokersChanged && changedTopics.isEmpty() && removedTopics.isEmpty();
+  }
+};
+
+/**
+ * @brief Topics of @p after that are new or differ from @p before, and the
+ * topics of @p before it no longer has.
+ */
+MetadataDiff diffMetadata(const ClusterMetadata &before, const ClusterMetadata &after);
+
+struct PartitionOffset {
+  TopicPartition tp;
+  qint16 errorCode = 0;
+  qint64 timestamp = -1;
+  qint64 offset = -1;
+};
+
+struct FetchTarget {
+  TopicPartition tp;
+  qint64 offset = 0;
+  qint32 maxBytes = 1 << 20;
+};
+
+/**
+ * @brief Result of fetching one partition.
+ *
+ * The record batches are not copied out of the response: @c frame keeps the
+ * whole implicitly shared response alive and records() views into it.
+ */
+struct FetchedPartition {
+  TopicPartition tp;
+  qint16 errorCode = 0;
+  qint64 fetchOffset = 0;
+  qint64 highWatermark = -1;
+  qint64 lastStableOffset = -1;
+  QByteArray frame;
+  int recordsBegin = 0;
+  int recordsSize = 0;
+
+  std::string_view records() const {
+    return std::string_view(frame.constData() + recordsBegin,
+                            static_cast<std::size_t>(recordsSize));
+  }
+};
+
+/**
+ * @brief A record batch to append to @c tp. The bytes are implicitly
+ * shared and only copied when the request frame is written.
+ */
+struct ProduceBatch {
+  TopicPartition tp;
+  QByteArray records;
+};
+
+/**
+ * @brief The leader's answer for one ProduceBatch.
+ */
+struct ProducedBatch {
+  TopicPartition tp;
+  qint16 errorCode = 0;
+  /** Offset the leader assigned to the first record, or -1. */
+  qint64 baseOffset = -1;
+};
+
+/**
+ * @brief Identity of an idempotent producer, as handed out by InitProducerId.
+ */
+struct ProducerId {
+  qint64 id = -1;
+  qint16 epoch = -1;
+};
+
+struct CommittedOffset {
+  TopicPartition tp;
+  /** -1 when the group has no offset for the partition. */
+  qint64 offset = -1;
+  qint16 errorCode = 0;
+};
+
+/**
+ * @brief The offsets one consumer group committed, as its coordinator
+ * reported them.
+ */
+struct GroupOffsets {
+  QString groupId;
+  /** "consumer" for consumer groups; empty for groups that only commit. */
+  QString protocolType;
+  qint32 coordinator = -1;
+  qint16 errorCode = 0;
+  QVector<CommittedOffset> offsets;
+};
+
+/**
+ * @brief Committed offsets of every group in the cluster, and what it took
+ * to collect them.
+ */
+struct GroupOffsetsSnapshot {
+  QVector<GroupOffsets> groups;
+  /** ListGroups and OffsetFetch requests sent. */
+  int requestCount = 0;
+  /** Brokers that could not be asked; the groups they coordinate are missing. */
+  QStringList brokerErrors;
+};
+
+/**
+ * @brief Registers the types above for queued signal delivery. Called once
+ * by KafkaClient; harmless to call again.
+ */
+void registerClientMetaTypes();
+
+} // namespace kafka
+
+Q_DECLARE_METATYPE(kafka::TopicPartition)
+Q_DECLARE_METATYPE(kafka::ClusterMetadata)
+Q_DECLARE_METATYPE(kafka::MetadataDiff)
+Q_DECLARE_METATYPE(kafka::PartitionOffset)
+Q_DECLARE_METATYPE(kafka::FetchedPartition)
+Q_DECLARE_METATYPE(kafka::GroupOffsetsSnapshot)
+Q_DECLARE_METATYPE(QVector<kafka::PartitionOffset>)
+Q_DECLARE_METATYPE(QVector<kafka::FetchedPartition>)
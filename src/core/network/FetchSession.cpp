@@ -0,0 +1,131 @@
+#include "core/network/FetchSession.h"
+
+#include <limits>
+
+#include "core/protocol/Messages.h"
+
+namespace kafka {
+
+namespace {
+// Fetch v7 introduced sessions.
+constexpr qint16 kFirstSessionVersion = 7;
+
+// Groups partitions by topic in the order they come, like a request built
+// by hand would.
+class TopicGrouper {
+public:
+  explicit TopicGrouper(FetchRequest *request) : m_request(request) {}
+
+  void add(const FetchTarget &target) {
+    auto it = m_topics.find(target.tp.topic);
+    if (it == m_topics.end()) {
+      it = m_topics.insert(target.tp.topic, m_request->topics.size());
+      m_request->topics.push_back(FetchTopic{target.tp.topic.toStdString(), {}});
+    }
+    FetchPartition partition;
+    partition.partition = target.tp.partition;
+    partition.fetchOffset = target.offset;
+    partition.maxBytes = target.maxBytes;
+    m_request->topics[it.value()].partitions.push_back(partition);
+  }
+
+  void forget(const TopicPartition &tp) {
+    auto it = m_forgotten.find(tp.topic);
+    if (it == m_forgotten.end()) {
+      it = m_forgotten.insert(tp.topic, m_request->forgottenTopics.size());
+      m_request->forgottenTopics.push_back(FetchForgottenTopic{tp.topic.toStdString(), {}});
+    }
+    m_request->forgottenTopics[it.value()].partitions.push_back(tp.partition);
+  }
+
+private:
+  FetchRequest *m_request;
+  QHash<QString, std::size_t> m_topics;
+  QHash<QString, std::size_t> m_forgotten;
+};
+} // namespace
+
+quint64 FetchSession::buildRequest(const QVector<FetchTarget> &targets, qint16 version,
+                                   FetchRequest *request) {
+  ++m_serial;
+  m_pending.clear();
+  m_pending.reserve(targets.size());
+  for (const FetchTarget &target : targets)
+    m_pending.insert(target.tp, PartitionState{target.offset, target.maxBytes});
+
+  TopicGrouper grouper(request);
+  m_pendingSession = version >= kFirstSessionVersion;
+  m_pendingIncremental = m_pendingSession && m_sessionId != 0;
+  if (!m_pendingSession) {
+    request->sessionId = 0;
+    request->sessionEpoch = kFinalFetchSessionEpoch;
+  } else if (!m_pendingIncremental) {
+    request->sessionId = 0;
+    request->sessionEpoch = kInitialFetchSessionEpoch;
+  } else {
+    request->sessionId = m_sessionId;
+    request->sessionEpoch = m_epoch;
+  }
+
+  if (!m_pendingIncremental) {
+    for (const FetchTarget &target : targets)
+      grouper.add(target);
+    return m_serial;
+  }
+
+  for (const FetchTarget &target : targets) {
+    const auto cached = m_partitions.constFind(target.tp);
+    if (cached == m_partitions.cend() || cached->offset != target.offset ||
+        cached->maxBytes != target.maxBytes)
+      grouper.add(target);
+  }
+  for (auto it = m_partitions.cbegin(); it != m_partitions.cend(); ++it) {
+    if (!m_pending.contains(it.key()))
+      grouper.forget(it.key());
+  }
+  return m_serial;
+}
+
+void FetchSession::commit(quint64 serial, qint32 sessionId) {
+  if (serial != m_serial) {
+    reset();
+    return;
+  }
+  if (!m_pendingSession)
+    return;
+
+  if (!m_pendingIncremental) {
+    // A broker whose session cache is full answers without a session; the
+    // next request asks again.
+    m_sessionId = sessionId;
+    m_epoch = sessionId != 0 ? 1 : 0;
+  } else if (sessionId != m_sessionId) {
+    reset();
+    return;
+  } else {
+    m_epoch = m_epoch == std::numeric_limits<qint32>::max() ? 1 : m_epoch + 1;
+  }
+  m_partitions = sessionId != 0 ? std::move(m_pending) : QHash<TopicPartition, PartitionState>();
+  m_pending.clear();
+}
+
+void FetchSession::reset() {
+  m_sessionId = 0;
+  m_epoch = 0;
+  m_partitions.clear();
+  m_pending.clear();
+  ++m_serial;
+}
+
+bool FetchSession::buildCloseRequest(FetchRequest *request) {
+  const qint32 sessionId = m_sessionId;
+  reset();
+  if (sessionId == 0)
+    return false;
+  request->sessionId = sessionId;
+  request->sessionEpoch = kFinalFetchSessionEpoch;
+  request->maxWaitMs = 0;
+  return true;
+}
+
+} // namespace kafka
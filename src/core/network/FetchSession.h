@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QHash>
+#include <QVector>
+
+#include "core/network/ClientTypes.h"
+
+namespace kafka {
+
+struct FetchRequest;
+
+/**
+ * @brief Client half of an incremental fetch session (KIP-227) with one
+ * broker.
+ *
+ * The first request is a full fetch naming every partition, which asks the
+ * broker to open a session. The broker then keeps each partition's fetch
+ * offset and size limit in its session cache, so later requests name only
+ * the partitions whose offset or limit changed and the ones to forget, and
+ * the responses leave out partitions with nothing new. Each answered
+ * request advances the session epoch; a rejected, failed or unanswered one
+ * resets the session so the next request is a full fetch again.
+ *
+ * Brokers older than Kafka 1.1 (Fetch < v7) get full fetches without a
+ * session.
+ *
+ * Not thread-safe; KafkaClient uses it on its own thread.
+ */
+class FetchSession {
+public:
+  /**
+   * @brief Fills the partitions and session fields of @p request for
+   * @p targets, to be sent with Fetch @p version. Returns a serial number
+   * for commit().
+   */
+  quint64 buildRequest(const QVector<FetchTarget> &targets, qint16 version,
+                       FetchRequest *request);
+  /**
+   * @brief Takes the broker's answer to the request @p serial: opens the
+   * session @p sessionId or moves the open one to its next epoch. An answer
+   * to an older request than the last one built resets the session.
+   */
+  void commit(quint64 serial, qint32 sessionId);
+  /** Forgets the session; the next request is a full fetch. */
+  void reset();
+  /**
+   * @brief Fills @p request to close the session on the broker; false when
+   * there is none to close. The session is forgotten either way.
+   */
+  bool buildCloseRequest(FetchRequest *request);
+
+  qint32 sessionId() const { return m_sessionId; }
+  /** Whether the last request built named only what changed. */
+  bool lastRequestIncremental() const { return m_pendingIncremental; }
+
+private:
+  struct PartitionState {
+    qint64 offset = 0;
+    qint32 maxBytes = 0;
+  };
+
+  qint32 m_sessionId = 0;
+  qint32 m_epoch = 0;
+  // What the broker's session cache holds, and what it will hold once the
+  // request in flight is answered.
+  QHash<TopicPartition, PartitionState> m_partitions;
+  QHash<TopicPartition, PartitionState> m_pending;
+  quint64 m_serial = 0;
+  bool m_pendingSession = false;
+  bool m_pendingIncremental = false;
+};
+
+/**
+ * @brief The fetch sessions of one reader, one per broker it fetches from.
+ *
+ * Create one per reader that fetches the same partitions over and over
+ * (following a topic's end, for instance) and pass it to
+ * KafkaClient::fetchSessionBlocking(). Only the client thread touches the
+ * sessions; readers just keep the pointer.
+ */
+struct FetchSessions {
+  QHash<qint32, FetchSession> brokers;
+  /**
+   * Bumped when a caller gives up waiting; answers to requests sent
+   * before then are dropped instead of moving a session on.
+   */
+  quint64 generation = 0;
+};
+
+} // namespace kafka
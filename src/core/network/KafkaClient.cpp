@@ -0,0 +1,1158 @@
+#include "core/network/KafkaClient.h"
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <utility>
+
+#include "core/network/BrokerConnection.h"
+#include "core/network/FetchSession.h"
+#include "core/network/MetadataCache.h"
+#include "core/protocol/Messages.h"
+#include "core/trace/Trace.h"
+
+namespace kafka {
+
+namespace {
+constexpr quint16 kDefaultPort = 9092;
+
+bool parseHostPort(const QString &server, QString *host, quint16 *port) {
+  const QString trimmed = server.trimmed();
+  const int colon = trimmed.lastIndexOf(QLatin1Char(':'));
+  if (colon <= 0) {
+    *host = trimmed;
+    *port = kDefaultPort;
+    return !trimmed.isEmpty();
+  }
+  bool ok = false;
+  const uint value = trimmed.midRef(colon + 1).toUInt(&ok);
+  if (!ok || value == 0 || value > 65535)
+    return false;
+  *host = trimmed.left(colon);
+  *port = static_cast<quint16>(value);
+  return true;
+}
+
+bool isStaleMetadataError(qint16 errorCode) {
+  switch (static_cast<ErrorCode>(errorCode)) {
+  case ErrorCode::UnknownTopicOrPartition:
+  case ErrorCode::LeaderNotAvailable:
+  case ErrorCode::NotLeaderForPartition:
+  case ErrorCode::NetworkException:
+    return true;
+  default:
+    return false;
+  }
+}
+
+template <typename Message> BrokerConnection::BodyEncoder encoderFor(Message message) {
+  return [message = std::move(message)](qint16 version) {
+    WireWriter writer;
+    message.encode(writer, version);
+    return writer.take();
+  };
+}
+
+ClusterMetadata toClusterMetadata(const MetadataResponse &response) {
+  ClusterMetadata metadata;
+  metadata.controllerId = response.controllerId;
+  metadata.brokers.reserve(static_cast<int>(response.brokers.size()));
+  for (const MetadataBroker &broker : response.brokers) {
+    BrokerInfo info;
+    info.nodeId = broker.nodeId;
+    info.host = QString::fromStdString(broker.host);
+    info.port = static_cast<quint16>(broker.port);
+    info.rack = QString::fromStdString(broker.rack);
+    metadata.brokers.append(info);
+  }
+  metadata.topics.reserve(static_cast<int>(response.topics.size()));
+  for (const MetadataTopic &topic : response.topics) {
+    TopicInfo info;
+    info.name = QString::fromStdString(topic.name);
+    // Null when all zero or, below v10, missing.
+    info.topicId = QUuid::fromRfc4122(
+        QByteArray(topic.topicId.data(), static_cast<int>(topic.topicId.size())));
+    info.isInternal = topic.isInternal;
+    info.errorCode = topic.errorCode;
+    info.partitions.reserve(static_cast<int>(topic.partitions.size()));
+    for (const MetadataPartition &partition : topic.partitions) {
+      PartitionInfo partitionInfo;
+      partitionInfo.partition = partition.partition;
+      partitionInfo.leader = partition.leader;
+      partitionInfo.errorCode = partition.errorCode;
+      partitionInfo.replicas = QVector<qint32>(partition.replicas.begin(), partition.replicas.end());
+      partitionInfo.isr = QVector<qint32>(partition.isr.begin(), partition.isr.end());
+      info.partitions.append(partitionInfo);
+    }
+    metadata.topics.append(info);
+  }
+  return metadata;
+}
+
+void applyOffsetFetch(const OffsetFetchGroupResponse &response, GroupOffsets *group) {
+  group->errorCode = response.errorCode;
+  for (const OffsetFetchTopicResponse &topic : response.topics) {
+    const QString topicName = QString::fromStdString(topic.name);
+    for (const OffsetFetchPartitionResponse &partition : topic.partitions) {
+      group->offsets.append(CommittedOffset{TopicPartition{topicName, partition.partition},
+                                            partition.committedOffset, partition.errorCode});
+    }
+  }
+}
+} // namespace
+
+KafkaClient::KafkaClient(QObject *parent) : QObject(parent) {
+  registerClientMetaTypes();
+}
+
+KafkaClient::~KafkaClient() = default;
+
+void KafkaClient::setBootstrapServers(const QStringList &servers) {
+  QMetaObject::invokeMethod(
+      this,
+      [this, servers]() {
+        m_bootstrapServers = servers;
+        m_bootstrapIndex = 0;
+        if (m_bootstrap) {
+          m_bootstrap->deleteLater();
+          m_bootstrap = nullptr;
+        }
+        for (BrokerConnection *connection : std::as_const(m_connections))
+          connection->deleteLater();
+        m_connections.clear();
+
+        {
+          QMutexLocker locker(&m_metadataMutex);
+          m_metadata = ClusterMetadata();
+          m_hasMetadata = false;
+        }
+        publishCachedMetadata();
+      },
+      Qt::QueuedConnection);
+}
+
+void KafkaClient::setMetadataCacheRoot(const QString &root) {
+  QMetaObject::invokeMethod(
+      this, [this, root]() { m_metadataCacheRoot = root; }, Qt::QueuedConnection);
+}
+
+void KafkaClient::setBatchCache(std::shared_ptr<BatchCache> cache) {
+  QMutexLocker locker(&m_batchCacheMutex);
+  m_batchCache = std::move(cache);
+}
+
+std::shared_ptr<BatchCache> KafkaClient::batchCache() const {
+  QMutexLocker locker(&m_batchCacheMutex);
+  return m_batchCache;
+}
+
+void KafkaClient::setClientId(const QString &clientId) {
+  QMetaObject::invokeMethod(
+      this, [this, clientId]() { m_clientId = clientId; }, Qt::QueuedConnection);
+}
+
+void KafkaClient::setMaxInFlightPerBroker(int maxInFlight) {
+  m_maxInFlight.store(qMax(1, maxInFlight));
+}
+
+quint64 KafkaClient::refreshMetadata() {
+  const quint64 requestId = nextRequestId();
+  QMetaObject::invokeMethod(
+      this,
+      [this, requestId]() {
+        doRefreshMetadata([this, requestId](const QString &error) {
+          if (!error.isEmpty())
+            emit requestFailed(requestId, error);
+        });
+      },
+      Qt::QueuedConnection);
+  return requestId;
+}
+
+quint64 KafkaClient::listOffsets(const QVector<TopicPartition> &partitions, qint64 timestamp) {
+  const quint64 requestId = nextRequestId();
+  QMetaObject::invokeMethod(
+      this,
+      [this, requestId, partitions, timestamp]() {
+        withMetadata(
+            [this, requestId, partitions, timestamp]() {
+              doListOffsets(partitions, timestamp,
+                            [this, requestId](const QVector<PartitionOffset> &offsets, int) {
+                              emit offsetsListed(requestId, offsets);
+                            });
+            },
+            failRequest(requestId));
+      },
+      Qt::QueuedConnection);
+  return requestId;
+}
+
+quint64 KafkaClient::fetch(const QVector<FetchTarget> &targets) {
+  const quint64 requestId = nextRequestId();
+  QMetaObject::invokeMethod(
+      this,
+      [this, requestId, targets]() {
+        withMetadata(
+            [this, requestId, targets]() {
+              doFetch(targets, [this, requestId](const QVector<FetchedPartition> &partitions) {
+                emit fetchCompleted(requestId, partitions);
+              });
+            },
+            failRequest(requestId));
+      },
+      Qt::QueuedConnection);
+  return requestId;
+}
+
+quint64 KafkaClient::fetchGroupOffsets() {
+  const quint64 requestId = nextRequestId();
+  QMetaObject::invokeMethod(
+      this,
+      [this, requestId]() {
+        withMetadata(
+            [this, requestId]() {
+              doFetchGroupOffsets([this, requestId](const GroupOffsetsSnapshot &snapshot) {
+                emit groupOffsetsFetched(requestId, snapshot);
+              });
+            },
+            failRequest(requestId));
+      },
+      Qt::QueuedConnection);
+  return requestId;
+}
+
+void KafkaClient::produce(const QVector<ProduceBatch> &batches, qint32 timeoutMs,
+                          const ProduceCallback &done) {
+  QMetaObject::invokeMethod(
+      this,
+      [this, batches, timeoutMs, done]() {
+        withMetadata([this, batches, timeoutMs, done]() { doProduce(batches, timeoutMs, done); },
+                     [batches, done](const QString &) {
+                       QVector<ProducedBatch> results;
+                       results.reserve(batches.size());
+                       for (const ProduceBatch &batch : batches)
+                         results.append(ProducedBatch{
+                             batch.tp, static_cast<qint16>(ErrorCode::NetworkException), -1});
+                       done(results);
+                     });
+      },
+      Qt::QueuedConnection);
+}
+
+KafkaClient::ErrorCallback KafkaClient::failRequest(quint64 requestId) {
+  return [this, requestId](const QString &error) { emit requestFailed(requestId, error); };
+}
+
+namespace {
+// Carries the outcome of a request from the client thread back to a
+// blocked worker thread.
+template <typename T> struct BlockingResult {
+  T value;
+  QString error;
+};
+
+template <typename T>
+bool waitFor(std::future<BlockingResult<T>> &future, T *value, QString *error, int timeoutMs) {
+  if (future.wait_for(std::chrono::milliseconds(timeoutMs)) != std::future_status::ready) {
+    if (error)
+      *error = KafkaClient::tr("Request timed out after %1 ms").arg(timeoutMs);
+    return false;
+  }
+  BlockingResult<T> result;
+  try {
+    result = future.get();
+  } catch (const std::future_error &) {
+    // The client was destroyed with the request still queued.
+    result.error = KafkaClient::tr("Client shut down");
+  }
+  if (!result.error.isEmpty()) {
+    if (error)
+      *error = result.error;
+    return false;
+  }
+  if (value)
+    *value = std::move(result.value);
+  return true;
+}
+} // namespace
+
+bool KafkaClient::listOffsetsBlocking(const QVector<TopicPartition> &partitions, qint64 timestamp,
+                                      QVector<PartitionOffset> *offsets, QString *error,
+                                      int timeoutMs) {
+  return listOffsetsBlocking(partitions, timestamp, offsets, nullptr, error, timeoutMs);
+}
+
+bool KafkaClient::listOffsetsBlocking(const QVector<TopicPartition> &partitions, qint64 timestamp,
+                                      QVector<PartitionOffset> *offsets, int *requestCount,
+                                      QString *error, int timeoutMs) {
+  Q_ASSERT(QThread::currentThread() != thread());
+  struct Listed {
+    QVector<PartitionOffset> offsets;
+    int requestCount = 0;
+  };
+  using Result = BlockingResult<Listed>;
+  auto promise = std::make_shared<std::promise<Result>>();
+  auto future = promise->get_future();
+  QMetaObject::invokeMethod(
+      this,
+      [this, partitions, timestamp, promise]() {
+        withMetadata(
+            [this, partitions, timestamp, promise]() {
+              doListOffsets(partitions, timestamp,
+                            [promise](const QVector<PartitionOffset> &r, int requests) {
+                              promise->set_value(Result{Listed{r, requests}, QString()});
+                            });
+            },
+            [promise](const QString &e) { promise->set_value(Result{{}, e}); });
+      },
+      Qt::QueuedConnection);
+  Listed listed;
+  if (!waitFor(future, &listed, error, timeoutMs))
+    return false;
+  if (offsets)
+    *offsets = std::move(listed.offsets);
+  if (requestCount)
+    *requestCount = listed.requestCount;
+  return true;
+}
+
+bool KafkaClient::fetchBlocking(const QVector<FetchTarget> &targets,
+                                QVector<FetchedPartition> *partitions, QString *error,
+                                int timeoutMs) {
+  Q_ASSERT(QThread::currentThread() != thread());
+  using Result = BlockingResult<QVector<FetchedPartition>>;
+  auto promise = std::make_shared<std::promise<Result>>();
+  auto future = promise->get_future();
+  QMetaObject::invokeMethod(
+      this,
+      [this, targets, promise]() {
+        withMetadata(
+            [this, targets, promise]() {
+              doFetch(targets, [promise](const QVector<FetchedPartition> &r) {
+                promise->set_value(Result{r, QString()});
+              });
+            },
+            [promise](const QString &e) { promise->set_value(Result{{}, e}); });
+      },
+      Qt::QueuedConnection);
+  return waitFor(future, partitions, error, timeoutMs);
+}
+
+bool KafkaClient::fetchSessionBlocking(const std::shared_ptr<FetchSessions> &sessions,
+                                       const QVector<FetchTarget> &targets,
+                                       QVector<FetchedPartition> *partitions, QString *error,
+                                       int timeoutMs) {
+  Q_ASSERT(QThread::currentThread() != thread());
+  using Result = BlockingResult<QVector<FetchedPartition>>;
+  auto promise = std::make_shared<std::promise<Result>>();
+  auto future = promise->get_future();
+  QMetaObject::invokeMethod(
+      this,
+      [this, sessions, targets, promise]() {
+        withMetadata(
+            [this, sessions, targets, promise]() {
+              doSessionFetch(sessions, targets, [promise](const QVector<FetchedPartition> &r) {
+                promise->set_value(Result{r, QString()});
+              });
+            },
+            [promise](const QString &e) { promise->set_value(Result{{}, e}); });
+      },
+      Qt::QueuedConnection);
+  if (waitFor(future, partitions, error, timeoutMs))
+    return true;
+  if (future.valid() &&
+      future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    // Timed out with requests still out. Their answers would move the
+    // sessions on behind the next call's back, so drop them and start
+    // over: the next call sends every target.
+    QMetaObject::invokeMethod(
+        this,
+        [this, sessions]() {
+          ++sessions->generation;
+          for (auto it = sessions->brokers.begin(); it != sessions->brokers.end(); ++it)
+            closeFetchSession(it.key(), &it.value());
+        },
+        Qt::QueuedConnection);
+  }
+  return false;
+}
+
+void KafkaClient::closeFetchSessions(const std::shared_ptr<FetchSessions> &sessions) {
+  QMetaObject::invokeMethod(
+      this,
+      [this, sessions]() {
+        for (auto it = sessions->brokers.begin(); it != sessions->brokers.end(); ++it)
+          closeFetchSession(it.key(), &it.value());
+      },
+      Qt::QueuedConnection);
+}
+
+bool KafkaClient::metadataBlocking(ClusterMetadata *metadata, QString *error, int timeoutMs) {
+  Q_ASSERT(QThread::currentThread() != thread());
+  using Result = BlockingResult<ClusterMetadata>;
+  auto promise = std::make_shared<std::promise<Result>>();
+  auto future = promise->get_future();
+  QMetaObject::invokeMethod(
+      this,
+      [this, promise]() {
+        withMetadata([this, promise]() { promise->set_value(Result{this->metadata(), QString()}); },
+                     [promise](const QString &e) { promise->set_value(Result{{}, e}); });
+      },
+      Qt::QueuedConnection);
+  return waitFor(future, metadata, error, timeoutMs);
+}
+
+bool KafkaClient::groupOffsetsBlocking(GroupOffsetsSnapshot *snapshot, QString *error,
+                                       int timeoutMs) {
+  Q_ASSERT(QThread::currentThread() != thread());
+  using Result = BlockingResult<GroupOffsetsSnapshot>;
+  auto promise = std::make_shared<std::promise<Result>>();
+  auto future = promise->get_future();
+  QMetaObject::invokeMethod(
+      this,
+      [this, promise]() {
+        withMetadata(
+            [this, promise]() {
+              doFetchGroupOffsets([promise](const GroupOffsetsSnapshot &r) {
+                promise->set_value(Result{r, QString()});
+              });
+            },
+            [promise](const QString &e) { promise->set_value(Result{{}, e}); });
+      },
+      Qt::QueuedConnection);
+  return waitFor(future, snapshot, error, timeoutMs);
+}
+
+bool KafkaClient::initProducerIdBlocking(ProducerId *producerId, QString *error, int timeoutMs) {
+  Q_ASSERT(QThread::currentThread() != thread());
+  using Result = BlockingResult<ProducerId>;
+  auto promise = std::make_shared<std::promise<Result>>();
+  auto future = promise->get_future();
+  QMetaObject::invokeMethod(
+      this,
+      [this, promise]() {
+        withMetadata(
+            [this, promise]() {
+              doInitProducerId([promise](const ProducerId &r, const QString &e) {
+                promise->set_value(Result{r, e});
+              });
+            },
+            [promise](const QString &e) { promise->set_value(Result{{}, e}); });
+      },
+      Qt::QueuedConnection);
+  return waitFor(future, producerId, error, timeoutMs);
+}
+
+ClusterMetadata KafkaClient::metadata() const {
+  QMutexLocker locker(&m_metadataMutex);
+  return m_metadata;
+}
+
+void KafkaClient::withMetadata(const std::function<void()> &action,
+                               const ErrorCallback &onError) {
+  if (m_hasMetadata && !m_metadataStale) {
+    action();
+    return;
+  }
+  doRefreshMetadata([this, action, onError](const QString &error) {
+    // Stale metadata still routes most requests correctly, so only give up
+    // when there is nothing to route with at all.
+    if (!error.isEmpty() && !m_hasMetadata) {
+      onError(error);
+      return;
+    }
+    action();
+  });
+}
+
+void KafkaClient::doRefreshMetadata(const MetadataCallback &callback) {
+  m_metadataWaiters.push_back(callback);
+  if (m_metadataInFlight)
+    return;
+
+  auto notifyWaiters = [this](const QString &error) {
+    m_metadataInFlight = false;
+    std::vector<MetadataCallback> waiters = std::exchange(m_metadataWaiters, {});
+    for (const MetadataCallback &waiter : waiters)
+      waiter(error);
+  };
+
+  BrokerConnection *connection = anyConnection();
+  if (!connection) {
+    notifyWaiters(tr("No usable bootstrap server configured"));
+    return;
+  }
+
+  m_metadataInFlight = true;
+  MetadataRequest request;
+  request.allTopics = true;
+  connection->send(ApiKey::Metadata, encoderFor(request),
+                   [this, notifyWaiters](const BrokerResponse &response) {
+                     if (!response.ok) {
+                       notifyWaiters(response.error);
+                       return;
+                     }
+                     MetadataResponse decoded;
+                     WireReader reader(response.body);
+                     if (!decoded.decode(reader, response.apiVersion)) {
+                       notifyWaiters(tr("Malformed Metadata response"));
+                       return;
+                     }
+                     applyMetadata(decoded);
+                     notifyWaiters(QString());
+                   });
+}
+
+void KafkaClient::applyMetadata(const MetadataResponse &response) {
+  const ClusterMetadata metadata = toClusterMetadata(response);
+
+  // Brokers that moved or left get a fresh connection on next use.
+  for (auto it = m_connections.begin(); it != m_connections.end();) {
+    const BrokerInfo *info = metadata.broker(it.key());
+    BrokerConnection *connection = it.value();
+    if (!info || info->host != connection->host() || info->port != connection->port()) {
+      connection->close();
+      connection->deleteLater();
+      it = m_connections.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  m_leaders.clear();
+  for (const TopicInfo &topic : metadata.topics) {
+    for (const PartitionInfo &partition : topic.partitions)
+      m_leaders.insert(TopicPartition{topic.name, partition.partition}, partition.leader);
+  }
+
+  {
+    QMutexLocker locker(&m_metadataMutex);
+    m_metadata = metadata;
+    m_hasMetadata = true;
+    m_metadataStale = false;
+  }
+  emit metadataUpdated(metadata);
+  publishMetadata(metadata);
+}
+
+// Reading the cache only feeds receivers; requests keep waiting for a
+// live Metadata response, since cached leaders may have moved.
+void KafkaClient::publishCachedMetadata() {
+  m_published = ClusterMetadata();
+  m_publishedFromCache = false;
+  if (m_metadataCacheRoot.isEmpty() || m_bootstrapServers.isEmpty())
+    return;
+  ClusterMetadata cached;
+  if (!MetadataCache::load(MetadataCache::pathFor(m_metadataCacheRoot, m_bootstrapServers),
+                           &cached, nullptr))
+    return;
+  MetadataDiff diff = diffMetadata(m_published, cached);
+  diff.fromCache = true;
+  m_published = std::move(cached);
+  m_publishedFromCache = true;
+  emit metadataChanged(diff);
+}
+
+void KafkaClient::publishMetadata(const ClusterMetadata &metadata) {
+  const MetadataDiff diff = diffMetadata(m_published, metadata);
+  // The first live answer is announced even when the cache was exact, so
+  // receivers know the tree is no longer from disk.
+  if (diff.isEmpty() && !m_publishedFromCache)
+    return;
+  m_published = metadata;
+  m_publishedFromCache = false;
+  emit metadataChanged(diff);
+
+  // A cache that cannot be written only costs the next cold start.
+  if (!diff.isEmpty() && !m_metadataCacheRoot.isEmpty())
+    MetadataCache::save(MetadataCache::pathFor(m_metadataCacheRoot, m_bootstrapServers),
+                        metadata, nullptr);
+}
+
+void KafkaClient::invalidateMetadataOnError(qint16 errorCode) {
+  if (isStaleMetadataError(errorCode))
+    m_metadataStale = true;
+}
+
+BrokerConnection *KafkaClient::connectionFor(qint32 nodeId) {
+  if (BrokerConnection *existing = m_connections.value(nodeId))
+    return existing;
+
+  const BrokerInfo *info = m_metadata.broker(nodeId);
+  if (!info)
+    return nullptr;
+
+  auto *connection = new BrokerConnection(nodeId, info->host, info->port, this);
+  connection->setClientId(m_clientId);
+  connection->setMaxInFlight(m_maxInFlight.load());
+  connect(connection, &BrokerConnection::failed, this, [this]() { m_metadataStale = true; });
+  m_connections.insert(nodeId, connection);
+  return connection;
+}
+
+BrokerConnection *KafkaClient::anyConnection() {
+  for (BrokerConnection *connection : std::as_const(m_connections)) {
+    if (connection->isReady())
+      return connection;
+  }
+  if (m_bootstrap)
+    return m_bootstrap;
+  if (m_bootstrapServers.isEmpty())
+    return nullptr;
+
+  for (int attempt = 0; attempt < m_bootstrapServers.size(); ++attempt) {
+    const QString server = m_bootstrapServers.at(m_bootstrapIndex % m_bootstrapServers.size());
+    m_bootstrapIndex = (m_bootstrapIndex + 1) % m_bootstrapServers.size();
+
+    QString host;
+    quint16 port = 0;
+    if (!parseHostPort(server, &host, &port))
+      continue;
+
+    m_bootstrap = new BrokerConnection(-1, host, port, this);
+    m_bootstrap->setClientId(m_clientId);
+    connect(m_bootstrap, &BrokerConnection::failed, this, [this]() {
+      // Try the next bootstrap server on the next metadata attempt.
+      if (m_bootstrap) {
+        m_bootstrap->deleteLater();
+        m_bootstrap = nullptr;
+      }
+    });
+    return m_bootstrap;
+  }
+  return nullptr;
+}
+
+void KafkaClient::doListOffsets(const QVector<TopicPartition> &partitions, qint64 timestamp,
+                                const OffsetsCallback &done) {
+  struct Pending {
+    int remaining = 0;
+    QVector<PartitionOffset> results;
+  };
+  auto pending = std::make_shared<Pending>();
+
+  QHash<qint32, QVector<TopicPartition>> byLeader;
+  for (const TopicPartition &tp : partitions) {
+    const qint32 leader = m_leaders.value(tp, -1);
+    if (leader < 0 || !connectionFor(leader)) {
+      PartitionOffset result;
+      result.tp = tp;
+      result.errorCode = static_cast<qint16>(ErrorCode::LeaderNotAvailable);
+      pending->results.append(result);
+      m_metadataStale = true;
+      continue;
+    }
+    byLeader[leader].append(tp);
+  }
+
+  // One request per leader with a connection; the rest failed above.
+  const int requests = byLeader.size();
+  pending->remaining = requests;
+  if (pending->remaining == 0) {
+    done(pending->results, 0);
+    return;
+  }
+
+  for (auto it = byLeader.cbegin(); it != byLeader.cend(); ++it) {
+    const QVector<TopicPartition> brokerPartitions = it.value();
+
+    ListOffsetsRequest request;
+    QHash<QString, std::size_t> topicIndex;
+    for (const TopicPartition &tp : brokerPartitions) {
+      auto indexIt = topicIndex.find(tp.topic);
+      if (indexIt == topicIndex.end()) {
+        indexIt = topicIndex.insert(tp.topic, request.topics.size());
+        request.topics.push_back(ListOffsetsTopic{tp.topic.toStdString(), {}});
+      }
+      request.topics[indexIt.value()].partitions.push_back(ListOffsetsPartition{tp.partition, timestamp});
+    }
+
+    connectionFor(it.key())->send(
+        ApiKey::ListOffsets, encoderFor(request),
+        [this, done, pending, requests, brokerPartitions](const BrokerResponse &response) {
+          ListOffsetsResponse decoded;
+          WireReader reader(response.body);
+          if (!response.ok || !decoded.decode(reader, response.apiVersion)) {
+            for (const TopicPartition &tp : brokerPartitions) {
+              PartitionOffset result;
+              result.tp = tp;
+              result.errorCode = static_cast<qint16>(ErrorCode::NetworkException);
+              pending->results.append(result);
+            }
+            m_metadataStale = true;
+          } else {
+            for (const ListOffsetsTopicResponse &topic : decoded.topics) {
+              const QString topicName = QString::fromStdString(topic.name);
+              for (const ListOffsetsPartitionResponse &partition : topic.partitions) {
+                PartitionOffset result;
+                result.tp = TopicPartition{topicName, partition.partition};
+                result.errorCode = partition.errorCode;
+                result.timestamp = partition.timestamp;
+                result.offset = partition.offset;
+                invalidateMetadataOnError(partition.errorCode);
+                pending->results.append(result);
+              }
+            }
+          }
+          if (--pending->remaining == 0)
+            done(pending->results, requests);
+        });
+  }
+}
+
+void KafkaClient::doFetch(const QVector<FetchTarget> &targets, const FetchCallback &done) {
+  struct Pending {
+    int remaining = 0;
+    QVector<FetchedPartition> results;
+  };
+  auto pending = std::make_shared<Pending>();
+
+  QHash<qint32, QVector<FetchTarget>> byLeader;
+  for (const FetchTarget &target : targets) {
+    const qint32 leader = m_leaders.value(target.tp, -1);
+    if (leader < 0 || !connectionFor(leader)) {
+      FetchedPartition result;
+      result.tp = target.tp;
+      result.fetchOffset = target.offset;
+      result.errorCode = static_cast<qint16>(ErrorCode::LeaderNotAvailable);
+      pending->results.append(result);
+      m_metadataStale = true;
+      continue;
+    }
+    byLeader[leader].append(target);
+  }
+
+  // Split each broker's partitions round-robin over up to maxInFlight
+  // requests so the broker can work on several of them at once.
+  QVector<QPair<qint32, QVector<FetchTarget>>> chunks;
+  const int maxInFlight = m_maxInFlight.load();
+  for (auto it = byLeader.cbegin(); it != byLeader.cend(); ++it) {
+    const QVector<FetchTarget> &brokerTargets = it.value();
+    const int chunkCount = qMin(maxInFlight, brokerTargets.size());
+    const int firstChunk = chunks.size();
+    for (int i = 0; i < chunkCount; ++i)
+      chunks.append(qMakePair(it.key(), QVector<FetchTarget>()));
+    for (int i = 0; i < brokerTargets.size(); ++i)
+      chunks[firstChunk + i % chunkCount].second.append(brokerTargets.at(i));
+  }
+
+  pending->remaining = chunks.size();
+  if (pending->remaining == 0) {
+    done(pending->results);
+    return;
+  }
+
+  const qint32 maxWaitMs = m_fetchMaxWaitMs.load();
+  for (const auto &chunk : std::as_const(chunks)) {
+    const QVector<FetchTarget> chunkTargets = chunk.second;
+
+    FetchRequest request;
+    request.maxWaitMs = maxWaitMs;
+    QHash<QString, std::size_t> topicIndex;
+    for (const FetchTarget &target : chunkTargets) {
+      auto indexIt = topicIndex.find(target.tp.topic);
+      if (indexIt == topicIndex.end()) {
+        indexIt = topicIndex.insert(target.tp.topic, request.topics.size());
+        request.topics.push_back(FetchTopic{target.tp.topic.toStdString(), {}});
+      }
+      request.topics[indexIt.value()].partitions.push_back(
+          FetchPartition{target.tp.partition, target.offset, -1, target.maxBytes});
+    }
+
+    connectionFor(chunk.first)->send(
+        ApiKey::Fetch, encoderFor(request),
+        [this, done, pending, chunkTargets](const BrokerResponse &response) {
+          KAFKA_TRACE_SCOPE("fetch response");
+          KAFKA_TRACE_COUNTER("fetch response bytes", response.frame.size());
+          QHash<TopicPartition, qint64> fetchOffsets;
+          for (const FetchTarget &target : chunkTargets)
+            fetchOffsets.insert(target.tp, target.offset);
+
+          FetchResponse decoded;
+          WireReader reader(response.body);
+          if (!response.ok || !decoded.decode(reader, response.apiVersion)) {
+            for (const FetchTarget &target : chunkTargets) {
+              FetchedPartition result;
+              result.tp = target.tp;
+              result.fetchOffset = target.offset;
+              result.errorCode = static_cast<qint16>(ErrorCode::NetworkException);
+              pending->results.append(result);
+            }
+            m_metadataStale = true;
+          } else {
+            appendFetched(decoded, response.frame, fetchOffsets, &pending->results);
+          }
+          if (--pending->remaining == 0)
+            done(pending->results);
+        });
+  }
+}
+
+void KafkaClient::appendFetched(const FetchResponse &response, const QByteArray &frame,
+                                const QHash<TopicPartition, qint64> &fetchOffsets,
+                                QVector<FetchedPartition> *results) {
+  for (const FetchTopicResponse &topic : response.topics) {
+    const QString topicName = QString::fromStdString(topic.name);
+    for (const FetchPartitionResponse &partition : topic.partitions) {
+      FetchedPartition result;
+      result.tp = TopicPartition{topicName, partition.partition};
+      result.fetchOffset = fetchOffsets.value(result.tp, -1);
+      result.errorCode = partition.errorCode;
+      result.highWatermark = partition.highWatermark;
+      result.lastStableOffset = partition.lastStableOffset;
+      result.frame = frame;
+      if (partition.records.data()) {
+        result.recordsBegin = static_cast<int>(partition.records.data() - frame.constData());
+        result.recordsSize = static_cast<int>(partition.records.size());
+      }
+      invalidateMetadataOnError(partition.errorCode);
+      results->append(result);
+    }
+  }
+}
+
+void KafkaClient::doSessionFetch(const std::shared_ptr<FetchSessions> &sessions,
+                                 const QVector<FetchTarget> &targets, const FetchCallback &done) {
+  struct Pending {
+    int remaining = 0;
+    QVector<FetchedPartition> results;
+  };
+  auto pending = std::make_shared<Pending>();
+
+  QHash<qint32, QVector<FetchTarget>> byLeader;
+  for (const FetchTarget &target : targets) {
+    const qint32 leader = m_leaders.value(target.tp, -1);
+    if (leader < 0 || !connectionFor(leader)) {
+      FetchedPartition result;
+      result.tp = target.tp;
+      result.fetchOffset = target.offset;
+      result.errorCode = static_cast<qint16>(ErrorCode::LeaderNotAvailable);
+      pending->results.append(result);
+      m_metadataStale = true;
+      continue;
+    }
+    byLeader[leader].append(target);
+  }
+  // Sessions with brokers that no longer lead any of the partitions would
+  // only hold a slot in their caches.
+  for (auto it = sessions->brokers.begin(); it != sessions->brokers.end(); ++it) {
+    if (it->sessionId() != 0 && !byLeader.contains(it.key()))
+      closeFetchSession(it.key(), &it.value());
+  }
+
+  pending->remaining = byLeader.size();
+  if (pending->remaining == 0) {
+    done(pending->results);
+    return;
+  }
+
+  // One request per broker: a session allows one request in flight.
+  for (auto it = byLeader.cbegin(); it != byLeader.cend(); ++it) {
+    sendSessionFetch(sessions, it.key(), it.value(), /*retry=*/true,
+                     [pending, done](const QVector<FetchedPartition> &partitions) {
+                       pending->results += partitions;
+                       if (--pending->remaining == 0)
+                         done(pending->results);
+                     });
+  }
+}
+
+void KafkaClient::closeFetchSession(qint32 nodeId, FetchSession *session) {
+  FetchRequest request;
+  BrokerConnection *connection = connectionFor(nodeId);
+  if (!session->buildCloseRequest(&request) || !connection)
+    return;
+  connection->send(ApiKey::Fetch, encoderFor(request), [](const BrokerResponse &) {});
+}
+
+void KafkaClient::sendSessionFetch(const std::shared_ptr<FetchSessions> &sessions,
+                                   qint32 nodeId, const QVector<FetchTarget> &targets,
+                                   bool retry, const FetchCallback &done) {
+  BrokerConnection *connection = connectionFor(nodeId);
+  auto failedResults = [targets](qint16 errorCode) {
+    QVector<FetchedPartition> results;
+    for (const FetchTarget &target : targets) {
+      FetchedPartition result;
+      result.tp = target.tp;
+      result.fetchOffset = target.offset;
+      result.errorCode = errorCode;
+      results.append(result);
+    }
+    return results;
+  };
+  if (!connection) {
+    sessions->brokers[nodeId].reset();
+    m_metadataStale = true;
+    done(failedResults(static_cast<qint16>(ErrorCode::LeaderNotAvailable)));
+    return;
+  }
+
+  // The session builds the request when it is dispatched, once the broker's
+  // Fetch version is known.
+  auto serial = std::make_shared<quint64>(0);
+  const quint64 generation = sessions->generation;
+  const qint32 maxWaitMs = m_fetchMaxWaitMs.load();
+  auto encoder = [sessions, nodeId, targets, serial, maxWaitMs](qint16 version) {
+    FetchRequest request;
+    request.maxWaitMs = maxWaitMs;
+    *serial = sessions->brokers[nodeId].buildRequest(targets, version, &request);
+    WireWriter writer;
+    request.encode(writer, version);
+    KAFKA_TRACE_COUNTER("fetch request bytes", writer.size());
+    return writer.take();
+  };
+
+  connection->send(
+      ApiKey::Fetch, encoder,
+      [this, sessions, nodeId, targets, retry, done, serial, generation, failedResults](
+          const BrokerResponse &response) {
+        KAFKA_TRACE_SCOPE("fetch response");
+        KAFKA_TRACE_COUNTER("fetch response bytes", response.frame.size());
+        if (sessions->generation != generation) {
+          // Its caller timed out and the sessions started over.
+          done(failedResults(static_cast<qint16>(ErrorCode::RequestTimedOut)));
+          return;
+        }
+        FetchSession &session = sessions->brokers[nodeId];
+        FetchResponse decoded;
+        WireReader reader(response.body);
+        if (!response.ok || !decoded.decode(reader, response.apiVersion)) {
+          session.reset();
+          m_metadataStale = true;
+          done(failedResults(static_cast<qint16>(ErrorCode::NetworkException)));
+          return;
+        }
+
+        const auto error = static_cast<ErrorCode>(decoded.errorCode);
+        if (error == ErrorCode::FetchSessionIdNotFound ||
+            error == ErrorCode::InvalidFetchSessionEpoch) {
+          // The broker evicted the session or lost track of its epoch;
+          // start over with a full fetch.
+          session.reset();
+          if (retry) {
+            sendSessionFetch(sessions, nodeId, targets, /*retry=*/false, done);
+            return;
+          }
+        }
+        if (decoded.errorCode != 0) {
+          session.reset();
+          done(failedResults(decoded.errorCode));
+          return;
+        }
+
+        session.commit(*serial, decoded.sessionId);
+        QHash<TopicPartition, qint64> fetchOffsets;
+        for (const FetchTarget &target : targets)
+          fetchOffsets.insert(target.tp, target.offset);
+        QVector<FetchedPartition> results;
+        appendFetched(decoded, response.frame, fetchOffsets, &results);
+        done(results);
+      });
+}
+
+void KafkaClient::doProduce(const QVector<ProduceBatch> &batches, qint32 timeoutMs,
+                            const ProduceCallback &done) {
+  struct Pending {
+    int remaining = 0;
+    QVector<ProducedBatch> results;
+  };
+  auto pending = std::make_shared<Pending>();
+
+  QHash<qint32, QVector<ProduceBatch>> byLeader;
+  for (const ProduceBatch &batch : batches) {
+    const qint32 leader = m_leaders.value(batch.tp, -1);
+    if (leader < 0 || !connectionFor(leader)) {
+      pending->results.append(
+          ProducedBatch{batch.tp, static_cast<qint16>(ErrorCode::LeaderNotAvailable), -1});
+      m_metadataStale = true;
+      continue;
+    }
+    byLeader[leader].append(batch);
+  }
+
+  pending->remaining = byLeader.size();
+  if (pending->remaining == 0) {
+    done(pending->results);
+    return;
+  }
+
+  for (auto it = byLeader.cbegin(); it != byLeader.cend(); ++it) {
+    const QVector<ProduceBatch> brokerBatches = it.value();
+    // The encoder holds the shared batches, so their bytes are copied once,
+    // straight into the request frame.
+    auto encoder = [brokerBatches, timeoutMs](qint16 version) {
+      ProduceRequest request;
+      request.timeoutMs = timeoutMs;
+      std::size_t size = 64;
+      QHash<QString, std::size_t> topicIndex;
+      for (const ProduceBatch &batch : brokerBatches) {
+        auto indexIt = topicIndex.find(batch.tp.topic);
+        if (indexIt == topicIndex.end()) {
+          indexIt = topicIndex.insert(batch.tp.topic, request.topics.size());
+          request.topics.push_back(ProduceTopic{batch.tp.topic.toStdString(), {}});
+          size += request.topics.back().name.size() + 8;
+        }
+        request.topics[indexIt.value()].partitions.push_back(ProducePartition{
+            batch.tp.partition, std::string_view(batch.records.constData(),
+                                                 static_cast<std::size_t>(batch.records.size()))});
+        size += static_cast<std::size_t>(batch.records.size()) + 8;
+      }
+      WireWriter writer(size);
+      request.encode(writer, version);
+      return writer.take();
+    };
+
+    connectionFor(it.key())->send(
+        ApiKey::Produce, encoder,
+        [this, done, pending, brokerBatches](const BrokerResponse &response) {
+          KAFKA_TRACE_SCOPE("produce response");
+          ProduceResponse decoded;
+          WireReader reader(response.body);
+          const bool ok = response.ok && decoded.decode(reader, response.apiVersion);
+          QHash<TopicPartition, ProducedBatch> answers;
+          if (ok) {
+            for (const ProduceTopicResponse &topic : decoded.topics) {
+              const QString topicName = QString::fromStdString(topic.name);
+              for (const ProducePartitionResponse &partition : topic.partitions) {
+                const TopicPartition tp{topicName, partition.partition};
+                answers.insert(tp, ProducedBatch{tp, partition.errorCode, partition.baseOffset});
+                invalidateMetadataOnError(partition.errorCode);
+              }
+            }
+          } else {
+            m_metadataStale = true;
+          }
+          for (const ProduceBatch &batch : brokerBatches) {
+            pending->results.append(answers.value(
+                batch.tp, ProducedBatch{batch.tp,
+                                        static_cast<qint16>(ErrorCode::NetworkException), -1}));
+          }
+          if (--pending->remaining == 0)
+            done(pending->results);
+        });
+  }
+}
+
+// Any broker can hand out an id to a producer outside transactions.
+void KafkaClient::doInitProducerId(const ProducerIdCallback &done) {
+  BrokerConnection *connection = anyConnection();
+  if (!connection) {
+    done(ProducerId(), tr("No usable bootstrap server configured"));
+    return;
+  }
+  connection->send(ApiKey::InitProducerId, encoderFor(InitProducerIdRequest()),
+                   [done](const BrokerResponse &response) {
+                     InitProducerIdResponse decoded;
+                     WireReader reader(response.body);
+                     if (!response.ok) {
+                       done(ProducerId(), response.error);
+                     } else if (!decoded.decode(reader, response.apiVersion)) {
+                       done(ProducerId(), tr("Malformed InitProducerId response"));
+                     } else if (decoded.errorCode != 0) {
+                       done(ProducerId(), tr("InitProducerId failed (%1)")
+                                              .arg(QLatin1String(errorName(decoded.errorCode))));
+                     } else {
+                       done(ProducerId{decoded.producerId, decoded.producerEpoch}, QString());
+                     }
+                   });
+}
+
+// ListGroups goes to every broker at once, and each broker's OffsetFetch
+// requests go out as soon as its own list arrives, so a slow broker only
+// delays its own groups.
+void KafkaClient::doFetchGroupOffsets(const GroupOffsetsCallback &done) {
+  struct Pending {
+    int remaining = 0;
+    GroupOffsetsSnapshot snapshot;
+  };
+  auto pending = std::make_shared<Pending>();
+  auto finishOne = [pending, done]() {
+    if (--pending->remaining == 0)
+      done(pending->snapshot);
+  };
+
+  for (const BrokerInfo &broker : std::as_const(m_metadata.brokers)) {
+    BrokerConnection *connection = connectionFor(broker.nodeId);
+    if (!connection)
+      continue;
+    const qint32 nodeId = broker.nodeId;
+    ++pending->remaining;
+    ++pending->snapshot.requestCount;
+    connection->send(
+        ApiKey::ListGroups, encoderFor(ListGroupsRequest()),
+        [this, pending, finishOne, nodeId](const BrokerResponse &response) {
+          ListGroupsResponse listed;
+          WireReader reader(response.body);
+          BrokerConnection *coordinator = m_connections.value(nodeId);
+          if (!response.ok || !listed.decode(reader, response.apiVersion) ||
+              listed.errorCode != 0 || !coordinator) {
+            pending->snapshot.brokerErrors.append(
+                response.ok ? tr("Broker %1: ListGroups failed (%2)")
+                                  .arg(nodeId)
+                                  .arg(QLatin1String(errorName(listed.errorCode)))
+                            : response.error);
+            if (!response.ok)
+              m_metadataStale = true;
+            finishOne();
+            return;
+          }
+
+          // The connection answered ListGroups, so its versions are known.
+          const bool batched = coordinator->negotiatedVersion(ApiKey::OffsetFetch) >= 8;
+          const std::size_t perRequest =
+              batched ? static_cast<std::size_t>(kGroupsPerOffsetFetch) : 1;
+          for (std::size_t first = 0; first < listed.groups.size(); first += perRequest) {
+            const std::size_t last = qMin(first + perRequest, listed.groups.size());
+            QVector<GroupOffsets> groups;
+            QHash<QString, int> groupIndex;
+            OffsetFetchRequest request;
+            for (std::size_t i = first; i < last; ++i) {
+              GroupOffsets group;
+              group.groupId = QString::fromStdString(listed.groups[i].groupId);
+              group.protocolType = QString::fromStdString(listed.groups[i].protocolType);
+              group.coordinator = nodeId;
+              groupIndex.insert(group.groupId, groups.size());
+              groups.append(group);
+              request.groups.push_back(OffsetFetchGroup{listed.groups[i].groupId, true, {}});
+            }
+
+            ++pending->remaining;
+            ++pending->snapshot.requestCount;
+            coordinator->send(
+                ApiKey::OffsetFetch, encoderFor(request),
+                [pending, finishOne, groups, groupIndex](const BrokerResponse &fetched) mutable {
+                  OffsetFetchResponse decoded;
+                  WireReader fetchedReader(fetched.body);
+                  const bool ok =
+                      fetched.ok && decoded.decode(fetchedReader, fetched.apiVersion);
+                  std::vector<bool> answered(static_cast<std::size_t>(groups.size()), false);
+                  for (const OffsetFetchGroupResponse &group : decoded.groups) {
+                    // Below v8 the response names no group; it is the first.
+                    const QString groupId = QString::fromStdString(group.groupId);
+                    const int index =
+                        fetched.apiVersion >= 8 ? groupIndex.value(groupId, -1) : 0;
+                    if (!ok || index < 0 || answered[static_cast<std::size_t>(index)])
+                      continue;
+                    applyOffsetFetch(group, &groups[index]);
+                    answered[static_cast<std::size_t>(index)] = true;
+                  }
+                  for (int i = 0; i < groups.size(); ++i) {
+                    if (!answered[static_cast<std::size_t>(i)])
+                      groups[i].errorCode = static_cast<qint16>(ErrorCode::NetworkException);
+                  }
+                  pending->snapshot.groups += groups;
+                  finishOne();
+                });
+          }
+          finishOne();
+        });
+  }
+
+  if (pending->remaining == 0)
+    done(pending->snapshot);
+}
+
+} // namespace kafka
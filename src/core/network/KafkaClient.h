@@ -0,0 +1,242 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "core/network/ClientTypes.h"
+
+namespace kafka {
+
+class BatchCache;
+class BrokerConnection;
+struct BrokerResponse;
+class FetchSession;
+struct FetchSessions;
+struct FetchResponse;
+struct MetadataResponse;
+
+/**
+ * @brief Asynchronous Kafka client speaking the wire protocol directly.
+ *
+ * The client lives on its own thread (see KafkaSession). Its public request
+ * methods are thread-safe: they only allocate a request id and post the work
+ * to the client thread, then return immediately. Results come back through
+ * signals, which reach GUI-thread receivers as queued calls, so the GUI
+ * event loop never waits on the network.
+ *
+ * Requests are routed to partition leaders. A Fetch touching many
+ * partitions on one broker is split into several requests that are
+ * pipelined on the same connection, keeping up to maxInFlightPerBroker()
+ * requests outstanding per broker. Readers that fetch the same partitions
+ * round after round use incremental fetch sessions instead, one request
+ * per broker naming only what changed (see FetchSession).
+ *
+ * Produce requests are routed the same way, one request per leader, and
+ * their results come back through a callback rather than a signal so a
+ * producer can keep several requests outstanding without an event loop.
+ *
+ * Committed offsets of all consumer groups are collected without a request
+ * per group: every broker is asked for the groups it coordinates, and each
+ * coordinator answers one OffsetFetch for many of its groups at once.
+ *
+ * With a metadata cache root set, the topology last seen for the bootstrap
+ * servers is read from disk as soon as they are set and published through
+ * metadataChanged() before any broker answers. Every Metadata response
+ * after that publishes only what differs from what was published before,
+ * and rewrites the cache when anything did.
+ */
+class KafkaClient final : public QObject {
+  Q_OBJECT
+
+public:
+  using ProduceCallback = std::function<void(const QVector<ProducedBatch> &)>;
+
+  explicit KafkaClient(QObject *parent = nullptr);
+  ~KafkaClient() override;
+
+  void setBootstrapServers(const QStringList &servers);
+  /** Directory for MetadataCache files; empty (the default) disables it. */
+  void setMetadataCacheRoot(const QString &root);
+  /** Disk cache KafkaBatchSource reads through; null (the default) disables it. */
+  void setBatchCache(std::shared_ptr<BatchCache> cache);
+  std::shared_ptr<BatchCache> batchCache() const;
+  void setClientId(const QString &clientId);
+  void setMaxInFlightPerBroker(int maxInFlight);
+  int maxInFlightPerBroker() const { return m_maxInFlight.load(); }
+  void setFetchMaxWaitMs(qint32 maxWaitMs) { m_fetchMaxWaitMs.store(maxWaitMs); }
+
+  quint64 refreshMetadata();
+  /**
+   * @brief Resolves @p timestamp (or kLatestTimestamp / kEarliestTimestamp)
+   * to an offset for each partition; answered by offsetsListed().
+   */
+  quint64 listOffsets(const QVector<TopicPartition> &partitions, qint64 timestamp);
+  /**
+   * @brief Fetches record batches; answered by fetchCompleted(). Partition
+   * level errors are reported per partition, not through requestFailed().
+   */
+  quint64 fetch(const QVector<FetchTarget> &targets);
+  /**
+   * @brief Committed offsets of every group in the cluster; answered by
+   * groupOffsetsFetched(). All brokers are asked concurrently; brokers
+   * older than Kafka 3.0 (OffsetFetch < v8) get one pipelined request per
+   * group instead of one per kGroupsPerOffsetFetch groups.
+   */
+  quint64 fetchGroupOffsets();
+  /**
+   * @brief Appends @p batches, at most one per partition, with acks=all:
+   * one Produce request per partition leader. @p done runs on the client
+   * thread once every leader answered, so it must return quickly and must
+   * not call the blocking variants. Partition level errors are reported
+   * per batch; a request that fails as a whole reports NETWORK_EXCEPTION
+   * for each of its batches.
+   */
+  void produce(const QVector<ProduceBatch> &batches, qint32 timeoutMs,
+               const ProduceCallback &done);
+
+  /**
+   * @brief Blocking variants for worker threads. They must not be called
+   * from the client thread (they would deadlock) and should not be called
+   * from the GUI thread. Return false with @p error set on failure or
+   * after @p timeoutMs.
+   */
+  bool listOffsetsBlocking(const QVector<TopicPartition> &partitions, qint64 timestamp,
+                           QVector<PartitionOffset> *offsets, QString *error,
+                           int timeoutMs = kDefaultBlockingTimeoutMs);
+  /** As above, also reporting the ListOffsets requests sent, one per leader asked. */
+  bool listOffsetsBlocking(const QVector<TopicPartition> &partitions, qint64 timestamp,
+                           QVector<PartitionOffset> *offsets, int *requestCount,
+                           QString *error, int timeoutMs = kDefaultBlockingTimeoutMs);
+  bool fetchBlocking(const QVector<FetchTarget> &targets, QVector<FetchedPartition> *partitions,
+                     QString *error, int timeoutMs = kDefaultBlockingTimeoutMs);
+  /**
+   * @brief Like fetchBlocking(), through the incremental fetch sessions in
+   * @p sessions: the first call sends every target, later ones only the
+   * targets whose offset or size limit changed since the previous call
+   * with the same sessions. Partitions with nothing new may be left out of
+   * @p partitions. Calls sharing @p sessions must not overlap. After a
+   * timeout the sessions start over: the late answer is dropped and the
+   * next call sends every target again.
+   */
+  bool fetchSessionBlocking(const std::shared_ptr<FetchSessions> &sessions,
+                            const QVector<FetchTarget> &targets,
+                            QVector<FetchedPartition> *partitions, QString *error,
+                            int timeoutMs = kDefaultBlockingTimeoutMs);
+  bool metadataBlocking(ClusterMetadata *metadata, QString *error,
+                        int timeoutMs = kDefaultBlockingTimeoutMs);
+  bool groupOffsetsBlocking(GroupOffsetsSnapshot *snapshot, QString *error,
+                            int timeoutMs = kDefaultBlockingTimeoutMs);
+  /** A fresh idempotent producer id from any broker. */
+  bool initProducerIdBlocking(ProducerId *producerId, QString *error,
+                              int timeoutMs = kDefaultBlockingTimeoutMs);
+
+  /**
+   * @brief Releases the brokers' side of @p sessions once its reader is
+   * done with them; no answer is awaited.
+   */
+  void closeFetchSessions(const std::shared_ptr<FetchSessions> &sessions);
+
+  /**
+   * @brief Thread-safe copy of the last metadata received.
+   */
+  ClusterMetadata metadata() const;
+
+  static constexpr int kDefaultBlockingTimeoutMs = 30000;
+  /** Groups per OffsetFetch v8 request. */
+  static constexpr int kGroupsPerOffsetFetch = 256;
+
+signals:
+  void metadataUpdated(const kafka::ClusterMetadata &metadata);
+  /**
+   * @brief Changes to the published topology; the first one after
+   * setBootstrapServers() holds the whole cached or fetched tree.
+   */
+  void metadataChanged(const kafka::MetadataDiff &diff);
+  void offsetsListed(quint64 requestId, const QVector<kafka::PartitionOffset> &offsets);
+  void fetchCompleted(quint64 requestId, const QVector<kafka::FetchedPartition> &partitions);
+  void groupOffsetsFetched(quint64 requestId, const kafka::GroupOffsetsSnapshot &snapshot);
+  void requestFailed(quint64 requestId, const QString &error);
+
+private:
+  using MetadataCallback = std::function<void(const QString &error)>;
+  using ErrorCallback = std::function<void(const QString &error)>;
+  using OffsetsCallback =
+      std::function<void(const QVector<PartitionOffset> &, int requestCount)>;
+  using FetchCallback = std::function<void(const QVector<FetchedPartition> &)>;
+  using GroupOffsetsCallback = std::function<void(const GroupOffsetsSnapshot &)>;
+  using ProducerIdCallback = std::function<void(const ProducerId &, const QString &error)>;
+
+  quint64 nextRequestId() { return m_nextRequestId.fetch_add(1); }
+
+  void doRefreshMetadata(const MetadataCallback &callback);
+  void doListOffsets(const QVector<TopicPartition> &partitions, qint64 timestamp,
+                     const OffsetsCallback &done);
+  void doFetch(const QVector<FetchTarget> &targets, const FetchCallback &done);
+  void doSessionFetch(const std::shared_ptr<FetchSessions> &sessions,
+                      const QVector<FetchTarget> &targets, const FetchCallback &done);
+  /**
+   * @brief Sends @p targets to @p nodeId through its session; a rejected
+   * session is retried once as a full fetch when @p retry is set.
+   */
+  void sendSessionFetch(const std::shared_ptr<FetchSessions> &sessions, qint32 nodeId,
+                        const QVector<FetchTarget> &targets, bool retry,
+                        const FetchCallback &done);
+  void closeFetchSession(qint32 nodeId, FetchSession *session);
+  void appendFetched(const FetchResponse &response, const QByteArray &frame,
+                     const QHash<TopicPartition, qint64> &fetchOffsets,
+                     QVector<FetchedPartition> *results);
+  void doFetchGroupOffsets(const GroupOffsetsCallback &done);
+  void doProduce(const QVector<ProduceBatch> &batches, qint32 timeoutMs,
+                 const ProduceCallback &done);
+  void doInitProducerId(const ProducerIdCallback &done);
+
+  /**
+   * @brief Runs @p action once metadata is available, fetching it first if
+   * needed; calls @p onError instead when no metadata can be obtained.
+   */
+  void withMetadata(const std::function<void()> &action, const ErrorCallback &onError);
+  ErrorCallback failRequest(quint64 requestId);
+  void applyMetadata(const MetadataResponse &response);
+  void publishCachedMetadata();
+  void publishMetadata(const ClusterMetadata &metadata);
+  void invalidateMetadataOnError(qint16 errorCode);
+
+  BrokerConnection *connectionFor(qint32 nodeId);
+  BrokerConnection *anyConnection();
+
+  QStringList m_bootstrapServers;
+  int m_bootstrapIndex = 0;
+  QString m_clientId = QStringLiteral("kafka-viewer");
+  std::atomic<int> m_maxInFlight{5};
+  std::atomic<qint32> m_fetchMaxWaitMs{100};
+  std::atomic<quint64> m_nextRequestId{1};
+  // Read by worker threads on every KafkaBatchSource::read().
+  mutable QMutex m_batchCacheMutex;
+  std::shared_ptr<BatchCache> m_batchCache;
+
+  QHash<qint32, BrokerConnection *> m_connections;
+  BrokerConnection *m_bootstrap = nullptr;
+
+  mutable QMutex m_metadataMutex;
+  ClusterMetadata m_metadata;
+  // Client thread only; ClusterMetadata::leaderFor() scans every topic.
+  QHash<TopicPartition, qint32> m_leaders;
+  bool m_hasMetadata = false;
+  bool m_metadataStale = false;
+  // Client thread only: what metadataChanged() has told receivers so far.
+  QString m_metadataCacheRoot;
+  ClusterMetadata m_published;
+  bool m_publishedFromCache = false;
+  bool m_metadataInFlight = false;
+  std::vector<MetadataCallback> m_metadataWaiters;
+};
+
+} // namespace kafka
@@ -0,0 +1,19 @@
+#include "core/network/KafkaSession.h"
+
+#include "core/network/KafkaClient.h"
+
+namespace kafka {
+
+KafkaSession::KafkaSession(QObject *parent) : QObject(parent), m_client(new KafkaClient) {
+  m_thread.setObjectName(QStringLiteral("kafka-network"));
+  m_client->moveToThread(&m_thread);
+  connect(&m_thread, &QThread::finished, m_client, &QObject::deleteLater);
+  m_thread.start();
+}
+
+KafkaSession::~KafkaSession() {
+  m_thread.quit();
+  m_thread.wait();
+}
+
+} // namespace kafka
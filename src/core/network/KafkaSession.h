@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QObject>
+#include <QThread>
+
+namespace kafka {
+
+class KafkaClient;
+
+/**
+ * @brief Owns the network thread and the KafkaClient living on it.
+ *
+ * Create the session on the GUI thread and talk to client(); its request
+ * methods are thread-safe and its signals arrive as queued calls.
+ */
+class KafkaSession final : public QObject {
+  Q_OBJECT
+
+public:
+  explicit KafkaSession(QObject *parent = nullptr);
+  ~KafkaSession() override;
+
+  KafkaClient *client() const { return m_client; }
+
+private:
+  QThread m_thread;
+  KafkaClient *m_client = nullptr;
+};
+
+} // namespace kafka
@@ -0,0 +1,195 @@
+#include "core/network/MetadataCache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <cstring>
+#include <string>
+
+#include "core/checksum/Crc32c.h"
+#include "core/protocol/Wire.h"
+
+namespace kafka {
+
+namespace {
+constexpr char kMagic[4] = {'K', 'V', 'M', 'C'};
+constexpr std::int32_t kVersion = 2;
+constexpr std::size_t kCrcSize = 4;
+constexpr std::size_t kTopicIdSize = 16;
+
+void writeNodeList(WireWriter &writer, const QVector<qint32> &nodes) {
+  writer.writeUnsignedVarint(static_cast<std::uint32_t>(nodes.size()));
+  for (qint32 node : nodes)
+    writer.writeVarint(node);
+}
+
+bool readNodeList(WireReader &reader, QVector<qint32> *nodes) {
+  const std::uint32_t count = reader.readUnsignedVarint();
+  // Every entry takes at least a byte; a larger count is corruption.
+  if (!reader.ok() || count > reader.remaining())
+    return false;
+  nodes->resize(static_cast<int>(count));
+  for (qint32 &node : *nodes)
+    node = reader.readVarint();
+  return reader.ok();
+}
+
+QString readQString(WireReader &reader) {
+  const std::string_view text = reader.readString();
+  return QString::fromUtf8(text.data(), static_cast<int>(text.size()));
+}
+
+std::string encode(const ClusterMetadata &metadata) {
+  WireWriter writer(256 * 1024);
+  writer.writeRaw(kMagic, sizeof(kMagic));
+  writer.writeInt32(kVersion);
+
+  writer.writeInt32(metadata.controllerId);
+  writer.writeUnsignedVarint(static_cast<std::uint32_t>(metadata.brokers.size()));
+  for (const BrokerInfo &broker : metadata.brokers) {
+    writer.writeInt32(broker.nodeId);
+    writer.writeString(broker.host.toStdString());
+    writer.writeInt16(static_cast<std::int16_t>(broker.port));
+    writer.writeString(broker.rack.toStdString());
+  }
+
+  writer.writeUnsignedVarint(static_cast<std::uint32_t>(metadata.topics.size()));
+  for (const TopicInfo &topic : metadata.topics) {
+    writer.writeString(topic.name.toStdString());
+    writer.writeRaw(topic.topicId.toRfc4122().constData(), kTopicIdSize);
+    writer.writeBool(topic.isInternal);
+    writer.writeInt16(topic.errorCode);
+    writer.writeUnsignedVarint(static_cast<std::uint32_t>(topic.partitions.size()));
+    for (const PartitionInfo &partition : topic.partitions) {
+      writer.writeVarint(partition.partition);
+      writer.writeVarint(partition.leader);
+      writer.writeInt16(partition.errorCode);
+      writeNodeList(writer, partition.replicas);
+      writeNodeList(writer, partition.isr);
+    }
+  }
+
+  const std::uint32_t crc = Crc32c::compute(writer.buffer());
+  writer.writeUInt32(crc);
+  return writer.take();
+}
+
+bool decode(std::string_view bytes, ClusterMetadata *metadata) {
+  if (bytes.size() < sizeof(kMagic) + kCrcSize ||
+      std::memcmp(bytes.data(), kMagic, sizeof(kMagic)) != 0)
+    return false;
+  const std::string_view body = bytes.substr(0, bytes.size() - kCrcSize);
+  WireReader trailer(bytes.substr(body.size()));
+  if (trailer.readUInt32() != Crc32c::compute(body))
+    return false;
+
+  WireReader reader(body.substr(sizeof(kMagic)));
+  if (reader.readInt32() != kVersion)
+    return false;
+
+  ClusterMetadata result;
+  result.controllerId = reader.readInt32();
+  const std::uint32_t brokerCount = reader.readUnsignedVarint();
+  if (!reader.ok() || brokerCount > reader.remaining())
+    return false;
+  result.brokers.reserve(static_cast<int>(brokerCount));
+  for (std::uint32_t i = 0; i < brokerCount && reader.ok(); ++i) {
+    BrokerInfo broker;
+    broker.nodeId = reader.readInt32();
+    broker.host = readQString(reader);
+    broker.port = static_cast<quint16>(reader.readInt16());
+    broker.rack = readQString(reader);
+    result.brokers.append(broker);
+  }
+
+  const std::uint32_t topicCount = reader.readUnsignedVarint();
+  if (!reader.ok() || topicCount > reader.remaining())
+    return false;
+  result.topics.reserve(static_cast<int>(topicCount));
+  for (std::uint32_t i = 0; i < topicCount && reader.ok(); ++i) {
+    TopicInfo topic;
+    topic.name = readQString(reader);
+    const std::string_view topicId = reader.readRaw(kTopicIdSize);
+    topic.topicId = QUuid::fromRfc4122(
+        QByteArray(topicId.data(), static_cast<int>(topicId.size())));
+    topic.isInternal = reader.readBool();
+    topic.errorCode = reader.readInt16();
+    const std::uint32_t partitionCount = reader.readUnsignedVarint();
+    if (!reader.ok() || partitionCount > reader.remaining())
+      return false;
+    topic.partitions.resize(static_cast<int>(partitionCount));
+    for (PartitionInfo &partition : topic.partitions) {
+      partition.partition = reader.readVarint();
+      partition.leader = reader.readVarint();
+      partition.errorCode = reader.readInt16();
+      if (!readNodeList(reader, &partition.replicas) || !readNodeList(reader, &partition.isr))
+        return false;
+    }
+    result.topics.append(std::move(topic));
+  }
+  if (!reader.ok() || reader.remaining() != 0)
+    return false;
+  *metadata = std::move(result);
+  return true;
+}
+} // namespace
+
+QString MetadataCache::defaultRoot() {
+  return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
+      .filePath(QStringLiteral("metadata"));
+}
+
+QString MetadataCache::pathFor(const QString &root, const QStringList &bootstrapServers) {
+  QStringList servers;
+  for (const QString &server : bootstrapServers)
+    servers.append(server.trimmed().toLower());
+  servers.sort();
+  servers.removeDuplicates();
+  const QByteArray digest =
+      QCryptographicHash::hash(servers.join(QLatin1Char(',')).toUtf8(),
+                               QCryptographicHash::Sha1)
+          .toHex();
+  return QDir(root).filePath(QString::fromLatin1(digest) + QStringLiteral(".meta"));
+}
+
+bool MetadataCache::load(const QString &path, ClusterMetadata *metadata, QString *error) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    if (error)
+      *error = QStringLiteral("Cannot open %1: %2").arg(path, file.errorString());
+    return false;
+  }
+  const QByteArray bytes = file.readAll();
+  if (!decode(std::string_view(bytes.constData(), static_cast<std::size_t>(bytes.size())),
+              metadata)) {
+    if (error)
+      *error = QStringLiteral("%1 is not a valid metadata cache").arg(path);
+    return false;
+  }
+  return true;
+}
+
+bool MetadataCache::save(const QString &path, const ClusterMetadata &metadata, QString *error) {
+  if (!QDir().mkpath(QFileInfo(path).absolutePath())) {
+    if (error)
+      *error = QStringLiteral("Cannot create the directory of %1").arg(path);
+    return false;
+  }
+  const std::string bytes = encode(metadata);
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly) ||
+      file.write(bytes.data(), static_cast<qint64>(bytes.size())) !=
+          static_cast<qint64>(bytes.size()) ||
+      !file.commit()) {
+    if (error)
+      *error = QStringLiteral("Cannot write %1: %2").arg(path, file.errorString());
+    return false;
+  }
+  return true;
+}
+
+} // namespace kafka
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include "core/network/ClientTypes.h"
+
+namespace kafka {
+
+/**
+ * @brief Last known topology of a cluster, kept on disk so the topic list
+ * can be shown before the first Metadata response arrives.
+ *
+ * One file per set of bootstrap servers. Its body uses the wire encoding
+ * with varints for partition ids, leaders and replica lists, which keeps a
+ * 20k partition cluster at a few hundred kilobytes, and ends with a CRC32C
+ * of everything before it. A file that is truncated, corrupt or from
+ * another format version simply does not load.
+ */
+class MetadataCache {
+public:
+  /** The application's cache directory plus "metadata". */
+  static QString defaultRoot();
+  /** File under @p root for @p bootstrapServers, in any order. */
+  static QString pathFor(const QString &root, const QStringList &bootstrapServers);
+
+  static bool load(const QString &path, ClusterMetadata *metadata, QString *error);
+  /** Replaces the file atomically. */
+  static bool save(const QString &path, const ClusterMetadata &metadata, QString *error);
+};
+
+} // namespace kafka
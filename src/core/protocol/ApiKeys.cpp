@@ -0,0 +1,81 @@
+#include "core/protocol/ApiKeys.h"
+
+namespace kafka {
+
+const char *apiKeyName(ApiKey key) {
+  switch (key) {
+  case ApiKey::Produce:
+    return "Produce";
+  case ApiKey::Fetch:
+    return "Fetch";
+  case ApiKey::ListOffsets:
+    return "ListOffsets";
+  case ApiKey::Metadata:
+    return "Metadata";
+  case ApiKey::OffsetFetch:
+    return "OffsetFetch";
+  case ApiKey::ListGroups:
+    return "ListGroups";
+  case ApiKey::ApiVersions:
+    return "ApiVersions";
+  case ApiKey::InitProducerId:
+    return "InitProducerId";
+  }
+  return "Unknown";
+}
+
+const char *errorName(std::int16_t code) {
+  switch (static_cast<ErrorCode>(code)) {
+  case ErrorCode::UnknownServerError:
+    return "UNKNOWN_SERVER_ERROR";
+  case ErrorCode::None:
+    return "NONE";
+  case ErrorCode::OffsetOutOfRange:
+    return "OFFSET_OUT_OF_RANGE";
+  case ErrorCode::CorruptMessage:
+    return "CORRUPT_MESSAGE";
+  case ErrorCode::UnknownTopicOrPartition:
+    return "UNKNOWN_TOPIC_OR_PARTITION";
+  case ErrorCode::LeaderNotAvailable:
+    return "LEADER_NOT_AVAILABLE";
+  case ErrorCode::NotLeaderForPartition:
+    return "NOT_LEADER_FOR_PARTITION";
+  case ErrorCode::RequestTimedOut:
+    return "REQUEST_TIMED_OUT";
+  case ErrorCode::MessageTooLarge:
+    return "MESSAGE_TOO_LARGE";
+  case ErrorCode::NetworkException:
+    return "NETWORK_EXCEPTION";
+  case ErrorCode::CoordinatorLoadInProgress:
+    return "COORDINATOR_LOAD_IN_PROGRESS";
+  case ErrorCode::CoordinatorNotAvailable:
+    return "COORDINATOR_NOT_AVAILABLE";
+  case ErrorCode::NotCoordinator:
+    return "NOT_COORDINATOR";
+  case ErrorCode::RecordListTooLarge:
+    return "RECORD_LIST_TOO_LARGE";
+  case ErrorCode::NotEnoughReplicas:
+    return "NOT_ENOUGH_REPLICAS";
+  case ErrorCode::NotEnoughReplicasAfterAppend:
+    return "NOT_ENOUGH_REPLICAS_AFTER_APPEND";
+  case ErrorCode::GroupAuthorizationFailed:
+    return "GROUP_AUTHORIZATION_FAILED";
+  case ErrorCode::UnsupportedVersion:
+    return "UNSUPPORTED_VERSION";
+  case ErrorCode::OutOfOrderSequenceNumber:
+    return "OUT_OF_ORDER_SEQUENCE_NUMBER";
+  case ErrorCode::DuplicateSequenceNumber:
+    return "DUPLICATE_SEQUENCE_NUMBER";
+  case ErrorCode::InvalidProducerEpoch:
+    return "INVALID_PRODUCER_EPOCH";
+  case ErrorCode::UnknownProducerId:
+    return "UNKNOWN_PRODUCER_ID";
+  case ErrorCode::FetchSessionIdNotFound:
+    return "FETCH_SESSION_ID_NOT_FOUND";
+  case ErrorCode::InvalidFetchSessionEpoch:
+    return "INVALID_FETCH_SESSION_EPOCH";
+  }
+  return "UNKNOWN_ERROR_CODE";
+}
+
+} // namespace kafka
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+namespace kafka {
+
+enum class ApiKey : std::int16_t {
+  Produce = 0,
+  Fetch = 1,
+  ListOffsets = 2,
+  Metadata = 3,
+  OffsetFetch = 9,
+  ListGroups = 16,
+  ApiVersions = 18,
+  InitProducerId = 22,
+};
+
+/**
+ * @brief Broker error codes the client reacts to. Anything not listed is
+ * still surfaced numerically through errorName().
+ */
+enum class ErrorCode : std::int16_t {
+  UnknownServerError = -1,
+  None = 0,
+  OffsetOutOfRange = 1,
+  CorruptMessage = 2,
+  UnknownTopicOrPartition = 3,
+  LeaderNotAvailable = 5,
+  NotLeaderForPartition = 6,
+  RequestTimedOut = 7,
+  MessageTooLarge = 10,
+  NetworkException = 13,
+  CoordinatorLoadInProgress = 14,
+  CoordinatorNotAvailable = 15,
+  NotCoordinator = 16,
+  RecordListTooLarge = 18,
+  NotEnoughReplicas = 19,
+  NotEnoughReplicasAfterAppend = 20,
+  GroupAuthorizationFailed = 30,
+  UnsupportedVersion = 35,
+  OutOfOrderSequenceNumber = 45,
+  DuplicateSequenceNumber = 46,
+  InvalidProducerEpoch = 47,
+  UnknownProducerId = 59,
+  FetchSessionIdNotFound = 70,
+  InvalidFetchSessionEpoch = 71,
+};
+
+/**
+ * @brief Special ListOffsets timestamps.
+ */
+constexpr std::int64_t kLatestTimestamp = -1;
+constexpr std::int64_t kEarliestTimestamp = -2;
+
+const char *apiKeyName(ApiKey key);
+const char *errorName(std::int16_t code);
+
+} // namespace kafka
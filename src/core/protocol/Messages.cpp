@@ -0,0 +1,815 @@
+#include "core/protocol/Messages.h"
+
+#include <limits>
+
+namespace kafka {
+
+namespace {
+constexpr std::size_t kTopicIdSize = 16;
+// Metadata v8+ authorized operations when they were not asked for.
+constexpr std::int32_t kAuthorizedOperationsOmitted = std::numeric_limits<std::int32_t>::min();
+
+std::string readStdString(WireReader &reader) {
+  const std::string_view view = reader.readString();
+  return std::string(view);
+}
+
+// Flexible versions differ only in how lengths are encoded and in the
+// tagged field sections, so one encoder serves both forms.
+void writeString(WireWriter &writer, std::string_view value, bool flexible) {
+  if (flexible)
+    writer.writeCompactString(value);
+  else
+    writer.writeString(value);
+}
+
+void writeArrayLength(WireWriter &writer, std::int32_t length, bool flexible) {
+  if (flexible)
+    writer.writeCompactArrayLength(length);
+  else
+    writer.writeArrayLength(length);
+}
+
+void writeTags(WireWriter &writer, bool flexible) {
+  if (flexible)
+    writer.writeEmptyTaggedFields();
+}
+
+std::string readString(WireReader &reader, bool flexible) {
+  return std::string(flexible ? reader.readCompactString() : reader.readString());
+}
+
+std::int32_t readArrayLength(WireReader &reader, std::size_t minElementSize, bool flexible) {
+  return flexible ? reader.readCompactArrayLength(minElementSize)
+                  : reader.readArrayLength(minElementSize);
+}
+
+void skipTags(WireReader &reader, bool flexible) {
+  if (flexible)
+    reader.skipTaggedFields();
+}
+
+template <typename T, typename Fn>
+bool readArray(WireReader &reader, std::vector<T> &out, std::size_t minElementSize, Fn &&readOne,
+               bool flexible = false) {
+  const std::int32_t count = readArrayLength(reader, minElementSize, flexible);
+  out.clear();
+  if (count <= 0)
+    return reader.ok();
+  out.resize(static_cast<std::size_t>(count));
+  for (T &element : out) {
+    if (!readOne(element) || !reader.ok())
+      return false;
+  }
+  return reader.ok();
+}
+
+void writeInt32Array(WireWriter &writer, const std::vector<std::int32_t> &values,
+                     bool flexible = false) {
+  writeArrayLength(writer, static_cast<std::int32_t>(values.size()), flexible);
+  for (std::int32_t value : values)
+    writer.writeInt32(value);
+}
+
+bool readInt32Array(WireReader &reader, std::vector<std::int32_t> &values, bool flexible = false) {
+  return readArray(
+      reader, values, 4,
+      [&](std::int32_t &value) {
+        value = reader.readInt32();
+        return true;
+      },
+      flexible);
+}
+
+void encodeOffsetFetchTopics(WireWriter &writer,
+                             const std::vector<OffsetFetchTopicResponse> &topics,
+                             std::int16_t version) {
+  const bool flexible = version >= 6;
+  writeArrayLength(writer, static_cast<std::int32_t>(topics.size()), flexible);
+  for (const OffsetFetchTopicResponse &topic : topics) {
+    writeString(writer, topic.name, flexible);
+    writeArrayLength(writer, static_cast<std::int32_t>(topic.partitions.size()), flexible);
+    for (const OffsetFetchPartitionResponse &partition : topic.partitions) {
+      writer.writeInt32(partition.partition);
+      writer.writeInt64(partition.committedOffset);
+      if (version >= 5)
+        writer.writeInt32(partition.leaderEpoch);
+      if (flexible)
+        writer.writeCompactNullableString(partition.metadata);
+      else
+        writer.writeNullableString(partition.metadata);
+      writer.writeInt16(partition.errorCode);
+      writeTags(writer, flexible);
+    }
+    writeTags(writer, flexible);
+  }
+}
+
+bool decodeOffsetFetchTopics(WireReader &reader, std::vector<OffsetFetchTopicResponse> &topics,
+                             std::int16_t version) {
+  const bool flexible = version >= 6;
+  return readArray(
+      reader, topics, 2,
+      [&](OffsetFetchTopicResponse &topic) {
+        topic.name = readString(reader, flexible);
+        const bool partitionsOk = readArray(
+            reader, topic.partitions, 15,
+            [&](OffsetFetchPartitionResponse &partition) {
+              partition.partition = reader.readInt32();
+              partition.committedOffset = reader.readInt64();
+              if (version >= 5)
+                partition.leaderEpoch = reader.readInt32();
+              partition.metadata = readString(reader, flexible);
+              partition.errorCode = reader.readInt16();
+              skipTags(reader, flexible);
+              return true;
+            },
+            flexible);
+        skipTags(reader, flexible);
+        return partitionsOk;
+      },
+      flexible);
+}
+} // namespace
+
+bool isFlexibleVersion(ApiKey key, std::int16_t version) {
+  switch (key) {
+  case ApiKey::Produce:
+    return version >= 9;
+  case ApiKey::Fetch:
+    return version >= 12;
+  case ApiKey::ListOffsets:
+    return version >= 6;
+  case ApiKey::Metadata:
+    return version >= 9;
+  case ApiKey::OffsetFetch:
+    return version >= 6;
+  case ApiKey::ListGroups:
+    return version >= 3;
+  case ApiKey::ApiVersions:
+    return false;
+  case ApiKey::InitProducerId:
+    return version >= 2;
+  }
+  return false;
+}
+
+void RequestHeader::encode(WireWriter &writer) const {
+  writer.writeInt16(static_cast<std::int16_t>(apiKey));
+  writer.writeInt16(apiVersion);
+  writer.writeInt32(correlationId);
+  writer.writeNullableString(clientId);
+  writeTags(writer, isFlexibleVersion(apiKey, apiVersion));
+}
+
+bool RequestHeader::decode(WireReader &reader) {
+  apiKey = static_cast<ApiKey>(reader.readInt16());
+  apiVersion = reader.readInt16();
+  correlationId = reader.readInt32();
+  clientId = std::string(reader.readString());
+  skipTags(reader, isFlexibleVersion(apiKey, apiVersion));
+  return reader.ok();
+}
+
+std::string encodeRequestFrame(const RequestHeader &header, std::string_view body) {
+  WireWriter writer(32 + header.clientId.size() + body.size());
+  const std::size_t sizePosition = writer.reserveInt32();
+  header.encode(writer);
+  writer.writeRaw(body);
+  writer.patchInt32(sizePosition, static_cast<std::int32_t>(writer.size() - 4));
+  return writer.take();
+}
+
+std::string encodeResponseFrame(std::int32_t correlationId, std::string_view body,
+                                bool flexible) {
+  WireWriter writer(9 + body.size());
+  writer.writeInt32(static_cast<std::int32_t>(body.size() + (flexible ? 5 : 4)));
+  writer.writeInt32(correlationId);
+  writeTags(writer, flexible);
+  writer.writeRaw(body);
+  return writer.take();
+}
+
+void ApiVersionsResponse::encode(WireWriter &writer, std::int16_t) const {
+  writer.writeInt16(errorCode);
+  writer.writeArrayLength(static_cast<std::int32_t>(apiKeys.size()));
+  for (const ApiVersionRange &range : apiKeys) {
+    writer.writeInt16(range.apiKey);
+    writer.writeInt16(range.minVersion);
+    writer.writeInt16(range.maxVersion);
+  }
+}
+
+bool ApiVersionsResponse::decode(WireReader &reader, std::int16_t version) {
+  if (version != 0)
+    return false;
+  errorCode = reader.readInt16();
+  return readArray(reader, apiKeys, 6, [&](ApiVersionRange &range) {
+    range.apiKey = reader.readInt16();
+    range.minVersion = reader.readInt16();
+    range.maxVersion = reader.readInt16();
+    return true;
+  });
+}
+
+void MetadataRequest::encode(WireWriter &writer, std::int16_t version) const {
+  const bool flexible = version >= 9;
+  if (allTopics) {
+    writeArrayLength(writer, -1, flexible);
+  } else {
+    writeArrayLength(writer, static_cast<std::int32_t>(topics.size()), flexible);
+    for (const std::string &topic : topics) {
+      if (version >= 10) {
+        writer.writeRaw(std::string(kTopicIdSize, '\0'));
+        writer.writeCompactNullableString(topic);
+      } else {
+        writeString(writer, topic, flexible);
+      }
+      writeTags(writer, flexible);
+    }
+  }
+  if (version >= 4)
+    writer.writeBool(allowAutoTopicCreation);
+  if (version >= 8) {
+    // Cluster and topic authorized operations, neither wanted.
+    writer.writeBool(false);
+    writer.writeBool(false);
+  }
+  writeTags(writer, flexible);
+}
+
+bool MetadataRequest::decode(WireReader &reader, std::int16_t version) {
+  if (version < 1 || version > 10)
+    return false;
+  const bool flexible = version >= 9;
+  const std::int32_t count = readArrayLength(reader, 2, flexible);
+  allTopics = count < 0;
+  topics.clear();
+  for (std::int32_t i = 0; i < count && reader.ok(); ++i) {
+    if (version >= 10)
+      reader.skip(kTopicIdSize);
+    topics.push_back(readString(reader, flexible));
+    skipTags(reader, flexible);
+  }
+  if (version >= 4)
+    allowAutoTopicCreation = reader.readBool();
+  if (version >= 8) {
+    reader.readBool();
+    reader.readBool();
+  }
+  skipTags(reader, flexible);
+  return reader.ok();
+}
+
+void MetadataResponse::encode(WireWriter &writer, std::int16_t version) const {
+  const bool flexible = version >= 9;
+  if (version >= 3)
+    writer.writeInt32(0); // throttle time
+  writeArrayLength(writer, static_cast<std::int32_t>(brokers.size()), flexible);
+  for (const MetadataBroker &broker : brokers) {
+    writer.writeInt32(broker.nodeId);
+    writeString(writer, broker.host, flexible);
+    writer.writeInt32(broker.port);
+    if (flexible)
+      writer.writeCompactNullableString(broker.rack, broker.rack.empty());
+    else
+      writer.writeNullableString(broker.rack, broker.rack.empty());
+    writeTags(writer, flexible);
+  }
+  if (version >= 2) {
+    // No cluster id.
+    if (flexible)
+      writer.writeCompactNullableString(std::string_view(), true);
+    else
+      writer.writeNullableString(std::string_view(), true);
+  }
+  writer.writeInt32(controllerId);
+  writeArrayLength(writer, static_cast<std::int32_t>(topics.size()), flexible);
+  for (const MetadataTopic &topic : topics) {
+    writer.writeInt16(topic.errorCode);
+    writeString(writer, topic.name, flexible);
+    if (version >= 10) {
+      writer.writeRaw(topic.topicId.size() == kTopicIdSize ? topic.topicId
+                                                           : std::string(kTopicIdSize, '\0'));
+    }
+    writer.writeBool(topic.isInternal);
+    writeArrayLength(writer, static_cast<std::int32_t>(topic.partitions.size()), flexible);
+    for (const MetadataPartition &partition : topic.partitions) {
+      writer.writeInt16(partition.errorCode);
+      writer.writeInt32(partition.partition);
+      writer.writeInt32(partition.leader);
+      if (version >= 7)
+        writer.writeInt32(-1); // leader epoch
+      writeInt32Array(writer, partition.replicas, flexible);
+      writeInt32Array(writer, partition.isr, flexible);
+      if (version >= 5)
+        writeArrayLength(writer, 0, flexible); // offline replicas
+      writeTags(writer, flexible);
+    }
+    if (version >= 8)
+      writer.writeInt32(kAuthorizedOperationsOmitted);
+    writeTags(writer, flexible);
+  }
+  if (version >= 8)
+    writer.writeInt32(kAuthorizedOperationsOmitted);
+  writeTags(writer, flexible);
+}
+
+bool MetadataResponse::decode(WireReader &reader, std::int16_t version) {
+  if (version < 1 || version > 10)
+    return false;
+  const bool flexible = version >= 9;
+  if (version >= 3)
+    reader.readInt32(); // throttle time
+  const bool brokersOk = readArray(
+      reader, brokers, 12,
+      [&](MetadataBroker &broker) {
+        broker.nodeId = reader.readInt32();
+        broker.host = readString(reader, flexible);
+        broker.port = reader.readInt32();
+        broker.rack = readString(reader, flexible);
+        skipTags(reader, flexible);
+        return true;
+      },
+      flexible);
+  if (!brokersOk)
+    return false;
+  if (version >= 2)
+    readString(reader, flexible); // cluster id
+  controllerId = reader.readInt32();
+  std::vector<std::int32_t> offlineReplicas;
+  const bool topicsOk = readArray(
+      reader, topics, 9,
+      [&](MetadataTopic &topic) {
+        topic.errorCode = reader.readInt16();
+        topic.name = readString(reader, flexible);
+        if (version >= 10)
+          topic.topicId = std::string(reader.readRaw(kTopicIdSize));
+        topic.isInternal = reader.readBool();
+        const bool partitionsOk = readArray(
+            reader, topic.partitions, 18,
+            [&](MetadataPartition &partition) {
+              partition.errorCode = reader.readInt16();
+              partition.partition = reader.readInt32();
+              partition.leader = reader.readInt32();
+              if (version >= 7)
+                reader.readInt32(); // leader epoch
+              if (!readInt32Array(reader, partition.replicas, flexible) ||
+                  !readInt32Array(reader, partition.isr, flexible))
+                return false;
+              if (version >= 5 && !readInt32Array(reader, offlineReplicas, flexible))
+                return false;
+              skipTags(reader, flexible);
+              return true;
+            },
+            flexible);
+        if (version >= 8)
+          reader.readInt32(); // topic authorized operations
+        skipTags(reader, flexible);
+        return partitionsOk;
+      },
+      flexible);
+  if (!topicsOk)
+    return false;
+  if (version >= 8)
+    reader.readInt32(); // cluster authorized operations
+  skipTags(reader, flexible);
+  return reader.ok();
+}
+
+void ListOffsetsRequest::encode(WireWriter &writer, std::int16_t) const {
+  writer.writeInt32(replicaId);
+  writer.writeArrayLength(static_cast<std::int32_t>(topics.size()));
+  for (const ListOffsetsTopic &topic : topics) {
+    writer.writeString(topic.name);
+    writer.writeArrayLength(static_cast<std::int32_t>(topic.partitions.size()));
+    for (const ListOffsetsPartition &partition : topic.partitions) {
+      writer.writeInt32(partition.partition);
+      writer.writeInt64(partition.timestamp);
+    }
+  }
+}
+
+bool ListOffsetsRequest::decode(WireReader &reader, std::int16_t version) {
+  if (version != 1)
+    return false;
+  replicaId = reader.readInt32();
+  return readArray(reader, topics, 6, [&](ListOffsetsTopic &topic) {
+    topic.name = readStdString(reader);
+    return readArray(reader, topic.partitions, 12, [&](ListOffsetsPartition &partition) {
+      partition.partition = reader.readInt32();
+      partition.timestamp = reader.readInt64();
+      return true;
+    });
+  });
+}
+
+void ListOffsetsResponse::encode(WireWriter &writer, std::int16_t) const {
+  writer.writeArrayLength(static_cast<std::int32_t>(topics.size()));
+  for (const ListOffsetsTopicResponse &topic : topics) {
+    writer.writeString(topic.name);
+    writer.writeArrayLength(static_cast<std::int32_t>(topic.partitions.size()));
+    for (const ListOffsetsPartitionResponse &partition : topic.partitions) {
+      writer.writeInt32(partition.partition);
+      writer.writeInt16(partition.errorCode);
+      writer.writeInt64(partition.timestamp);
+      writer.writeInt64(partition.offset);
+    }
+  }
+}
+
+bool ListOffsetsResponse::decode(WireReader &reader, std::int16_t version) {
+  if (version != 1)
+    return false;
+  return readArray(reader, topics, 6, [&](ListOffsetsTopicResponse &topic) {
+    topic.name = readStdString(reader);
+    return readArray(reader, topic.partitions, 22, [&](ListOffsetsPartitionResponse &partition) {
+      partition.partition = reader.readInt32();
+      partition.errorCode = reader.readInt16();
+      partition.timestamp = reader.readInt64();
+      partition.offset = reader.readInt64();
+      return true;
+    });
+  });
+}
+
+void FetchRequest::encode(WireWriter &writer, std::int16_t version) const {
+  writer.writeInt32(replicaId);
+  writer.writeInt32(maxWaitMs);
+  writer.writeInt32(minBytes);
+  writer.writeInt32(maxBytes);
+  writer.writeInt8(isolationLevel);
+  if (version >= 7) {
+    writer.writeInt32(sessionId);
+    writer.writeInt32(sessionEpoch);
+  }
+  writer.writeArrayLength(static_cast<std::int32_t>(topics.size()));
+  for (const FetchTopic &topic : topics) {
+    writer.writeString(topic.name);
+    writer.writeArrayLength(static_cast<std::int32_t>(topic.partitions.size()));
+    for (const FetchPartition &partition : topic.partitions) {
+      writer.writeInt32(partition.partition);
+      writer.writeInt64(partition.fetchOffset);
+      if (version >= 5)
+        writer.writeInt64(partition.logStartOffset);
+      writer.writeInt32(partition.maxBytes);
+    }
+  }
+  if (version >= 7) {
+    writer.writeArrayLength(static_cast<std::int32_t>(forgottenTopics.size()));
+    for (const FetchForgottenTopic &topic : forgottenTopics) {
+      writer.writeString(topic.name);
+      writeInt32Array(writer, topic.partitions);
+    }
+  }
+}
+
+bool FetchRequest::decode(WireReader &reader, std::int16_t version) {
+  if (version < 4 || version > 7)
+    return false;
+  replicaId = reader.readInt32();
+  maxWaitMs = reader.readInt32();
+  minBytes = reader.readInt32();
+  maxBytes = reader.readInt32();
+  isolationLevel = reader.readInt8();
+  sessionId = version >= 7 ? reader.readInt32() : 0;
+  sessionEpoch = version >= 7 ? reader.readInt32() : kFinalFetchSessionEpoch;
+  const bool topicsOk = readArray(reader, topics, 6, [&](FetchTopic &topic) {
+    topic.name = readStdString(reader);
+    return readArray(reader, topic.partitions, version >= 5 ? 24 : 16,
+                     [&](FetchPartition &partition) {
+                       partition.partition = reader.readInt32();
+                       partition.fetchOffset = reader.readInt64();
+                       partition.logStartOffset = version >= 5 ? reader.readInt64() : -1;
+                       partition.maxBytes = reader.readInt32();
+                       return true;
+                     });
+  });
+  forgottenTopics.clear();
+  if (!topicsOk || version < 7)
+    return topicsOk;
+  return readArray(reader, forgottenTopics, 6, [&](FetchForgottenTopic &topic) {
+    topic.name = readStdString(reader);
+    return readInt32Array(reader, topic.partitions);
+  });
+}
+
+void FetchResponse::encode(WireWriter &writer, std::int16_t version) const {
+  writer.writeInt32(throttleTimeMs);
+  if (version >= 7) {
+    writer.writeInt16(errorCode);
+    writer.writeInt32(sessionId);
+  }
+  writer.writeArrayLength(static_cast<std::int32_t>(topics.size()));
+  for (const FetchTopicResponse &topic : topics) {
+    writer.writeString(topic.name);
+    writer.writeArrayLength(static_cast<std::int32_t>(topic.partitions.size()));
+    for (const FetchPartitionResponse &partition : topic.partitions) {
+      writer.writeInt32(partition.partition);
+      writer.writeInt16(partition.errorCode);
+      writer.writeInt64(partition.highWatermark);
+      writer.writeInt64(partition.lastStableOffset);
+      if (version >= 5)
+        writer.writeInt64(partition.logStartOffset);
+      writer.writeArrayLength(static_cast<std::int32_t>(partition.abortedTransactions.size()));
+      for (const AbortedTransaction &aborted : partition.abortedTransactions) {
+        writer.writeInt64(aborted.producerId);
+        writer.writeInt64(aborted.firstOffset);
+      }
+      writer.writeBytes(partition.records);
+    }
+  }
+}
+
+bool FetchResponse::decode(WireReader &reader, std::int16_t version) {
+  if (version < 4 || version > 7)
+    return false;
+  throttleTimeMs = reader.readInt32();
+  errorCode = version >= 7 ? reader.readInt16() : 0;
+  sessionId = version >= 7 ? reader.readInt32() : 0;
+  return readArray(reader, topics, 6, [&](FetchTopicResponse &topic) {
+    topic.name = readStdString(reader);
+    return readArray(reader, topic.partitions, version >= 5 ? 38 : 30,
+                     [&](FetchPartitionResponse &partition) {
+                       partition.partition = reader.readInt32();
+                       partition.errorCode = reader.readInt16();
+                       partition.highWatermark = reader.readInt64();
+                       partition.lastStableOffset = reader.readInt64();
+                       partition.logStartOffset = version >= 5 ? reader.readInt64() : -1;
+                       const bool abortedOk = readArray(
+                           reader, partition.abortedTransactions, 16,
+                           [&](AbortedTransaction &aborted) {
+                             aborted.producerId = reader.readInt64();
+                             aborted.firstOffset = reader.readInt64();
+                             return true;
+                           });
+                       partition.records = reader.readBytes();
+                       return abortedOk;
+                     });
+  });
+}
+
+void ListGroupsResponse::encode(WireWriter &writer, std::int16_t version) const {
+  if (version >= 1)
+    writer.writeInt32(throttleTimeMs);
+  writer.writeInt16(errorCode);
+  writer.writeArrayLength(static_cast<std::int32_t>(groups.size()));
+  for (const ListedGroup &group : groups) {
+    writer.writeString(group.groupId);
+    writer.writeString(group.protocolType);
+  }
+}
+
+bool ListGroupsResponse::decode(WireReader &reader, std::int16_t version) {
+  if (version > 1)
+    return false;
+  throttleTimeMs = version >= 1 ? reader.readInt32() : 0;
+  errorCode = reader.readInt16();
+  return readArray(reader, groups, 4, [&](ListedGroup &group) {
+    group.groupId = readStdString(reader);
+    group.protocolType = readStdString(reader);
+    return true;
+  });
+}
+
+void OffsetFetchRequest::encode(WireWriter &writer, std::int16_t version) const {
+  const bool flexible = version >= 6;
+  auto writeTopics = [&](const OffsetFetchGroup &group) {
+    if (group.allTopics) {
+      writeArrayLength(writer, -1, flexible);
+      return;
+    }
+    writeArrayLength(writer, static_cast<std::int32_t>(group.topics.size()), flexible);
+    for (const OffsetFetchTopic &topic : group.topics) {
+      writeString(writer, topic.name, flexible);
+      writeArrayLength(writer, static_cast<std::int32_t>(topic.partitions.size()), flexible);
+      for (std::int32_t partition : topic.partitions)
+        writer.writeInt32(partition);
+      writeTags(writer, flexible);
+    }
+  };
+
+  if (version >= 8) {
+    writer.writeCompactArrayLength(static_cast<std::int32_t>(groups.size()));
+    for (const OffsetFetchGroup &group : groups) {
+      writer.writeCompactString(group.groupId);
+      writeTopics(group);
+      writer.writeEmptyTaggedFields();
+    }
+  } else {
+    const OffsetFetchGroup group = groups.empty() ? OffsetFetchGroup() : groups.front();
+    writeString(writer, group.groupId, flexible);
+    writeTopics(group);
+  }
+  if (version >= 7)
+    writer.writeBool(requireStable);
+  writeTags(writer, flexible);
+}
+
+bool OffsetFetchRequest::decode(WireReader &reader, std::int16_t version) {
+  if (version < 2 || version > 8)
+    return false;
+  const bool flexible = version >= 6;
+  auto readTopics = [&](OffsetFetchGroup &group) {
+    const std::int32_t count = readArrayLength(reader, 2, flexible);
+    group.allTopics = count < 0;
+    group.topics.clear();
+    for (std::int32_t i = 0; i < count && reader.ok(); ++i) {
+      OffsetFetchTopic topic;
+      topic.name = readString(reader, flexible);
+      if (!readInt32Array(reader, topic.partitions, flexible))
+        return false;
+      skipTags(reader, flexible);
+      group.topics.push_back(std::move(topic));
+    }
+    return reader.ok();
+  };
+
+  groups.clear();
+  if (version >= 8) {
+    const bool groupsOk = readArray(
+        reader, groups, 3,
+        [&](OffsetFetchGroup &group) {
+          group.groupId = readString(reader, true);
+          const bool topicsOk = readTopics(group);
+          reader.skipTaggedFields();
+          return topicsOk;
+        },
+        true);
+    if (!groupsOk)
+      return false;
+  } else {
+    groups.resize(1);
+    groups.front().groupId = readString(reader, flexible);
+    if (!readTopics(groups.front()))
+      return false;
+  }
+  requireStable = version >= 7 && reader.readBool();
+  skipTags(reader, flexible);
+  return reader.ok();
+}
+
+void OffsetFetchResponse::encode(WireWriter &writer, std::int16_t version) const {
+  const bool flexible = version >= 6;
+  if (version >= 3)
+    writer.writeInt32(throttleTimeMs);
+  if (version >= 8) {
+    writer.writeCompactArrayLength(static_cast<std::int32_t>(groups.size()));
+    for (const OffsetFetchGroupResponse &group : groups) {
+      writer.writeCompactString(group.groupId);
+      encodeOffsetFetchTopics(writer, group.topics, version);
+      writer.writeInt16(group.errorCode);
+      writer.writeEmptyTaggedFields();
+    }
+  } else {
+    const OffsetFetchGroupResponse group =
+        groups.empty() ? OffsetFetchGroupResponse() : groups.front();
+    encodeOffsetFetchTopics(writer, group.topics, version);
+    writer.writeInt16(group.errorCode);
+  }
+  writeTags(writer, flexible);
+}
+
+bool OffsetFetchResponse::decode(WireReader &reader, std::int16_t version) {
+  if (version < 2 || version > 8)
+    return false;
+  const bool flexible = version >= 6;
+  throttleTimeMs = version >= 3 ? reader.readInt32() : 0;
+  groups.clear();
+  if (version >= 8) {
+    const bool groupsOk = readArray(
+        reader, groups, 5,
+        [&](OffsetFetchGroupResponse &group) {
+          group.groupId = readString(reader, true);
+          const bool topicsOk = decodeOffsetFetchTopics(reader, group.topics, version);
+          group.errorCode = reader.readInt16();
+          reader.skipTaggedFields();
+          return topicsOk;
+        },
+        true);
+    if (!groupsOk)
+      return false;
+  } else {
+    groups.resize(1);
+    if (!decodeOffsetFetchTopics(reader, groups.front().topics, version))
+      return false;
+    groups.front().errorCode = reader.readInt16();
+  }
+  skipTags(reader, flexible);
+  return reader.ok();
+}
+
+void ProduceRequest::encode(WireWriter &writer, std::int16_t) const {
+  writer.writeNullableString(transactionalId, transactionalId.empty());
+  writer.writeInt16(acks);
+  writer.writeInt32(timeoutMs);
+  writer.writeArrayLength(static_cast<std::int32_t>(topics.size()));
+  for (const ProduceTopic &topic : topics) {
+    writer.writeString(topic.name);
+    writer.writeArrayLength(static_cast<std::int32_t>(topic.partitions.size()));
+    for (const ProducePartition &partition : topic.partitions) {
+      writer.writeInt32(partition.partition);
+      writer.writeBytes(partition.records);
+    }
+  }
+}
+
+bool ProduceRequest::decode(WireReader &reader, std::int16_t version) {
+  if (version < 3 || version > 7)
+    return false;
+  transactionalId = readStdString(reader);
+  acks = reader.readInt16();
+  timeoutMs = reader.readInt32();
+  return readArray(reader, topics, 6, [&](ProduceTopic &topic) {
+    topic.name = readStdString(reader);
+    return readArray(reader, topic.partitions, 8, [&](ProducePartition &partition) {
+      partition.partition = reader.readInt32();
+      partition.records = reader.readBytes();
+      return true;
+    });
+  });
+}
+
+void ProduceResponse::encode(WireWriter &writer, std::int16_t version) const {
+  writer.writeArrayLength(static_cast<std::int32_t>(topics.size()));
+  for (const ProduceTopicResponse &topic : topics) {
+    writer.writeString(topic.name);
+    writer.writeArrayLength(static_cast<std::int32_t>(topic.partitions.size()));
+    for (const ProducePartitionResponse &partition : topic.partitions) {
+      writer.writeInt32(partition.partition);
+      writer.writeInt16(partition.errorCode);
+      writer.writeInt64(partition.baseOffset);
+      writer.writeInt64(partition.logAppendTimeMs);
+      if (version >= 5)
+        writer.writeInt64(partition.logStartOffset);
+    }
+  }
+  writer.writeInt32(throttleTimeMs);
+}
+
+bool ProduceResponse::decode(WireReader &reader, std::int16_t version) {
+  if (version < 3 || version > 7)
+    return false;
+  const std::size_t partitionSize = version >= 5 ? 30 : 22;
+  const bool topicsOk = readArray(reader, topics, 6, [&](ProduceTopicResponse &topic) {
+    topic.name = readStdString(reader);
+    return readArray(reader, topic.partitions, partitionSize,
+                     [&](ProducePartitionResponse &partition) {
+                       partition.partition = reader.readInt32();
+                       partition.errorCode = reader.readInt16();
+                       partition.baseOffset = reader.readInt64();
+                       partition.logAppendTimeMs = reader.readInt64();
+                       if (version >= 5)
+                         partition.logStartOffset = reader.readInt64();
+                       return true;
+                     });
+  });
+  throttleTimeMs = reader.readInt32();
+  return topicsOk && reader.ok();
+}
+
+void InitProducerIdRequest::encode(WireWriter &writer, std::int16_t) const {
+  writer.writeNullableString(transactionalId, transactionalId.empty());
+  writer.writeInt32(transactionTimeoutMs);
+}
+
+bool InitProducerIdRequest::decode(WireReader &reader, std::int16_t version) {
+  if (version > 1)
+    return false;
+  transactionalId = readStdString(reader);
+  transactionTimeoutMs = reader.readInt32();
+  return reader.ok();
+}
+
+void InitProducerIdResponse::encode(WireWriter &writer, std::int16_t) const {
+  writer.writeInt32(throttleTimeMs);
+  writer.writeInt16(errorCode);
+  writer.writeInt64(producerId);
+  writer.writeInt16(producerEpoch);
+}
+
+bool InitProducerIdResponse::decode(WireReader &reader, std::int16_t version) {
+  if (version > 1)
+    return false;
+  throttleTimeMs = reader.readInt32();
+  errorCode = reader.readInt16();
+  producerId = reader.readInt64();
+  producerEpoch = reader.readInt16();
+  return reader.ok();
+}
+
+const std::vector<SupportedVersion> &supportedVersions() {
+  static const std::vector<SupportedVersion> versions = {
+      {ApiKey::Produce, 3, 7},
+      {ApiKey::Fetch, 4, 7},
+      {ApiKey::ListOffsets, 1, 1},
+      {ApiKey::Metadata, 1, 10},
+      {ApiKey::OffsetFetch, 2, 8},
+      {ApiKey::ListGroups, 0, 1},
+      {ApiKey::ApiVersions, 0, 0},
+      {ApiKey::InitProducerId, 0, 1},
+  };
+  return versions;
+}
+
+} // namespace kafka
@@ -0,0 +1,397 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/protocol/ApiKeys.h"
+#include "core/protocol/Wire.h"
+
+namespace kafka {
+
+/*
+ * Request and response bodies for the APIs the viewer speaks. Each message
+ * can both encode and decode itself so the same definitions serve the
+ * client and the in-process MockBroker. Only the versions listed next to
+ * each struct are implemented; decode() returns false for anything else.
+ *
+ * Decoded byte payloads (Fetch and Produce records) are views into the
+ * frame that was decoded and stay valid only as long as that frame does.
+ *
+ * Flexible versions (KIP-482) use compact lengths and tagged fields in the
+ * body and one more tagged field section in both headers; tagged fields
+ * are written empty and skipped when read.
+ */
+
+/**
+ * @brief Whether @p version of @p key is a flexible version. ApiVersions
+ * is never treated as one; the viewer only speaks ApiVersions v0.
+ */
+bool isFlexibleVersion(ApiKey key, std::int16_t version);
+
+struct RequestHeader {
+  ApiKey apiKey = ApiKey::ApiVersions;
+  std::int16_t apiVersion = 0;
+  std::int32_t correlationId = 0;
+  std::string clientId;
+
+  /** Header v1, or v2 for flexible versions. */
+  void encode(WireWriter &writer) const;
+  bool decode(WireReader &reader);
+};
+
+/**
+ * @brief Frames a request: INT32 size, request header, body.
+ */
+std::string encodeRequestFrame(const RequestHeader &header, std::string_view body);
+/**
+ * @brief Frames a response: INT32 size, correlation id (header v0, or v1
+ * with an empty tagged field section when @p flexible), body.
+ */
+std::string encodeResponseFrame(std::int32_t correlationId, std::string_view body,
+                                bool flexible = false);
+
+// ApiVersions v0
+struct ApiVersionsRequest {
+  void encode(WireWriter &, std::int16_t) const {}
+  bool decode(WireReader &, std::int16_t version) { return version == 0; }
+};
+
+struct ApiVersionRange {
+  std::int16_t apiKey = 0;
+  std::int16_t minVersion = 0;
+  std::int16_t maxVersion = 0;
+};
+
+struct ApiVersionsResponse {
+  std::int16_t errorCode = 0;
+  std::vector<ApiVersionRange> apiKeys;
+
+  void encode(WireWriter &writer, std::int16_t version) const;
+  bool decode(WireReader &reader, std::int16_t version);
+};
+
+// Metadata v1-v10. v10 adds topic ids (KIP-516), which tell a topic
+// apart from an earlier one of the same name; fields of the versions in
+// between that the viewer has no use for are skipped when read and
+// written as defaults.
+struct MetadataRequest {
+  /** Empty together with allTopics = true requests every topic. */
+  std::vector<std::string> topics;
+  bool allTopics = true;
+  /** v4+; below v4 the broker's auto.create.topics.enable alone decides. */
+  bool allowAutoTopicCreation = true;
+
+  void encode(WireWriter &writer, std::int16_t version) const;
+  bool decode(WireReader &reader, std::int16_t version);
+};
+
+struct MetadataBroker {
+  std::int32_t nodeId = -1;
+  std::string host;
+  std::int32_t port = 0;
+  std::string rack;
+};
+
+struct MetadataPartition {
+  std::int16_t errorCode = 0;
+  std::int32_t partition = 0;
+  std::int32_t leader = -1;
+  std::vector<std::int32_t> replicas;
+  std::vector<std::int32_t> isr;
+};
+
+struct MetadataTopic {
+  std::int16_t errorCode = 0;
+  std::string name;
+  /** v10+; 16 bytes, all zero when the broker assigns none. Empty before. */
+  std::string topicId;
+  bool isInternal = false;
+  std::vector<MetadataPartition> partitions;
+};
+
+struct MetadataResponse {
+  std::vector<MetadataBroker> brokers;
+  std::int32_t controllerId = -1;
+  std::vector<MetadataTopic> topics;
+
+  void encode(WireWriter &writer, std::int16_t version) const;
+  bool decode(WireReader &reader, std::int16_t version);
+};
+
+// ListOffsets v1
+struct ListOffsetsPartition {
+  std::int32_t partition = 0;
+  /** Target timestamp, or kLatestTimestamp / kEarliestTimestamp. */
+  std::int64_t timestamp = kLatestTimestamp;
+};
+
+struct ListOffsetsTopic {
+  std::string name;
+  std::vector<ListOffsetsPartition> partitions;
+};
+
+struct ListOffsetsRequest {
+  std::int32_t replicaId = -1;
+  std::vector<ListOffsetsTopic> topics;
+
+  void encode(WireWriter &writer, std::int16_t version) const;
+  bool decode(WireReader &reader, std::int16_t version);
+};
+
+struct ListOffsetsPartitionResponse {
+  std::int32_t partition = 0;
+  std::int16_t errorCode = 0;
+  std::int64_t timestamp = -1;
+  std::int64_t offset = -1;
+};
+
+struct ListOffsetsTopicResponse {
+  std::string name;
+  std::vector<ListOffsetsPartitionResponse> partitions;
+};
+
+struct ListOffsetsResponse {
+  std::vector<ListOffsetsTopicResponse> topics;
+
+  void encode(WireWriter &writer, std::int16_t version) const;
+  bool decode(WireReader &reader, std::int16_t version);
+};
+
+// Fetch v4-v7. v5 adds log start offsets; v7 adds incremental fetch
+// sessions (KIP-227), in which a request names only the partitions that
+// changed since the previous one of the same session.
+struct FetchPartition {
+  std::int32_t partition = 0;
+  std::int64_t fetchOffset = 0;
+  /** v5+; only followers send one, consumers send -1. */
+  std::int64_t logStartOffset = -1;
+  std::int32_t maxBytes = 1 << 20;
+};
+
+struct FetchTopic {
+  std::string name;
+  std::vector<FetchPartition> partitions;
+};
+
+struct FetchForgottenTopic {
+  std::string name;
+  std::vector<std::int32_t> partitions;
+};
+
+constexpr std::int32_t kInitialFetchSessionEpoch = 0;
+constexpr std::int32_t kFinalFetchSessionEpoch = -1;
+
+struct FetchRequest {
+  std::int32_t replicaId = -1;
+  std::int32_t maxWaitMs = 500;
+  std::int32_t minBytes = 1;
+  std::int32_t maxBytes = 32 << 20;
+  /** 0 = read uncommitted, 1 = read committed. */
+  std::int8_t isolationLevel = 0;
+  /** v7+; 0 outside a session. */
+  std::int32_t sessionId = 0;
+  /**
+   * v7+; kInitialFetchSessionEpoch asks for a new session and
+   * kFinalFetchSessionEpoch fetches without one, closing @c sessionId.
+   */
+  std::int32_t sessionEpoch = kFinalFetchSessionEpoch;
+  std::vector<FetchTopic> topics;
+  /** v7+; partitions to drop from the session. */
+  std::vector<FetchForgottenTopic> forgottenTopics;
+
+  void encode(WireWriter &writer, std::int16_t version) const;
+  bool decode(WireReader &reader, std::int16_t version);
+};
+
+struct AbortedTransaction {
+  std::int64_t producerId = 0;
+  std::int64_t firstOffset = 0;
+};
+
+struct FetchPartitionResponse {
+  std::int32_t partition = 0;
+  std::int16_t errorCode = 0;
+  std::int64_t highWatermark = -1;
+  std::int64_t lastStableOffset = -1;
+  /** v5+. */
+  std::int64_t logStartOffset = -1;
+  std::vector<AbortedTransaction> abortedTransactions;
+  /** Raw record batches; a view into the decoded frame. */
+  std::string_view records;
+};
+
+struct FetchTopicResponse {
+  std::string name;
+  std::vector<FetchPartitionResponse> partitions;
+};
+
+struct FetchResponse {
+  std::int32_t throttleTimeMs = 0;
+  /** v7+; set when the session was rejected, with no topics. */
+  std::int16_t errorCode = 0;
+  /** v7+; the session the request opened or continued, 0 for none. */
+  std::int32_t sessionId = 0;
+  std::vector<FetchTopicResponse> topics;
+
+  void encode(WireWriter &writer, std::int16_t version) const;
+  bool decode(WireReader &reader, std::int16_t version);
+};
+
+// ListGroups v0-v1. Sent to every broker, each answers with the groups it
+// coordinates.
+struct ListGroupsRequest {
+  void encode(WireWriter &, std::int16_t) const {}
+  bool decode(WireReader &, std::int16_t version) { return version <= 1; }
+};
+
+struct ListedGroup {
+  std::string groupId;
+  std::string protocolType;
+};
+
+struct ListGroupsResponse {
+  std::int32_t throttleTimeMs = 0;
+  std::int16_t errorCode = 0;
+  std::vector<ListedGroup> groups;
+
+  void encode(WireWriter &writer, std::int16_t version) const;
+  bool decode(WireReader &reader, std::int16_t version);
+};
+
+// OffsetFetch v2-v8. v8 (KIP-709) carries any number of groups; earlier
+// versions exactly one, the first of @c groups.
+struct OffsetFetchTopic {
+  std::string name;
+  std::vector<std::int32_t> partitions;
+};
+
+struct OffsetFetchGroup {
+  std::string groupId;
+  /** Every partition the group committed when set; @c topics is ignored. */
+  bool allTopics = true;
+  std::vector<OffsetFetchTopic> topics;
+};
+
+struct OffsetFetchRequest {
+  std::vector<OffsetFetchGroup> groups;
+  bool requireStable = false;
+
+  void encode(WireWriter &writer, std::int16_t version) const;
+  bool decode(WireReader &reader, std::int16_t version);
+};
+
+struct OffsetFetchPartitionResponse {
+  std::int32_t partition = 0;
+  /** -1 when the group has no offset for the partition. */
+  std::int64_t committedOffset = -1;
+  std::int32_t leaderEpoch = -1;
+  std::string metadata;
+  std::int16_t errorCode = 0;
+};
+
+struct OffsetFetchTopicResponse {
+  std::string name;
+  std::vector<OffsetFetchPartitionResponse> partitions;
+};
+
+struct OffsetFetchGroupResponse {
+  /** Empty below v8, where the response names no group. */
+  std::string groupId;
+  std::vector<OffsetFetchTopicResponse> topics;
+  std::int16_t errorCode = 0;
+};
+
+struct OffsetFetchResponse {
+  std::int32_t throttleTimeMs = 0;
+  /** Exactly one entry below v8. */
+  std::vector<OffsetFetchGroupResponse> groups;
+
+  void encode(WireWriter &writer, std::int16_t version) const;
+  bool decode(WireReader &reader, std::int16_t version);
+};
+
+// Produce v3-v7. The request is the same in every version of the range;
+// v5 adds the log start offset to the response.
+struct ProducePartition {
+  std::int32_t partition = 0;
+  /**
+   * Record batches. When encoding, the caller keeps the bytes alive until
+   * the encoder has run; when decoding, a view into the decoded frame.
+   */
+  std::string_view records;
+};
+
+struct ProduceTopic {
+  std::string name;
+  std::vector<ProducePartition> partitions;
+};
+
+struct ProduceRequest {
+  /** Empty for a producer outside any transaction; written as null. */
+  std::string transactionalId;
+  /** -1 waits for every in-sync replica; idempotent producers need it. */
+  std::int16_t acks = -1;
+  std::int32_t timeoutMs = 30000;
+  std::vector<ProduceTopic> topics;
+
+  void encode(WireWriter &writer, std::int16_t version) const;
+  bool decode(WireReader &reader, std::int16_t version);
+};
+
+struct ProducePartitionResponse {
+  std::int32_t partition = 0;
+  std::int16_t errorCode = 0;
+  std::int64_t baseOffset = -1;
+  std::int64_t logAppendTimeMs = -1;
+  std::int64_t logStartOffset = -1;
+};
+
+struct ProduceTopicResponse {
+  std::string name;
+  std::vector<ProducePartitionResponse> partitions;
+};
+
+struct ProduceResponse {
+  std::vector<ProduceTopicResponse> topics;
+  std::int32_t throttleTimeMs = 0;
+
+  void encode(WireWriter &writer, std::int16_t version) const;
+  bool decode(WireReader &reader, std::int16_t version);
+};
+
+// InitProducerId v0-v1. Without a transactional id the broker hands out a
+// fresh producer id for idempotent produce.
+struct InitProducerIdRequest {
+  /** Empty for an idempotent, non-transactional producer; written as null. */
+  std::string transactionalId;
+  std::int32_t transactionTimeoutMs = -1;
+
+  void encode(WireWriter &writer, std::int16_t version) const;
+  bool decode(WireReader &reader, std::int16_t version);
+};
+
+struct InitProducerIdResponse {
+  std::int32_t throttleTimeMs = 0;
+  std::int16_t errorCode = 0;
+  std::int64_t producerId = -1;
+  std::int16_t producerEpoch = -1;
+
+  void encode(WireWriter &writer, std::int16_t version) const;
+  bool decode(WireReader &reader, std::int16_t version);
+};
+
+/**
+ * @brief Versions this client implements, used to negotiate against the
+ * ranges a broker reports through ApiVersions.
+ */
+struct SupportedVersion {
+  ApiKey apiKey;
+  std::int16_t minVersion;
+  std::int16_t maxVersion;
+};
+
+const std::vector<SupportedVersion> &supportedVersions();
+
+} // namespace kafka
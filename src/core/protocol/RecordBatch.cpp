@@ -0,0 +1,244 @@
+#include "core/protocol/RecordBatch.h"
+
+#include <algorithm>
+
+#include "core/checksum/Crc32c.h"
+
+namespace kafka {
+
+namespace {
+constexpr std::int8_t kCurrentMagic = 2;
+
+// Varint-prefixed byte string where -1 means null.
+std::string_view readVarBytes(WireReader &reader) {
+  const std::int32_t length = reader.readVarint();
+  if (length < 0)
+    return {};
+  return reader.readRaw(static_cast<std::size_t>(length));
+}
+
+std::size_t varintSize(std::int64_t value) {
+  auto zigzag = (static_cast<std::uint64_t>(value) << 1) ^
+                static_cast<std::uint64_t>(value >> 63);
+  std::size_t size = 1;
+  while (zigzag >= 0x80) {
+    zigzag >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+void writeVarBytes(WireWriter &writer, std::string_view bytes) {
+  if (bytes.data() == nullptr) {
+    writer.writeVarint(-1);
+    return;
+  }
+  writer.writeVarint(static_cast<std::int32_t>(bytes.size()));
+  writer.writeRaw(bytes);
+}
+
+std::size_t varBytesSize(std::string_view bytes) {
+  if (bytes.data() == nullptr)
+    return varintSize(-1);
+  return varintSize(static_cast<std::int64_t>(bytes.size())) + bytes.size();
+}
+} // namespace
+
+const char *compressionName(Compression compression) {
+  switch (compression) {
+  case Compression::None:
+    return "none";
+  case Compression::Gzip:
+    return "gzip";
+  case Compression::Snappy:
+    return "snappy";
+  case Compression::Lz4:
+    return "lz4";
+  case Compression::Zstd:
+    return "zstd";
+  }
+  return "unknown";
+}
+
+bool HeaderReader::next(RecordHeader &header) {
+  if (m_remaining <= 0 || !m_reader.ok())
+    return false;
+  --m_remaining;
+  const std::int32_t keyLength = m_reader.readVarint();
+  header.key = keyLength < 0 ? std::string_view()
+                             : m_reader.readRaw(static_cast<std::size_t>(keyLength));
+  header.value = readVarBytes(m_reader);
+  return m_reader.ok();
+}
+
+ParseStatus RecordBatch::parse(std::string_view bytes, RecordBatch &batch) {
+  return parse(bytes, batch, /*headerOnly=*/false);
+}
+
+ParseStatus RecordBatch::parseHeader(std::string_view bytes, RecordBatch &batch) {
+  if (bytes.size() < kHeaderSize)
+    return ParseStatus::Incomplete;
+  return parse(bytes, batch, /*headerOnly=*/true);
+}
+
+ParseStatus RecordBatch::parse(std::string_view bytes, RecordBatch &batch, bool headerOnly) {
+  if (bytes.size() < kLogOverhead)
+    return ParseStatus::Incomplete;
+
+  WireReader header(bytes);
+  const std::int64_t baseOffset = header.readInt64();
+  const std::int32_t batchLength = header.readInt32();
+  if (batchLength < 0)
+    return ParseStatus::Corrupt;
+
+  const std::size_t totalSize = kLogOverhead + static_cast<std::size_t>(batchLength);
+  if (bytes.size() < totalSize && !headerOnly)
+    return ParseStatus::Incomplete;
+
+  batch.m_bytes = bytes.substr(0, totalSize);
+  batch.m_baseOffset = baseOffset;
+  if (totalSize <= kMagicOffset)
+    return ParseStatus::Corrupt;
+
+  batch.m_partitionLeaderEpoch = header.readInt32();
+  batch.m_magic = header.readInt8();
+  if (batch.m_magic != kCurrentMagic)
+    return ParseStatus::UnsupportedMagic;
+  if (totalSize < kHeaderSize)
+    return ParseStatus::Corrupt;
+
+  batch.m_crc = header.readUInt32();
+  batch.m_attributes = header.readInt16();
+  batch.m_lastOffsetDelta = header.readInt32();
+  batch.m_firstTimestamp = header.readInt64();
+  batch.m_maxTimestamp = header.readInt64();
+  batch.m_producerId = header.readInt64();
+  batch.m_producerEpoch = header.readInt16();
+  batch.m_baseSequence = header.readInt32();
+  batch.m_recordCount = header.readInt32();
+  if (!header.ok() || batch.m_recordCount < 0 || batch.m_lastOffsetDelta < 0)
+    return ParseStatus::Corrupt;
+  return ParseStatus::Ok;
+}
+
+std::uint32_t RecordBatch::computeCrc() const { return Crc32c::compute(crcCoveredBytes()); }
+
+RecordReader::RecordReader(const RecordBatch &batch, std::string_view records)
+    : m_reader(records), m_baseOffset(batch.baseOffset()),
+      m_firstTimestamp(batch.firstTimestamp()), m_maxTimestamp(batch.maxTimestamp()),
+      m_logAppendTime(batch.isLogAppendTime()), m_remaining(batch.recordCount()) {}
+
+bool RecordReader::next(Record &record) {
+  if (m_remaining <= 0 || !m_reader.ok() || m_reader.atEnd())
+    return false;
+  --m_remaining;
+
+  const char *start = m_reader.current();
+  const std::int32_t length = m_reader.readVarint();
+  if (length < 0 || static_cast<std::size_t>(length) > m_reader.remaining()) {
+    m_reader.fail();
+    return false;
+  }
+  const std::size_t prefixSize = static_cast<std::size_t>(m_reader.current() - start);
+  WireReader body(m_reader.readRaw(static_cast<std::size_t>(length)));
+
+  body.readInt8(); // record attributes, unused by v2
+  const std::int64_t timestampDelta = body.readVarlong();
+  const std::int32_t offsetDelta = body.readVarint();
+  record.key = readVarBytes(body);
+  record.value = readVarBytes(body);
+  record.headerCount = body.readVarint();
+  record.headers = std::string_view(body.current(), body.remaining());
+  if (!body.ok() || record.headerCount < 0) {
+    m_reader.fail();
+    return false;
+  }
+
+  record.offset = m_baseOffset + offsetDelta;
+  record.timestamp = m_logAppendTime ? m_maxTimestamp : m_firstTimestamp + timestampDelta;
+  record.encoded = std::string_view(start, prefixSize + static_cast<std::size_t>(length));
+  return true;
+}
+
+ParseStatus BatchReader::next(RecordBatch &batch) {
+  while (m_position < m_buffer.size()) {
+    const ParseStatus status = RecordBatch::parse(m_buffer.substr(m_position), batch);
+    if (status == ParseStatus::UnsupportedMagic) {
+      m_position += batch.size();
+      continue;
+    }
+    if (status == ParseStatus::Ok)
+      m_position += batch.size();
+    return status;
+  }
+  return ParseStatus::Incomplete;
+}
+
+void RecordBatchBuilder::setProducer(std::int64_t producerId, std::int16_t producerEpoch,
+                                     std::int32_t baseSequence) {
+  m_producerId = producerId;
+  m_producerEpoch = producerEpoch;
+  m_baseSequence = baseSequence;
+}
+
+void RecordBatchBuilder::append(const RecordData &record) {
+  if (m_recordCount == 0) {
+    m_firstTimestamp = record.timestamp;
+    m_maxTimestamp = record.timestamp;
+  }
+  m_maxTimestamp = std::max(m_maxTimestamp, record.timestamp);
+
+  const std::int64_t timestampDelta = record.timestamp - m_firstTimestamp;
+  const std::int32_t offsetDelta = m_recordCount;
+
+  std::size_t bodySize = 1 + varintSize(timestampDelta) + varintSize(offsetDelta) +
+                         varBytesSize(record.key) + varBytesSize(record.value) +
+                         varintSize(static_cast<std::int64_t>(record.headers.size()));
+  for (const RecordHeader &header : record.headers) {
+    bodySize += varintSize(static_cast<std::int64_t>(header.key.size())) + header.key.size() +
+                varBytesSize(header.value);
+  }
+
+  m_records.writeVarint(static_cast<std::int32_t>(bodySize));
+  m_records.writeInt8(0);
+  m_records.writeVarlong(timestampDelta);
+  m_records.writeVarint(offsetDelta);
+  writeVarBytes(m_records, record.key);
+  writeVarBytes(m_records, record.value);
+  m_records.writeVarint(static_cast<std::int32_t>(record.headers.size()));
+  for (const RecordHeader &header : record.headers) {
+    m_records.writeVarint(static_cast<std::int32_t>(header.key.size()));
+    m_records.writeRaw(header.key);
+    writeVarBytes(m_records, header.value);
+  }
+  ++m_recordCount;
+}
+
+std::string RecordBatchBuilder::build() const {
+  WireWriter writer(RecordBatch::kHeaderSize + m_records.size());
+  writer.writeInt64(m_baseOffset);
+  const std::size_t lengthPosition = writer.reserveInt32();
+  writer.writeInt32(m_partitionLeaderEpoch);
+  writer.writeInt8(kCurrentMagic);
+  const std::size_t crcPosition = writer.reserveInt32();
+  writer.writeInt16(0); // attributes: uncompressed, create time
+  writer.writeInt32(m_recordCount > 0 ? m_recordCount - 1 : 0);
+  writer.writeInt64(m_firstTimestamp);
+  writer.writeInt64(m_maxTimestamp);
+  writer.writeInt64(m_producerId);
+  writer.writeInt16(m_producerEpoch);
+  writer.writeInt32(m_baseSequence);
+  writer.writeInt32(m_recordCount);
+  writer.writeRaw(m_records.buffer());
+
+  writer.patchInt32(lengthPosition,
+                    static_cast<std::int32_t>(writer.size() - RecordBatch::kLogOverhead));
+  const std::string &bytes = writer.buffer();
+  const std::uint32_t crc =
+      Crc32c::compute(bytes.data() + RecordBatch::kAttributesOffset,
+                      bytes.size() - RecordBatch::kAttributesOffset);
+  writer.patchInt32(crcPosition, static_cast<std::int32_t>(crc));
+  return writer.take();
+}
+
+} // namespace kafka
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/protocol/Wire.h"
+
+namespace kafka {
+
+enum class Compression : std::uint8_t {
+  None = 0,
+  Gzip = 1,
+  Snappy = 2,
+  Lz4 = 3,
+  Zstd = 4,
+};
+
+const char *compressionName(Compression compression);
+
+enum class ParseStatus {
+  Ok,
+  /** Fewer bytes than the batch length; typical at the end of a Fetch. */
+  Incomplete,
+  /** Batch framing is broken; the rest of the buffer cannot be trusted. */
+  Corrupt,
+  /** A pre-0.11 message set (magic 0 or 1); skipped, never decoded. */
+  UnsupportedMagic,
+};
+
+struct RecordHeader {
+  std::string_view key;
+  std::string_view value;
+};
+
+/**
+ * @brief One record inside a batch. Every view points into the buffer the
+ * batch was parsed from; a null key or value has a null data() pointer.
+ */
+struct Record {
+  std::int64_t offset = 0;
+  std::int64_t timestamp = 0;
+  std::string_view key;
+  std::string_view value;
+  /** Raw, still-encoded header section; walk it with HeaderReader. */
+  std::string_view headers;
+  std::int32_t headerCount = 0;
+  /** The whole encoded record including its length prefix. */
+  std::string_view encoded;
+};
+
+/**
+ * @brief Walks the encoded header section of a Record without allocating.
+ */
+class HeaderReader {
+public:
+  explicit HeaderReader(const Record &record)
+      : m_reader(record.headers), m_remaining(record.headerCount) {}
+
+  bool next(RecordHeader &header);
+
+private:
+  WireReader m_reader;
+  std::int32_t m_remaining = 0;
+};
+
+/**
+ * @brief Zero-copy view over a magic v2 record batch.
+ */
+class RecordBatch {
+public:
+  static constexpr std::size_t kLogOverhead = 12; // baseOffset + batchLength
+  static constexpr std::size_t kHeaderSize = 61;
+  static constexpr std::size_t kMagicOffset = 16;
+  static constexpr std::size_t kCrcOffset = 17;
+  static constexpr std::size_t kAttributesOffset = 21;
+
+  /**
+   * @brief Parses the batch at the start of @p bytes. On success the batch
+   * spans the first size() bytes of @p bytes; for UnsupportedMagic size()
+   * is still valid so callers can step over the legacy entry.
+   */
+  static ParseStatus parse(std::string_view bytes, RecordBatch &batch);
+  /**
+   * @brief Parses only the fixed header, e.g. a copy kept next to the
+   * decompressed records. bytes() then holds just what was passed in and
+   * recordsSection() is empty or truncated.
+   */
+  static ParseStatus parseHeader(std::string_view bytes, RecordBatch &batch);
+
+  std::int64_t baseOffset() const { return m_baseOffset; }
+  std::int64_t lastOffset() const { return m_baseOffset + m_lastOffsetDelta; }
+  std::int64_t nextOffset() const { return lastOffset() + 1; }
+  std::int32_t partitionLeaderEpoch() const { return m_partitionLeaderEpoch; }
+  std::int8_t magic() const { return m_magic; }
+  std::uint32_t storedCrc() const { return m_crc; }
+  std::int16_t attributes() const { return m_attributes; }
+  std::int64_t firstTimestamp() const { return m_firstTimestamp; }
+  std::int64_t maxTimestamp() const { return m_maxTimestamp; }
+  std::int64_t producerId() const { return m_producerId; }
+  std::int16_t producerEpoch() const { return m_producerEpoch; }
+  std::int32_t baseSequence() const { return m_baseSequence; }
+  std::int32_t recordCount() const { return m_recordCount; }
+
+  Compression compression() const { return static_cast<Compression>(m_attributes & 0x07); }
+  bool isLogAppendTime() const { return (m_attributes & 0x08) != 0; }
+  bool isTransactional() const { return (m_attributes & 0x10) != 0; }
+  bool isControl() const { return (m_attributes & 0x20) != 0; }
+
+  /** The complete batch, header included. */
+  std::string_view bytes() const { return m_bytes; }
+  std::size_t size() const { return m_bytes.size(); }
+  /** The record section as stored, compressed when compression() != None. */
+  std::string_view recordsSection() const { return m_bytes.substr(kHeaderSize); }
+  /** The bytes covered by the stored CRC (attributes to end of batch). */
+  std::string_view crcCoveredBytes() const { return m_bytes.substr(kAttributesOffset); }
+  /** CRC32C of crcCoveredBytes(), computed on the fastest available path. */
+  std::uint32_t computeCrc() const;
+  bool hasValidCrc() const { return computeCrc() == m_crc; }
+
+private:
+  static ParseStatus parse(std::string_view bytes, RecordBatch &batch, bool headerOnly);
+
+  std::string_view m_bytes;
+  std::int64_t m_baseOffset = 0;
+  std::int32_t m_partitionLeaderEpoch = 0;
+  std::int8_t m_magic = 0;
+  std::uint32_t m_crc = 0;
+  std::int16_t m_attributes = 0;
+  std::int32_t m_lastOffsetDelta = 0;
+  std::int64_t m_firstTimestamp = 0;
+  std::int64_t m_maxTimestamp = 0;
+  std::int64_t m_producerId = -1;
+  std::int16_t m_producerEpoch = -1;
+  std::int32_t m_baseSequence = -1;
+  std::int32_t m_recordCount = 0;
+};
+
+/**
+ * @brief Iterates the records of a batch given its uncompressed record
+ * section (RecordBatch::recordsSection() for uncompressed batches).
+ */
+class RecordReader {
+public:
+  RecordReader(const RecordBatch &batch, std::string_view records);
+
+  /**
+   * @brief Decodes the next record; returns false at the end or on error.
+   */
+  bool next(Record &record);
+  bool ok() const { return m_reader.ok(); }
+
+private:
+  WireReader m_reader;
+  std::int64_t m_baseOffset = 0;
+  std::int64_t m_firstTimestamp = 0;
+  std::int64_t m_maxTimestamp = 0;
+  bool m_logAppendTime = false;
+  std::int32_t m_remaining = 0;
+};
+
+/**
+ * @brief Splits a buffer of back-to-back batches, as found in a Fetch
+ * response or a .log segment, into RecordBatch views.
+ */
+class BatchReader {
+public:
+  explicit BatchReader(std::string_view buffer) : m_buffer(buffer) {}
+
+  /**
+   * @brief Parses the next v2 batch, silently stepping over legacy message
+   * sets. Returns Incomplete once the remaining bytes do not hold a whole
+   * batch; a truncated tail is normal for Fetch responses.
+   */
+  ParseStatus next(RecordBatch &batch);
+  std::size_t position() const { return m_position; }
+
+private:
+  std::string_view m_buffer;
+  std::size_t m_position = 0;
+};
+
+struct RecordData {
+  std::int64_t timestamp = 0;
+  std::string_view key;
+  std::string_view value;
+  std::vector<RecordHeader> headers;
+};
+
+/**
+ * @brief Encodes records into a single uncompressed v2 batch.
+ */
+class RecordBatchBuilder {
+public:
+  explicit RecordBatchBuilder(std::int64_t baseOffset = 0) : m_baseOffset(baseOffset) {}
+
+  void setProducer(std::int64_t producerId, std::int16_t producerEpoch,
+                   std::int32_t baseSequence);
+  void setPartitionLeaderEpoch(std::int32_t epoch) { m_partitionLeaderEpoch = epoch; }
+
+  void append(const RecordData &record);
+  std::int32_t recordCount() const { return m_recordCount; }
+  std::size_t estimatedSize() const { return RecordBatch::kHeaderSize + m_records.size(); }
+  bool isEmpty() const { return m_recordCount == 0; }
+
+  /**
+   * @brief Returns the encoded batch with its CRC filled in.
+   */
+  std::string build() const;
+
+private:
+  std::int64_t m_baseOffset = 0;
+  std::int32_t m_partitionLeaderEpoch = -1;
+  std::int64_t m_producerId = -1;
+  std::int16_t m_producerEpoch = -1;
+  std::int32_t m_baseSequence = -1;
+  std::int64_t m_firstTimestamp = 0;
+  std::int64_t m_maxTimestamp = 0;
+  std::int32_t m_recordCount = 0;
+  WireWriter m_records;
+};
+
+} // namespace kafka
@@ -0,0 +1,258 @@
+#include "core/protocol/Wire.h"
+
+#include <cstring>
+#include <type_traits>
+
+namespace kafka {
+
+namespace {
+template <typename T> void appendBigEndian(std::string &out, T value) {
+  using U = std::make_unsigned_t<T>;
+  const auto bits = static_cast<U>(value);
+  char bytes[sizeof(T)];
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+    bytes[i] = static_cast<char>((bits >> (8 * (sizeof(T) - 1 - i))) & 0xFF);
+  out.append(bytes, sizeof(T));
+}
+
+template <typename T> T loadBigEndian(const char *data) {
+  using U = std::make_unsigned_t<T>;
+  U bits = 0;
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+    bits = static_cast<U>((bits << 8) | static_cast<unsigned char>(data[i]));
+  return static_cast<T>(bits);
+}
+} // namespace
+
+void WireWriter::writeInt8(std::int8_t value) {
+  m_buffer.push_back(static_cast<char>(value));
+}
+
+void WireWriter::writeInt16(std::int16_t value) { appendBigEndian(m_buffer, value); }
+void WireWriter::writeInt32(std::int32_t value) { appendBigEndian(m_buffer, value); }
+void WireWriter::writeInt64(std::int64_t value) { appendBigEndian(m_buffer, value); }
+void WireWriter::writeUInt32(std::uint32_t value) { appendBigEndian(m_buffer, value); }
+
+void WireWriter::writeVarint(std::int32_t value) {
+  const auto zigzag = (static_cast<std::uint32_t>(value) << 1) ^
+                      static_cast<std::uint32_t>(value >> 31);
+  writeUnsignedVarint(zigzag);
+}
+
+void WireWriter::writeVarlong(std::int64_t value) {
+  auto zigzag = (static_cast<std::uint64_t>(value) << 1) ^
+                static_cast<std::uint64_t>(value >> 63);
+  while (zigzag >= 0x80) {
+    m_buffer.push_back(static_cast<char>((zigzag & 0x7F) | 0x80));
+    zigzag >>= 7;
+  }
+  m_buffer.push_back(static_cast<char>(zigzag));
+}
+
+void WireWriter::writeUnsignedVarint(std::uint32_t value) {
+  while (value >= 0x80) {
+    m_buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  m_buffer.push_back(static_cast<char>(value));
+}
+
+void WireWriter::writeString(std::string_view value) {
+  writeInt16(static_cast<std::int16_t>(value.size()));
+  writeRaw(value);
+}
+
+void WireWriter::writeNullableString(std::string_view value, bool isNull) {
+  if (isNull) {
+    writeInt16(-1);
+    return;
+  }
+  writeString(value);
+}
+
+void WireWriter::writeBytes(std::string_view value, bool isNull) {
+  if (isNull) {
+    writeInt32(-1);
+    return;
+  }
+  writeInt32(static_cast<std::int32_t>(value.size()));
+  writeRaw(value);
+}
+
+void WireWriter::writeCompactString(std::string_view value) {
+  writeUnsignedVarint(static_cast<std::uint32_t>(value.size()) + 1);
+  writeRaw(value);
+}
+
+void WireWriter::writeCompactNullableString(std::string_view value, bool isNull) {
+  if (isNull) {
+    writeUnsignedVarint(0);
+    return;
+  }
+  writeCompactString(value);
+}
+
+void WireWriter::writeCompactArrayLength(std::int32_t length) {
+  writeUnsignedVarint(length < 0 ? 0 : static_cast<std::uint32_t>(length) + 1);
+}
+
+void WireWriter::writeRaw(const void *data, std::size_t size) {
+  if (size > 0)
+    m_buffer.append(static_cast<const char *>(data), size);
+}
+
+std::size_t WireWriter::reserveInt32() {
+  const std::size_t position = m_buffer.size();
+  m_buffer.append(4, '\0');
+  return position;
+}
+
+void WireWriter::patchInt32(std::size_t position, std::int32_t value) {
+  const auto bits = static_cast<std::uint32_t>(value);
+  for (std::size_t i = 0; i < 4; ++i)
+    m_buffer[position + i] = static_cast<char>((bits >> (8 * (3 - i))) & 0xFF);
+}
+
+bool WireReader::require(std::size_t size) {
+  if (!m_ok || m_size - m_pos < size) {
+    m_ok = false;
+    return false;
+  }
+  return true;
+}
+
+std::int8_t WireReader::readInt8() {
+  if (!require(1))
+    return 0;
+  return static_cast<std::int8_t>(m_data[m_pos++]);
+}
+
+std::int16_t WireReader::readInt16() {
+  if (!require(2))
+    return 0;
+  const auto value = loadBigEndian<std::int16_t>(m_data + m_pos);
+  m_pos += 2;
+  return value;
+}
+
+std::int32_t WireReader::readInt32() {
+  if (!require(4))
+    return 0;
+  const auto value = loadBigEndian<std::int32_t>(m_data + m_pos);
+  m_pos += 4;
+  return value;
+}
+
+std::int64_t WireReader::readInt64() {
+  if (!require(8))
+    return 0;
+  const auto value = loadBigEndian<std::int64_t>(m_data + m_pos);
+  m_pos += 8;
+  return value;
+}
+
+std::uint32_t WireReader::readUInt32() {
+  return static_cast<std::uint32_t>(readInt32());
+}
+
+std::uint32_t WireReader::readUnsignedVarint() {
+  std::uint32_t value = 0;
+  for (int shift = 0; shift <= 28; shift += 7) {
+    if (!require(1))
+      return 0;
+    const auto byte = static_cast<unsigned char>(m_data[m_pos++]);
+    value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0)
+      return value;
+  }
+  m_ok = false;
+  return 0;
+}
+
+std::int32_t WireReader::readVarint() {
+  const std::uint32_t raw = readUnsignedVarint();
+  return static_cast<std::int32_t>((raw >> 1) ^ (~(raw & 1) + 1));
+}
+
+std::int64_t WireReader::readVarlong() {
+  std::uint64_t raw = 0;
+  for (int shift = 0; shift <= 63; shift += 7) {
+    if (!require(1))
+      return 0;
+    const auto byte = static_cast<unsigned char>(m_data[m_pos++]);
+    raw |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0)
+      return static_cast<std::int64_t>((raw >> 1) ^ (~(raw & 1) + 1));
+  }
+  m_ok = false;
+  return 0;
+}
+
+std::string_view WireReader::readString(bool *isNull) {
+  const std::int16_t length = readInt16();
+  if (isNull)
+    *isNull = length < 0;
+  if (length < 0)
+    return {};
+  return readRaw(static_cast<std::size_t>(length));
+}
+
+std::string_view WireReader::readBytes(bool *isNull) {
+  const std::int32_t length = readInt32();
+  if (isNull)
+    *isNull = length < 0;
+  if (length < 0)
+    return {};
+  return readRaw(static_cast<std::size_t>(length));
+}
+
+std::string_view WireReader::readRaw(std::size_t size) {
+  if (!require(size))
+    return {};
+  std::string_view view(m_data + m_pos, size);
+  m_pos += size;
+  return view;
+}
+
+std::int32_t WireReader::readArrayLength(std::size_t minElementSize) {
+  const std::int32_t length = readInt32();
+  if (length < 0)
+    return -1;
+  if (minElementSize > 0 &&
+      static_cast<std::size_t>(length) > remaining() / minElementSize) {
+    m_ok = false;
+    return 0;
+  }
+  return length;
+}
+
+std::string_view WireReader::readCompactString(bool *isNull) {
+  const std::uint32_t length = readUnsignedVarint();
+  if (isNull)
+    *isNull = length == 0;
+  if (length == 0)
+    return {};
+  return readRaw(length - 1);
+}
+
+std::int32_t WireReader::readCompactArrayLength(std::size_t minElementSize) {
+  const std::uint32_t encoded = readUnsignedVarint();
+  if (encoded == 0)
+    return -1;
+  const std::size_t length = encoded - 1;
+  if (minElementSize > 0 && length > remaining() / minElementSize) {
+    m_ok = false;
+    return 0;
+  }
+  return static_cast<std::int32_t>(length);
+}
+
+void WireReader::skipTaggedFields() {
+  const std::uint32_t count = readUnsignedVarint();
+  for (std::uint32_t i = 0; i < count && m_ok; ++i) {
+    readUnsignedVarint();
+    skip(readUnsignedVarint());
+  }
+}
+
+} // namespace kafka
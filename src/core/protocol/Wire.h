@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace kafka {
+
+/**
+ * @brief Appends Kafka wire primitives (big-endian integers, zig-zag varints,
+ * length-prefixed strings and byte arrays) to a growable byte buffer.
+ */
+class WireWriter {
+public:
+  WireWriter() = default;
+  explicit WireWriter(std::size_t reserve) { m_buffer.reserve(reserve); }
+
+  void writeInt8(std::int8_t value);
+  void writeInt16(std::int16_t value);
+  void writeInt32(std::int32_t value);
+  void writeInt64(std::int64_t value);
+  void writeUInt32(std::uint32_t value);
+  void writeBool(bool value) { writeInt8(value ? 1 : 0); }
+
+  /**
+   * @brief Zig-zag encoded signed varint, as used inside record batches.
+   */
+  void writeVarint(std::int32_t value);
+  void writeVarlong(std::int64_t value);
+  void writeUnsignedVarint(std::uint32_t value);
+
+  /**
+   * @brief INT16 length-prefixed string.
+   */
+  void writeString(std::string_view value);
+  /**
+   * @brief INT16 length-prefixed string, or -1 when @p isNull is set.
+   */
+  void writeNullableString(std::string_view value, bool isNull = false);
+  /**
+   * @brief INT32 length-prefixed bytes, or -1 when @p isNull is set.
+   */
+  void writeBytes(std::string_view value, bool isNull = false);
+  void writeArrayLength(std::int32_t length) { writeInt32(length); }
+
+  /**
+   * @brief Flexible-version (KIP-482) forms: lengths are unsigned varints
+   * holding length + 1, with 0 meaning null.
+   */
+  void writeCompactString(std::string_view value);
+  void writeCompactNullableString(std::string_view value, bool isNull = false);
+  void writeCompactArrayLength(std::int32_t length);
+  /** A tagged field section with no fields. */
+  void writeEmptyTaggedFields() { writeUnsignedVarint(0); }
+
+  void writeRaw(const void *data, std::size_t size);
+  void writeRaw(std::string_view data) { writeRaw(data.data(), data.size()); }
+
+  /**
+   * @brief Reserves room for an INT32 that is filled in later with
+   * patchInt32(), e.g. a frame or batch length.
+   */
+  std::size_t reserveInt32();
+  void patchInt32(std::size_t position, std::int32_t value);
+
+  std::size_t size() const { return m_buffer.size(); }
+  const std::string &buffer() const { return m_buffer; }
+  std::string take() { return std::move(m_buffer); }
+
+private:
+  std::string m_buffer;
+};
+
+/**
+ * @brief Bounds-checked cursor over a borrowed byte range.
+ *
+ * Reads never throw; the first out-of-range or malformed read latches
+ * ok() to false and every later read returns a zero value. Callers decode a
+ * whole structure and check ok() once at the end.
+ */
+class WireReader {
+public:
+  WireReader() = default;
+  WireReader(const char *data, std::size_t size) : m_data(data), m_size(size) {}
+  explicit WireReader(std::string_view data) : WireReader(data.data(), data.size()) {}
+
+  std::int8_t readInt8();
+  std::int16_t readInt16();
+  std::int32_t readInt32();
+  std::int64_t readInt64();
+  std::uint32_t readUInt32();
+  bool readBool() { return readInt8() != 0; }
+
+  std::int32_t readVarint();
+  std::int64_t readVarlong();
+  std::uint32_t readUnsignedVarint();
+
+  /**
+   * @brief Returns a view into the underlying buffer; no bytes are copied.
+   * Null strings and byte arrays are returned as a default (null data)
+   * view and reported through @p isNull when provided.
+   */
+  std::string_view readString(bool *isNull = nullptr);
+  std::string_view readBytes(bool *isNull = nullptr);
+  std::string_view readRaw(std::size_t size);
+  /**
+   * @brief Reads an array length and rejects counts that could not fit in
+   * the remaining bytes given @p minElementSize per element.
+   */
+  std::int32_t readArrayLength(std::size_t minElementSize = 1);
+
+  /** Flexible-version counterparts of readString() and readArrayLength(). */
+  std::string_view readCompactString(bool *isNull = nullptr);
+  std::int32_t readCompactArrayLength(std::size_t minElementSize = 1);
+  /** Skips a tagged field section; no tagged field is interpreted. */
+  void skipTaggedFields();
+
+  void skip(std::size_t size) { readRaw(size); }
+
+  bool ok() const { return m_ok; }
+  bool atEnd() const { return m_pos >= m_size; }
+  std::size_t position() const { return m_pos; }
+  std::size_t remaining() const { return m_ok ? m_size - m_pos : 0; }
+  const char *data() const { return m_data; }
+  const char *current() const { return m_data + m_pos; }
+  void fail() { m_ok = false; }
+
+private:
+  bool require(std::size_t size);
+
+  const char *m_data = nullptr;
+  std::size_t m_size = 0;
+  std::size_t m_pos = 0;
+  bool m_ok = true;
+};
+
+} // namespace kafka
@@ -0,0 +1,343 @@
+#include "core/replay/ReplayReader.h"
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <zstd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+
+#include "core/json/JsonPath.h"
+
+namespace kafka {
+
+namespace {
+constexpr qint64 kReadBytes = 1 << 20;
+constexpr std::string_view kBase64Prefix = "base64:";
+constexpr std::string_view kCsvHeader = "partition,offset,";
+constexpr std::string_view kUtf8Bom = "\xef\xbb\xbf";
+
+template <typename T> bool parseInteger(std::string_view text, T *value) {
+  const auto result = std::from_chars(text.data(), text.data() + text.size(), *value);
+  return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+void decodeBase64(std::string_view text, std::string *out) {
+  const QByteArray decoded = QByteArray::fromBase64(
+      QByteArray::fromRawData(text.data(), static_cast<int>(text.size())));
+  out->assign(decoded.constData(), static_cast<std::size_t>(decoded.size()));
+}
+
+bool isBase64Marker(const JsonValue &encoding) {
+  return encoding.type == JsonValue::String && encoding.raw == "\"base64\"";
+}
+
+// Null leaves the field absent, a string gives its unescaped text (or the
+// bytes it encodes) and any other JSON value its text as written.
+void assignJson(const JsonValue &value, bool base64, bool *present, std::string *out,
+                std::string *scratch) {
+  out->clear();
+  *present = value.type != JsonValue::Missing && value.type != JsonValue::Null;
+  if (!*present)
+    return;
+  if (value.type != JsonValue::String) {
+    out->assign(value.raw);
+    return;
+  }
+  const std::string_view body = value.raw.substr(1, value.raw.size() - 2);
+  std::string *text = base64 ? scratch : out;
+  text->clear();
+  if (body.find('\\') == std::string_view::npos ||
+      !JsonPath::unescape(body, std::numeric_limits<std::size_t>::max(), text))
+    text->assign(body);
+  if (base64)
+    decodeBase64(*scratch, out);
+}
+
+void assignCsv(std::string_view field, bool *present, std::string *out) {
+  out->clear();
+  *present = !field.empty();
+  if (field.substr(0, kBase64Prefix.size()) == kBase64Prefix)
+    decodeBase64(field.substr(kBase64Prefix.size()), out);
+  else
+    out->assign(field);
+}
+
+// Where the CSV record at the start of @p text ends: the first line break
+// outside quotes, or npos when the record is not complete yet.
+std::size_t csvRecordEnd(std::string_view text) {
+  bool quoted = false;
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    const char c = text[i];
+    if (c == '"')
+      quoted = !quoted;
+    else if (c == '\n' && !quoted)
+      return i;
+  }
+  return std::string_view::npos;
+}
+
+// Splits one CSV record into @p fields, reusing their storage; returns the
+// field count.
+std::size_t splitCsv(std::string_view line, std::vector<std::string> &fields) {
+  std::size_t count = 0;
+  std::size_t i = 0;
+  for (;;) {
+    if (fields.size() <= count)
+      fields.emplace_back();
+    std::string &field = fields[count++];
+    field.clear();
+    if (i < line.size() && line[i] == '"') {
+      ++i;
+      while (i < line.size()) {
+        const std::size_t quote = line.find('"', i);
+        if (quote == std::string_view::npos) {
+          field.append(line.substr(i));
+          i = line.size();
+          break;
+        }
+        field.append(line.substr(i, quote - i));
+        i = quote + 1;
+        if (i < line.size() && line[i] == '"') {
+          field += '"';
+          ++i;
+        } else {
+          break;
+        }
+      }
+    }
+    const std::size_t comma = line.find(',', i);
+    field.append(line.substr(i, comma == std::string_view::npos ? comma : comma - i));
+    if (comma == std::string_view::npos)
+      return count;
+    i = comma + 1;
+  }
+}
+} // namespace
+
+ReplayReader::ReplayReader()
+    : m_partitionPath(JsonPath::compile(QStringLiteral("$.partition"), nullptr)),
+      m_timestampPath(JsonPath::compile(QStringLiteral("$.timestamp"), nullptr)),
+      m_keyPath(JsonPath::compile(QStringLiteral("$.key"), nullptr)),
+      m_keyEncodingPath(JsonPath::compile(QStringLiteral("$.keyEncoding"), nullptr)),
+      m_valuePath(JsonPath::compile(QStringLiteral("$.value"), nullptr)),
+      m_valueEncodingPath(JsonPath::compile(QStringLiteral("$.valueEncoding"), nullptr)),
+      m_headersPath(JsonPath::compile(QStringLiteral("$.headers"), nullptr)) {}
+
+ReplayReader::~ReplayReader() { ZSTD_freeDCtx(m_dctx); }
+
+bool ReplayReader::open(const QString &path, QString *error) {
+  m_file.setFileName(path);
+  if (!m_file.open(QIODevice::ReadOnly)) {
+    *error = QStringLiteral("Cannot read %1: %2").arg(path, m_file.errorString());
+    return false;
+  }
+
+  QString name = path;
+  if (name.endsWith(QLatin1String(".zst")))
+    name.chop(4);
+  m_csv = name.endsWith(QLatin1String(".csv"), Qt::CaseInsensitive);
+
+  const QByteArray magic = m_file.peek(4);
+  m_zstd = magic == QByteArray("\x28\xb5\x2f\xfd", 4);
+  if (m_zstd) {
+    m_dctx = ZSTD_createDCtx();
+    if (!m_dctx) {
+      *error = QStringLiteral("Cannot create a zstd decompressor");
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ReplayReader::fill(QString *error) {
+  if (m_eof)
+    return false;
+  if (m_begin > 0) {
+    m_buffer.erase(0, m_begin);
+    m_begin = 0;
+  }
+
+  if (!m_zstd) {
+    const std::size_t used = m_buffer.size();
+    m_buffer.resize(used + static_cast<std::size_t>(kReadBytes));
+    const qint64 read = m_file.read(&m_buffer[used], kReadBytes);
+    m_buffer.resize(used + static_cast<std::size_t>(std::max<qint64>(read, 0)));
+    if (read < 0) {
+      *error = QStringLiteral("Cannot read %1: %2").arg(m_file.fileName(), m_file.errorString());
+      return false;
+    }
+    m_filePosition += read;
+    m_eof = read == 0;
+    return !m_eof;
+  }
+
+  for (;;) {
+    if (m_inputUsed == m_input.size()) {
+      m_input.resize(static_cast<std::size_t>(kReadBytes));
+      const qint64 read = m_file.read(&m_input[0], kReadBytes);
+      if (read < 0) {
+        *error = QStringLiteral("Cannot read %1: %2").arg(m_file.fileName(), m_file.errorString());
+        return false;
+      }
+      m_input.resize(static_cast<std::size_t>(read));
+      m_inputUsed = 0;
+      m_filePosition += read;
+      if (read == 0) {
+        m_eof = true;
+        if (m_frameOpen)
+          *error = QStringLiteral("%1 ends in the middle of a zstd frame").arg(m_file.fileName());
+        return false;
+      }
+    }
+
+    ZSTD_inBuffer in{m_input.data(), m_input.size(), m_inputUsed};
+    const std::size_t used = m_buffer.size();
+    m_buffer.resize(used + ZSTD_DStreamOutSize());
+    ZSTD_outBuffer out{&m_buffer[used], ZSTD_DStreamOutSize(), 0};
+    const std::size_t remaining = ZSTD_decompressStream(m_dctx, &out, &in);
+    m_buffer.resize(used + out.pos);
+    m_inputUsed = in.pos;
+    if (ZSTD_isError(remaining)) {
+      *error = QStringLiteral("Cannot decompress %1: %2")
+                   .arg(m_file.fileName(), QLatin1String(ZSTD_getErrorName(remaining)));
+      return false;
+    }
+    m_frameOpen = remaining != 0;
+    if (out.pos > 0)
+      return true;
+  }
+}
+
+bool ReplayReader::nextLine(std::string_view *line, QString *error) {
+  std::size_t scanned = 0;
+  for (;;) {
+    const std::string_view rest(m_buffer.data() + m_begin, m_buffer.size() - m_begin);
+    // A quoted CSV field can hold line breaks, so CSV is rescanned from the
+    // record start; JSON Lines only looks at what arrived since.
+    std::size_t end = std::string_view::npos;
+    if (m_csv) {
+      end = csvRecordEnd(rest);
+    } else {
+      end = rest.find('\n', scanned);
+      scanned = rest.size();
+    }
+
+    if (end == std::string_view::npos) {
+      if (fill(error))
+        continue;
+      if (!error->isEmpty() || rest.empty())
+        return false;
+      end = rest.size();
+    }
+
+    *line = rest.substr(0, end);
+    m_begin += std::min(end + 1, rest.size());
+    m_recordLine = m_line + 1;
+    m_line += 1 + std::count(line->begin(), line->end(), '\n');
+    if (!line->empty() && line->back() == '\r')
+      line->remove_suffix(1);
+    if (m_recordLine == 1 && line->substr(0, kUtf8Bom.size()) == kUtf8Bom)
+      line->remove_prefix(kUtf8Bom.size());
+    return true;
+  }
+}
+
+bool ReplayReader::next(ReplayRecord *record, QString *error) {
+  error->clear();
+  std::string_view line;
+  for (;;) {
+    if (!nextLine(&line, error))
+      return false;
+    if (line.empty())
+      continue;
+    if (m_csv && m_recordLine == 1 && line.substr(0, kCsvHeader.size()) == kCsvHeader)
+      continue;
+    break;
+  }
+
+  record->partition = -1;
+  record->timestamp = -1;
+  record->headerCount = 0;
+  if (!m_csv) {
+    parseJsonLine(line, record);
+    return true;
+  }
+  if (!parseCsvRecord(line, record)) {
+    *error = QStringLiteral("Line %1 of %2 does not have the export's CSV columns")
+                 .arg(m_recordLine)
+                 .arg(m_file.fileName());
+    return false;
+  }
+  return true;
+}
+
+void ReplayReader::parseJsonLine(std::string_view line, ReplayRecord *record) {
+  const JsonValue value = m_valuePath->extract(line);
+  if (value.type == JsonValue::Missing) {
+    record->hasKey = false;
+    record->key.clear();
+    record->hasValue = true;
+    record->value.assign(line);
+    return;
+  }
+  assignJson(value, isBase64Marker(m_valueEncodingPath->extract(line)), &record->hasValue,
+             &record->value, &m_scratch);
+  assignJson(m_keyPath->extract(line), isBase64Marker(m_keyEncodingPath->extract(line)),
+             &record->hasKey, &record->key, &m_scratch);
+
+  const JsonValue partition = m_partitionPath->extract(line);
+  if (partition.type == JsonValue::Number && !parseInteger(partition.raw, &record->partition))
+    record->partition = -1;
+  const JsonValue timestamp = m_timestampPath->extract(line);
+  if (timestamp.type == JsonValue::Number && !parseInteger(timestamp.raw, &record->timestamp))
+    record->timestamp = -1;
+  const JsonValue headers = m_headersPath->extract(line);
+  if (headers.type == JsonValue::Array)
+    parseHeaders(headers.raw, record);
+}
+
+bool ReplayReader::parseCsvRecord(std::string_view line, ReplayRecord *record) {
+  const std::size_t count = splitCsv(line, m_fields);
+  if (count < 5)
+    return false;
+  if (!m_fields[0].empty() && !parseInteger(std::string_view(m_fields[0]), &record->partition))
+    return false;
+  if (!m_fields[2].empty() && !parseInteger(std::string_view(m_fields[2]), &record->timestamp))
+    return false;
+  assignCsv(m_fields[3], &record->hasKey, &record->key);
+  assignCsv(m_fields[4], &record->hasValue, &record->value);
+  if (count > 5 && !m_fields[5].empty())
+    parseHeaders(m_fields[5], record);
+  return true;
+}
+
+// Headers are rare and short next to values, so they go through the
+// regular JSON parser instead of one path lookup per member.
+void ReplayReader::parseHeaders(std::string_view json, ReplayRecord *record) {
+  if (json == "[]")
+    return;
+  const QJsonArray array =
+      QJsonDocument::fromJson(QByteArray::fromRawData(json.data(), static_cast<int>(json.size())))
+          .array();
+  for (const QJsonValue &entry : array) {
+    const QJsonObject header = entry.toObject();
+    if (record->headers.size() <= record->headerCount)
+      record->headers.emplace_back();
+    auto &[key, value] = record->headers[record->headerCount++];
+    const QByteArray keyText = header.value(QLatin1String("key")).toString().toUtf8();
+    const QByteArray valueText = header.value(QLatin1String("value")).toString().toUtf8();
+    key.assign(keyText.constData(), static_cast<std::size_t>(keyText.size()));
+    value.assign(valueText.constData(), static_cast<std::size_t>(valueText.size()));
+    if (header.value(QLatin1String("keyEncoding")).toString() == QLatin1String("base64"))
+      decodeBase64(std::string(key), &key);
+    if (header.value(QLatin1String("valueEncoding")).toString() == QLatin1String("base64"))
+      decodeBase64(std::string(value), &value);
+  }
+}
+
+} // namespace kafka
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct ZSTD_DCtx_s;
+
+namespace kafka {
+
+class JsonPath;
+
+/**
+ * @brief One record read back from a file. The reader reuses the strings
+ * from record to record, so reading allocates little once warmed up.
+ */
+struct ReplayRecord {
+  /** The partition the file names, or -1. */
+  qint32 partition = -1;
+  /** The timestamp the file names, or -1. */
+  qint64 timestamp = -1;
+  bool hasKey = false;
+  std::string key;
+  bool hasValue = false;
+  std::string value;
+  /** Header keys and values; only the first headerCount entries are set. */
+  std::vector<std::pair<std::string, std::string>> headers;
+  std::size_t headerCount = 0;
+};
+
+/**
+ * @brief Reads records from a JSON Lines or CSV file, such as the ones
+ * TopicExport writes, for replaying them into a topic.
+ *
+ * Files ending in .csv (or .csv.zst) are read as CSV with the export's
+ * columns: partition, offset, timestamp, key, value, headers. An empty
+ * field is read as null, which is how the export writes nulls, and a
+ * "base64:" prefix marks binary data. Anything else is read as JSON Lines:
+ * an object with a "value" member gives key, value, partition, timestamp
+ * and headers as the export writes them; a string member is taken
+ * unescaped (decoded when its "keyEncoding" / "valueEncoding" is base64)
+ * and any other JSON value as its text. A line that is not such an object
+ * becomes the value of a record without key. Zstandard-compressed files
+ * are recognised by their magic number and inflated on the fly.
+ *
+ * Not thread-safe; one reader per thread.
+ */
+class ReplayReader {
+public:
+  ReplayReader();
+  ~ReplayReader();
+
+  ReplayReader(const ReplayReader &) = delete;
+  ReplayReader &operator=(const ReplayReader &) = delete;
+
+  bool open(const QString &path, QString *error);
+
+  /**
+   * @brief Reads the next record. Returns false at the end of the file,
+   * with @p error left empty, or on a read or decompression error.
+   */
+  bool next(ReplayRecord *record, QString *error);
+
+  /** Size of the file on disk. */
+  qint64 size() const { return m_file.size(); }
+  /** Bytes of the file read so far, before decompression. */
+  qint64 position() const { return m_filePosition; }
+  /** Line of the file the last record started on, counted from 1. */
+  qint64 lineNumber() const { return m_recordLine; }
+
+private:
+  /** Reads and inflates more of the file into m_buffer; false at its end or on error. */
+  bool fill(QString *error);
+  /** The next line, or for CSV the next record, without its line break. */
+  bool nextLine(std::string_view *line, QString *error);
+  void parseJsonLine(std::string_view line, ReplayRecord *record);
+  bool parseCsvRecord(std::string_view line, ReplayRecord *record);
+  void parseHeaders(std::string_view json, ReplayRecord *record);
+
+  QFile m_file;
+  bool m_csv = false;
+  bool m_zstd = false;
+  ZSTD_DCtx_s *m_dctx = nullptr;
+  bool m_frameOpen = false;
+  bool m_eof = false;
+  qint64 m_filePosition = 0;
+  qint64 m_line = 0;
+  qint64 m_recordLine = 0;
+
+  std::string m_input;
+  std::size_t m_inputUsed = 0;
+  std::string m_buffer;
+  std::size_t m_begin = 0;
+  std::vector<std::string> m_fields;
+  std::string m_scratch;
+
+  std::shared_ptr<const JsonPath> m_partitionPath;
+  std::shared_ptr<const JsonPath> m_timestampPath;
+  std::shared_ptr<const JsonPath> m_keyPath;
+  std::shared_ptr<const JsonPath> m_keyEncodingPath;
+  std::shared_ptr<const JsonPath> m_valuePath;
+  std::shared_ptr<const JsonPath> m_valueEncodingPath;
+  std::shared_ptr<const JsonPath> m_headersPath;
+};
+
+} // namespace kafka
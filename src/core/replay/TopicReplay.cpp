@@ -0,0 +1,585 @@
+#include "core/replay/TopicReplay.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "core/codec/Compressor.h"
+#include "core/network/KafkaClient.h"
+#include "core/protocol/ApiKeys.h"
+#include "core/replay/ReplayReader.h"
+#include "core/trace/Trace.h"
+
+namespace kafka {
+
+namespace {
+// Idempotent producers keep ordering with at most this many requests out.
+constexpr int kMaxInFlight = 5;
+// Sealed and unacknowledged batches plus open ones; reading pauses above.
+constexpr qint64 kMaxBufferedBytes = qint64(64) << 20;
+constexpr qint64 kMaxRequestBytes = qint64(8) << 20;
+constexpr int kMinBatchBytes = 1 << 10;
+constexpr int kRecordsPerSlice = 1024;
+constexpr int kMaxAttempts = 5;
+constexpr qint64 kRetryBackoffMs = 100;
+constexpr qint32 kRequestTimeoutMs = 30000;
+// How long past the broker-side timeout an answer is still waited for.
+constexpr qint64 kAnswerGraceMs = 15000;
+constexpr int kPostIntervalMs = 100;
+constexpr int kWaitSliceMs = 5;
+
+// Kafka's murmur2, so keyed records land where the Java client's default
+// partitioner would put them.
+std::uint32_t murmur2(std::string_view data) {
+  constexpr std::uint32_t kSeed = 0x9747b28c;
+  constexpr std::uint32_t kMultiplier = 0x5bd1e995;
+  constexpr int kShift = 24;
+  const auto *bytes = reinterpret_cast<const unsigned char *>(data.data());
+  const std::size_t length = data.size();
+  std::uint32_t hash = kSeed ^ static_cast<std::uint32_t>(length);
+  std::size_t i = 0;
+  for (; i + 4 <= length; i += 4) {
+    std::uint32_t k = static_cast<std::uint32_t>(bytes[i]) |
+                      (static_cast<std::uint32_t>(bytes[i + 1]) << 8) |
+                      (static_cast<std::uint32_t>(bytes[i + 2]) << 16) |
+                      (static_cast<std::uint32_t>(bytes[i + 3]) << 24);
+    k *= kMultiplier;
+    k ^= k >> kShift;
+    k *= kMultiplier;
+    hash *= kMultiplier;
+    hash ^= k;
+  }
+  switch (length - i) {
+  case 3:
+    hash ^= static_cast<std::uint32_t>(bytes[i + 2]) << 16;
+    [[fallthrough]];
+  case 2:
+    hash ^= static_cast<std::uint32_t>(bytes[i + 1]) << 8;
+    [[fallthrough]];
+  case 1:
+    hash ^= bytes[i];
+    hash *= kMultiplier;
+    break;
+  default:
+    break;
+  }
+  hash ^= hash >> 13;
+  hash *= kMultiplier;
+  hash ^= hash >> 15;
+  return hash;
+}
+
+bool isRetriable(qint16 errorCode) {
+  switch (static_cast<ErrorCode>(errorCode)) {
+  case ErrorCode::CorruptMessage:
+  case ErrorCode::UnknownTopicOrPartition:
+  case ErrorCode::LeaderNotAvailable:
+  case ErrorCode::NotLeaderForPartition:
+  case ErrorCode::RequestTimedOut:
+  case ErrorCode::NetworkException:
+  case ErrorCode::NotEnoughReplicas:
+  case ErrorCode::NotEnoughReplicasAfterAppend:
+  // Follows a resent predecessor; resent in turn after it.
+  case ErrorCode::OutOfOrderSequenceNumber:
+    return true;
+  default:
+    return false;
+  }
+}
+
+struct Sealed {
+  qint32 partition = 0;
+  QByteArray bytes;
+  qint32 records = 0;
+  qint32 baseSequence = 0;
+  int attempts = 0;
+  qint64 notBefore = 0;
+};
+
+struct Accumulator {
+  std::unique_ptr<RecordBatchBuilder> open;
+  qint64 openedAt = 0;
+  qint32 nextSequence = 0;
+  // Sealed batches waiting to be sent, in sequence order.
+  std::deque<std::shared_ptr<Sealed>> queued;
+  int inFlight = 0;
+};
+
+// One Produce request: its batches and, once answered, the answers.
+struct Request {
+  quint64 id = 0;
+  qint32 broker = -1;
+  qint64 sentAt = 0;
+  qint64 bytes = 0;
+  std::vector<std::shared_ptr<Sealed>> batches;
+  QVector<ProducedBatch> results;
+};
+} // namespace
+
+// Shared with the client thread only through the mutex-guarded answers;
+// everything else belongs to the worker.
+struct TopicReplay::Run : std::enable_shared_from_this<TopicReplay::Run> {
+  TopicReplay *owner = nullptr;
+  quint64 generation = 0;
+  KafkaClient *client = nullptr;
+  ReplayRequest request;
+
+  std::atomic<bool> stop{false};
+  std::atomic<bool> cancelled{false};
+  std::atomic<qint64> done{0};
+  std::atomic<qint64> total{0};
+  std::atomic<qint64> records{0};
+  std::atomic<qint64> bytesSent{0};
+  std::atomic<qint64> requests{0};
+  std::atomic<qint64> elapsedMs{0};
+
+  // Guards the fields below; ready is signalled whenever one changes.
+  QMutex mutex;
+  QWaitCondition ready;
+  std::vector<std::shared_ptr<Request>> answered;
+  QString error;
+
+  RecordData data;
+  ProducerId producerId;
+  QVector<qint32> partitions;
+  QHash<qint32, qint32> leaders;
+  bool leadersStale = false;
+  std::vector<Accumulator> accumulators;
+  QHash<qint32, int> inFlightPerBroker;
+  std::map<quint64, std::shared_ptr<Request>> outstanding;
+  quint64 nextRequestId = 1;
+  qint64 buffered = 0;
+  int stickyIndex = 0;
+
+  void halt() {
+    stop.store(true);
+    QMutexLocker locker(&mutex);
+    ready.wakeAll();
+  }
+
+  void fail(const QString &message) {
+    {
+      QMutexLocker locker(&mutex);
+      if (error.isEmpty())
+        error = message;
+    }
+    halt();
+  }
+
+  bool prepare(ReplayReader *reader, QString *failure) {
+    ClusterMetadata metadata;
+    if (!client->metadataBlocking(&metadata, failure))
+      return false;
+    const TopicInfo *topic = metadata.topic(request.topic);
+    if (!topic || topic->partitions.isEmpty()) {
+      *failure = QStringLiteral("Topic %1 does not exist").arg(request.topic);
+      return false;
+    }
+    qint32 maxPartition = 0;
+    for (const PartitionInfo &partition : topic->partitions) {
+      partitions.append(partition.partition);
+      leaders.insert(partition.partition, partition.leader);
+      maxPartition = qMax(maxPartition, partition.partition);
+    }
+    std::sort(partitions.begin(), partitions.end());
+    accumulators.resize(static_cast<std::size_t>(maxPartition) + 1);
+
+    if (!client->initProducerIdBlocking(&producerId, failure) ||
+        !reader->open(request.path, failure))
+      return false;
+    total.store(reader->size());
+    return true;
+  }
+
+  void refreshLeaders() {
+    const ClusterMetadata metadata = client->metadata();
+    if (const TopicInfo *topic = metadata.topic(request.topic)) {
+      for (const PartitionInfo &partition : topic->partitions)
+        leaders.insert(partition.partition, partition.leader);
+    }
+    leadersStale = false;
+  }
+
+  qint32 partitionFor(const ReplayRecord &replayed) {
+    if (request.keepPartitions && replayed.partition >= 0 && leaders.contains(replayed.partition))
+      return replayed.partition;
+    if (replayed.hasKey) {
+      const std::uint32_t hash = murmur2(replayed.key) & 0x7fffffffu;
+      return partitions.at(static_cast<int>(hash % static_cast<std::uint32_t>(partitions.size())));
+    }
+    return partitions.at(stickyIndex);
+  }
+
+  bool append(const ReplayRecord &record, qint64 now, qint64 wallClock, QString *failure) {
+    const qint32 partition = partitionFor(record);
+    Accumulator &accumulator = accumulators[static_cast<std::size_t>(partition)];
+    if (!accumulator.open) {
+      accumulator.open = std::make_unique<RecordBatchBuilder>();
+      accumulator.openedAt = now;
+    }
+
+    data.timestamp =
+        request.keepTimestamps && record.timestamp >= 0 ? record.timestamp : wallClock;
+    data.key = record.hasKey ? std::string_view(record.key) : std::string_view();
+    data.value = record.hasValue ? std::string_view(record.value) : std::string_view();
+    data.headers.clear();
+    for (std::size_t i = 0; i < record.headerCount; ++i)
+      data.headers.push_back(RecordHeader{record.headers[i].first, record.headers[i].second});
+
+    const std::size_t before = accumulator.open->estimatedSize();
+    accumulator.open->append(data);
+    buffered += static_cast<qint64>(accumulator.open->estimatedSize() - before);
+    if (accumulator.open->estimatedSize() >= static_cast<std::size_t>(request.batchBytes))
+      return seal(partition, failure);
+    return true;
+  }
+
+  bool seal(qint32 partition, QString *failure) {
+    KAFKA_TRACE_SCOPE("seal batch");
+    Accumulator &accumulator = accumulators[static_cast<std::size_t>(partition)];
+    RecordBatchBuilder &builder = *accumulator.open;
+    builder.setProducer(producerId.id, producerId.epoch, accumulator.nextSequence);
+    std::string bytes = builder.build();
+    buffered -= static_cast<qint64>(builder.estimatedSize());
+
+    auto sealed = std::make_shared<Sealed>();
+    sealed->partition = partition;
+    sealed->records = builder.recordCount();
+    sealed->baseSequence = accumulator.nextSequence;
+    accumulator.nextSequence += builder.recordCount();
+    accumulator.open.reset();
+
+    if (request.compression != Compression::None) {
+      std::string compressed;
+      std::string compressError;
+      if (!Compressor::compressBatch(bytes, request.compression, &compressed, &compressError)) {
+        *failure = QString::fromStdString(compressError);
+        return false;
+      }
+      bytes.swap(compressed);
+    }
+    sealed->bytes = QByteArray(bytes.data(), static_cast<int>(bytes.size()));
+    buffered += sealed->bytes.size();
+    accumulator.queued.push_back(std::move(sealed));
+
+    // Records without key move on once they filled a batch, like the
+    // Java client's sticky partitioner.
+    if (partition == partitions.at(stickyIndex))
+      stickyIndex = (stickyIndex + 1) % partitions.size();
+    return true;
+  }
+
+  bool sealLingered(qint64 now, bool all, QString *failure) {
+    for (qint32 partition : std::as_const(partitions)) {
+      const Accumulator &accumulator = accumulators[static_cast<std::size_t>(partition)];
+      if (accumulator.open && (all || now - accumulator.openedAt >= request.lingerMs) &&
+          !seal(partition, failure))
+        return false;
+    }
+    return true;
+  }
+
+  // Takes the first sealed batch of every partition whose leader has room
+  // for another request, one request per leader, until no leader has room
+  // or nothing is left to send.
+  void sendReady(qint64 now) {
+    if (leadersStale)
+      refreshLeaders();
+    for (;;) {
+      QHash<qint32, std::shared_ptr<Request>> building;
+      for (qint32 partition : std::as_const(partitions)) {
+        Accumulator &accumulator = accumulators[static_cast<std::size_t>(partition)];
+        if (accumulator.queued.empty())
+          continue;
+        const Sealed &front = *accumulator.queued.front();
+        // A resent batch waits until the partition's other batches are
+        // back, so it reaches the broker ahead of its successors.
+        if (front.notBefore > now || (front.attempts > 0 && accumulator.inFlight > 0))
+          continue;
+        const qint32 broker = leaders.value(partition, -1);
+        if (inFlightPerBroker.value(broker) >= request.maxInFlight)
+          continue;
+        std::shared_ptr<Request> &pending = building[broker];
+        if (!pending)
+          pending = std::make_shared<Request>();
+        if (!pending->batches.empty() && pending->bytes + front.bytes.size() > kMaxRequestBytes)
+          continue;
+        pending->bytes += front.bytes.size();
+        pending->batches.push_back(std::move(accumulator.queued.front()));
+        accumulator.queued.pop_front();
+        ++accumulator.inFlight;
+      }
+      if (building.isEmpty())
+        return;
+      for (auto it = building.begin(); it != building.end(); ++it)
+        submit(it.key(), it.value(), now);
+    }
+  }
+
+  void submit(qint32 broker, const std::shared_ptr<Request> &pending, qint64 now) {
+    pending->id = nextRequestId++;
+    pending->broker = broker;
+    pending->sentAt = now;
+    ++inFlightPerBroker[broker];
+    outstanding.emplace(pending->id, pending);
+    ++requests;
+
+    QVector<ProduceBatch> batches;
+    batches.reserve(static_cast<int>(pending->batches.size()));
+    for (const std::shared_ptr<Sealed> &sealed : pending->batches)
+      batches.append(ProduceBatch{TopicPartition{request.topic, sealed->partition}, sealed->bytes});
+    client->produce(batches, kRequestTimeoutMs,
+                    [self = shared_from_this(), pending](const QVector<ProducedBatch> &results) {
+                      QMutexLocker locker(&self->mutex);
+                      pending->results = results;
+                      self->answered.push_back(pending);
+                      self->ready.wakeAll();
+                    });
+  }
+
+  bool handleAnswers(qint64 now, QString *failure) {
+    std::vector<std::shared_ptr<Request>> answers;
+    {
+      QMutexLocker locker(&mutex);
+      answers.swap(answered);
+    }
+    for (const std::shared_ptr<Request> &answer : answers) {
+      outstanding.erase(answer->id);
+      --inFlightPerBroker[answer->broker];
+      for (const std::shared_ptr<Sealed> &sealed : answer->batches) {
+        Accumulator &accumulator = accumulators[static_cast<std::size_t>(sealed->partition)];
+        --accumulator.inFlight;
+        auto errorCode = static_cast<qint16>(ErrorCode::NetworkException);
+        for (const ProducedBatch &result : std::as_const(answer->results)) {
+          if (result.tp.partition == sealed->partition)
+            errorCode = result.errorCode;
+        }
+
+        if (errorCode == static_cast<qint16>(ErrorCode::None) ||
+            errorCode == static_cast<qint16>(ErrorCode::DuplicateSequenceNumber)) {
+          records += sealed->records;
+          bytesSent += sealed->bytes.size();
+          buffered -= sealed->bytes.size();
+          continue;
+        }
+        if (!isRetriable(errorCode) || ++sealed->attempts >= kMaxAttempts) {
+          *failure = QStringLiteral("Partition %1: %2")
+                         .arg(sealed->partition)
+                         .arg(QLatin1String(errorName(errorCode)));
+          return false;
+        }
+        sealed->notBefore = now + kRetryBackoffMs;
+        const auto position = std::lower_bound(
+            accumulator.queued.begin(), accumulator.queued.end(), sealed->baseSequence,
+            [](const std::shared_ptr<Sealed> &queued, qint32 sequence) {
+              return queued->baseSequence < sequence;
+            });
+        accumulator.queued.insert(position, sealed);
+        leadersStale = true;
+      }
+    }
+    return true;
+  }
+
+  bool idle() const {
+    if (!outstanding.empty())
+      return false;
+    return std::all_of(accumulators.begin(), accumulators.end(),
+                       [](const Accumulator &accumulator) {
+                         return !accumulator.open && accumulator.queued.empty();
+                       });
+  }
+
+  bool answerOverdue(qint64 now) const {
+    return !outstanding.empty() &&
+           now - outstanding.begin()->second->sentAt > kRequestTimeoutMs + kAnswerGraceMs;
+  }
+
+  void waitForAnswers() {
+    QMutexLocker locker(&mutex);
+    if (answered.empty() && !stop.load())
+      ready.wait(&mutex, kWaitSliceMs);
+  }
+};
+
+TopicReplay::TopicReplay(QObject *parent) : QObject(parent) {
+  m_pool.setObjectName(QStringLiteral("kafka-replay"));
+  m_pool.setMaxThreadCount(1);
+}
+
+// Stops the worker without cancel(), which would emit finished() to
+// receivers that may already be half destroyed.
+TopicReplay::~TopicReplay() {
+  if (m_run) {
+    m_run->cancelled.store(true);
+    m_run->halt();
+  }
+  m_pool.waitForDone();
+}
+
+void TopicReplay::start(KafkaClient *client, const ReplayRequest &request) {
+  cancel();
+  if (!client || request.path.isEmpty() || request.topic.isEmpty())
+    return;
+
+  auto run = std::make_shared<Run>();
+  run->owner = this;
+  run->generation = ++m_generation;
+  run->client = client;
+  run->request = request;
+  run->request.maxInFlight = qBound(1, request.maxInFlight, kMaxInFlight);
+  run->request.lingerMs = qMax(0, request.lingerMs);
+  run->request.batchBytes = qMax(kMinBatchBytes, request.batchBytes);
+
+  m_run = run;
+  m_running = true;
+  m_cancelled = false;
+  m_records = 0;
+  m_bytesSent = 0;
+  m_requests = 0;
+  m_elapsedMs = 0;
+  m_error.clear();
+  emit progressChanged(0, 0);
+
+  m_pool.start([run]() { produce(run); });
+}
+
+void TopicReplay::cancel() {
+  if (!m_run)
+    return;
+  m_run->cancelled.store(true);
+  m_run->halt();
+  // Bumping the generation drops whatever the old run still posts.
+  ++m_generation;
+  const std::shared_ptr<Run> run = std::move(m_run);
+  if (m_running) {
+    m_running = false;
+    m_cancelled = true;
+    emit finished();
+  }
+}
+
+// Runs on the pool for the whole replay. Reading only pauses while the
+// buffered batches are at their limit; otherwise answers, lingering
+// batches and free request slots are handled between slices of records.
+void TopicReplay::produce(const std::shared_ptr<Run> &run) {
+  KAFKA_TRACE_SCOPE("replay worker");
+  QElapsedTimer clock;
+  clock.start();
+  QElapsedTimer sincePost;
+  sincePost.start();
+
+  // The reader holds a QFile, so it stays on this thread rather than in
+  // the run a late answer may release on the client thread.
+  ReplayReader reader;
+  ReplayRecord record;
+  QString failure;
+  bool inputDone = false;
+  bool ok = run->prepare(&reader, &failure);
+  while (ok && !run->stop.load()) {
+    qint64 now = clock.elapsed();
+    ok = run->handleAnswers(now, &failure);
+    if (!ok)
+      break;
+
+    if (!inputDone && run->buffered < kMaxBufferedBytes) {
+      const qint64 wallClock = QDateTime::currentMSecsSinceEpoch();
+      for (int i = 0; i < kRecordsPerSlice && run->buffered < kMaxBufferedBytes; ++i) {
+        if (!reader.next(&record, &failure)) {
+          ok = failure.isEmpty();
+          inputDone = true;
+          break;
+        }
+        ok = run->append(record, now, wallClock, &failure);
+        if (!ok)
+          break;
+      }
+      if (!ok)
+        break;
+      run->done.store(reader.position());
+    }
+
+    now = clock.elapsed();
+    ok = run->sealLingered(now, inputDone, &failure);
+    if (!ok)
+      break;
+    run->sendReady(now);
+    if (inputDone && run->idle())
+      break;
+    if (run->answerOverdue(now)) {
+      failure = QStringLiteral("No answer to a Produce request within %1 s")
+                    .arg((kRequestTimeoutMs + kAnswerGraceMs) / 1000);
+      ok = false;
+      break;
+    }
+    if (inputDone || run->buffered >= kMaxBufferedBytes)
+      run->waitForAnswers();
+
+    KAFKA_TRACE_COUNTER("replay buffered bytes", run->buffered);
+    if (sincePost.elapsed() >= kPostIntervalMs) {
+      run->elapsedMs.store(clock.elapsed());
+      run->owner->post(run);
+      sincePost.restart();
+    }
+  }
+
+  if (!ok)
+    run->fail(failure);
+  run->elapsedMs.store(clock.elapsed());
+  run->owner->finish(run);
+}
+
+// Called from the worker; everything touching the object happens in the
+// queued call. The destructor drains the pool, so the owner outlives the
+// worker, and Qt drops the call if the owner is gone before it runs.
+void TopicReplay::post(const std::shared_ptr<Run> &run) {
+  QMetaObject::invokeMethod(
+      this,
+      [this, run]() {
+        if (run->generation != m_generation)
+          return;
+        m_records = run->records.load();
+        m_bytesSent = run->bytesSent.load();
+        m_requests = run->requests.load();
+        m_elapsedMs = run->elapsedMs.load();
+        emit progressChanged(run->done.load(), run->total.load());
+      },
+      Qt::QueuedConnection);
+}
+
+void TopicReplay::finish(const std::shared_ptr<Run> &run) {
+  QMetaObject::invokeMethod(
+      this,
+      [this, run]() {
+        if (run->generation != m_generation)
+          return;
+        m_run.reset();
+        m_running = false;
+        m_cancelled = run->cancelled.load();
+        m_records = run->records.load();
+        m_bytesSent = run->bytesSent.load();
+        m_requests = run->requests.load();
+        m_elapsedMs = run->elapsedMs.load();
+        {
+          QMutexLocker locker(&run->mutex);
+          m_error = run->error;
+        }
+        emit progressChanged(run->done.load(), run->total.load());
+        emit finished();
+      },
+      Qt::QueuedConnection);
+}
+
+} // namespace kafka
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+#include <memory>
+
+#include "core/protocol/RecordBatch.h"
+
+namespace kafka {
+
+class KafkaClient;
+
+/**
+ * @brief What a TopicReplay publishes and how it batches it.
+ */
+struct ReplayRequest {
+  /** A JSON Lines or CSV file; see ReplayReader. */
+  QString path;
+  QString topic;
+  /**
+   * Sends each record to the partition the file names when the topic has
+   * it. Other records go by key hash, as the Java client places them, and
+   * records without key fill one partition's batch at a time.
+   */
+  bool keepPartitions = true;
+  /** Keeps the file's timestamps; otherwise records are stamped when read. */
+  bool keepTimestamps = true;
+  Compression compression = Compression::Lz4;
+  /** How long a partition's batch may wait for more records before it is sent. */
+  int lingerMs = 5;
+  /** Uncompressed size at which a batch is sent without waiting. */
+  int batchBytes = 256 << 10;
+  /** Produce requests outstanding per broker; at most 5 keep ordering. */
+  int maxInFlight = 5;
+};
+
+/**
+ * @brief Publishes the records of a file to a topic as an idempotent
+ * producer.
+ *
+ * One worker reads the file and appends each record to an open batch of
+ * its partition. A batch is sealed once it reaches batchBytes or has been
+ * open for lingerMs, gets the partition's next sequence number, and is
+ * compressed. Sealed batches go out one per partition per Produce request,
+ * a request per leader, with up to maxInFlight requests outstanding per
+ * broker; the worker keeps reading while they are on the wire. Sealed and
+ * unacknowledged batches are bounded in total size, so a slow cluster
+ * slows the reading down instead of filling memory.
+ *
+ * Retriable errors resend the batch with its original sequence number
+ * after a short backoff; the broker's sequence checks drop a copy that
+ * already landed. Other errors stop the replay. Records acknowledged
+ * before a stop stay in the topic.
+ */
+class TopicReplay final : public QObject {
+  Q_OBJECT
+
+public:
+  explicit TopicReplay(QObject *parent = nullptr);
+  ~TopicReplay() override;
+
+  /** @p client must outlive the replay. */
+  void start(KafkaClient *client, const ReplayRequest &request);
+  void cancel();
+
+  bool isRunning() const { return m_running; }
+  /** Valid after finished(). */
+  bool wasCancelled() const { return m_cancelled; }
+  QString errorString() const { return m_error; }
+  /** Records the brokers acknowledged. */
+  qint64 recordCount() const { return m_records; }
+  /** Batch bytes acknowledged, after compression. */
+  qint64 bytesSent() const { return m_bytesSent; }
+  qint64 requestCount() const { return m_requests; }
+  qint64 elapsedMs() const { return m_elapsedMs; }
+
+signals:
+  /** Bytes of the file read so far out of @p total. */
+  void progressChanged(qint64 done, qint64 total);
+  void finished();
+
+private:
+  struct Run;
+
+  static void produce(const std::shared_ptr<Run> &run);
+  void post(const std::shared_ptr<Run> &run);
+  void finish(const std::shared_ptr<Run> &run);
+
+  QThreadPool m_pool;
+  std::shared_ptr<Run> m_run;
+  quint64 m_generation = 0;
+  bool m_running = false;
+  bool m_cancelled = false;
+  qint64 m_records = 0;
+  qint64 m_bytesSent = 0;
+  qint64 m_requests = 0;
+  qint64 m_elapsedMs = 0;
+  QString m_error;
+};
+
+} // namespace kafka
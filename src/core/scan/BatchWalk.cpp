@@ -0,0 +1,80 @@
+#include "core/scan/BatchWalk.h"
+
+#include <algorithm>
+#include <string>
+
+#include "core/codec/BatchDecoder.h"
+
+namespace kafka {
+
+namespace {
+constexpr qint32 kReadBytes = 1 << 20;
+} // namespace
+
+QByteArray copyOf(std::string_view bytes, std::size_t maxBytes) {
+  if (!bytes.data())
+    return QByteArray();
+  return QByteArray(bytes.data(), static_cast<int>(std::min(bytes.size(), maxBytes)));
+}
+
+bool recordsOf(const RecordBatch &batch, std::shared_ptr<const DecodedBatch> *decoded,
+               std::string_view *section) {
+  if (batch.compression() == Compression::None) {
+    *section = batch.recordsSection();
+    return true;
+  }
+  std::string error;
+  *decoded = BatchDecoder::decodeOne(batch, &error);
+  if (!*decoded)
+    return false;
+  *section = (*decoded)->records;
+  return true;
+}
+
+BatchWalk::BatchWalk(BatchSource &source, qint32 partition, qint64 start, qint64 end)
+    : m_source(source), m_partition(partition), m_end(end), m_chunkStart(start),
+      m_position(start) {}
+
+bool BatchWalk::nextChunk(QString *error) {
+  m_batches = BatchReader(std::string_view());
+  if (m_position >= m_end || m_failed)
+    return false;
+  m_chunk = BatchChunk();
+  if (!m_source.read(m_partition, m_position, kReadBytes, &m_chunk, error)) {
+    m_failed = true;
+    return false;
+  }
+
+  // Only the headers are looked at here, to learn how far the chunk goes.
+  qint64 reach = m_position;
+  BatchReader batches(m_chunk.bytes);
+  RecordBatch batch;
+  while (batches.next(batch) == ParseStatus::Ok) {
+    if (batch.nextOffset() <= m_position)
+      continue;
+    if (batch.baseOffset() >= m_end)
+      break;
+    reach = std::max(reach, std::min(batch.nextOffset(), m_end));
+  }
+  // A read that did not move past any batch means the log ends here.
+  if (reach == m_position)
+    return false;
+
+  m_chunkStart = m_position;
+  m_position = reach;
+  m_batches = BatchReader(m_chunk.bytes);
+  return true;
+}
+
+bool BatchWalk::nextBatch(RecordBatch &batch) {
+  while (m_batches.next(batch) == ParseStatus::Ok) {
+    if (batch.nextOffset() <= m_chunkStart)
+      continue;
+    if (batch.baseOffset() >= m_end)
+      return false;
+    return true;
+  }
+  return false;
+}
+
+} // namespace kafka
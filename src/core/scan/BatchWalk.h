@@ -0,0 +1,95 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include <memory>
+#include <string_view>
+
+#include "core/protocol/RecordBatch.h"
+#include "core/source/BatchSource.h"
+
+namespace kafka {
+
+struct DecodedBatch;
+
+/**
+ * @brief Copies up to @p maxBytes of a key or value out of its batch. A
+ * null view (a null key or value) gives a null QByteArray.
+ */
+QByteArray copyOf(std::string_view bytes, std::size_t maxBytes);
+
+/**
+ * @brief Points @p section at the records of @p batch, inflating them into
+ * @p decoded when the batch is compressed. Returns false when they cannot
+ * be inflated.
+ *
+ * This goes around the shared BatchDecoder on purpose: a pass over a whole
+ * range would only flush the browser's working set out of its cache, so
+ * the inflated copy lives only as long as @p decoded.
+ */
+bool recordsOf(const RecordBatch &batch, std::shared_ptr<const DecodedBatch> *decoded,
+               std::string_view *section);
+
+/**
+ * @brief Reads the offsets [start, end) of one partition in order, chunk
+ * by chunk, and hands out the batches and records of each chunk that fall
+ * in that range.
+ *
+ * A chunk may begin with a batch the previous chunk already covered and
+ * may reach past @c end; both are skipped here. The walk is over at
+ * @c end, when a read fails, or when a chunk does not reach past the
+ * offset it was read from, which means the log ends there.
+ */
+class BatchWalk {
+public:
+  BatchWalk(BatchSource &source, qint32 partition, qint64 start, qint64 end);
+
+  /**
+   * @brief Reads the chunk at position(). Returns false once the walk is
+   * over; failed() tells whether a read failed, with @p error set.
+   */
+  bool nextChunk(QString *error);
+  bool failed() const { return m_failed; }
+
+  const BatchChunk &chunk() const { return m_chunk; }
+  /** The current chunk covers [chunkStart(), position()). */
+  qint64 chunkStart() const { return m_chunkStart; }
+  qint64 position() const { return m_position; }
+
+  /** The next batch of the current chunk that overlaps the range. */
+  bool nextBatch(RecordBatch &batch);
+
+  /**
+   * @brief Calls @p onRecord with each record of @p batch, read from
+   * @p section, that falls in the current chunk's part of the range, until
+   * it returns false. Returns false if it did.
+   */
+  template <typename OnRecord>
+  bool forEachRecord(const RecordBatch &batch, std::string_view section,
+                     OnRecord &&onRecord) const {
+    RecordReader records(batch, section);
+    Record record;
+    while (records.next(record)) {
+      if (record.offset < m_chunkStart)
+        continue;
+      if (record.offset >= m_end)
+        break;
+      if (!onRecord(record))
+        return false;
+    }
+    return true;
+  }
+
+private:
+  BatchSource &m_source;
+  qint32 m_partition;
+  qint64 m_end;
+  qint64 m_chunkStart;
+  qint64 m_position;
+  bool m_failed = false;
+  BatchChunk m_chunk;
+  BatchReader m_batches{std::string_view()};
+};
+
+} // namespace kafka
@@ -0,0 +1,276 @@
+#include "core/scan/SliceScan.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "core/codec/DecodedBatchCache.h"
+#include "core/protocol/RecordBatch.h"
+#include "core/scan/BatchWalk.h"
+#include "core/source/BatchSource.h"
+#include "core/trace/Trace.h"
+
+namespace kafka {
+
+namespace {
+constexpr qint64 kMinSliceOffsets = 1 << 14;
+// Slices per worker, so a worker that finishes early can take over work.
+constexpr int kSlicesPerWorker = 4;
+constexpr int kPostIntervalMs = 100;
+
+struct Slice {
+  int target = 0;
+  qint32 partition = 0;
+  qint64 start = 0;
+  qint64 end = 0;
+};
+
+QString partitionName(const SliceScan::Target &target, qint32 partition) {
+  if (target.topic.isEmpty())
+    return QStringLiteral("Partition %1").arg(partition);
+  return QStringLiteral("%1/%2").arg(target.topic).arg(partition);
+}
+} // namespace
+
+struct SliceScan::Run {
+  SliceScan *owner = nullptr;
+  quint64 generation = 0;
+  Request request;
+  WorkerFactory createWorker;
+
+  std::vector<Slice> slices;
+  std::atomic<std::size_t> nextSlice{0};
+  std::atomic<int> activeWorkers{0};
+  std::atomic<bool> stop{false};
+  std::atomic<bool> cancelled{false};
+  std::atomic<bool> stoppedByWorker{false};
+  std::atomic<qint64> scanned{0};
+  std::atomic<qint64> skippedBatches{0};
+  qint64 total = 0;
+
+  QMutex errorMutex;
+  QString error;
+
+  void fail(const QString &message) {
+    {
+      QMutexLocker locker(&errorMutex);
+      if (error.isEmpty())
+        error = message;
+    }
+    stop.store(true);
+  }
+};
+
+SliceScan::SliceScan(QObject *context, const QString &poolName, const char *traceName,
+                     std::function<void(qint64, qint64)> progress,
+                     std::function<void()> finished)
+    : m_context(context), m_traceName(traceName), m_progress(std::move(progress)),
+      m_finished(std::move(finished)) {
+  m_pool.setObjectName(poolName);
+  // One extra thread for the planning task that starts the workers.
+  m_pool.setMaxThreadCount(kMaxWorkers + 1);
+}
+
+// Stops the workers without cancel(), which would report the end to
+// receivers that may already be half destroyed.
+SliceScan::~SliceScan() {
+  if (m_run) {
+    m_run->cancelled.store(true);
+    m_run->stop.store(true);
+  }
+  m_pool.waitForDone();
+}
+
+void SliceScan::start(Request request, WorkerFactory createWorker) {
+  cancel();
+
+  auto run = std::make_shared<Run>();
+  run->owner = this;
+  run->generation = ++m_generation;
+  run->request = std::move(request);
+  run->createWorker = std::move(createWorker);
+
+  m_run = run;
+  m_running = true;
+  m_cancelled = false;
+  m_stoppedByWorker = false;
+  m_skippedBatches = 0;
+  m_error.clear();
+  m_progress(0, 0);
+
+  m_pool.start([run]() { plan(run); });
+}
+
+void SliceScan::cancel() {
+  if (!m_run)
+    return;
+  m_run->cancelled.store(true);
+  m_run->stop.store(true);
+  // Bumping the generation drops whatever the old run still posts.
+  ++m_generation;
+  const std::shared_ptr<Run> run = std::move(m_run);
+  if (m_running) {
+    m_running = false;
+    m_cancelled = true;
+    m_skippedBatches = run->skippedBatches.load();
+    m_finished();
+  }
+}
+
+// Runs on the pool: resolves every target's partition ranges within the
+// time bounds, which may block on the network, then cuts them into slices
+// and starts the workers.
+void SliceScan::plan(const std::shared_ptr<Run> &run) {
+  const Request &request = run->request;
+  std::vector<Slice> ranges;
+  for (int target = 0; target < request.targets.size(); ++target) {
+    const Target &entry = request.targets[target];
+    QVector<OffsetRange> bounds;
+    for (qint32 partition : entry.partitions) {
+      OffsetRange range;
+      QString error;
+      if (!entry.source->offsetRange(partition, &range, &error)) {
+        run->fail(QStringLiteral("%1: %2").arg(partitionName(entry, partition), error));
+        run->owner->finish(run);
+        return;
+      }
+      bounds.append(range);
+    }
+
+    for (const bool isStart : {true, false}) {
+      const qint64 bound = isStart ? request.from : request.to;
+      if (bound < 0)
+        continue;
+      QVector<qint64> offsets;
+      QString error;
+      if (!entry.source->offsetsForTimestamp(entry.partitions, bound, &offsets, &error)) {
+        run->fail(entry.topic.isEmpty() ? error
+                                        : QStringLiteral("%1: %2").arg(entry.topic, error));
+        run->owner->finish(run);
+        return;
+      }
+      for (int i = 0; i < bounds.size(); ++i) {
+        const qint64 offset = qBound(bounds[i].start, offsets[i], bounds[i].end);
+        if (isStart)
+          bounds[i].start = offset;
+        else
+          bounds[i].end = std::max(bounds[i].start, offset);
+      }
+    }
+
+    for (int i = 0; i < bounds.size(); ++i) {
+      run->total += bounds[i].size();
+      ranges.push_back({target, entry.partitions[i], bounds[i].start, bounds[i].end});
+    }
+  }
+
+  const int workers = qBound(1, QThread::idealThreadCount(), kMaxWorkers);
+  const qint64 sliceSize =
+      std::max(kMinSliceOffsets, run->total / (qint64(workers) * kSlicesPerWorker));
+  for (const Slice &range : ranges) {
+    for (qint64 start = range.start; start < range.end; start += sliceSize)
+      run->slices.push_back(
+          {range.target, range.partition, start, std::min(start + sliceSize, range.end)});
+  }
+
+  const int started = std::max(1, std::min(workers, static_cast<int>(run->slices.size())));
+  run->activeWorkers.store(started);
+  for (int i = 0; i < started; ++i)
+    run->owner->m_pool.start([run]() { work(run); });
+}
+
+void SliceScan::work(const std::shared_ptr<Run> &run) {
+  KAFKA_TRACE_SCOPE(run->owner->m_traceName);
+  const std::unique_ptr<Worker> worker = run->createWorker();
+  QElapsedTimer sincePost;
+  sincePost.start();
+
+  for (std::size_t index = run->nextSlice.fetch_add(1);
+       index < run->slices.size() && !run->stop.load(); index = run->nextSlice.fetch_add(1)) {
+    const Slice &slice = run->slices[index];
+    const Target &target = run->request.targets[slice.target];
+    BatchWalk walk(*target.source, slice.partition, slice.start, slice.end);
+    QString error;
+    while (!run->stop.load() && walk.nextChunk(&error)) {
+      RecordBatch batch;
+      while (!run->stop.load() && walk.nextBatch(batch)) {
+        if (batch.isControl() || !worker->wantsBatch(batch))
+          continue;
+        std::shared_ptr<const DecodedBatch> decoded;
+        std::string_view section;
+        if (!recordsOf(batch, &decoded, &section)) {
+          ++run->skippedBatches;
+          continue;
+        }
+        const bool more = walk.forEachRecord(batch, section, [&](const Record &record) {
+          return worker->add(slice.target, slice.partition, record);
+        });
+        if (!more) {
+          run->stoppedByWorker.store(true);
+          run->stop.store(true);
+        }
+      }
+      run->scanned += walk.position() - walk.chunkStart();
+
+      std::function<void()> delivery = worker->take();
+      if (delivery || sincePost.elapsed() >= kPostIntervalMs) {
+        run->owner->post(run, std::move(delivery));
+        sincePost.restart();
+      }
+    }
+    if (walk.failed())
+      run->fail(QStringLiteral("%1: %2").arg(partitionName(target, slice.partition), error));
+  }
+
+  run->owner->post(run, worker->take());
+  if (!run->cancelled.load())
+    worker->done();
+  if (run->activeWorkers.fetch_sub(1) == 1)
+    run->owner->finish(run);
+}
+
+// Called from workers; everything touching the object happens in the
+// queued call. The context owns the scan, whose destructor drains the pool,
+// so both outlive every worker, and Qt drops the call if the context is
+// gone before it runs.
+void SliceScan::post(const std::shared_ptr<Run> &run, std::function<void()> delivery) {
+  QMetaObject::invokeMethod(
+      m_context,
+      [this, run, delivery = std::move(delivery)]() {
+        if (run->generation != m_generation)
+          return;
+        if (delivery)
+          delivery();
+        m_progress(run->scanned.load(), run->total);
+      },
+      Qt::QueuedConnection);
+}
+
+void SliceScan::finish(const std::shared_ptr<Run> &run) {
+  QMetaObject::invokeMethod(
+      m_context,
+      [this, run]() {
+        if (run->generation != m_generation)
+          return;
+        m_run.reset();
+        m_running = false;
+        m_cancelled = run->cancelled.load();
+        m_stoppedByWorker = run->stoppedByWorker.load();
+        m_skippedBatches = run->skippedBatches.load();
+        {
+          QMutexLocker locker(&run->errorMutex);
+          m_error = run->error;
+        }
+        m_progress(run->scanned.load(), run->total);
+        m_finished();
+      },
+      Qt::QueuedConnection);
+}
+
+} // namespace kafka
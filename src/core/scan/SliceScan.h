@@ -0,0 +1,139 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+#include <functional>
+#include <memory>
+
+namespace kafka {
+
+class BatchSource;
+class RecordBatch;
+struct Record;
+
+/**
+ * @brief Reads offset ranges of one or more topics on worker threads and
+ * hands every record to a callback of the worker that read it.
+ *
+ * The engine behind TopicSearch, TopicFilter, TopicStats and
+ * CorrelationScan. Each partition's range is cut into slices that workers
+ * pull from a shared counter, so all partitions are read in parallel and a
+ * single large partition still spreads across every worker. Compressed
+ * batches are inflated with recordsOf() and dropped after use.
+ *
+ * What happens to the records is up to the Worker each thread creates: it
+ * collects them without locks, take() hands what it has to the context
+ * thread while the scan runs, and done() merges what it kept once it runs
+ * out of slices. Progress and the end of the scan reach the context thread
+ * through the callbacks given to the constructor. A scan that was
+ * cancelled or replaced delivers nothing more.
+ */
+class SliceScan {
+public:
+  static constexpr int kMaxWorkers = 8;
+
+  /**
+   * @brief Partitions of one topic to scan. @c topic names them in errors;
+   * a scan of a single topic leaves it empty.
+   */
+  struct Target {
+    QString topic;
+    std::shared_ptr<BatchSource> source;
+    QVector<qint32> partitions;
+  };
+
+  /**
+   * @brief What to scan. @c from and @c to bound every partition by
+   * timestamp in ms since the epoch; -1 stands for its start or end.
+   */
+  struct Request {
+    QVector<Target> targets;
+    qint64 from = -1;
+    qint64 to = -1;
+  };
+
+  /** What one worker thread does with the records it reads. */
+  class Worker {
+  public:
+    virtual ~Worker() = default;
+
+    /**
+     * @brief Whether @p batch may hold records of interest; other batches
+     * are not inflated. Control batches never get here.
+     */
+    virtual bool wantsBatch(const RecordBatch &) { return true; }
+    /**
+     * @brief Takes one record of @p partition of target @p target. Returns
+     * false to end the whole scan, as at a result limit.
+     */
+    virtual bool add(int target, qint32 partition, const Record &record) = 0;
+    /**
+     * @brief Hands over what was collected since the last call, as a call
+     * to make on the context thread; null when there is nothing new.
+     * Called after every chunk and once more when the worker is done.
+     */
+    virtual std::function<void()> take() { return nullptr; }
+    /**
+     * @brief Called on the worker thread once it ran out of slices, unless
+     * the scan was cancelled; the place to merge per-worker results.
+     */
+    virtual void done() {}
+  };
+
+  using WorkerFactory = std::function<std::unique_ptr<Worker>()>;
+
+  /**
+   * @brief @p context is the object owning this scan; @p progress and
+   * @p finished run on its thread. @p traceName is a string literal.
+   */
+  SliceScan(QObject *context, const QString &poolName, const char *traceName,
+            std::function<void(qint64 scanned, qint64 total)> progress,
+            std::function<void()> finished);
+  ~SliceScan();
+
+  SliceScan(const SliceScan &) = delete;
+  SliceScan &operator=(const SliceScan &) = delete;
+
+  /**
+   * @brief Cancels the running scan and starts one over @p request; every
+   * worker thread gets its Worker from @p createWorker.
+   */
+  void start(Request request, WorkerFactory createWorker);
+  /** Stops the running scan and reports it finished at once. */
+  void cancel();
+
+  bool isRunning() const { return m_running; }
+  /** Valid after finished. */
+  bool wasCancelled() const { return m_cancelled; }
+  /** A Worker ended the scan early. */
+  bool stoppedByWorker() const { return m_stoppedByWorker; }
+  QString errorString() const { return m_error; }
+  /** Compressed batches that could not be inflated and were skipped. */
+  qint64 skippedBatches() const { return m_skippedBatches; }
+
+private:
+  struct Run;
+
+  static void plan(const std::shared_ptr<Run> &run);
+  static void work(const std::shared_ptr<Run> &run);
+  void post(const std::shared_ptr<Run> &run, std::function<void()> delivery);
+  void finish(const std::shared_ptr<Run> &run);
+
+  QObject *m_context;
+  const char *m_traceName;
+  std::function<void(qint64, qint64)> m_progress;
+  std::function<void()> m_finished;
+  QThreadPool m_pool;
+  std::shared_ptr<Run> m_run;
+  quint64 m_generation = 0;
+  bool m_running = false;
+  bool m_cancelled = false;
+  bool m_stoppedByWorker = false;
+  qint64 m_skippedBatches = 0;
+  QString m_error;
+};
+
+} // namespace kafka
@@ -0,0 +1,364 @@
+#include "core/schema/AvroDecoder.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <cstring>
+#include <limits>
+
+namespace kafka {
+
+namespace {
+// Deeper values are almost certainly a corrupt payload looping through a
+// recursive schema; stop before the stack does.
+constexpr int kMaxDepth = 128;
+constexpr quint64 kMaxNullItems = 1 << 16;
+
+QString fullName(const QString &name, const QString &enclosingNamespace) {
+  if (name.contains(QLatin1Char('.')) || enclosingNamespace.isEmpty())
+    return name;
+  return enclosingNamespace + QLatin1Char('.') + name;
+}
+
+QString namespaceOf(const QString &fullName) {
+  const int dot = fullName.lastIndexOf(QLatin1Char('.'));
+  return dot < 0 ? QString() : fullName.left(dot);
+}
+} // namespace
+
+class AvroDecoder::Reader {
+public:
+  explicit Reader(std::string_view bytes) : m_p(bytes.data()), m_end(bytes.data() + bytes.size()) {}
+
+  bool readLong(qint64 *value) {
+    quint64 result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (m_p == m_end)
+        return fail("truncated");
+      const auto byte = static_cast<unsigned char>(*m_p++);
+      result |= quint64(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        *value = static_cast<qint64>(result >> 1) ^ -static_cast<qint64>(result & 1);
+        return true;
+      }
+    }
+    return fail("varint too long");
+  }
+
+  bool readBytes(std::size_t size, std::string_view *bytes) {
+    if (static_cast<std::size_t>(m_end - m_p) < size)
+      return fail("truncated");
+    *bytes = std::string_view(m_p, size);
+    m_p += size;
+    return true;
+  }
+
+  bool readSized(std::string_view *bytes) {
+    qint64 size = 0;
+    if (!readLong(&size))
+      return false;
+    if (size < 0)
+      return fail("negative length");
+    return readBytes(static_cast<std::size_t>(size), bytes);
+  }
+
+  bool fail(const char *reason) {
+    if (!m_reason)
+      m_reason = reason;
+    return false;
+  }
+
+  std::size_t remaining() const { return static_cast<std::size_t>(m_end - m_p); }
+  const char *reason() const { return m_reason ? m_reason : "invalid value"; }
+
+private:
+  const char *m_p;
+  const char *m_end;
+  const char *m_reason = nullptr;
+};
+
+std::shared_ptr<const AvroDecoder> AvroDecoder::compile(const QByteArray &schema, QString *error) {
+  QJsonParseError parseError;
+  const QJsonDocument document = QJsonDocument::fromJson(schema, &parseError);
+  QJsonValue root;
+  if (parseError.error == QJsonParseError::NoError) {
+    root = document.isArray() ? QJsonValue(document.array()) : QJsonValue(document.object());
+  } else {
+    // A bare primitive such as "string" is a schema too, but not a JSON
+    // document to QJsonDocument.
+    const QByteArray trimmed = schema.trimmed();
+    if (trimmed.size() < 2 || !trimmed.startsWith('"') || !trimmed.endsWith('"')) {
+      if (error)
+        *error = QStringLiteral("Invalid schema JSON: %1").arg(parseError.errorString());
+      return nullptr;
+    }
+    root = QString::fromUtf8(trimmed.mid(1, trimmed.size() - 2));
+  }
+
+  std::shared_ptr<AvroDecoder> decoder(new AvroDecoder());
+  QHash<QString, int> named;
+  decoder->m_root = decoder->compileNode(root, QString(), &named, error);
+  if (decoder->m_root < 0)
+    return nullptr;
+  if (root.isObject() && root.toObject().value(QStringLiteral("type")).toString() ==
+                             QLatin1String("record")) {
+    for (const QJsonValue &field : root.toObject().value(QStringLiteral("fields")).toArray())
+      decoder->m_fieldNames.append(field.toObject().value(QStringLiteral("name")).toString());
+  }
+  return decoder;
+}
+
+int AvroDecoder::compileNode(const QJsonValue &schema, const QString &enclosingNamespace,
+                             QHash<QString, int> *named, QString *error) {
+  auto fail = [error](const QString &message) {
+    if (error)
+      *error = message;
+    return -1;
+  };
+  auto add = [this](Node::Kind kind) {
+    Node node;
+    node.kind = kind;
+    m_nodes.push_back(std::move(node));
+    return static_cast<int>(m_nodes.size() - 1);
+  };
+
+  if (schema.isArray()) {
+    const int index = add(Node::Union);
+    for (const QJsonValue &branch : schema.toArray()) {
+      const int child = compileNode(branch, enclosingNamespace, named, error);
+      if (child < 0)
+        return -1;
+      m_nodes[static_cast<std::size_t>(index)].children.push_back(child);
+    }
+    return index;
+  }
+
+  const QJsonObject object = schema.toObject();
+  const QString type =
+      schema.isString() ? schema.toString() : object.value(QStringLiteral("type")).toString();
+  if (schema.isObject() && object.value(QStringLiteral("type")).isObject())
+    return compileNode(object.value(QStringLiteral("type")), enclosingNamespace, named, error);
+  if (schema.isObject() && object.value(QStringLiteral("type")).isArray())
+    return compileNode(object.value(QStringLiteral("type")), enclosingNamespace, named, error);
+
+  static const QHash<QString, Node::Kind> primitives = {
+      {QStringLiteral("null"), Node::Null},     {QStringLiteral("boolean"), Node::Boolean},
+      {QStringLiteral("int"), Node::Int},       {QStringLiteral("long"), Node::Long},
+      {QStringLiteral("float"), Node::Float},   {QStringLiteral("double"), Node::Double},
+      {QStringLiteral("bytes"), Node::Bytes},   {QStringLiteral("string"), Node::String},
+  };
+  const auto primitive = primitives.constFind(type);
+  if (primitive != primitives.cend())
+    return add(primitive.value());
+
+  // A type name, bare or as {"type": "com.example.Name"}.
+  if (schema.isString() || !(type == QLatin1String("record") || type == QLatin1String("error") ||
+                             type == QLatin1String("enum") || type == QLatin1String("fixed") ||
+                             type == QLatin1String("array") || type == QLatin1String("map"))) {
+    const int reference = named->value(fullName(type, enclosingNamespace),
+                                       named->value(type, -1));
+    return reference >= 0 ? reference : fail(QStringLiteral("Unknown type \"%1\"").arg(type));
+  }
+
+  const bool isNamed = type == QLatin1String("record") || type == QLatin1String("error") ||
+                       type == QLatin1String("enum") || type == QLatin1String("fixed");
+  QString name;
+  QString scope = enclosingNamespace;
+  if (isNamed) {
+    const QString explicitNamespace = object.value(QStringLiteral("namespace")).toString();
+    name = fullName(object.value(QStringLiteral("name")).toString(),
+                    explicitNamespace.isEmpty() ? enclosingNamespace : explicitNamespace);
+    if (name.isEmpty())
+      return fail(QStringLiteral("A %1 needs a name").arg(type));
+    scope = namespaceOf(name);
+  }
+
+  if (type == QLatin1String("record") || type == QLatin1String("error")) {
+    // Registered before the fields so they can refer to the record itself.
+    const int index = add(Node::Record);
+    named->insert(name, index);
+    for (const QJsonValue &fieldValue : object.value(QStringLiteral("fields")).toArray()) {
+      const QJsonObject field = fieldValue.toObject();
+      const int child = compileNode(field.value(QStringLiteral("type")), scope, named, error);
+      if (child < 0)
+        return -1;
+      std::string label;
+      appendJsonString(&label, field.value(QStringLiteral("name")).toString().toStdString());
+      label.push_back(':');
+      Node &node = m_nodes[static_cast<std::size_t>(index)];
+      node.children.push_back(child);
+      node.labels.push_back(std::move(label));
+    }
+    return index;
+  }
+  if (type == QLatin1String("enum")) {
+    const int index = add(Node::Enum);
+    named->insert(name, index);
+    for (const QJsonValue &symbol : object.value(QStringLiteral("symbols")).toArray()) {
+      std::string label;
+      appendJsonString(&label, symbol.toString().toStdString());
+      m_nodes[static_cast<std::size_t>(index)].labels.push_back(std::move(label));
+    }
+    return index;
+  }
+  if (type == QLatin1String("fixed")) {
+    const int size = object.value(QStringLiteral("size")).toInt(-1);
+    if (size < 0)
+      return fail(QStringLiteral("Fixed type %1 needs a size").arg(name));
+    const int index = add(Node::Fixed);
+    m_nodes[static_cast<std::size_t>(index)].fixedSize = size;
+    named->insert(name, index);
+    return index;
+  }
+  if (type == QLatin1String("array") || type == QLatin1String("map")) {
+    const int index = add(type == QLatin1String("array") ? Node::Array : Node::Map);
+    const QJsonValue item =
+        object.value(type == QLatin1String("array") ? QStringLiteral("items")
+                                                    : QStringLiteral("values"));
+    const int child = compileNode(item, enclosingNamespace, named, error);
+    if (child < 0)
+      return -1;
+    m_nodes[static_cast<std::size_t>(index)].children.push_back(child);
+    return index;
+  }
+  return fail(QStringLiteral("Unsupported schema type \"%1\"").arg(type));
+}
+
+bool AvroDecoder::decode(std::string_view payload, std::string *json, QString *error) const {
+  Reader reader(payload);
+  if (decodeNode(m_root, reader, json, 0))
+    return true;
+  if (error)
+    *error = QStringLiteral("Avro value does not match its schema: %1")
+                 .arg(QLatin1String(reader.reason()));
+  return false;
+}
+
+bool AvroDecoder::decodeNode(int index, Reader &reader, std::string *json, int depth) const {
+  if (depth > kMaxDepth)
+    return reader.fail("nested too deeply");
+  const Node &node = m_nodes[static_cast<std::size_t>(index)];
+  qint64 value = 0;
+  std::string_view bytes;
+  switch (node.kind) {
+  case Node::Null:
+    json->append("null");
+    return true;
+  case Node::Boolean:
+    if (!reader.readBytes(1, &bytes))
+      return false;
+    json->append(bytes[0] != 0 ? "true" : "false");
+    return true;
+  case Node::Int:
+  case Node::Long:
+    if (!reader.readLong(&value))
+      return false;
+    json->append(std::to_string(value));
+    return true;
+  case Node::Float: {
+    float number = 0;
+    if (!reader.readBytes(sizeof(number), &bytes))
+      return false;
+    std::memcpy(&number, bytes.data(), sizeof(number));
+    appendJsonDouble(json, static_cast<double>(number));
+    return true;
+  }
+  case Node::Double: {
+    double number = 0;
+    if (!reader.readBytes(sizeof(number), &bytes))
+      return false;
+    std::memcpy(&number, bytes.data(), sizeof(number));
+    appendJsonDouble(json, number);
+    return true;
+  }
+  case Node::Bytes:
+    if (!reader.readSized(&bytes))
+      return false;
+    appendJsonBytes(json, bytes);
+    return true;
+  case Node::String:
+    if (!reader.readSized(&bytes))
+      return false;
+    appendJsonString(json, bytes);
+    return true;
+  case Node::Fixed:
+    if (!reader.readBytes(static_cast<std::size_t>(node.fixedSize), &bytes))
+      return false;
+    appendJsonBytes(json, bytes);
+    return true;
+  case Node::Enum:
+    if (!reader.readLong(&value))
+      return false;
+    if (value < 0 || value >= static_cast<qint64>(node.labels.size()))
+      return reader.fail("enum index out of range");
+    json->append(node.labels[static_cast<std::size_t>(value)]);
+    return true;
+  case Node::Union:
+    if (!reader.readLong(&value))
+      return false;
+    if (value < 0 || value >= static_cast<qint64>(node.children.size()))
+      return reader.fail("union branch out of range");
+    return decodeNode(node.children[static_cast<std::size_t>(value)], reader, json, depth + 1);
+  case Node::Record:
+    json->push_back('{');
+    for (std::size_t i = 0; i < node.children.size(); ++i) {
+      if (i > 0)
+        json->push_back(',');
+      json->append(node.labels[i]);
+      if (!decodeNode(node.children[i], reader, json, depth + 1))
+        return false;
+    }
+    json->push_back('}');
+    return true;
+  case Node::Array:
+  case Node::Map: {
+    const bool isMap = node.kind == Node::Map;
+    json->push_back(isMap ? '{' : '[');
+    bool first = true;
+    // Items come in blocks; a negative count is followed by the block's
+    // size in bytes, and a zero count ends the sequence.
+    for (;;) {
+      qint64 count = 0;
+      if (!reader.readLong(&count))
+        return false;
+      if (count == 0)
+        break;
+      if (count < 0) {
+        qint64 blockBytes = 0;
+        if (!reader.readLong(&blockBytes))
+          return false;
+        // Its negation would overflow; no block holds that many anyway.
+        if (count == std::numeric_limits<qint64>::min())
+          return reader.fail("block count exceeds the value");
+        count = -count;
+      }
+      // Every item but null takes at least a byte, so a count beyond the
+      // payload means the length is garbage.
+      const bool sized = isMap || m_nodes[static_cast<std::size_t>(node.children.front())].kind !=
+                                      Node::Null;
+      const quint64 limit = sized ? reader.remaining() : kMaxNullItems;
+      if (static_cast<quint64>(count) > limit)
+        return reader.fail("block count exceeds the value");
+      for (qint64 i = 0; i < count; ++i) {
+        if (!first)
+          json->push_back(',');
+        first = false;
+        if (isMap) {
+          if (!reader.readSized(&bytes))
+            return false;
+          appendJsonString(json, bytes);
+          json->push_back(':');
+        }
+        if (!decodeNode(node.children.front(), reader, json, depth + 1))
+          return false;
+      }
+    }
+    json->push_back(isMap ? '}' : ']');
+    return true;
+  }
+  }
+  return false;
+}
+
+} // namespace kafka
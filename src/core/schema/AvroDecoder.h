@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonValue>
+
+#include <memory>
+#include <vector>
+
+#include "core/schema/SchemaDecoder.h"
+
+namespace kafka {
+
+/**
+ * @brief Decodes Avro binary values written with one writer schema.
+ *
+ * compile() turns the schema's JSON into a flat array of nodes once: named
+ * types become indexes, record field names are stored already quoted for
+ * output, so decode() only follows indexes and never looks at the schema
+ * text again. Logical types are shown as their underlying type and unions
+ * as the chosen branch's value.
+ */
+class AvroDecoder final : public SchemaDecoder {
+public:
+  /** Returns null and sets @p error when @p schema is not a valid Avro schema. */
+  static std::shared_ptr<const AvroDecoder> compile(const QByteArray &schema, QString *error);
+
+  Type type() const override { return Type::Avro; }
+  bool decode(std::string_view payload, std::string *json, QString *error) const override;
+  QStringList fieldNames() const override { return m_fieldNames; }
+
+private:
+  struct Node {
+    enum Kind : quint8 {
+      Null,
+      Boolean,
+      Int,
+      Long,
+      Float,
+      Double,
+      Bytes,
+      String,
+      Record,
+      Enum,
+      Array,
+      Map,
+      Union,
+      Fixed,
+    };
+
+    Kind kind = Null;
+    /** Record fields, the array or map item, or the union branches. */
+    std::vector<int> children;
+    /** Record fields as "\"name\":", enum symbols as JSON strings. */
+    std::vector<std::string> labels;
+    qint32 fixedSize = 0;
+  };
+
+  class Reader;
+
+  AvroDecoder() = default;
+
+  int compileNode(const QJsonValue &schema, const QString &enclosingNamespace,
+                  QHash<QString, int> *named, QString *error);
+  bool decodeNode(int node, Reader &reader, std::string *json, int depth) const;
+
+  std::vector<Node> m_nodes;
+  int m_root = 0;
+  QStringList m_fieldNames;
+};
+
+} // namespace kafka
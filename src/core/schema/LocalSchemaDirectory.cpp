@@ -0,0 +1,39 @@
+#include "core/schema/LocalSchemaDirectory.h"
+
+#include <QDir>
+#include <QFile>
+
+namespace kafka {
+
+LocalSchemaDirectory::LocalSchemaDirectory(const QString &path) : m_path(path) {}
+
+QString LocalSchemaDirectory::description() const { return QDir::toNativeSeparators(m_path); }
+
+bool LocalSchemaDirectory::fetch(qint32 schemaId, SchemaText *schema, QString *error) {
+  const QDir directory(m_path);
+  const struct {
+    const char *suffix;
+    SchemaDecoder::Type type;
+  } candidates[] = {
+      {".avsc", SchemaDecoder::Type::Avro},
+      {".proto", SchemaDecoder::Type::Protobuf},
+  };
+  for (const auto &candidate : candidates) {
+    QFile file(directory.filePath(QString::number(schemaId) + QLatin1String(candidate.suffix)));
+    if (!file.exists())
+      continue;
+    if (!file.open(QIODevice::ReadOnly)) {
+      if (error)
+        *error = QStringLiteral("Cannot read %1: %2").arg(file.fileName(), file.errorString());
+      return false;
+    }
+    schema->type = candidate.type;
+    schema->text = file.readAll();
+    return true;
+  }
+  if (error)
+    *error = QStringLiteral("No %1.avsc or %1.proto in %2").arg(schemaId).arg(description());
+  return false;
+}
+
+} // namespace kafka
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "core/schema/SchemaSource.h"
+
+namespace kafka {
+
+/**
+ * @brief Schemas stored as files named after their id: 42.avsc for Avro,
+ * 42.proto for Protobuf.
+ *
+ * Stands in for a registry offline and in tests; export the schemas a
+ * topic uses once and decode its values without network access.
+ */
+class LocalSchemaDirectory final : public SchemaSource {
+public:
+  explicit LocalSchemaDirectory(const QString &path);
+
+  QString description() const override;
+  bool fetch(qint32 schemaId, SchemaText *schema, QString *error) override;
+
+private:
+  QString m_path;
+};
+
+} // namespace kafka
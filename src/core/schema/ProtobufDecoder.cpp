@@ -0,0 +1,766 @@
+#include "core/schema/ProtobufDecoder.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+namespace kafka {
+
+namespace {
+constexpr int kMaxDepth = 100;
+
+enum WireType {
+  Varint = 0,
+  Fixed64Wire = 1,
+  LengthDelimited = 2,
+  Fixed32Wire = 5,
+};
+
+constexpr char kBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void appendBase64(std::string *json, std::string_view bytes) {
+  json->push_back('"');
+  std::size_t i = 0;
+  for (; i + 3 <= bytes.size(); i += 3) {
+    const quint32 group = quint32(static_cast<unsigned char>(bytes[i])) << 16 |
+                          quint32(static_cast<unsigned char>(bytes[i + 1])) << 8 |
+                          quint32(static_cast<unsigned char>(bytes[i + 2]));
+    json->push_back(kBase64[(group >> 18) & 0x3F]);
+    json->push_back(kBase64[(group >> 12) & 0x3F]);
+    json->push_back(kBase64[(group >> 6) & 0x3F]);
+    json->push_back(kBase64[group & 0x3F]);
+  }
+  if (i < bytes.size()) {
+    quint32 group = quint32(static_cast<unsigned char>(bytes[i])) << 16;
+    if (i + 1 < bytes.size())
+      group |= quint32(static_cast<unsigned char>(bytes[i + 1])) << 8;
+    json->push_back(kBase64[(group >> 18) & 0x3F]);
+    json->push_back(kBase64[(group >> 12) & 0x3F]);
+    json->push_back(i + 1 < bytes.size() ? kBase64[(group >> 6) & 0x3F] : '=');
+    json->push_back('=');
+  }
+  json->push_back('"');
+}
+
+qint64 zigzag(quint64 value) {
+  return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
+} // namespace
+
+class ProtobufDecoder::Reader {
+public:
+  explicit Reader(std::string_view bytes) : m_p(bytes.data()), m_end(bytes.data() + bytes.size()) {}
+
+  bool atEnd() const { return m_p == m_end; }
+  std::string_view rest() const {
+    return std::string_view(m_p, static_cast<std::size_t>(m_end - m_p));
+  }
+
+  bool readVarint(quint64 *value) {
+    quint64 result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (m_p == m_end)
+        return false;
+      const auto byte = static_cast<unsigned char>(*m_p++);
+      result |= quint64(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        *value = result;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool readFixed(std::size_t size, quint64 *value) {
+    if (static_cast<std::size_t>(m_end - m_p) < size)
+      return false;
+    // Little-endian on the wire whatever the host.
+    quint64 result = 0;
+    for (std::size_t i = 0; i < size; ++i)
+      result |= quint64(static_cast<unsigned char>(m_p[i])) << (8 * i);
+    m_p += size;
+    *value = result;
+    return true;
+  }
+
+  bool readBytes(std::string_view *bytes) {
+    quint64 size = 0;
+    if (!readVarint(&size) || size > static_cast<quint64>(m_end - m_p))
+      return false;
+    *bytes = std::string_view(m_p, static_cast<std::size_t>(size));
+    m_p += size;
+    return true;
+  }
+
+private:
+  const char *m_p;
+  const char *m_end;
+};
+
+// Recursive-descent reader for .proto files. Everything that does not
+// change how values are laid out on the wire (options, services, reserved
+// ranges) is skipped.
+class ProtobufDecoder::Parser {
+public:
+  explicit Parser(const QString &text) { tokenize(text.toStdString()); }
+
+  bool parse(ProtobufDecoder *decoder, QString *error) {
+    m_decoder = decoder;
+    while (m_error.isEmpty() && m_next < m_tokens.size()) {
+      const std::string token = take();
+      if (token == "syntax" || token == "edition" || token == "import" || token == "option") {
+        skipStatement();
+      } else if (token == "package") {
+        m_package = take();
+        expect(";");
+      } else if (token == "message") {
+        const int index = parseMessage(m_package);
+        if (index >= 0)
+          decoder->m_topLevel.push_back(index);
+      } else if (token == "enum") {
+        parseEnum(m_package);
+      } else if (token == "service" || token == "extend") {
+        skipBlock();
+      } else if (token != ";") {
+        fail(QStringLiteral("Unexpected \"%1\"").arg(QString::fromStdString(token)));
+      }
+    }
+    if (m_error.isEmpty())
+      resolve();
+    if (!m_error.isEmpty()) {
+      if (error)
+        *error = m_error;
+      return false;
+    }
+    return true;
+  }
+
+private:
+  struct PendingField {
+    std::string name;
+    std::string type;
+    qint32 number = 0;
+    bool repeated = false;
+    bool isMap = false;
+    std::string keyType;
+  };
+
+  struct PendingMessage {
+    std::string fullName;
+    std::vector<PendingField> fields;
+  };
+
+  void tokenize(const std::string &text) {
+    std::size_t i = 0;
+    while (i < text.size()) {
+      const char c = text[i];
+      if (std::isspace(static_cast<unsigned char>(c))) {
+        ++i;
+      } else if (text.compare(i, 2, "//") == 0) {
+        i = text.find('\n', i);
+        if (i == std::string::npos)
+          break;
+      } else if (text.compare(i, 2, "/*") == 0) {
+        i = text.find("*/", i + 2);
+        if (i == std::string::npos)
+          break;
+        i += 2;
+      } else if (c == '"' || c == '\'') {
+        std::size_t end = i + 1;
+        while (end < text.size() && text[end] != c)
+          end += text[end] == '\\' ? std::size_t(2) : std::size_t(1);
+        m_tokens.push_back(text.substr(i, std::min(end + 1, text.size()) - i));
+        i = end + 1;
+      } else if (std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.') {
+        std::size_t end = i;
+        while (end < text.size() && (std::isalnum(static_cast<unsigned char>(text[end])) ||
+                                     text[end] == '_' || text[end] == '.'))
+          ++end;
+        m_tokens.push_back(text.substr(i, end - i));
+        i = end;
+      } else {
+        m_tokens.push_back(std::string(1, c));
+        ++i;
+      }
+    }
+  }
+
+  std::string take() {
+    if (m_next >= m_tokens.size()) {
+      fail(QStringLiteral("Unexpected end of file"));
+      return std::string();
+    }
+    return m_tokens[m_next++];
+  }
+
+  std::string peek() const { return m_next < m_tokens.size() ? m_tokens[m_next] : std::string(); }
+
+  bool expect(const char *token) {
+    const std::string actual = take();
+    if (actual == token)
+      return true;
+    fail(QStringLiteral("Expected \"%1\" but found \"%2\"")
+             .arg(QLatin1String(token), QString::fromStdString(actual)));
+    return false;
+  }
+
+  void fail(const QString &message) {
+    if (m_error.isEmpty())
+      m_error = message;
+    m_next = m_tokens.size();
+  }
+
+  // Skips to the end of the statement, past a nested block if it has one.
+  void skipStatement() {
+    while (m_next < m_tokens.size()) {
+      const std::string token = take();
+      if (token == ";")
+        return;
+      if (token == "{") {
+        --m_next;
+        skipBlock();
+        return;
+      }
+    }
+  }
+
+  void skipBlock() {
+    while (m_next < m_tokens.size() && m_tokens[m_next] != "{")
+      ++m_next;
+    int depth = 0;
+    while (m_next < m_tokens.size()) {
+      const std::string &token = m_tokens[m_next++];
+      if (token == "{")
+        ++depth;
+      else if (token == "}" && --depth == 0)
+        return;
+    }
+  }
+
+  qint32 takeNumber() {
+    std::string token = take();
+    bool negative = false;
+    if (token == "-") {
+      negative = true;
+      token = take();
+    }
+    char *end = nullptr;
+    const long long value = std::strtoll(token.c_str(), &end, 0);
+    if (token.empty() || *end != '\0') {
+      fail(QStringLiteral("Expected a number but found \"%1\"").arg(QString::fromStdString(token)));
+      return 0;
+    }
+    return static_cast<qint32>(negative ? -value : value);
+  }
+
+  // Field options such as [packed = false] do not change how values are
+  // read: packed and unpacked encodings are both accepted.
+  void skipFieldOptions() {
+    if (peek() != "[")
+      return;
+    while (m_next < m_tokens.size() && take() != "]") {
+    }
+  }
+
+  int parseMessage(const std::string &scope) {
+    const std::string name = take();
+    const std::string fullName = scope.empty() ? name : scope + "." + name;
+    const int index = static_cast<int>(m_pending.size());
+    m_pending.push_back({fullName, {}});
+    m_decoder->m_messages.emplace_back();
+    m_messageIndex.emplace(fullName, index);
+    if (!expect("{"))
+      return -1;
+
+    while (m_error.isEmpty()) {
+      const std::string token = take();
+      if (token == "}")
+        break;
+      if (token == "message") {
+        const int child = parseMessage(fullName);
+        if (child >= 0)
+          m_decoder->m_messages[static_cast<std::size_t>(index)].nested.push_back(child);
+      } else if (token == "enum") {
+        parseEnum(fullName);
+      } else if (token == "oneof") {
+        take();
+        expect("{");
+        while (m_error.isEmpty() && peek() != "}") {
+          const std::string member = take();
+          if (member == "option")
+            skipStatement();
+          else if (member != ";")
+            parseField(index, member);
+        }
+        expect("}");
+      } else if (token == "option" || token == "reserved" || token == "extensions") {
+        skipStatement();
+      } else if (token == "extend") {
+        skipBlock();
+      } else if (token == "map") {
+        PendingField field;
+        field.isMap = true;
+        expect("<");
+        field.keyType = take();
+        expect(",");
+        field.type = take();
+        expect(">");
+        field.name = take();
+        expect("=");
+        field.number = takeNumber();
+        skipFieldOptions();
+        expect(";");
+        field.repeated = true;
+        m_pending[static_cast<std::size_t>(index)].fields.push_back(std::move(field));
+      } else if (token != ";") {
+        parseField(index, token);
+      }
+    }
+    return index;
+  }
+
+  void parseField(int message, std::string token) {
+    PendingField field;
+    if (token == "repeated" || token == "optional" || token == "required") {
+      field.repeated = token == "repeated";
+      token = take();
+    }
+    if (token == "group") {
+      fail(QStringLiteral("Groups are not supported"));
+      return;
+    }
+    field.type = token;
+    field.name = take();
+    expect("=");
+    field.number = takeNumber();
+    skipFieldOptions();
+    expect(";");
+    m_pending[static_cast<std::size_t>(message)].fields.push_back(std::move(field));
+  }
+
+  void parseEnum(const std::string &scope) {
+    const std::string name = take();
+    const std::string fullName = scope.empty() ? name : scope + "." + name;
+    const int index = static_cast<int>(m_decoder->m_enums.size());
+    m_decoder->m_enums.emplace_back();
+    m_enumIndex.emplace(fullName, index);
+    if (!expect("{"))
+      return;
+    while (m_error.isEmpty()) {
+      const std::string token = take();
+      if (token == "}")
+        break;
+      if (token == "option" || token == "reserved") {
+        skipStatement();
+      } else if (token != ";") {
+        expect("=");
+        const qint32 number = takeNumber();
+        skipFieldOptions();
+        expect(";");
+        std::string label;
+        appendJsonString(&label, token);
+        m_decoder->m_enums[static_cast<std::size_t>(index)].values.emplace_back(number,
+                                                                               std::move(label));
+      }
+    }
+  }
+
+  // Resolves @p type as protoc does: innermost scope first, or absolute
+  // with a leading dot.
+  static int lookUp(const std::unordered_map<std::string, int> &names, const std::string &type,
+                    std::string scope) {
+    auto find = [&names](const std::string &name) {
+      const auto it = names.find(name);
+      return it == names.end() ? -1 : it->second;
+    };
+    if (!type.empty() && type[0] == '.')
+      return find(type.substr(1));
+    for (;;) {
+      const int found = find(scope.empty() ? type : scope + "." + type);
+      if (found >= 0 || scope.empty())
+        return found;
+      const std::size_t dot = scope.rfind('.');
+      scope = dot == std::string::npos ? std::string() : scope.substr(0, dot);
+    }
+  }
+
+  Field compileField(const std::string &scope, const std::string &name, const std::string &type,
+                     qint32 number, bool repeated) const {
+    static const std::unordered_map<std::string, Kind> scalars = {
+        {"double", Kind::Double},     {"float", Kind::Float},       {"int32", Kind::Int32},
+        {"int64", Kind::Int64},       {"uint32", Kind::UInt32},     {"uint64", Kind::UInt64},
+        {"sint32", Kind::SInt32},     {"sint64", Kind::SInt64},     {"fixed32", Kind::Fixed32},
+        {"fixed64", Kind::Fixed64},   {"sfixed32", Kind::SFixed32}, {"sfixed64", Kind::SFixed64},
+        {"bool", Kind::Bool},         {"string", Kind::String},     {"bytes", Kind::Bytes},
+    };
+    Field field;
+    field.number = number;
+    field.name = QString::fromStdString(name);
+    appendJsonString(&field.label, name);
+    field.label.push_back(':');
+    field.repeated = repeated;
+    const auto scalar = scalars.find(type);
+    if (scalar != scalars.end()) {
+      field.kind = scalar->second;
+    } else if ((field.target = lookUp(m_messageIndex, type, scope)) >= 0) {
+      field.kind = Kind::Message;
+    } else if ((field.target = lookUp(m_enumIndex, type, scope)) >= 0) {
+      field.kind = Kind::Enum;
+    } else {
+      // Defined in an imported file this decoder does not have.
+      field.kind = Kind::Bytes;
+    }
+    return field;
+  }
+
+  void resolve() {
+    for (std::size_t i = 0; i < m_pending.size(); ++i) {
+      const PendingMessage &pending = m_pending[i];
+      std::vector<Field> fields;
+      for (const PendingField &declared : pending.fields) {
+        if (!declared.isMap) {
+          fields.push_back(compileField(pending.fullName, declared.name, declared.type,
+                                        declared.number, declared.repeated));
+          continue;
+        }
+        Message entry;
+        entry.mapEntry = true;
+        entry.fields.push_back(compileField(pending.fullName, "key", declared.keyType, 1, false));
+        entry.fields.push_back(compileField(pending.fullName, "value", declared.type, 2, false));
+        m_decoder->m_messages.push_back(std::move(entry));
+        Field field = compileField(pending.fullName, declared.name, "bytes", declared.number, true);
+        field.kind = Kind::Message;
+        field.target = static_cast<int>(m_decoder->m_messages.size() - 1);
+        fields.push_back(std::move(field));
+      }
+      std::sort(fields.begin(), fields.end(),
+                [](const Field &a, const Field &b) { return a.number < b.number; });
+      m_decoder->m_messages[i].fields = std::move(fields);
+    }
+  }
+
+  ProtobufDecoder *m_decoder = nullptr;
+  std::vector<std::string> m_tokens;
+  std::size_t m_next = 0;
+  std::string m_package;
+  std::vector<PendingMessage> m_pending;
+  std::unordered_map<std::string, int> m_messageIndex;
+  std::unordered_map<std::string, int> m_enumIndex;
+  QString m_error;
+};
+
+std::shared_ptr<const ProtobufDecoder> ProtobufDecoder::compile(const QString &proto,
+                                                                QString *error) {
+  std::shared_ptr<ProtobufDecoder> decoder(new ProtobufDecoder());
+  Parser parser(proto);
+  if (!parser.parse(decoder.get(), error))
+    return nullptr;
+  if (decoder->m_topLevel.empty()) {
+    if (error)
+      *error = QStringLiteral("The schema defines no message");
+    return nullptr;
+  }
+  return decoder;
+}
+
+QStringList ProtobufDecoder::fieldNames() const {
+  QStringList names;
+  for (const Field &field : m_messages[static_cast<std::size_t>(m_topLevel.front())].fields)
+    names.append(field.name);
+  return names;
+}
+
+bool ProtobufDecoder::decode(std::string_view payload, std::string *json, QString *error) const {
+  // The Confluent framing names the message by its path of indexes through
+  // the file's (nested) declarations, zigzag encoded; a lone 0 is [0].
+  Reader reader(payload);
+  quint64 raw = 0;
+  if (!reader.readVarint(&raw)) {
+    if (error)
+      *error = QStringLiteral("Truncated message index list");
+    return false;
+  }
+  const qint64 count = zigzag(raw);
+  int message = m_topLevel.front();
+  for (qint64 i = 0; i < count; ++i) {
+    const std::vector<int> &candidates =
+        i == 0 ? m_topLevel : m_messages[static_cast<std::size_t>(message)].nested;
+    qint64 index = 0;
+    if (!reader.readVarint(&raw) || (index = zigzag(raw)) < 0 ||
+        index >= static_cast<qint64>(candidates.size())) {
+      if (error)
+        *error = QStringLiteral("Message index out of range for the schema");
+      return false;
+    }
+    message = candidates[static_cast<std::size_t>(index)];
+  }
+  return decodeMessage(message, reader.rest(), json, 0, error);
+}
+
+bool ProtobufDecoder::collect(const Message &message, std::string_view bytes,
+                              std::vector<Occurrence> *found, QString *error) const {
+  Reader reader(bytes);
+  while (!reader.atEnd()) {
+    quint64 tag = 0;
+    Occurrence occurrence;
+    bool ok = reader.readVarint(&tag);
+    occurrence.wireType = static_cast<int>(tag & 7);
+    if (ok) {
+      switch (occurrence.wireType) {
+      case Varint:
+        ok = reader.readVarint(&occurrence.scalar);
+        break;
+      case Fixed64Wire:
+        ok = reader.readFixed(8, &occurrence.scalar);
+        break;
+      case LengthDelimited:
+        ok = reader.readBytes(&occurrence.bytes);
+        break;
+      case Fixed32Wire:
+        ok = reader.readFixed(4, &occurrence.scalar);
+        break;
+      default:
+        ok = false;
+        break;
+      }
+    }
+    if (!ok) {
+      if (error)
+        *error = QStringLiteral("Protobuf value does not match its schema");
+      return false;
+    }
+    const qint64 number = static_cast<qint64>(tag >> 3);
+    const auto field = std::lower_bound(
+        message.fields.begin(), message.fields.end(), number,
+        [](const Field &candidate, qint64 wanted) { return candidate.number < wanted; });
+    // Fields the schema does not know are skipped, as parsers do.
+    if (field == message.fields.end() || field->number != number)
+      continue;
+    occurrence.field = static_cast<int>(field - message.fields.begin());
+    found->push_back(occurrence);
+  }
+  // Repeated fields may be interleaved with others on the wire.
+  std::stable_sort(found->begin(), found->end(), [](const Occurrence &a, const Occurrence &b) {
+    return a.field < b.field;
+  });
+  return true;
+}
+
+bool ProtobufDecoder::decodeMessage(int index, std::string_view bytes, std::string *json,
+                                    int depth, QString *error) const {
+  if (depth > kMaxDepth) {
+    if (error)
+      *error = QStringLiteral("Protobuf value nested too deeply");
+    return false;
+  }
+  const Message &message = m_messages[static_cast<std::size_t>(index)];
+  std::vector<Occurrence> found;
+  if (!collect(message, bytes, &found, error))
+    return false;
+
+  json->push_back('{');
+  bool firstField = true;
+  for (std::size_t i = 0; i < found.size();) {
+    std::size_t end = i + 1;
+    while (end < found.size() && found[end].field == found[i].field)
+      ++end;
+    const Field &field = message.fields[static_cast<std::size_t>(found[i].field)];
+    if (!firstField)
+      json->push_back(',');
+    firstField = false;
+    json->append(field.label);
+
+    const bool isMap = field.kind == Kind::Message &&
+                       m_messages[static_cast<std::size_t>(field.target)].mapEntry;
+    if (isMap) {
+      json->push_back('{');
+      for (std::size_t k = i; k < end; ++k) {
+        if (k > i)
+          json->push_back(',');
+        if (!decodeMapEntry(m_messages[static_cast<std::size_t>(field.target)], found[k].bytes,
+                            json, depth + 1, error))
+          return false;
+      }
+      json->push_back('}');
+    } else if (field.repeated) {
+      const bool packable = field.kind != Kind::String && field.kind != Kind::Bytes &&
+                            field.kind != Kind::Message;
+      json->push_back('[');
+      bool firstValue = true;
+      for (std::size_t k = i; k < end; ++k) {
+        // An empty packed run holds no values, and so no separator.
+        if (packable && found[k].wireType == LengthDelimited && found[k].bytes.empty())
+          continue;
+        if (!firstValue)
+          json->push_back(',');
+        firstValue = false;
+        if (!decodeValue(field, found[k].wireType, found[k].scalar, found[k].bytes, json,
+                         depth + 1, error))
+          return false;
+      }
+      json->push_back(']');
+    } else {
+      // The last occurrence of a singular field wins.
+      const Occurrence &last = found[end - 1];
+      if (!decodeValue(field, last.wireType, last.scalar, last.bytes, json, depth + 1, error))
+        return false;
+    }
+    i = end;
+  }
+  json->push_back('}');
+  return true;
+}
+
+bool ProtobufDecoder::decodeMapEntry(const Message &entry, std::string_view bytes,
+                                     std::string *json, int depth, QString *error) const {
+  std::vector<Occurrence> found;
+  if (!collect(entry, bytes, &found, error))
+    return false;
+  const Occurrence *key = nullptr;
+  const Occurrence *value = nullptr;
+  for (const Occurrence &occurrence : found)
+    (occurrence.field == 0 ? key : value) = &occurrence;
+
+  // JSON keys are strings, so scalar keys are rendered and then quoted.
+  std::string keyText;
+  if (key && !decodeValue(entry.fields[0], key->wireType, key->scalar, key->bytes, &keyText,
+                          depth, error))
+    return false;
+  if (keyText.size() >= 2 && keyText.front() == '"')
+    json->append(keyText);
+  else
+    appendJsonString(json, keyText);
+  json->push_back(':');
+  if (!value) {
+    json->append("null");
+    return true;
+  }
+  return decodeValue(entry.fields[1], value->wireType, value->scalar, value->bytes, json, depth,
+                     error);
+}
+
+bool ProtobufDecoder::decodeValue(const Field &field, int wireType, quint64 scalar,
+                                  std::string_view bytes, std::string *json, int depth,
+                                  QString *error) const {
+  int expected = Varint;
+  switch (field.kind) {
+  case Kind::Double:
+  case Kind::Fixed64:
+  case Kind::SFixed64:
+    expected = Fixed64Wire;
+    break;
+  case Kind::Float:
+  case Kind::Fixed32:
+  case Kind::SFixed32:
+    expected = Fixed32Wire;
+    break;
+  case Kind::String:
+  case Kind::Bytes:
+  case Kind::Message:
+    expected = LengthDelimited;
+    break;
+  default:
+    break;
+  }
+
+  // Packed repeated scalars arrive as one length-delimited run; unpack it
+  // into consecutive values.
+  if (wireType == LengthDelimited && expected != LengthDelimited && field.repeated) {
+    Reader reader(bytes);
+    bool first = true;
+    while (!reader.atEnd()) {
+      quint64 value = 0;
+      const bool ok = expected == Varint ? reader.readVarint(&value)
+                                         : reader.readFixed(expected == Fixed64Wire ? 8 : 4, &value);
+      if (!ok) {
+        if (error)
+          *error = QStringLiteral("Truncated packed field %1").arg(field.name);
+        return false;
+      }
+      if (!first)
+        json->push_back(',');
+      first = false;
+      if (!decodeValue(field, expected, value, std::string_view(), json, depth, error))
+        return false;
+    }
+    return true;
+  }
+  if (wireType != expected) {
+    if (error)
+      *error = QStringLiteral("Field %1 has wire type %2, expected %3")
+                   .arg(field.name)
+                   .arg(wireType)
+                   .arg(expected);
+    return false;
+  }
+
+  switch (field.kind) {
+  case Kind::Int32:
+    json->append(std::to_string(static_cast<qint32>(static_cast<quint32>(scalar))));
+    break;
+  case Kind::Int64:
+    json->append(std::to_string(static_cast<qint64>(scalar)));
+    break;
+  case Kind::UInt32:
+    json->append(std::to_string(static_cast<quint32>(scalar)));
+    break;
+  case Kind::UInt64:
+  case Kind::Fixed64:
+    json->append(std::to_string(scalar));
+    break;
+  case Kind::SInt32:
+  case Kind::SInt64:
+    json->append(std::to_string(zigzag(scalar)));
+    break;
+  case Kind::Fixed32:
+    json->append(std::to_string(static_cast<quint32>(scalar)));
+    break;
+  case Kind::SFixed32:
+    json->append(std::to_string(static_cast<qint32>(static_cast<quint32>(scalar))));
+    break;
+  case Kind::SFixed64:
+    json->append(std::to_string(static_cast<qint64>(scalar)));
+    break;
+  case Kind::Bool:
+    json->append(scalar != 0 ? "true" : "false");
+    break;
+  case Kind::Float: {
+    const auto bits = static_cast<quint32>(scalar);
+    float value = 0;
+    std::memcpy(&value, &bits, sizeof(value));
+    appendJsonDouble(json, static_cast<double>(value));
+    break;
+  }
+  case Kind::Double: {
+    double value = 0;
+    std::memcpy(&value, &scalar, sizeof(value));
+    appendJsonDouble(json, value);
+    break;
+  }
+  case Kind::Enum: {
+    const auto number = static_cast<qint32>(static_cast<quint32>(scalar));
+    const Enum &values = m_enums[static_cast<std::size_t>(field.target)];
+    const auto it = std::find_if(values.values.begin(), values.values.end(),
+                                 [number](const auto &value) { return value.first == number; });
+    // Values added to the enum after this schema stay numbers.
+    if (it != values.values.end())
+      json->append(it->second);
+    else
+      json->append(std::to_string(number));
+    break;
+  }
+  case Kind::String:
+    appendJsonString(json, bytes);
+    break;
+  case Kind::Bytes:
+    appendBase64(json, bytes);
+    break;
+  case Kind::Message:
+    return decodeMessage(field.target, bytes, json, depth + 1, error);
+  }
+  return true;
+}
+
+} // namespace kafka
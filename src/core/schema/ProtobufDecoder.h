@@ -0,0 +1,107 @@
+#pragma once
+
+#include <QString>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "core/schema/SchemaDecoder.h"
+
+namespace kafka {
+
+/**
+ * @brief Decodes Protobuf values described by one .proto file.
+ *
+ * compile() parses the file's messages and enums (proto2 and proto3,
+ * without groups or extensions) and resolves every field type to an index
+ * once. Types imported from other files are unknown here, so their values
+ * are shown as base64 bytes. decode() expects the Confluent message-index
+ * list ahead of the message and renders it like the proto3 JSON mapping,
+ * but with the field names as declared and 64-bit integers as numbers.
+ */
+class ProtobufDecoder final : public SchemaDecoder {
+public:
+  /** Returns null and sets @p error when @p proto cannot be parsed. */
+  static std::shared_ptr<const ProtobufDecoder> compile(const QString &proto, QString *error);
+
+  Type type() const override { return Type::Protobuf; }
+  bool decode(std::string_view payload, std::string *json, QString *error) const override;
+  /** Fields of the first message of the file, the one index list [0] selects. */
+  QStringList fieldNames() const override;
+
+private:
+  enum class Kind : quint8 {
+    Double,
+    Float,
+    Int32,
+    Int64,
+    UInt32,
+    UInt64,
+    SInt32,
+    SInt64,
+    Fixed32,
+    Fixed64,
+    SFixed32,
+    SFixed64,
+    Bool,
+    String,
+    Bytes,
+    Enum,
+    Message,
+  };
+
+  struct Field {
+    qint32 number = 0;
+    /** The name as "\"name\":". */
+    std::string label;
+    QString name;
+    Kind kind = Kind::Bytes;
+    /** Message or enum index for Kind::Message and Kind::Enum. */
+    int target = -1;
+    bool repeated = false;
+  };
+
+  struct Message {
+    /** Sorted by number. */
+    std::vector<Field> fields;
+    /** Nested messages in declaration order, for message indexes. */
+    std::vector<int> nested;
+    /** Synthesized entry of a map field, shown as a JSON object. */
+    bool mapEntry = false;
+  };
+
+  struct Enum {
+    /** Numbers with their names as JSON strings. */
+    std::vector<std::pair<qint32, std::string>> values;
+  };
+
+  // One field occurrence on the wire.
+  struct Occurrence {
+    int field = 0;
+    int wireType = 0;
+    quint64 scalar = 0;
+    std::string_view bytes;
+  };
+
+  class Parser;
+  class Reader;
+
+  ProtobufDecoder() = default;
+
+  bool collect(const Message &message, std::string_view bytes, std::vector<Occurrence> *found,
+               QString *error) const;
+  bool decodeMessage(int index, std::string_view bytes, std::string *json, int depth,
+                     QString *error) const;
+  bool decodeValue(const Field &field, int wireType, quint64 scalar, std::string_view bytes,
+                   std::string *json, int depth, QString *error) const;
+  bool decodeMapEntry(const Message &entry, std::string_view bytes, std::string *json, int depth,
+                      QString *error) const;
+
+  std::vector<Message> m_messages;
+  std::vector<Enum> m_enums;
+  /** Top-level messages in declaration order. */
+  std::vector<int> m_topLevel;
+};
+
+} // namespace kafka
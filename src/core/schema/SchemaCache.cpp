@@ -0,0 +1,58 @@
+#include "core/schema/SchemaCache.h"
+
+#include <QMutexLocker>
+
+#include "core/schema/AvroDecoder.h"
+#include "core/schema/ProtobufDecoder.h"
+#include "core/schema/SchemaSource.h"
+
+namespace kafka {
+
+SchemaCache::SchemaCache(std::shared_ptr<SchemaSource> source) : m_source(std::move(source)) {}
+
+SchemaCache::~SchemaCache() = default;
+
+QString SchemaCache::description() const { return m_source->description(); }
+
+std::shared_ptr<const SchemaDecoder> SchemaCache::decoderFor(qint32 schemaId, QString *error) {
+  std::shared_ptr<Entry> entry;
+  {
+    QMutexLocker locker(&m_mutex);
+    std::shared_ptr<Entry> &slot = m_entries[schemaId];
+    if (!slot)
+      slot = std::make_shared<Entry>();
+    entry = slot;
+  }
+
+  // Held across the fetch so concurrent loaders of the same id wait for
+  // one compilation instead of each fetching the schema.
+  QMutexLocker locker(&entry->mutex);
+  if (!entry->resolved) {
+    SchemaText schema;
+    if (m_source->fetch(schemaId, &schema, &entry->error)) {
+      if (schema.type == SchemaDecoder::Type::Avro)
+        entry->decoder = AvroDecoder::compile(schema.text, &entry->error);
+      else
+        entry->decoder = ProtobufDecoder::compile(QString::fromUtf8(schema.text), &entry->error);
+      if (!entry->decoder)
+        entry->error = QStringLiteral("Schema %1: %2").arg(schemaId).arg(entry->error);
+    }
+    entry->resolved = true;
+  }
+  if (!entry->decoder && error)
+    *error = entry->error;
+  return entry->decoder;
+}
+
+SchemaCache::Result SchemaCache::decode(std::string_view value, qint32 *schemaId,
+                                        std::string *json, QString *error) {
+  std::string_view payload;
+  if (!SchemaDecoder::splitWireFormat(value, schemaId, &payload))
+    return Result::NotEncoded;
+  const std::shared_ptr<const SchemaDecoder> decoder = decoderFor(*schemaId, error);
+  if (!decoder || !decoder->decode(payload, json, error))
+    return Result::Failed;
+  return Result::Decoded;
+}
+
+} // namespace kafka
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include <memory>
+
+#include "core/schema/SchemaDecoder.h"
+
+namespace kafka {
+
+class SchemaSource;
+
+/**
+ * @brief Compiled decoders by schema id, shared by all loader threads.
+ *
+ * The first thread to need an id fetches and compiles its schema while
+ * others needing the same id wait for it; every later value written with
+ * that id reuses the decoder. Failures are kept too, so a schema the
+ * source does not have is asked for once, not once per record.
+ */
+class SchemaCache {
+public:
+  explicit SchemaCache(std::shared_ptr<SchemaSource> source);
+  ~SchemaCache();
+
+  QString description() const;
+
+  /** May block on the source the first time @p schemaId is seen. */
+  std::shared_ptr<const SchemaDecoder> decoderFor(qint32 schemaId, QString *error);
+
+  enum class Result {
+    /** Not in the Confluent wire format; shown as is. */
+    NotEncoded,
+    Decoded,
+    Failed,
+  };
+
+  /** Appends @p value decoded to JSON to @p json and sets @p schemaId. */
+  Result decode(std::string_view value, qint32 *schemaId, std::string *json, QString *error);
+
+private:
+  struct Entry {
+    QMutex mutex;
+    bool resolved = false;
+    std::shared_ptr<const SchemaDecoder> decoder;
+    QString error;
+  };
+
+  std::shared_ptr<SchemaSource> m_source;
+  QMutex m_mutex;
+  QHash<qint32, std::shared_ptr<Entry>> m_entries;
+};
+
+} // namespace kafka
@@ -0,0 +1,122 @@
+#include "core/schema/SchemaDecoder.h"
+
+#include <charconv>
+#include <cmath>
+
+namespace kafka {
+
+namespace {
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+void appendEscapedByte(std::string *json, unsigned char byte) {
+  json->append("\\u00");
+  json->push_back(kHexDigits[byte >> 4]);
+  json->push_back(kHexDigits[byte & 0x0F]);
+}
+
+// Length of the well-formed UTF-8 sequence at @p i, or 0.
+std::size_t utf8SequenceLength(std::string_view text, std::size_t i) {
+  const auto lead = static_cast<unsigned char>(text[i]);
+  std::size_t length = 0;
+  unsigned char min = 0x80;
+  unsigned char max = 0xBF;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    length = 2;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    length = 3;
+    if (lead == 0xE0)
+      min = 0xA0;
+    else if (lead == 0xED)
+      max = 0x9F;
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    length = 4;
+    if (lead == 0xF0)
+      min = 0x90;
+    else if (lead == 0xF4)
+      max = 0x8F;
+  } else {
+    return 0;
+  }
+  if (i + length > text.size())
+    return 0;
+  for (std::size_t k = 1; k < length; ++k) {
+    const auto byte = static_cast<unsigned char>(text[i + k]);
+    if (byte < (k == 1 ? min : 0x80) || byte > (k == 1 ? max : 0xBF))
+      return 0;
+  }
+  return length;
+}
+} // namespace
+
+bool SchemaDecoder::splitWireFormat(std::string_view value, qint32 *schemaId,
+                                    std::string_view *payload) {
+  if (value.size() < 5 || value[0] != 0)
+    return false;
+  quint32 id = 0;
+  for (std::size_t i = 1; i < 5; ++i)
+    id = (id << 8) | static_cast<unsigned char>(value[i]);
+  *schemaId = static_cast<qint32>(id);
+  *payload = value.substr(5);
+  return true;
+}
+
+void SchemaDecoder::appendJsonString(std::string *json, std::string_view text) {
+  json->push_back('"');
+  std::size_t i = 0;
+  while (i < text.size()) {
+    const auto byte = static_cast<unsigned char>(text[i]);
+    if (byte >= 0x80) {
+      const std::size_t length = utf8SequenceLength(text, i);
+      if (length == 0) {
+        json->append("\xEF\xBF\xBD");
+        ++i;
+      } else {
+        json->append(text.data() + i, length);
+        i += length;
+      }
+      continue;
+    }
+    if (byte == '"' || byte == '\\') {
+      json->push_back('\\');
+      json->push_back(static_cast<char>(byte));
+    } else if (byte < 0x20) {
+      appendEscapedByte(json, byte);
+    } else {
+      json->push_back(static_cast<char>(byte));
+    }
+    ++i;
+  }
+  json->push_back('"');
+}
+
+void SchemaDecoder::appendJsonBytes(std::string *json, std::string_view bytes) {
+  json->push_back('"');
+  for (char c : bytes) {
+    const auto byte = static_cast<unsigned char>(c);
+    if (byte == '"' || byte == '\\') {
+      json->push_back('\\');
+      json->push_back(c);
+    } else if (byte < 0x20 || byte >= 0x80) {
+      appendEscapedByte(json, byte);
+    } else {
+      json->push_back(c);
+    }
+  }
+  json->push_back('"');
+}
+
+void SchemaDecoder::appendJsonDouble(std::string *json, double value) {
+  if (std::isnan(value)) {
+    json->append("\"NaN\"");
+    return;
+  }
+  if (std::isinf(value)) {
+    json->append(value > 0 ? "\"Infinity\"" : "\"-Infinity\"");
+    return;
+  }
+  char buffer[32];
+  const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  json->append(buffer, result.ptr);
+}
+
+} // namespace kafka
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include <string>
+#include <string_view>
+
+namespace kafka {
+
+/**
+ * @brief A schema compiled into a decoder for the values written with it.
+ *
+ * Decoders render a payload as JSON text so the rest of the viewer (value
+ * column, JSON columns) treats decoded and plain JSON values alike. They
+ * are immutable once compiled and shared between loader threads.
+ */
+class SchemaDecoder {
+public:
+  enum class Type {
+    Avro,
+    Protobuf,
+  };
+
+  virtual ~SchemaDecoder() = default;
+
+  virtual Type type() const = 0;
+  /**
+   * @brief Appends @p payload, the value without the Confluent header, to
+   * @p json; false with @p error when it does not fit the schema.
+   */
+  virtual bool decode(std::string_view payload, std::string *json, QString *error) const = 0;
+  /** Top-level fields of the value, in schema order. */
+  virtual QStringList fieldNames() const = 0;
+
+  /**
+   * @brief Splits a value in the Confluent wire format: magic byte 0, the
+   * big-endian schema id, then the payload.
+   */
+  static bool splitWireFormat(std::string_view value, qint32 *schemaId, std::string_view *payload);
+
+  /** Appends @p text as a quoted JSON string; invalid UTF-8 becomes U+FFFD. */
+  static void appendJsonString(std::string *json, std::string_view text);
+  /** Appends binary @p bytes as a JSON string with one \u00XX per byte above 0x7F. */
+  static void appendJsonBytes(std::string *json, std::string_view bytes);
+  /** Appends @p value; JSON has no NaN or infinity, so those become strings. */
+  static void appendJsonDouble(std::string *json, double value);
+};
+
+} // namespace kafka
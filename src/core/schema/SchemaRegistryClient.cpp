@@ -0,0 +1,67 @@
+#include "core/schema/SchemaRegistryClient.h"
+
+#include <QEventLoop>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTimer>
+
+#include <memory>
+
+namespace kafka {
+
+SchemaRegistryClient::SchemaRegistryClient(const QUrl &baseUrl) : m_baseUrl(baseUrl) {}
+
+QString SchemaRegistryClient::description() const {
+  return m_baseUrl.toDisplayString(QUrl::RemoveUserInfo);
+}
+
+bool SchemaRegistryClient::fetch(qint32 schemaId, SchemaText *schema, QString *error) {
+  QUrl url = m_baseUrl;
+  QString path = url.path();
+  if (!path.endsWith(QLatin1Char('/')))
+    path += QLatin1Char('/');
+  url.setPath(path + QStringLiteral("schemas/ids/%1").arg(schemaId));
+
+  QNetworkRequest request(url);
+  request.setRawHeader("Accept", "application/vnd.schemaregistry.v1+json");
+  QNetworkAccessManager network;
+  QEventLoop loop;
+  QTimer timeout;
+  timeout.setSingleShot(true);
+  const std::unique_ptr<QNetworkReply> reply(network.get(request));
+  QObject::connect(reply.get(), &QNetworkReply::finished, &loop, &QEventLoop::quit);
+  QObject::connect(&timeout, &QTimer::timeout, reply.get(), &QNetworkReply::abort);
+  timeout.start(kTimeoutMs);
+  loop.exec();
+
+  const QByteArray body = reply->readAll();
+  if (reply->error() != QNetworkReply::NoError) {
+    // The registry explains itself in {"error_code":..., "message":...}.
+    const QString message =
+        QJsonDocument::fromJson(body).object().value(QStringLiteral("message")).toString();
+    if (error)
+      *error = QStringLiteral("Schema %1 from %2: %3")
+                   .arg(schemaId)
+                   .arg(description(), message.isEmpty() ? reply->errorString() : message);
+    return false;
+  }
+
+  const QJsonObject object = QJsonDocument::fromJson(body).object();
+  const QString type = object.value(QStringLiteral("schemaType")).toString();
+  if (type.isEmpty() || type == QLatin1String("AVRO")) {
+    schema->type = SchemaDecoder::Type::Avro;
+  } else if (type == QLatin1String("PROTOBUF")) {
+    schema->type = SchemaDecoder::Type::Protobuf;
+  } else {
+    if (error)
+      *error = QStringLiteral("Schema %1 is %2, which cannot be decoded").arg(schemaId).arg(type);
+    return false;
+  }
+  schema->text = object.value(QStringLiteral("schema")).toString().toUtf8();
+  return true;
+}
+
+} // namespace kafka
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QUrl>
+
+#include "core/schema/SchemaSource.h"
+
+namespace kafka {
+
+/**
+ * @brief Fetches schemas from a Confluent-compatible Schema Registry with
+ * GET /schemas/ids/{id}.
+ *
+ * Each fetch runs its own QNetworkAccessManager and event loop on the
+ * calling worker thread. Credentials in the URL are used for basic
+ * authentication. Schema references are not followed, so Protobuf
+ * schemas importing other subjects decode those fields as bytes.
+ */
+class SchemaRegistryClient final : public SchemaSource {
+public:
+  static constexpr int kTimeoutMs = 10000;
+
+  explicit SchemaRegistryClient(const QUrl &baseUrl);
+
+  QString description() const override;
+  bool fetch(qint32 schemaId, SchemaText *schema, QString *error) override;
+
+private:
+  QUrl m_baseUrl;
+};
+
+} // namespace kafka
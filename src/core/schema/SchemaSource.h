@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include "core/schema/SchemaDecoder.h"
+
+namespace kafka {
+
+/**
+ * @brief A schema as its source stores it, before compilation.
+ */
+struct SchemaText {
+  SchemaDecoder::Type type = SchemaDecoder::Type::Avro;
+  QByteArray text;
+};
+
+/**
+ * @brief Where schemas are looked up by the id values carry.
+ *
+ * Implementations are thread-safe and may block, so call them from worker
+ * threads only; SchemaCache asks each id once.
+ */
+class SchemaSource {
+public:
+  virtual ~SchemaSource() = default;
+
+  /** Human readable origin, e.g. the registry URL. */
+  virtual QString description() const = 0;
+  virtual bool fetch(qint32 schemaId, SchemaText *schema, QString *error) = 0;
+};
+
+} // namespace kafka
@@ -0,0 +1,231 @@
+#include "core/search/PatternMatcher.h"
+
+#include <cstring>
+
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define KAFKA_SEARCH_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+namespace kafka {
+
+namespace {
+inline unsigned char foldAscii(unsigned char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c | 0x20) : c;
+}
+
+// Compares @p size bytes of @p text against the already folded @p needle.
+bool equalsFolded(const unsigned char *text, const unsigned char *needle, std::size_t size) {
+  for (std::size_t i = 0; i < size; ++i) {
+    if (foldAscii(text[i]) != needle[i])
+      return false;
+  }
+  return true;
+}
+
+std::size_t findScalar(const unsigned char *text, std::size_t size, const unsigned char *needle,
+                       std::size_t needleSize, std::size_t from, bool caseSensitive) {
+  if (caseSensitive) {
+    const unsigned char first = needle[0];
+    std::size_t i = from;
+    while (i + needleSize <= size) {
+      const void *hit = std::memchr(text + i, first, size - needleSize + 1 - i);
+      if (!hit)
+        return std::string_view::npos;
+      i = static_cast<std::size_t>(static_cast<const unsigned char *>(hit) - text);
+      if (std::memcmp(text + i + 1, needle + 1, needleSize - 1) == 0)
+        return i;
+      ++i;
+    }
+    return std::string_view::npos;
+  }
+  for (std::size_t i = from; i + needleSize <= size; ++i) {
+    if (foldAscii(text[i]) == needle[0] && equalsFolded(text + i, needle, needleSize))
+      return i;
+  }
+  return std::string_view::npos;
+}
+
+#ifdef KAFKA_SEARCH_SSE2
+inline int countTrailingZeros(unsigned int mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index = 0;
+  _BitScanForward(&index, mask);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+// ASCII upper case to lower case on 16 bytes; bytes >= 0x80 compare as
+// negative and are left alone.
+inline __m128i foldAscii16(__m128i bytes) {
+  const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('A' - 1)),
+                                      _mm_cmplt_epi8(bytes, _mm_set1_epi8('Z' + 1)));
+  return _mm_or_si128(bytes, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+// Compares the first and last needle byte against 16 candidate positions at
+// once; only positions where both agree are verified byte by byte. The
+// blocks that cannot be read whole are left to the scalar loop.
+std::size_t findSse2(const unsigned char *text, std::size_t size, const unsigned char *needle,
+                     std::size_t needleSize, bool caseSensitive) {
+  const __m128i first = _mm_set1_epi8(static_cast<char>(needle[0]));
+  const __m128i last = _mm_set1_epi8(static_cast<char>(needle[needleSize - 1]));
+
+  std::size_t i = 0;
+  for (; i + needleSize + 15 <= size; i += 16) {
+    __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i));
+    __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i + needleSize - 1));
+    if (!caseSensitive) {
+      head = foldAscii16(head);
+      tail = foldAscii16(tail);
+    }
+    unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last))));
+    while (mask != 0) {
+      const std::size_t candidate = i + static_cast<std::size_t>(countTrailingZeros(mask));
+      // The first and last byte already matched.
+      const bool equal =
+          caseSensitive
+              ? needleSize <= 2 ||
+                    std::memcmp(text + candidate + 1, needle + 1, needleSize - 2) == 0
+              : equalsFolded(text + candidate + 1, needle + 1, needleSize - 1);
+      if (equal)
+        return candidate;
+      mask &= mask - 1;
+    }
+  }
+  return findScalar(text, size, needle, needleSize, i, caseSensitive);
+}
+#endif
+
+// @p needle is already folded when matching case-insensitively.
+std::size_t findBytes(std::string_view haystack, std::string_view needle, bool caseSensitive) {
+  if (needle.empty())
+    return 0;
+  if (needle.size() > haystack.size())
+    return std::string_view::npos;
+  const auto *text = reinterpret_cast<const unsigned char *>(haystack.data());
+  const auto *pattern = reinterpret_cast<const unsigned char *>(needle.data());
+#ifdef KAFKA_SEARCH_SSE2
+  return findSse2(text, haystack.size(), pattern, needle.size(), caseSensitive);
+#else
+  return findScalar(text, haystack.size(), pattern, needle.size(), 0, caseSensitive);
+#endif
+}
+
+std::string foldedCopy(std::string_view text) {
+  std::string folded(text);
+  for (char &c : folded)
+    c = static_cast<char>(foldAscii(static_cast<unsigned char>(c)));
+  return folded;
+}
+
+QString pcre2Message(int code) {
+  PCRE2_UCHAR buffer[256];
+  const int length = pcre2_get_error_message(code, buffer, sizeof(buffer));
+  if (length < 0)
+    return QStringLiteral("PCRE2 error %1").arg(code);
+  return QString::fromUtf8(reinterpret_cast<const char *>(buffer), length);
+}
+} // namespace
+
+PatternMatcher::~PatternMatcher() {
+  if (m_code)
+    pcre2_code_free(m_code);
+}
+
+std::size_t PatternMatcher::findLiteral(std::string_view haystack, std::string_view needle,
+                                        bool caseSensitive) {
+  if (caseSensitive)
+    return findBytes(haystack, needle, true);
+  return findBytes(haystack, foldedCopy(needle), false);
+}
+
+std::shared_ptr<const PatternMatcher> PatternMatcher::compile(const QString &pattern,
+                                                              Syntax syntax, bool caseSensitive,
+                                                              QString *error) {
+  if (pattern.isEmpty()) {
+    if (error)
+      *error = QStringLiteral("Empty pattern");
+    return nullptr;
+  }
+
+  std::shared_ptr<PatternMatcher> matcher(new PatternMatcher());
+  matcher->m_syntax = syntax;
+  matcher->m_caseSensitive = caseSensitive;
+
+  const QByteArray utf8 = pattern.toUtf8();
+  if (syntax == Syntax::Literal) {
+    const std::string_view literal(utf8.constData(), static_cast<std::size_t>(utf8.size()));
+    matcher->m_literal = caseSensitive ? std::string(literal) : foldedCopy(literal);
+    return matcher;
+  }
+
+  // Record values are often not valid UTF-8; MATCH_INVALID_UTF lets the
+  // pattern match the valid parts instead of failing the whole subject.
+  std::uint32_t options = PCRE2_UTF | PCRE2_MATCH_INVALID_UTF;
+  if (!caseSensitive)
+    options |= PCRE2_CASELESS;
+  int errorCode = 0;
+  PCRE2_SIZE errorOffset = 0;
+  matcher->m_code =
+      pcre2_compile(reinterpret_cast<PCRE2_SPTR>(utf8.constData()),
+                    static_cast<PCRE2_SIZE>(utf8.size()), options, &errorCode, &errorOffset,
+                    nullptr);
+  if (!matcher->m_code) {
+    if (error)
+      *error = QStringLiteral("%1 at position %2").arg(pcre2Message(errorCode)).arg(errorOffset);
+    return nullptr;
+  }
+  matcher->m_jit = pcre2_jit_compile(matcher->m_code, PCRE2_JIT_COMPLETE) == 0;
+  return matcher;
+}
+
+PatternMatcher::Scanner::Scanner(std::shared_ptr<const PatternMatcher> matcher)
+    : m_matcher(std::move(matcher)) {
+  if (m_matcher->m_code)
+    m_matchData = pcre2_match_data_create_from_pattern(m_matcher->m_code, nullptr);
+}
+
+PatternMatcher::Scanner::~Scanner() {
+  if (m_matchData)
+    pcre2_match_data_free(m_matchData);
+}
+
+bool PatternMatcher::Scanner::find(std::string_view text, Match *match) {
+  const PatternMatcher &matcher = *m_matcher;
+  if (matcher.m_syntax == Syntax::Literal) {
+    const std::size_t position = findBytes(text, matcher.m_literal, matcher.m_caseSensitive);
+    if (position == std::string_view::npos)
+      return false;
+    match->position = position;
+    match->length = matcher.m_literal.size();
+    return true;
+  }
+
+  if (!m_matchData)
+    return false;
+  // A null view (a null key or value) still has to be a valid subject.
+  const auto *subject = reinterpret_cast<PCRE2_SPTR>(text.data() ? text.data() : "");
+  const int rc = matcher.m_jit
+                     ? pcre2_jit_match(matcher.m_code, subject, text.size(), 0, 0, m_matchData,
+                                       nullptr)
+                     : pcre2_match(matcher.m_code, subject, text.size(), 0, 0, m_matchData,
+                                   nullptr);
+  if (rc < 0)
+    return false;
+  const PCRE2_SIZE *ovector = pcre2_get_ovector_pointer(m_matchData);
+  match->position = ovector[0];
+  match->length = ovector[1] > ovector[0] ? ovector[1] - ovector[0] : 0;
+  return true;
+}
+
+} // namespace kafka
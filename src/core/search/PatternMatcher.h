@@ -0,0 +1,88 @@
+#pragma once
+
+#include <QString>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+struct pcre2_real_code_8;
+struct pcre2_real_match_data_8;
+
+namespace kafka {
+
+/**
+ * @brief A compiled search pattern applied to raw record bytes.
+ *
+ * Matching works on the UTF-8 bytes as stored, never on decoded QStrings.
+ * Literals are found with a SIMD scan (SSE2 on x86-64, memchr elsewhere)
+ * that filters candidate positions by the pattern's first and last byte;
+ * regular expressions are compiled once with PCRE2 and JIT-compiled when
+ * the platform allows. Case-insensitive literals fold ASCII only.
+ *
+ * The pattern itself is immutable and shared between threads; each thread
+ * matches through its own Scanner.
+ */
+class PatternMatcher {
+public:
+  enum class Syntax {
+    Literal,
+    Regex,
+  };
+
+  struct Match {
+    std::size_t position = 0;
+    std::size_t length = 0;
+  };
+
+  /** Per-thread matching state. */
+  class Scanner {
+  public:
+    explicit Scanner(std::shared_ptr<const PatternMatcher> matcher);
+    ~Scanner();
+
+    Scanner(const Scanner &) = delete;
+    Scanner &operator=(const Scanner &) = delete;
+
+    bool find(std::string_view text, Match *match);
+
+  private:
+    std::shared_ptr<const PatternMatcher> m_matcher;
+    pcre2_real_match_data_8 *m_matchData = nullptr;
+  };
+
+  ~PatternMatcher();
+
+  PatternMatcher(const PatternMatcher &) = delete;
+  PatternMatcher &operator=(const PatternMatcher &) = delete;
+
+  /** Returns null and sets @p error for an empty or invalid pattern. */
+  static std::shared_ptr<const PatternMatcher> compile(const QString &pattern, Syntax syntax,
+                                                       bool caseSensitive, QString *error);
+
+  Syntax syntax() const { return m_syntax; }
+  bool caseSensitive() const { return m_caseSensitive; }
+  /** True when the regex was JIT-compiled (always false for literals). */
+  bool isJitCompiled() const { return m_jit; }
+
+  /**
+   * @brief Position of the first occurrence of @p needle in @p haystack, or
+   * npos; ASCII letters compare case-insensitively unless @p caseSensitive.
+   * An empty needle matches at 0.
+   */
+  static std::size_t findLiteral(std::string_view haystack, std::string_view needle,
+                                 bool caseSensitive);
+
+private:
+  PatternMatcher() = default;
+
+  Syntax m_syntax = Syntax::Literal;
+  bool m_caseSensitive = true;
+  bool m_jit = false;
+  // Lower-cased when matching case-insensitively.
+  std::string m_literal;
+  pcre2_real_code_8 *m_code = nullptr;
+};
+
+} // namespace kafka
@@ -0,0 +1,121 @@
+#include "core/search/TopicSearch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "core/protocol/RecordBatch.h"
+
+namespace kafka {
+
+namespace {
+constexpr std::size_t kContextBefore = 32;
+constexpr std::size_t kContextAfter = 96;
+
+QString previewAround(std::string_view text, const PatternMatcher::Match &match) {
+  const std::size_t from = match.position > kContextBefore ? match.position - kContextBefore : 0;
+  const std::size_t to = std::min(text.size(), match.position + match.length + kContextAfter);
+  QString preview = QString::fromUtf8(text.data() + from, static_cast<int>(to - from));
+  for (QChar &ch : preview) {
+    if (ch.category() == QChar::Other_Control)
+      ch = QLatin1Char(' ');
+  }
+  if (from > 0)
+    preview.prepend(QChar(0x2026));
+  if (to < text.size())
+    preview.append(QChar(0x2026));
+  return preview;
+}
+} // namespace
+
+class TopicSearch::Worker final : public SliceScan::Worker {
+public:
+  Worker(TopicSearch *owner, std::shared_ptr<const PatternMatcher> matcher, int fields,
+         std::shared_ptr<std::atomic<int>> matches)
+      : m_owner(owner), m_scanner(std::move(matcher)), m_fields(fields),
+        m_matches(std::move(matches)) {}
+
+  bool add(int, qint32 partition, const Record &record) override {
+    PatternMatcher::Match match;
+    SearchMatch found;
+    if ((m_fields & SearchMatch::Key) && record.key.data() &&
+        m_scanner.find(record.key, &match)) {
+      found.field = SearchMatch::Key;
+      found.preview = previewAround(record.key, match);
+    } else if ((m_fields & SearchMatch::Value) && record.value.data() &&
+               m_scanner.find(record.value, &match)) {
+      found.field = SearchMatch::Value;
+      found.preview = previewAround(record.value, match);
+    } else if (m_fields & SearchMatch::Headers) {
+      HeaderReader headers(record);
+      RecordHeader header;
+      bool hit = false;
+      while (!hit && headers.next(header)) {
+        if (m_scanner.find(header.key, &match)) {
+          found.preview = previewAround(header.key, match);
+          hit = true;
+        } else if (header.value.data() && m_scanner.find(header.value, &match)) {
+          found.preview = previewAround(header.value, match);
+          hit = true;
+        }
+        if (hit) {
+          found.field = SearchMatch::Headers;
+          found.headerKey =
+              QString::fromUtf8(header.key.data(), static_cast<int>(header.key.size()));
+        }
+      }
+      if (!hit)
+        return true;
+    } else {
+      return true;
+    }
+    found.partition = partition;
+    found.offset = record.offset;
+    found.timestamp = record.timestamp;
+    m_pending.append(std::move(found));
+    return m_matches->fetch_add(1) + 1 < kMaxMatches;
+  }
+
+  std::function<void()> take() override {
+    if (m_pending.isEmpty())
+      return nullptr;
+    return [owner = m_owner, matches = std::exchange(m_pending, {})]() {
+      owner->m_matchCount += matches.size();
+      emit owner->matchesFound(matches);
+    };
+  }
+
+private:
+  TopicSearch *m_owner;
+  PatternMatcher::Scanner m_scanner;
+  int m_fields;
+  // Shared by the workers of one search.
+  std::shared_ptr<std::atomic<int>> m_matches;
+  QVector<SearchMatch> m_pending;
+};
+
+TopicSearch::TopicSearch(QObject *parent)
+    : QObject(parent),
+      m_scan(
+          this, QStringLiteral("kafka-search"), "search worker",
+          [this](qint64 scanned, qint64 total) { emit progressChanged(scanned, total); },
+          [this]() { emit finished(); }) {}
+
+void TopicSearch::start(std::shared_ptr<BatchSource> source, const QVector<qint32> &partitions,
+                        std::shared_ptr<const PatternMatcher> matcher, int fields) {
+  cancel();
+  if (!source || !matcher || partitions.isEmpty() || fields == 0)
+    return;
+
+  m_matchCount = 0;
+  SliceScan::Request request;
+  request.targets.append({QString(), std::move(source), partitions});
+  auto matches = std::make_shared<std::atomic<int>>(0);
+  m_scan.start(std::move(request), [this, matcher = std::move(matcher), fields, matches]() {
+    return std::make_unique<Worker>(this, matcher, fields, matches);
+  });
+}
+
+void TopicSearch::cancel() { m_scan.cancel(); }
+
+} // namespace kafka
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+#include "core/scan/SliceScan.h"
+#include "core/search/PatternMatcher.h"
+
+namespace kafka {
+
+class BatchSource;
+
+/**
+ * @brief One record matching a TopicSearch, with the text around the match.
+ */
+struct SearchMatch {
+  enum Field {
+    Key = 1 << 0,
+    Value = 1 << 1,
+    Headers = 1 << 2,
+  };
+
+  qint32 partition = 0;
+  qint64 offset = 0;
+  qint64 timestamp = 0;
+  Field field = Value;
+  /** Header name when @c field is Headers. */
+  QString headerKey;
+  QString preview;
+};
+
+/**
+ * @brief Scans every record of a set of partitions for a pattern.
+ *
+ * Runs on a SliceScan, so all partitions are read in parallel and a single
+ * large partition still spreads across every worker. Records are matched
+ * in place on their raw bytes; only matches are turned into QStrings. Matches reach matchesFound() in batches while the scan runs,
+ * in no particular order.
+ *
+ * cancel() stops every worker at its next batch. Starting a new search
+ * cancels the running one; results of a cancelled search are never
+ * delivered after start() returns.
+ */
+class TopicSearch final : public QObject {
+  Q_OBJECT
+
+public:
+  /** The scan stops once this many records matched. */
+  static constexpr int kMaxMatches = 10000;
+
+  explicit TopicSearch(QObject *parent = nullptr);
+
+  /**
+   * @brief Searches @p fields (SearchMatch::Field flags) of every record in
+   * @p partitions of @p source.
+   */
+  void start(std::shared_ptr<BatchSource> source, const QVector<qint32> &partitions,
+             std::shared_ptr<const PatternMatcher> matcher, int fields);
+  void cancel();
+
+  bool isRunning() const { return m_scan.isRunning(); }
+  int matchCount() const { return m_matchCount; }
+  /** Valid after finished(). */
+  bool wasCancelled() const { return m_scan.wasCancelled(); }
+  bool limitReached() const { return m_scan.stoppedByWorker(); }
+  QString errorString() const { return m_scan.errorString(); }
+  /** Compressed batches that could not be inflated and were skipped. */
+  qint64 skippedBatches() const { return m_scan.skippedBatches(); }
+
+signals:
+  void matchesFound(const QVector<kafka::SearchMatch> &matches);
+  /** Offsets scanned so far out of @p total across all partitions. */
+  void progressChanged(qint64 scanned, qint64 total);
+  void finished();
+
+private:
+  class Worker;
+
+  int m_matchCount = 0;
+  // Last, so the workers stop before anything else goes.
+  SliceScan m_scan;
+};
+
+} // namespace kafka
@@ -0,0 +1,52 @@
+#include "core/source/BatchSource.h"
+
+namespace kafka {
+
+namespace {
+class SequentialPoller final : public BatchPoller {
+public:
+  explicit SequentialPoller(BatchSource *source) : m_source(source) {}
+
+  bool poll(const QVector<PollTarget> &targets, QVector<BatchChunk> *chunks,
+            QString *error) override {
+    chunks->clear();
+    chunks->reserve(targets.size());
+    for (const PollTarget &target : targets) {
+      BatchChunk chunk;
+      QString readError;
+      if (!m_source->read(target.partition, target.offset, target.maxBytes, &chunk,
+                          &readError)) {
+        const qint16 errorCode = chunk.errorCode;
+        chunk = BatchChunk();
+        chunk.errorCode = errorCode != 0 ? errorCode : qint16(-1);
+        if (error)
+          *error = readError;
+      }
+      chunks->append(chunk);
+    }
+    return true;
+  }
+
+private:
+  BatchSource *m_source;
+};
+} // namespace
+
+bool BatchSource::offsetsForTimestamp(const QVector<qint32> &partitions, qint64 timestamp,
+                                      QVector<qint64> *offsets, QString *error) {
+  offsets->clear();
+  offsets->reserve(partitions.size());
+  for (qint32 partition : partitions) {
+    qint64 offset = 0;
+    if (!offsetForTimestamp(partition, timestamp, &offset, error))
+      return false;
+    offsets->append(offset);
+  }
+  return true;
+}
+
+std::unique_ptr<BatchPoller> BatchSource::createPoller() {
+  return std::make_unique<SequentialPoller>(this);
+}
+
+} // namespace kafka
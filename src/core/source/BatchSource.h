@@ -0,0 +1,133 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+#include <memory>
+#include <string_view>
+
+namespace kafka {
+
+/**
+ * @brief Half-open offset range [start, end) of a partition.
+ */
+struct OffsetRange {
+  qint64 start = 0;
+  qint64 end = 0;
+
+  qint64 size() const { return end > start ? end - start : 0; }
+  bool contains(qint64 offset) const { return offset >= start && offset < end; }
+};
+
+/**
+ * @brief Raw record batches read from a partition.
+ *
+ * @c bytes may begin with a batch that starts before the requested offset
+ * and may end with a truncated batch; BatchReader handles both. @c owner
+ * keeps the memory behind @c bytes alive (a network frame, a mapped file)
+ * for as long as any copy of the chunk exists.
+ */
+struct BatchChunk {
+  std::shared_ptr<const void> owner;
+  std::string_view bytes;
+  qint16 errorCode = 0;
+
+  bool isEmpty() const { return bytes.empty(); }
+};
+
+/**
+ * @brief One partition for BatchPoller::poll(): read from @c offset, up to
+ * roughly @c maxBytes.
+ */
+struct PollTarget {
+  qint32 partition = 0;
+  qint64 offset = 0;
+  qint32 maxBytes = 1 << 20;
+};
+
+/**
+ * @brief Reads a set of partitions of a source round after round, as a
+ * reader following their ends does. A poller may keep state between rounds
+ * that makes the next one cheaper, so each reader gets its own and uses it
+ * from one thread at a time.
+ */
+class BatchPoller {
+public:
+  virtual ~BatchPoller() = default;
+
+  /**
+   * @brief Reads every target, filling @p chunks with one chunk per target
+   * in the same order. A chunk is empty when its partition has nothing at
+   * or after the offset yet; a failed partition gets a non-zero errorCode
+   * (-1 when the failure was not a Kafka error) and @p error describes it.
+   * Returns false with @p error set when the round failed as a whole.
+   */
+  virtual bool poll(const QVector<PollTarget> &targets, QVector<BatchChunk> *chunks,
+                    QString *error) = 0;
+};
+
+/**
+ * @brief Synchronous access to the record batches of one topic, whatever
+ * the backing store (broker, log directory, ...).
+ *
+ * Implementations are thread-safe and may block, so call them from worker
+ * threads only, never from the GUI thread.
+ */
+class BatchSource {
+public:
+  virtual ~BatchSource() = default;
+
+  /** Unique per source object for the life of the process; keys caches. */
+  quint64 sourceId() const { return m_sourceId; }
+
+  /** Human readable origin, e.g. "orders @ broker:9092". */
+  virtual QString description() const = 0;
+  virtual QString topic() const = 0;
+  virtual QVector<qint32> partitions() = 0;
+  /**
+   * @brief Names the same topic across runs, for caches kept on disk. May
+   * block; empty when it cannot be determined.
+   */
+  virtual QString persistentKey() = 0;
+
+  virtual bool offsetRange(qint32 partition, OffsetRange *range, QString *error) = 0;
+  /**
+   * @brief Reads batches starting at the one containing @p offset, up to
+   * roughly @p maxBytes (at least one whole batch when available). An empty
+   * chunk means there is nothing at or after @p offset yet.
+   */
+  virtual bool read(qint32 partition, qint64 offset, qint32 maxBytes, BatchChunk *chunk,
+                    QString *error) = 0;
+  /**
+   * @brief First offset whose timestamp is >= @p timestamp, or the end
+   * offset when there is none.
+   */
+  virtual bool offsetForTimestamp(qint32 partition, qint64 timestamp, qint64 *offset,
+                                  QString *error) = 0;
+  /**
+   * @brief offsetForTimestamp() for each of @p partitions, filling
+   * @p offsets in the same order. The default asks one partition at a time;
+   * sources that can answer for many at once override it.
+   */
+  virtual bool offsetsForTimestamp(const QVector<qint32> &partitions, qint64 timestamp,
+                                   QVector<qint64> *offsets, QString *error);
+  /**
+   * @brief A poller for one reader of many partitions. The default one
+   * calls read() for each target in turn.
+   */
+  virtual std::unique_ptr<BatchPoller> createPoller();
+
+protected:
+  BatchSource() : m_sourceId(nextSourceId()) {}
+
+private:
+  static quint64 nextSourceId() {
+    static std::atomic<quint64> next{1};
+    return next.fetch_add(1);
+  }
+
+  const quint64 m_sourceId;
+};
+
+} // namespace kafka
@@ -0,0 +1,265 @@
+#include "core/source/KafkaBatchSource.h"
+
+#include <QMutexLocker>
+#include <QStringList>
+
+#include <algorithm>
+
+#include "core/cache/BatchCache.h"
+#include "core/network/FetchSession.h"
+#include "core/network/KafkaClient.h"
+#include "core/protocol/ApiKeys.h"
+#include "core/trace/Trace.h"
+
+namespace kafka {
+
+namespace {
+QString partitionError(qint16 errorCode) {
+  return QStringLiteral("Partition error %1 (%2)")
+      .arg(errorCode)
+      .arg(QLatin1String(errorName(errorCode)));
+}
+
+class SessionPoller final : public BatchPoller {
+public:
+  SessionPoller(KafkaClient *client, const QString &topic)
+      : m_client(client), m_topic(topic), m_sessions(std::make_shared<FetchSessions>()) {}
+  ~SessionPoller() override { m_client->closeFetchSessions(m_sessions); }
+
+  bool poll(const QVector<PollTarget> &targets, QVector<BatchChunk> *chunks,
+            QString *error) override {
+    KAFKA_TRACE_SCOPE("fetch session");
+    QVector<FetchTarget> fetchTargets;
+    fetchTargets.reserve(targets.size());
+    for (const PollTarget &target : targets) {
+      FetchTarget fetchTarget;
+      fetchTarget.tp = TopicPartition{m_topic, target.partition};
+      fetchTarget.offset = target.offset;
+      fetchTarget.maxBytes = target.maxBytes;
+      fetchTargets.append(fetchTarget);
+    }
+
+    QVector<FetchedPartition> fetched;
+    if (!m_client->fetchSessionBlocking(m_sessions, fetchTargets, &fetched, error))
+      return false;
+
+    // Partitions with nothing new are not in the answer at all.
+    QHash<qint32, int> indexOf;
+    indexOf.reserve(fetched.size());
+    for (int i = 0; i < fetched.size(); ++i)
+      indexOf.insert(fetched.at(i).tp.partition, i);
+
+    chunks->clear();
+    chunks->reserve(targets.size());
+    std::shared_ptr<const QByteArray> owner;
+    for (const PollTarget &target : targets) {
+      BatchChunk chunk;
+      const int index = indexOf.value(target.partition, -1);
+      if (index >= 0) {
+        const FetchedPartition &result = fetched.at(index);
+        chunk.errorCode = result.errorCode;
+        if (result.errorCode != 0) {
+          if (error)
+            *error = partitionError(result.errorCode);
+        } else if (result.recordsSize > 0) {
+          // Every partition of one response shares its frame.
+          if (!owner || owner->constData() != result.frame.constData())
+            owner = std::make_shared<const QByteArray>(result.frame);
+          chunk.owner = owner;
+          chunk.bytes = result.records();
+        }
+      }
+      chunks->append(chunk);
+    }
+    return true;
+  }
+
+private:
+  KafkaClient *m_client;
+  QString m_topic;
+  std::shared_ptr<FetchSessions> m_sessions;
+};
+} // namespace
+
+KafkaBatchSource::KafkaBatchSource(KafkaClient *client, const QString &topic)
+    : m_client(client), m_topic(topic) {}
+
+QString KafkaBatchSource::description() const {
+  return QStringLiteral("%1 (cluster)").arg(m_topic);
+}
+
+QVector<qint32> KafkaBatchSource::partitions() {
+  ClusterMetadata metadata;
+  QString error;
+  if (!m_client->metadataBlocking(&metadata, &error))
+    return {};
+
+  QVector<qint32> result;
+  if (const TopicInfo *info = metadata.topic(m_topic)) {
+    for (const PartitionInfo &partition : info->partitions)
+      result.append(partition.partition);
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+// The cluster is named by its brokers; a changed broker set starts fresh
+// caches. The topic id, where the broker has one, keeps a topic deleted
+// and created again under the same name from reading the old one's.
+QString KafkaBatchSource::persistentKey() {
+  ClusterMetadata metadata;
+  QString error;
+  if (!m_client->metadataBlocking(&metadata, &error) || metadata.brokers.isEmpty())
+    return QString();
+
+  QStringList brokers;
+  for (const BrokerInfo &broker : std::as_const(metadata.brokers))
+    brokers.append(QStringLiteral("%1:%2").arg(broker.host).arg(broker.port));
+  brokers.sort();
+  QString key = QStringLiteral("kafka:%1/%2").arg(brokers.join(QLatin1Char(',')), m_topic);
+  const TopicInfo *info = metadata.topic(m_topic);
+  if (info && !info->topicId.isNull())
+    key += QLatin1Char('/') + info->topicId.toString(QUuid::WithoutBraces);
+  return key;
+}
+
+bool KafkaBatchSource::offsetRange(qint32 partition, OffsetRange *range, QString *error) {
+  const QVector<TopicPartition> partitions{TopicPartition{m_topic, partition}};
+  QVector<PartitionOffset> earliest;
+  QVector<PartitionOffset> latest;
+  if (!m_client->listOffsetsBlocking(partitions, kEarliestTimestamp, &earliest, error) ||
+      !m_client->listOffsetsBlocking(partitions, kLatestTimestamp, &latest, error))
+    return false;
+  if (earliest.isEmpty() || latest.isEmpty())
+    return false;
+  if (earliest.first().errorCode != 0 || latest.first().errorCode != 0) {
+    if (error)
+      *error = partitionError(earliest.first().errorCode ? earliest.first().errorCode
+                                                         : latest.first().errorCode);
+    return false;
+  }
+  range->start = earliest.first().offset;
+  range->end = latest.first().offset;
+  return true;
+}
+
+QString KafkaBatchSource::cacheKey() {
+  QMutexLocker locker(&m_cacheKeyMutex);
+  if (m_cacheKey.isEmpty())
+    m_cacheKey = persistentKey();
+  return m_cacheKey;
+}
+
+bool KafkaBatchSource::read(qint32 partition, qint64 offset, qint32 maxBytes, BatchChunk *chunk,
+                            QString *error) {
+  const std::shared_ptr<BatchCache> cache = m_client->batchCache();
+  const QString key = cache && cache->isEnabled() ? cacheKey() : QString();
+  if (!key.isEmpty() && cache->read(key, partition, offset, chunk))
+    return true;
+
+  KAFKA_TRACE_SCOPE("fetch");
+  FetchTarget target;
+  target.tp = TopicPartition{m_topic, partition};
+  target.offset = offset;
+  target.maxBytes = maxBytes;
+
+  QVector<FetchedPartition> fetched;
+  if (!m_client->fetchBlocking({target}, &fetched, error) || fetched.isEmpty())
+    return false;
+
+  const FetchedPartition &result = fetched.first();
+  chunk->errorCode = result.errorCode;
+  if (result.errorCode != 0) {
+    if (error)
+      *error = partitionError(result.errorCode);
+    return false;
+  }
+  chunk->owner = std::make_shared<const QByteArray>(result.frame);
+  chunk->bytes = result.records();
+  if (!key.isEmpty())
+    cache->store(key, partition, offset, *chunk);
+  return true;
+}
+
+bool KafkaBatchSource::offsetForTimestamp(qint32 partition, qint64 timestamp, qint64 *offset,
+                                          QString *error) {
+  QVector<PartitionOffset> offsets;
+  if (!m_client->listOffsetsBlocking({TopicPartition{m_topic, partition}}, timestamp, &offsets,
+                                     error) ||
+      offsets.isEmpty())
+    return false;
+  if (offsets.first().errorCode != 0) {
+    if (error)
+      *error = partitionError(offsets.first().errorCode);
+    return false;
+  }
+  if (offsets.first().offset >= 0) {
+    *offset = offsets.first().offset;
+    return true;
+  }
+  OffsetRange range;
+  if (!offsetRange(partition, &range, error))
+    return false;
+  *offset = range.end;
+  return true;
+}
+
+// The client groups the partitions by leader, so this is one request per
+// broker; a second round asks for the end of the partitions that have
+// nothing at or after the timestamp.
+bool KafkaBatchSource::offsetsForTimestamp(const QVector<qint32> &partitions, qint64 timestamp,
+                                           QVector<qint64> *offsets, QString *error) {
+  QVector<TopicPartition> targets;
+  targets.reserve(partitions.size());
+  for (qint32 partition : partitions)
+    targets.append(TopicPartition{m_topic, partition});
+
+  QVector<PartitionOffset> found;
+  if (!m_client->listOffsetsBlocking(targets, timestamp, &found, error))
+    return false;
+  QHash<qint32, qint64> offsetOf;
+  QVector<TopicPartition> pastEnd;
+  for (const PartitionOffset &result : std::as_const(found)) {
+    if (result.errorCode != 0) {
+      if (error)
+        *error = partitionError(result.errorCode);
+      return false;
+    }
+    if (result.offset >= 0)
+      offsetOf.insert(result.tp.partition, result.offset);
+    else
+      pastEnd.append(result.tp);
+  }
+  if (!pastEnd.isEmpty()) {
+    QVector<PartitionOffset> ends;
+    if (!m_client->listOffsetsBlocking(pastEnd, kLatestTimestamp, &ends, error))
+      return false;
+    for (const PartitionOffset &result : std::as_const(ends)) {
+      if (result.errorCode != 0) {
+        if (error)
+          *error = partitionError(result.errorCode);
+        return false;
+      }
+      offsetOf.insert(result.tp.partition, result.offset);
+    }
+  }
+
+  offsets->clear();
+  offsets->reserve(partitions.size());
+  for (qint32 partition : partitions) {
+    const auto it = offsetOf.constFind(partition);
+    if (it == offsetOf.cend()) {
+      if (error)
+        *error = QStringLiteral("No offset for partition %1").arg(partition);
+      return false;
+    }
+    offsets->append(it.value());
+  }
+  return true;
+}
+
+std::unique_ptr<BatchPoller> KafkaBatchSource::createPoller() {
+  return std::make_unique<SessionPoller>(m_client, m_topic);
+}
+
+} // namespace kafka
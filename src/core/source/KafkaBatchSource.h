@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QMutex>
+
+#include "core/source/BatchSource.h"
+
+namespace kafka {
+
+class KafkaClient;
+
+/**
+ * @brief BatchSource reading a topic from a live cluster through the
+ * blocking KafkaClient helpers. The client must outlive the source and
+ * its pollers.
+ *
+ * Pollers fetch through incremental fetch sessions, so following
+ * thousands of partitions costs one small request per broker and round
+ * once the first round has named them all.
+ *
+ * With a BatchCache on the client, read() is answered from disk for
+ * offsets fetched before, in this run or an earlier one, and stores what
+ * it fetches. Pollers follow the ends of partitions and always fetch.
+ */
+class KafkaBatchSource final : public BatchSource {
+public:
+  KafkaBatchSource(KafkaClient *client, const QString &topic);
+
+  QString description() const override;
+  QString topic() const override { return m_topic; }
+  QVector<qint32> partitions() override;
+  QString persistentKey() override;
+  bool offsetRange(qint32 partition, OffsetRange *range, QString *error) override;
+  bool read(qint32 partition, qint64 offset, qint32 maxBytes, BatchChunk *chunk,
+            QString *error) override;
+  bool offsetForTimestamp(qint32 partition, qint64 timestamp, qint64 *offset,
+                          QString *error) override;
+  /** One ListOffsets request per leader broker, whatever the partition count. */
+  bool offsetsForTimestamp(const QVector<qint32> &partitions, qint64 timestamp,
+                           QVector<qint64> *offsets, QString *error) override;
+  std::unique_ptr<BatchPoller> createPoller() override;
+
+private:
+  /** persistentKey(), asked once; empty until it could be determined. */
+  QString cacheKey();
+
+  KafkaClient *m_client = nullptr;
+  QString m_topic;
+  QMutex m_cacheKeyMutex;
+  QString m_cacheKey;
+};
+
+} // namespace kafka
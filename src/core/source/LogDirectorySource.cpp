@@ -0,0 +1,135 @@
+#include "core/source/LogDirectorySource.h"
+
+#include <QDir>
+
+#include <algorithm>
+
+#include "core/log/LogSegment.h"
+#include "core/protocol/RecordBatch.h"
+
+namespace kafka {
+
+LogDirectorySource::LogDirectorySource(const QString &topic,
+                                       const QVector<LogPartitionDirectory> &directories)
+    : m_topic(topic) {
+  for (const LogPartitionDirectory &directory : directories) {
+    if (directory.topic != topic)
+      continue;
+    if (m_root.isEmpty())
+      m_root = QDir(directory.path).absoluteFilePath(QStringLiteral(".."));
+    Segments &segments = m_segments[directory.partition];
+    for (const QString &file : LogDirectory::segmentFiles(directory.path)) {
+      if (auto segment = LogSegment::forLogFile(file))
+        segments.push_back(std::move(segment));
+    }
+  }
+}
+
+LogDirectorySource::~LogDirectorySource() = default;
+
+QString LogDirectorySource::description() const {
+  return QStringLiteral("%1 (%2)").arg(m_topic, QDir::cleanPath(m_root));
+}
+
+QVector<qint32> LogDirectorySource::partitions() {
+  QVector<qint32> result;
+  for (auto it = m_segments.cbegin(); it != m_segments.cend(); ++it)
+    result.append(it.key());
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+QString LogDirectorySource::persistentKey() {
+  const QString root = QDir(m_root).canonicalPath();
+  return root.isEmpty() ? QString() : QStringLiteral("log:%1/%2").arg(root, m_topic);
+}
+
+const LogDirectorySource::Segments *LogDirectorySource::segmentsFor(qint32 partition,
+                                                                    QString *error) const {
+  const auto it = m_segments.constFind(partition);
+  if (it == m_segments.cend() || it->empty()) {
+    if (error)
+      *error = QStringLiteral("No segments for %1-%2").arg(m_topic).arg(partition);
+    return nullptr;
+  }
+  return &it.value();
+}
+
+bool LogDirectorySource::offsetRange(qint32 partition, OffsetRange *range, QString *error) {
+  const Segments *segments = segmentsFor(partition, error);
+  if (!segments)
+    return false;
+
+  LogSegment &first = *segments->front();
+  LogSegment &last = *segments->back();
+  if (!first.map(error) || !last.map(error))
+    return false;
+  range->start = first.firstOffset();
+  range->end = std::max(range->start, last.nextOffset());
+  return true;
+}
+
+bool LogDirectorySource::read(qint32 partition, qint64 offset, qint32 maxBytes,
+                              BatchChunk *chunk, QString *error) {
+  const Segments *segments = segmentsFor(partition, error);
+  if (!segments)
+    return false;
+
+  // Last segment whose base offset is <= offset; earlier offsets start at
+  // the first segment.
+  auto it = std::upper_bound(segments->begin(), segments->end(), offset,
+                             [](qint64 value, const std::shared_ptr<LogSegment> &segment) {
+                               return value < segment->baseOffset();
+                             });
+  if (it != segments->begin())
+    --it;
+
+  for (; it != segments->end(); ++it) {
+    LogSegment &segment = **it;
+    if (!segment.map(error))
+      return false;
+
+    const std::string_view log = segment.log();
+    const std::size_t position = segment.positionForOffset(offset);
+    if (position >= log.size())
+      continue;
+
+    // Always hand out at least the whole first batch.
+    std::size_t length = static_cast<std::size_t>(std::max(maxBytes, 0));
+    RecordBatch batch;
+    if (RecordBatch::parse(log.substr(position), batch) == ParseStatus::Ok)
+      length = std::max(length, batch.size());
+
+    chunk->owner = *it;
+    chunk->bytes = log.substr(position, length);
+    chunk->errorCode = 0;
+    return true;
+  }
+
+  *chunk = BatchChunk();
+  return true;
+}
+
+bool LogDirectorySource::offsetForTimestamp(qint32 partition, qint64 timestamp, qint64 *offset,
+                                            QString *error) {
+  const Segments *segments = segmentsFor(partition, error);
+  if (!segments)
+    return false;
+
+  // Segments older than the target only scan the tail after their last
+  // time index entry, so walking them in order stays cheap.
+  for (const std::shared_ptr<LogSegment> &segment : *segments) {
+    if (!segment->map(error))
+      return false;
+    if (segment->offsetForTimestamp(timestamp, offset))
+      return true;
+  }
+
+  OffsetRange range;
+  if (!offsetRange(partition, &range, error))
+    return false;
+  *offset = range.end;
+  return true;
+}
+
+} // namespace kafka
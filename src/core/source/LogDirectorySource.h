@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QHash>
+
+#include <memory>
+#include <vector>
+
+#include "core/log/LogDirectory.h"
+#include "core/source/BatchSource.h"
+
+namespace kafka {
+
+class LogSegment;
+
+/**
+ * @brief BatchSource reading one topic straight from copied partition
+ * directories. Segments are memory-mapped on first access and chunks point
+ * into the mappings, so nothing is copied into the heap.
+ */
+class LogDirectorySource final : public BatchSource {
+public:
+  LogDirectorySource(const QString &topic, const QVector<LogPartitionDirectory> &directories);
+  ~LogDirectorySource() override;
+
+  QString description() const override;
+  QString topic() const override { return m_topic; }
+  QVector<qint32> partitions() override;
+  QString persistentKey() override;
+  bool offsetRange(qint32 partition, OffsetRange *range, QString *error) override;
+  bool read(qint32 partition, qint64 offset, qint32 maxBytes, BatchChunk *chunk,
+            QString *error) override;
+  bool offsetForTimestamp(qint32 partition, qint64 timestamp, qint64 *offset,
+                          QString *error) override;
+
+private:
+  using Segments = std::vector<std::shared_ptr<LogSegment>>;
+
+  const Segments *segmentsFor(qint32 partition, QString *error) const;
+
+  QString m_topic;
+  QString m_root;
+  // Filled in the constructor and never modified, so readers need no lock.
+  QHash<qint32, Segments> m_segments;
+};
+
+} // namespace kafka
@@ -0,0 +1,269 @@
+#include "core/stats/Sketches.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace kafka {
+
+quint64 sketchHash(std::string_view bytes) {
+  quint64 hash = 14695981039346656037ull;
+  for (char c : bytes) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  // splitmix64 finalizer; FNV leaves the high bits poorly mixed.
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ull;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebull;
+  hash ^= hash >> 31;
+  return hash;
+}
+
+HyperLogLog::HyperLogLog() : m_registers(kRegisters, 0) {}
+
+void HyperLogLog::add(quint64 hash) {
+  const auto index = static_cast<std::size_t>(hash >> (64 - kPrecision));
+  // The guard bit caps the rank when the remaining bits are all zero.
+  const quint64 rest = (hash << kPrecision) | (quint64(1) << (kPrecision - 1));
+  const auto rank = static_cast<quint8>(qCountLeadingZeroBits(rest) + 1);
+  if (rank > m_registers[index])
+    m_registers[index] = rank;
+}
+
+void HyperLogLog::merge(const HyperLogLog &other) {
+  for (std::size_t i = 0; i < m_registers.size(); ++i)
+    m_registers[i] = std::max(m_registers[i], other.m_registers[i]);
+}
+
+double HyperLogLog::estimate() const {
+  double sum = 0;
+  int zeros = 0;
+  for (quint8 rank : m_registers) {
+    sum += std::ldexp(1.0, -rank);
+    if (rank == 0)
+      ++zeros;
+  }
+  const double m = kRegisters;
+  const double alpha = 0.7213 / (1 + 1.079 / m);
+  const double raw = alpha * m * m / sum;
+  // Linear counting is more accurate while many registers are still empty.
+  if (raw <= 2.5 * m && zeros > 0)
+    return m * std::log(m / zeros);
+  return raw;
+}
+
+double HyperLogLog::standardError() {
+  return 1.04 / std::sqrt(static_cast<double>(kRegisters));
+}
+
+CountMinSketch::CountMinSketch() : m_counters(std::size_t(kDepth) * kWidth, 0) {}
+
+// Row hashes come from the two halves of one 64-bit hash (Kirsch and
+// Mitzenmacher), which keeps the rows independent enough.
+std::size_t CountMinSketch::column(quint64 hash, int row) {
+  const quint64 first = hash & 0xffffffffu;
+  const quint64 second = (hash >> 32) | 1;
+  return static_cast<std::size_t>((first + quint64(row) * second) & (kWidth - 1));
+}
+
+quint64 CountMinSketch::add(quint64 hash) {
+  quint64 estimate = ~quint64(0);
+  for (int row = 0; row < kDepth; ++row) {
+    quint64 &counter = m_counters[std::size_t(row) * kWidth + column(hash, row)];
+    estimate = std::min(estimate, ++counter);
+  }
+  return estimate;
+}
+
+quint64 CountMinSketch::estimate(quint64 hash) const {
+  quint64 estimate = ~quint64(0);
+  for (int row = 0; row < kDepth; ++row)
+    estimate = std::min(estimate, m_counters[std::size_t(row) * kWidth + column(hash, row)]);
+  return estimate;
+}
+
+void CountMinSketch::merge(const CountMinSketch &other) {
+  for (std::size_t i = 0; i < m_counters.size(); ++i)
+    m_counters[i] += other.m_counters[i];
+}
+
+HeavyHitters::HeavyHitters() {
+  m_entries.reserve(kCapacity);
+  m_slots.reserve(kCapacity * 2);
+}
+
+void HeavyHitters::add(quint64 hash, std::string_view key, quint64 estimate) {
+  // A tracked key's estimate only grows, so it is never rejected here.
+  const bool full = m_entries.size() == static_cast<std::size_t>(kCapacity);
+  if (full && estimate <= m_entries[static_cast<std::size_t>(m_lightest)].count)
+    return;
+
+  const auto slot = m_slots.find(hash);
+  if (slot != m_slots.end()) {
+    m_entries[static_cast<std::size_t>(slot->second)].count = estimate;
+    if (slot->second == m_lightest)
+      updateLightest();
+    return;
+  }
+  if (!full) {
+    m_entries.push_back({hash, std::string(key.substr(0, kMaxKeyBytes)), estimate});
+    m_slots.emplace(hash, static_cast<int>(m_entries.size() - 1));
+    updateLightest();
+    return;
+  }
+  replaceLightest(hash, key, estimate);
+}
+
+void HeavyHitters::replaceLightest(quint64 hash, std::string_view key, quint64 count) {
+  Entry &entry = m_entries[static_cast<std::size_t>(m_lightest)];
+  m_slots.erase(entry.hash);
+  entry.hash = hash;
+  entry.key.assign(key.data(), std::min(key.size(), kMaxKeyBytes));
+  entry.count = count;
+  m_slots.emplace(hash, m_lightest);
+  updateLightest();
+}
+
+void HeavyHitters::updateLightest() {
+  std::size_t lightest = 0;
+  for (std::size_t i = 1; i < m_entries.size(); ++i) {
+    if (m_entries[i].count < m_entries[lightest].count)
+      lightest = i;
+  }
+  m_lightest = m_entries.empty() ? -1 : static_cast<int>(lightest);
+}
+
+void HeavyHitters::merge(const HeavyHitters &other, const CountMinSketch &counts) {
+  std::vector<Entry> candidates = m_entries;
+  for (const Entry &entry : other.m_entries) {
+    if (m_slots.find(entry.hash) == m_slots.end())
+      candidates.push_back(entry);
+  }
+  for (Entry &entry : candidates)
+    entry.count = counts.estimate(entry.hash);
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Entry &a, const Entry &b) { return a.count > b.count; });
+  if (candidates.size() > static_cast<std::size_t>(kCapacity))
+    candidates.resize(kCapacity);
+
+  m_entries = std::move(candidates);
+  m_slots.clear();
+  for (std::size_t i = 0; i < m_entries.size(); ++i)
+    m_slots.emplace(m_entries[i].hash, static_cast<int>(i));
+  updateLightest();
+}
+
+std::vector<HeavyHitters::Entry> HeavyHitters::entries() const {
+  std::vector<Entry> sorted = m_entries;
+  std::sort(sorted.begin(), sorted.end(),
+            [](const Entry &a, const Entry &b) { return a.count > b.count; });
+  return sorted;
+}
+
+void SizeHistogram::add(quint64 size) {
+  const int bucket =
+      size == 0 ? 0 : std::min(kBuckets - 1, 63 - static_cast<int>(qCountLeadingZeroBits(size)));
+  ++m_counts[static_cast<std::size_t>(bucket)];
+  m_min = std::min(m_min, size);
+  m_max = std::max(m_max, size);
+  ++m_total;
+  m_sum += size;
+}
+
+void SizeHistogram::merge(const SizeHistogram &other) {
+  for (std::size_t i = 0; i < m_counts.size(); ++i)
+    m_counts[i] += other.m_counts[i];
+  m_min = std::min(m_min, other.m_min);
+  m_max = std::max(m_max, other.m_max);
+  m_total += other.m_total;
+  m_sum += other.m_sum;
+}
+
+quint64 SizeHistogram::quantileBound(double q) const {
+  if (m_total == 0)
+    return 0;
+  const auto target = static_cast<quint64>(std::ceil(q * static_cast<double>(m_total)));
+  quint64 seen = 0;
+  for (int bucket = 0; bucket < kBuckets; ++bucket) {
+    seen += count(bucket);
+    if (seen >= target && seen > 0)
+      return bucket + 1 < kBuckets ? std::min(m_max, lowerBound(bucket + 1) - 1) : m_max;
+  }
+  return m_max;
+}
+
+qint64 TimeSeries::alignDown(qint64 timestamp, qint64 width) {
+  qint64 quotient = timestamp / width;
+  if (timestamp % width != 0 && timestamp < 0)
+    --quotient;
+  return quotient * width;
+}
+
+static_assert(TimeSeries::kMaxWidthMs / 2 <=
+                  std::numeric_limits<qint64>::max() / TimeSeries::kBuckets &&
+              TimeSeries::kMaxWidthMs > std::numeric_limits<qint64>::max() / TimeSeries::kBuckets,
+              "kMaxWidthMs must be the first width whose buckets span every timestamp");
+
+void TimeSeries::add(qint64 timestamp, quint64 count) {
+  if (timestamp < 0)
+    return;
+  if (m_counts.empty()) {
+    m_counts.assign(kBuckets, 0);
+    m_origin = alignDown(timestamp, m_width);
+  }
+  // Divided rather than multiplied out: width * kBuckets overflows at the
+  // widest buckets.
+  while (timestamp < m_origin ||
+         static_cast<quint64>(timestamp - m_origin) / static_cast<quint64>(m_width) >=
+             static_cast<quint64>(kBuckets))
+    widen();
+  m_counts[static_cast<std::size_t>((timestamp - m_origin) / m_width)] += count;
+}
+
+// Doubles the width; the origin moves down by at most one old bucket to
+// stay aligned, so the span grows in both directions. At kMaxWidthMs the
+// origin moves to 0 instead, after which every timestamp fits.
+void TimeSeries::widen() {
+  const qint64 width = m_width < kMaxWidthMs ? m_width * 2 : m_width;
+  const qint64 origin = width == m_width ? 0 : alignDown(m_origin, width);
+  const auto ratio = static_cast<std::size_t>(width / m_width);
+  const auto shift = static_cast<std::size_t>((m_origin - origin) / m_width);
+  std::vector<quint64> counts(kBuckets, 0);
+  // Empty buckets past the last timestamp may map beyond the new span.
+  for (std::size_t i = 0; i < m_counts.size(); ++i) {
+    if (m_counts[i] > 0)
+      counts[(i + shift) / ratio] += m_counts[i];
+  }
+  m_counts = std::move(counts);
+  m_origin = origin;
+  m_width = width;
+}
+
+void TimeSeries::merge(const TimeSeries &other) {
+  if (other.m_counts.empty())
+    return;
+  if (m_counts.empty()) {
+    *this = other;
+    return;
+  }
+  while (m_width < other.m_width)
+    widen();
+  for (std::size_t i = 0; i < other.m_counts.size(); ++i) {
+    if (other.m_counts[i] > 0)
+      add(other.m_origin + static_cast<qint64>(i) * other.m_width, other.m_counts[i]);
+  }
+}
+
+int TimeSeries::bucketCount() const {
+  for (std::size_t i = m_counts.size(); i > 0; --i) {
+    if (m_counts[i - 1] > 0)
+      return static_cast<int>(i);
+  }
+  return 0;
+}
+
+} // namespace kafka
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace kafka {
+
+/**
+ * @brief 64-bit hash of @p bytes for the sketches: FNV-1a with a final
+ * avalanche, so the high bits HyperLogLog indexes by are well mixed.
+ */
+quint64 sketchHash(std::string_view bytes);
+
+/**
+ * @brief Distinct-count estimate in 2^kPrecision one-byte registers
+ * (16 KiB), with a standard error of about 1.04 / sqrt(2^kPrecision),
+ * 0.8%. Two sketches merge by taking the larger of each register.
+ */
+class HyperLogLog {
+public:
+  static constexpr int kPrecision = 14;
+  static constexpr int kRegisters = 1 << kPrecision;
+
+  HyperLogLog();
+
+  void add(quint64 hash);
+  void merge(const HyperLogLog &other);
+  double estimate() const;
+  /** Relative standard error of estimate(). */
+  static double standardError();
+
+private:
+  std::vector<quint8> m_registers;
+};
+
+/**
+ * @brief Count-Min sketch: kDepth rows of kWidth counters. An estimate
+ * never undercounts and overcounts by at most e / kWidth of the total with
+ * probability 1 - e^-kDepth. Sketches merge by adding their counters.
+ */
+class CountMinSketch {
+public:
+  static constexpr int kDepth = 4;
+  static constexpr int kWidth = 2048;
+
+  CountMinSketch();
+
+  /** Counts @p hash once and returns its new estimate. */
+  quint64 add(quint64 hash);
+  quint64 estimate(quint64 hash) const;
+  void merge(const CountMinSketch &other);
+
+private:
+  static std::size_t column(quint64 hash, int row);
+
+  std::vector<quint64> m_counters;
+};
+
+/**
+ * @brief The kCapacity keys with the highest Count-Min estimates seen so
+ * far, a bounded candidate set in the spirit of Space-Saving.
+ *
+ * add() costs one comparison against the smallest tracked count unless the
+ * key's estimate beats it, so a skewed stream touches the candidate table
+ * only for its heavy keys. Keys are kept up to kMaxKeyBytes; longer keys
+ * are identified by their hash and shown cut.
+ */
+class HeavyHitters {
+public:
+  static constexpr int kCapacity = 64;
+  static constexpr std::size_t kMaxKeyBytes = 256;
+
+  struct Entry {
+    quint64 hash = 0;
+    std::string key;
+    quint64 count = 0;
+  };
+
+  HeavyHitters();
+
+  /** Offers @p key whose Count-Min estimate is now @p estimate. */
+  void add(quint64 hash, std::string_view key, quint64 estimate);
+  /**
+   * @brief Keeps the heaviest of both candidate sets, recounted against
+   * @p counts, which must already include both streams.
+   */
+  void merge(const HeavyHitters &other, const CountMinSketch &counts);
+  /** Candidates, heaviest first. */
+  std::vector<Entry> entries() const;
+
+private:
+  void replaceLightest(quint64 hash, std::string_view key, quint64 count);
+  void updateLightest();
+
+  std::vector<Entry> m_entries;
+  std::unordered_map<quint64, int> m_slots;
+  int m_lightest = -1;
+};
+
+/**
+ * @brief Record sizes in power-of-two buckets: bucket i holds sizes in
+ * [2^i, 2^(i+1)), bucket 0 also holds empty records.
+ */
+class SizeHistogram {
+public:
+  static constexpr int kBuckets = 32;
+
+  void add(quint64 size);
+  void merge(const SizeHistogram &other);
+
+  quint64 count(int bucket) const { return m_counts[static_cast<std::size_t>(bucket)]; }
+  static quint64 lowerBound(int bucket) { return bucket == 0 ? 0 : quint64(1) << bucket; }
+  quint64 minimum() const { return m_total > 0 ? m_min : 0; }
+  quint64 maximum() const { return m_max; }
+  quint64 total() const { return m_total; }
+  quint64 sum() const { return m_sum; }
+  /** Upper bound of the bucket holding quantile @p q in [0, 1]. */
+  quint64 quantileBound(double q) const;
+
+private:
+  std::array<quint64, kBuckets> m_counts{};
+  quint64 m_min = ~quint64(0);
+  quint64 m_max = 0;
+  quint64 m_total = 0;
+  quint64 m_sum = 0;
+};
+
+/**
+ * @brief Records per time bucket, in at most kBuckets buckets.
+ *
+ * Buckets start kBaseWidthMs wide and double, pairwise merged, whenever a
+ * timestamp falls outside the span they cover. Bucket starts are always
+ * multiples of the width, so two series merge exactly once the narrower
+ * is widened to the wider's width. Negative timestamps, which Kafka uses
+ * for "none", are ignored; at kMaxWidthMs the buckets from 0 cover every
+ * other qint64, and widening only moves the origin down to 0.
+ */
+class TimeSeries {
+public:
+  static constexpr int kBuckets = 240;
+  static constexpr qint64 kBaseWidthMs = 1000;
+  /** The first kBaseWidthMs * 2^n for which kBuckets buckets span 2^63. */
+  static constexpr qint64 kMaxWidthMs = kBaseWidthMs << 46;
+
+  void add(qint64 timestamp, quint64 count = 1);
+  void merge(const TimeSeries &other);
+
+  bool isEmpty() const { return m_counts.empty(); }
+  qint64 origin() const { return m_origin; }
+  qint64 width() const { return m_width; }
+  /** Buckets from origin() up to the last non-empty one. */
+  int bucketCount() const;
+  quint64 count(int bucket) const { return m_counts[static_cast<std::size_t>(bucket)]; }
+
+private:
+  void widen();
+  static qint64 alignDown(qint64 timestamp, qint64 width);
+
+  std::vector<quint64> m_counts;
+  qint64 m_origin = 0;
+  qint64 m_width = kBaseWidthMs;
+};
+
+} // namespace kafka
@@ -0,0 +1,151 @@
+#include "core/stats/TopicStats.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <utility>
+
+#include "core/protocol/RecordBatch.h"
+
+namespace kafka {
+
+void StatsSketch::add(qint32 partition, const Record &record) {
+  const auto size = static_cast<quint64>(record.encoded.size());
+  m_sizes.add(size);
+  if (record.timestamp >= 0)
+    m_throughput.add(record.timestamp);
+
+  PartitionStats &stats = partitionStats(partition);
+  ++stats.records;
+  stats.bytes += size;
+  if (record.timestamp >= 0) {
+    if (stats.firstTimestamp < 0 || record.timestamp < stats.firstTimestamp)
+      stats.firstTimestamp = record.timestamp;
+    stats.lastTimestamp = std::max(stats.lastTimestamp, qint64(record.timestamp));
+  }
+
+  if (!record.key.data()) {
+    ++m_nullKeys;
+    ++stats.nullKeys;
+    return;
+  }
+  const quint64 hash = sketchHash(record.key);
+  m_keys.add(hash);
+  m_hotKeys.add(hash, record.key, m_keyCounts.add(hash));
+}
+
+PartitionStats &StatsSketch::partitionStats(qint32 partition) {
+  if (m_lastPartition < m_partitions.size() &&
+      m_partitions[m_lastPartition].partition == partition)
+    return m_partitions[m_lastPartition];
+  auto it = std::lower_bound(
+      m_partitions.begin(), m_partitions.end(), partition,
+      [](const PartitionStats &stats, qint32 value) { return stats.partition < value; });
+  if (it == m_partitions.end() || it->partition != partition) {
+    PartitionStats stats;
+    stats.partition = partition;
+    it = m_partitions.insert(it, stats);
+  }
+  m_lastPartition = static_cast<std::size_t>(it - m_partitions.begin());
+  return *it;
+}
+
+void StatsSketch::merge(const StatsSketch &other) {
+  m_keys.merge(other.m_keys);
+  m_keyCounts.merge(other.m_keyCounts);
+  // Recounted against the merged frequencies, so this goes after them.
+  m_hotKeys.merge(other.m_hotKeys, m_keyCounts);
+  m_sizes.merge(other.m_sizes);
+  m_throughput.merge(other.m_throughput);
+  m_nullKeys += other.m_nullKeys;
+  for (const PartitionStats &theirs : other.m_partitions) {
+    PartitionStats &ours = partitionStats(theirs.partition);
+    ours.records += theirs.records;
+    ours.bytes += theirs.bytes;
+    ours.nullKeys += theirs.nullKeys;
+    if (theirs.firstTimestamp >= 0 &&
+        (ours.firstTimestamp < 0 || theirs.firstTimestamp < ours.firstTimestamp))
+      ours.firstTimestamp = theirs.firstTimestamp;
+    ours.lastTimestamp = std::max(ours.lastTimestamp, theirs.lastTimestamp);
+  }
+}
+
+std::size_t StatsSketch::footprint() {
+  return std::size_t(HyperLogLog::kRegisters) +
+         std::size_t(CountMinSketch::kDepth) * CountMinSketch::kWidth * sizeof(quint64) +
+         std::size_t(HeavyHitters::kCapacity) *
+             (sizeof(HeavyHitters::Entry) + HeavyHitters::kMaxKeyBytes) +
+         std::size_t(SizeHistogram::kBuckets) * sizeof(quint64) +
+         std::size_t(TimeSeries::kBuckets) * sizeof(quint64);
+}
+
+// Worker sketches are folded in here as each worker finishes.
+struct TopicStats::Merged {
+  QMutex mutex;
+  std::shared_ptr<StatsSketch> sketch;
+  int workers = 0;
+};
+
+class TopicStats::Worker final : public SliceScan::Worker {
+public:
+  explicit Worker(std::shared_ptr<Merged> merged)
+      : m_merged(std::move(merged)), m_sketch(std::make_shared<StatsSketch>()) {}
+
+  bool add(int, qint32 partition, const Record &record) override {
+    m_sketch->add(partition, record);
+    return true;
+  }
+
+  void done() override {
+    QMutexLocker locker(&m_merged->mutex);
+    if (m_merged->sketch)
+      m_merged->sketch->merge(*m_sketch);
+    else
+      m_merged->sketch = std::move(m_sketch);
+    ++m_merged->workers;
+  }
+
+private:
+  std::shared_ptr<Merged> m_merged;
+  std::shared_ptr<StatsSketch> m_sketch;
+};
+
+TopicStats::TopicStats(QObject *parent)
+    : QObject(parent),
+      m_scan(
+          this, QStringLiteral("kafka-stats"), "stats worker",
+          [this](qint64 scanned, qint64 total) { emit progressChanged(scanned, total); },
+          [this]() { finish(); }) {}
+
+void TopicStats::start(std::shared_ptr<BatchSource> source, const QVector<qint32> &partitions,
+                       qint64 from, qint64 to) {
+  cancel();
+  if (!source || partitions.isEmpty())
+    return;
+
+  m_merged = std::make_shared<Merged>();
+  m_workers = 0;
+  m_result.reset();
+  SliceScan::Request request;
+  request.targets.append({QString(), std::move(source), partitions});
+  request.from = from;
+  request.to = to;
+  m_scan.start(std::move(request),
+               [merged = m_merged]() { return std::make_unique<Worker>(merged); });
+}
+
+void TopicStats::cancel() { m_scan.cancel(); }
+
+// Runs on the GUI thread. A scan that was neither cancelled nor failed
+// ends only after every worker merged its sketch.
+void TopicStats::finish() {
+  if (!m_scan.wasCancelled() && m_scan.errorString().isEmpty()) {
+    QMutexLocker locker(&m_merged->mutex);
+    m_result = m_merged->sketch ? m_merged->sketch : std::make_shared<StatsSketch>();
+    m_workers = m_merged->workers;
+  }
+  emit finished();
+}
+
+} // namespace kafka
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+#include "core/scan/SliceScan.h"
+#include "core/stats/Sketches.h"
+
+namespace kafka {
+
+class BatchSource;
+struct Record;
+
+/** Exact per-partition counters of a TopicStats scan. */
+struct PartitionStats {
+  qint32 partition = 0;
+  quint64 records = 0;
+  quint64 bytes = 0;
+  quint64 nullKeys = 0;
+  /** Lowest and highest record timestamp; -1 when none was seen. */
+  qint64 firstTimestamp = -1;
+  qint64 lastTimestamp = -1;
+};
+
+/**
+ * @brief Everything TopicStats learns about a stream of records, in
+ * memory that does not grow with the number of records: key cardinality
+ * (HyperLogLog), key frequencies (Count-Min) and the heaviest keys, a size
+ * histogram, records over time, and exact counters per partition.
+ *
+ * Each worker fills its own; merge() combines them.
+ */
+class StatsSketch {
+public:
+  void add(qint32 partition, const Record &record);
+  void merge(const StatsSketch &other);
+
+  quint64 records() const { return m_sizes.total(); }
+  quint64 bytes() const { return m_sizes.sum(); }
+  quint64 nullKeys() const { return m_nullKeys; }
+  double distinctKeys() const { return m_keys.estimate(); }
+  /** Estimated record count of @p key; never below the true count. */
+  quint64 keyCount(std::string_view key) const { return m_keyCounts.estimate(sketchHash(key)); }
+  std::vector<HeavyHitters::Entry> hotKeys() const { return m_hotKeys.entries(); }
+  const SizeHistogram &sizes() const { return m_sizes; }
+  const TimeSeries &throughput() const { return m_throughput; }
+  /** Sorted by partition. */
+  const std::vector<PartitionStats> &partitions() const { return m_partitions; }
+
+  /** Memory held by the sketches, which stays the same for any input. */
+  static std::size_t footprint();
+
+private:
+  PartitionStats &partitionStats(qint32 partition);
+
+  HyperLogLog m_keys;
+  CountMinSketch m_keyCounts;
+  HeavyHitters m_hotKeys;
+  SizeHistogram m_sizes;
+  TimeSeries m_throughput;
+  quint64 m_nullKeys = 0;
+  std::vector<PartitionStats> m_partitions;
+  // Slices cover one partition each, so the last lookup usually hits.
+  std::size_t m_lastPartition = 0;
+};
+
+/**
+ * @brief Profiles a range of records of a set of partitions on worker
+ * threads.
+ *
+ * Runs on a SliceScan, as TopicSearch does. Each worker feeds a
+ * StatsSketch of its own, without locks, and the sketches are merged as
+ * the workers finish, so
+ * memory stays at one sketch per worker however many records there are.
+ * The merged sketch is available from result() once finished() reports a
+ * scan that was not cancelled.
+ */
+class TopicStats final : public QObject {
+  Q_OBJECT
+
+public:
+  explicit TopicStats(QObject *parent = nullptr);
+
+  /**
+   * @brief Profiles @p partitions of @p source between the times @p from
+   * and @p to (ms since epoch; -1 for the partition's start or end).
+   */
+  void start(std::shared_ptr<BatchSource> source, const QVector<qint32> &partitions,
+             qint64 from, qint64 to);
+  void cancel();
+
+  bool isRunning() const { return m_scan.isRunning(); }
+  /** Valid after finished(). */
+  bool wasCancelled() const { return m_scan.wasCancelled(); }
+  QString errorString() const { return m_scan.errorString(); }
+  /** Compressed batches that could not be inflated and were skipped. */
+  qint64 skippedBatches() const { return m_scan.skippedBatches(); }
+  /** Number of worker sketches merged into result(). */
+  int workerCount() const { return m_workers; }
+  /** The merged sketch of the last completed scan, or null. */
+  std::shared_ptr<const StatsSketch> result() const { return m_result; }
+
+signals:
+  /** Offsets scanned so far out of @p total across all partitions. */
+  void progressChanged(qint64 scanned, qint64 total);
+  void finished();
+
+private:
+  class Worker;
+  struct Merged;
+
+  void finish();
+
+  std::shared_ptr<Merged> m_merged;
+  int m_workers = 0;
+  std::shared_ptr<const StatsSketch> m_result;
+  // Last, so the workers stop before anything else goes.
+  SliceScan m_scan;
+};
+
+} // namespace kafka
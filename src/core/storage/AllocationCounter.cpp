@@ -0,0 +1,56 @@
+#include "core/storage/AllocationCounter.h"
+
+#ifdef KAFKA_VIEWER_COUNT_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+
+namespace {
+thread_local quint64 t_allocations = 0;
+
+void *countedAllocate(std::size_t size) {
+  ++t_allocations;
+  if (void *p = std::malloc(size > 0 ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+} // namespace
+
+// Aligned overloads are left to the runtime; nothing on the record path
+// uses over-aligned types.
+void *operator new(std::size_t size) { return countedAllocate(size); }
+void *operator new[](std::size_t size) { return countedAllocate(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  ++t_allocations;
+  return std::malloc(size > 0 ? size : 1);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  ++t_allocations;
+  return std::malloc(size > 0 ? size : 1);
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { std::free(p); }
+#endif
+
+namespace kafka {
+
+bool AllocationCounter::isEnabled() {
+#ifdef KAFKA_VIEWER_COUNT_ALLOCATIONS
+  return true;
+#else
+  return false;
+#endif
+}
+
+quint64 AllocationCounter::threadAllocations() {
+#ifdef KAFKA_VIEWER_COUNT_ALLOCATIONS
+  return t_allocations;
+#else
+  return 0;
+#endif
+}
+
+} // namespace kafka
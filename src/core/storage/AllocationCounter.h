@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QtGlobal>
+
+namespace kafka {
+
+/**
+ * @brief Heap allocations made by the calling thread.
+ *
+ * Counting replaces the global operator new and is only compiled in with
+ * the KAFKA_VIEWER_COUNT_ALLOCATIONS CMake option; otherwise isEnabled()
+ * is false and every count is zero.
+ */
+class AllocationCounter {
+public:
+  static bool isEnabled();
+  static quint64 threadAllocations();
+};
+
+/**
+ * @brief Allocations made by this thread since construction.
+ */
+class AllocationScope {
+public:
+  AllocationScope() : m_start(AllocationCounter::threadAllocations()) {}
+
+  quint64 count() const { return AllocationCounter::threadAllocations() - m_start; }
+
+private:
+  quint64 m_start = 0;
+};
+
+} // namespace kafka
@@ -0,0 +1,73 @@
+#include "core/storage/RecordArena.h"
+
+#include <algorithm>
+
+namespace kafka {
+
+namespace {
+// A page rarely spans more than a read chunk and a few compressed batches.
+constexpr std::size_t kExpectedOwners = 8;
+} // namespace
+
+RecordArena::RecordArena(qint64 firstOffset, qint64 endOffset)
+    : m_firstOffset(firstOffset),
+      m_slots(static_cast<std::size_t>(std::max<qint64>(0, endOffset - firstOffset))) {
+  m_owners.reserve(kExpectedOwners);
+}
+
+Record RecordArena::record(qint64 offset) const {
+  const Slot &slot = at(offset);
+  Record record;
+  record.offset = offset;
+  record.timestamp = slot.timestamp;
+  record.key = slot.key;
+  record.value = slot.value;
+  record.headers = slot.headers;
+  record.headerCount = slot.headerCount;
+  return record;
+}
+
+void RecordArena::retain(std::shared_ptr<const void> owner, std::size_t bytes) {
+  if (!owner)
+    return;
+  // Consecutive batches of one chunk share their owner.
+  if (!m_owners.empty() && m_owners.back() == owner)
+    return;
+  m_owners.push_back(std::move(owner));
+  m_retainedBytes += bytes;
+}
+
+void RecordArena::store(const Record &record, bool corrupt) {
+  if (!contains(record.offset))
+    return;
+  Slot &slot = m_slots[static_cast<std::size_t>(record.offset - m_firstOffset)];
+  if (!slot.has(Present))
+    ++m_recordCount;
+  slot.key = record.key;
+  slot.value = record.value;
+  slot.headers = record.headers;
+  slot.timestamp = record.timestamp;
+  slot.size = static_cast<qint32>(record.encoded.size());
+  slot.headerCount = record.headerCount;
+  slot.flags = Present;
+  if (record.key.data() == nullptr)
+    slot.flags |= KeyNull;
+  if (record.value.data() == nullptr)
+    slot.flags |= ValueNull;
+  if (corrupt)
+    slot.flags |= Corrupt;
+}
+
+void RecordArena::markUndecodable(qint64 first, qint64 last) {
+  first = std::max(first, m_firstOffset);
+  last = std::min(last, endOffset());
+  for (qint64 offset = first; offset < last; ++offset)
+    m_slots[static_cast<std::size_t>(offset - m_firstOffset)].flags |= Undecodable;
+}
+
+qint64 RecordArena::bytes() const {
+  return static_cast<qint64>(sizeof(*this) + m_slots.capacity() * sizeof(Slot) +
+                             m_owners.capacity() * sizeof(m_owners[0]) + m_retainedBytes);
+}
+
+} // namespace kafka
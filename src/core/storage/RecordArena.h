@@ -0,0 +1,81 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "core/protocol/RecordBatch.h"
+
+namespace kafka {
+
+/**
+ * @brief The records of a contiguous offset range, stored as views into
+ * the buffers they were parsed from.
+ *
+ * The arena pins every buffer its records point into (fetch frames,
+ * mapped segments, decoded batches) and releases them together, so a
+ * record costs one fixed-size slot and no allocation of its own. Text for
+ * display is built from the views by whoever shows it.
+ */
+class RecordArena {
+public:
+  enum Flag : quint8 {
+    Present = 1 << 0,
+    KeyNull = 1 << 1,
+    ValueNull = 1 << 2,
+    Corrupt = 1 << 3,
+    Undecodable = 1 << 4,
+  };
+
+  struct Slot {
+    std::string_view key;
+    std::string_view value;
+    /** Encoded header section; walk it with HeaderReader via record(). */
+    std::string_view headers;
+    qint64 timestamp = 0;
+    qint32 size = 0;
+    qint32 headerCount = 0;
+    quint8 flags = 0;
+
+    bool has(Flag flag) const { return (flags & flag) != 0; }
+  };
+
+  /** Reserves one slot per offset in [firstOffset, endOffset). */
+  RecordArena(qint64 firstOffset, qint64 endOffset);
+
+  qint64 firstOffset() const { return m_firstOffset; }
+  qint64 endOffset() const { return m_firstOffset + static_cast<qint64>(m_slots.size()); }
+  bool contains(qint64 offset) const { return offset >= m_firstOffset && offset < endOffset(); }
+
+  const Slot &at(qint64 offset) const {
+    return m_slots[static_cast<std::size_t>(offset - m_firstOffset)];
+  }
+  /** The slot at @p offset as a Record, e.g. for HeaderReader. */
+  Record record(qint64 offset) const;
+
+  /**
+   * @brief Keeps @p owner alive as long as the arena. Views passed to
+   * store() must point into a retained buffer; @p bytes is its size, for
+   * bytes().
+   */
+  void retain(std::shared_ptr<const void> owner, std::size_t bytes);
+  /** Stores @p record in its offset's slot; offsets outside are ignored. */
+  void store(const Record &record, bool corrupt);
+  /** Flags [first, last) as belonging to a batch that could not be read. */
+  void markUndecodable(qint64 first, qint64 last);
+
+  qint32 recordCount() const { return m_recordCount; }
+  /** Slots plus retained buffers. */
+  qint64 bytes() const;
+
+private:
+  qint64 m_firstOffset = 0;
+  std::vector<Slot> m_slots;
+  std::vector<std::shared_ptr<const void>> m_owners;
+  std::size_t m_retainedBytes = 0;
+  qint32 m_recordCount = 0;
+};
+
+} // namespace kafka
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace kafka {
+
+/**
+ * @brief Bounded lock-free queue for exactly one producer thread and one
+ * consumer thread.
+ *
+ * Each side owns one index and only reads the other's, so a push or pop is
+ * one acquire load and one release store; the other side's index is cached
+ * and reloaded only when the queue looks full (or empty). Both indices run
+ * freely and are masked, so the capacity is rounded up to a power of two.
+ * tryPush() fails instead of waiting when the queue is full; what to do
+ * with the element is the producer's call.
+ */
+template <typename T> class SpscQueue {
+public:
+  explicit SpscQueue(std::size_t capacity)
+      : m_slots(roundUp(capacity)), m_mask(m_slots.size() - 1) {}
+
+  SpscQueue(const SpscQueue &) = delete;
+  SpscQueue &operator=(const SpscQueue &) = delete;
+
+  std::size_t capacity() const { return m_slots.size(); }
+
+  /** Producer thread only. */
+  bool tryPush(T &&value) {
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_producerHead == m_slots.size()) {
+      m_producerHead = m_head.load(std::memory_order_acquire);
+      if (tail - m_producerHead == m_slots.size())
+        return false;
+    }
+    m_slots[tail & m_mask] = std::move(value);
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** Consumer thread only. */
+  bool tryPop(T *value) {
+    const std::size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_consumerTail) {
+      m_consumerTail = m_tail.load(std::memory_order_acquire);
+      if (head == m_consumerTail)
+        return false;
+    }
+    *value = std::move(m_slots[head & m_mask]);
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** Exact only on a side's own thread while the other is idle. */
+  std::size_t sizeApprox() const {
+    return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+  }
+
+private:
+  static std::size_t roundUp(std::size_t capacity) {
+    std::size_t size = 1;
+    while (size < capacity)
+      size <<= 1;
+    return size;
+  }
+
+  // Producer and consumer state on separate cache lines, so neither side's
+  // writes invalidate the line the other keeps reading.
+  static constexpr std::size_t kCacheLine = 64;
+
+  std::vector<T> m_slots;
+  const std::size_t m_mask;
+  alignas(kCacheLine) std::atomic<std::size_t> m_head{0};
+  std::size_t m_consumerTail = 0;
+  alignas(kCacheLine) std::atomic<std::size_t> m_tail{0};
+  std::size_t m_producerHead = 0;
+};
+
+} // namespace kafka
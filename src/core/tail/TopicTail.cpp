@@ -0,0 +1,189 @@
+#include "core/tail/TopicTail.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <atomic>
+
+#include "core/codec/DecodedBatchCache.h"
+#include "core/protocol/ApiKeys.h"
+#include "core/protocol/RecordBatch.h"
+#include "core/scan/BatchWalk.h"
+#include "core/source/BatchSource.h"
+#include "core/storage/SpscQueue.h"
+
+namespace kafka {
+
+namespace {
+constexpr qint32 kReadBytes = 1024 * 1024;
+// A broker fetch already waits for data; these only pace sources that
+// answer an empty read at once, like a log directory.
+constexpr unsigned long kIdleSleepMs = 50;
+constexpr unsigned long kErrorSleepMs = 1000;
+} // namespace
+
+struct TopicTail::Run {
+  std::shared_ptr<BatchSource> source;
+  QVector<qint32> partitions;
+  SpscQueue<TailRecord> queue{kQueueCapacity};
+  std::atomic<bool> stop{false};
+  std::atomic<quint64> dropped{0};
+  mutable QMutex errorMutex;
+  QString error;
+
+  /**
+   * A failed round stands for every partition; otherwise the first
+   * partition still failing does, and none failing clears the error.
+   */
+  void setError(const QString &roundError, const QVector<QString> &partitionErrors) {
+    QString message = roundError;
+    for (int i = 0; message.isEmpty() && i < partitionErrors.size(); ++i)
+      message = partitionErrors[i];
+    QMutexLocker locker(&errorMutex);
+    error = message;
+  }
+};
+
+TopicTail::TopicTail() { m_pool.setObjectName(QStringLiteral("kafka-topic-tail")); }
+
+TopicTail::~TopicTail() {
+  stop();
+  m_pool.waitForDone();
+}
+
+void TopicTail::start(std::shared_ptr<BatchSource> source, const QVector<qint32> &partitions) {
+  stop();
+  if (!source || partitions.isEmpty())
+    return;
+
+  auto tail = std::make_shared<Run>();
+  tail->source = std::move(source);
+  tail->partitions = partitions;
+  m_run = tail;
+  m_pool.start([tail]() { run(tail); });
+}
+
+void TopicTail::stop() {
+  if (!m_run)
+    return;
+  m_run->stop.store(true);
+  m_run.reset();
+}
+
+bool TopicTail::pop(TailRecord *record) { return m_run && m_run->queue.tryPop(record); }
+
+quint64 TopicTail::droppedCount() const { return m_run ? m_run->dropped.load() : 0; }
+
+QString TopicTail::errorString() const {
+  if (!m_run)
+    return QString();
+  QMutexLocker locker(&m_run->errorMutex);
+  return m_run->error;
+}
+
+void TopicTail::run(const std::shared_ptr<Run> &tail) {
+  BatchSource &source = *tail->source;
+  const std::unique_ptr<BatchPoller> poller = source.createPoller();
+  const int partitionCount = tail->partitions.size();
+  // Next offset to read per partition; -1 until its end offset is known.
+  QVector<qint64> next(partitionCount, -1);
+  QVector<PollTarget> targets;
+  QVector<int> targetIndex;
+  QVector<BatchChunk> chunks;
+  // Each partition's last error, so one that reads fine does not hide
+  // another that keeps failing.
+  QVector<QString> errors(partitionCount);
+
+  while (!tail->stop.load()) {
+    bool received = false;
+    bool failed = false;
+    targets.clear();
+    targetIndex.clear();
+    for (int i = 0; i < partitionCount && !tail->stop.load(); ++i) {
+      if (next[i] < 0) {
+        OffsetRange range;
+        if (!source.offsetRange(tail->partitions[i], &range, &errors[i])) {
+          failed = true;
+          continue;
+        }
+        next[i] = range.end;
+      }
+      targets.append(PollTarget{tail->partitions[i], next[i], kReadBytes});
+      targetIndex.append(i);
+    }
+
+    // One poll covers every partition, so a source that can read many at
+    // once (a broker, through a fetch session) does.
+    QString roundError;
+    if (!targets.isEmpty() && !tail->stop.load() &&
+        !poller->poll(targets, &chunks, &roundError)) {
+      failed = true;
+      chunks.clear();
+    } else {
+      roundError.clear();
+    }
+
+    for (int t = 0; t < chunks.size() && t < targets.size() && !tail->stop.load(); ++t) {
+      const int i = targetIndex[t];
+      const qint32 partition = tail->partitions[i];
+      const BatchChunk &chunk = chunks[t];
+      if (chunk.errorCode != 0) {
+        // The poll's own message may be about another partition.
+        errors[i] = QStringLiteral("Partition %1: error %2 (%3)")
+                        .arg(partition)
+                        .arg(chunk.errorCode)
+                        .arg(QLatin1String(errorName(chunk.errorCode)));
+        failed = true;
+        // Retention may have moved past us; resume from the end again.
+        next[i] = -1;
+        continue;
+      }
+      errors[i].clear();
+      if (chunk.isEmpty())
+        continue;
+
+      BatchReader batches(chunk.bytes);
+      RecordBatch batch;
+      while (batches.next(batch) == ParseStatus::Ok) {
+        if (batch.nextOffset() <= next[i])
+          continue;
+        const qint64 readFrom = next[i];
+        next[i] = batch.nextOffset();
+        received = true;
+        if (batch.isControl())
+          continue;
+
+        std::shared_ptr<const DecodedBatch> decoded;
+        std::string_view section;
+        if (!recordsOf(batch, &decoded, &section))
+          continue;
+
+        RecordReader records(batch, section);
+        Record record;
+        while (records.next(record)) {
+          if (record.offset < readFrom)
+            continue;
+          TailRecord tailed;
+          tailed.partition = partition;
+          tailed.offset = record.offset;
+          tailed.timestamp = record.timestamp;
+          tailed.size = static_cast<qint32>(record.encoded.size());
+          tailed.key = copyOf(record.key, record.key.size());
+          tailed.value = copyOf(record.value, kMaxValueBytes);
+          tailed.valueTruncated = record.value.size() > static_cast<std::size_t>(kMaxValueBytes);
+          if (!tail->queue.tryPush(std::move(tailed)))
+            tail->dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    }
+    chunks.clear();
+    tail->setError(roundError, errors);
+    if (failed)
+      QThread::msleep(kErrorSleepMs);
+    else if (!received)
+      QThread::msleep(kIdleSleepMs);
+  }
+}
+
+} // namespace kafka
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+#include <memory>
+
+namespace kafka {
+
+class BatchSource;
+
+/**
+ * @brief A record received while tailing, copied out of its fetch buffer.
+ *
+ * Values longer than TopicTail::kMaxValueBytes are cut; @c size keeps the
+ * size of the whole record. A null key or value is a null QByteArray.
+ */
+struct TailRecord {
+  qint32 partition = 0;
+  qint64 offset = 0;
+  qint64 timestamp = 0;
+  qint32 size = 0;
+  QByteArray key;
+  QByteArray value;
+  bool valueTruncated = false;
+};
+
+/**
+ * @brief Follows the end of a set of partitions on one worker thread.
+ *
+ * The worker polls all partitions at once from their end offsets at
+ * start(), through a BatchPoller of the source, and pushes each new record
+ * into a lock-free single-producer, single-consumer queue; the owner's
+ * thread is the only consumer and pops whenever it likes, typically once
+ * per display frame. The worker never
+ * waits for the consumer: a record arriving while the queue is full is
+ * dropped and counted.
+ *
+ * Every start() gets a queue of its own, so a worker that has not yet
+ * noticed stop() keeps pushing into a queue nobody reads instead of
+ * becoming a second producer.
+ */
+class TopicTail {
+public:
+  static constexpr std::size_t kQueueCapacity = std::size_t(1) << 16;
+  static constexpr int kMaxValueBytes = 1024;
+
+  TopicTail();
+  /** Stops the worker and waits for it. */
+  ~TopicTail();
+
+  TopicTail(const TopicTail &) = delete;
+  TopicTail &operator=(const TopicTail &) = delete;
+
+  void start(std::shared_ptr<BatchSource> source, const QVector<qint32> &partitions);
+  void stop();
+  bool isRunning() const { return m_run != nullptr; }
+
+  /** Pops the next record; consumer thread only. */
+  bool pop(TailRecord *record);
+  /** Records dropped because the queue was full. */
+  quint64 droppedCount() const;
+  /**
+   * The last read error: that of a failed poll, else that of the first
+   * partition still failing. Cleared once every partition reads again.
+   */
+  QString errorString() const;
+
+private:
+  struct Run;
+
+  static void run(const std::shared_ptr<Run> &run);
+
+  QThreadPool m_pool;
+  std::shared_ptr<Run> m_run;
+};
+
+} // namespace kafka
@@ -0,0 +1,296 @@
+#include "core/trace/Trace.h"
+
+#include <QCoreApplication>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace kafka {
+
+std::atomic<bool> Trace::s_enabled{false};
+
+namespace {
+constexpr quint64 kEventMask = Trace::kEventsPerThread - 1;
+static_assert((Trace::kEventsPerThread & (Trace::kEventsPerThread - 1)) == 0,
+              "the ring index is masked");
+
+struct Event {
+  const char *name = nullptr;
+  qint64 startNs = 0;
+  qint64 durationNs = 0;
+  qint64 value = 0;
+  // 'X' for a span, 'C' for a counter sample.
+  char phase = 'X';
+};
+
+// An Event the exporter may read while its thread overwrites it. Relaxed
+// accesses cost what plain ones do; the fences in push() and snapshot()
+// tell a torn copy from a good one.
+struct Slot {
+  std::atomic<const char *> name{nullptr};
+  std::atomic<qint64> startNs{0};
+  std::atomic<qint64> durationNs{0};
+  std::atomic<qint64> value{0};
+  std::atomic<char> phase{'X'};
+
+  void store(const Event &event) {
+    name.store(event.name, std::memory_order_relaxed);
+    startNs.store(event.startNs, std::memory_order_relaxed);
+    durationNs.store(event.durationNs, std::memory_order_relaxed);
+    value.store(event.value, std::memory_order_relaxed);
+    phase.store(event.phase, std::memory_order_relaxed);
+  }
+
+  Event load() const {
+    Event event;
+    event.name = name.load(std::memory_order_relaxed);
+    event.startNs = startNs.load(std::memory_order_relaxed);
+    event.durationNs = durationNs.load(std::memory_order_relaxed);
+    event.value = value.load(std::memory_order_relaxed);
+    event.phase = phase.load(std::memory_order_relaxed);
+    return event;
+  }
+};
+
+// The thread a buffer records for from event @c from on.
+struct Track {
+  quint64 from = 0;
+  int threadId = 0;
+  QString threadName;
+};
+
+// Written by its thread only. head counts every event ever pushed; the
+// slot of event i is i & kEventMask.
+struct ThreadBuffer {
+  std::unique_ptr<Slot[]> ring{new Slot[Trace::kEventsPerThread]};
+  std::atomic<quint64> head{0};
+  // Guarded by the registry mutex; a buffer taken over by a new thread
+  // starts a track, so earlier events keep the name of the thread that
+  // recorded them.
+  std::vector<Track> tracks;
+
+  void push(const Event &event) {
+    const quint64 index = head.load(std::memory_order_relaxed);
+    // Orders the previous head store before the overwrite below, so an
+    // exporter that copies the new event also sees head at least at index.
+    std::atomic_thread_fence(std::memory_order_release);
+    ring[index & kEventMask].store(event);
+    head.store(index + 1, std::memory_order_release);
+  }
+};
+
+// Buffers outlive their threads so an export still shows pool threads
+// that have since expired; a new thread takes over a free buffer instead
+// of growing the registry.
+struct Registry {
+  QMutex mutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  std::vector<ThreadBuffer *> free;
+  int nextThreadId = 1;
+  std::atomic<qint64> since{0};
+};
+
+Registry &registry() {
+  static Registry instance;
+  return instance;
+}
+
+struct ThreadSlot {
+  ThreadBuffer *buffer = nullptr;
+
+  ~ThreadSlot() {
+    if (!buffer)
+      return;
+    Registry &shared = registry();
+    QMutexLocker locker(&shared.mutex);
+    shared.free.push_back(buffer);
+  }
+};
+
+thread_local ThreadSlot t_slot;
+
+QString currentThreadName(int id) {
+  QThread *thread = QThread::currentThread();
+  if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+    return QStringLiteral("Main thread");
+  const QString name = thread ? thread->objectName() : QString();
+  return QStringLiteral("%1 #%2").arg(name.isEmpty() ? QStringLiteral("Thread") : name).arg(id);
+}
+
+ThreadBuffer &threadBuffer() {
+  if (t_slot.buffer)
+    return *t_slot.buffer;
+
+  Registry &shared = registry();
+  QMutexLocker locker(&shared.mutex);
+  if (!shared.free.empty()) {
+    t_slot.buffer = shared.free.back();
+    shared.free.pop_back();
+  } else {
+    auto buffer = std::make_shared<ThreadBuffer>();
+    t_slot.buffer = buffer.get();
+    shared.buffers.push_back(std::move(buffer));
+  }
+  ThreadBuffer &buffer = *t_slot.buffer;
+  const quint64 head = buffer.head.load(std::memory_order_relaxed);
+  // Tracks whose events have all been overwritten have nothing to show.
+  const quint64 capacity = Trace::kEventsPerThread;
+  const quint64 kept = head > capacity ? head - capacity : 0;
+  while (!buffer.tracks.empty() &&
+         (buffer.tracks.size() == 1 ? head : buffer.tracks[1].from) <= kept)
+    buffer.tracks.erase(buffer.tracks.begin());
+  const int id = shared.nextThreadId++;
+  buffer.tracks.push_back(Track{head, id, currentThreadName(id)});
+  return buffer;
+}
+
+// Copies the events of @p buffer that were not overwritten while copying;
+// *first is the index of the first one.
+std::vector<Event> snapshot(const ThreadBuffer &buffer, quint64 *first) {
+  const quint64 head = buffer.head.load(std::memory_order_acquire);
+  const quint64 capacity = Trace::kEventsPerThread;
+  *first = head > capacity ? head - capacity : 0;
+  std::vector<Event> events;
+  events.reserve(static_cast<std::size_t>(head - *first));
+  for (quint64 i = *first; i < head; ++i)
+    events.push_back(buffer.ring[i & kEventMask].load());
+
+  // Pairs with the fence in push(): if a copy above read any part of an
+  // event pushed meanwhile, the head read below counts that push. The
+  // writer may also be writing the slot after that head, which holds the
+  // event one capacity earlier.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const quint64 after = buffer.head.load(std::memory_order_relaxed);
+  const quint64 valid = after + 1 > capacity ? after + 1 - capacity : 0;
+  if (valid > *first) {
+    const quint64 dropped = qMin(valid, head) - *first;
+    events.erase(events.begin(), events.begin() + static_cast<std::ptrdiff_t>(dropped));
+    *first += dropped;
+  }
+  return events;
+}
+
+void appendJsonString(QByteArray &out, const QString &text) {
+  out += '"';
+  for (QChar ch : text) {
+    if (ch == QLatin1Char('"') || ch == QLatin1Char('\\')) {
+      out += '\\';
+      out += static_cast<char>(ch.unicode());
+    } else if (ch.unicode() < 0x20) {
+      out += ' ';
+    } else {
+      out += QString(ch).toUtf8();
+    }
+  }
+  out += '"';
+}
+
+QByteArray microseconds(qint64 ns) { return QByteArray::number(double(ns) / 1000.0, 'f', 3); }
+} // namespace
+
+void Trace::setEnabled(bool enabled) {
+  if (enabled && !isEnabled())
+    registry().since.store(now(), std::memory_order_relaxed);
+  s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+qint64 Trace::now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Trace::complete(const char *name, qint64 startNs) {
+  Event event;
+  event.name = name;
+  event.startNs = startNs;
+  event.durationNs = now() - startNs;
+  event.phase = 'X';
+  threadBuffer().push(event);
+}
+
+void Trace::counter(const char *name, qint64 value) {
+  Event event;
+  event.name = name;
+  event.startNs = now();
+  event.value = value;
+  event.phase = 'C';
+  threadBuffer().push(event);
+}
+
+bool Trace::writeChromeJson(const QString &path, QString *error) {
+  Registry &shared = registry();
+  const qint64 since = shared.since.load(std::memory_order_relaxed);
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    QMutexLocker locker(&shared.mutex);
+    buffers = shared.buffers;
+  }
+
+  QByteArray out;
+  out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  auto beginEvent = [&]() {
+    if (!first)
+      out += ",\n";
+    first = false;
+  };
+  for (const std::shared_ptr<ThreadBuffer> &buffer : buffers) {
+    quint64 index = 0;
+    const std::vector<Event> events = snapshot(*buffer, &index);
+    // Read after the events, so a thread that took the buffer over
+    // meanwhile has its track already.
+    std::vector<Track> tracks;
+    {
+      QMutexLocker locker(&shared.mutex);
+      tracks = buffer->tracks;
+    }
+    for (const Track &track : tracks) {
+      beginEvent();
+      out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" +
+             QByteArray::number(track.threadId) + ",\"args\":{\"name\":";
+      appendJsonString(out, track.threadName);
+      out += "}}";
+    }
+
+    std::size_t t = 0;
+    for (const Event &event : events) {
+      const quint64 eventIndex = index++;
+      while (t + 1 < tracks.size() && tracks[t + 1].from <= eventIndex)
+        ++t;
+      // Older than every track: overwritten since, and its track dropped.
+      if (tracks.empty() || eventIndex < tracks[t].from)
+        continue;
+      if (!event.name || event.startNs < since)
+        continue;
+      const QByteArray tid = QByteArray::number(tracks[t].threadId);
+      beginEvent();
+      // Names are literals from the code; they need no escaping.
+      out += "{\"name\":\"";
+      out += event.name;
+      out += "\",\"ph\":\"";
+      out += event.phase;
+      out += "\",\"pid\":1,\"tid\":" + tid + ",\"ts\":" + microseconds(event.startNs - since);
+      if (event.phase == 'X')
+        out += ",\"dur\":" + microseconds(event.durationNs) + "}";
+      else
+        out += ",\"args\":{\"value\":" + QByteArray::number(event.value) + "}}";
+    }
+  }
+  out += "]}\n";
+
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly) || file.write(out) != out.size() || !file.commit()) {
+    if (error)
+      *error = QStringLiteral("Cannot write %1: %2").arg(path, file.errorString());
+    return false;
+  }
+  return true;
+}
+
+} // namespace kafka
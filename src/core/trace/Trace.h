@@ -0,0 +1,80 @@
+#pragma once
+
+#include <QString>
+
+#include <atomic>
+
+namespace kafka {
+
+/**
+ * @brief Process-wide recorder of spans and counters, exported as Chrome
+ * trace-event JSON (chrome://tracing, Perfetto).
+ *
+ * Every thread records into a ring buffer of its own, allocated on its
+ * first event, so recording takes no lock and never waits for the
+ * exporter; a full buffer overwrites its oldest events. The exporter reads
+ * the buffers while they are written and drops the events that were
+ * overwritten during the copy.
+ *
+ * While disabled, a span or counter costs one relaxed atomic load. Names
+ * must be string literals without quotes or backslashes: only the pointer
+ * is stored, and the export writes them as is.
+ */
+class Trace {
+public:
+  /** Events each thread keeps (40 bytes each). */
+  static constexpr int kEventsPerThread = 1 << 15;
+
+  static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+  /**
+   * @brief Starts or stops recording. Starting drops whatever was
+   * recorded before, so an export covers one recording.
+   */
+  static void setEnabled(bool enabled);
+
+  /** Monotonic nanoseconds; the clock spans and counters are stamped with. */
+  static qint64 now();
+  /** Records a span of the calling thread that began at @p startNs and ends now. */
+  static void complete(const char *name, qint64 startNs);
+  static void counter(const char *name, qint64 value);
+
+  /** Writes what was recorded since recording started; see the class comment. */
+  static bool writeChromeJson(const QString &path, QString *error);
+
+private:
+  static std::atomic<bool> s_enabled;
+};
+
+/**
+ * @brief Records the lifetime of the scope as a span when tracing is on.
+ */
+class TraceScope {
+public:
+  explicit TraceScope(const char *name)
+      : m_name(name), m_start(Trace::isEnabled() ? Trace::now() : -1) {}
+  ~TraceScope() {
+    if (m_start >= 0)
+      Trace::complete(m_name, m_start);
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  const char *m_name;
+  qint64 m_start;
+};
+
+} // namespace kafka
+
+#define KAFKA_TRACE_CONCAT_(a, b) a##b
+#define KAFKA_TRACE_CONCAT(a, b) KAFKA_TRACE_CONCAT_(a, b)
+/** Traces the enclosing scope under @p name, a string literal. */
+#define KAFKA_TRACE_SCOPE(name) \
+  ::kafka::TraceScope KAFKA_TRACE_CONCAT(kafkaTraceScope, __LINE__)(name)
+/** Records @p value for the counter @p name, a string literal. */
+#define KAFKA_TRACE_COUNTER(name, value)                                     \
+  do {                                                                       \
+    if (::kafka::Trace::isEnabled())                                         \
+      ::kafka::Trace::counter(name, static_cast<qint64>(value));             \
+  } while (false)
@@ -1,5 +1,6 @@
 #include "ui/dialogs/AboutDialog.h"
 
+#include "app/Application.h"
 #include "ui/widgets/FlatButton.h"
 
 #include <QLabel>
@@ -10,7 +11,7 @@ AboutDialog::AboutDialog(QWidget *parent)
 {
     setWindowTitle(tr("About Kafka Viewer"));
     setModal(true);
-    setFixedSize(360, 220);
+    setFixedSize(360, 250);
 
     auto *layout = new QVBoxLayout(this);
     layout->setContentsMargins(24, 24, 24, 16);
@@ -28,6 +29,20 @@ AboutDialog::AboutDialog(QWidget *parent)
     auto *version = new QLabel(tr("Version 0.1.0"), this);
     version->setAlignment(Qt::AlignCenter);
 
+    // Measured by Application; kept here so a slow start or theme switch
+    // can be read off without a profiler.
+    auto *timings = new QLabel(this);
+    timings->setObjectName(QStringLiteral("AboutTimings"));
+    timings->setAlignment(Qt::AlignCenter);
+    if (auto *app = qobject_cast<Application *>(QApplication::instance())) {
+        const UiMetrics &metrics = app->metrics();
+        timings->setText(tr("Startup %1 ms · theme switch %2 ms (slowest %3 ms of %4)")
+                             .arg(metrics.startupMs)
+                             .arg(metrics.lastThemeSwitchMs)
+                             .arg(metrics.slowestThemeSwitchMs)
+                             .arg(metrics.themeSwitchCount));
+    }
+
     auto *closeButton = new FlatButton(tr("Close"), this);
     closeButton->setFixedWidth(100);
     connect(closeButton, &QPushButton::clicked, this, &QDialog::accept);
@@ -35,6 +50,7 @@ AboutDialog::AboutDialog(QWidget *parent)
     layout->addWidget(title);
     layout->addWidget(description);
     layout->addWidget(version);
+    layout->addWidget(timings);
     layout->addStretch();
     layout->addWidget(closeButton, 0, Qt::AlignCenter);
 }
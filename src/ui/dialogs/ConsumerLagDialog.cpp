@@ -0,0 +1,156 @@
+#include "ui/dialogs/ConsumerLagDialog.h"
+
+#include <QCheckBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QLocale>
+#include <QSortFilterProxyModel>
+#include <QTableView>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include "core/groups/LagMonitor.h"
+#include "ui/models/ConsumerLagModel.h"
+#include "ui/widgets/FlatButton.h"
+
+namespace
+{
+constexpr int kRowHeight = 22;
+constexpr int kRefreshIntervalMs = 10000;
+}
+
+ConsumerLagDialog::ConsumerLagDialog(kafka::KafkaClient *client, QWidget *parent)
+    : QDialog(parent),
+      m_monitor(new kafka::LagMonitor(client, this)),
+      m_model(new ConsumerLagModel(this)),
+      m_proxy(new QSortFilterProxyModel(this)),
+      m_refreshTimer(new QTimer(this))
+{
+    setWindowTitle(tr("Consumer group lag"));
+    setModal(false);
+    resize(900, 520);
+    setupUi();
+
+    m_refreshTimer->setInterval(kRefreshIntervalMs);
+    connect(m_refreshTimer, &QTimer::timeout, this, &ConsumerLagDialog::refresh);
+    connect(m_monitor, &kafka::LagMonitor::updated, this, &ConsumerLagDialog::onUpdated);
+    connect(m_monitor, &kafka::LagMonitor::failed, this, &ConsumerLagDialog::onFailed);
+    updateControls();
+}
+
+void ConsumerLagDialog::setupUi()
+{
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(12, 12, 12, 12);
+    layout->setSpacing(8);
+
+    auto *controlRow = new QHBoxLayout();
+    m_filterEdit = new QLineEdit(this);
+    m_filterEdit->setPlaceholderText(tr("Filter groups and topics"));
+    m_filterEdit->setClearButtonEnabled(true);
+    m_autoRefreshBox = new QCheckBox(tr("Refresh every %1 s").arg(kRefreshIntervalMs / 1000), this);
+    m_autoRefreshBox->setChecked(true);
+    m_refreshButton = new FlatButton(tr("Refresh"), this);
+    m_refreshButton->setFixedWidth(100);
+    controlRow->addWidget(m_filterEdit, /*stretch=*/1);
+    controlRow->addWidget(m_autoRefreshBox);
+    controlRow->addWidget(m_refreshButton);
+    layout->addLayout(controlRow);
+
+    m_proxy->setSourceModel(m_model);
+    m_proxy->setFilterKeyColumn(-1);
+    m_proxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    m_proxy->setSortRole(Qt::DisplayRole);
+
+    m_table = new QTableView(this);
+    m_table->setModel(m_proxy);
+    m_table->setSortingEnabled(true);
+    m_table->sortByColumn(ConsumerLagModel::LagColumn, Qt::DescendingOrder);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setWordWrap(false);
+    m_table->setAlternatingRowColors(true);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_table->verticalHeader()->setDefaultSectionSize(kRowHeight);
+    m_table->horizontalHeader()->setSectionResizeMode(ConsumerLagModel::GroupColumn,
+                                                      QHeaderView::Stretch);
+    m_table->horizontalHeader()->setSectionResizeMode(ConsumerLagModel::TopicColumn,
+                                                      QHeaderView::Stretch);
+    m_table->setColumnWidth(ConsumerLagModel::PartitionColumn, 70);
+    m_table->setColumnWidth(ConsumerLagModel::CommittedColumn, 110);
+    m_table->setColumnWidth(ConsumerLagModel::EndOffsetColumn, 110);
+    m_table->setColumnWidth(ConsumerLagModel::LagColumn, 100);
+    m_table->setColumnWidth(ConsumerLagModel::CoordinatorColumn, 90);
+    layout->addWidget(m_table, /*stretch=*/1);
+
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setWordWrap(true);
+    layout->addWidget(m_statusLabel);
+
+    connect(m_refreshButton, &QPushButton::clicked, this, &ConsumerLagDialog::refresh);
+    connect(m_filterEdit, &QLineEdit::textChanged, m_proxy,
+            &QSortFilterProxyModel::setFilterFixedString);
+    connect(m_autoRefreshBox, &QCheckBox::toggled, this, [this](bool on) {
+        if (on && isVisible())
+            m_refreshTimer->start();
+        else
+            m_refreshTimer->stop();
+    });
+}
+
+// A refresh still running when the timer fires is left alone; the next
+// tick tries again.
+void ConsumerLagDialog::refresh()
+{
+    if (m_monitor->isRunning())
+        return;
+    m_monitor->refresh();
+    if (m_model->rowCount() == 0)
+        m_statusLabel->setText(tr("Listing consumer groups..."));
+    updateControls();
+}
+
+void ConsumerLagDialog::onUpdated(const kafka::LagDelta &delta)
+{
+    m_model->apply(delta);
+    const QLocale locale;
+    QString text = tr("%n group(s)", nullptr, delta.groupCount) +
+                   tr(" · %n partition offset(s)", nullptr, delta.rowCount) +
+                   tr(" · total lag %1").arg(locale.toString(m_model->totalLag())) +
+                   tr(" · %n changed", nullptr, delta.changed.size() + delta.removed.size()) +
+                   tr(" · %n request(s) in %1 ms", nullptr, delta.requestCount)
+                       .arg(delta.elapsedMs);
+    if (!delta.errors.isEmpty())
+        text += tr(" · %1").arg(delta.errors.join(QStringLiteral("; ")));
+    m_statusLabel->setText(text);
+    updateControls();
+}
+
+// The rows of the last good refresh stay up; only the status says it failed.
+void ConsumerLagDialog::onFailed(const QString &error)
+{
+    m_statusLabel->setText(tr("Could not refresh: %1").arg(error));
+    updateControls();
+}
+
+void ConsumerLagDialog::updateControls()
+{
+    m_refreshButton->setEnabled(!m_monitor->isRunning());
+}
+
+void ConsumerLagDialog::showEvent(QShowEvent *event)
+{
+    QDialog::showEvent(event);
+    refresh();
+    if (m_autoRefreshBox->isChecked())
+        m_refreshTimer->start();
+}
+
+// Nobody looks at a hidden dialog, so it stops asking the cluster.
+void ConsumerLagDialog::hideEvent(QHideEvent *event)
+{
+    m_refreshTimer->stop();
+    QDialog::hideEvent(event);
+}
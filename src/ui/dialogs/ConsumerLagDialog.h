@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QDialog>
+
+class QCheckBox;
+class QLabel;
+class QLineEdit;
+class QSortFilterProxyModel;
+class QTableView;
+class QTimer;
+
+class ConsumerLagModel;
+class FlatButton;
+
+namespace kafka {
+class KafkaClient;
+struct LagDelta;
+class LagMonitor;
+}
+
+/**
+ * @brief View → Consumer group lag: committed offset, end offset and lag of
+ * every consumer group on every partition it reads, optionally refreshed
+ * on a timer.
+ */
+class ConsumerLagDialog final : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ConsumerLagDialog(kafka::KafkaClient *client, QWidget *parent = nullptr);
+
+    void refresh();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void setupUi();
+    void onUpdated(const kafka::LagDelta &delta);
+    void onFailed(const QString &error);
+    void updateControls();
+
+    kafka::LagMonitor *m_monitor = nullptr;
+    ConsumerLagModel *m_model = nullptr;
+    QSortFilterProxyModel *m_proxy = nullptr;
+    QTimer *m_refreshTimer = nullptr;
+
+    QLineEdit *m_filterEdit = nullptr;
+    QCheckBox *m_autoRefreshBox = nullptr;
+    FlatButton *m_refreshButton = nullptr;
+    QTableView *m_table = nullptr;
+    QLabel *m_statusLabel = nullptr;
+};
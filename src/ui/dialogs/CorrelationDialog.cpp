@@ -0,0 +1,373 @@
+#include "ui/dialogs/CorrelationDialog.h"
+
+#include <QComboBox>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDateTimeEdit>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QItemSelectionModel>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QLocale>
+#include <QProgressBar>
+#include <QSignalBlocker>
+#include <QSplitter>
+#include <QTableView>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+#include <memory>
+
+#include "core/correlate/CorrelationScan.h"
+#include "core/network/KafkaClient.h"
+#include "core/source/KafkaBatchSource.h"
+#include "ui/models/CorrelationModel.h"
+#include "ui/widgets/FlatButton.h"
+
+namespace
+{
+constexpr int kRowHeight = 22;
+// QProgressBar takes int; progress is shown in permille.
+constexpr int kProgressSteps = 1000;
+
+enum TimelineColumn
+{
+    TimeColumn,
+    DelayColumn,
+    TopicColumn,
+    PartitionColumn,
+    OffsetColumn,
+    ValueColumn,
+};
+
+void setCell(QTableWidget *table, int row, int column, const QString &text, bool number)
+{
+    auto *item = new QTableWidgetItem(text);
+    item->setTextAlignment(number ? int(Qt::AlignRight | Qt::AlignVCenter)
+                                  : int(Qt::AlignLeft | Qt::AlignVCenter));
+    table->setItem(row, column, item);
+}
+
+QString previewText(const kafka::CorrelationHit &hit)
+{
+    if (hit.preview.isNull())
+        return QCoreApplication::translate("CorrelationDialog", "(null)");
+    QString text = QString::fromUtf8(hit.preview);
+    for (QChar &ch : text) {
+        if (ch.category() == QChar::Other_Control)
+            ch = QLatin1Char(' ');
+    }
+    if (hit.previewTruncated)
+        text += QChar(0x2026);
+    return text;
+}
+}
+
+CorrelationDialog::CorrelationDialog(kafka::KafkaClient *client, QWidget *parent)
+    : QDialog(parent),
+      m_client(client),
+      m_scan(new kafka::CorrelationScan(this)),
+      m_groups(new CorrelationModel(this))
+{
+    setWindowTitle(tr("Correlate across topics"));
+    setModal(false);
+    resize(900, 680);
+    setupUi();
+
+    connect(m_scan, &kafka::CorrelationScan::hitsFound, m_groups, &CorrelationModel::append);
+    connect(m_scan, &kafka::CorrelationScan::progressChanged, this,
+            &CorrelationDialog::onProgress);
+    connect(m_scan, &kafka::CorrelationScan::finished, this, &CorrelationDialog::onFinished);
+    updateControls();
+}
+
+void CorrelationDialog::setupUi()
+{
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(12, 12, 12, 12);
+    layout->setSpacing(8);
+
+    auto *form = new QFormLayout();
+    m_topicList = new QListWidget(this);
+    m_topicList->setMaximumHeight(120);
+    form->addRow(tr("Topics"), m_topicList);
+
+    auto *fieldRow = new QHBoxLayout();
+    m_fieldCombo = new QComboBox(this);
+    m_fieldCombo->addItem(tr("Header"), kafka::CorrelationRequest::Header);
+    m_fieldCombo->addItem(tr("Key"), kafka::CorrelationRequest::Key);
+    m_headerEdit = new QLineEdit(QStringLiteral("trace-id"), this);
+    m_headerEdit->setPlaceholderText(tr("Header name"));
+    fieldRow->addWidget(m_fieldCombo);
+    fieldRow->addWidget(m_headerEdit, /*stretch=*/1);
+    form->addRow(tr("Join on"), fieldRow);
+
+    m_valueEdit = new QLineEdit(this);
+    m_valueEdit->setPlaceholderText(tr("Any value found in two or more topics"));
+    form->addRow(tr("Value"), m_valueEdit);
+
+    auto *timeRow = new QHBoxLayout();
+    const QDateTime now = QDateTime::currentDateTime();
+    m_fromTimeEdit = new QDateTimeEdit(now.addSecs(-3600), this);
+    m_fromTimeEdit->setCalendarPopup(true);
+    m_fromTimeEdit->setDisplayFormat(QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+    m_toTimeEdit = new QDateTimeEdit(now, this);
+    m_toTimeEdit->setCalendarPopup(true);
+    m_toTimeEdit->setDisplayFormat(QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+    timeRow->addWidget(m_fromTimeEdit);
+    timeRow->addWidget(new QLabel(tr("to"), this));
+    timeRow->addWidget(m_toTimeEdit);
+    timeRow->addStretch();
+    form->addRow(tr("Between"), timeRow);
+    layout->addLayout(form);
+
+    m_progressBar = new QProgressBar(this);
+    m_progressBar->setRange(0, kProgressSteps);
+    m_progressBar->setTextVisible(false);
+    m_progressBar->setMaximumHeight(6);
+    layout->addWidget(m_progressBar);
+
+    auto *splitter = new QSplitter(Qt::Vertical, this);
+    m_groupTable = new QTableView(splitter);
+    m_groupTable->setModel(m_groups);
+    m_groupTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_groupTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_groupTable->setWordWrap(false);
+    m_groupTable->setAlternatingRowColors(true);
+    m_groupTable->verticalHeader()->setVisible(false);
+    m_groupTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_groupTable->verticalHeader()->setDefaultSectionSize(kRowHeight);
+    m_groupTable->horizontalHeader()->setSectionResizeMode(CorrelationModel::ValueColumn,
+                                                           QHeaderView::Stretch);
+    m_groupTable->setColumnWidth(CorrelationModel::TopicsColumn, 70);
+    m_groupTable->setColumnWidth(CorrelationModel::MessagesColumn, 90);
+    m_groupTable->setColumnWidth(CorrelationModel::FirstColumn, 190);
+    m_groupTable->setColumnWidth(CorrelationModel::SpanColumn, 100);
+
+    m_timelineTable = new QTableWidget(0, 6, splitter);
+    m_timelineTable->setHorizontalHeaderLabels(
+        {tr("Time"), tr("After first"), tr("Topic"), tr("Partition"), tr("Offset"), tr("Value")});
+    m_timelineTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_timelineTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_timelineTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_timelineTable->setWordWrap(false);
+    m_timelineTable->setAlternatingRowColors(true);
+    m_timelineTable->verticalHeader()->setVisible(false);
+    m_timelineTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_timelineTable->verticalHeader()->setDefaultSectionSize(kRowHeight);
+    m_timelineTable->horizontalHeader()->setStretchLastSection(true);
+    m_timelineTable->setColumnWidth(TimeColumn, 190);
+    m_timelineTable->setColumnWidth(DelayColumn, 90);
+    m_timelineTable->setColumnWidth(TopicColumn, 160);
+    m_timelineTable->setColumnWidth(PartitionColumn, 70);
+    m_timelineTable->setColumnWidth(OffsetColumn, 110);
+    layout->addWidget(splitter, /*stretch=*/1);
+
+    auto *bottomRow = new QHBoxLayout();
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setWordWrap(true);
+    m_startButton = new FlatButton(tr("Correlate"), this);
+    m_startButton->setFixedWidth(100);
+    bottomRow->addWidget(m_statusLabel, /*stretch=*/1);
+    bottomRow->addWidget(m_startButton);
+    layout->addLayout(bottomRow);
+
+    connect(m_fieldCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            &CorrelationDialog::updateControls);
+    connect(m_topicList, &QListWidget::itemChanged, this, &CorrelationDialog::updateControls);
+    connect(m_startButton, &QPushButton::clicked, this, &CorrelationDialog::startOrCancel);
+    connect(m_groupTable->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+            &CorrelationDialog::showTimeline);
+    connect(m_groups, &QAbstractItemModel::dataChanged, this,
+            [this](const QModelIndex &first, const QModelIndex &last) {
+                onGroupsChanged(first.row(), last.row());
+            });
+    connect(m_groups, &QAbstractItemModel::rowsInserted, this,
+            [this](const QModelIndex &, int first, int last) { onGroupsChanged(first, last); });
+    connect(m_timelineTable, &QTableWidget::cellActivated, this, [this](int row, int) {
+        if (m_shownGroup < 0)
+            return;
+        const kafka::CorrelationHit &hit = m_groups->groupAt(m_shownGroup).hits.at(row);
+        emit messageActivated(m_scan->request().targets.at(hit.target).topic, hit.partition,
+                              hit.offset);
+    });
+}
+
+void CorrelationDialog::setTopics(const QStringList &topics, const QString &current)
+{
+    QStringList checked;
+    for (int i = 0; i < m_topicList->count(); ++i) {
+        if (m_topicList->item(i)->checkState() == Qt::Checked)
+            checked.append(m_topicList->item(i)->text());
+    }
+    if (checked.isEmpty() && !current.isEmpty())
+        checked.append(current);
+
+    const QSignalBlocker blocker(m_topicList);
+    m_topicList->clear();
+    for (const QString &topic : topics) {
+        auto *item = new QListWidgetItem(topic, m_topicList);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(checked.contains(topic) ? Qt::Checked : Qt::Unchecked);
+    }
+    updateControls();
+}
+
+void CorrelationDialog::startOrCancel()
+{
+    if (m_scan->isRunning()) {
+        m_scan->cancel();
+        return;
+    }
+
+    const kafka::ClusterMetadata metadata = m_client->metadata();
+    kafka::CorrelationRequest request;
+    for (int i = 0; i < m_topicList->count(); ++i) {
+        const QListWidgetItem *item = m_topicList->item(i);
+        const kafka::TopicInfo *topic = metadata.topic(item->text());
+        if (item->checkState() != Qt::Checked || !topic)
+            continue;
+        kafka::CorrelationTarget target;
+        target.topic = topic->name;
+        target.source = std::make_shared<kafka::KafkaBatchSource>(m_client, topic->name);
+        for (const kafka::PartitionInfo &partition : topic->partitions)
+            target.partitions.append(partition.partition);
+        request.targets.append(target);
+    }
+    if (request.targets.size() > kafka::CorrelationScan::kMaxTargets) {
+        m_statusLabel->setText(
+            tr("Select at most %1 topics").arg(kafka::CorrelationScan::kMaxTargets));
+        return;
+    }
+
+    request.field = static_cast<kafka::CorrelationRequest::Field>(
+        m_fieldCombo->currentData().toInt());
+    request.header = m_headerEdit->text().trimmed().toUtf8();
+    request.value = m_valueEdit->text().toUtf8();
+    // A single value is worth a timeline even when one topic has it.
+    request.minTopics = request.value.isEmpty() ? 2 : 1;
+    request.from = m_fromTimeEdit->dateTime().toMSecsSinceEpoch();
+    request.to = m_toTimeEdit->dateTime().toMSecsSinceEpoch();
+    if (request.from > request.to) {
+        m_statusLabel->setText(tr("The time window ends before it starts"));
+        return;
+    }
+    if (request.field == kafka::CorrelationRequest::Header && request.header.isEmpty()) {
+        m_statusLabel->setText(tr("Enter the header to join on"));
+        return;
+    }
+    if (request.value.isEmpty() && request.targets.size() < 2) {
+        m_statusLabel->setText(tr("Select two or more topics, or enter a value"));
+        return;
+    }
+
+    m_groups->clear();
+    m_shownGroup = -1;
+    m_timelineTable->setRowCount(0);
+    m_progressBar->setValue(0);
+    m_scan->start(request);
+    m_statusLabel->setText(tr("Scanning %n topic(s)...", nullptr, request.targets.size()));
+    updateControls();
+}
+
+void CorrelationDialog::onProgress(qint64 scanned, qint64 total)
+{
+    const int value =
+        total > 0 ? static_cast<int>(qMin<qint64>(kProgressSteps, scanned * kProgressSteps / total))
+                  : 0;
+    m_progressBar->setValue(value);
+    if (m_scan->isRunning()) {
+        const QLocale locale;
+        m_statusLabel->setText(tr("Scanning... %1 of %2 messages, %n value(s) joined", nullptr,
+                                  m_groups->rowCount())
+                                   .arg(locale.toString(scanned))
+                                   .arg(locale.toString(total)));
+    }
+}
+
+void CorrelationDialog::onFinished()
+{
+    QString text;
+    if (!m_scan->errorString().isEmpty())
+        text = tr("Scan failed: %1").arg(m_scan->errorString());
+    else if (m_scan->wasCancelled())
+        text = tr("Cancelled");
+    else
+        text = tr("%n value(s) joined", nullptr, m_groups->rowCount());
+    text += tr(", %n message(s)", nullptr, m_scan->hitCount());
+    if (m_scan->limitReached())
+        text += tr(" · stopped after holding %1 unmatched messages")
+                    .arg(QLocale().toString(kafka::CorrelationScan::kMaxHeldRecords));
+    if (m_scan->skippedBatches() > 0)
+        text += tr(" · %n batch(es) could not be decompressed", nullptr,
+                   static_cast<int>(m_scan->skippedBatches()));
+    m_statusLabel->setText(text);
+    updateControls();
+}
+
+// Follows the shown group as its messages stream in; the first group to
+// appear is selected, which covers the common single-value case.
+void CorrelationDialog::onGroupsChanged(int first, int last)
+{
+    if (m_shownGroup < 0 && m_groups->rowCount() > 0) {
+        m_groupTable->selectRow(0);
+        return;
+    }
+    if (m_shownGroup >= first && m_shownGroup <= last)
+        showTimeline();
+}
+
+void CorrelationDialog::showTimeline()
+{
+    const QModelIndex current = m_groupTable->selectionModel()->currentIndex();
+    m_shownGroup = current.isValid() ? current.row() : -1;
+    if (m_shownGroup < 0) {
+        m_timelineTable->setRowCount(0);
+        return;
+    }
+
+    const CorrelationGroup &group = m_groups->groupAt(m_shownGroup);
+    const QVector<kafka::CorrelationTarget> &targets = m_scan->request().targets;
+    const qint64 start = group.hits.first().timestamp;
+    m_timelineTable->setRowCount(group.hits.size());
+    for (int row = 0; row < group.hits.size(); ++row) {
+        const kafka::CorrelationHit &hit = group.hits.at(row);
+        setCell(m_timelineTable, row, TimeColumn,
+                QDateTime::fromMSecsSinceEpoch(hit.timestamp, Qt::UTC).toString(Qt::ISODateWithMs),
+                false);
+        setCell(m_timelineTable, row, DelayColumn,
+                tr("+%1 ms").arg(QLocale().toString(hit.timestamp - start)), true);
+        setCell(m_timelineTable, row, TopicColumn, targets.at(hit.target).topic, false);
+        setCell(m_timelineTable, row, PartitionColumn, QString::number(hit.partition), true);
+        setCell(m_timelineTable, row, OffsetColumn, QString::number(hit.offset), true);
+        setCell(m_timelineTable, row, ValueColumn, previewText(hit), false);
+    }
+}
+
+void CorrelationDialog::updateControls()
+{
+    const bool running = m_scan->isRunning();
+    bool anyChecked = false;
+    for (int i = 0; i < m_topicList->count() && !anyChecked; ++i)
+        anyChecked = m_topicList->item(i)->checkState() == Qt::Checked;
+
+    m_startButton->setText(running ? tr("Cancel") : tr("Correlate"));
+    m_startButton->setEnabled(running || anyChecked);
+    m_topicList->setEnabled(!running);
+    m_fieldCombo->setEnabled(!running);
+    m_headerEdit->setEnabled(!running && m_fieldCombo->currentData().toInt() ==
+                                             kafka::CorrelationRequest::Header);
+    m_valueEdit->setEnabled(!running);
+    m_fromTimeEdit->setEnabled(!running);
+    m_toTimeEdit->setEnabled(!running);
+}
+
+// Closing the dialog stops the scan; what was joined stays on screen.
+void CorrelationDialog::reject()
+{
+    m_scan->cancel();
+    QDialog::reject();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QDialog>
+#include <QStringList>
+
+class QComboBox;
+class QDateTimeEdit;
+class QLabel;
+class QLineEdit;
+class QListWidget;
+class QProgressBar;
+class QTableView;
+class QTableWidget;
+
+class CorrelationModel;
+class FlatButton;
+
+namespace kafka {
+class CorrelationScan;
+class KafkaClient;
+}
+
+/**
+ * @brief Edit → Correlate across topics: builds the timeline of every
+ * message that shares a key or header value, such as a trace id, across
+ * several topics within a time window.
+ *
+ * Values show up as soon as they occur in two of the topics, or in one
+ * when a single value is asked for; selecting one lists its messages in
+ * time order, and activating a message opens it in the browser. Closing
+ * the dialog stops a running scan.
+ */
+class CorrelationDialog final : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit CorrelationDialog(kafka::KafkaClient *client, QWidget *parent = nullptr);
+
+    /** @brief Topics to offer, checking @p current when it is one of them. */
+    void setTopics(const QStringList &topics, const QString &current);
+
+signals:
+    void messageActivated(const QString &topic, qint32 partition, qint64 offset);
+
+protected:
+    void reject() override;
+
+private:
+    void setupUi();
+    void startOrCancel();
+    void onProgress(qint64 scanned, qint64 total);
+    void onFinished();
+    void onGroupsChanged(int first, int last);
+    void showTimeline();
+    void updateControls();
+
+    kafka::KafkaClient *m_client = nullptr;
+    kafka::CorrelationScan *m_scan = nullptr;
+    CorrelationModel *m_groups = nullptr;
+    int m_shownGroup = -1;
+
+    QListWidget *m_topicList = nullptr;
+    QComboBox *m_fieldCombo = nullptr;
+    QLineEdit *m_headerEdit = nullptr;
+    QLineEdit *m_valueEdit = nullptr;
+    QDateTimeEdit *m_fromTimeEdit = nullptr;
+    QDateTimeEdit *m_toTimeEdit = nullptr;
+    FlatButton *m_startButton = nullptr;
+    QProgressBar *m_progressBar = nullptr;
+    QTableView *m_groupTable = nullptr;
+    QTableWidget *m_timelineTable = nullptr;
+    QLabel *m_statusLabel = nullptr;
+};
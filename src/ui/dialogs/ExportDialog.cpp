@@ -0,0 +1,282 @@
+#include "ui/dialogs/ExportDialog.h"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDateTimeEdit>
+#include <QDir>
+#include <QFileDialog>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QLocale>
+#include <QProgressBar>
+#include <QVBoxLayout>
+
+#include "core/export/TopicExport.h"
+#include "core/source/BatchSource.h"
+#include "ui/widgets/FlatButton.h"
+
+namespace
+{
+// QProgressBar takes int; progress is shown in permille.
+constexpr int kProgressSteps = 1000;
+constexpr int kAllPartitions = -1;
+
+enum RangeMode
+{
+    OffsetRange,
+    TimeRange,
+};
+
+// Parses an optional offset; empty means the partition's start or end.
+bool parseOffset(const QString &text, qint64 *offset)
+{
+    if (text.trimmed().isEmpty()) {
+        *offset = -1;
+        return true;
+    }
+    bool ok = false;
+    *offset = text.trimmed().toLongLong(&ok);
+    return ok && *offset >= 0;
+}
+}
+
+ExportDialog::ExportDialog(QWidget *parent)
+    : QDialog(parent), m_export(new kafka::TopicExport(this))
+{
+    setWindowTitle(tr("Export"));
+    setModal(false);
+    resize(560, 300);
+    setupUi();
+
+    connect(m_export, &kafka::TopicExport::progressChanged, this, &ExportDialog::onProgress);
+    connect(m_export, &kafka::TopicExport::finished, this, &ExportDialog::onFinished);
+    updateControls();
+}
+
+void ExportDialog::setupUi()
+{
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(12, 12, 12, 12);
+    layout->setSpacing(8);
+
+    auto *form = new QFormLayout();
+    m_partitionCombo = new QComboBox(this);
+    form->addRow(tr("Partition"), m_partitionCombo);
+
+    m_rangeCombo = new QComboBox(this);
+    m_rangeCombo->addItem(tr("Offsets"), OffsetRange);
+    m_rangeCombo->addItem(tr("Time"), TimeRange);
+    form->addRow(tr("Range"), m_rangeCombo);
+
+    m_offsetRow = new QWidget(this);
+    auto *offsetLayout = new QHBoxLayout(m_offsetRow);
+    offsetLayout->setContentsMargins(0, 0, 0, 0);
+    m_fromOffsetEdit = new QLineEdit(m_offsetRow);
+    m_fromOffsetEdit->setPlaceholderText(tr("first"));
+    m_toOffsetEdit = new QLineEdit(m_offsetRow);
+    m_toOffsetEdit->setPlaceholderText(tr("end"));
+    offsetLayout->addWidget(m_fromOffsetEdit);
+    offsetLayout->addWidget(new QLabel(tr("to"), m_offsetRow));
+    offsetLayout->addWidget(m_toOffsetEdit);
+    form->addRow(tr("Offsets"), m_offsetRow);
+
+    m_timeRow = new QWidget(this);
+    auto *timeLayout = new QHBoxLayout(m_timeRow);
+    timeLayout->setContentsMargins(0, 0, 0, 0);
+    const QDateTime now = QDateTime::currentDateTime();
+    m_fromTimeEdit = new QDateTimeEdit(now.addSecs(-3600), m_timeRow);
+    m_fromTimeEdit->setCalendarPopup(true);
+    m_fromTimeEdit->setDisplayFormat(QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+    m_toTimeEdit = new QDateTimeEdit(now, m_timeRow);
+    m_toTimeEdit->setCalendarPopup(true);
+    m_toTimeEdit->setDisplayFormat(QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+    timeLayout->addWidget(m_fromTimeEdit);
+    timeLayout->addWidget(new QLabel(tr("to"), m_timeRow));
+    timeLayout->addWidget(m_toTimeEdit);
+    form->addRow(tr("Time"), m_timeRow);
+
+    auto *formatRow = new QHBoxLayout();
+    m_formatCombo = new QComboBox(this);
+    m_formatCombo->addItem(tr("JSON Lines"), kafka::ExportRequest::JsonLines);
+    m_formatCombo->addItem(tr("CSV"), kafka::ExportRequest::Csv);
+    m_zstdCheck = new QCheckBox(tr("Compress with zstd"), this);
+    formatRow->addWidget(m_formatCombo);
+    formatRow->addWidget(m_zstdCheck);
+    formatRow->addStretch();
+    form->addRow(tr("Format"), formatRow);
+
+    auto *pathRow = new QHBoxLayout();
+    m_pathEdit = new QLineEdit(this);
+    m_pathEdit->setText(QDir::home().filePath(QStringLiteral("export.jsonl")));
+    m_browseButton = new FlatButton(tr("Browse..."), this);
+    pathRow->addWidget(m_pathEdit, /*stretch=*/1);
+    pathRow->addWidget(m_browseButton);
+    form->addRow(tr("File"), pathRow);
+    layout->addLayout(form);
+
+    m_progressBar = new QProgressBar(this);
+    m_progressBar->setRange(0, kProgressSteps);
+    m_progressBar->setTextVisible(false);
+    m_progressBar->setMaximumHeight(6);
+    layout->addWidget(m_progressBar);
+
+    auto *bottomRow = new QHBoxLayout();
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setWordWrap(true);
+    m_exportButton = new FlatButton(tr("Export"), this);
+    m_exportButton->setFixedWidth(100);
+    bottomRow->addWidget(m_statusLabel, /*stretch=*/1);
+    bottomRow->addWidget(m_exportButton);
+    layout->addStretch();
+    layout->addLayout(bottomRow);
+
+    m_timeRow->setVisible(false);
+    connect(m_rangeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]() {
+        const bool byTime = m_rangeCombo->currentData().toInt() == TimeRange;
+        m_offsetRow->setVisible(!byTime);
+        m_timeRow->setVisible(byTime);
+    });
+    connect(m_formatCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            &ExportDialog::updateSuffix);
+    connect(m_zstdCheck, &QCheckBox::toggled, this, &ExportDialog::updateSuffix);
+    connect(m_browseButton, &QPushButton::clicked, this, &ExportDialog::browse);
+    connect(m_exportButton, &QPushButton::clicked, this, &ExportDialog::startOrCancel);
+}
+
+void ExportDialog::setTarget(std::shared_ptr<kafka::BatchSource> source,
+                             const QVector<qint32> &partitions, qint32 currentPartition)
+{
+    m_source = std::move(source);
+    m_partitions = partitions;
+
+    m_partitionCombo->clear();
+    m_partitionCombo->addItem(tr("All partitions"), kAllPartitions);
+    for (qint32 partition : partitions)
+        m_partitionCombo->addItem(QString::number(partition), partition);
+    const int current = m_partitionCombo->findData(currentPartition);
+    m_partitionCombo->setCurrentIndex(partitions.size() > 1 && current >= 0 ? current : 0);
+
+    if (!m_export->isRunning()) {
+        m_statusLabel->setText(m_source ? tr("Exporting from %1").arg(m_source->topic())
+                                        : tr("Open a topic to export it"));
+    }
+    updateControls();
+}
+
+void ExportDialog::browse()
+{
+    const bool csv = m_formatCombo->currentData().toInt() == kafka::ExportRequest::Csv;
+    QString filter = csv ? tr("CSV (*.csv)") : tr("JSON Lines (*.jsonl)");
+    if (m_zstdCheck->isChecked())
+        filter = csv ? tr("Zstandard CSV (*.csv.zst)") : tr("Zstandard JSON Lines (*.jsonl.zst)");
+    const QString path =
+        QFileDialog::getSaveFileName(this, tr("Export to"), m_pathEdit->text(), filter);
+    if (!path.isEmpty())
+        m_pathEdit->setText(path);
+}
+
+// Keeps the file name's extension in line with the format and compression.
+void ExportDialog::updateSuffix()
+{
+    QString path = m_pathEdit->text();
+    if (path.endsWith(QLatin1String(".zst")))
+        path.chop(4);
+    for (const QLatin1String suffix : {QLatin1String(".jsonl"), QLatin1String(".csv")}) {
+        if (path.endsWith(suffix))
+            path.chop(suffix.size());
+    }
+    path += m_formatCombo->currentData().toInt() == kafka::ExportRequest::Csv
+                ? QLatin1String(".csv")
+                : QLatin1String(".jsonl");
+    if (m_zstdCheck->isChecked())
+        path += QLatin1String(".zst");
+    m_pathEdit->setText(path);
+}
+
+void ExportDialog::startOrCancel()
+{
+    if (m_export->isRunning()) {
+        m_export->cancel();
+        return;
+    }
+    if (!m_source)
+        return;
+
+    kafka::ExportRequest request;
+    const int partition = m_partitionCombo->currentData().toInt();
+    request.partitions = m_partitions;
+    if (partition != kAllPartitions)
+        request.partitions = {static_cast<qint32>(partition)};
+    request.byTime = m_rangeCombo->currentData().toInt() == TimeRange;
+    if (request.byTime) {
+        request.from = m_fromTimeEdit->dateTime().toMSecsSinceEpoch();
+        request.to = m_toTimeEdit->dateTime().toMSecsSinceEpoch();
+    } else if (!parseOffset(m_fromOffsetEdit->text(), &request.from) ||
+               !parseOffset(m_toOffsetEdit->text(), &request.to)) {
+        m_statusLabel->setText(tr("Offsets must be whole numbers, or empty for the whole range"));
+        return;
+    }
+    if (request.to >= 0 && request.from > request.to) {
+        m_statusLabel->setText(tr("The range ends before it starts"));
+        return;
+    }
+    request.format =
+        static_cast<kafka::ExportRequest::Format>(m_formatCombo->currentData().toInt());
+    request.zstd = m_zstdCheck->isChecked();
+    request.path = m_pathEdit->text().trimmed();
+    if (request.path.isEmpty()) {
+        m_statusLabel->setText(tr("Choose a file to export to"));
+        return;
+    }
+
+    m_progressBar->setValue(0);
+    m_export->start(m_source, request);
+    m_statusLabel->setText(tr("Exporting %1...").arg(m_source->topic()));
+    updateControls();
+}
+
+void ExportDialog::onProgress(qint64 done, qint64 total)
+{
+    const int value =
+        total > 0 ? static_cast<int>(qMin<qint64>(kProgressSteps, done * kProgressSteps / total))
+                  : 0;
+    m_progressBar->setValue(value);
+    if (m_export->isRunning()) {
+        const QLocale locale;
+        m_statusLabel->setText(tr("Exporting... %1 messages, %2 written")
+                                   .arg(locale.toString(m_export->recordCount()))
+                                   .arg(locale.formattedDataSize(m_export->bytesWritten())));
+    }
+}
+
+void ExportDialog::onFinished()
+{
+    const QLocale locale;
+    QString text;
+    if (!m_export->errorString().isEmpty())
+        text = tr("Export failed: %1").arg(m_export->errorString());
+    else if (m_export->wasCancelled())
+        text = tr("Cancelled; the file was not written");
+    else
+        text = tr("Exported %1 messages, %2")
+                   .arg(locale.toString(m_export->recordCount()))
+                   .arg(locale.formattedDataSize(m_export->bytesWritten()));
+    if (m_export->skippedBatches() > 0)
+        text += tr(" · %n batch(es) could not be decompressed", nullptr,
+                   static_cast<int>(m_export->skippedBatches()));
+    m_statusLabel->setText(text);
+    updateControls();
+}
+
+void ExportDialog::updateControls()
+{
+    const bool running = m_export->isRunning();
+    m_exportButton->setText(running ? tr("Cancel") : tr("Export"));
+    m_exportButton->setEnabled(running || m_source != nullptr);
+    for (QWidget *widget : std::initializer_list<QWidget *>{
+             m_partitionCombo, m_rangeCombo, m_offsetRow, m_timeRow, m_formatCombo, m_zstdCheck,
+             m_pathEdit, m_browseButton})
+        widget->setEnabled(!running);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QDialog>
+#include <QVector>
+
+#include <memory>
+
+class QCheckBox;
+class QComboBox;
+class QDateTimeEdit;
+class QLabel;
+class QLineEdit;
+class QProgressBar;
+class QWidget;
+
+class FlatButton;
+
+namespace kafka {
+class BatchSource;
+class TopicExport;
+}
+
+/**
+ * @brief File → Export: writes an offset or time range of the open topic
+ * to a JSON Lines or CSV file while the dialog shows progress.
+ *
+ * Closing the dialog leaves a running export going; Cancel stops it.
+ */
+class ExportDialog final : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ExportDialog(QWidget *parent = nullptr);
+
+    /**
+     * @brief Topic to export, preselecting @p currentPartition; a running
+     * export keeps its own source.
+     */
+    void setTarget(std::shared_ptr<kafka::BatchSource> source, const QVector<qint32> &partitions,
+                   qint32 currentPartition);
+
+private:
+    void setupUi();
+    void browse();
+    void startOrCancel();
+    void onProgress(qint64 done, qint64 total);
+    void onFinished();
+    void updateSuffix();
+    void updateControls();
+
+    kafka::TopicExport *m_export = nullptr;
+    std::shared_ptr<kafka::BatchSource> m_source;
+    QVector<qint32> m_partitions;
+
+    QComboBox *m_partitionCombo = nullptr;
+    QComboBox *m_rangeCombo = nullptr;
+    QWidget *m_offsetRow = nullptr;
+    QLineEdit *m_fromOffsetEdit = nullptr;
+    QLineEdit *m_toOffsetEdit = nullptr;
+    QWidget *m_timeRow = nullptr;
+    QDateTimeEdit *m_fromTimeEdit = nullptr;
+    QDateTimeEdit *m_toTimeEdit = nullptr;
+    QComboBox *m_formatCombo = nullptr;
+    QCheckBox *m_zstdCheck = nullptr;
+    QLineEdit *m_pathEdit = nullptr;
+    FlatButton *m_browseButton = nullptr;
+    FlatButton *m_exportButton = nullptr;
+    QProgressBar *m_progressBar = nullptr;
+    QLabel *m_statusLabel = nullptr;
+};
@@ -0,0 +1,217 @@
+#include "ui/dialogs/FindDialog.h"
+
+#include <QCheckBox>
+#include <QElapsedTimer>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QLocale>
+#include <QProgressBar>
+#include <QTableView>
+#include <QVBoxLayout>
+
+#include "core/search/PatternMatcher.h"
+#include "core/search/TopicSearch.h"
+#include "core/source/BatchSource.h"
+#include "ui/models/SearchResultModel.h"
+#include "ui/widgets/FlatButton.h"
+
+namespace
+{
+constexpr int kRowHeight = 22;
+// QProgressBar takes int; progress is shown in permille.
+constexpr int kProgressSteps = 1000;
+}
+
+FindDialog::FindDialog(QWidget *parent)
+    : QDialog(parent), m_search(new kafka::TopicSearch(this)), m_results(new SearchResultModel(this))
+{
+    setWindowTitle(tr("Find across topic"));
+    setModal(false);
+    resize(860, 520);
+    setupUi();
+
+    connect(m_search, &kafka::TopicSearch::matchesFound, m_results, &SearchResultModel::append);
+    connect(m_search, &kafka::TopicSearch::progressChanged, this, &FindDialog::onProgress);
+    connect(m_search, &kafka::TopicSearch::finished, this, &FindDialog::onFinished);
+    updateControls();
+}
+
+void FindDialog::setupUi()
+{
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(12, 12, 12, 12);
+    layout->setSpacing(8);
+
+    auto *patternRow = new QHBoxLayout();
+    m_patternEdit = new QLineEdit(this);
+    m_patternEdit->setPlaceholderText(tr("Text or regular expression"));
+    m_findButton = new FlatButton(tr("Find"), this);
+    m_findButton->setFixedWidth(100);
+    patternRow->addWidget(m_patternEdit, /*stretch=*/1);
+    patternRow->addWidget(m_findButton);
+    layout->addLayout(patternRow);
+
+    auto *optionsRow = new QHBoxLayout();
+    m_regexCheck = new QCheckBox(tr("Regular expression"), this);
+    m_caseCheck = new QCheckBox(tr("Match case"), this);
+    m_keyCheck = new QCheckBox(tr("Key"), this);
+    m_keyCheck->setChecked(true);
+    m_valueCheck = new QCheckBox(tr("Value"), this);
+    m_valueCheck->setChecked(true);
+    m_headersCheck = new QCheckBox(tr("Headers"), this);
+    m_headersCheck->setChecked(true);
+    optionsRow->addWidget(m_regexCheck);
+    optionsRow->addWidget(m_caseCheck);
+    optionsRow->addSpacing(12);
+    optionsRow->addWidget(new QLabel(tr("Search in"), this));
+    optionsRow->addWidget(m_keyCheck);
+    optionsRow->addWidget(m_valueCheck);
+    optionsRow->addWidget(m_headersCheck);
+    optionsRow->addStretch();
+    layout->addLayout(optionsRow);
+
+    m_progressBar = new QProgressBar(this);
+    m_progressBar->setRange(0, kProgressSteps);
+    m_progressBar->setTextVisible(false);
+    m_progressBar->setMaximumHeight(6);
+    layout->addWidget(m_progressBar);
+
+    m_table = new QTableView(this);
+    m_table->setModel(m_results);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_table->setWordWrap(false);
+    m_table->setAlternatingRowColors(true);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_table->verticalHeader()->setDefaultSectionSize(kRowHeight);
+    m_table->horizontalHeader()->setSectionResizeMode(SearchResultModel::MatchColumn,
+                                                      QHeaderView::Stretch);
+    m_table->setColumnWidth(SearchResultModel::PartitionColumn, 70);
+    m_table->setColumnWidth(SearchResultModel::OffsetColumn, 110);
+    m_table->setColumnWidth(SearchResultModel::TimestampColumn, 190);
+    m_table->setColumnWidth(SearchResultModel::FieldColumn, 110);
+    layout->addWidget(m_table, /*stretch=*/1);
+
+    m_statusLabel = new QLabel(this);
+    layout->addWidget(m_statusLabel);
+
+    connect(m_findButton, &QPushButton::clicked, this, &FindDialog::startOrCancel);
+    connect(m_patternEdit, &QLineEdit::returnPressed, this, [this]() {
+        if (!m_search->isRunning())
+            startOrCancel();
+    });
+    connect(m_table, &QTableView::activated, this, [this](const QModelIndex &index) {
+        const kafka::SearchMatch &match = m_results->matchAt(index.row());
+        emit matchActivated(match.partition, match.offset);
+    });
+}
+
+void FindDialog::setTarget(std::shared_ptr<kafka::BatchSource> source,
+                           const QVector<qint32> &partitions)
+{
+    m_source = std::move(source);
+    m_partitions = partitions;
+    if (!m_search->isRunning()) {
+        m_statusLabel->setText(m_source ? tr("Searching %n partition(s) of %1", nullptr,
+                                             m_partitions.size())
+                                              .arg(m_source->topic())
+                                        : tr("Open a topic to search it"));
+    }
+    updateControls();
+}
+
+void FindDialog::startOrCancel()
+{
+    if (m_search->isRunning()) {
+        m_search->cancel();
+        return;
+    }
+    if (!m_source)
+        return;
+
+    int fields = 0;
+    if (m_keyCheck->isChecked())
+        fields |= kafka::SearchMatch::Key;
+    if (m_valueCheck->isChecked())
+        fields |= kafka::SearchMatch::Value;
+    if (m_headersCheck->isChecked())
+        fields |= kafka::SearchMatch::Headers;
+    if (fields == 0) {
+        m_statusLabel->setText(tr("Select at least one of key, value or headers"));
+        return;
+    }
+
+    QString error;
+    const auto syntax = m_regexCheck->isChecked() ? kafka::PatternMatcher::Syntax::Regex
+                                                  : kafka::PatternMatcher::Syntax::Literal;
+    std::shared_ptr<const kafka::PatternMatcher> matcher =
+        kafka::PatternMatcher::compile(m_patternEdit->text(), syntax, m_caseCheck->isChecked(),
+                                       &error);
+    if (!matcher) {
+        m_statusLabel->setText(tr("Invalid pattern: %1").arg(error));
+        return;
+    }
+
+    m_results->clear();
+    m_progressBar->setValue(0);
+    m_search->start(m_source, m_partitions, std::move(matcher), fields);
+    m_statusLabel->setText(tr("Searching %1...").arg(m_source->topic()));
+    updateControls();
+}
+
+void FindDialog::onProgress(qint64 scanned, qint64 total)
+{
+    const int value =
+        total > 0 ? static_cast<int>(qMin<qint64>(kProgressSteps, scanned * kProgressSteps / total))
+                  : 0;
+    m_progressBar->setValue(value);
+    if (m_search->isRunning()) {
+        const QLocale locale;
+        m_statusLabel->setText(tr("Searching... %1 of %2 messages, %n match(es)", nullptr,
+                                  m_search->matchCount())
+                                   .arg(locale.toString(scanned))
+                                   .arg(locale.toString(total)));
+    }
+}
+
+void FindDialog::onFinished()
+{
+    const QLocale locale;
+    QString text;
+    if (!m_search->errorString().isEmpty())
+        text = tr("Search failed: %1").arg(m_search->errorString());
+    else if (m_search->wasCancelled())
+        text = tr("Cancelled after %n match(es)", nullptr, m_search->matchCount());
+    else if (m_search->limitReached())
+        text = tr("Stopped at the first %1 matches").arg(locale.toString(m_search->matchCount()));
+    else
+        text = tr("%n match(es)", nullptr, m_search->matchCount());
+    if (m_search->skippedBatches() > 0)
+        text += tr(" · %n batch(es) could not be decompressed", nullptr,
+                   static_cast<int>(m_search->skippedBatches()));
+    m_statusLabel->setText(text);
+    updateControls();
+}
+
+void FindDialog::updateControls()
+{
+    const bool running = m_search->isRunning();
+    m_findButton->setText(running ? tr("Cancel") : tr("Find"));
+    m_findButton->setEnabled(running || m_source != nullptr);
+    m_patternEdit->setEnabled(!running);
+    m_regexCheck->setEnabled(!running);
+    m_caseCheck->setEnabled(!running);
+    m_keyCheck->setEnabled(!running);
+    m_valueCheck->setEnabled(!running);
+    m_headersCheck->setEnabled(!running);
+}
+
+// Closing the dialog stops the scan; results stay until the next search.
+void FindDialog::reject()
+{
+    m_search->cancel();
+    QDialog::reject();
+}
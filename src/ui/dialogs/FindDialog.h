@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QDialog>
+#include <QVector>
+
+#include <memory>
+
+class QCheckBox;
+class QLabel;
+class QLineEdit;
+class QProgressBar;
+class QTableView;
+
+class FlatButton;
+class SearchResultModel;
+
+namespace kafka {
+class BatchSource;
+class TopicSearch;
+}
+
+/**
+ * @brief Edit → Find across topic: searches every partition of the open
+ * topic and lists matches while the scan runs.
+ */
+class FindDialog final : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit FindDialog(QWidget *parent = nullptr);
+
+    /** Topic to search; a running search keeps its own source. */
+    void setTarget(std::shared_ptr<kafka::BatchSource> source, const QVector<qint32> &partitions);
+
+signals:
+    void matchActivated(qint32 partition, qint64 offset);
+
+protected:
+    void reject() override;
+
+private:
+    void setupUi();
+    void startOrCancel();
+    void onProgress(qint64 scanned, qint64 total);
+    void onFinished();
+    void updateControls();
+
+    kafka::TopicSearch *m_search = nullptr;
+    SearchResultModel *m_results = nullptr;
+    std::shared_ptr<kafka::BatchSource> m_source;
+    QVector<qint32> m_partitions;
+
+    QLineEdit *m_patternEdit = nullptr;
+    QCheckBox *m_regexCheck = nullptr;
+    QCheckBox *m_caseCheck = nullptr;
+    QCheckBox *m_keyCheck = nullptr;
+    QCheckBox *m_valueCheck = nullptr;
+    QCheckBox *m_headersCheck = nullptr;
+    FlatButton *m_findButton = nullptr;
+    QProgressBar *m_progressBar = nullptr;
+    QTableView *m_table = nullptr;
+    QLabel *m_statusLabel = nullptr;
+};
@@ -0,0 +1,175 @@
+#include "ui/dialogs/KeyVersionsDialog.h"
+
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QLocale>
+#include <QProgressBar>
+#include <QTableView>
+#include <QVBoxLayout>
+
+#include "core/index/KeyLookup.h"
+#include "core/source/BatchSource.h"
+#include "ui/models/SearchResultModel.h"
+#include "ui/widgets/FlatButton.h"
+
+namespace
+{
+constexpr int kRowHeight = 22;
+// QProgressBar takes int; progress is shown in permille.
+constexpr int kProgressSteps = 1000;
+}
+
+KeyVersionsDialog::KeyVersionsDialog(QWidget *parent)
+    : QDialog(parent), m_lookup(new kafka::KeyLookup(this)), m_results(new SearchResultModel(this))
+{
+    setWindowTitle(tr("Find versions of key"));
+    setModal(false);
+    resize(860, 480);
+    setupUi();
+
+    connect(m_lookup, &kafka::KeyLookup::versionsFound, m_results, &SearchResultModel::append);
+    connect(m_lookup, &kafka::KeyLookup::indexProgress, this, &KeyVersionsDialog::onIndexProgress);
+    connect(m_lookup, &kafka::KeyLookup::finished, this, &KeyVersionsDialog::onFinished);
+    updateControls();
+}
+
+void KeyVersionsDialog::setupUi()
+{
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(12, 12, 12, 12);
+    layout->setSpacing(8);
+
+    auto *keyRow = new QHBoxLayout();
+    m_keyEdit = new QLineEdit(this);
+    m_keyEdit->setPlaceholderText(tr("Message key"));
+    m_findButton = new FlatButton(tr("Find"), this);
+    m_findButton->setFixedWidth(100);
+    keyRow->addWidget(new QLabel(tr("Key"), this));
+    keyRow->addWidget(m_keyEdit, /*stretch=*/1);
+    keyRow->addWidget(m_findButton);
+    layout->addLayout(keyRow);
+
+    m_progressBar = new QProgressBar(this);
+    m_progressBar->setRange(0, kProgressSteps);
+    m_progressBar->setTextVisible(false);
+    m_progressBar->setMaximumHeight(6);
+    layout->addWidget(m_progressBar);
+
+    m_table = new QTableView(this);
+    m_table->setModel(m_results);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_table->setWordWrap(false);
+    m_table->setAlternatingRowColors(true);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_table->verticalHeader()->setDefaultSectionSize(kRowHeight);
+    m_table->horizontalHeader()->setSectionResizeMode(SearchResultModel::MatchColumn,
+                                                      QHeaderView::Stretch);
+    // Every row is a value of the same key.
+    m_table->setColumnHidden(SearchResultModel::FieldColumn, true);
+    m_table->setColumnWidth(SearchResultModel::PartitionColumn, 70);
+    m_table->setColumnWidth(SearchResultModel::OffsetColumn, 110);
+    m_table->setColumnWidth(SearchResultModel::TimestampColumn, 190);
+    layout->addWidget(m_table, /*stretch=*/1);
+
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setWordWrap(true);
+    layout->addWidget(m_statusLabel);
+
+    connect(m_findButton, &QPushButton::clicked, this, &KeyVersionsDialog::startOrCancel);
+    connect(m_keyEdit, &QLineEdit::textEdited, this, [this](const QString &text) {
+        m_key = text.toUtf8();
+    });
+    connect(m_keyEdit, &QLineEdit::returnPressed, this, [this]() {
+        if (!m_lookup->isRunning())
+            startOrCancel();
+    });
+    connect(m_table, &QTableView::activated, this, [this](const QModelIndex &index) {
+        const kafka::SearchMatch &version = m_results->matchAt(index.row());
+        emit versionActivated(version.partition, version.offset);
+    });
+}
+
+void KeyVersionsDialog::setTarget(std::shared_ptr<kafka::BatchSource> source, qint32 partition)
+{
+    m_source = std::move(source);
+    m_partition = partition;
+    if (!m_lookup->isRunning()) {
+        m_statusLabel->setText(m_source ? tr("Looking in partition %1 of %2")
+                                              .arg(m_partition)
+                                              .arg(m_source->topic())
+                                        : tr("Open a topic to look up keys in it"));
+    }
+    updateControls();
+}
+
+void KeyVersionsDialog::lookUp(const QByteArray &key)
+{
+    m_lookup->cancel();
+    m_key = key;
+    m_keyEdit->setText(QString::fromUtf8(key));
+    startOrCancel();
+}
+
+void KeyVersionsDialog::startOrCancel()
+{
+    if (m_lookup->isRunning()) {
+        m_lookup->cancel();
+        return;
+    }
+    if (!m_source)
+        return;
+
+    m_results->clear();
+    m_progressBar->setValue(0);
+    m_lookup->start(m_source, m_partition, m_key);
+    m_statusLabel->setText(tr("Updating the key index of partition %1...").arg(m_partition));
+    updateControls();
+}
+
+void KeyVersionsDialog::onIndexProgress(qint64 indexedUntil, qint64 end)
+{
+    const int value =
+        end > 0 ? static_cast<int>(qMin<qint64>(kProgressSteps, indexedUntil * kProgressSteps / end))
+                : 0;
+    m_progressBar->setValue(value);
+    const QLocale locale;
+    m_statusLabel->setText(tr("Indexing partition %1... offset %2 of %3")
+                               .arg(m_partition)
+                               .arg(locale.toString(indexedUntil))
+                               .arg(locale.toString(end)));
+}
+
+void KeyVersionsDialog::onFinished()
+{
+    m_progressBar->setValue(m_lookup->wasCancelled() ? 0 : kProgressSteps);
+    QString text;
+    if (m_lookup->wasCancelled())
+        text = tr("Cancelled; what was indexed so far is kept");
+    else
+        text = tr("%n version(s)", nullptr, m_lookup->versionCount());
+    // Errors may come with partial results, e.g. from an index that could
+    // not be brought fully up to date.
+    if (!m_lookup->errorString().isEmpty())
+        text += tr(" · %1").arg(m_lookup->errorString());
+    m_statusLabel->setText(text);
+    updateControls();
+}
+
+void KeyVersionsDialog::updateControls()
+{
+    const bool running = m_lookup->isRunning();
+    m_findButton->setText(running ? tr("Cancel") : tr("Find"));
+    m_findButton->setEnabled(running || m_source != nullptr);
+    m_keyEdit->setEnabled(!running);
+}
+
+// Closing the dialog stops the lookup; the index keeps what was built.
+void KeyVersionsDialog::reject()
+{
+    m_lookup->cancel();
+    QDialog::reject();
+}
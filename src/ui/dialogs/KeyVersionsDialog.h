@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDialog>
+
+#include <memory>
+
+class QLabel;
+class QLineEdit;
+class QProgressBar;
+class QTableView;
+
+class FlatButton;
+class SearchResultModel;
+
+namespace kafka {
+class BatchSource;
+class KeyLookup;
+}
+
+/**
+ * @brief Edit → Find versions of key: lists every record of one partition
+ * that carries a given key, through the persistent key index.
+ */
+class KeyVersionsDialog final : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit KeyVersionsDialog(QWidget *parent = nullptr);
+
+    /** Partition to look in; a running lookup keeps its own source. */
+    void setTarget(std::shared_ptr<kafka::BatchSource> source, qint32 partition);
+    /** Fills in @p key, which may hold bytes that are not UTF-8, and looks it up. */
+    void lookUp(const QByteArray &key);
+
+signals:
+    void versionActivated(qint32 partition, qint64 offset);
+
+protected:
+    void reject() override;
+
+private:
+    void setupUi();
+    void startOrCancel();
+    void onIndexProgress(qint64 indexedUntil, qint64 end);
+    void onFinished();
+    void updateControls();
+
+    kafka::KeyLookup *m_lookup = nullptr;
+    SearchResultModel *m_results = nullptr;
+    std::shared_ptr<kafka::BatchSource> m_source;
+    qint32 m_partition = 0;
+    // Kept apart from the edit so keys that are not valid UTF-8 survive.
+    QByteArray m_key;
+
+    QLineEdit *m_keyEdit = nullptr;
+    FlatButton *m_findButton = nullptr;
+    QProgressBar *m_progressBar = nullptr;
+    QTableView *m_table = nullptr;
+    QLabel *m_statusLabel = nullptr;
+};
@@ -0,0 +1,225 @@
+#include "ui/dialogs/ReplayDialog.h"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDir>
+#include <QFileDialog>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QLocale>
+#include <QProgressBar>
+#include <QSpinBox>
+#include <QVBoxLayout>
+
+#include "core/replay/TopicReplay.h"
+#include "ui/widgets/FlatButton.h"
+
+namespace
+{
+// QProgressBar takes int; progress is shown in permille.
+constexpr int kProgressSteps = 1000;
+// Produce requests beyond five per connection may reorder an idempotent
+// producer's batches.
+constexpr int kMaxInFlight = 5;
+}
+
+ReplayDialog::ReplayDialog(kafka::KafkaClient *client, QWidget *parent)
+    : QDialog(parent), m_client(client), m_replay(new kafka::TopicReplay(this))
+{
+    setWindowTitle(tr("Replay into topic"));
+    setModal(false);
+    resize(560, 320);
+    setupUi();
+
+    connect(m_replay, &kafka::TopicReplay::progressChanged, this, &ReplayDialog::onProgress);
+    connect(m_replay, &kafka::TopicReplay::finished, this, &ReplayDialog::onFinished);
+    updateControls();
+}
+
+void ReplayDialog::setupUi()
+{
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(12, 12, 12, 12);
+    layout->setSpacing(8);
+
+    const kafka::ReplayRequest defaults;
+    auto *form = new QFormLayout();
+    auto *pathRow = new QHBoxLayout();
+    m_pathEdit = new QLineEdit(this);
+    m_pathEdit->setText(QDir::home().filePath(QStringLiteral("export.jsonl")));
+    m_browseButton = new FlatButton(tr("Browse..."), this);
+    pathRow->addWidget(m_pathEdit, /*stretch=*/1);
+    pathRow->addWidget(m_browseButton);
+    form->addRow(tr("File"), pathRow);
+
+    m_topicCombo = new QComboBox(this);
+    m_topicCombo->setEditable(true);
+    m_topicCombo->setInsertPolicy(QComboBox::NoInsert);
+    form->addRow(tr("Topic"), m_topicCombo);
+
+    auto *keepRow = new QHBoxLayout();
+    m_keepPartitionsCheck = new QCheckBox(tr("Keep partitions"), this);
+    m_keepPartitionsCheck->setChecked(defaults.keepPartitions);
+    m_keepPartitionsCheck->setToolTip(
+        tr("Send each message to the partition the file names; otherwise partition by key"));
+    m_keepTimestampsCheck = new QCheckBox(tr("Keep timestamps"), this);
+    m_keepTimestampsCheck->setChecked(defaults.keepTimestamps);
+    keepRow->addWidget(m_keepPartitionsCheck);
+    keepRow->addWidget(m_keepTimestampsCheck);
+    keepRow->addStretch();
+    form->addRow(QString(), keepRow);
+
+    m_compressionCombo = new QComboBox(this);
+    for (const kafka::Compression compression :
+         {kafka::Compression::None, kafka::Compression::Gzip, kafka::Compression::Snappy,
+          kafka::Compression::Lz4, kafka::Compression::Zstd})
+        m_compressionCombo->addItem(QString::fromLatin1(kafka::compressionName(compression)),
+                                    static_cast<int>(compression));
+    m_compressionCombo->setCurrentIndex(
+        m_compressionCombo->findData(static_cast<int>(defaults.compression)));
+    form->addRow(tr("Compression"), m_compressionCombo);
+
+    auto *batchRow = new QHBoxLayout();
+    m_lingerSpin = new QSpinBox(this);
+    m_lingerSpin->setRange(0, 1000);
+    m_lingerSpin->setSuffix(tr(" ms linger"));
+    m_lingerSpin->setValue(defaults.lingerMs);
+    m_batchSizeSpin = new QSpinBox(this);
+    m_batchSizeSpin->setRange(16, 4096);
+    m_batchSizeSpin->setSuffix(tr(" KiB batches"));
+    m_batchSizeSpin->setValue(defaults.batchBytes >> 10);
+    m_inFlightSpin = new QSpinBox(this);
+    m_inFlightSpin->setRange(1, kMaxInFlight);
+    m_inFlightSpin->setSuffix(tr(" in flight"));
+    m_inFlightSpin->setValue(defaults.maxInFlight);
+    m_inFlightSpin->setToolTip(tr("Produce requests outstanding per broker"));
+    batchRow->addWidget(m_lingerSpin);
+    batchRow->addWidget(m_batchSizeSpin);
+    batchRow->addWidget(m_inFlightSpin);
+    batchRow->addStretch();
+    form->addRow(tr("Batching"), batchRow);
+    layout->addLayout(form);
+
+    m_progressBar = new QProgressBar(this);
+    m_progressBar->setRange(0, kProgressSteps);
+    m_progressBar->setTextVisible(false);
+    m_progressBar->setMaximumHeight(6);
+    layout->addWidget(m_progressBar);
+
+    auto *bottomRow = new QHBoxLayout();
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setWordWrap(true);
+    m_replayButton = new FlatButton(tr("Replay"), this);
+    m_replayButton->setFixedWidth(100);
+    bottomRow->addWidget(m_statusLabel, /*stretch=*/1);
+    bottomRow->addWidget(m_replayButton);
+    layout->addStretch();
+    layout->addLayout(bottomRow);
+
+    connect(m_browseButton, &QPushButton::clicked, this, &ReplayDialog::browse);
+    connect(m_replayButton, &QPushButton::clicked, this, &ReplayDialog::startOrCancel);
+}
+
+void ReplayDialog::setTopics(const QStringList &topics, const QString &current)
+{
+    const QString typed = m_topicCombo->currentText();
+    m_topicCombo->clear();
+    m_topicCombo->addItems(topics);
+    const int index = m_topicCombo->findText(current);
+    if (index >= 0)
+        m_topicCombo->setCurrentIndex(index);
+    else
+        m_topicCombo->setEditText(typed);
+    updateControls();
+}
+
+void ReplayDialog::browse()
+{
+    const QString path = QFileDialog::getOpenFileName(
+        this, tr("Replay from"), m_pathEdit->text(),
+        tr("Exported messages (*.jsonl *.csv *.jsonl.zst *.csv.zst);;All files (*)"));
+    if (!path.isEmpty())
+        m_pathEdit->setText(path);
+}
+
+void ReplayDialog::startOrCancel()
+{
+    if (m_replay->isRunning()) {
+        m_replay->cancel();
+        return;
+    }
+
+    kafka::ReplayRequest request;
+    request.path = m_pathEdit->text().trimmed();
+    request.topic = m_topicCombo->currentText().trimmed();
+    if (request.path.isEmpty()) {
+        m_statusLabel->setText(tr("Choose a file to replay"));
+        return;
+    }
+    if (request.topic.isEmpty()) {
+        m_statusLabel->setText(tr("Choose the topic to replay into"));
+        return;
+    }
+    request.keepPartitions = m_keepPartitionsCheck->isChecked();
+    request.keepTimestamps = m_keepTimestampsCheck->isChecked();
+    request.compression =
+        static_cast<kafka::Compression>(m_compressionCombo->currentData().toInt());
+    request.lingerMs = m_lingerSpin->value();
+    request.batchBytes = m_batchSizeSpin->value() << 10;
+    request.maxInFlight = m_inFlightSpin->value();
+
+    m_progressBar->setValue(0);
+    m_replay->start(m_client, request);
+    m_statusLabel->setText(tr("Replaying into %1...").arg(request.topic));
+    updateControls();
+}
+
+QString ReplayDialog::throughputText() const
+{
+    const QLocale locale;
+    const qint64 elapsedMs = m_replay->elapsedMs();
+    QString text = tr("%1 messages, %2")
+                       .arg(locale.toString(m_replay->recordCount()))
+                       .arg(locale.formattedDataSize(m_replay->bytesSent()));
+    if (elapsedMs > 0)
+        text += tr(" · %1 msg/s").arg(
+            locale.toString(m_replay->recordCount() * 1000 / elapsedMs));
+    return text;
+}
+
+void ReplayDialog::onProgress(qint64 done, qint64 total)
+{
+    const int value =
+        total > 0 ? static_cast<int>(qMin<qint64>(kProgressSteps, done * kProgressSteps / total))
+                  : 0;
+    m_progressBar->setValue(value);
+    if (m_replay->isRunning())
+        m_statusLabel->setText(tr("Replaying... %1").arg(throughputText()));
+}
+
+void ReplayDialog::onFinished()
+{
+    QString text;
+    if (!m_replay->errorString().isEmpty())
+        text = tr("Replay failed after %1: %2").arg(throughputText(), m_replay->errorString());
+    else if (m_replay->wasCancelled())
+        text = tr("Cancelled after %1").arg(throughputText());
+    else
+        text = tr("Replayed %1").arg(throughputText());
+    m_statusLabel->setText(text);
+    updateControls();
+}
+
+void ReplayDialog::updateControls()
+{
+    const bool running = m_replay->isRunning();
+    m_replayButton->setText(running ? tr("Cancel") : tr("Replay"));
+    m_replayButton->setEnabled(running || m_client != nullptr);
+    for (QWidget *widget : std::initializer_list<QWidget *>{
+             m_pathEdit, m_browseButton, m_topicCombo, m_keepPartitionsCheck,
+             m_keepTimestampsCheck, m_compressionCombo, m_lingerSpin, m_batchSizeSpin,
+             m_inFlightSpin})
+        widget->setEnabled(!running);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QDialog>
+#include <QStringList>
+
+class QCheckBox;
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QProgressBar;
+class QSpinBox;
+
+class FlatButton;
+
+namespace kafka {
+class KafkaClient;
+class TopicReplay;
+}
+
+/**
+ * @brief File → Replay into topic: publishes a JSON Lines or CSV file,
+ * such as one written by Export, to a topic while the dialog shows
+ * progress and throughput.
+ *
+ * Closing the dialog leaves a running replay going; Cancel stops it.
+ */
+class ReplayDialog final : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ReplayDialog(kafka::KafkaClient *client, QWidget *parent = nullptr);
+
+    /** @brief Topics to offer, preselecting @p current when it is one of them. */
+    void setTopics(const QStringList &topics, const QString &current);
+
+private:
+    void setupUi();
+    void browse();
+    void startOrCancel();
+    void onProgress(qint64 done, qint64 total);
+    void onFinished();
+    void updateControls();
+    QString throughputText() const;
+
+    kafka::KafkaClient *m_client = nullptr;
+    kafka::TopicReplay *m_replay = nullptr;
+
+    QLineEdit *m_pathEdit = nullptr;
+    FlatButton *m_browseButton = nullptr;
+    QComboBox *m_topicCombo = nullptr;
+    QCheckBox *m_keepPartitionsCheck = nullptr;
+    QCheckBox *m_keepTimestampsCheck = nullptr;
+    QComboBox *m_compressionCombo = nullptr;
+    QSpinBox *m_lingerSpin = nullptr;
+    QSpinBox *m_batchSizeSpin = nullptr;
+    QSpinBox *m_inFlightSpin = nullptr;
+    FlatButton *m_replayButton = nullptr;
+    QProgressBar *m_progressBar = nullptr;
+    QLabel *m_statusLabel = nullptr;
+};
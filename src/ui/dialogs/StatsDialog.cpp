@@ -0,0 +1,351 @@
+#include "ui/dialogs/StatsDialog.h"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDateTime>
+#include <QDateTimeEdit>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLocale>
+#include <QProgressBar>
+#include <QTabWidget>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+#include <algorithm>
+
+#include "core/source/BatchSource.h"
+#include "core/stats/TopicStats.h"
+#include "ui/widgets/FlatButton.h"
+
+namespace
+{
+constexpr int kRowHeight = 22;
+// QProgressBar takes int; progress is shown in permille.
+constexpr int kProgressSteps = 1000;
+constexpr int kAllPartitions = -1;
+// Heavy keys listed; the sketch tracks more candidates than it shows.
+constexpr int kShownKeys = 25;
+
+QTableWidget *createTable(const QStringList &headers, QWidget *parent)
+{
+    auto *table = new QTableWidget(0, headers.size(), parent);
+    table->setHorizontalHeaderLabels(headers);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setWordWrap(false);
+    table->setAlternatingRowColors(true);
+    table->verticalHeader()->setVisible(false);
+    table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    table->verticalHeader()->setDefaultSectionSize(kRowHeight);
+    table->horizontalHeader()->setStretchLastSection(true);
+    return table;
+}
+
+void setCell(QTableWidget *table, int row, int column, const QString &text, bool number)
+{
+    auto *item = new QTableWidgetItem(text);
+    item->setTextAlignment(number ? int(Qt::AlignRight | Qt::AlignVCenter)
+                                  : int(Qt::AlignLeft | Qt::AlignVCenter));
+    table->setItem(row, column, item);
+}
+
+QString percent(double part, double whole)
+{
+    return whole > 0 ? QLocale().toString(100.0 * part / whole, 'f', 2) + QLatin1Char('%')
+                     : QString();
+}
+
+QString timeText(qint64 timestamp)
+{
+    return timestamp < 0 ? QString()
+                         : QDateTime::fromMSecsSinceEpoch(timestamp, Qt::UTC).toString(Qt::ISODate);
+}
+
+QString keyText(const std::string &key)
+{
+    QString text = QString::fromUtf8(key.data(), static_cast<int>(key.size()));
+    for (QChar &ch : text) {
+        if (ch.category() == QChar::Other_Control)
+            ch = QLatin1Char(' ');
+    }
+    if (key.size() >= kafka::HeavyHitters::kMaxKeyBytes)
+        text += QChar(0x2026);
+    return text;
+}
+}
+
+StatsDialog::StatsDialog(QWidget *parent)
+    : QDialog(parent), m_stats(new kafka::TopicStats(this))
+{
+    setWindowTitle(tr("Topic statistics"));
+    setModal(false);
+    resize(820, 600);
+    setupUi();
+
+    connect(m_stats, &kafka::TopicStats::progressChanged, this, &StatsDialog::onProgress);
+    connect(m_stats, &kafka::TopicStats::finished, this, &StatsDialog::onFinished);
+    updateControls();
+}
+
+void StatsDialog::setupUi()
+{
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(12, 12, 12, 12);
+    layout->setSpacing(8);
+
+    auto *form = new QFormLayout();
+    m_partitionCombo = new QComboBox(this);
+    form->addRow(tr("Partition"), m_partitionCombo);
+
+    auto *timeRow = new QHBoxLayout();
+    const QDateTime now = QDateTime::currentDateTime();
+    m_windowCheck = new QCheckBox(tr("Only between"), this);
+    m_fromTimeEdit = new QDateTimeEdit(now.addSecs(-3600), this);
+    m_fromTimeEdit->setCalendarPopup(true);
+    m_fromTimeEdit->setDisplayFormat(QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+    m_toTimeEdit = new QDateTimeEdit(now, this);
+    m_toTimeEdit->setCalendarPopup(true);
+    m_toTimeEdit->setDisplayFormat(QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+    timeRow->addWidget(m_windowCheck);
+    timeRow->addWidget(m_fromTimeEdit);
+    timeRow->addWidget(new QLabel(tr("and"), this));
+    timeRow->addWidget(m_toTimeEdit);
+    timeRow->addStretch();
+    form->addRow(tr("Time"), timeRow);
+    layout->addLayout(form);
+
+    m_progressBar = new QProgressBar(this);
+    m_progressBar->setRange(0, kProgressSteps);
+    m_progressBar->setTextVisible(false);
+    m_progressBar->setMaximumHeight(6);
+    layout->addWidget(m_progressBar);
+
+    m_summaryLabel = new QLabel(this);
+    m_summaryLabel->setWordWrap(true);
+    m_summaryLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    layout->addWidget(m_summaryLabel);
+
+    m_tabs = new QTabWidget(this);
+    m_partitionTable = createTable({tr("Partition"), tr("Messages"), tr("Share"), tr("Bytes"),
+                                    tr("vs. mean"), tr("First"), tr("Last")},
+                                   m_tabs);
+    m_keyTable = createTable({tr("Key"), tr("Messages (at most)"), tr("Share")}, m_tabs);
+    m_keyTable->horizontalHeader()->setStretchLastSection(false);
+    m_keyTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_sizeTable = createTable({tr("Size"), tr("Messages"), tr("Share")}, m_tabs);
+    m_timeTable = createTable({tr("From"), tr("Messages"), tr("Per second")}, m_tabs);
+    m_tabs->addTab(m_partitionTable, tr("Partitions"));
+    m_tabs->addTab(m_keyTable, tr("Hot keys"));
+    m_tabs->addTab(m_sizeTable, tr("Sizes"));
+    m_tabs->addTab(m_timeTable, tr("Over time"));
+    layout->addWidget(m_tabs, /*stretch=*/1);
+
+    auto *bottomRow = new QHBoxLayout();
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setWordWrap(true);
+    m_startButton = new FlatButton(tr("Scan"), this);
+    m_startButton->setFixedWidth(100);
+    bottomRow->addWidget(m_statusLabel, /*stretch=*/1);
+    bottomRow->addWidget(m_startButton);
+    layout->addLayout(bottomRow);
+
+    connect(m_windowCheck, &QCheckBox::toggled, this, &StatsDialog::updateControls);
+    connect(m_startButton, &QPushButton::clicked, this, &StatsDialog::startOrCancel);
+}
+
+void StatsDialog::setTarget(std::shared_ptr<kafka::BatchSource> source,
+                            const QVector<qint32> &partitions)
+{
+    m_source = std::move(source);
+    m_partitions = partitions;
+
+    m_partitionCombo->clear();
+    m_partitionCombo->addItem(tr("All partitions"), kAllPartitions);
+    for (qint32 partition : partitions)
+        m_partitionCombo->addItem(QString::number(partition), partition);
+
+    if (!m_stats->isRunning()) {
+        m_statusLabel->setText(m_source ? tr("Profiling %1").arg(m_source->topic())
+                                        : tr("Open a topic to profile it"));
+    }
+    updateControls();
+}
+
+void StatsDialog::startOrCancel()
+{
+    if (m_stats->isRunning()) {
+        m_stats->cancel();
+        return;
+    }
+    if (!m_source)
+        return;
+
+    QVector<qint32> partitions = m_partitions;
+    const int partition = m_partitionCombo->currentData().toInt();
+    if (partition != kAllPartitions)
+        partitions = {static_cast<qint32>(partition)};
+    qint64 from = -1;
+    qint64 to = -1;
+    if (m_windowCheck->isChecked()) {
+        from = m_fromTimeEdit->dateTime().toMSecsSinceEpoch();
+        to = m_toTimeEdit->dateTime().toMSecsSinceEpoch();
+        if (from > to) {
+            m_statusLabel->setText(tr("The time window ends before it starts"));
+            return;
+        }
+    }
+
+    m_progressBar->setValue(0);
+    m_stats->start(m_source, partitions, from, to);
+    m_statusLabel->setText(tr("Scanning %1...").arg(m_source->topic()));
+    updateControls();
+}
+
+void StatsDialog::onProgress(qint64 scanned, qint64 total)
+{
+    const int value =
+        total > 0 ? static_cast<int>(qMin<qint64>(kProgressSteps, scanned * kProgressSteps / total))
+                  : 0;
+    m_progressBar->setValue(value);
+    if (m_stats->isRunning()) {
+        const QLocale locale;
+        m_statusLabel->setText(tr("Scanning... %1 of %2 messages")
+                                   .arg(locale.toString(scanned))
+                                   .arg(locale.toString(total)));
+    }
+}
+
+void StatsDialog::onFinished()
+{
+    const QLocale locale;
+    QString text;
+    if (!m_stats->errorString().isEmpty())
+        text = tr("Scan failed: %1").arg(m_stats->errorString());
+    else if (m_stats->wasCancelled())
+        text = tr("Cancelled");
+    else
+        text = tr("%n worker sketch(es) of %1 each, merged", nullptr, m_stats->workerCount())
+                   .arg(locale.formattedDataSize(
+                       static_cast<qint64>(kafka::StatsSketch::footprint())));
+    if (m_stats->skippedBatches() > 0)
+        text += tr(" · %n batch(es) could not be decompressed", nullptr,
+                   static_cast<int>(m_stats->skippedBatches()));
+    m_statusLabel->setText(text);
+    showResult();
+    updateControls();
+}
+
+void StatsDialog::showResult()
+{
+    const std::shared_ptr<const kafka::StatsSketch> result = m_stats->result();
+    if (!result)
+        return;
+
+    const QLocale locale;
+    const auto records = static_cast<double>(result->records());
+    const std::vector<kafka::PartitionStats> &partitions = result->partitions();
+    const double mean = partitions.empty() ? 0 : records / static_cast<double>(partitions.size());
+
+    QStringList summary;
+    summary << tr("%1 messages, %2")
+                   .arg(locale.toString(result->records()))
+                   .arg(locale.formattedDataSize(static_cast<qint64>(result->bytes())));
+    summary << tr("about %1 distinct keys (±%2%), %3 null keys")
+                   .arg(locale.toString(qRound64(result->distinctKeys())))
+                   .arg(locale.toString(100 * kafka::HyperLogLog::standardError(), 'f', 1))
+                   .arg(locale.toString(result->nullKeys()));
+    const kafka::SizeHistogram &sizes = result->sizes();
+    if (sizes.total() > 0) {
+        summary << tr("sizes %1 – %2, median ≤ %3, 99th percentile ≤ %4")
+                       .arg(locale.formattedDataSize(static_cast<qint64>(sizes.minimum())))
+                       .arg(locale.formattedDataSize(static_cast<qint64>(sizes.maximum())))
+                       .arg(locale.formattedDataSize(static_cast<qint64>(sizes.quantileBound(0.5))))
+                       .arg(locale.formattedDataSize(
+                           static_cast<qint64>(sizes.quantileBound(0.99))));
+    }
+    const auto busiest = std::max_element(
+        partitions.begin(), partitions.end(),
+        [](const kafka::PartitionStats &a, const kafka::PartitionStats &b) {
+            return a.records < b.records;
+        });
+    if (busiest != partitions.end() && mean > 0 && partitions.size() > 1) {
+        summary << tr("busiest partition %1 holds %2× the mean")
+                       .arg(busiest->partition)
+                       .arg(locale.toString(static_cast<double>(busiest->records) / mean, 'f', 2));
+    }
+    m_summaryLabel->setText(summary.join(QStringLiteral(" · ")));
+
+    m_partitionTable->setRowCount(static_cast<int>(partitions.size()));
+    for (int row = 0; row < m_partitionTable->rowCount(); ++row) {
+        const kafka::PartitionStats &stats = partitions[static_cast<std::size_t>(row)];
+        const auto count = static_cast<double>(stats.records);
+        setCell(m_partitionTable, row, 0, QString::number(stats.partition), true);
+        setCell(m_partitionTable, row, 1, locale.toString(stats.records), true);
+        setCell(m_partitionTable, row, 2, percent(count, records), true);
+        setCell(m_partitionTable, row, 3,
+                locale.formattedDataSize(static_cast<qint64>(stats.bytes)), true);
+        setCell(m_partitionTable, row, 4,
+                mean > 0 ? locale.toString(count / mean, 'f', 2) + QChar(0x00d7) : QString(),
+                true);
+        setCell(m_partitionTable, row, 5, timeText(stats.firstTimestamp), false);
+        setCell(m_partitionTable, row, 6, timeText(stats.lastTimestamp), false);
+    }
+
+    const std::vector<kafka::HeavyHitters::Entry> keys = result->hotKeys();
+    const int shownKeys = std::min(kShownKeys, static_cast<int>(keys.size()));
+    m_keyTable->setRowCount(shownKeys);
+    for (int row = 0; row < shownKeys; ++row) {
+        const kafka::HeavyHitters::Entry &entry = keys[static_cast<std::size_t>(row)];
+        setCell(m_keyTable, row, 0, keyText(entry.key), false);
+        setCell(m_keyTable, row, 1, locale.toString(entry.count), true);
+        setCell(m_keyTable, row, 2, percent(static_cast<double>(entry.count), records), true);
+    }
+
+    m_sizeTable->setRowCount(0);
+    for (int bucket = 0; bucket < kafka::SizeHistogram::kBuckets; ++bucket) {
+        if (sizes.count(bucket) == 0)
+            continue;
+        const int row = m_sizeTable->rowCount();
+        m_sizeTable->insertRow(row);
+        const auto low = static_cast<qint64>(kafka::SizeHistogram::lowerBound(bucket));
+        const auto high = static_cast<qint64>(kafka::SizeHistogram::lowerBound(bucket + 1));
+        setCell(m_sizeTable, row, 0,
+                tr("%1 – %2").arg(locale.formattedDataSize(low), locale.formattedDataSize(high)),
+                false);
+        setCell(m_sizeTable, row, 1, locale.toString(sizes.count(bucket)), true);
+        setCell(m_sizeTable, row, 2, percent(static_cast<double>(sizes.count(bucket)), records),
+                true);
+    }
+
+    const kafka::TimeSeries &series = result->throughput();
+    const double seconds = static_cast<double>(series.width()) / 1000;
+    m_timeTable->setRowCount(series.bucketCount());
+    for (int row = 0; row < series.bucketCount(); ++row) {
+        const quint64 count = series.count(row);
+        setCell(m_timeTable, row, 0, timeText(series.origin() + row * series.width()), false);
+        setCell(m_timeTable, row, 1, locale.toString(count), true);
+        setCell(m_timeTable, row, 2,
+                locale.toString(static_cast<double>(count) / seconds, 'f', 1), true);
+    }
+}
+
+void StatsDialog::updateControls()
+{
+    const bool running = m_stats->isRunning();
+    m_startButton->setText(running ? tr("Cancel") : tr("Scan"));
+    m_startButton->setEnabled(running || m_source != nullptr);
+    m_partitionCombo->setEnabled(!running);
+    m_windowCheck->setEnabled(!running);
+    m_fromTimeEdit->setEnabled(!running && m_windowCheck->isChecked());
+    m_toTimeEdit->setEnabled(!running && m_windowCheck->isChecked());
+}
+
+// Closing the dialog stops the scan; the last result stays on screen.
+void StatsDialog::reject()
+{
+    m_stats->cancel();
+    QDialog::reject();
+}
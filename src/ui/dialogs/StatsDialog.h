@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QDialog>
+#include <QVector>
+
+#include <memory>
+
+class QCheckBox;
+class QComboBox;
+class QDateTimeEdit;
+class QLabel;
+class QProgressBar;
+class QTableWidget;
+class QTabWidget;
+
+class FlatButton;
+
+namespace kafka {
+class BatchSource;
+class TopicStats;
+}
+
+/**
+ * @brief View → Topic statistics: profiles the open topic, or one of its
+ * partitions, optionally within a time window.
+ *
+ * Shows partition skew, the heaviest keys, the key cardinality, a size
+ * histogram and records over time, all from fixed-size sketches, so the
+ * scan needs the same memory for a thousand records as for billions.
+ * Closing the dialog stops a running scan.
+ */
+class StatsDialog final : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit StatsDialog(QWidget *parent = nullptr);
+
+    /**
+     * @brief Topic to profile, preselecting all partitions; a running scan
+     * keeps its own source.
+     */
+    void setTarget(std::shared_ptr<kafka::BatchSource> source, const QVector<qint32> &partitions);
+
+protected:
+    void reject() override;
+
+private:
+    void setupUi();
+    void startOrCancel();
+    void onProgress(qint64 scanned, qint64 total);
+    void onFinished();
+    void showResult();
+    void updateControls();
+
+    kafka::TopicStats *m_stats = nullptr;
+    std::shared_ptr<kafka::BatchSource> m_source;
+    QVector<qint32> m_partitions;
+
+    QComboBox *m_partitionCombo = nullptr;
+    QCheckBox *m_windowCheck = nullptr;
+    QDateTimeEdit *m_fromTimeEdit = nullptr;
+    QDateTimeEdit *m_toTimeEdit = nullptr;
+    FlatButton *m_startButton = nullptr;
+    QProgressBar *m_progressBar = nullptr;
+    QLabel *m_summaryLabel = nullptr;
+    QTabWidget *m_tabs = nullptr;
+    QTableWidget *m_partitionTable = nullptr;
+    QTableWidget *m_keyTable = nullptr;
+    QTableWidget *m_sizeTable = nullptr;
+    QTableWidget *m_timeTable = nullptr;
+    QLabel *m_statusLabel = nullptr;
+};
@@ -0,0 +1,172 @@
+#include "ui/models/ConsumerLagModel.h"
+
+#include <QColor>
+
+#include <algorithm>
+#include <functional>
+
+#include "core/protocol/ApiKeys.h"
+#include "core/trace/Trace.h"
+
+ConsumerLagModel::ConsumerLagModel(QObject *parent) : QAbstractTableModel(parent) {}
+
+void ConsumerLagModel::clear() {
+  beginResetModel();
+  m_rows.clear();
+  m_rowOf.clear();
+  m_totalLag = 0;
+  endResetModel();
+}
+
+void ConsumerLagModel::apply(const kafka::LagDelta &delta) {
+  KAFKA_TRACE_SCOPE("apply lag delta");
+  removeRows(delta.removed);
+
+  QVector<int> updated;
+  QVector<kafka::LagRow> added;
+  for (const kafka::LagRow &row : delta.changed) {
+    const auto it = m_rowOf.constFind(kafka::LagKey{row.group, row.tp});
+    if (it == m_rowOf.cend()) {
+      added.append(row);
+      continue;
+    }
+    kafka::LagRow &current = m_rows[it.value()];
+    m_totalLag -= qMax<qint64>(0, current.lag());
+    current = row;
+    m_totalLag += qMax<qint64>(0, current.lag());
+    updated.append(it.value());
+  }
+
+  // Adjacent updated rows are announced together.
+  std::sort(updated.begin(), updated.end());
+  for (int i = 0; i < updated.size();) {
+    int last = i;
+    while (last + 1 < updated.size() && updated[last + 1] == updated[last] + 1)
+      ++last;
+    emit dataChanged(index(updated[i], 0), index(updated[last], ColumnCount - 1));
+    i = last + 1;
+  }
+
+  if (!added.isEmpty()) {
+    const int first = m_rows.size();
+    beginInsertRows(QModelIndex(), first, first + added.size() - 1);
+    m_rows.reserve(first + added.size());
+    for (const kafka::LagRow &row : std::as_const(added)) {
+      m_rowOf.insert(kafka::LagKey{row.group, row.tp}, m_rows.size());
+      m_totalLag += qMax<qint64>(0, row.lag());
+      m_rows.append(row);
+    }
+    endInsertRows();
+  }
+}
+
+void ConsumerLagModel::removeRows(const QVector<kafka::LagKey> &keys) {
+  QVector<int> rows;
+  rows.reserve(keys.size());
+  for (const kafka::LagKey &key : keys) {
+    const auto it = m_rowOf.constFind(key);
+    if (it != m_rowOf.cend())
+      rows.append(it.value());
+  }
+  if (rows.isEmpty())
+    return;
+
+  // From the bottom up, so the rows of earlier ranges keep their index.
+  std::sort(rows.begin(), rows.end(), std::greater<int>());
+  for (int i = 0; i < rows.size();) {
+    int last = i;
+    while (last + 1 < rows.size() && rows[last + 1] == rows[last] - 1)
+      ++last;
+    const int first = rows[last];
+    const int count = last - i + 1;
+    beginRemoveRows(QModelIndex(), first, rows[i]);
+    for (int row = first; row < first + count; ++row) {
+      m_totalLag -= qMax<qint64>(0, m_rows[row].lag());
+      m_rowOf.remove(kafka::LagKey{m_rows[row].group, m_rows[row].tp});
+    }
+    m_rows.remove(first, count);
+    endRemoveRows();
+    i = last + 1;
+  }
+
+  for (int row = rows.last(); row < m_rows.size(); ++row)
+    m_rowOf[kafka::LagKey{m_rows[row].group, m_rows[row].tp}] = row;
+}
+
+int ConsumerLagModel::rowCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : m_rows.size();
+}
+
+int ConsumerLagModel::columnCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ConsumerLagModel::headerData(int section, Qt::Orientation orientation, int role) const {
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QAbstractTableModel::headerData(section, orientation, role);
+
+  switch (section) {
+  case GroupColumn:
+    return tr("Group");
+  case TopicColumn:
+    return tr("Topic");
+  case PartitionColumn:
+    return tr("Partition");
+  case CommittedColumn:
+    return tr("Committed");
+  case EndOffsetColumn:
+    return tr("End offset");
+  case LagColumn:
+    return tr("Lag");
+  case CoordinatorColumn:
+    return tr("Coordinator");
+  default:
+    return QVariant();
+  }
+}
+
+QVariant ConsumerLagModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || index.row() >= m_rows.size())
+    return QVariant();
+
+  const int column = index.column();
+  if (role == Qt::TextAlignmentRole) {
+    if (column == GroupColumn || column == TopicColumn)
+      return int(Qt::AlignLeft | Qt::AlignVCenter);
+    return int(Qt::AlignRight | Qt::AlignVCenter);
+  }
+
+  const kafka::LagRow &row = m_rows[index.row()];
+  if (role == Qt::ForegroundRole) {
+    if (row.errorCode != 0)
+      return QColor(Qt::red);
+    return column == LagColumn && row.lag() < 0 ? QVariant(QColor(Qt::gray)) : QVariant();
+  }
+  if (role == Qt::ToolTipRole) {
+    if (row.errorCode != 0)
+      return QString::fromLatin1(kafka::errorName(row.errorCode));
+    return QVariant();
+  }
+  if (role != Qt::DisplayRole)
+    return QVariant();
+
+  // Unknown offsets stay empty so the column still sorts as numbers.
+  switch (column) {
+  case GroupColumn:
+    return row.group;
+  case TopicColumn:
+    return row.tp.topic;
+  case PartitionColumn:
+    return row.tp.partition;
+  case CommittedColumn:
+    return row.committed >= 0 ? QVariant(row.committed) : QVariant();
+  case EndOffsetColumn:
+    return row.endOffset >= 0 ? QVariant(row.endOffset) : QVariant();
+  case LagColumn:
+    return row.lag() >= 0 ? QVariant(row.lag()) : QVariant();
+  case CoordinatorColumn:
+    return row.coordinator >= 0 ? QVariant(row.coordinator) : QVariant();
+  default:
+    return QVariant();
+  }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QVector>
+
+#include "core/groups/LagMonitor.h"
+
+/**
+ * @brief One row per consumer group and partition, kept up to date from
+ * kafka::LagMonitor deltas.
+ *
+ * apply() touches only what a refresh changed: updated rows are announced
+ * with one dataChanged() per run of adjacent rows, new rows with a single
+ * beginInsertRows() at the end, and removed rows with one
+ * beginRemoveRows() per contiguous range, so a refresh of a cluster where
+ * little moved costs the view almost nothing.
+ */
+class ConsumerLagModel final : public QAbstractTableModel {
+  Q_OBJECT
+
+public:
+  enum Column {
+    GroupColumn,
+    TopicColumn,
+    PartitionColumn,
+    CommittedColumn,
+    EndOffsetColumn,
+    LagColumn,
+    CoordinatorColumn,
+    ColumnCount
+  };
+
+  explicit ConsumerLagModel(QObject *parent = nullptr);
+
+  void apply(const kafka::LagDelta &delta);
+  void clear();
+
+  /** Sum of the known lag of every row. */
+  qint64 totalLag() const { return m_totalLag; }
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+private:
+  void removeRows(const QVector<kafka::LagKey> &keys);
+
+  QVector<kafka::LagRow> m_rows;
+  QHash<kafka::LagKey, int> m_rowOf;
+  qint64 m_totalLag = 0;
+};
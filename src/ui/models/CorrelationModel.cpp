@@ -0,0 +1,145 @@
+#include "ui/models/CorrelationModel.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QLocale>
+
+#include <algorithm>
+
+namespace {
+QString valueText(const QByteArray &bytes) {
+  QString text = QString::fromUtf8(bytes);
+  for (QChar &ch : text) {
+    if (ch.category() == QChar::Other_Control)
+      ch = QLatin1Char(' ');
+  }
+  return text;
+}
+
+int popCount(quint64 bits) {
+  int count = 0;
+  for (; bits != 0; bits &= bits - 1)
+    ++count;
+  return count;
+}
+
+QString spanText(qint64 ms) {
+  if (ms < 1000)
+    return QCoreApplication::translate("CorrelationModel", "%1 ms").arg(ms);
+  return QCoreApplication::translate("CorrelationModel", "%1 s")
+      .arg(QLocale().toString(static_cast<double>(ms) / 1000, 'f', 3));
+}
+} // namespace
+
+CorrelationModel::CorrelationModel(QObject *parent) : QAbstractTableModel(parent) {}
+
+// Hits of known values are merged in place and reported through one
+// dataChanged() over the touched rows; new values become rows in one
+// insertion.
+void CorrelationModel::append(const QVector<kafka::CorrelationHit> &hits) {
+  if (hits.isEmpty())
+    return;
+
+  const int oldCount = m_groups.size();
+  QVector<CorrelationGroup> added;
+  int firstChanged = oldCount;
+  int lastChanged = -1;
+  const auto byTime = [](const kafka::CorrelationHit &a, const kafka::CorrelationHit &b) {
+    return a.timestamp < b.timestamp;
+  };
+
+  for (const kafka::CorrelationHit &hit : hits) {
+    int row = m_rows.value(hit.value, -1);
+    CorrelationGroup *group = nullptr;
+    if (row < 0) {
+      row = oldCount + added.size();
+      m_rows.insert(hit.value, row);
+      added.append(CorrelationGroup());
+      group = &added.last();
+      group->value = hit.value;
+    } else if (row >= oldCount) {
+      group = &added[row - oldCount];
+    } else {
+      group = &m_groups[row];
+      firstChanged = std::min(firstChanged, row);
+      lastChanged = std::max(lastChanged, row);
+    }
+    group->targets |= quint64(1) << hit.target;
+    group->hits.insert(std::upper_bound(group->hits.begin(), group->hits.end(), hit, byTime),
+                       hit);
+  }
+
+  if (lastChanged >= 0)
+    emit dataChanged(index(firstChanged, 0), index(lastChanged, ColumnCount - 1));
+  if (!added.isEmpty()) {
+    beginInsertRows(QModelIndex(), oldCount, oldCount + added.size() - 1);
+    m_groups += added;
+    endInsertRows();
+  }
+}
+
+void CorrelationModel::clear() {
+  beginResetModel();
+  m_groups.clear();
+  m_rows.clear();
+  endResetModel();
+}
+
+int CorrelationModel::rowCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : m_groups.size();
+}
+
+int CorrelationModel::columnCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant CorrelationModel::headerData(int section, Qt::Orientation orientation, int role) const {
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QAbstractTableModel::headerData(section, orientation, role);
+
+  switch (section) {
+  case ValueColumn:
+    return tr("Value");
+  case TopicsColumn:
+    return tr("Topics");
+  case MessagesColumn:
+    return tr("Messages");
+  case FirstColumn:
+    return tr("First");
+  case SpanColumn:
+    return tr("Span");
+  default:
+    return QVariant();
+  }
+}
+
+QVariant CorrelationModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || index.row() >= m_groups.size())
+    return QVariant();
+
+  const int column = index.column();
+  if (role == Qt::TextAlignmentRole) {
+    if (column == TopicsColumn || column == MessagesColumn || column == SpanColumn)
+      return int(Qt::AlignRight | Qt::AlignVCenter);
+    return int(Qt::AlignLeft | Qt::AlignVCenter);
+  }
+  if (role != Qt::DisplayRole)
+    return QVariant();
+
+  const CorrelationGroup &group = m_groups.at(index.row());
+  switch (column) {
+  case ValueColumn:
+    return valueText(group.value);
+  case TopicsColumn:
+    return popCount(group.targets);
+  case MessagesColumn:
+    return group.hits.size();
+  case FirstColumn:
+    return QDateTime::fromMSecsSinceEpoch(group.hits.first().timestamp, Qt::UTC)
+        .toString(Qt::ISODateWithMs);
+  case SpanColumn:
+    return spanText(group.hits.last().timestamp - group.hits.first().timestamp);
+  default:
+    return QVariant();
+  }
+}
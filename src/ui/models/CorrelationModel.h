@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+
+#include "core/correlate/CorrelationScan.h"
+
+/**
+ * @brief One correlation value and its records, oldest first.
+ */
+struct CorrelationGroup {
+  QByteArray value;
+  /** Bit i is set when a record of target i carries the value. */
+  quint64 targets = 0;
+  QVector<kafka::CorrelationHit> hits;
+};
+
+/**
+ * @brief The values a kafka::CorrelationScan joined, one row each, in the
+ * order they were found. Hits arrive in no particular order and are
+ * sorted into their group's timeline as they stream in.
+ */
+class CorrelationModel final : public QAbstractTableModel {
+  Q_OBJECT
+
+public:
+  enum Column { ValueColumn, TopicsColumn, MessagesColumn, FirstColumn, SpanColumn, ColumnCount };
+
+  explicit CorrelationModel(QObject *parent = nullptr);
+
+  void append(const QVector<kafka::CorrelationHit> &hits);
+  void clear();
+  const CorrelationGroup &groupAt(int row) const { return m_groups.at(row); }
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+private:
+  QVector<CorrelationGroup> m_groups;
+  QHash<QByteArray, int> m_rows;
+};
@@ -0,0 +1,111 @@
+#include "ui/models/FilteredMessageModel.h"
+
+#include <QColor>
+#include <QDateTime>
+
+namespace {
+constexpr int kPreviewBytes = 256;
+
+QString previewText(const QByteArray &bytes, bool truncated) {
+  QString text = QString::fromUtf8(bytes.constData(), qMin(bytes.size(), kPreviewBytes));
+  for (QChar &ch : text) {
+    if (ch.category() == QChar::Other_Control)
+      ch = QLatin1Char(' ');
+  }
+  if (truncated || bytes.size() > kPreviewBytes)
+    text += QChar(0x2026);
+  return text;
+}
+} // namespace
+
+FilteredMessageModel::FilteredMessageModel(QObject *parent) : QAbstractTableModel(parent) {}
+
+void FilteredMessageModel::append(const QVector<kafka::FilterMatch> &matches) {
+  if (matches.isEmpty())
+    return;
+  beginInsertRows(QModelIndex(), m_matches.size(), m_matches.size() + matches.size() - 1);
+  m_matches += matches;
+  endInsertRows();
+}
+
+void FilteredMessageModel::clear() {
+  beginResetModel();
+  m_matches.clear();
+  endResetModel();
+}
+
+int FilteredMessageModel::rowCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : m_matches.size();
+}
+
+int FilteredMessageModel::columnCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant FilteredMessageModel::headerData(int section, Qt::Orientation orientation,
+                                          int role) const {
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QAbstractTableModel::headerData(section, orientation, role);
+
+  switch (section) {
+  case PartitionColumn:
+    return tr("Partition");
+  case OffsetColumn:
+    return tr("Offset");
+  case TimestampColumn:
+    return tr("Timestamp");
+  case KeyColumn:
+    return tr("Key");
+  case ValueColumn:
+    return tr("Value");
+  case SizeColumn:
+    return tr("Size");
+  default:
+    return QVariant();
+  }
+}
+
+QVariant FilteredMessageModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || index.row() >= m_matches.size())
+    return QVariant();
+
+  const int column = index.column();
+  if (role == Qt::TextAlignmentRole) {
+    if (column == PartitionColumn || column == OffsetColumn || column == SizeColumn)
+      return int(Qt::AlignRight | Qt::AlignVCenter);
+    return int(Qt::AlignLeft | Qt::AlignVCenter);
+  }
+
+  const kafka::FilterMatch &match = m_matches.at(index.row());
+  if (role == Qt::ForegroundRole) {
+    const bool isNull = (column == KeyColumn && match.key.isNull()) ||
+                        (column == ValueColumn && match.value.isNull());
+    return isNull ? QVariant(QColor(Qt::gray)) : QVariant();
+  }
+  if (role == Qt::ToolTipRole) {
+    if (column == ValueColumn && match.valueTruncated)
+      return tr("Only the first %n byte(s) of the value are kept; double-click to open the "
+                "message",
+                nullptr, kafka::TopicFilter::kMaxValueBytes);
+    return QVariant();
+  }
+  if (role != Qt::DisplayRole)
+    return QVariant();
+
+  switch (column) {
+  case PartitionColumn:
+    return match.partition;
+  case OffsetColumn:
+    return match.offset;
+  case TimestampColumn:
+    return QDateTime::fromMSecsSinceEpoch(match.timestamp, Qt::UTC).toString(Qt::ISODateWithMs);
+  case KeyColumn:
+    return match.key.isNull() ? tr("(null)") : previewText(match.key, false);
+  case ValueColumn:
+    return match.value.isNull() ? tr("(null)") : previewText(match.value, match.valueTruncated);
+  case SizeColumn:
+    return match.size;
+  default:
+    return QVariant();
+  }
+}
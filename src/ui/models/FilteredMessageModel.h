@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+#include "core/filter/TopicFilter.h"
+
+/**
+ * @brief Records that passed a kafka::TopicFilter, appended as they stream
+ * in. Only matches ever reach the model; they arrive in no particular
+ * order.
+ */
+class FilteredMessageModel final : public QAbstractTableModel {
+  Q_OBJECT
+
+public:
+  enum Column {
+    PartitionColumn,
+    OffsetColumn,
+    TimestampColumn,
+    KeyColumn,
+    ValueColumn,
+    SizeColumn,
+    ColumnCount
+  };
+
+  explicit FilteredMessageModel(QObject *parent = nullptr);
+
+  void append(const QVector<kafka::FilterMatch> &matches);
+  void clear();
+  const kafka::FilterMatch &matchAt(int row) const { return m_matches.at(row); }
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+private:
+  QVector<kafka::FilterMatch> m_matches;
+};
@@ -0,0 +1,182 @@
+#include "ui/models/LiveTailModel.h"
+
+#include <QColor>
+#include <QDateTime>
+
+#include "core/source/BatchSource.h"
+#include "core/trace/Trace.h"
+
+namespace {
+constexpr int kPreviewBytes = 256;
+
+QString previewText(const QByteArray &bytes, bool truncated) {
+  QString text = QString::fromUtf8(bytes.constData(), qMin(bytes.size(), kPreviewBytes));
+  for (QChar &ch : text) {
+    if (ch.category() == QChar::Other_Control)
+      ch = QLatin1Char(' ');
+  }
+  if (truncated || bytes.size() > kPreviewBytes)
+    text += QChar(0x2026);
+  return text;
+}
+} // namespace
+
+LiveTailModel::LiveTailModel(QObject *parent) : QAbstractTableModel(parent) {
+  m_frameTimer.setInterval(kFrameIntervalMs);
+  m_frameTimer.setTimerType(Qt::PreciseTimer);
+  connect(&m_frameTimer, &QTimer::timeout, this, &LiveTailModel::drainFrame);
+}
+
+void LiveTailModel::start(std::shared_ptr<kafka::BatchSource> source,
+                          const QVector<qint32> &partitions) {
+  stop();
+  beginResetModel();
+  m_ring.clear();
+  m_ring.resize(kCapacity);
+  m_head = 0;
+  m_count = 0;
+  endResetModel();
+  m_received = 0;
+  m_frames = 0;
+  m_largestFrame = 0;
+  m_evicted = 0;
+  m_reportedDropped = 0;
+  m_reportedError.clear();
+
+  // Reserved on first use, then kept: a frame never outgrows one queue.
+  m_staging.reserve(kafka::TopicTail::kQueueCapacity);
+  m_tail.start(std::move(source), partitions);
+  if (m_tail.isRunning())
+    m_frameTimer.start();
+  emit statsChanged();
+}
+
+// The rows stay so the last frames can still be read; only what is still
+// queued is lost.
+void LiveTailModel::stop() {
+  if (!m_tail.isRunning())
+    return;
+  drainFrame();
+  m_frameTimer.stop();
+  m_tail.stop();
+  emit statsChanged();
+}
+
+void LiveTailModel::drainFrame() {
+  KAFKA_TRACE_SCOPE("tail frame");
+  // Bounded by one queue's worth, so a frame never outlasts the producer.
+  m_staging.clear();
+  kafka::TailRecord record;
+  while (m_staging.size() < kafka::TopicTail::kQueueCapacity && m_tail.pop(&record))
+    m_staging.push_back(std::move(record));
+
+  const int received = static_cast<int>(m_staging.size());
+  if (received > 0) {
+    KAFKA_TRACE_COUNTER("tail records per frame", received);
+    // A burst larger than the ring only keeps its newest records.
+    const int kept = qMin(received, kCapacity);
+    const int skipped = received - kept;
+    const int overflow = m_count + kept - kCapacity;
+    if (overflow > 0) {
+      beginRemoveRows(QModelIndex(), 0, overflow - 1);
+      m_head = (m_head + static_cast<std::size_t>(overflow)) % m_ring.size();
+      m_count -= overflow;
+      endRemoveRows();
+    }
+    beginInsertRows(QModelIndex(), m_count, m_count + kept - 1);
+    for (int i = skipped; i < received; ++i) {
+      m_ring[(m_head + static_cast<std::size_t>(m_count)) % m_ring.size()] =
+          std::move(m_staging[static_cast<std::size_t>(i)]);
+      ++m_count;
+    }
+    endInsertRows();
+
+    m_evicted += static_cast<quint64>(qMax(0, overflow) + skipped);
+    m_received += static_cast<quint64>(received);
+    ++m_frames;
+    m_largestFrame = qMax(m_largestFrame, received);
+  }
+
+  const quint64 dropped = m_tail.droppedCount();
+  const QString error = m_tail.errorString();
+  if (received > 0 || dropped != m_reportedDropped || error != m_reportedError) {
+    m_reportedDropped = dropped;
+    m_reportedError = error;
+    emit statsChanged();
+  }
+}
+
+int LiveTailModel::rowCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : m_count;
+}
+
+int LiveTailModel::columnCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant LiveTailModel::headerData(int section, Qt::Orientation orientation, int role) const {
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QAbstractTableModel::headerData(section, orientation, role);
+
+  switch (section) {
+  case PartitionColumn:
+    return tr("Partition");
+  case OffsetColumn:
+    return tr("Offset");
+  case TimestampColumn:
+    return tr("Timestamp");
+  case KeyColumn:
+    return tr("Key");
+  case ValueColumn:
+    return tr("Value");
+  case SizeColumn:
+    return tr("Size");
+  default:
+    return QVariant();
+  }
+}
+
+QVariant LiveTailModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || index.row() >= m_count)
+    return QVariant();
+
+  const int column = index.column();
+  if (role == Qt::TextAlignmentRole) {
+    if (column == PartitionColumn || column == OffsetColumn || column == SizeColumn)
+      return int(Qt::AlignRight | Qt::AlignVCenter);
+    return int(Qt::AlignLeft | Qt::AlignVCenter);
+  }
+
+  const kafka::TailRecord &record = recordAt(index.row());
+  if (role == Qt::ForegroundRole) {
+    const bool isNull = (column == KeyColumn && record.key.isNull()) ||
+                        (column == ValueColumn && record.value.isNull());
+    return isNull ? QVariant(QColor(Qt::gray)) : QVariant();
+  }
+  if (role == Qt::ToolTipRole) {
+    if (column == ValueColumn && record.valueTruncated)
+      return tr("Only the first %n byte(s) of the value are kept while tailing", nullptr,
+                kafka::TopicTail::kMaxValueBytes);
+    return QVariant();
+  }
+  if (role != Qt::DisplayRole)
+    return QVariant();
+
+  switch (column) {
+  case PartitionColumn:
+    return record.partition;
+  case OffsetColumn:
+    return record.offset;
+  case TimestampColumn:
+    return QDateTime::fromMSecsSinceEpoch(record.timestamp, Qt::UTC).toString(Qt::ISODateWithMs);
+  case KeyColumn:
+    return record.key.isNull() ? tr("(null)") : previewText(record.key, false);
+  case ValueColumn:
+    return record.value.isNull() ? tr("(null)")
+                                 : previewText(record.value, record.valueTruncated);
+  case SizeColumn:
+    return record.size;
+  default:
+    return QVariant();
+  }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QTimer>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+#include "core/tail/TopicTail.h"
+
+namespace kafka {
+class BatchSource;
+}
+
+/**
+ * @brief The newest records of a set of partitions, as they are produced.
+ *
+ * Records arrive from a kafka::TopicTail worker through its lock-free
+ * queue. The model drains the queue on a frame timer, never per record,
+ * and announces everything that arrived during a frame with one
+ * beginInsertRows()/endInsertRows() pair, so the view relayouts at most
+ * once per frame however fast the topic is written.
+ *
+ * Rows live in a ring of kCapacity records; once it is full, each frame
+ * first removes the oldest rows in one beginRemoveRows() call. Records the
+ * ring had no room for and records the queue dropped are both counted.
+ */
+class LiveTailModel final : public QAbstractTableModel {
+  Q_OBJECT
+
+public:
+  enum Column {
+    PartitionColumn,
+    OffsetColumn,
+    TimestampColumn,
+    KeyColumn,
+    ValueColumn,
+    SizeColumn,
+    ColumnCount
+  };
+
+  /** Rows kept; older ones are evicted. */
+  static constexpr int kCapacity = 100000;
+  /** About one display frame at 60 Hz. */
+  static constexpr int kFrameIntervalMs = 16;
+
+  explicit LiveTailModel(QObject *parent = nullptr);
+
+  /** Clears the rows and follows @p partitions of @p source from their end. */
+  void start(std::shared_ptr<kafka::BatchSource> source, const QVector<qint32> &partitions);
+  void stop();
+  bool isFollowing() const { return m_tail.isRunning(); }
+
+  /** Records received since start(). */
+  quint64 receivedCount() const { return m_received; }
+  /** Frames that inserted rows; received / frames is the coalescing factor. */
+  quint64 frameCount() const { return m_frames; }
+  /** Most rows inserted by a single frame. */
+  int largestFrame() const { return m_largestFrame; }
+  /** Records the tail worker dropped because the queue was full. */
+  quint64 droppedCount() const { return m_tail.droppedCount(); }
+  /** Rows pushed out of the ring by newer ones. */
+  quint64 evictedCount() const { return m_evicted; }
+  QString errorString() const { return m_tail.errorString(); }
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+signals:
+  /** At most once per frame, after rows changed or a counter moved. */
+  void statsChanged();
+
+private:
+  void drainFrame();
+  const kafka::TailRecord &recordAt(int row) const {
+    return m_ring[(m_head + static_cast<std::size_t>(row)) % m_ring.size()];
+  }
+
+  kafka::TopicTail m_tail;
+  QTimer m_frameTimer;
+  std::vector<kafka::TailRecord> m_ring;
+  std::size_t m_head = 0;
+  int m_count = 0;
+  // Reused by every frame so draining does not allocate.
+  std::vector<kafka::TailRecord> m_staging;
+  quint64 m_received = 0;
+  quint64 m_frames = 0;
+  int m_largestFrame = 0;
+  quint64 m_evicted = 0;
+  quint64 m_reportedDropped = 0;
+  QString m_reportedError;
+};
@@ -0,0 +1,387 @@
+#include "ui/models/MergedMessageModel.h"
+
+#include <QColor>
+#include <QDateTime>
+
+#include <unordered_set>
+#include <utility>
+
+#include "core/source/BatchSource.h"
+#include "core/trace/Trace.h"
+
+namespace {
+constexpr int kPreviewBytes = 256;
+
+QString previewText(std::string_view bytes) {
+  const auto size = static_cast<int>(qMin<std::size_t>(bytes.size(), kPreviewBytes));
+  QString text = QString::fromUtf8(bytes.data(), size);
+  for (QChar &ch : text) {
+    if (ch.category() == QChar::Other_Control)
+      ch = QLatin1Char(' ');
+  }
+  if (bytes.size() > static_cast<std::size_t>(kPreviewBytes))
+    text += QChar(0x2026);
+  return text;
+}
+} // namespace
+
+struct MergedMessageModel::MergeRun {
+  std::shared_ptr<kafka::BatchSource> source;
+  QVector<qint32> partitions;
+  qint64 timestamp = 0;
+  std::unique_ptr<kafka::TimestampMerge> merge;
+  // Page the merge stands at the start of; -1 when it must be restored.
+  qint64 atPage = -1;
+};
+
+MergedMessageModel::MergedMessageModel(QObject *parent) : QAbstractTableModel(parent) {
+  // Pages are merged in order from one merge; a second thread would only
+  // wait for it.
+  m_pool.setMaxThreadCount(1);
+}
+
+MergedMessageModel::~MergedMessageModel() {
+  m_pool.clear();
+  m_pool.waitForDone();
+}
+
+void MergedMessageModel::start(std::shared_ptr<kafka::BatchSource> source,
+                               const QVector<qint32> &partitions, qint64 timestamp) {
+  beginResetModel();
+  ++m_generation;
+  m_pool.clear();
+  m_source = std::move(source);
+  m_partitions = partitions;
+  m_startTimestamp = timestamp;
+  m_run.reset();
+  m_checkpoints.clear();
+  m_mergedPages = 0;
+  m_exposedRows = 0;
+  m_complete = false;
+  m_failed = false;
+  m_pages.clear();
+  m_pendingPages.clear();
+  m_residentBytes = 0;
+  endResetModel();
+  emit residencyChanged(0, 0);
+
+  if (!m_source || m_partitions.isEmpty())
+    return;
+  // A worker may still be finishing a page of the previous run; it keeps
+  // its own run, so the two never share a merge.
+  m_run = std::make_shared<MergeRun>();
+  m_run->source = m_source;
+  m_run->partitions = m_partitions;
+  m_run->timestamp = timestamp;
+  requestPage(0);
+}
+
+void MergedMessageModel::seekToTimestamp(qint64 timestamp) {
+  start(m_source, m_partitions, timestamp);
+}
+
+void MergedMessageModel::clear() { start(nullptr, {}, 0); }
+
+int MergedMessageModel::rowCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : m_exposedRows;
+}
+
+int MergedMessageModel::columnCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : ColumnCount;
+}
+
+bool MergedMessageModel::canFetchMore(const QModelIndex &parent) const {
+  return !parent.isValid() && m_run && !m_complete && !m_failed &&
+         !m_pendingPages.contains(m_mergedPages);
+}
+
+void MergedMessageModel::fetchMore(const QModelIndex &parent) {
+  if (canFetchMore(parent))
+    requestPage(m_mergedPages);
+}
+
+QVariant MergedMessageModel::headerData(int section, Qt::Orientation orientation,
+                                        int role) const {
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QAbstractTableModel::headerData(section, orientation, role);
+
+  switch (section) {
+  case PartitionColumn:
+    return tr("Partition");
+  case OffsetColumn:
+    return tr("Offset");
+  case TimestampColumn:
+    return tr("Timestamp");
+  case KeyColumn:
+    return tr("Key");
+  case ValueColumn:
+    return tr("Value");
+  case SizeColumn:
+    return tr("Size");
+  default:
+    return QVariant();
+  }
+}
+
+QVariant MergedMessageModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || index.row() >= m_exposedRows)
+    return QVariant();
+
+  const int column = index.column();
+  if (role == Qt::TextAlignmentRole) {
+    if (column == PartitionColumn || column == OffsetColumn || column == SizeColumn)
+      return int(Qt::AlignRight | Qt::AlignVCenter);
+    return int(Qt::AlignLeft | Qt::AlignVCenter);
+  }
+  if (role != Qt::DisplayRole && role != Qt::ForegroundRole)
+    return QVariant();
+
+  const qint64 page = pageOf(index.row());
+  const auto it = m_pages.constFind(page);
+  if (it == m_pages.cend()) {
+    requestPage(page);
+    return QVariant();
+  }
+
+  using Arena = kafka::RecordArena;
+  const Page &loaded = *it.value();
+  const auto slotIndex = static_cast<std::size_t>(index.row() - page * kPageSize);
+  const Arena::Slot &row = loaded.records.at(index.row());
+  if (role == Qt::ForegroundRole) {
+    const bool isNull = (column == KeyColumn && row.has(Arena::KeyNull)) ||
+                        (column == ValueColumn && row.has(Arena::ValueNull));
+    return isNull ? QVariant(QColor(Qt::gray)) : QVariant();
+  }
+
+  switch (column) {
+  case PartitionColumn:
+    return loaded.partitions[slotIndex];
+  case OffsetColumn:
+    return loaded.offsets[slotIndex];
+  case TimestampColumn:
+    return QDateTime::fromMSecsSinceEpoch(row.timestamp, Qt::UTC).toString(Qt::ISODateWithMs);
+  case KeyColumn:
+    return row.has(Arena::KeyNull) ? tr("(null)") : previewText(row.key);
+  case ValueColumn:
+    return row.has(Arena::ValueNull) ? tr("(null)") : previewText(row.value);
+  case SizeColumn:
+    return row.size;
+  default:
+    return QVariant();
+  }
+}
+
+bool MergedMessageModel::positionAt(int row, qint32 *partition, qint64 *offset) const {
+  if (row < 0 || row >= m_exposedRows)
+    return false;
+  const qint64 page = pageOf(row);
+  const auto it = m_pages.constFind(page);
+  if (it == m_pages.cend())
+    return false;
+  const auto slotIndex = static_cast<std::size_t>(row - page * kPageSize);
+  *partition = it.value()->partitions[slotIndex];
+  *offset = it.value()->offsets[slotIndex];
+  return true;
+}
+
+bool MergedMessageModel::valueAt(int row, std::shared_ptr<const void> *owner,
+                                 std::string_view *value, bool *isNull) const {
+  if (row < 0 || row >= m_exposedRows)
+    return false;
+  const auto it = m_pages.constFind(pageOf(row));
+  if (it == m_pages.cend())
+    return false;
+
+  using Arena = kafka::RecordArena;
+  const Arena::Slot &slot = it.value()->records.at(row);
+  *owner = it.value();
+  *value = slot.value;
+  *isNull = slot.has(Arena::ValueNull);
+  return true;
+}
+
+void MergedMessageModel::setViewport(int firstRow, int lastRow) {
+  m_viewportFirst = qMax(0, firstRow);
+  m_viewportLast = qMax(m_viewportFirst, lastRow);
+  m_window->firstPage.store(pageOf(m_viewportFirst));
+  m_window->lastPage.store(pageOf(m_viewportLast));
+  evictPages();
+
+  // Only pages merged before can be rebuilt; the next new one comes
+  // through fetchMore().
+  const qint64 firstPage = qMax<qint64>(0, pageOf(m_viewportFirst) - 1);
+  const qint64 lastPage = qMin<qint64>(pageOf(m_viewportLast) + 1, m_mergedPages - 1);
+  for (qint64 page = firstPage; page <= lastPage; ++page)
+    requestPage(page);
+}
+
+void MergedMessageModel::requestPage(qint64 page) const {
+  if (!m_run || m_pages.contains(page) || m_pendingPages.contains(page) ||
+      page > m_mergedPages)
+    return;
+
+  // Page 0 of a new merge starts with the seek; every other page from the
+  // checkpoint its predecessor left.
+  QVector<kafka::MergePosition> checkpoint;
+  if (page < m_checkpoints.size())
+    checkpoint = m_checkpoints.at(static_cast<int>(page));
+
+  m_pendingPages.insert(page);
+  const quint64 generation = m_generation;
+  const std::shared_ptr<MergeRun> run = m_run;
+  const std::shared_ptr<const ViewportWindow> window = m_window;
+  const bool extending = page == m_mergedPages;
+  auto *self = const_cast<MergedMessageModel *>(this);
+
+  m_pool.start([self, run, page, checkpoint, generation, window, extending]() {
+    // A page scrolled past before the worker got to it is not rebuilt;
+    // extending the merge is always wanted.
+    QString error;
+    std::shared_ptr<Page> loaded;
+    const bool wanted = extending || (page >= window->firstPage.load() - kKeepPagesAround &&
+                                      page <= window->lastPage.load() + kKeepPagesAround);
+    if (wanted)
+      loaded = buildPage(*run, page, checkpoint, &error);
+    QMetaObject::invokeMethod(
+        self,
+        [self, generation, page, loaded, error]() {
+          self->onPageLoaded(generation, page, loaded, error);
+        },
+        Qt::QueuedConnection);
+  });
+}
+
+std::shared_ptr<MergedMessageModel::Page>
+MergedMessageModel::buildPage(MergeRun &run, qint64 page,
+                              const QVector<kafka::MergePosition> &checkpoint, QString *error) {
+  KAFKA_TRACE_SCOPE("merge page");
+  if (!run.merge)
+    run.merge = std::make_unique<kafka::TimestampMerge>(run.source, run.partitions);
+  kafka::TimestampMerge &merge = *run.merge;
+  if (run.atPage != page) {
+    const bool ok = checkpoint.isEmpty() ? merge.seek(run.timestamp, error)
+                                         : merge.restore(checkpoint, error);
+    if (!ok) {
+      run.atPage = -1;
+      return nullptr;
+    }
+  }
+
+  const qint64 firstRow = page * kPageSize;
+  auto loaded = std::make_shared<Page>(firstRow);
+  loaded->start = merge.position();
+  loaded->partitions.reserve(kPageSize);
+  loaded->offsets.reserve(kPageSize);
+
+  // Consecutive records mostly share a buffer; each is retained once.
+  std::unordered_set<const void *> retained;
+  kafka::MergedRecord merged;
+  while (static_cast<int>(loaded->offsets.size()) < kPageSize) {
+    if (!merge.next(&merged, error)) {
+      if (!error->isEmpty()) {
+        run.atPage = -1;
+        return nullptr;
+      }
+      loaded->complete = true;
+      break;
+    }
+    if (retained.insert(merged.owner.get()).second)
+      loaded->records.retain(merged.owner, merged.ownerBytes);
+    loaded->partitions.push_back(merged.partition);
+    loaded->offsets.push_back(merged.record.offset);
+    kafka::Record record = merged.record;
+    record.offset = firstRow + static_cast<qint64>(loaded->offsets.size()) - 1;
+    loaded->records.store(record, /*corrupt=*/false);
+  }
+  // The merge keeps a reference to the last record's buffer; drop ours
+  // before the page leaves the worker.
+  merged = kafka::MergedRecord();
+  loaded->end = merge.position();
+  run.atPage = page + 1;
+  return loaded;
+}
+
+void MergedMessageModel::onPageLoaded(quint64 generation, qint64 page,
+                                      std::shared_ptr<Page> loaded, const QString &error) {
+  KAFKA_TRACE_SCOPE("apply merged page");
+  if (generation != m_generation)
+    return;
+  m_pendingPages.remove(page);
+  if (!loaded) {
+    if (!error.isEmpty()) {
+      // Retrying the next page on every scroll would repeat the error; the
+      // next seek starts over.
+      if (page == m_mergedPages)
+        m_failed = true;
+      emit loadFailed(error);
+    }
+    return;
+  }
+
+  const int rows = static_cast<int>(loaded->offsets.size());
+  if (page == m_mergedPages) {
+    if (m_checkpoints.isEmpty())
+      m_checkpoints.append(loaded->start);
+    m_checkpoints.append(loaded->end);
+    if (rows > 0) {
+      beginInsertRows(QModelIndex(), m_exposedRows, m_exposedRows + rows - 1);
+      m_exposedRows += rows;
+      ++m_mergedPages;
+      endInsertRows();
+    }
+    if (loaded->complete) {
+      m_complete = true;
+      emit mergeCompleted();
+    }
+  }
+  if (rows == 0)
+    return;
+
+  m_residentBytes += loaded->records.bytes();
+  m_pages.insert(page, std::move(loaded));
+  const int firstRow = static_cast<int>(page * kPageSize);
+  emit dataChanged(index(firstRow, 0), index(firstRow + rows - 1, ColumnCount - 1));
+
+  evictPages();
+  KAFKA_TRACE_COUNTER("merged pages", m_pages.size());
+  emit residencyChanged(m_pages.size(), m_residentBytes);
+}
+
+void MergedMessageModel::evictPages() {
+  const qint64 firstPage = pageOf(m_viewportFirst);
+  const qint64 lastPage = pageOf(m_viewportLast);
+  const qint64 keepFirst = firstPage - kKeepPagesAround;
+  const qint64 keepLast = lastPage + kKeepPagesAround;
+
+  auto distance = [&](qint64 page) {
+    if (page < firstPage)
+      return firstPage - page;
+    if (page > lastPage)
+      return page - lastPage;
+    return qint64(0);
+  };
+
+  bool changed = false;
+  for (auto it = m_pages.begin(); it != m_pages.end();) {
+    if (it.key() < keepFirst || it.key() > keepLast) {
+      m_residentBytes -= it.value()->records.bytes();
+      it = m_pages.erase(it);
+      changed = true;
+    } else {
+      ++it;
+    }
+  }
+  while (m_pages.size() > kMaxResidentPages) {
+    auto farthest = m_pages.begin();
+    for (auto it = m_pages.begin(); it != m_pages.end(); ++it) {
+      if (distance(it.key()) > distance(farthest.key()))
+        farthest = it;
+    }
+    m_residentBytes -= farthest.value()->records.bytes();
+    m_pages.erase(farthest);
+    changed = true;
+  }
+
+  if (changed)
+    emit residencyChanged(m_pages.size(), m_residentBytes);
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QSet>
+#include <QThreadPool>
+#include <QVector>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "core/merge/TimestampMerge.h"
+#include "core/storage/RecordArena.h"
+
+namespace kafka {
+class BatchSource;
+}
+
+/**
+ * @brief Every partition of a topic as one table ordered by timestamp,
+ * read lazily through a kafka::TimestampMerge.
+ *
+ * Rows are positions in the merged sequence, so there is no way to jump to
+ * row N without merging the rows before it: pages of kPageSize rows are
+ * merged one after another as the view scrolls down (fetchMore()), and the
+ * row count grows with them until every partition is exhausted. Each page
+ * records the merge position it starts from; a page dropped because it
+ * went out of view is rebuilt from that checkpoint rather than from the
+ * start of the range.
+ *
+ * Merging runs on one worker thread, which keeps the merge between pages
+ * so reading on down never re-reads what it already has.
+ */
+class MergedMessageModel final : public QAbstractTableModel {
+  Q_OBJECT
+
+public:
+  enum Column {
+    PartitionColumn,
+    OffsetColumn,
+    TimestampColumn,
+    KeyColumn,
+    ValueColumn,
+    SizeColumn,
+    ColumnCount
+  };
+
+  static constexpr int kPageSize = 512;
+  /** Pages kept on each side of the viewport; farther pages are dropped. */
+  static constexpr int kKeepPagesAround = 4;
+  /** Hard cap on resident pages regardless of viewport jumps. */
+  static constexpr int kMaxResidentPages = 24;
+
+  explicit MergedMessageModel(QObject *parent = nullptr);
+  ~MergedMessageModel() override;
+
+  /**
+   * @brief Merges @p partitions of @p source from their first records at
+   * or after @p timestamp (ms since epoch).
+   */
+  void start(std::shared_ptr<kafka::BatchSource> source, const QVector<qint32> &partitions,
+             qint64 timestamp);
+  /** Starts over at @p timestamp with the same source and partitions. */
+  void seekToTimestamp(qint64 timestamp);
+  void clear();
+
+  const std::shared_ptr<kafka::BatchSource> &source() const { return m_source; }
+  const QVector<qint32> &partitions() const { return m_partitions; }
+  qint64 startTimestamp() const { return m_startTimestamp; }
+  /** Whether the merge reached the end of every partition. */
+  bool isComplete() const { return m_complete; }
+
+  /** Partition and offset of @p row; false when its page is not loaded. */
+  bool positionAt(int row, qint32 *partition, qint64 *offset) const;
+  /** See MessageTableModel::valueAt(). */
+  bool valueAt(int row, std::shared_ptr<const void> *owner, std::string_view *value,
+               bool *isNull) const;
+
+  /** See MessageTableModel::setViewport(). */
+  void setViewport(int firstRow, int lastRow);
+
+  int residentPageCount() const { return m_pages.size(); }
+  qint64 residentBytes() const { return m_residentBytes; }
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+  bool canFetchMore(const QModelIndex &parent) const override;
+  void fetchMore(const QModelIndex &parent) override;
+
+signals:
+  void loadFailed(const QString &error);
+  void residencyChanged(int pages, qint64 bytes);
+  /** Every partition is exhausted; rowCount() is final. */
+  void mergeCompleted();
+
+private:
+  // Slots are indexed by row; the record's own offset is kept beside it.
+  struct Page {
+    explicit Page(qint64 firstRow) : records(firstRow, firstRow + kPageSize) {}
+
+    kafka::RecordArena records;
+    std::vector<qint32> partitions;
+    std::vector<qint64> offsets;
+    QVector<kafka::MergePosition> start;
+    QVector<kafka::MergePosition> end;
+    bool complete = false;
+  };
+
+  // The merge, carried from one page to the next by the worker.
+  struct MergeRun;
+
+  // Viewport in pages, readable by the worker.
+  struct ViewportWindow {
+    std::atomic<qint64> firstPage{0};
+    std::atomic<qint64> lastPage{0};
+  };
+
+  static std::shared_ptr<Page> buildPage(MergeRun &run, qint64 page,
+                                         const QVector<kafka::MergePosition> &checkpoint,
+                                         QString *error);
+
+  qint64 pageOf(int row) const { return row / kPageSize; }
+  void requestPage(qint64 page) const;
+  void onPageLoaded(quint64 generation, qint64 page, std::shared_ptr<Page> loaded,
+                    const QString &error);
+  void evictPages();
+
+  std::shared_ptr<kafka::BatchSource> m_source;
+  QVector<qint32> m_partitions;
+  qint64 m_startTimestamp = 0;
+  std::shared_ptr<MergeRun> m_run;
+  quint64 m_generation = 0;
+
+  // Merge position at the start of each page merged so far, plus the one
+  // after the last; empty until the first page arrives.
+  QVector<QVector<kafka::MergePosition>> m_checkpoints;
+  int m_mergedPages = 0;
+  int m_exposedRows = 0;
+  bool m_complete = false;
+  bool m_failed = false;
+
+  QHash<qint64, std::shared_ptr<const Page>> m_pages;
+  mutable QSet<qint64> m_pendingPages;
+  qint64 m_residentBytes = 0;
+  int m_viewportFirst = 0;
+  int m_viewportLast = 0;
+  std::shared_ptr<ViewportWindow> m_window = std::make_shared<ViewportWindow>();
+  mutable QThreadPool m_pool;
+};
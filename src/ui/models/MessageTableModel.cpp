@@ -0,0 +1,728 @@
+#include "ui/models/MessageTableModel.h"
+
+#include <QColor>
+#include <QDateTime>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "core/codec/BatchDecoder.h"
+#include "core/protocol/RecordBatch.h"
+#include "core/scan/BatchWalk.h"
+#include "core/storage/AllocationCounter.h"
+#include "core/trace/Trace.h"
+
+namespace {
+constexpr int kPreviewBytes = 256;
+constexpr int kLoaderThreads = 4;
+
+// Only the painted prefix is converted; the rest of the value stays in
+// the page's buffers.
+QString previewText(std::string_view bytes) {
+  const auto size = static_cast<int>(qMin<std::size_t>(bytes.size(), kPreviewBytes));
+  QString text = QString::fromUtf8(bytes.data(), size);
+  for (QChar &ch : text) {
+    if (ch.category() == QChar::Other_Control)
+      ch = QLatin1Char(' ');
+  }
+  if (bytes.size() > static_cast<std::size_t>(kPreviewBytes))
+    text += QChar(0x2026);
+  return text;
+}
+} // namespace
+
+std::string_view MessageTableModel::Page::valueText(qint64 offset,
+                                                   const kafka::RecordArena::Slot &slot) const {
+  if (decoded.empty())
+    return slot.value;
+  const DecodedValue &value = decoded[static_cast<std::size_t>(offset - records.firstOffset())];
+  if (value.result != kafka::SchemaCache::Result::Decoded)
+    return slot.value;
+  return std::string_view(decodedText).substr(value.begin, value.length);
+}
+
+std::string_view MessageTableModel::Page::decodeError(qint64 offset) const {
+  if (decoded.empty())
+    return std::string_view();
+  const DecodedValue &value = decoded[static_cast<std::size_t>(offset - records.firstOffset())];
+  if (value.result != kafka::SchemaCache::Result::Failed)
+    return std::string_view();
+  return std::string_view(decodedText).substr(value.begin, value.length);
+}
+
+MessageTableModel::MessageTableModel(QObject *parent) : QAbstractTableModel(parent) {
+  m_pool.setMaxThreadCount(kLoaderThreads);
+}
+
+MessageTableModel::~MessageTableModel() {
+  m_pool.clear();
+  m_pool.waitForDone();
+}
+
+void MessageTableModel::setSource(std::shared_ptr<kafka::BatchSource> source, qint32 partition) {
+  beginResetModel();
+  ++m_generation;
+  m_pool.clear();
+  m_source = std::move(source);
+  m_partition = partition;
+  m_range = kafka::OffsetRange();
+  m_exposedRows = 0;
+  m_pendingSeek = -1;
+  m_pages.clear();
+  m_pendingPages.clear();
+  for (JsonColumn &column : m_jsonColumns) {
+    column.blocks.clear();
+    column.pendingBlocks.clear();
+  }
+  m_residentBytes = 0;
+  m_corruptBatches = 0;
+  endResetModel();
+  emit residencyChanged(0, 0);
+
+  if (m_source)
+    loadRange();
+}
+
+void MessageTableModel::clear() { setSource(nullptr, 0); }
+
+void MessageTableModel::loadRange() {
+  const quint64 generation = m_generation;
+  const std::shared_ptr<kafka::BatchSource> source = m_source;
+  const qint32 partition = m_partition;
+  MessageTableModel *self = this;
+
+  // The destructor drains the pool, so workers may use self; the queued
+  // call is dropped by Qt if the model is gone by the time it runs.
+  m_pool.start([self, source, partition, generation]() {
+    kafka::OffsetRange range;
+    QString error;
+    const bool ok = source->offsetRange(partition, &range, &error);
+    QMetaObject::invokeMethod(
+        self,
+        [self, ok, range, error, generation]() {
+          if (self->m_generation != generation)
+            return;
+          if (!ok) {
+            emit self->loadFailed(error);
+            return;
+          }
+          self->beginResetModel();
+          self->m_range = range;
+          self->m_exposedRows = 0;
+          self->endResetModel();
+          emit self->offsetRangeChanged(range.start, range.end);
+          self->fetchMore(QModelIndex());
+          if (self->m_pendingSeek >= 0)
+            self->seekToOffset(std::exchange(self->m_pendingSeek, -1));
+        },
+        Qt::QueuedConnection);
+  });
+}
+
+void MessageTableModel::setSchemaCache(std::shared_ptr<kafka::SchemaCache> schemas) {
+  if (m_schemas == schemas)
+    return;
+  m_schemas = std::move(schemas);
+  m_schemaIdsSeen.clear();
+  // Like a checksum setting change: pages in flight are discarded on arrival.
+  dropPages();
+  if (m_exposedRows > 0)
+    emit dataChanged(index(0, 0), index(m_exposedRows - 1, columnCount() - 1));
+}
+
+void MessageTableModel::setVerifyChecksums(bool verify) {
+  if (m_verifyChecksums == verify)
+    return;
+  m_verifyChecksums = verify;
+  // Pages still in flight were decoded with the old setting; onPageLoaded()
+  // discards them when they arrive.
+  dropPages();
+  if (m_exposedRows > 0)
+    emit dataChanged(index(0, 0), index(m_exposedRows - 1, columnCount() - 1));
+}
+
+double MessageTableModel::allocationsPerRecord() const {
+  quint64 allocations = 0;
+  qint64 records = 0;
+  for (const std::shared_ptr<const Page> &page : m_pages) {
+    allocations += page->allocations;
+    records += page->records.recordCount();
+  }
+  return records > 0 ? static_cast<double>(allocations) / static_cast<double>(records) : 0.0;
+}
+
+void MessageTableModel::dropPages() {
+  m_pages.clear();
+  for (JsonColumn &column : m_jsonColumns)
+    column.blocks.clear();
+  m_residentBytes = 0;
+  m_corruptBatches = 0;
+  emit residencyChanged(0, 0);
+}
+
+void MessageTableModel::seekToOffset(qint64 offset) {
+  if (m_range.size() == 0) {
+    if (m_source)
+      m_pendingSeek = offset;
+    return;
+  }
+  const qint64 clamped = qBound(m_range.start, offset, m_range.end - 1);
+  const int row = rowForOffset(clamped);
+  if (row >= m_exposedRows) {
+    beginInsertRows(QModelIndex(), m_exposedRows, row);
+    m_exposedRows = row + 1;
+    endInsertRows();
+  }
+  emit seekCompleted(row);
+}
+
+void MessageTableModel::seekToTimestamp(qint64 timestamp) {
+  if (!m_source)
+    return;
+
+  const quint64 generation = m_generation;
+  const std::shared_ptr<kafka::BatchSource> source = m_source;
+  const qint32 partition = m_partition;
+  MessageTableModel *self = this;
+
+  m_pool.start([self, source, partition, timestamp, generation]() {
+    qint64 offset = 0;
+    QString error;
+    const bool ok = source->offsetForTimestamp(partition, timestamp, &offset, &error);
+    QMetaObject::invokeMethod(
+        self,
+        [self, ok, offset, error, generation]() {
+          if (self->m_generation != generation)
+            return;
+          if (!ok) {
+            emit self->loadFailed(error);
+            return;
+          }
+          self->seekToOffset(offset);
+        },
+        Qt::QueuedConnection);
+  });
+}
+
+int MessageTableModel::rowForOffset(qint64 offset) const {
+  if (!m_range.contains(offset))
+    return -1;
+  return static_cast<int>(qMin<qint64>(offset - m_range.start, std::numeric_limits<int>::max()));
+}
+
+int MessageTableModel::rowCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : m_exposedRows;
+}
+
+int MessageTableModel::columnCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : ColumnCount + static_cast<int>(m_jsonColumns.size());
+}
+
+bool MessageTableModel::canFetchMore(const QModelIndex &parent) const {
+  if (parent.isValid())
+    return false;
+  const qint64 total = qMin<qint64>(m_range.size(), std::numeric_limits<int>::max());
+  return m_exposedRows < total;
+}
+
+void MessageTableModel::fetchMore(const QModelIndex &parent) {
+  if (!canFetchMore(parent))
+    return;
+  const qint64 total = qMin<qint64>(m_range.size(), std::numeric_limits<int>::max());
+  const int added = static_cast<int>(qMin<qint64>(kRowsPerFetch, total - m_exposedRows));
+  beginInsertRows(QModelIndex(), m_exposedRows, m_exposedRows + added - 1);
+  m_exposedRows += added;
+  endInsertRows();
+}
+
+QVariant MessageTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QAbstractTableModel::headerData(section, orientation, role);
+
+  if (isJsonColumn(section))
+    return m_jsonColumns[static_cast<std::size_t>(section - ColumnCount)].path->expression();
+  switch (section) {
+  case OffsetColumn:
+    return tr("Offset");
+  case TimestampColumn:
+    return tr("Timestamp");
+  case KeyColumn:
+    return tr("Key");
+  case ValueColumn:
+    return tr("Value");
+  case SizeColumn:
+    return tr("Size");
+  default:
+    return QVariant();
+  }
+}
+
+QVariant MessageTableModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || index.row() >= m_exposedRows)
+    return QVariant();
+
+  const int column = index.column();
+  if (role == Qt::TextAlignmentRole) {
+    if (column == OffsetColumn || column == SizeColumn)
+      return int(Qt::AlignRight | Qt::AlignVCenter);
+    return int(Qt::AlignLeft | Qt::AlignVCenter);
+  }
+  if (role != Qt::DisplayRole && role != Qt::ForegroundRole && role != Qt::ToolTipRole)
+    return QVariant();
+
+  const qint64 offset = offsetForRow(index.row());
+  if (column == OffsetColumn)
+    return role == Qt::DisplayRole ? QVariant(offset) : QVariant();
+
+  const qint64 page = pageOf(index.row());
+  const auto it = m_pages.constFind(page);
+  if (it == m_pages.cend()) {
+    requestPage(page);
+    return QVariant();
+  }
+
+  using Arena = kafka::RecordArena;
+  const Arena::Slot &row = it.value()->records.at(offset);
+  if (!row.has(Arena::Present)) {
+    if (role == Qt::ForegroundRole)
+      return QColor(Qt::gray);
+    if (role == Qt::ToolTipRole)
+      return QVariant();
+    if (column != ValueColumn)
+      return QVariant();
+    return row.has(Arena::Undecodable) ? tr("(batch could not be decompressed)")
+                                       : tr("(no record at this offset)");
+  }
+
+  if (row.has(Arena::Corrupt)) {
+    if (role == Qt::ForegroundRole)
+      return QColor(Qt::red);
+    if (role == Qt::ToolTipRole)
+      return tr("The batch holding this record failed its CRC32C check");
+  }
+  if (role == Qt::ToolTipRole) {
+    const std::string_view decodeError = it.value()->decodeError(offset);
+    if (column != ValueColumn || decodeError.empty())
+      return QVariant();
+    return tr("Not decoded: %1")
+        .arg(QString::fromUtf8(decodeError.data(), static_cast<int>(decodeError.size())));
+  }
+
+  if (column >= ColumnCount) {
+    if (row.has(Arena::ValueNull))
+      return role == Qt::ForegroundRole ? QVariant(QColor(Qt::gray)) : QVariant();
+    return jsonData(static_cast<std::size_t>(column - ColumnCount), page, offset, role);
+  }
+  if (role == Qt::ForegroundRole) {
+    const bool isNull = (column == KeyColumn && row.has(Arena::KeyNull)) ||
+                        (column == ValueColumn && row.has(Arena::ValueNull));
+    return isNull ? QVariant(QColor(Qt::gray)) : QVariant();
+  }
+
+  switch (column) {
+  case TimestampColumn:
+    return QDateTime::fromMSecsSinceEpoch(row.timestamp, Qt::UTC).toString(Qt::ISODateWithMs);
+  case KeyColumn:
+    return row.has(Arena::KeyNull) ? tr("(null)") : previewText(row.key);
+  case ValueColumn:
+    return row.has(Arena::ValueNull) ? tr("(null)")
+                                     : previewText(it.value()->valueText(offset, row));
+  case SizeColumn:
+    return row.size;
+  default:
+    return QVariant();
+  }
+}
+
+bool MessageTableModel::keyAt(int row, QByteArray *key) const {
+  if (row < 0 || row >= m_exposedRows)
+    return false;
+  const auto it = m_pages.constFind(pageOf(row));
+  if (it == m_pages.cend())
+    return false;
+
+  using Arena = kafka::RecordArena;
+  const Arena::Slot &slot = it.value()->records.at(offsetForRow(row));
+  if (!slot.has(Arena::Present) || slot.has(Arena::KeyNull))
+    return false;
+  *key = QByteArray(slot.key.data(), static_cast<int>(slot.key.size()));
+  return true;
+}
+
+bool MessageTableModel::valueAt(int row, std::shared_ptr<const void> *owner,
+                                std::string_view *value, bool *isNull) const {
+  if (row < 0 || row >= m_exposedRows)
+    return false;
+  const auto it = m_pages.constFind(pageOf(row));
+  if (it == m_pages.cend())
+    return false;
+
+  using Arena = kafka::RecordArena;
+  const Arena::Slot &slot = it.value()->records.at(offsetForRow(row));
+  if (!slot.has(Arena::Present))
+    return false;
+  *owner = it.value();
+  *value = slot.value;
+  *isNull = slot.has(Arena::ValueNull);
+  return true;
+}
+
+void MessageTableModel::setViewport(int firstRow, int lastRow) {
+  m_viewportFirst = qMax(0, firstRow);
+  m_viewportLast = qMax(m_viewportFirst, lastRow);
+  m_window->firstPage.store(pageOf(m_viewportFirst));
+  m_window->lastPage.store(pageOf(m_viewportLast));
+  evictPages();
+
+  // Prefetch one page on each side so small scrolls never show gaps.
+  const qint64 firstPage = qMax<qint64>(0, pageOf(m_viewportFirst) - 1);
+  const qint64 lastPage = pageOf(qMin(m_viewportLast, qMax(0, m_exposedRows - 1))) + 1;
+  for (qint64 page = firstPage; page <= lastPage; ++page) {
+    if (page * kPageSize < m_exposedRows)
+      requestPage(page);
+  }
+}
+
+void MessageTableModel::requestPage(qint64 page) const {
+  if (!m_source || m_pages.contains(page) || m_pendingPages.contains(page))
+    return;
+
+  const qint64 firstOffset = m_range.start + page * kPageSize;
+  const qint64 endOffset = qMin(firstOffset + kPageSize, m_range.end);
+  if (firstOffset >= endOffset)
+    return;
+
+  m_pendingPages.insert(page);
+  const quint64 generation = m_generation;
+  const std::shared_ptr<kafka::BatchSource> source = m_source;
+  const qint32 partition = m_partition;
+  auto *self = const_cast<MessageTableModel *>(this);
+  const std::shared_ptr<const ViewportWindow> window = m_window;
+  const bool verifyChecksums = m_verifyChecksums;
+  const std::shared_ptr<kafka::SchemaCache> schemas = m_schemas;
+
+  m_pool.start([self, source, partition, firstOffset, endOffset, generation, page, window,
+                verifyChecksums, schemas]() {
+    // Pages requested during a fast scrollbar drag are usually out of view
+    // by the time a worker gets to them; skip those instead of fetching.
+    QString error;
+    std::shared_ptr<Page> loaded;
+    const bool wanted = page >= window->firstPage.load() - kKeepPagesAround &&
+                        page <= window->lastPage.load() + kKeepPagesAround;
+    if (wanted)
+      loaded = loadPage(*source, partition, firstOffset, endOffset, verifyChecksums,
+                        schemas.get(), &error);
+    QMetaObject::invokeMethod(
+        self,
+        [self, generation, page, loaded, error]() {
+          self->onPageLoaded(generation, page, loaded, error);
+        },
+        Qt::QueuedConnection);
+  });
+}
+
+void MessageTableModel::onPageLoaded(quint64 generation, qint64 page,
+                                     std::shared_ptr<Page> loaded, const QString &error) {
+  KAFKA_TRACE_SCOPE("apply page");
+  if (generation != m_generation)
+    return;
+  m_pendingPages.remove(page);
+  if (!loaded) {
+    if (!error.isEmpty())
+      emit loadFailed(error);
+    return;
+  }
+  if (loaded->checksumsVerified != m_verifyChecksums || loaded->schemas != m_schemas.get()) {
+    const int firstRow = static_cast<int>(page * kPageSize);
+    if (firstRow < m_exposedRows)
+      emit dataChanged(index(firstRow, 0), index(firstRow, columnCount() - 1));
+    return;
+  }
+
+  m_residentBytes += loaded->records.bytes() + static_cast<qint64>(loaded->decodedText.size());
+  m_corruptBatches += loaded->corruptBatches;
+  const QVector<qint32> schemaIds = loaded->schemaIds;
+  m_pages.insert(page, std::move(loaded));
+  addSchemaColumns(schemaIds);
+
+  const int firstRow = static_cast<int>(page * kPageSize);
+  const int lastRow = qMin(firstRow + kPageSize, m_exposedRows) - 1;
+  if (lastRow >= firstRow)
+    emit dataChanged(index(firstRow, 0), index(lastRow, columnCount() - 1));
+
+  evictPages();
+  KAFKA_TRACE_COUNTER("resident pages", m_pages.size());
+  emit residencyChanged(m_pages.size(), m_residentBytes);
+}
+
+void MessageTableModel::evictPages() {
+  const qint64 firstPage = pageOf(m_viewportFirst);
+  const qint64 lastPage = pageOf(m_viewportLast);
+  const qint64 keepFirst = firstPage - kKeepPagesAround;
+  const qint64 keepLast = lastPage + kKeepPagesAround;
+
+  auto distance = [&](qint64 page) {
+    if (page < firstPage)
+      return firstPage - page;
+    if (page > lastPage)
+      return page - lastPage;
+    return qint64(0);
+  };
+
+  bool changed = false;
+  for (auto it = m_pages.begin(); it != m_pages.end();) {
+    if (it.key() < keepFirst || it.key() > keepLast) {
+      m_residentBytes -= it.value()->records.bytes() +
+                         static_cast<qint64>(it.value()->decodedText.size());
+      m_corruptBatches -= it.value()->corruptBatches;
+      dropJsonBlocks(it.key());
+      it = m_pages.erase(it);
+      changed = true;
+    } else {
+      ++it;
+    }
+  }
+
+  // A viewport taller than the keep window could still exceed the cap.
+  while (m_pages.size() > kMaxResidentPages) {
+    auto farthest = m_pages.begin();
+    for (auto it = m_pages.begin(); it != m_pages.end(); ++it) {
+      if (distance(it.key()) > distance(farthest.key()))
+        farthest = it;
+    }
+    m_residentBytes -= farthest.value()->records.bytes() +
+                       static_cast<qint64>(farthest.value()->decodedText.size());
+    m_corruptBatches -= farthest.value()->corruptBatches;
+    dropJsonBlocks(farthest.key());
+    m_pages.erase(farthest);
+    changed = true;
+  }
+
+  if (changed)
+    emit residencyChanged(m_pages.size(), m_residentBytes);
+}
+
+std::shared_ptr<MessageTableModel::Page>
+MessageTableModel::loadPage(kafka::BatchSource &source, qint32 partition, qint64 firstOffset,
+                            qint64 endOffset, bool verifyChecksums, kafka::SchemaCache *schemas,
+                            QString *error) {
+  KAFKA_TRACE_SCOPE("load page");
+  const kafka::AllocationScope allocations;
+  auto page = std::make_shared<Page>(firstOffset, endOffset);
+  page->checksumsVerified = verifyChecksums;
+
+  kafka::BatchWalk walk(source, partition, firstOffset, endOffset);
+  while (walk.nextChunk(error)) {
+    const kafka::BatchChunk &chunk = walk.chunk();
+    page->records.retain(chunk.owner, chunk.bytes.size());
+
+    // Collect the batches of this chunk that overlap the page first, so the
+    // compressed ones can be inflated together on the decoder pool.
+    std::vector<kafka::RecordBatch> wanted;
+    std::vector<kafka::RecordBatch> compressed;
+    kafka::RecordBatch batch;
+    while (walk.nextBatch(batch)) {
+      wanted.push_back(batch);
+      if (batch.compression() != kafka::Compression::None && !batch.isControl())
+        compressed.push_back(batch);
+    }
+
+    // Failures are shown per row below rather than failing the page.
+    const std::vector<std::shared_ptr<const kafka::DecodedBatch>> decoded =
+        kafka::BatchDecoder::shared().decode(source.sourceId(), partition, compressed, nullptr);
+    std::size_t decodedIndex = 0;
+
+    for (const kafka::RecordBatch &current : wanted) {
+      const bool corrupt = verifyChecksums && !current.hasValidCrc();
+      if (corrupt)
+        ++page->corruptBatches;
+      if (current.isControl())
+        continue;
+
+      std::string_view section = current.recordsSection();
+      if (current.compression() != kafka::Compression::None) {
+        const std::shared_ptr<const kafka::DecodedBatch> &inflated = decoded[decodedIndex++];
+        if (!inflated) {
+          page->records.markUndecodable(qMax(current.baseOffset(), walk.chunkStart()),
+                                        current.nextOffset());
+          continue;
+        }
+        page->records.retain(inflated, inflated->cost());
+        section = inflated->records;
+      }
+
+      walk.forEachRecord(current, section, [&](const kafka::Record &record) {
+        page->records.store(record, corrupt);
+        return true;
+      });
+    }
+  }
+  if (walk.failed())
+    return nullptr;
+  page->allocations = allocations.count();
+  if (schemas)
+    decodeValues(*page, *schemas);
+  return page;
+}
+
+// Runs on the loader thread right after the page's records are stored, so
+// decoding never happens on the GUI thread and only for loaded pages.
+void MessageTableModel::decodeValues(Page &page, kafka::SchemaCache &schemas) {
+  KAFKA_TRACE_SCOPE("decode values");
+  using Arena = kafka::RecordArena;
+  using Result = kafka::SchemaCache::Result;
+  page.schemas = &schemas;
+  const Arena &records = page.records;
+  page.decoded.resize(static_cast<std::size_t>(records.endOffset() - records.firstOffset()));
+
+  QString error;
+  for (qint64 offset = records.firstOffset(); offset < records.endOffset(); ++offset) {
+    const Arena::Slot &slot = records.at(offset);
+    if (!slot.has(Arena::Present) || slot.has(Arena::ValueNull))
+      continue;
+    Page::DecodedValue &value =
+        page.decoded[static_cast<std::size_t>(offset - records.firstOffset())];
+    const std::size_t begin = page.decodedText.size();
+    qint32 schemaId = 0;
+    error.clear();
+    value.result = schemas.decode(slot.value, &schemaId, &page.decodedText, &error);
+    if (value.result == Result::NotEncoded)
+      continue;
+    if (!page.schemaIds.contains(schemaId))
+      page.schemaIds.append(schemaId);
+    if (value.result == Result::Failed) {
+      // A partial rendering is useless; keep the reason for the tooltip.
+      page.decodedText.resize(begin);
+      page.decodedText += error.toStdString();
+    }
+    value.begin = static_cast<quint32>(begin);
+    value.length = static_cast<quint32>(page.decodedText.size() - begin);
+  }
+}
+
+void MessageTableModel::addSchemaColumns(const QVector<qint32> &schemaIds) {
+  if (!m_schemas)
+    return;
+  for (qint32 schemaId : schemaIds) {
+    if (m_schemaIdsSeen.contains(schemaId))
+      continue;
+    m_schemaIdsSeen.insert(schemaId);
+    const std::shared_ptr<const kafka::SchemaDecoder> decoder =
+        m_schemas->decoderFor(schemaId, nullptr);
+    if (!decoder)
+      continue;
+    for (const QString &field : decoder->fieldNames()) {
+      const bool plain = std::all_of(field.cbegin(), field.cend(), [](QChar ch) {
+        return ch.isLetterOrNumber() || ch == QLatin1Char('_');
+      });
+      const QString expression = plain ? QStringLiteral("$.%1").arg(field)
+                                       : QStringLiteral("$['%1']").arg(field);
+      const bool exists = std::any_of(
+          m_jsonColumns.cbegin(), m_jsonColumns.cend(),
+          [&expression](const JsonColumn &column) { return column.path->expression() == expression; });
+      if (!exists)
+        addJsonColumn(kafka::JsonPath::compile(expression, nullptr));
+    }
+  }
+}
+
+void MessageTableModel::addJsonColumn(std::shared_ptr<const kafka::JsonPath> path) {
+  if (!path)
+    return;
+  const int column = columnCount();
+  beginInsertColumns(QModelIndex(), column, column);
+  JsonColumn json;
+  json.id = ++m_nextJsonColumnId;
+  json.path = std::move(path);
+  m_jsonColumns.push_back(std::move(json));
+  endInsertColumns();
+}
+
+void MessageTableModel::removeJsonColumn(int column) {
+  if (!isJsonColumn(column))
+    return;
+  beginRemoveColumns(QModelIndex(), column, column);
+  m_jsonColumns.erase(m_jsonColumns.begin() + (column - ColumnCount));
+  endRemoveColumns();
+}
+
+QVariant MessageTableModel::jsonData(std::size_t column, qint64 page, qint64 offset,
+                                     int role) const {
+  const JsonColumn &json = m_jsonColumns[column];
+  const auto it = json.blocks.constFind(page);
+  if (it == json.blocks.cend()) {
+    requestJsonBlock(column, page);
+    return QVariant();
+  }
+  const JsonBlock &block = *it.value();
+  const kafka::JsonValue &value =
+      block.values[static_cast<std::size_t>(offset - block.page->records.firstOffset())];
+  if (role == Qt::ForegroundRole) {
+    const bool dim = value.type == kafka::JsonValue::Missing || value.type == kafka::JsonValue::Null;
+    return dim ? QVariant(QColor(Qt::gray)) : QVariant();
+  }
+  return value.toDisplayString(kPreviewBytes);
+}
+
+void MessageTableModel::requestJsonBlock(std::size_t column, qint64 page) const {
+  const JsonColumn &json = m_jsonColumns[column];
+  const auto loaded = m_pages.constFind(page);
+  if (loaded == m_pages.cend() || json.pendingBlocks.contains(page))
+    return;
+
+  json.pendingBlocks.insert(page);
+  const quint64 generation = m_generation;
+  const quint64 columnId = json.id;
+  const std::shared_ptr<const kafka::JsonPath> path = json.path;
+  const std::shared_ptr<const Page> records = loaded.value();
+  auto *self = const_cast<MessageTableModel *>(this);
+
+  m_pool.start([self, generation, columnId, page, path, records]() {
+    KAFKA_TRACE_SCOPE("extract json block");
+    using Arena = kafka::RecordArena;
+    auto block = std::make_shared<JsonBlock>();
+    block->page = records;
+    const Arena &arena = records->records;
+    block->values.resize(static_cast<std::size_t>(arena.endOffset() - arena.firstOffset()));
+    for (qint64 offset = arena.firstOffset(); offset < arena.endOffset(); ++offset) {
+      const Arena::Slot &slot = arena.at(offset);
+      if (slot.has(Arena::Present) && !slot.has(Arena::ValueNull))
+        block->values[static_cast<std::size_t>(offset - arena.firstOffset())] =
+            path->extract(records->valueText(offset, slot));
+    }
+    QMetaObject::invokeMethod(
+        self,
+        [self, generation, columnId, page, block]() {
+          self->onJsonBlockLoaded(generation, columnId, page, block);
+        },
+        Qt::QueuedConnection);
+  });
+}
+
+void MessageTableModel::onJsonBlockLoaded(quint64 generation, quint64 columnId, qint64 page,
+                                          std::shared_ptr<const JsonBlock> block) {
+  if (generation != m_generation)
+    return;
+  const auto json = std::find_if(m_jsonColumns.begin(), m_jsonColumns.end(),
+                                 [columnId](const JsonColumn &candidate) { return candidate.id == columnId; });
+  if (json == m_jsonColumns.end())
+    return;
+  json->pendingBlocks.remove(page);
+  // A page evicted or reloaded meanwhile is extracted again when painted.
+  const auto resident = m_pages.constFind(page);
+  if (resident == m_pages.cend() || resident.value() != block->page)
+    return;
+  json->blocks.insert(page, std::move(block));
+
+  const int column = ColumnCount + static_cast<int>(json - m_jsonColumns.begin());
+  const int firstRow = static_cast<int>(page * kPageSize);
+  const int lastRow = qMin(firstRow + kPageSize, m_exposedRows) - 1;
+  if (lastRow >= firstRow)
+    emit dataChanged(index(firstRow, column), index(lastRow, column));
+}
+
+void MessageTableModel::dropJsonBlocks(qint64 page) {
+  for (JsonColumn &column : m_jsonColumns)
+    column.blocks.remove(page);
+}
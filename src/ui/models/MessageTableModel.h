@@ -0,0 +1,240 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QSet>
+#include <QThreadPool>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "core/json/JsonPath.h"
+#include "core/schema/SchemaCache.h"
+#include "core/source/BatchSource.h"
+#include "core/storage/RecordArena.h"
+
+/**
+ * @brief Virtualized table of the messages of one partition.
+ *
+ * Row r is offset range.start + r. The row count grows in large steps
+ * through canFetchMore()/fetchMore(), which costs nothing per row; message
+ * data is loaded asynchronously in fixed-size pages around the viewport
+ * (reported through setViewport()) on a worker pool, and pages that scroll
+ * far out of view are dropped again. Memory therefore depends on the
+ * viewport, not on how many offsets the partition holds.
+ *
+ * A page is a kafka::RecordArena: keys and values stay views into the
+ * fetched or mapped buffers the page pins, and cell text is only built in
+ * data() for the rows actually painted.
+ *
+ * JSON columns added with addJsonColumn() follow the built-in ones. Their
+ * cells are extracted a page at a time on the same pool, only for pages
+ * that are painted, and dropped together with the page.
+ *
+ * With a schema cache set, values in the Confluent wire format are decoded
+ * to JSON while their page loads, and the value column and JSON columns
+ * show the decoded text. The fields of every schema seen are added as
+ * JSON columns.
+ */
+class MessageTableModel final : public QAbstractTableModel {
+  Q_OBJECT
+
+public:
+  enum Column {
+    OffsetColumn,
+    TimestampColumn,
+    KeyColumn,
+    ValueColumn,
+    SizeColumn,
+    ColumnCount
+  };
+
+  /** Offsets per page, the unit of loading, eviction and JSON extraction. */
+  static constexpr int kPageSize = 512;
+  /** Rows added to rowCount() per fetchMore(). */
+  static constexpr int kRowsPerFetch = 1 << 20;
+  /** Pages kept on each side of the viewport; farther pages are dropped. */
+  static constexpr int kKeepPagesAround = 4;
+  /** Hard cap on resident pages regardless of viewport jumps. */
+  static constexpr int kMaxResidentPages = 24;
+
+  explicit MessageTableModel(QObject *parent = nullptr);
+  ~MessageTableModel() override;
+
+  void setSource(std::shared_ptr<kafka::BatchSource> source, qint32 partition);
+  void clear();
+
+  const std::shared_ptr<kafka::BatchSource> &source() const { return m_source; }
+  qint32 partition() const { return m_partition; }
+
+  /**
+   * @brief Tells the model which rows are visible so it can prefetch the
+   * surrounding pages and drop the ones far away.
+   */
+  void setViewport(int firstRow, int lastRow);
+
+  /**
+   * @brief Exposes rows up to @p offset (clamped to the range) and reports
+   * its row through seekCompleted(). A seek issued while the range is still
+   * loading is applied once it arrives.
+   */
+  void seekToOffset(qint64 offset);
+  /**
+   * @brief Resolves the first offset at or after @p timestamp (ms since
+   * epoch) on a worker, then behaves like seekToOffset().
+   */
+  void seekToTimestamp(qint64 timestamp);
+
+  kafka::OffsetRange offsetRange() const { return m_range; }
+  qint64 offsetForRow(int row) const { return m_range.start + row; }
+  int rowForOffset(qint64 offset) const;
+  /**
+   * @brief Copies the key of @p row into @p key; false when the row is not
+   * loaded, holds no record or has a null key.
+   */
+  bool keyAt(int row, QByteArray *key) const;
+  /**
+   * @brief Points @p value at the raw value of @p row where it lies in the
+   * page buffers, and @p owner at what keeps them alive. False when the row
+   * is not loaded or holds no record; a null value sets @p isNull.
+   */
+  bool valueAt(int row, std::shared_ptr<const void> *owner, std::string_view *value,
+               bool *isNull) const;
+
+  /**
+   * @brief Checks the CRC32C of every batch a page is decoded from; rows of
+   * failing batches are shown in red. Resident pages are reloaded.
+   */
+  void setVerifyChecksums(bool verify);
+  bool verifyChecksums() const { return m_verifyChecksums; }
+  /** Batches failing the CRC check among the resident pages. */
+  int corruptBatchCount() const { return m_corruptBatches; }
+
+  /**
+   * @brief Decodes Avro and Protobuf values through @p schemas, or shows
+   * them raw when null. Resident pages are reloaded.
+   */
+  void setSchemaCache(std::shared_ptr<kafka::SchemaCache> schemas);
+  const std::shared_ptr<kafka::SchemaCache> &schemaCache() const { return m_schemas; }
+
+  /** Appends a column showing what @p path selects in each value. */
+  void addJsonColumn(std::shared_ptr<const kafka::JsonPath> path);
+  /** Removes the JSON column at model column @p column. */
+  void removeJsonColumn(int column);
+  bool isJsonColumn(int column) const {
+    return column >= ColumnCount && column < ColumnCount + static_cast<int>(m_jsonColumns.size());
+  }
+
+  int residentPageCount() const { return m_pages.size(); }
+  qint64 residentBytes() const { return m_residentBytes; }
+  /**
+   * @brief Heap allocations per record made while loading the resident
+   * pages; 0 unless built with KAFKA_VIEWER_COUNT_ALLOCATIONS.
+   */
+  double allocationsPerRecord() const;
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+  bool canFetchMore(const QModelIndex &parent) const override;
+  void fetchMore(const QModelIndex &parent) override;
+
+signals:
+  void offsetRangeChanged(qint64 start, qint64 end);
+  void loadFailed(const QString &error);
+  void residencyChanged(int pages, qint64 bytes);
+  void seekCompleted(int row);
+
+private:
+  struct Page {
+    Page(qint64 firstOffset, qint64 endOffset) : records(firstOffset, endOffset) {}
+
+    // A value decoded through the schema cache: its JSON, or for a failure
+    // the reason, as a span of decodedText.
+    struct DecodedValue {
+      quint32 begin = 0;
+      quint32 length = 0;
+      kafka::SchemaCache::Result result = kafka::SchemaCache::Result::NotEncoded;
+    };
+
+    /** The decoded JSON of @p slot when there is one, else its raw value. */
+    std::string_view valueText(qint64 offset, const kafka::RecordArena::Slot &slot) const;
+    std::string_view decodeError(qint64 offset) const;
+
+    kafka::RecordArena records;
+    int corruptBatches = 0;
+    bool checksumsVerified = false;
+    quint64 allocations = 0;
+    // Empty unless the page was loaded with a schema cache.
+    const kafka::SchemaCache *schemas = nullptr;
+    std::vector<DecodedValue> decoded;
+    std::string decodedText;
+    QVector<qint32> schemaIds;
+  };
+
+  // What one JSON column selects in the values of one page, indexed by
+  // offset. The values are views into the page, which the block pins.
+  struct JsonBlock {
+    std::shared_ptr<const Page> page;
+    std::vector<kafka::JsonValue> values;
+  };
+
+  struct JsonColumn {
+    // Identifies the column to extractions still in flight after a removal.
+    quint64 id = 0;
+    std::shared_ptr<const kafka::JsonPath> path;
+    QHash<qint64, std::shared_ptr<const JsonBlock>> blocks;
+    mutable QSet<qint64> pendingBlocks;
+  };
+
+  // Viewport in pages, readable by loader threads.
+  struct ViewportWindow {
+    std::atomic<qint64> firstPage{0};
+    std::atomic<qint64> lastPage{0};
+  };
+
+  static std::shared_ptr<Page> loadPage(kafka::BatchSource &source, qint32 partition,
+                                        qint64 firstOffset, qint64 endOffset,
+                                        bool verifyChecksums, kafka::SchemaCache *schemas,
+                                        QString *error);
+  static void decodeValues(Page &page, kafka::SchemaCache &schemas);
+  void addSchemaColumns(const QVector<qint32> &schemaIds);
+
+  qint64 pageOf(int row) const { return row / kPageSize; }
+  void requestPage(qint64 page) const;
+  void onPageLoaded(quint64 generation, qint64 page, std::shared_ptr<Page> loaded,
+                    const QString &error);
+  void requestJsonBlock(std::size_t column, qint64 page) const;
+  void onJsonBlockLoaded(quint64 generation, quint64 columnId, qint64 page,
+                         std::shared_ptr<const JsonBlock> block);
+  QVariant jsonData(std::size_t column, qint64 page, qint64 offset, int role) const;
+  void dropJsonBlocks(qint64 page);
+  void evictPages();
+  void dropPages();
+  void loadRange();
+
+  std::shared_ptr<kafka::BatchSource> m_source;
+  qint32 m_partition = 0;
+  kafka::OffsetRange m_range;
+  int m_exposedRows = 0;
+  quint64 m_generation = 0;
+  qint64 m_pendingSeek = -1;
+
+  QHash<qint64, std::shared_ptr<const Page>> m_pages;
+  mutable QSet<qint64> m_pendingPages;
+  qint64 m_residentBytes = 0;
+  int m_corruptBatches = 0;
+  bool m_verifyChecksums = true;
+  int m_viewportFirst = 0;
+  int m_viewportLast = 0;
+  std::shared_ptr<ViewportWindow> m_window = std::make_shared<ViewportWindow>();
+  std::shared_ptr<kafka::SchemaCache> m_schemas;
+  QSet<qint32> m_schemaIdsSeen;
+  std::vector<JsonColumn> m_jsonColumns;
+  quint64 m_nextJsonColumnId = 0;
+
+  mutable QThreadPool m_pool;
+};
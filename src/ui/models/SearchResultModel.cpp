@@ -0,0 +1,85 @@
+#include "ui/models/SearchResultModel.h"
+
+#include <QDateTime>
+
+SearchResultModel::SearchResultModel(QObject *parent) : QAbstractTableModel(parent) {}
+
+void SearchResultModel::append(const QVector<kafka::SearchMatch> &matches) {
+  if (matches.isEmpty())
+    return;
+  beginInsertRows(QModelIndex(), m_matches.size(), m_matches.size() + matches.size() - 1);
+  m_matches += matches;
+  endInsertRows();
+}
+
+void SearchResultModel::clear() {
+  beginResetModel();
+  m_matches.clear();
+  endResetModel();
+}
+
+int SearchResultModel::rowCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : m_matches.size();
+}
+
+int SearchResultModel::columnCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant SearchResultModel::headerData(int section, Qt::Orientation orientation, int role) const {
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QAbstractTableModel::headerData(section, orientation, role);
+
+  switch (section) {
+  case PartitionColumn:
+    return tr("Partition");
+  case OffsetColumn:
+    return tr("Offset");
+  case TimestampColumn:
+    return tr("Timestamp");
+  case FieldColumn:
+    return tr("Field");
+  case MatchColumn:
+    return tr("Match");
+  default:
+    return QVariant();
+  }
+}
+
+QVariant SearchResultModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || index.row() >= m_matches.size())
+    return QVariant();
+
+  const int column = index.column();
+  if (role == Qt::TextAlignmentRole) {
+    if (column == PartitionColumn || column == OffsetColumn)
+      return int(Qt::AlignRight | Qt::AlignVCenter);
+    return int(Qt::AlignLeft | Qt::AlignVCenter);
+  }
+  if (role != Qt::DisplayRole)
+    return QVariant();
+
+  const kafka::SearchMatch &match = m_matches.at(index.row());
+  switch (column) {
+  case PartitionColumn:
+    return match.partition;
+  case OffsetColumn:
+    return match.offset;
+  case TimestampColumn:
+    return QDateTime::fromMSecsSinceEpoch(match.timestamp, Qt::UTC).toString(Qt::ISODateWithMs);
+  case FieldColumn:
+    switch (match.field) {
+    case kafka::SearchMatch::Key:
+      return tr("Key");
+    case kafka::SearchMatch::Value:
+      return tr("Value");
+    case kafka::SearchMatch::Headers:
+      return tr("Header %1").arg(match.headerKey);
+    }
+    return QVariant();
+  case MatchColumn:
+    return match.preview;
+  default:
+    return QVariant();
+  }
+}
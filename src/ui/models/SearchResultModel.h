@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+#include "core/search/TopicSearch.h"
+
+/**
+ * @brief Matches of a TopicSearch, appended as they stream in.
+ */
+class SearchResultModel final : public QAbstractTableModel {
+  Q_OBJECT
+
+public:
+  enum Column {
+    PartitionColumn,
+    OffsetColumn,
+    TimestampColumn,
+    FieldColumn,
+    MatchColumn,
+    ColumnCount
+  };
+
+  explicit SearchResultModel(QObject *parent = nullptr);
+
+  void append(const QVector<kafka::SearchMatch> &matches);
+  void clear();
+  const kafka::SearchMatch &matchAt(int row) const { return m_matches.at(row); }
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+private:
+  QVector<kafka::SearchMatch> m_matches;
+};
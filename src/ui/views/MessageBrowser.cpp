@@ -0,0 +1,910 @@
+#include "ui/views/MessageBrowser.h"
+
+#include <QComboBox>
+#include <QDateTime>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QInputDialog>
+#include <QLabel>
+#include <QLineEdit>
+#include <QLocale>
+#include <QMenu>
+#include <QScrollBar>
+#include <QSettings>
+#include <QSplitter>
+#include <QTableView>
+#include <QVBoxLayout>
+
+#include <algorithm>
+
+#include "core/codec/BatchDecoder.h"
+#include "core/filter/RecordFilter.h"
+#include "core/filter/TopicFilter.h"
+#include "core/json/JsonPath.h"
+#include "core/network/KafkaClient.h"
+#include "core/source/KafkaBatchSource.h"
+#include "core/storage/AllocationCounter.h"
+#include "ui/models/FilteredMessageModel.h"
+#include "ui/models/LiveTailModel.h"
+#include "ui/models/MergedMessageModel.h"
+#include "ui/models/MessageTableModel.h"
+#include "ui/widgets/FlatButton.h"
+#include "ui/widgets/PayloadInspector.h"
+#include "ui/widgets/TracedTableView.h"
+
+namespace
+{
+constexpr int kRowHeight = 22;
+constexpr int kJsonColumnWidth = 160;
+constexpr Qt::MatchFlags kExactMatch = Qt::MatchExactly | Qt::MatchCaseSensitive;
+const QString kBootstrapServersKey = QStringLiteral("connection/bootstrapServers");
+// Partition combo data of the entry merging every partition by time.
+constexpr int kMergedPartitions = -1;
+
+bool parseTime(const QString &text, qint64 *timestamp)
+{
+    QDateTime time = QDateTime::fromString(text, Qt::ISODateWithMs);
+    if (!time.isValid())
+        time = QDateTime::fromString(text, Qt::ISODate);
+    if (!time.isValid())
+        return false;
+    *timestamp = time.toMSecsSinceEpoch();
+    return true;
+}
+
+// Index keeping the sorted items of @p combo sorted once @p text is inserted.
+int sortedInsertIndex(const QComboBox *combo, const QString &text)
+{
+    int low = 0;
+    int high = combo->count();
+    while (low < high) {
+        const int mid = low + (high - low) / 2;
+        if (combo->itemText(mid) < text)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+}
+
+MessageBrowser::MessageBrowser(kafka::KafkaClient *client, QWidget *parent)
+    : QWidget(parent), m_client(client), m_model(new MessageTableModel(this))
+{
+    setObjectName(QStringLiteral("MessageBrowser"));
+    setupUi();
+
+    connect(m_client, &kafka::KafkaClient::metadataChanged, this,
+            &MessageBrowser::onMetadataChanged);
+    connect(m_model, &MessageTableModel::offsetRangeChanged, this, [this]() {
+        m_lastError.clear();
+        updateStatus();
+        updateViewport();
+    });
+    connect(m_model, &MessageTableModel::loadFailed, this, [this](const QString &error) {
+        m_lastError = error;
+        updateStatus();
+    });
+    connect(m_model, &MessageTableModel::residencyChanged, this, &MessageBrowser::updateStatus);
+    connect(m_model, &MessageTableModel::seekCompleted, this, [this](int row) {
+        const QModelIndex index = m_model->index(row, MessageTableModel::OffsetColumn);
+        m_table->scrollTo(index, QAbstractItemView::PositionAtTop);
+        m_table->setCurrentIndex(index);
+    });
+}
+
+void MessageBrowser::setupUi()
+{
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(8, 8, 8, 8);
+    layout->setSpacing(6);
+
+    auto *toolbar = new QHBoxLayout();
+    toolbar->setSpacing(6);
+
+    m_bootstrapEdit = new QLineEdit(this);
+    m_bootstrapEdit->setPlaceholderText(tr("host:port[,host:port...]"));
+    m_connectButton = new FlatButton(tr("Connect"), this);
+    m_topicCombo = new QComboBox(this);
+    m_topicCombo->setMinimumContentsLength(24);
+    m_topicCombo->setSizeAdjustPolicy(QComboBox::AdjustToMinimumContentsLengthWithIcon);
+    m_partitionCombo = new QComboBox(this);
+    m_partitionCombo->setMinimumContentsLength(4);
+    m_seekEdit = new QLineEdit(this);
+    m_seekEdit->setPlaceholderText(tr("Go to offset or time"));
+    m_seekEdit->setToolTip(tr("An offset, or a time such as 2024-05-01T12:00:00Z"));
+    m_followButton = new FlatButton(tr("Follow"), this);
+    m_followButton->setCheckable(true);
+    m_followButton->setToolTip(tr("Show records of every partition as they are produced"));
+    m_payloadButton = new FlatButton(tr("Payload"), this);
+    m_payloadButton->setCheckable(true);
+    m_payloadButton->setToolTip(tr("Show the selected message's value as hex, ASCII or UTF-8"));
+
+    toolbar->addWidget(new QLabel(tr("Bootstrap"), this));
+    toolbar->addWidget(m_bootstrapEdit, /*stretch=*/1);
+    toolbar->addWidget(m_connectButton);
+    toolbar->addSpacing(12);
+    toolbar->addWidget(m_topicCombo);
+    toolbar->addWidget(new QLabel(tr("Partition"), this));
+    toolbar->addWidget(m_partitionCombo);
+    toolbar->addSpacing(12);
+    toolbar->addWidget(m_seekEdit);
+    toolbar->addWidget(m_followButton);
+    toolbar->addWidget(m_payloadButton);
+    layout->addLayout(toolbar);
+
+    auto *filterBar = new QHBoxLayout();
+    filterBar->setSpacing(6);
+    m_filterEdit = new QLineEdit(this);
+    m_filterEdit->setClearButtonEnabled(true);
+    m_filterEdit->setPlaceholderText(
+        tr("Filter, e.g. ts > now-5m && header[\"tenant\"] == \"acme\" && $.amount > 1000"));
+    m_filterEdit->setToolTip(
+        tr("Fields: offset, partition, ts, size, key, value, header[\"name\"], $.json.path\n"
+           "Operators: == != < <= > >= contains + - && || !\n"
+           "Times: now, durations such as 30s, 5m, 2h, 1d, or \"2024-05-01T12:00:00Z\"\n"
+           "Press Enter to run over every partition of the topic"));
+    filterBar->addWidget(new QLabel(tr("Filter"), this));
+    filterBar->addWidget(m_filterEdit, /*stretch=*/1);
+    layout->addLayout(filterBar);
+
+    // Every row has the same fixed height so the view never measures rows;
+    // together with uniform pages this keeps scrolling cost independent of
+    // the row count.
+    m_table = new TracedTableView(this);
+    m_table->setModel(m_model);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setWordWrap(false);
+    m_table->setAlternatingRowColors(true);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_table->verticalHeader()->setDefaultSectionSize(kRowHeight);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    m_table->horizontalHeader()->setStretchLastSection(false);
+    m_table->horizontalHeader()->setSectionResizeMode(MessageTableModel::ValueColumn,
+                                                      QHeaderView::Stretch);
+    m_table->setColumnWidth(MessageTableModel::OffsetColumn, 110);
+    m_table->setColumnWidth(MessageTableModel::TimestampColumn, 190);
+    m_table->setColumnWidth(MessageTableModel::KeyColumn, 180);
+    m_table->setColumnWidth(MessageTableModel::SizeColumn, 70);
+    m_table->setContextMenuPolicy(Qt::CustomContextMenu);
+    m_table->horizontalHeader()->setContextMenuPolicy(Qt::CustomContextMenu);
+
+    // The payload panel shares a splitter with the tables and stays hidden
+    // until asked for.
+    auto *splitter = new QSplitter(Qt::Horizontal, this);
+    auto *tables = new QWidget(splitter);
+    m_tablesLayout = new QVBoxLayout(tables);
+    m_tablesLayout->setContentsMargins(0, 0, 0, 0);
+    m_tablesLayout->addWidget(m_table, /*stretch=*/1);
+    m_inspector = new PayloadInspector(splitter);
+    m_inspector->hide();
+    splitter->addWidget(tables);
+    splitter->addWidget(m_inspector);
+    splitter->setStretchFactor(0, 3);
+    splitter->setStretchFactor(1, 2);
+    layout->addWidget(splitter, /*stretch=*/1);
+
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setObjectName(QStringLiteral("MessageBrowserStatus"));
+    layout->addWidget(m_statusLabel);
+
+    connect(m_connectButton, &QPushButton::clicked, this, [this]() {
+        connectTo(m_bootstrapEdit->text());
+    });
+    connect(m_bootstrapEdit, &QLineEdit::returnPressed, m_connectButton, &QPushButton::click);
+    connect(m_topicCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            &MessageBrowser::openSelectedTopic);
+    connect(m_partitionCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            &MessageBrowser::openSelectedPartition);
+    connect(m_followButton, &QPushButton::toggled, this, &MessageBrowser::setFollowing);
+    connect(m_payloadButton, &QPushButton::toggled, this, [this](bool show) {
+        m_inspector->setVisible(show);
+        inspectCurrentRow();
+    });
+    connect(m_table->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+            &MessageBrowser::inspectCurrentRow);
+    // The selected row's page may arrive after the selection.
+    connect(m_model, &QAbstractItemModel::dataChanged, this, &MessageBrowser::inspectCurrentRow);
+    connect(m_seekEdit, &QLineEdit::returnPressed, this, [this]() {
+        seekTo(m_seekEdit->text());
+    });
+    connect(m_filterEdit, &QLineEdit::returnPressed, this, &MessageBrowser::applyFilter);
+    // The clear button leaves the filter view without waiting for Enter.
+    connect(m_filterEdit, &QLineEdit::textChanged, this, [this](const QString &text) {
+        if (text.isEmpty())
+            stopFilter();
+    });
+    connect(m_table, &QWidget::customContextMenuRequested, this, &MessageBrowser::showTableMenu);
+    connect(m_table->horizontalHeader(), &QWidget::customContextMenuRequested, this,
+            &MessageBrowser::showHeaderMenu);
+
+    auto *scrollBar = m_table->verticalScrollBar();
+    connect(scrollBar, &QScrollBar::valueChanged, this, &MessageBrowser::updateViewport);
+    connect(scrollBar, &QScrollBar::rangeChanged, this, &MessageBrowser::updateViewport);
+
+    updateStatus();
+}
+
+// Built on the first Follow: most sessions never tail, and the model
+// preallocates a frame's worth of records.
+void MessageBrowser::createTailView()
+{
+    m_tailModel = new LiveTailModel(this);
+    m_tailTable = new TracedTableView(this);
+    m_tailTable->setModel(m_tailModel);
+    m_tailTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_tailTable->setWordWrap(false);
+    m_tailTable->setAlternatingRowColors(true);
+    m_tailTable->verticalHeader()->setVisible(false);
+    m_tailTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_tailTable->verticalHeader()->setDefaultSectionSize(kRowHeight);
+    m_tailTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    m_tailTable->horizontalHeader()->setStretchLastSection(false);
+    m_tailTable->horizontalHeader()->setSectionResizeMode(LiveTailModel::ValueColumn,
+                                                          QHeaderView::Stretch);
+    m_tailTable->setColumnWidth(LiveTailModel::PartitionColumn, 70);
+    m_tailTable->setColumnWidth(LiveTailModel::OffsetColumn, 110);
+    m_tailTable->setColumnWidth(LiveTailModel::TimestampColumn, 190);
+    m_tailTable->setColumnWidth(LiveTailModel::KeyColumn, 180);
+    m_tailTable->setColumnWidth(LiveTailModel::SizeColumn, 70);
+    m_tailTable->hide();
+    m_tablesLayout->insertWidget(m_tablesLayout->indexOf(m_table) + 1, m_tailTable,
+                                 /*stretch=*/1);
+
+    connect(m_tailModel, &LiveTailModel::statsChanged, this, &MessageBrowser::updateStatus);
+    // Rows arrive once per frame; keep the newest in view unless the user
+    // scrolled up to read.
+    connect(m_tailModel, &QAbstractItemModel::rowsInserted, this, [this]() {
+        if (m_tailAtBottom)
+            m_tailTable->scrollToBottom();
+    });
+    auto *tailScrollBar = m_tailTable->verticalScrollBar();
+    connect(tailScrollBar, &QScrollBar::valueChanged, this, [this, tailScrollBar](int value) {
+        m_tailAtBottom = value >= tailScrollBar->maximum();
+    });
+}
+
+// Built the first time the merged partitions are picked, like the tail view.
+void MessageBrowser::createMergeView()
+{
+    m_mergeModel = new MergedMessageModel(this);
+    m_mergeTable = new TracedTableView(this);
+    m_mergeTable->setModel(m_mergeModel);
+    m_mergeTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_mergeTable->setWordWrap(false);
+    m_mergeTable->setAlternatingRowColors(true);
+    m_mergeTable->verticalHeader()->setVisible(false);
+    m_mergeTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_mergeTable->verticalHeader()->setDefaultSectionSize(kRowHeight);
+    m_mergeTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    m_mergeTable->horizontalHeader()->setStretchLastSection(false);
+    m_mergeTable->horizontalHeader()->setSectionResizeMode(MergedMessageModel::ValueColumn,
+                                                           QHeaderView::Stretch);
+    m_mergeTable->setColumnWidth(MergedMessageModel::PartitionColumn, 70);
+    m_mergeTable->setColumnWidth(MergedMessageModel::OffsetColumn, 110);
+    m_mergeTable->setColumnWidth(MergedMessageModel::TimestampColumn, 190);
+    m_mergeTable->setColumnWidth(MergedMessageModel::KeyColumn, 180);
+    m_mergeTable->setColumnWidth(MergedMessageModel::SizeColumn, 70);
+    m_mergeTable->hide();
+    m_tablesLayout->insertWidget(m_tablesLayout->indexOf(m_table) + 1, m_mergeTable,
+                                 /*stretch=*/1);
+
+    connect(m_mergeModel, &MergedMessageModel::loadFailed, this, [this](const QString &error) {
+        m_lastError = error;
+        updateStatus();
+    });
+    connect(m_mergeModel, &MergedMessageModel::residencyChanged, this,
+            &MessageBrowser::updateStatus);
+    connect(m_mergeModel, &MergedMessageModel::mergeCompleted, this,
+            &MessageBrowser::updateStatus);
+    connect(m_mergeModel, &QAbstractItemModel::modelReset, m_mergeTable,
+            &QTableView::scrollToTop);
+    connect(m_mergeTable->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+            &MessageBrowser::inspectCurrentRow);
+    connect(m_mergeModel, &QAbstractItemModel::dataChanged, this,
+            &MessageBrowser::inspectCurrentRow);
+    auto *scrollBar = m_mergeTable->verticalScrollBar();
+    connect(scrollBar, &QScrollBar::valueChanged, this, &MessageBrowser::updateMergeViewport);
+    connect(scrollBar, &QScrollBar::rangeChanged, this, &MessageBrowser::updateMergeViewport);
+}
+
+// Built by the first filter, like the tail view.
+void MessageBrowser::createFilterView()
+{
+    m_filter = new kafka::TopicFilter(this);
+    m_filterModel = new FilteredMessageModel(this);
+    m_filterTable = new TracedTableView(this);
+    m_filterTable->setModel(m_filterModel);
+    m_filterTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_filterTable->setWordWrap(false);
+    m_filterTable->setAlternatingRowColors(true);
+    m_filterTable->verticalHeader()->setVisible(false);
+    m_filterTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_filterTable->verticalHeader()->setDefaultSectionSize(kRowHeight);
+    m_filterTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    m_filterTable->horizontalHeader()->setStretchLastSection(false);
+    m_filterTable->horizontalHeader()->setSectionResizeMode(FilteredMessageModel::ValueColumn,
+                                                            QHeaderView::Stretch);
+    m_filterTable->setColumnWidth(FilteredMessageModel::PartitionColumn, 70);
+    m_filterTable->setColumnWidth(FilteredMessageModel::OffsetColumn, 110);
+    m_filterTable->setColumnWidth(FilteredMessageModel::TimestampColumn, 190);
+    m_filterTable->setColumnWidth(FilteredMessageModel::KeyColumn, 180);
+    m_filterTable->setColumnWidth(FilteredMessageModel::SizeColumn, 70);
+    m_filterTable->setToolTip(tr("Double-click a match to open it in its partition"));
+    m_filterTable->hide();
+    m_tablesLayout->insertWidget(m_tablesLayout->indexOf(m_table) + 1, m_filterTable,
+                                 /*stretch=*/1);
+
+    connect(m_filter, &kafka::TopicFilter::matchesFound, m_filterModel,
+            &FilteredMessageModel::append);
+    connect(m_filter, &kafka::TopicFilter::progressChanged, this,
+            [this](qint64 scanned, qint64 total) {
+                m_filterScanned = scanned;
+                m_filterTotal = total;
+                updateStatus();
+            });
+    connect(m_filter, &kafka::TopicFilter::finished, this, &MessageBrowser::updateStatus);
+    connect(m_filterTable->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+            &MessageBrowser::inspectCurrentRow);
+    connect(m_filterTable, &QAbstractItemView::doubleClicked, this,
+            [this](const QModelIndex &index) {
+                const kafka::FilterMatch match = m_filterModel->matchAt(index.row());
+                stopFilter();
+                showMessage(match.partition, match.offset);
+            });
+}
+
+bool MessageBrowser::isMerging() const
+{
+    return m_mergeModel && m_partitionCombo->currentIndex() >= 0 &&
+           m_partitionCombo->currentData().toInt() == kMergedPartitions;
+}
+
+void MessageBrowser::showActiveTable()
+{
+    const bool follow = m_followButton->isChecked();
+    const bool filtering = !follow && m_filtering;
+    const bool merging = !follow && !filtering && isMerging();
+    m_table->setVisible(!follow && !filtering && !merging);
+    if (m_filterTable)
+        m_filterTable->setVisible(filtering);
+    if (m_mergeTable)
+        m_mergeTable->setVisible(merging);
+    if (m_tailTable)
+        m_tailTable->setVisible(follow);
+}
+
+void MessageBrowser::connectTo(const QString &bootstrapServers)
+{
+    const QStringList servers = bootstrapServers.split(QLatin1Char(','), Qt::SkipEmptyParts);
+    if (servers.isEmpty())
+        return;
+
+    m_bootstrapEdit->setText(servers.join(QLatin1Char(',')));
+    m_fixedSource.reset();
+    m_topicPartitions.clear();
+    m_model->clear();
+    m_followButton->setChecked(false);
+    m_topicCombo->clear();
+    m_topicsFromCache = false;
+    m_lastError.clear();
+    m_client->setBootstrapServers(servers);
+    m_client->refreshMetadata();
+    m_statusLabel->setText(tr("Connecting to %1...").arg(servers.join(QStringLiteral(", "))));
+    QSettings().setValue(kBootstrapServersKey, servers.join(QLatin1Char(',')));
+}
+
+void MessageBrowser::restoreLastConnection()
+{
+    const QString servers = QSettings().value(kBootstrapServersKey).toString();
+    if (!servers.isEmpty())
+        connectTo(servers);
+}
+
+void MessageBrowser::openSource(std::shared_ptr<kafka::BatchSource> source,
+                                const QVector<qint32> &partitions)
+{
+    m_fixedSource = std::move(source);
+    m_topicPartitions.clear();
+    m_lastError.clear();
+    if (!m_fixedSource) {
+        m_model->clear();
+        m_followButton->setChecked(false);
+        m_topicCombo->clear();
+        return;
+    }
+
+    const QString topic = m_fixedSource->topic();
+    m_topicPartitions.insert(topic, partitions);
+    {
+        const QSignalBlocker blocker(m_topicCombo);
+        m_topicCombo->clear();
+        m_topicCombo->addItem(topic);
+        m_topicCombo->setCurrentIndex(0);
+    }
+    openSelectedTopic();
+}
+
+std::shared_ptr<kafka::BatchSource> MessageBrowser::currentSource() const
+{
+    if (isMerging())
+        return m_mergeModel->source();
+    return m_model->source();
+}
+
+QVector<qint32> MessageBrowser::currentPartitions() const
+{
+    return m_topicPartitions.value(m_topicCombo->currentText());
+}
+
+void MessageBrowser::showMessage(qint32 partition, qint64 offset)
+{
+    const int index = m_partitionCombo->findData(partition);
+    if (index < 0)
+        return;
+    // Switching partitions reloads the model; the seek waits for its range.
+    if (index != m_partitionCombo->currentIndex())
+        m_partitionCombo->setCurrentIndex(index);
+    m_model->seekToOffset(offset);
+}
+
+void MessageBrowser::showTopicMessage(const QString &topic, qint32 partition, qint64 offset)
+{
+    const int index = m_topicCombo->findText(topic, kExactMatch);
+    if (index < 0)
+        return;
+    if (index != m_topicCombo->currentIndex())
+        m_topicCombo->setCurrentIndex(index);
+    showMessage(partition, offset);
+}
+
+// Only the difference is applied, so a refresh of a cluster with thousands
+// of topics does not rebuild the topic list or reopen what is being read.
+void MessageBrowser::onMetadataChanged(const kafka::MetadataDiff &diff)
+{
+    if (m_fixedSource)
+        return;
+
+    const QString current = m_topicCombo->currentText();
+    bool currentPartitionsChanged = false;
+    {
+        const QSignalBlocker blocker(m_topicCombo);
+        for (const QString &topic : diff.removedTopics) {
+            m_topicPartitions.remove(topic);
+            const int index = m_topicCombo->findText(topic, kExactMatch);
+            if (index >= 0)
+                m_topicCombo->removeItem(index);
+        }
+
+        // The first diff fills an empty list; that is done in one call.
+        const bool fill = m_topicCombo->count() == 0;
+        QStringList added;
+        for (const kafka::TopicInfo &topic : diff.changedTopics) {
+            QVector<qint32> partitions;
+            partitions.reserve(topic.partitions.size());
+            for (const kafka::PartitionInfo &partition : topic.partitions)
+                partitions.append(partition.partition);
+            std::sort(partitions.begin(), partitions.end());
+
+            const auto existing = m_topicPartitions.find(topic.name);
+            if (existing != m_topicPartitions.end()) {
+                if (topic.name == current && existing.value() != partitions)
+                    currentPartitionsChanged = true;
+                existing.value() = std::move(partitions);
+                continue;
+            }
+            m_topicPartitions.insert(topic.name, std::move(partitions));
+            if (fill)
+                added.append(topic.name);
+            else
+                m_topicCombo->insertItem(sortedInsertIndex(m_topicCombo, topic.name), topic.name);
+        }
+        if (fill) {
+            added.sort();
+            m_topicCombo->addItems(added);
+        }
+    }
+
+    if (m_topicsFromCache != diff.fromCache) {
+        m_topicsFromCache = diff.fromCache;
+        updateStatus();
+    }
+
+    const int index = current.isEmpty() ? -1 : m_topicCombo->findText(current, kExactMatch);
+    if (index < 0) {
+        const QSignalBlocker blocker(m_topicCombo);
+        m_topicCombo->setCurrentIndex(m_topicCombo->count() > 0 ? 0 : -1);
+    } else if (index != m_topicCombo->currentIndex()) {
+        const QSignalBlocker blocker(m_topicCombo);
+        m_topicCombo->setCurrentIndex(index);
+    }
+    if (index < 0) {
+        openSelectedTopic();
+        return;
+    }
+    if (!currentPartitionsChanged)
+        return;
+
+    // Partitions were added to the open topic; keep reading the same one
+    // unless it went away.
+    const QVariant partition = m_partitionCombo->currentData();
+    setPartitions(m_topicPartitions.value(current));
+    const int partitionIndex = m_partitionCombo->findData(partition);
+    if (partitionIndex >= 0) {
+        const QSignalBlocker blocker(m_partitionCombo);
+        m_partitionCombo->setCurrentIndex(partitionIndex);
+    } else {
+        openSelectedPartition();
+    }
+}
+
+void MessageBrowser::setPartitions(const QVector<qint32> &partitions)
+{
+    const QSignalBlocker blocker(m_partitionCombo);
+    m_partitionCombo->clear();
+    for (qint32 partition : partitions)
+        m_partitionCombo->addItem(QString::number(partition), partition);
+    if (partitions.size() > 1)
+        m_partitionCombo->addItem(tr("All, by time"), kMergedPartitions);
+    if (!partitions.isEmpty())
+        m_partitionCombo->setCurrentIndex(0);
+}
+
+void MessageBrowser::openSelectedTopic()
+{
+    setPartitions(m_topicPartitions.value(m_topicCombo->currentText()));
+    openSelectedPartition();
+}
+
+void MessageBrowser::openSelectedPartition()
+{
+    // The matches belong to what was open before.
+    stopFilter();
+    const QString topic = m_topicCombo->currentText();
+    if (topic.isEmpty() || m_partitionCombo->currentIndex() < 0) {
+        m_model->clear();
+        if (m_mergeModel)
+            m_mergeModel->clear();
+        m_followButton->setChecked(false);
+        return;
+    }
+
+    std::shared_ptr<kafka::BatchSource> source = m_fixedSource;
+    if (!source)
+        source = std::make_shared<kafka::KafkaBatchSource>(m_client, topic);
+
+    m_lastError.clear();
+    m_inspector->showMessage(tr("Select a message"));
+    const int partition = m_partitionCombo->currentData().toInt();
+    if (partition == kMergedPartitions) {
+        if (!m_mergeModel)
+            createMergeView();
+        // Starts at the time in the seek box, if it holds one, else at the
+        // beginning of every partition.
+        qint64 timestamp = 0;
+        parseTime(m_seekEdit->text().trimmed(), &timestamp);
+        m_model->clear();
+        m_mergeModel->start(std::move(source), currentPartitions(), timestamp);
+    } else {
+        if (m_mergeModel)
+            m_mergeModel->clear();
+        m_model->setSource(std::move(source), partition);
+        m_table->scrollToTop();
+    }
+    showActiveTable();
+    if (m_followButton->isChecked())
+        m_tailModel->start(currentSource(), currentPartitions());
+    updateStatus();
+}
+
+void MessageBrowser::seekTo(const QString &target)
+{
+    const QString text = target.trimmed();
+    if (text.isEmpty())
+        return;
+    stopFilter();
+
+    bool isOffset = false;
+    const qint64 offset = text.toLongLong(&isOffset);
+    if (isOffset && isMerging()) {
+        m_lastError = tr("The merged partitions have no common offsets; enter a time");
+        updateStatus();
+        return;
+    }
+    if (isOffset) {
+        m_model->seekToOffset(offset);
+        return;
+    }
+
+    qint64 timestamp = 0;
+    if (!parseTime(text, &timestamp)) {
+        m_lastError = tr("Cannot parse \"%1\" as an offset or ISO 8601 time").arg(text);
+        updateStatus();
+        return;
+    }
+    if (isMerging()) {
+        m_lastError.clear();
+        m_mergeModel->seekToTimestamp(timestamp);
+        updateStatus();
+        return;
+    }
+    m_model->seekToTimestamp(timestamp);
+}
+
+void MessageBrowser::showTableMenu(const QPoint &position)
+{
+    QByteArray key;
+    const QModelIndex index = m_table->indexAt(position);
+    if (!index.isValid() || !m_model->keyAt(index.row(), &key))
+        return;
+
+    QMenu menu(this);
+    QAction *versionsAction = menu.addAction(tr("Show every version of this key"));
+    if (menu.exec(m_table->viewport()->mapToGlobal(position)) == versionsAction)
+        emit keyVersionsRequested(key);
+}
+
+void MessageBrowser::showHeaderMenu(const QPoint &position)
+{
+    QHeaderView *header = m_table->horizontalHeader();
+    const int column = header->logicalIndexAt(position);
+
+    QMenu menu(this);
+    QAction *addAction = menu.addAction(tr("Add JSON column..."));
+    QAction *removeAction = nullptr;
+    if (m_model->isJsonColumn(column)) {
+        removeAction = menu.addAction(
+            tr("Remove column %1").arg(m_model->headerData(column, Qt::Horizontal).toString()));
+    }
+    QAction *chosen = menu.exec(header->viewport()->mapToGlobal(position));
+    if (chosen == addAction)
+        addJsonColumn();
+    else if (chosen && chosen == removeAction)
+        m_model->removeJsonColumn(column);
+}
+
+// Values are parsed lazily: the column only costs something for the pages
+// that get painted, and it is extracted off the GUI thread.
+void MessageBrowser::addJsonColumn()
+{
+    bool ok = false;
+    const QString expression =
+        QInputDialog::getText(this, tr("Add JSON column"), tr("JSONPath, e.g. $.order.id:"),
+                              QLineEdit::Normal, QStringLiteral("$."), &ok);
+    if (!ok || expression.trimmed().isEmpty())
+        return;
+
+    QString error;
+    std::shared_ptr<const kafka::JsonPath> path = kafka::JsonPath::compile(expression, &error);
+    if (!path) {
+        m_lastError = tr("Invalid JSONPath \"%1\": %2").arg(expression, error);
+        updateStatus();
+        return;
+    }
+    m_model->addJsonColumn(std::move(path));
+    m_table->setColumnWidth(m_model->columnCount() - 1, kJsonColumnWidth);
+}
+
+// Follows every partition of the open topic, not just the selected one;
+// the paged table keeps its place underneath.
+void MessageBrowser::setFollowing(bool follow)
+{
+    if (follow && !currentSource()) {
+        const QSignalBlocker blocker(m_followButton);
+        m_followButton->setChecked(false);
+        return;
+    }
+    if (!m_tailModel) {
+        if (!follow)
+            return;
+        createTailView();
+    }
+    if (follow) {
+        m_tailAtBottom = true;
+        m_tailModel->start(currentSource(), currentPartitions());
+    } else {
+        m_tailModel->stop();
+    }
+    showActiveTable();
+    m_seekEdit->setEnabled(!follow);
+    updateStatus();
+}
+
+// "now" is read once here, so the expression means the same thing for
+// every record the scan reaches later.
+void MessageBrowser::applyFilter()
+{
+    const QString expression = m_filterEdit->text().trimmed();
+    if (expression.isEmpty()) {
+        stopFilter();
+        return;
+    }
+    std::shared_ptr<kafka::BatchSource> source = currentSource();
+    if (!source)
+        return;
+
+    QString error;
+    std::shared_ptr<const kafka::RecordFilter> filter = kafka::RecordFilter::compile(
+        expression, QDateTime::currentMSecsSinceEpoch(), &error);
+    if (!filter) {
+        m_lastError = tr("Invalid filter: %1").arg(error);
+        updateStatus();
+        return;
+    }
+
+    if (!m_filter)
+        createFilterView();
+    m_lastError.clear();
+    m_filtering = true;
+    m_filterModel->clear();
+    m_filter->start(std::move(source), currentPartitions(), std::move(filter));
+    showActiveTable();
+    inspectCurrentRow();
+    updateStatus();
+}
+
+// Keeps the expression in the bar so Enter runs it again.
+void MessageBrowser::stopFilter()
+{
+    if (!m_filtering)
+        return;
+    m_filtering = false;
+    m_filter->cancel();
+    m_filterModel->clear();
+    showActiveTable();
+    updateStatus();
+}
+
+void MessageBrowser::updateViewport()
+{
+    const int first = qMax(0, m_table->rowAt(0));
+    int last = m_table->rowAt(m_table->viewport()->height() - 1);
+    if (last < 0)
+        last = m_model->rowCount() - 1;
+    m_model->setViewport(first, qMax(first, last));
+}
+
+void MessageBrowser::updateMergeViewport()
+{
+    const int first = qMax(0, m_mergeTable->rowAt(0));
+    int last = m_mergeTable->rowAt(m_mergeTable->viewport()->height() - 1);
+    if (last < 0)
+        last = m_mergeModel->rowCount() - 1;
+    m_mergeModel->setViewport(first, qMax(first, last));
+}
+
+// Only the visible lines of the value are ever formatted, so even a value
+// of many megabytes is shown straight from its page without a copy.
+void MessageBrowser::inspectCurrentRow()
+{
+    if (!m_payloadButton->isChecked())
+        return;
+    // Matches keep only the start of their value.
+    if (m_filtering) {
+        m_inspector->showMessage(tr("Double-click a match to inspect its value"));
+        return;
+    }
+    const bool merging = isMerging();
+    const QTableView *table = merging ? m_mergeTable : m_table;
+    const int row = table->currentIndex().row();
+    if (row < 0) {
+        m_inspector->showMessage(tr("Select a message"));
+        return;
+    }
+
+    qint32 partition = 0;
+    qint64 offset = 0;
+    std::shared_ptr<const void> owner;
+    std::string_view value;
+    bool isNull = false;
+    bool loaded = false;
+    if (merging) {
+        loaded = m_mergeModel->positionAt(row, &partition, &offset) &&
+                 m_mergeModel->valueAt(row, &owner, &value, &isNull);
+    } else {
+        partition = m_model->partition();
+        offset = m_model->offsetForRow(row);
+        loaded = m_model->valueAt(row, &owner, &value, &isNull);
+    }
+    if (!loaded) {
+        m_inspector->showMessage(tr("No record loaded for this row"));
+        return;
+    }
+    // Pages reload under a selection; keep the reader's place in the value.
+    if (!m_inspector->isShowing(partition, offset))
+        m_inspector->setValue(partition, offset, std::move(owner), value, isNull);
+}
+
+void MessageBrowser::updateStatus()
+{
+    if (!m_lastError.isEmpty()) {
+        m_statusLabel->setText(tr("Error: %1").arg(m_lastError));
+        return;
+    }
+
+    const QLocale locale;
+    if (m_followButton->isChecked()) {
+        QString text =
+            tr("Following %n partition(s) · %1 received in %2 frames, up to %3 per frame",
+               nullptr, currentPartitions().size())
+                .arg(locale.toString(m_tailModel->receivedCount()))
+                .arg(locale.toString(m_tailModel->frameCount()))
+                .arg(locale.toString(m_tailModel->largestFrame()));
+        text += tr(" · %1 dropped (queue full), %2 evicted (ring of %3)")
+                    .arg(locale.toString(m_tailModel->droppedCount()))
+                    .arg(locale.toString(m_tailModel->evictedCount()))
+                    .arg(locale.toString(LiveTailModel::kCapacity));
+        if (!m_tailModel->errorString().isEmpty())
+            text += tr(" · %1").arg(m_tailModel->errorString());
+        m_statusLabel->setText(text);
+        return;
+    }
+
+    if (m_filtering) {
+        QString text = tr("Filter matched %n message(s)", nullptr, m_filter->matchCount());
+        if (m_filter->isRunning()) {
+            text += tr(" so far");
+            if (m_filterTotal > 0)
+                text += tr(" · %1 of %2 offsets scanned")
+                            .arg(locale.toString(m_filterScanned))
+                            .arg(locale.toString(m_filterTotal));
+        } else if (m_filter->limitReached()) {
+            text += tr(" · stopped at the limit of %1")
+                        .arg(locale.toString(kafka::TopicFilter::kMaxMatches));
+        }
+        text += tr(" · %n partition(s)", nullptr, currentPartitions().size());
+        if (m_filter->skippedBatches() > 0)
+            text += tr(" · %n undecodable batch(es) skipped", nullptr,
+                       static_cast<int>(m_filter->skippedBatches()));
+        if (!m_filter->errorString().isEmpty())
+            text += tr(" · %1").arg(m_filter->errorString());
+        if (m_fixedSource)
+            text.prepend(m_fixedSource->description() + QStringLiteral(" · "));
+        m_statusLabel->setText(text);
+        return;
+    }
+
+    if (isMerging()) {
+        const QString from =
+            m_mergeModel->startTimestamp() > 0
+                ? QDateTime::fromMSecsSinceEpoch(m_mergeModel->startTimestamp(), Qt::UTC)
+                      .toString(Qt::ISODate)
+                : tr("the beginning");
+        QString text = tr("%n partition(s) merged by time from %1", nullptr,
+                          m_mergeModel->partitions().size())
+                           .arg(from);
+        const QString rows = locale.toString(m_mergeModel->rowCount());
+        text += m_mergeModel->isComplete() ? tr(" · %1 messages").arg(rows)
+                                           : tr(" · %1 messages so far").arg(rows);
+        text += tr(" · %1 pages resident, %2")
+                    .arg(m_mergeModel->residentPageCount())
+                    .arg(locale.formattedDataSize(m_mergeModel->residentBytes()));
+        if (m_fixedSource)
+            text.prepend(m_fixedSource->description() + QStringLiteral(" · "));
+        m_statusLabel->setText(text);
+        return;
+    }
+
+    const kafka::OffsetRange range = m_model->offsetRange();
+    QString text = tr("Offsets %1 – %2 (%3 messages) · %4 pages resident, %5")
+                       .arg(locale.toString(range.start))
+                       .arg(locale.toString(range.end))
+                       .arg(locale.toString(range.size()))
+                       .arg(m_model->residentPageCount())
+                       .arg(locale.formattedDataSize(m_model->residentBytes()));
+    const kafka::DecodedBatchCache &cache = kafka::BatchDecoder::shared().cache();
+    if (cache.totalBytes() > 0)
+        text += tr(" · decoded cache %1").arg(locale.formattedDataSize(cache.totalBytes()));
+    if (kafka::AllocationCounter::isEnabled() && m_model->residentPageCount() > 0)
+        text += tr(" · %1 allocations/record").arg(m_model->allocationsPerRecord(), 0, 'f', 3);
+    if (m_model->corruptBatchCount() > 0)
+        text += tr(" · %n batch(es) failed the CRC check", nullptr, m_model->corruptBatchCount());
+    if (m_model->schemaCache())
+        text += tr(" · schemas from %1").arg(m_model->schemaCache()->description());
+    if (m_fixedSource)
+        text.prepend(m_fixedSource->description() + QStringLiteral(" · "));
+    else if (m_topicsFromCache)
+        text += tr(" · topics from cache, refreshing...");
+    m_statusLabel->setText(text);
+}
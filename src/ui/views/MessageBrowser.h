@@ -0,0 +1,135 @@
+#pragma once
+
+#include <QHash>
+#include <QVector>
+#include <QWidget>
+
+#include <memory>
+
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QTableView;
+class QVBoxLayout;
+
+class FilteredMessageModel;
+class FlatButton;
+class LiveTailModel;
+class MergedMessageModel;
+class MessageTableModel;
+class PayloadInspector;
+
+namespace kafka {
+class BatchSource;
+class KafkaClient;
+class TopicFilter;
+struct MetadataDiff;
+}
+
+/**
+ * @brief Topic/partition picker on top of a virtualized message table.
+ *
+ * Picking "All, by time" as the partition shows every partition of the
+ * topic merged into one table in timestamp order; seeking to a time then
+ * restarts the merge there.
+ *
+ * An expression entered in the filter bar is compiled once and run over
+ * every partition of the topic on worker threads; only the matches are
+ * shown, in a table of their own until the filter is cleared.
+ */
+class MessageBrowser final : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit MessageBrowser(kafka::KafkaClient *client, QWidget *parent = nullptr);
+
+    MessageTableModel *model() const { return m_model; }
+
+    /**
+     * @brief Browses @p source instead of the cluster until the next
+     * connectTo(), e.g. a log directory opened from disk.
+     */
+    void openSource(std::shared_ptr<kafka::BatchSource> source, const QVector<qint32> &partitions);
+
+    /** Source of the open topic, or null when none is open. */
+    std::shared_ptr<kafka::BatchSource> currentSource() const;
+    QVector<qint32> currentPartitions() const;
+    /** Switches to @p partition of the open topic and scrolls to @p offset. */
+    void showMessage(qint32 partition, qint64 offset);
+    /** Opens @p topic, if the browser lists it, and shows the message there. */
+    void showTopicMessage(const QString &topic, qint32 partition, qint64 offset);
+
+public slots:
+    /** Connects and remembers @p bootstrapServers for restoreLastConnection(). */
+    void connectTo(const QString &bootstrapServers);
+    /** Connects to the servers of the last connectTo(), if any. */
+    void restoreLastConnection();
+
+signals:
+    /** Asked from the table's context menu for the open partition. */
+    void keyVersionsRequested(const QByteArray &key);
+
+private:
+    void setupUi();
+    void onMetadataChanged(const kafka::MetadataDiff &diff);
+    void setPartitions(const QVector<qint32> &partitions);
+    void openSelectedTopic();
+    void openSelectedPartition();
+    void seekTo(const QString &target);
+    void showTableMenu(const QPoint &position);
+    void showHeaderMenu(const QPoint &position);
+    void addJsonColumn();
+    void setFollowing(bool follow);
+    void createTailView();
+    void createMergeView();
+    void createFilterView();
+    bool isMerging() const;
+    void applyFilter();
+    void stopFilter();
+    void showActiveTable();
+    void updateViewport();
+    void updateMergeViewport();
+    void inspectCurrentRow();
+    void updateStatus();
+
+    kafka::KafkaClient *m_client = nullptr;
+    MessageTableModel *m_model = nullptr;
+    LiveTailModel *m_tailModel = nullptr;
+    MergedMessageModel *m_mergeModel = nullptr;
+    FilteredMessageModel *m_filterModel = nullptr;
+    kafka::TopicFilter *m_filter = nullptr;
+
+    QLineEdit *m_bootstrapEdit = nullptr;
+    FlatButton *m_connectButton = nullptr;
+    QComboBox *m_topicCombo = nullptr;
+    QComboBox *m_partitionCombo = nullptr;
+    QLineEdit *m_seekEdit = nullptr;
+    FlatButton *m_followButton = nullptr;
+    FlatButton *m_payloadButton = nullptr;
+    QLineEdit *m_filterEdit = nullptr;
+    // Holds m_table and the views shown instead of it.
+    QVBoxLayout *m_tablesLayout = nullptr;
+    QTableView *m_table = nullptr;
+    // Shown instead of m_table while following; created with m_tailModel
+    // by the first setFollowing(true).
+    QTableView *m_tailTable = nullptr;
+    // Shown instead of m_table for the merged partitions; created with
+    // m_mergeModel the first time they are picked.
+    QTableView *m_mergeTable = nullptr;
+    // Shown instead of the others while a filter runs or its matches are
+    // on screen; created with m_filterModel by the first filter.
+    QTableView *m_filterTable = nullptr;
+    bool m_filtering = false;
+    qint64 m_filterScanned = 0;
+    qint64 m_filterTotal = 0;
+    bool m_tailAtBottom = true;
+    PayloadInspector *m_inspector = nullptr;
+    QLabel *m_statusLabel = nullptr;
+    QString m_lastError;
+    // Set while browsing something other than the connected cluster.
+    std::shared_ptr<kafka::BatchSource> m_fixedSource;
+    QHash<QString, QVector<qint32>> m_topicPartitions;
+    // The topic list came from the metadata cache and is being refreshed.
+    bool m_topicsFromCache = false;
+};
@@ -12,29 +12,12 @@ FlatButton::FlatButton(const QString &text, QWidget *parent)
     initStyle();
 }
 
+// Colors come from the FlatButton rules of the application stylesheet. A
+// stylesheet of its own would make every button parse and resolve styles
+// separately, and would override the theme.
 void FlatButton::initStyle()
 {
     setCursor(Qt::PointingHandCursor);
     setFlat(true);
     setMinimumHeight(34);
-    setStyleSheet(
-        "FlatButton {"
-        "  border: 1px solid rgba(255,255,255,0.2);"
-        "  border-radius: 6px;"
-        "  padding: 6px 18px;"
-        "  color: #ffffff;"
-        "  background-color: #0078D4"
-        "}"
-        "FlatButton:hover {"
-        "  border-color: rgba(255,255,255,0.4);"
-        "  background-color: #1590f0"
-        "}"
-        "FlatButton:pressed {"
-        "  background-color: #005a9e"
-        "}"
-        "FlatButton:disabled {"
-        "  color: rgba(255,255,255,0.4);"
-        "  border-color: rgba(255,255,255,0.1);"
-        "  background-color: rgba(255,255,255,0.05);"
-        "}");
 }
@@ -0,0 +1,63 @@
+#include "ui/widgets/PayloadInspector.h"
+
+#include <QComboBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLocale>
+#include <QVBoxLayout>
+
+#include "ui/widgets/PayloadView.h"
+
+PayloadInspector::PayloadInspector(QWidget *parent)
+    : QWidget(parent)
+{
+    setObjectName(QStringLiteral("PayloadInspector"));
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(6);
+
+    auto *header = new QHBoxLayout();
+    m_titleLabel = new QLabel(this);
+    m_modeCombo = new QComboBox(this);
+    m_modeCombo->addItem(tr("Hex"), static_cast<int>(PayloadView::Mode::Hex));
+    m_modeCombo->addItem(tr("ASCII"), static_cast<int>(PayloadView::Mode::Ascii));
+    m_modeCombo->addItem(tr("UTF-8"), static_cast<int>(PayloadView::Mode::Utf8));
+    header->addWidget(m_titleLabel, /*stretch=*/1);
+    header->addWidget(m_modeCombo);
+    layout->addLayout(header);
+
+    m_view = new PayloadView(this);
+    layout->addWidget(m_view, /*stretch=*/1);
+
+    connect(m_modeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]() {
+        m_view->setMode(static_cast<PayloadView::Mode>(m_modeCombo->currentData().toInt()));
+    });
+    showMessage(tr("Select a message"));
+}
+
+void PayloadInspector::setValue(qint32 partition, qint64 offset,
+                                std::shared_ptr<const void> owner, std::string_view value,
+                                bool isNull)
+{
+    m_partition = partition;
+    m_offset = offset;
+    const QLocale locale;
+    QString title = tr("Partition %1 · offset %2 · ").arg(partition).arg(locale.toString(offset));
+    title += isNull ? tr("null value")
+                    : locale.formattedDataSize(static_cast<qint64>(value.size()));
+    m_titleLabel->setText(title);
+    m_view->setPayload(std::move(owner), value);
+}
+
+void PayloadInspector::showMessage(const QString &message)
+{
+    m_partition = -1;
+    m_offset = -1;
+    m_titleLabel->setText(message);
+    m_view->clear();
+}
+
+bool PayloadInspector::isShowing(qint32 partition, qint64 offset) const
+{
+    return m_partition == partition && m_offset == offset;
+}
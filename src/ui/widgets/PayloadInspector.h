@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QWidget>
+
+#include <memory>
+#include <string_view>
+
+class QComboBox;
+class QLabel;
+
+class PayloadView;
+
+/**
+ * @brief Side panel showing the value of the selected message through a
+ * PayloadView, with a choice of hex, ASCII or UTF-8.
+ */
+class PayloadInspector final : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit PayloadInspector(QWidget *parent = nullptr);
+
+    /**
+     * @brief Shows the value of the record at @p offset of @p partition;
+     * @p value must stay valid as long as @p owner lives.
+     */
+    void setValue(qint32 partition, qint64 offset, std::shared_ptr<const void> owner,
+                  std::string_view value, bool isNull);
+    /** Shows @p message instead of a value, e.g. while its page loads. */
+    void showMessage(const QString &message);
+
+    /** Whether the value of @p offset of @p partition is the one shown. */
+    bool isShowing(qint32 partition, qint64 offset) const;
+
+private:
+    QLabel *m_titleLabel = nullptr;
+    QComboBox *m_modeCombo = nullptr;
+    PayloadView *m_view = nullptr;
+    qint32 m_partition = -1;
+    qint64 m_offset = -1;
+};
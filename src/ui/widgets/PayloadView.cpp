@@ -0,0 +1,185 @@
+#include "ui/widgets/PayloadView.h"
+
+#include <QFontDatabase>
+#include <QPainter>
+#include <QScrollBar>
+
+#include <limits>
+
+#include "core/trace/Trace.h"
+
+namespace
+{
+constexpr int kHexBytesPerLine = 16;
+constexpr int kTextBytesPerLine = 64;
+// Offset column, then two spaces.
+constexpr int kOffsetChars = 10;
+// Sixteen "xx " groups, a gap after the eighth, a space, then the ASCII.
+constexpr int kHexChars = kOffsetChars + kHexBytesPerLine * 3 + 2 + kHexBytesPerLine;
+constexpr int kTextChars = kOffsetChars + kTextBytesPerLine;
+constexpr int kMargin = 6;
+const char kHexDigits[] = "0123456789abcdef";
+
+QChar asciiChar(unsigned char byte)
+{
+    return byte >= 0x20 && byte < 0x7f ? QLatin1Char(static_cast<char>(byte)) : QLatin1Char('.');
+}
+
+bool isContinuationByte(char byte)
+{
+    return (static_cast<unsigned char>(byte) & 0xc0) == 0x80;
+}
+}
+
+PayloadView::PayloadView(QWidget *parent)
+    : QAbstractScrollArea(parent)
+{
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    setFocusPolicy(Qt::StrongFocus);
+    verticalScrollBar()->setSingleStep(1);
+}
+
+void PayloadView::setPayload(std::shared_ptr<const void> owner, std::string_view bytes)
+{
+    m_owner = std::move(owner);
+    m_bytes = bytes;
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    updateScrollBar();
+    viewport()->update();
+}
+
+void PayloadView::clear()
+{
+    setPayload(nullptr, std::string_view());
+}
+
+void PayloadView::setMode(Mode mode)
+{
+    if (m_mode == mode)
+        return;
+    // Keep the byte at the top of the view in view.
+    const qint64 topByte = lineStart(verticalScrollBar()->value());
+    m_mode = mode;
+    updateScrollBar();
+    verticalScrollBar()->setValue(static_cast<int>(topByte / bytesPerLine()));
+    viewport()->update();
+}
+
+int PayloadView::bytesPerLine() const
+{
+    return m_mode == Mode::Hex ? kHexBytesPerLine : kTextBytesPerLine;
+}
+
+qint64 PayloadView::lineCount() const
+{
+    const auto size = static_cast<qint64>(m_bytes.size());
+    return (size + bytesPerLine() - 1) / bytesPerLine();
+}
+
+qint64 PayloadView::lineStart(qint64 line) const
+{
+    const auto size = static_cast<qint64>(m_bytes.size());
+    const qint64 nominal = line * bytesPerLine();
+    if (nominal >= size)
+        return size;
+    qint64 start = nominal;
+    // A UTF-8 sequence is at most four bytes, so a line moves back by at
+    // most three to begin on a whole character.
+    if (m_mode == Mode::Utf8) {
+        while (start > 0 && start > nominal - 3 &&
+               isContinuationByte(m_bytes[static_cast<std::size_t>(start)]))
+            --start;
+    }
+    return start;
+}
+
+QString PayloadView::lineText(qint64 line) const
+{
+    const qint64 start = lineStart(line);
+    const qint64 end = lineStart(line + 1);
+    const char *data = m_bytes.data() + start;
+    const int length = static_cast<int>(end - start);
+
+    QString text;
+    text.reserve(kHexChars);
+    text += QStringLiteral("%1  ").arg(start, 8, 16, QLatin1Char('0'));
+
+    switch (m_mode) {
+    case Mode::Hex:
+        for (int i = 0; i < kHexBytesPerLine; ++i) {
+            if (i < length) {
+                const auto byte = static_cast<unsigned char>(data[i]);
+                text += QLatin1Char(kHexDigits[byte >> 4]);
+                text += QLatin1Char(kHexDigits[byte & 0x0f]);
+                text += QLatin1Char(' ');
+            } else {
+                text += QStringLiteral("   ");
+            }
+            if (i == kHexBytesPerLine / 2 - 1)
+                text += QLatin1Char(' ');
+        }
+        text += QLatin1Char(' ');
+        for (int i = 0; i < length; ++i)
+            text += asciiChar(static_cast<unsigned char>(data[i]));
+        break;
+    case Mode::Ascii:
+        for (int i = 0; i < length; ++i)
+            text += asciiChar(static_cast<unsigned char>(data[i]));
+        break;
+    case Mode::Utf8: {
+        // Line breaks and other controls would break the fixed line grid;
+        // they are shown as symbols.
+        const QString decoded = QString::fromUtf8(data, length);
+        for (QChar ch : decoded) {
+            if (ch == QLatin1Char('\n'))
+                ch = QChar(0x21b5);
+            else if (ch == QLatin1Char('\t'))
+                ch = QChar(0x2192);
+            else if (ch.category() == QChar::Other_Control)
+                ch = QChar(0x00b7);
+            text += ch;
+        }
+        break;
+    }
+    }
+    return text;
+}
+
+void PayloadView::updateScrollBar()
+{
+    const QFontMetrics metrics(font());
+    const int visibleLines = qMax(1, viewport()->height() / metrics.height());
+    const qint64 lines = lineCount();
+    const int maximum = static_cast<int>(
+        qBound<qint64>(0, lines - visibleLines, std::numeric_limits<int>::max()));
+    verticalScrollBar()->setRange(0, maximum);
+    verticalScrollBar()->setPageStep(visibleLines);
+
+    const int chars = m_mode == Mode::Hex ? kHexChars : kTextChars;
+    const int width = metrics.horizontalAdvance(QLatin1Char('0')) * chars + 2 * kMargin;
+    horizontalScrollBar()->setRange(0, qMax(0, width - viewport()->width()));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+}
+
+void PayloadView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBar();
+}
+
+void PayloadView::paintEvent(QPaintEvent *)
+{
+    KAFKA_TRACE_SCOPE("paint payload");
+    QPainter painter(viewport());
+    painter.setFont(font());
+    painter.setPen(palette().color(QPalette::Text));
+    const QFontMetrics metrics(font());
+    const int lineHeight = metrics.height();
+    const qint64 first = verticalScrollBar()->value();
+    const qint64 last = qMin(lineCount(), first + viewport()->height() / lineHeight + 1);
+    const int x = kMargin - horizontalScrollBar()->value();
+    int y = metrics.ascent();
+    for (qint64 line = first; line < last; ++line, y += lineHeight)
+        painter.drawText(x, y, lineText(line));
+}
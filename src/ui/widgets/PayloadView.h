@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QAbstractScrollArea>
+
+#include <memory>
+#include <string_view>
+
+/**
+ * @brief Scrollable hex, ASCII or UTF-8 rendering of a byte payload of any
+ * size.
+ *
+ * The view reads the payload where it lies (a record's page buffers) and
+ * formats only the lines that are painted, so a 20 MB value costs the same
+ * to show and to scroll as a 20 byte one. Lines cover a fixed number of
+ * bytes, which makes the line of any byte a division: no pass over the
+ * payload is ever made. UTF-8 lines start at character boundaries, and
+ * line breaks in the text are shown as symbols rather than followed.
+ */
+class PayloadView final : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    enum class Mode {
+        Hex,
+        Ascii,
+        Utf8,
+    };
+
+    explicit PayloadView(QWidget *parent = nullptr);
+
+    /**
+     * @brief Shows @p bytes, which must stay valid as long as @p owner
+     * lives; the view keeps @p owner until the next setPayload() or clear().
+     */
+    void setPayload(std::shared_ptr<const void> owner, std::string_view bytes);
+    void clear();
+    std::string_view payload() const { return m_bytes; }
+
+    void setMode(Mode mode);
+    Mode mode() const { return m_mode; }
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    qint64 lineCount() const;
+    int bytesPerLine() const;
+    // First byte of @p line; UTF-8 lines back up to a character boundary.
+    qint64 lineStart(qint64 line) const;
+    QString lineText(qint64 line) const;
+    void updateScrollBar();
+
+    std::shared_ptr<const void> m_owner;
+    std::string_view m_bytes;
+    Mode m_mode = Mode::Hex;
+};
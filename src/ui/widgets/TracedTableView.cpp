@@ -0,0 +1,14 @@
+#include "ui/widgets/TracedTableView.h"
+
+#include "core/trace/Trace.h"
+
+TracedTableView::TracedTableView(QWidget *parent)
+    : QTableView(parent)
+{
+}
+
+void TracedTableView::paintEvent(QPaintEvent *event)
+{
+    KAFKA_TRACE_SCOPE("paint table");
+    QTableView::paintEvent(event);
+}
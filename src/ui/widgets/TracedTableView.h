@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QTableView>
+
+/**
+ * @brief QTableView whose paint passes show up in performance traces.
+ */
+class TracedTableView : public QTableView
+{
+    Q_OBJECT
+
+public:
+    explicit TracedTableView(QWidget *parent = nullptr);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+};
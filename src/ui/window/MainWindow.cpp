@@ -3,23 +3,49 @@
 #include <QApplication>
 #include <QDebug>
 #include <QEvent>
+#include <QFileDialog>
 #include <QGridLayout>
+#include <QInputDialog>
+#include <QLineEdit>
 #include <QMenuBar>
+#include <QMessageBox>
+#include <QSettings>
 #include <QVBoxLayout>
 #include <QWindow>
 
 #include "app/Application.h"
+#include "core/cache/BatchCache.h"
+#include "core/log/LogDirectory.h"
+#include "core/network/KafkaClient.h"
+#include "core/network/KafkaSession.h"
+#include "core/network/MetadataCache.h"
+#include "core/schema/LocalSchemaDirectory.h"
+#include "core/schema/SchemaRegistryClient.h"
+#include "core/source/BatchSource.h"
+#include "core/source/LogDirectorySource.h"
+#include "core/trace/Trace.h"
 #include "ui/dialogs/AboutDialog.h"
+#include "ui/dialogs/ConsumerLagDialog.h"
+#include "ui/dialogs/CorrelationDialog.h"
+#include "ui/dialogs/ExportDialog.h"
+#include "ui/dialogs/FindDialog.h"
+#include "ui/dialogs/KeyVersionsDialog.h"
+#include "ui/dialogs/ReplayDialog.h"
+#include "ui/dialogs/StatsDialog.h"
+#include "ui/models/MessageTableModel.h"
+#include "ui/views/MessageBrowser.h"
 #include "ui/window/decoration/TitleBar.h"
 #include "ui/window/decoration/WindowResizeHandle.h"
 
 namespace
 {
 constexpr int kResizeHandleThickness = 6;
+const QString kBatchCacheBudgetKey = QStringLiteral("cache/batchBudgetMiB");
+constexpr int kMiB = 1 << 20;
 }
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent)
+    : QMainWindow(parent), m_session(new kafka::KafkaSession(this))
 {
     setObjectName(QStringLiteral("MainWindow"));
     setWindowTitle(QStringLiteral("Kafka Viewer"));
@@ -29,6 +55,33 @@ MainWindow::MainWindow(QWidget *parent)
     updateWindowUiState();
 }
 
+// The message model, the search, the key lookup, the lag monitor, the
+// export, the replay, the statistics scan and the correlation scan wait
+// for their worker threads on destruction and those talk to the session's
+// client, so all of them have to go before the session.
+MainWindow::~MainWindow()
+{
+    delete m_findDialog;
+    delete m_keyVersionsDialog;
+    delete m_consumerLagDialog;
+    delete m_correlationDialog;
+    delete m_exportDialog;
+    delete m_replayDialog;
+    delete m_statsDialog;
+    delete m_messageBrowser;
+}
+
+void MainWindow::restoreSession()
+{
+    m_session->client()->setMetadataCacheRoot(kafka::MetadataCache::defaultRoot());
+    const qint64 budgetMiB =
+        QSettings().value(kBatchCacheBudgetKey, kafka::BatchCache::kDefaultBudget / kMiB)
+            .toLongLong();
+    m_session->client()->setBatchCache(std::make_shared<kafka::BatchCache>(
+        kafka::BatchCache::defaultRoot(), budgetMiB * kMiB));
+    m_messageBrowser->restoreLastConnection();
+}
+
 void MainWindow::setupUi()
 {
     auto *root = new QWidget(this);
@@ -54,6 +107,16 @@ void MainWindow::setupUi()
 
     auto *content = new QWidget(m_contentContainer);
     content->setObjectName(QStringLiteral("MainContent"));
+    auto *mainLayout = new QVBoxLayout(content);
+    mainLayout->setContentsMargins(0, 0, 0, 0);
+    mainLayout->setSpacing(0);
+    m_messageBrowser = new MessageBrowser(m_session->client(), content);
+    mainLayout->addWidget(m_messageBrowser);
+    connect(m_messageBrowser, &MessageBrowser::keyVersionsRequested, this,
+            [this](const QByteArray &key) {
+                findKeyVersions();
+                m_keyVersionsDialog->lookUp(key);
+            });
     contentLayout->addWidget(content, /*stretch=*/1);
 
     grid->addWidget(m_contentContainer, 1, 1);
@@ -106,6 +169,35 @@ void MainWindow::connectTitleBarSignals()
         AboutDialog dialog(this);
         dialog.exec();
     });
+    QObject::connect(m_titleBar, &TitleBar::traceRecordingRequested, this,
+                     [](bool record) { kafka::Trace::setEnabled(record); });
+    QObject::connect(m_titleBar, &TitleBar::saveTraceRequested, this, &MainWindow::saveTrace);
+    QObject::connect(m_titleBar, &TitleBar::openLogDirectoryRequested, this,
+                     &MainWindow::openLogDirectory);
+    QObject::connect(m_titleBar, &TitleBar::exportRequested, this, &MainWindow::exportRange);
+    QObject::connect(m_titleBar, &TitleBar::replayRequested, this, &MainWindow::replayIntoTopic);
+    QObject::connect(m_titleBar, &TitleBar::findAcrossTopicRequested, this,
+                     &MainWindow::findAcrossTopic);
+    QObject::connect(m_titleBar, &TitleBar::findKeyVersionsRequested, this,
+                     &MainWindow::findKeyVersions);
+    QObject::connect(m_titleBar, &TitleBar::correlateRequested, this,
+                     &MainWindow::correlateAcrossTopics);
+    QObject::connect(m_titleBar, &TitleBar::consumerLagRequested, this,
+                     &MainWindow::showConsumerLag);
+    QObject::connect(m_titleBar, &TitleBar::topicStatsRequested, this,
+                     &MainWindow::showTopicStats);
+    QObject::connect(m_titleBar, &TitleBar::verifyChecksumsRequested, this, [this](bool verify) {
+        m_messageBrowser->model()->setVerifyChecksums(verify);
+    });
+    QObject::connect(m_titleBar, &TitleBar::schemaRegistryRequested, this,
+                     &MainWindow::useSchemaRegistry);
+    QObject::connect(m_titleBar, &TitleBar::schemaDirectoryRequested, this,
+                     &MainWindow::useSchemaDirectory);
+    QObject::connect(m_titleBar, &TitleBar::schemaDecodingOffRequested, this, [this]() {
+        m_messageBrowser->model()->setSchemaCache(nullptr);
+    });
+    QObject::connect(m_titleBar, &TitleBar::batchCacheRequested, this,
+                     &MainWindow::configureBatchCache);
     QObject::connect(m_titleBar, &TitleBar::useSystemFrameRequested, this,
                     &MainWindow::setUseSystemFrame);
     QObject::connect(m_titleBar, &TitleBar::themeChanged, this, [](const QString &themeName) {
@@ -115,6 +207,202 @@ void MainWindow::connectTitleBarSignals()
     });
 }
 
+// Opens a partition directory, or a broker log directory holding several,
+// copied from a broker; segments are memory-mapped, not loaded.
+void MainWindow::openLogDirectory()
+{
+    const QString path = QFileDialog::getExistingDirectory(this, tr("Open log directory"));
+    if (path.isEmpty())
+        return;
+
+    const QVector<kafka::LogPartitionDirectory> directories = kafka::LogDirectory::scan(path);
+    QStringList topics;
+    for (const auto &directory : directories) {
+        if (!topics.contains(directory.topic))
+            topics.append(directory.topic);
+    }
+    if (topics.isEmpty()) {
+        QMessageBox::warning(this, tr("Open log directory"),
+                             tr("No Kafka partition directories found in %1.").arg(path));
+        return;
+    }
+
+    QString topic = topics.first();
+    if (topics.size() > 1) {
+        bool ok = false;
+        topic = QInputDialog::getItem(this, tr("Open log directory"), tr("Topic:"), topics, 0,
+                                      /*editable=*/false, &ok);
+        if (!ok)
+            return;
+    }
+
+    QVector<qint32> partitions;
+    for (const auto &directory : directories) {
+        if (directory.topic == topic)
+            partitions.append(directory.partition);
+    }
+    m_messageBrowser->openSource(std::make_shared<kafka::LogDirectorySource>(topic, directories),
+                                 partitions);
+}
+
+void MainWindow::exportRange()
+{
+    if (!m_exportDialog)
+        m_exportDialog = new ExportDialog(this);
+    m_exportDialog->setTarget(m_messageBrowser->currentSource(),
+                              m_messageBrowser->currentPartitions(),
+                              m_messageBrowser->model()->partition());
+    m_exportDialog->show();
+    m_exportDialog->raise();
+    m_exportDialog->activateWindow();
+}
+
+void MainWindow::replayIntoTopic()
+{
+    if (!m_replayDialog)
+        m_replayDialog = new ReplayDialog(m_session->client(), this);
+    QStringList topics;
+    for (const auto &topic : m_session->client()->metadata().topics) {
+        if (!topic.isInternal)
+            topics.append(topic.name);
+    }
+    topics.sort();
+    const auto source = m_messageBrowser->currentSource();
+    m_replayDialog->setTopics(topics, source ? source->topic() : QString());
+    m_replayDialog->show();
+    m_replayDialog->raise();
+    m_replayDialog->activateWindow();
+}
+
+void MainWindow::findAcrossTopic()
+{
+    if (!m_findDialog) {
+        m_findDialog = new FindDialog(this);
+        connect(m_findDialog, &FindDialog::matchActivated, m_messageBrowser,
+                &MessageBrowser::showMessage);
+    }
+    m_findDialog->setTarget(m_messageBrowser->currentSource(),
+                            m_messageBrowser->currentPartitions());
+    m_findDialog->show();
+    m_findDialog->raise();
+    m_findDialog->activateWindow();
+}
+
+void MainWindow::findKeyVersions()
+{
+    if (!m_keyVersionsDialog) {
+        m_keyVersionsDialog = new KeyVersionsDialog(this);
+        connect(m_keyVersionsDialog, &KeyVersionsDialog::versionActivated, m_messageBrowser,
+                &MessageBrowser::showMessage);
+    }
+    m_keyVersionsDialog->setTarget(m_messageBrowser->currentSource(),
+                                   m_messageBrowser->model()->partition());
+    m_keyVersionsDialog->show();
+    m_keyVersionsDialog->raise();
+    m_keyVersionsDialog->activateWindow();
+}
+
+void MainWindow::correlateAcrossTopics()
+{
+    if (!m_correlationDialog) {
+        m_correlationDialog = new CorrelationDialog(m_session->client(), this);
+        connect(m_correlationDialog, &CorrelationDialog::messageActivated, m_messageBrowser,
+                &MessageBrowser::showTopicMessage);
+    }
+    QStringList topics;
+    for (const auto &topic : m_session->client()->metadata().topics) {
+        if (!topic.isInternal)
+            topics.append(topic.name);
+    }
+    topics.sort();
+    const auto source = m_messageBrowser->currentSource();
+    m_correlationDialog->setTopics(topics, source ? source->topic() : QString());
+    m_correlationDialog->show();
+    m_correlationDialog->raise();
+    m_correlationDialog->activateWindow();
+}
+
+void MainWindow::showConsumerLag()
+{
+    if (!m_consumerLagDialog)
+        m_consumerLagDialog = new ConsumerLagDialog(m_session->client(), this);
+    m_consumerLagDialog->show();
+    m_consumerLagDialog->raise();
+    m_consumerLagDialog->activateWindow();
+}
+
+void MainWindow::showTopicStats()
+{
+    if (!m_statsDialog)
+        m_statsDialog = new StatsDialog(this);
+    m_statsDialog->setTarget(m_messageBrowser->currentSource(),
+                             m_messageBrowser->currentPartitions());
+    m_statsDialog->show();
+    m_statsDialog->raise();
+    m_statsDialog->activateWindow();
+}
+
+// Saving works while recording too, so a trace can be written right after
+// reproducing a slowdown; stopping keeps what was recorded until the next
+// start.
+void MainWindow::saveTrace()
+{
+    const QString path = QFileDialog::getSaveFileName(
+        this, tr("Save performance trace"), QStringLiteral("kafka-viewer-trace.json"),
+        tr("Chrome trace (*.json)"));
+    if (path.isEmpty())
+        return;
+    QString error;
+    if (!kafka::Trace::writeChromeJson(path, &error))
+        QMessageBox::warning(this, tr("Save performance trace"), error);
+}
+
+// Schemas are fetched on first use by the page loaders, so a wrong URL
+// shows up as undecoded values with the error in their tooltip.
+void MainWindow::useSchemaRegistry()
+{
+    bool ok = false;
+    const QString url = QInputDialog::getText(this, tr("Schema registry"), tr("Registry URL:"),
+                                              QLineEdit::Normal,
+                                              QStringLiteral("http://localhost:8081"), &ok);
+    if (!ok || url.trimmed().isEmpty())
+        return;
+    const QUrl baseUrl = QUrl::fromUserInput(url.trimmed());
+    if (!baseUrl.isValid()) {
+        QMessageBox::warning(this, tr("Schema registry"), tr("%1 is not a valid URL").arg(url));
+        return;
+    }
+    m_messageBrowser->model()->setSchemaCache(std::make_shared<kafka::SchemaCache>(
+        std::make_shared<kafka::SchemaRegistryClient>(baseUrl)));
+}
+
+// Stands in for a registry: <id>.avsc and <id>.proto files named by schema id.
+void MainWindow::useSchemaDirectory()
+{
+    const QString path = QFileDialog::getExistingDirectory(this, tr("Open schema directory"));
+    if (path.isEmpty())
+        return;
+    m_messageBrowser->model()->setSchemaCache(std::make_shared<kafka::SchemaCache>(
+        std::make_shared<kafka::LocalSchemaDirectory>(path)));
+}
+
+// Takes effect on the next read; a smaller budget evicts on the next fetch.
+void MainWindow::configureBatchCache()
+{
+    const std::shared_ptr<kafka::BatchCache> cache = m_session->client()->batchCache();
+    if (!cache)
+        return;
+    bool ok = false;
+    const int budgetMiB = QInputDialog::getInt(
+        this, tr("Record cache"),
+        tr("Disk space for fetched record batches, in MiB (0 turns the cache off):"),
+        static_cast<int>(cache->budget() / kMiB), 0, 1 << 20, 256, &ok);
+    if (!ok)
+        return;
+    QSettings().setValue(kBatchCacheBudgetKey, budgetMiB);
+    cache->setBudget(qint64(budgetMiB) * kMiB);
+}
+
 void MainWindow::toggleMaximizeRestore()
 {
     if (isMaximized()) {
@@ -175,10 +463,8 @@ void MainWindow::setUseSystemFrame(bool useSystemFrame)
     }
 
     show(); // Required to apply window flag changes
-
-    if (auto *app = qobject_cast<Application *>(QApplication::instance())) {
-        app->loadTheme(app->currentTheme());
-    }
+    // Recreating the native window keeps every widget's style, so the
+    // theme does not need loading again.
 }
 
 // When the window uses the system frame we no longer need a custom title bar,
@@ -9,15 +9,36 @@ class QWidget;
 class QMenuBar;
 class QVBoxLayout;
 
+class ConsumerLagDialog;
+class CorrelationDialog;
+class ExportDialog;
+class FindDialog;
+class KeyVersionsDialog;
+class MessageBrowser;
+class ReplayDialog;
+class StatsDialog;
 class TitleBar;
 class WindowResizeHandle;
 
+namespace kafka {
+class KafkaSession;
+}
+
 
 class MainWindow final : public QMainWindow {
   Q_OBJECT
 
 public:
   explicit MainWindow(QWidget *parent = nullptr);
+  ~MainWindow() override;
+
+  MessageBrowser *messageBrowser() const { return m_messageBrowser; }
+  /**
+   * @brief Enables the metadata cache and reconnects to the last cluster,
+   * whose cached topics show up before it answers. Call once the
+   * application name is set.
+   */
+  void restoreSession();
 
 protected:
   void changeEvent(QEvent *event) override;
@@ -26,6 +47,18 @@ private:
   void setupUi();
   void setupResizeHandles(QWidget *rootWidget, QGridLayout *gridLayout);
   void connectTitleBarSignals();
+  void openLogDirectory();
+  void exportRange();
+  void replayIntoTopic();
+  void findAcrossTopic();
+  void findKeyVersions();
+  void correlateAcrossTopics();
+  void showConsumerLag();
+  void showTopicStats();
+  void saveTrace();
+  void useSchemaRegistry();
+  void useSchemaDirectory();
+  void configureBatchCache();
   void updateWindowUiState();
   void toggleMaximizeRestore();
   void restoreWindow();
@@ -40,5 +73,14 @@ private:
   TitleBar *m_titleBar = nullptr;
   QVector<WindowResizeHandle *> m_resizeHandles;
   QWidget *m_contentContainer = nullptr;
+  kafka::KafkaSession *m_session = nullptr;
+  MessageBrowser *m_messageBrowser = nullptr;
+  FindDialog *m_findDialog = nullptr;
+  KeyVersionsDialog *m_keyVersionsDialog = nullptr;
+  ConsumerLagDialog *m_consumerLagDialog = nullptr;
+  CorrelationDialog *m_correlationDialog = nullptr;
+  ExportDialog *m_exportDialog = nullptr;
+  ReplayDialog *m_replayDialog = nullptr;
+  StatsDialog *m_statsDialog = nullptr;
   bool m_useSystemFrame = false;
 };
@@ -5,7 +5,9 @@
 #include <QDebug>
 #include <QEvent>
 #include <QHBoxLayout>
+#include <QHash>
 #include <QIcon>
+#include <QKeySequence>
 #include <QLabel>
 #include <QMenu>
 #include <QMenuBar>
@@ -14,10 +16,35 @@
 #include <QSizePolicy>
 #include <QStyle>
 #include <QToolButton>
+#include <QWindow>
+
+#include "core/trace/Trace.h"
 
 namespace {
 constexpr auto kIconPrefix = ":/icons/titlebar/";
 constexpr auto kLogoIcon = ":/icons/titlebar/logo.svg";
+constexpr int kButtonIconSize = 16;
+constexpr int kLogoSize = 24;
+
+// SVGs are rasterized once per image, size and device pixel ratio and
+// shared by every title bar; handing a button a fresh file-backed QIcon
+// would render the SVG again on the next paint.
+QPixmap rasterized(const QString &path, int size, qreal devicePixelRatio) {
+  static QHash<QString, QPixmap> cache;
+  const QString key = QStringLiteral("%1:%2@%3").arg(path).arg(size).arg(devicePixelRatio);
+  auto it = cache.find(key);
+  if (it == cache.end()) {
+    const int pixels = qRound(size * devicePixelRatio);
+    QPixmap pixmap = QIcon(path).pixmap(pixels, pixels);
+    pixmap.setDevicePixelRatio(devicePixelRatio);
+    it = cache.insert(key, pixmap);
+  }
+  return it.value();
+}
+
+QString buttonIconPath(const QString &name) {
+  return QString::fromLatin1("%1%2").arg(QLatin1String(kIconPrefix), name);
+}
 } // namespace
 
 TitleBar::TitleBar(QWidget *parent) : QWidget(parent) {
@@ -34,8 +61,7 @@ void TitleBar::setupUi() {
   m_logoLabel = new QLabel(this);
   m_logoLabel->setObjectName(QStringLiteral("TitleBarLogo"));
   m_logoLabel->setAlignment(Qt::AlignCenter);
-  m_logoLabel->setFixedSize(24, 24);
-  m_logoLabel->setPixmap(QIcon(QString::fromLatin1(kLogoIcon)).pixmap(24, 24));
+  m_logoLabel->setFixedSize(kLogoSize, kLogoSize);
 
   m_menuBar = new QMenuBar(this);
   m_menuBar->setObjectName(QStringLiteral("TitleBarMenu"));
@@ -44,13 +70,11 @@ void TitleBar::setupUi() {
   m_menuBar->installEventFilter(this);
   createMenus();
 
-  m_minimizeButton =
-      createButton(QStringLiteral("btn_minimize.svg"), tr("Minimize"));
+  m_minimizeButton = createButton(tr("Minimize"));
   connect(m_minimizeButton, &QToolButton::clicked, this,
           &TitleBar::minimizeRequested);
 
-  m_maximizeButton =
-      createButton(QStringLiteral("btn_maximize.svg"), tr("Maximize"));
+  m_maximizeButton = createButton(tr("Maximize"));
   connect(m_maximizeButton, &QToolButton::clicked, this, [this]() {
     if (m_isMaximized) {
       emit restoreRequested();
@@ -59,7 +83,7 @@ void TitleBar::setupUi() {
     }
   });
 
-  m_closeButton = createButton(QStringLiteral("btn_close.svg"), tr("Close"));
+  m_closeButton = createButton(tr("Close"));
   connect(m_closeButton, &QToolButton::clicked, this,
           &TitleBar::closeRequested);
 
@@ -70,13 +94,43 @@ void TitleBar::setupUi() {
   layout->addWidget(m_minimizeButton);
   layout->addWidget(m_maximizeButton);
   layout->addWidget(m_closeButton);
+
+  updateIcons();
 }
 
-QToolButton *TitleBar::createButton(const QString &iconPath,
-                                    const QString &tooltip) {
+// Icons are set here only: at construction, on show and when the window
+// moves to a screen with another device pixel ratio.
+void TitleBar::updateIcons() {
+  const qreal ratio = devicePixelRatioF();
+  if (ratio == m_iconRatio)
+    return;
+  m_iconRatio = ratio;
+
+  m_logoLabel->setPixmap(rasterized(QString::fromLatin1(kLogoIcon), kLogoSize, ratio));
+  m_minimizeButton->setIcon(
+      rasterized(buttonIconPath(QStringLiteral("btn_minimize.svg")), kButtonIconSize, ratio));
+  m_closeButton->setIcon(
+      rasterized(buttonIconPath(QStringLiteral("btn_close.svg")), kButtonIconSize, ratio));
+  updateMaximizeButton();
+}
+
+void TitleBar::showEvent(QShowEvent *event) {
+  QWidget::showEvent(event);
+  // Switching the window frame recreates the native window, so the
+  // connection is remade whenever the handle changes.
+  QWindow *handle = window()->windowHandle();
+  if (handle && handle != m_watchedWindow) {
+    if (m_watchedWindow)
+      disconnect(m_watchedWindow, nullptr, this, nullptr);
+    m_watchedWindow = handle;
+    connect(handle, &QWindow::screenChanged, this, &TitleBar::updateIcons);
+  }
+  updateIcons();
+}
+
+QToolButton *TitleBar::createButton(const QString &tooltip) {
   auto *button = new QToolButton(this);
-  button->setIcon(QIcon(
-      QString::fromLatin1("%1%2").arg(QLatin1String(kIconPrefix), iconPath)));
+  button->setIconSize(QSize(kButtonIconSize, kButtonIconSize));
   button->setToolTip(tooltip);
   button->setCursor(Qt::PointingHandCursor);
   button->setAutoRaise(true);
@@ -84,9 +138,31 @@ QToolButton *TitleBar::createButton(const QString &iconPath,
 }
 
 void TitleBar::createMenus() {
-  m_menuBar->addMenu(tr("File"));
-  m_menuBar->addMenu(tr("Edit"));
-  m_menuBar->addMenu(tr("View"));
+  auto *fileMenu = m_menuBar->addMenu(tr("File"));
+  auto *openLogDirectoryAction = fileMenu->addAction(tr("Open log directory..."));
+  connect(openLogDirectoryAction, &QAction::triggered, this,
+          &TitleBar::openLogDirectoryRequested);
+  auto *exportAction = fileMenu->addAction(tr("Export..."));
+  connect(exportAction, &QAction::triggered, this, &TitleBar::exportRequested);
+  auto *replayAction = fileMenu->addAction(tr("Replay into topic..."));
+  connect(replayAction, &QAction::triggered, this, &TitleBar::replayRequested);
+
+  auto *editMenu = m_menuBar->addMenu(tr("Edit"));
+  auto *findAcrossTopicAction = editMenu->addAction(tr("Find across topic..."));
+  findAcrossTopicAction->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_F));
+  connect(findAcrossTopicAction, &QAction::triggered, this,
+          &TitleBar::findAcrossTopicRequested);
+  auto *findKeyVersionsAction = editMenu->addAction(tr("Find versions of key..."));
+  connect(findKeyVersionsAction, &QAction::triggered, this,
+          &TitleBar::findKeyVersionsRequested);
+  auto *correlateAction = editMenu->addAction(tr("Correlate across topics..."));
+  connect(correlateAction, &QAction::triggered, this, &TitleBar::correlateRequested);
+
+  auto *viewMenu = m_menuBar->addMenu(tr("View"));
+  auto *consumerLagAction = viewMenu->addAction(tr("Consumer group lag..."));
+  connect(consumerLagAction, &QAction::triggered, this, &TitleBar::consumerLagRequested);
+  auto *topicStatsAction = viewMenu->addAction(tr("Topic statistics..."));
+  connect(topicStatsAction, &QAction::triggered, this, &TitleBar::topicStatsRequested);
   
   auto *settingsMenu = m_menuBar->addMenu(tr("Settings"));
   m_useSystemFrameAction = settingsMenu->addAction(tr("Use system window frame"));
@@ -95,6 +171,24 @@ void TitleBar::createMenus() {
   connect(m_useSystemFrameAction, &QAction::toggled, this,
           &TitleBar::useSystemFrameRequested);
 
+  auto *verifyChecksumsAction = settingsMenu->addAction(tr("Verify batch checksums (CRC32C)"));
+  verifyChecksumsAction->setCheckable(true);
+  verifyChecksumsAction->setChecked(true);
+  connect(verifyChecksumsAction, &QAction::toggled, this,
+          &TitleBar::verifyChecksumsRequested);
+
+  auto *decodeMenu = settingsMenu->addMenu(tr("Decode values"));
+  auto *registryAction = decodeMenu->addAction(tr("Schema registry..."));
+  connect(registryAction, &QAction::triggered, this, &TitleBar::schemaRegistryRequested);
+  auto *directoryAction = decodeMenu->addAction(tr("Local schema directory..."));
+  connect(directoryAction, &QAction::triggered, this, &TitleBar::schemaDirectoryRequested);
+  decodeMenu->addSeparator();
+  auto *decodeOffAction = decodeMenu->addAction(tr("Off"));
+  connect(decodeOffAction, &QAction::triggered, this, &TitleBar::schemaDecodingOffRequested);
+
+  auto *batchCacheAction = settingsMenu->addAction(tr("Record cache size..."));
+  connect(batchCacheAction, &QAction::triggered, this, &TitleBar::batchCacheRequested);
+
   settingsMenu->addSeparator();
 
   // Theme selection
@@ -118,6 +212,13 @@ void TitleBar::createMenus() {
   });
 
   auto *helpMenu = m_menuBar->addMenu(tr("Help"));
+  auto *recordTraceAction = helpMenu->addAction(tr("Record performance trace"));
+  recordTraceAction->setCheckable(true);
+  recordTraceAction->setChecked(kafka::Trace::isEnabled());
+  connect(recordTraceAction, &QAction::toggled, this, &TitleBar::traceRecordingRequested);
+  auto *saveTraceAction = helpMenu->addAction(tr("Save performance trace..."));
+  connect(saveTraceAction, &QAction::triggered, this, &TitleBar::saveTraceRequested);
+  helpMenu->addSeparator();
   auto *aboutAction = helpMenu->addAction(tr("About"));
   connect(aboutAction, &QAction::triggered, this, &TitleBar::aboutRequested);
 }
@@ -131,13 +232,12 @@ void TitleBar::setMaximized(bool maximized) {
 }
 
 void TitleBar::updateMaximizeButton() {
-  if (!m_maximizeButton)
+  if (!m_maximizeButton || m_iconRatio <= 0)
     return;
 
   const QString iconName = m_isMaximized ? QStringLiteral("btn_restore.svg")
                                          : QStringLiteral("btn_maximize.svg");
-  m_maximizeButton->setIcon(QIcon(
-      QString::fromLatin1("%1%2").arg(QLatin1String(kIconPrefix), iconName)));
+  m_maximizeButton->setIcon(rasterized(buttonIconPath(iconName), kButtonIconSize, m_iconRatio));
   m_maximizeButton->setToolTip(m_isMaximized ? tr("Restore") : tr("Maximize"));
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QEvent>
+#include <QPointer>
 #include <QString>
 #include <QWidget>
 
@@ -9,7 +10,9 @@ class QLabel;
 class QMenu;
 class QMenuBar;
 class QMouseEvent;
+class QShowEvent;
 class QToolButton;
+class QWindow;
 
 /**
  * @brief Simple custom title bar with window control buttons.
@@ -34,14 +37,31 @@ signals:
     void closeRequested();
     void systemMoveRequested();
     void aboutRequested();
+    void traceRecordingRequested(bool record);
+    void saveTraceRequested();
+    void openLogDirectoryRequested();
+    void exportRequested();
+    void replayRequested();
+    void findAcrossTopicRequested();
+    void findKeyVersionsRequested();
+    void correlateRequested();
+    void consumerLagRequested();
+    void topicStatsRequested();
     void useSystemFrameRequested(bool useSystemFrame);
+    void verifyChecksumsRequested(bool verify);
+    void schemaRegistryRequested();
+    void schemaDirectoryRequested();
+    void schemaDecodingOffRequested();
+    void batchCacheRequested();
     void themeChanged(const QString &themeName);
 
 private:
     void setupUi();
     void createMenus();
-    QToolButton *createButton(const QString &iconPath, const QString &tooltip);
+    QToolButton *createButton(const QString &tooltip);
+    void updateIcons();
     void updateMaximizeButton();
+    void showEvent(QShowEvent *event) override;
     bool eventFilter(QObject *watched, QEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
     void mouseDoubleClickEvent(QMouseEvent *event) override;
@@ -55,4 +75,7 @@ private:
     QAction *m_lightThemeAction = nullptr;
     QAction *m_darkThemeAction = nullptr;
     bool m_isMaximized = false;
+    // Device pixel ratio the icons were rasterized for; 0 before the first.
+    qreal m_iconRatio = 0;
+    QPointer<QWindow> m_watchedWindow;
 };
@@ -0,0 +1,692 @@
+#include "mock/MockBroker.h"
+
+#include <QHostAddress>
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtEndian>
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <set>
+
+#include "core/protocol/Messages.h"
+
+namespace kafka {
+
+namespace {
+// Long-poll cap so an idle tailing client does not stall shutdown.
+constexpr std::int32_t kMaxFetchWaitMs = 1000;
+// Batches per producer and partition a broker remembers for deduplication.
+constexpr std::size_t kRecentProducerBatches = 5;
+// Kafka's default max.incremental.fetch.session.cache.slots.
+constexpr std::size_t kMaxFetchSessions = 1000;
+} // namespace
+
+struct MockBroker::ResolvedFetch {
+  // Every partition to answer, with the session's positions applied.
+  FetchRequest request;
+  std::int16_t errorCode = 0;
+  std::int32_t sessionId = 0;
+  // Incremental answers leave out partitions without records or errors,
+  // unless the request named them. A real broker also reports partitions
+  // whose high watermark moved; readers here have no use for that.
+  bool incremental = false;
+  std::set<std::pair<std::string, std::int32_t>> named;
+};
+
+MockBroker::MockBroker(QObject *parent) : QObject(parent), m_server(new QTcpServer(this)) {
+  connect(m_server, &QTcpServer::newConnection, this, &MockBroker::onNewConnection);
+}
+
+MockBroker::~MockBroker() = default;
+
+bool MockBroker::listen(quint16 port) {
+  return m_server->listen(QHostAddress::LocalHost, port);
+}
+
+quint16 MockBroker::port() const { return m_server->serverPort(); }
+
+QString MockBroker::bootstrapServer() const {
+  return QStringLiteral("127.0.0.1:%1").arg(port());
+}
+
+void MockBroker::createTopic(const QString &topic, int partitionCount) {
+  if (m_topics.contains(topic))
+    return;
+  m_topics.insert(topic, QVector<PartitionLog>(qMax(1, partitionCount)));
+  m_topicIds.insert(topic, QUuid::createUuid());
+}
+
+void MockBroker::deleteTopic(const QString &topic) {
+  m_topics.remove(topic);
+  m_topicIds.remove(topic);
+}
+
+qint64 MockBroker::append(const QString &topic, int partition,
+                          const std::vector<RecordData> &records) {
+  PartitionLog *log = partitionLog(topic, partition);
+  if (!log || records.empty())
+    return -1;
+
+  RecordBatchBuilder builder(log->nextOffset);
+  builder.setPartitionLeaderEpoch(0);
+  for (const RecordData &record : records)
+    builder.append(record);
+
+  StoredBatch batch;
+  batch.baseOffset = log->nextOffset;
+  batch.lastOffset = log->nextOffset + builder.recordCount() - 1;
+  batch.maxTimestamp = std::max_element(records.begin(), records.end(),
+                                        [](const RecordData &a, const RecordData &b) {
+                                          return a.timestamp < b.timestamp;
+                                        })->timestamp;
+  batch.bytes = builder.build();
+
+  const qint64 baseOffset = batch.baseOffset;
+  log->nextOffset = batch.lastOffset + 1;
+  log->batches.push_back(std::move(batch));
+  return baseOffset;
+}
+
+qint64 MockBroker::endOffset(const QString &topic, int partition) const {
+  const PartitionLog *log = partitionLog(topic.toStdString(), partition);
+  return log ? log->nextOffset : -1;
+}
+
+void MockBroker::commitOffset(const QString &group, const QString &topic, int partition,
+                              qint64 offset) {
+  m_groups[group].offsets[{topic.toStdString(), partition}] = offset;
+}
+
+void MockBroker::setMaxVersion(ApiKey key, std::int16_t maxVersion) {
+  m_maxVersions.insert(static_cast<qint16>(key), maxVersion);
+}
+
+void MockBroker::injectError(ApiKey key, ErrorCode error, int skip) {
+  const auto apiKey = static_cast<qint16>(key);
+  m_injectedErrors[{apiKey, m_requestCounts.value(apiKey) + qMax(0, skip) + 1}] = error;
+}
+
+const MockBroker::PartitionLog *MockBroker::partitionLog(const std::string &topic,
+                                                         std::int32_t partition) const {
+  const auto it = m_topics.constFind(QString::fromStdString(topic));
+  if (it == m_topics.cend() || partition < 0 || partition >= it->size())
+    return nullptr;
+  return &it->at(partition);
+}
+
+MockBroker::PartitionLog *MockBroker::partitionLog(const QString &topic, std::int32_t partition) {
+  const auto it = m_topics.find(topic);
+  if (it == m_topics.end() || partition < 0 || partition >= it->size())
+    return nullptr;
+  return &(*it)[partition];
+}
+
+void MockBroker::onNewConnection() {
+  while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    m_connections.insert(socket, Connection());
+    connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+    connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+      m_connections.remove(socket);
+      socket->deleteLater();
+    });
+  }
+}
+
+void MockBroker::onReadyRead(QTcpSocket *socket) {
+  auto it = m_connections.find(socket);
+  if (it == m_connections.end())
+    return;
+  it->buffer.append(socket->readAll());
+  processFrames(socket);
+}
+
+void MockBroker::processFrames(QTcpSocket *socket) {
+  while (true) {
+    auto it = m_connections.find(socket);
+    if (it == m_connections.end() || it->busy || it->buffer.size() < 4)
+      return;
+
+    const qint32 size = qFromBigEndian<qint32>(it->buffer.constData());
+    if (size < 0) {
+      socket->abort();
+      return;
+    }
+    if (it->buffer.size() - 4 < size)
+      return;
+
+    const QByteArray frame = it->buffer.mid(4, size);
+    it->buffer.remove(0, 4 + size);
+    if (!handleRequest(socket, frame))
+      return;
+  }
+}
+
+bool MockBroker::handleRequest(QTcpSocket *socket, const QByteArray &frame) {
+  WireReader reader(frame.constData(), static_cast<std::size_t>(frame.size()));
+  RequestHeader header;
+  if (!header.decode(reader)) {
+    socket->abort();
+    return false;
+  }
+
+  const auto key = static_cast<qint16>(header.apiKey);
+  m_requestCounts[key] += 1;
+  m_requestBytes[key] += frame.size() + 4;
+  ErrorCode injected = ErrorCode::None;
+  const auto injectedIt = m_injectedErrors.find({key, m_requestCounts.value(key)});
+  if (injectedIt != m_injectedErrors.end()) {
+    injected = injectedIt->second;
+    m_injectedErrors.erase(injectedIt);
+  }
+
+  switch (header.apiKey) {
+  case ApiKey::ApiVersions:
+    respond(socket, header.correlationId, handleApiVersions());
+    return true;
+  case ApiKey::Metadata:
+    respond(socket, header.correlationId, handleMetadata(reader, header.apiVersion),
+            isFlexibleVersion(header.apiKey, header.apiVersion));
+    return true;
+  case ApiKey::ListOffsets:
+    respond(socket, header.correlationId, handleListOffsets(reader, header.apiVersion));
+    return true;
+  case ApiKey::ListGroups:
+    respond(socket, header.correlationId, handleListGroups(reader, header.apiVersion));
+    return true;
+  case ApiKey::OffsetFetch:
+    respond(socket, header.correlationId, handleOffsetFetch(reader, header.apiVersion),
+            isFlexibleVersion(header.apiKey, header.apiVersion));
+    return true;
+  case ApiKey::Produce:
+    respond(socket, header.correlationId, handleProduce(reader, header.apiVersion, injected));
+    return true;
+  case ApiKey::InitProducerId:
+    respond(socket, header.correlationId, handleInitProducerId(reader, header.apiVersion));
+    return true;
+  case ApiKey::Fetch: {
+    auto fetch = std::make_shared<ResolvedFetch>();
+    resolveFetch(reader, header.apiVersion, injected, fetch.get());
+    bool empty = false;
+    std::string body = answerFetch(*fetch, header.apiVersion, &empty);
+    if (!empty || fetch->request.maxWaitMs <= 0) {
+      respond(socket, header.correlationId, body);
+      return true;
+    }
+
+    // Hold the connection like a broker waiting for min_bytes, then answer
+    // with whatever has been appended in the meantime.
+    m_connections[socket].busy = true;
+    QPointer<QTcpSocket> guard(socket);
+    QTimer::singleShot(qMin(fetch->request.maxWaitMs, kMaxFetchWaitMs), this,
+                       [this, guard, fetch, header]() {
+                         const auto it = m_connections.find(guard.data());
+                         if (!guard || it == m_connections.end())
+                           return;
+                         it->busy = false;
+                         bool stillEmpty = false;
+                         respond(guard, header.correlationId,
+                                 answerFetch(*fetch, header.apiVersion, &stillEmpty));
+                         processFrames(guard);
+                       });
+    return false;
+  }
+  default:
+    // Unknown APIs close the connection, as a real broker does.
+    socket->abort();
+    return false;
+  }
+}
+
+void MockBroker::respond(QTcpSocket *socket, std::int32_t correlationId,
+                         const std::string &body, bool flexible) {
+  const std::string frame = encodeResponseFrame(correlationId, body, flexible);
+  socket->write(frame.data(), static_cast<qint64>(frame.size()));
+}
+
+std::string MockBroker::handleApiVersions() {
+  ApiVersionsResponse response;
+  for (const SupportedVersion &version : supportedVersions()) {
+    const auto key = static_cast<std::int16_t>(version.apiKey);
+    const std::int16_t maxVersion = std::min(
+        version.maxVersion, m_maxVersions.value(key, std::numeric_limits<std::int16_t>::max()));
+    response.apiKeys.push_back(ApiVersionRange{key, version.minVersion, maxVersion});
+  }
+  WireWriter writer;
+  response.encode(writer, 0);
+  return writer.take();
+}
+
+std::string MockBroker::handleMetadata(WireReader &reader, std::int16_t version) {
+  MetadataRequest request;
+  MetadataResponse response;
+  QVector<const MockBroker *> cluster = {this};
+  for (const MockBroker *peer : std::as_const(m_peers))
+    cluster.append(peer);
+  response.controllerId = m_nodeId;
+  for (const MockBroker *broker : std::as_const(cluster)) {
+    response.controllerId = std::min(response.controllerId, broker->m_nodeId);
+    response.brokers.push_back(
+        MetadataBroker{broker->m_nodeId, "127.0.0.1", broker->port(), std::string()});
+  }
+
+  // A topic is led by the broker holding its log.
+  auto describe = [](const MockBroker *holder, const QString &name) {
+    const qint32 leader = holder->m_nodeId;
+    const QVector<PartitionLog> logs = holder->m_topics.value(name);
+    const QByteArray topicId = holder->m_topicIds.value(name).toRfc4122();
+    MetadataTopic topic;
+    topic.name = name.toStdString();
+    topic.topicId = topicId.toStdString();
+    for (int i = 0; i < logs.size(); ++i)
+      topic.partitions.push_back(MetadataPartition{0, i, leader, {leader}, {leader}});
+    return topic;
+  };
+
+  if (request.decode(reader, version) && !request.allTopics) {
+    for (const std::string &name : request.topics) {
+      const QString topicName = QString::fromStdString(name);
+      const auto holder =
+          std::find_if(cluster.cbegin(), cluster.cend(), [&](const MockBroker *broker) {
+            return broker->m_topics.contains(topicName);
+          });
+      if (holder == cluster.cend()) {
+        MetadataTopic missing;
+        missing.errorCode = static_cast<std::int16_t>(ErrorCode::UnknownTopicOrPartition);
+        missing.name = name;
+        response.topics.push_back(missing);
+      } else {
+        response.topics.push_back(describe(*holder, topicName));
+      }
+    }
+  } else {
+    for (const MockBroker *broker : std::as_const(cluster)) {
+      for (auto it = broker->m_topics.cbegin(); it != broker->m_topics.cend(); ++it)
+        response.topics.push_back(describe(broker, it.key()));
+    }
+  }
+
+  WireWriter writer;
+  response.encode(writer, version);
+  return writer.take();
+}
+
+qint64 MockBroker::offsetForTimestamp(const PartitionLog &log, qint64 timestamp) const {
+  const auto batchIt = std::find_if(log.batches.begin(), log.batches.end(),
+                                    [timestamp](const StoredBatch &batch) {
+                                      return batch.maxTimestamp >= timestamp;
+                                    });
+  if (batchIt == log.batches.end())
+    return -1;
+
+  RecordBatch batch;
+  if (RecordBatch::parse(batchIt->bytes, batch) != ParseStatus::Ok)
+    return -1;
+  RecordReader records(batch, batch.recordsSection());
+  Record record;
+  while (records.next(record)) {
+    if (record.timestamp >= timestamp)
+      return record.offset;
+  }
+  return -1;
+}
+
+std::string MockBroker::handleListOffsets(WireReader &reader, std::int16_t version) {
+  ListOffsetsRequest request;
+  ListOffsetsResponse response;
+  if (request.decode(reader, version)) {
+    for (const ListOffsetsTopic &topic : request.topics) {
+      ListOffsetsTopicResponse topicResponse;
+      topicResponse.name = topic.name;
+      for (const ListOffsetsPartition &partition : topic.partitions) {
+        ListOffsetsPartitionResponse partitionResponse;
+        partitionResponse.partition = partition.partition;
+        const PartitionLog *log = partitionLog(topic.name, partition.partition);
+        if (!log) {
+          partitionResponse.errorCode =
+              static_cast<std::int16_t>(ErrorCode::UnknownTopicOrPartition);
+        } else if (partition.timestamp == kLatestTimestamp) {
+          partitionResponse.offset = log->nextOffset;
+        } else if (partition.timestamp == kEarliestTimestamp) {
+          partitionResponse.offset = 0;
+        } else {
+          partitionResponse.offset = offsetForTimestamp(*log, partition.timestamp);
+          partitionResponse.timestamp = partitionResponse.offset >= 0 ? partition.timestamp : -1;
+        }
+        topicResponse.partitions.push_back(partitionResponse);
+      }
+      response.topics.push_back(std::move(topicResponse));
+    }
+  }
+
+  WireWriter writer;
+  response.encode(writer, version);
+  return writer.take();
+}
+
+std::string MockBroker::handleListGroups(WireReader &reader, std::int16_t version) {
+  ListGroupsRequest request;
+  ListGroupsResponse response;
+  if (!request.decode(reader, version))
+    response.errorCode = static_cast<std::int16_t>(ErrorCode::UnsupportedVersion);
+  for (auto it = m_groups.cbegin(); it != m_groups.cend(); ++it)
+    response.groups.push_back(ListedGroup{it.key().toStdString(), "consumer"});
+
+  WireWriter writer;
+  response.encode(writer, version);
+  return writer.take();
+}
+
+std::string MockBroker::handleOffsetFetch(WireReader &reader, std::int16_t version) {
+  OffsetFetchRequest request;
+  OffsetFetchResponse response;
+  if (request.decode(reader, version)) {
+    for (const OffsetFetchGroup &group : request.groups) {
+      OffsetFetchGroupResponse groupResponse;
+      groupResponse.groupId = group.groupId;
+      const auto groupIt = m_groups.constFind(QString::fromStdString(group.groupId));
+      auto partitionFor = [&groupResponse](const std::string &topic) {
+        if (groupResponse.topics.empty() || groupResponse.topics.back().name != topic)
+          groupResponse.topics.push_back(OffsetFetchTopicResponse{topic, {}});
+        return &groupResponse.topics.back().partitions;
+      };
+
+      if (group.allTopics) {
+        if (groupIt != m_groups.cend()) {
+          for (const auto &committed : groupIt->offsets) {
+            OffsetFetchPartitionResponse partition;
+            partition.partition = committed.first.second;
+            partition.committedOffset = committed.second;
+            partitionFor(committed.first.first)->push_back(partition);
+          }
+        }
+      } else {
+        for (const OffsetFetchTopic &topic : group.topics) {
+          for (std::int32_t partitionIndex : topic.partitions) {
+            OffsetFetchPartitionResponse partition;
+            partition.partition = partitionIndex;
+            if (groupIt != m_groups.cend()) {
+              const auto committed = groupIt->offsets.find({topic.name, partitionIndex});
+              if (committed != groupIt->offsets.end())
+                partition.committedOffset = committed->second;
+            }
+            partitionFor(topic.name)->push_back(partition);
+          }
+        }
+      }
+      response.groups.push_back(std::move(groupResponse));
+    }
+  }
+
+  WireWriter writer;
+  response.encode(writer, version);
+  return writer.take();
+}
+
+void MockBroker::resolveFetch(WireReader &reader, std::int16_t version, ErrorCode injected,
+                              ResolvedFetch *fetch) {
+  FetchRequest &request = fetch->request;
+  auto reject = [&](ErrorCode error) {
+    fetch->errorCode = static_cast<std::int16_t>(error);
+    request.topics.clear();
+    request.maxWaitMs = 0;
+  };
+  if (!request.decode(reader, version)) {
+    request = FetchRequest();
+    request.maxWaitMs = 0;
+    return;
+  }
+  if (injected != ErrorCode::None) {
+    if (injected == ErrorCode::FetchSessionIdNotFound)
+      m_fetchSessions.erase(request.sessionId);
+    reject(injected);
+    return;
+  }
+
+  if (request.sessionId == 0) {
+    if (request.sessionEpoch == kFinalFetchSessionEpoch)
+      return;
+    if (request.sessionEpoch != kInitialFetchSessionEpoch) {
+      reject(ErrorCode::InvalidFetchSessionEpoch);
+      return;
+    }
+    // A full cache answers in full without a session, as brokers do.
+    if (m_fetchSessions.size() >= kMaxFetchSessions)
+      return;
+    fetch->sessionId = m_nextFetchSessionId++;
+    FetchSessionCache &session = m_fetchSessions[fetch->sessionId];
+    for (const FetchTopic &topic : request.topics) {
+      for (const FetchPartition &partition : topic.partitions)
+        session.partitions[{topic.name, partition.partition}] =
+            CachedFetchPartition{partition.fetchOffset, partition.maxBytes};
+    }
+    return;
+  }
+
+  const auto it = m_fetchSessions.find(request.sessionId);
+  if (it == m_fetchSessions.end()) {
+    reject(ErrorCode::FetchSessionIdNotFound);
+    return;
+  }
+  if (request.sessionEpoch == kFinalFetchSessionEpoch) {
+    m_fetchSessions.erase(it);
+    return;
+  }
+  FetchSessionCache &session = it->second;
+  if (request.sessionEpoch != session.nextEpoch) {
+    reject(ErrorCode::InvalidFetchSessionEpoch);
+    return;
+  }
+  session.nextEpoch = session.nextEpoch == std::numeric_limits<std::int32_t>::max()
+                          ? 1
+                          : session.nextEpoch + 1;
+  for (const FetchForgottenTopic &topic : request.forgottenTopics) {
+    for (std::int32_t partition : topic.partitions)
+      session.partitions.erase({topic.name, partition});
+  }
+  for (const FetchTopic &topic : request.topics) {
+    for (const FetchPartition &partition : topic.partitions) {
+      session.partitions[{topic.name, partition.partition}] =
+          CachedFetchPartition{partition.fetchOffset, partition.maxBytes};
+      fetch->named.insert({topic.name, partition.partition});
+    }
+  }
+
+  fetch->sessionId = request.sessionId;
+  fetch->incremental = true;
+  request.topics.clear();
+  for (const auto &[key, cached] : session.partitions) {
+    if (request.topics.empty() || request.topics.back().name != key.first)
+      request.topics.push_back(FetchTopic{key.first, {}});
+    request.topics.back().partitions.push_back(
+        FetchPartition{key.second, cached.fetchOffset, -1, cached.maxBytes});
+  }
+}
+
+std::string MockBroker::answerFetch(const ResolvedFetch &fetch, std::int16_t version,
+                                    bool *empty) const {
+  const FetchRequest &request = fetch.request;
+  FetchResponse response;
+  response.errorCode = fetch.errorCode;
+  response.sessionId = fetch.sessionId;
+  *empty = fetch.errorCode == 0;
+
+  std::size_t responseBytes = 0;
+  // Record views in the response point into this; deque keeps them stable.
+  std::deque<std::string> recordStorage;
+  for (const FetchTopic &topic : request.topics) {
+    FetchTopicResponse topicResponse;
+    topicResponse.name = topic.name;
+    for (const FetchPartition &partition : topic.partitions) {
+      const bool named =
+          !fetch.incremental || fetch.named.count({topic.name, partition.partition}) > 0;
+      FetchPartitionResponse partitionResponse;
+      partitionResponse.partition = partition.partition;
+      const PartitionLog *log = partitionLog(topic.name, partition.partition);
+      if (!log) {
+        partitionResponse.errorCode =
+            static_cast<std::int16_t>(ErrorCode::UnknownTopicOrPartition);
+        topicResponse.partitions.push_back(partitionResponse);
+        continue;
+      }
+
+      partitionResponse.highWatermark = log->nextOffset;
+      partitionResponse.lastStableOffset = log->nextOffset;
+      partitionResponse.logStartOffset = log->batches.empty() ? log->nextOffset
+                                                              : log->batches.front().baseOffset;
+      if (partition.fetchOffset < 0 || partition.fetchOffset > log->nextOffset) {
+        partitionResponse.errorCode = static_cast<std::int16_t>(ErrorCode::OffsetOutOfRange);
+        topicResponse.partitions.push_back(partitionResponse);
+        *empty = false;
+        continue;
+      }
+
+      auto batchIt = std::lower_bound(log->batches.begin(), log->batches.end(),
+                                      partition.fetchOffset,
+                                      [](const StoredBatch &batch, qint64 offset) {
+                                        return batch.lastOffset < offset;
+                                      });
+      std::string &records = recordStorage.emplace_back();
+      for (; batchIt != log->batches.end(); ++batchIt) {
+        const std::size_t size = batchIt->bytes.size();
+        if (!records.empty() &&
+            (records.size() + size > static_cast<std::size_t>(partition.maxBytes) ||
+             responseBytes + size > static_cast<std::size_t>(request.maxBytes)))
+          break;
+        records += batchIt->bytes;
+        responseBytes += size;
+      }
+      partitionResponse.records = records;
+      if (!records.empty())
+        *empty = false;
+      if (named || !records.empty())
+        topicResponse.partitions.push_back(partitionResponse);
+    }
+    if (!topicResponse.partitions.empty() || !fetch.incremental)
+      response.topics.push_back(std::move(topicResponse));
+  }
+
+  WireWriter writer;
+  response.encode(writer, version);
+  return writer.take();
+}
+
+std::string MockBroker::handleProduce(WireReader &reader, std::int16_t version,
+                                      ErrorCode injected) {
+  ProduceRequest request;
+  ProduceResponse response;
+  if (request.decode(reader, version)) {
+    for (const ProduceTopic &topic : request.topics) {
+      ProduceTopicResponse topicResponse;
+      topicResponse.name = topic.name;
+      for (const ProducePartition &partition : topic.partitions) {
+        ProducePartitionResponse partitionResponse;
+        partitionResponse.partition = partition.partition;
+        partitionResponse.logStartOffset = 0;
+        PartitionLog *log = partitionLog(QString::fromStdString(topic.name), partition.partition);
+        if (injected != ErrorCode::None) {
+          partitionResponse.errorCode = static_cast<std::int16_t>(injected);
+        } else if (!log) {
+          partitionResponse.errorCode =
+              static_cast<std::int16_t>(ErrorCode::UnknownTopicOrPartition);
+        } else {
+          partitionResponse.errorCode =
+              appendProduced(log, partition.records, &partitionResponse.baseOffset);
+        }
+        topicResponse.partitions.push_back(partitionResponse);
+      }
+      response.topics.push_back(std::move(topicResponse));
+    }
+  }
+
+  WireWriter writer;
+  response.encode(writer, version);
+  return writer.take();
+}
+
+std::int16_t MockBroker::appendProduced(PartitionLog *log, std::string_view records,
+                                        qint64 *baseOffset) {
+  // Validate everything first so a bad batch leaves the partition untouched.
+  std::vector<RecordBatch> batches;
+  BatchReader reader(records);
+  RecordBatch batch;
+  while (reader.next(batch) == ParseStatus::Ok) {
+    if (!batch.hasValidCrc() || batch.recordCount() <= 0)
+      return static_cast<std::int16_t>(ErrorCode::CorruptMessage);
+    batches.push_back(batch);
+  }
+  if (batches.empty() || reader.position() != records.size())
+    return static_cast<std::int16_t>(ErrorCode::CorruptMessage);
+
+  *baseOffset = -1;
+  for (const RecordBatch &produced : batches) {
+    ProducerState *producer = nullptr;
+    if (produced.producerId() >= 0) {
+      producer = &log->producers[produced.producerId()];
+      if (produced.producerEpoch() < producer->epoch)
+        return static_cast<std::int16_t>(ErrorCode::InvalidProducerEpoch);
+      if (produced.producerEpoch() > producer->epoch) {
+        producer->epoch = produced.producerEpoch();
+        producer->nextSequence = 0;
+        producer->recentBatches.clear();
+      }
+      // A retry of a batch that was already written is answered with the
+      // offset it got the first time.
+      const auto duplicate =
+          std::find_if(producer->recentBatches.begin(), producer->recentBatches.end(),
+                       [&](const std::pair<std::int32_t, qint64> &recent) {
+                         return recent.first == produced.baseSequence();
+                       });
+      if (duplicate != producer->recentBatches.end()) {
+        if (*baseOffset < 0)
+          *baseOffset = duplicate->second;
+        continue;
+      }
+      if (produced.baseSequence() != producer->nextSequence)
+        return static_cast<std::int16_t>(ErrorCode::OutOfOrderSequenceNumber);
+    }
+
+    StoredBatch stored;
+    stored.baseOffset = log->nextOffset;
+    stored.lastOffset = log->nextOffset + produced.recordCount() - 1;
+    stored.maxTimestamp = produced.maxTimestamp();
+    stored.bytes = std::string(produced.bytes());
+    // Base offset and leader epoch are outside the CRC; the broker owns both.
+    qToBigEndian<qint64>(stored.baseOffset, &stored.bytes[0]);
+    qToBigEndian<qint32>(0, &stored.bytes[12]);
+
+    if (producer) {
+      producer->nextSequence = produced.baseSequence() + produced.recordCount();
+      producer->recentBatches.emplace_back(produced.baseSequence(), stored.baseOffset);
+      if (producer->recentBatches.size() > kRecentProducerBatches)
+        producer->recentBatches.pop_front();
+    }
+    if (*baseOffset < 0)
+      *baseOffset = stored.baseOffset;
+    log->nextOffset = stored.lastOffset + 1;
+    log->batches.push_back(std::move(stored));
+  }
+  return static_cast<std::int16_t>(ErrorCode::None);
+}
+
+std::string MockBroker::handleInitProducerId(WireReader &reader, std::int16_t version) {
+  InitProducerIdRequest request;
+  InitProducerIdResponse response;
+  if (!request.decode(reader, version)) {
+    response.errorCode = static_cast<std::int16_t>(ErrorCode::UnsupportedVersion);
+  } else {
+    response.producerId = m_nextProducerId++;
+    response.producerEpoch = 0;
+  }
+
+  WireWriter writer;
+  response.encode(writer, version);
+  return writer.take();
+}
+
+} // namespace kafka
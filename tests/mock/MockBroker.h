@@ -0,0 +1,212 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QUuid>
+#include <QVector>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "core/protocol/ApiKeys.h"
+#include "core/protocol/RecordBatch.h"
+
+class QTcpServer;
+class QTcpSocket;
+
+namespace kafka {
+
+struct RequestHeader;
+
+/**
+ * @brief In-process Kafka broker for tests.
+ *
+ * Listens on 127.0.0.1 and answers the requests KafkaClient sends from
+ * an in-memory log, so the whole client stack can be exercised on a
+ * machine without network access. Built into the test-only
+ * kafka-viewer-mock library, not the application. On its own it is a
+ * single-node cluster; setPeers() joins brokers into a larger one.
+ * Produce appends the batches as sent, assigning offsets, and checks
+ * idempotent producers' sequence numbers per partition the way a broker
+ * does. Fetch keeps incremental fetch sessions (KIP-227), so their
+ * savings show in requestBytes(). Like a real broker it processes one
+ * request at a time per connection and answers them in order; an empty
+ * Fetch is held back for up to the request's max wait time before it is
+ * answered.
+ *
+ * Not thread-safe: create it, feed it and destroy it on one thread (any
+ * thread with an event loop, including the GUI thread).
+ */
+class MockBroker final : public QObject {
+  Q_OBJECT
+
+public:
+  explicit MockBroker(QObject *parent = nullptr);
+  ~MockBroker() override;
+
+  /**
+   * @brief Starts listening; @p port 0 picks a free port.
+   */
+  bool listen(quint16 port = 0);
+  quint16 port() const;
+  /**
+   * @brief "127.0.0.1:<port>", ready for KafkaClient::setBootstrapServers().
+   */
+  QString bootstrapServer() const;
+
+  qint32 nodeId() const { return m_nodeId; }
+  void setNodeId(qint32 nodeId) { m_nodeId = nodeId; }
+  /**
+   * @brief Forms a cluster with @p peers, which must live on this thread:
+   * Metadata lists every broker and each topic with the broker holding it
+   * as leader. Groups stay with the broker they were committed on, which
+   * acts as their coordinator.
+   */
+  void setPeers(const QVector<MockBroker *> &peers) { m_peers = peers; }
+
+  /** Creates @p topic under a new topic id; does nothing if it exists. */
+  void createTopic(const QString &topic, int partitionCount);
+  /** Drops @p topic with its log, so it can be created again. */
+  void deleteTopic(const QString &topic);
+  /**
+   * @brief Appends @p records as one batch and returns its base offset, or
+   * -1 when the partition does not exist.
+   */
+  qint64 append(const QString &topic, int partition, const std::vector<RecordData> &records);
+  qint64 endOffset(const QString &topic, int partition) const;
+
+  /**
+   * @brief Records @p offset as committed by consumer group @p group,
+   * creating the group on first use.
+   */
+  void commitOffset(const QString &group, const QString &topic, int partition, qint64 offset);
+  void deleteGroup(const QString &group) { m_groups.remove(group); }
+
+  /**
+   * @brief Advertises at most @p maxVersion of @p key in ApiVersions, like
+   * an older broker would.
+   */
+  void setMaxVersion(ApiKey key, std::int16_t maxVersion);
+
+  /**
+   * @brief Fails the request for @p key that arrives after @p skip more of
+   * them with @p error. A failed Produce appends nothing and reports the
+   * error for each of its partitions; a failed Fetch answers with the
+   * error and no partitions, and FETCH_SESSION_ID_NOT_FOUND also evicts
+   * the request's fetch session.
+   */
+  void injectError(ApiKey key, ErrorCode error, int skip = 0);
+
+  /** Requests received so far for @p key, for assertions and benchmarks. */
+  int requestCount(ApiKey key) const { return m_requestCounts.value(static_cast<qint16>(key)); }
+  /** Request bytes (frames including headers) received for @p key. */
+  qint64 requestBytes(ApiKey key) const { return m_requestBytes.value(static_cast<qint16>(key)); }
+
+private slots:
+  void onNewConnection();
+
+private:
+  struct StoredBatch {
+    qint64 baseOffset = 0;
+    qint64 lastOffset = 0;
+    qint64 maxTimestamp = 0;
+    std::string bytes;
+  };
+
+  // Batches an idempotent producer recently appended to a partition, so a
+  // retried batch is recognised instead of written twice.
+  struct ProducerState {
+    std::int16_t epoch = -1;
+    std::int32_t nextSequence = 0;
+    std::deque<std::pair<std::int32_t, qint64>> recentBatches; // base sequence, base offset
+  };
+
+  struct PartitionLog {
+    std::vector<StoredBatch> batches;
+    qint64 nextOffset = 0;
+    std::map<qint64, ProducerState> producers;
+  };
+
+  struct GroupLog {
+    // Ordered so OffsetFetch answers list each topic's partitions together.
+    std::map<std::pair<std::string, std::int32_t>, qint64> offsets;
+  };
+
+  struct Connection {
+    QByteArray buffer;
+    bool busy = false;
+  };
+
+  struct CachedFetchPartition {
+    qint64 fetchOffset = 0;
+    std::int32_t maxBytes = 0;
+  };
+
+  // An incremental fetch session: what the client last said about each of
+  // its partitions, ordered so responses list each topic's partitions
+  // together.
+  struct FetchSessionCache {
+    std::int32_t nextEpoch = 1;
+    std::map<std::pair<std::string, std::int32_t>, CachedFetchPartition> partitions;
+  };
+
+  struct ResolvedFetch;
+
+  void onReadyRead(QTcpSocket *socket);
+  void processFrames(QTcpSocket *socket);
+  /**
+   * @brief Handles one request. Returns false when the response is
+   * deferred; the socket is then resumed from a timer.
+   */
+  bool handleRequest(QTcpSocket *socket, const QByteArray &frame);
+  void respond(QTcpSocket *socket, std::int32_t correlationId, const std::string &body,
+               bool flexible = false);
+
+  std::string handleApiVersions();
+  std::string handleMetadata(WireReader &reader, std::int16_t version);
+  std::string handleListOffsets(WireReader &reader, std::int16_t version);
+  std::string handleListGroups(WireReader &reader, std::int16_t version);
+  std::string handleOffsetFetch(WireReader &reader, std::int16_t version);
+  /**
+   * @brief Decodes a Fetch and applies it to its session, once; the result
+   * can be answered any number of times while the request waits for data.
+   */
+  void resolveFetch(WireReader &reader, std::int16_t version, ErrorCode injected,
+                    ResolvedFetch *fetch);
+  std::string answerFetch(const ResolvedFetch &fetch, std::int16_t version, bool *empty) const;
+  std::string handleProduce(WireReader &reader, std::int16_t version, ErrorCode injected);
+  std::string handleInitProducerId(WireReader &reader, std::int16_t version);
+  /**
+   * @brief Appends the batches of one Produce partition; returns the error
+   * code and sets @p baseOffset to the first batch's offset.
+   */
+  std::int16_t appendProduced(PartitionLog *log, std::string_view records, qint64 *baseOffset);
+
+  const PartitionLog *partitionLog(const std::string &topic, std::int32_t partition) const;
+  PartitionLog *partitionLog(const QString &topic, std::int32_t partition);
+  qint64 offsetForTimestamp(const PartitionLog &log, qint64 timestamp) const;
+
+  QTcpServer *m_server = nullptr;
+  qint32 m_nodeId = 0;
+  QVector<MockBroker *> m_peers;
+  QHash<QString, QVector<PartitionLog>> m_topics;
+  QHash<QString, QUuid> m_topicIds;
+  QHash<QString, GroupLog> m_groups;
+  QHash<QTcpSocket *, Connection> m_connections;
+  QHash<qint16, int> m_requestCounts;
+  QHash<qint16, qint64> m_requestBytes;
+  QHash<qint16, std::int16_t> m_maxVersions;
+  // Keyed by API key and the count of that key's request to fail.
+  std::map<std::pair<qint16, int>, ErrorCode> m_injectedErrors;
+  qint64 m_nextProducerId = 1000;
+  std::map<std::int32_t, FetchSessionCache> m_fetchSessions;
+  std::int32_t m_nextFetchSessionId = 1;
+};
+
+} // namespace kafka
@@ -0,0 +1,48 @@
+#include "mock/MockCluster.h"
+
+#include "mock/MockBroker.h"
+
+namespace kafka {
+
+MockCluster::MockCluster(int brokerCount) : m_context(new QObject) {
+  m_thread.setObjectName(QStringLiteral("mock-cluster"));
+  m_context->moveToThread(&m_thread);
+  QObject::connect(&m_thread, &QThread::finished, m_context, &QObject::deleteLater);
+  m_thread.start();
+
+  QMetaObject::invokeMethod(
+      m_context,
+      [this, brokerCount]() {
+        for (int i = 0; i < brokerCount; ++i) {
+          auto *broker = new MockBroker(m_context);
+          broker->setNodeId(i);
+          if (!broker->listen()) {
+            delete broker;
+            break;
+          }
+          m_brokers.append(broker);
+          m_bootstrapServers.append(broker->bootstrapServer());
+        }
+        for (MockBroker *broker : std::as_const(m_brokers)) {
+          QVector<MockBroker *> peers = m_brokers;
+          peers.removeOne(broker);
+          broker->setPeers(peers);
+        }
+      },
+      Qt::BlockingQueuedConnection);
+}
+
+MockCluster::~MockCluster() {
+  QMetaObject::invokeMethod(
+      m_context, [this]() { qDeleteAll(m_brokers); }, Qt::BlockingQueuedConnection);
+  m_thread.quit();
+  m_thread.wait();
+}
+
+void MockCluster::run(const std::function<void(MockBroker &broker)> &task, int index) {
+  QMetaObject::invokeMethod(
+      m_context, [this, &task, index]() { task(*m_brokers.at(index)); },
+      Qt::BlockingQueuedConnection);
+}
+
+} // namespace kafka
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+
+#include <functional>
+
+namespace kafka {
+
+class MockBroker;
+
+/**
+ * @brief MockBrokers answering from a thread of their own.
+ *
+ * Tests drive the client through its blocking API from the test thread,
+ * which would starve brokers living there. The brokers, with node ids
+ * 0 to brokerCount - 1, are created, fed and destroyed on the cluster's
+ * thread; reach them through run().
+ */
+class MockCluster final {
+public:
+  explicit MockCluster(int brokerCount = 1);
+  ~MockCluster();
+
+  MockCluster(const MockCluster &) = delete;
+  MockCluster &operator=(const MockCluster &) = delete;
+
+  int size() const { return m_bootstrapServers.size(); }
+  QStringList bootstrapServers() const { return m_bootstrapServers; }
+
+  /**
+   * @brief Runs @p task with broker @p index on the brokers' thread and
+   * returns once it is done.
+   */
+  void run(const std::function<void(MockBroker &broker)> &task, int index = 0);
+
+private:
+  QThread m_thread;
+  QObject *m_context = nullptr;
+  QVector<MockBroker *> m_brokers;
+  QStringList m_bootstrapServers;
+};
+
+} // namespace kafka
@@ -0,0 +1,185 @@
+#include <QDirIterator>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "core/cache/BatchCache.h"
+#include "core/protocol/RecordBatch.h"
+#include "core/source/BatchSource.h"
+
+using namespace kafka;
+
+namespace {
+
+constexpr qint32 kPartition = 2;
+constexpr int kRecordsPerBatch = 2;
+// What the file adds to the batches it holds.
+constexpr qint64 kHeaderSize = 32;
+
+const QString kKey = QStringLiteral("kafka:127.0.0.1:9092/orders");
+
+// @p count batches back to back, the first at @p baseOffset. Batches of
+// the same count are the same size wherever they start.
+std::string batches(qint64 baseOffset, int count) {
+  std::string bytes;
+  for (int i = 0; i < count; ++i) {
+    RecordBatchBuilder builder(baseOffset + i * kRecordsPerBatch);
+    for (int j = 0; j < kRecordsPerBatch; ++j) {
+      RecordData record;
+      record.timestamp = 1700000000000;
+      record.value = "value";
+      builder.append(record);
+    }
+    bytes += builder.build();
+  }
+  return bytes;
+}
+
+BatchChunk chunkOf(const std::string &bytes) {
+  BatchChunk chunk;
+  chunk.bytes = bytes;
+  return chunk;
+}
+
+// The bytes a read at @p offset hands out; empty on a miss.
+std::string readAt(BatchCache &cache, qint64 offset, qint32 partition = kPartition,
+                   const QString &key = kKey) {
+  BatchChunk chunk;
+  if (!cache.read(key, partition, offset, &chunk))
+    return std::string();
+  return std::string(chunk.bytes);
+}
+
+QStringList cacheFiles(const QString &root) {
+  QStringList files;
+  QDirIterator it(root, {QStringLiteral("*.batches")}, QDir::Files, QDirIterator::Subdirectories);
+  while (it.hasNext())
+    files.append(it.next());
+  return files;
+}
+
+} // namespace
+
+class BatchCacheTest : public QObject {
+  Q_OBJECT
+
+private slots:
+  void init();
+  void cleanup();
+
+  void roundTrip();
+  void evictsLeastRecentlyRead();
+  void corruptFile_data();
+  void corruptFile();
+
+private:
+  std::unique_ptr<QTemporaryDir> m_directory;
+};
+
+void BatchCacheTest::init() {
+  m_directory = std::make_unique<QTemporaryDir>();
+  QVERIFY(m_directory->isValid());
+}
+
+void BatchCacheTest::cleanup() { m_directory.reset(); }
+
+void BatchCacheTest::roundTrip() {
+  const std::string stored = batches(10, 3);
+  const std::size_t batchSize = stored.size() / 3;
+  {
+    BatchCache cache(m_directory->path(), BatchCache::kDefaultBudget);
+    cache.store(kKey, kPartition, 10, chunkOf(stored));
+    QCOMPARE(cache.size(), kHeaderSize + qint64(stored.size()));
+
+    QCOMPARE(readAt(cache, 10), stored);
+    // From the batch holding the offset on.
+    QCOMPARE(readAt(cache, 13), stored.substr(batchSize));
+    QCOMPARE(readAt(cache, 15), stored.substr(2 * batchSize));
+    QVERIFY(readAt(cache, 9).empty());
+    QVERIFY(readAt(cache, 16).empty());
+    QVERIFY(readAt(cache, 10, kPartition + 1).empty());
+    QVERIFY(readAt(cache, 10, kPartition, kKey + QStringLiteral("/other")).empty());
+  }
+
+  // A later run finds the file by scanning the directory.
+  BatchCache cache(m_directory->path(), BatchCache::kDefaultBudget);
+  QCOMPARE(readAt(cache, 12), stored.substr(batchSize));
+  QCOMPARE(cacheFiles(m_directory->path()).size(), 1);
+}
+
+// The budget holds four files; the fifth pushes out the one read least
+// recently, not the one stored first.
+void BatchCacheTest::evictsLeastRecentlyRead() {
+  const qint64 fileSize = kHeaderSize + qint64(batches(0, 1).size());
+  BatchCache cache(m_directory->path(), 4 * fileSize);
+  for (int i = 0; i < 4; ++i) {
+    const qint64 offset = i * kRecordsPerBatch;
+    cache.store(kKey, kPartition, offset, chunkOf(batches(offset, 1)));
+  }
+  QCOMPARE(cache.size(), 4 * fileSize);
+  QVERIFY(!readAt(cache, 0).empty());
+
+  cache.store(kKey, kPartition, 8, chunkOf(batches(8, 1)));
+  QCOMPARE(cache.size(), 4 * fileSize);
+  QCOMPARE(cacheFiles(m_directory->path()).size(), 4);
+  QVERIFY(readAt(cache, 2).empty());
+  for (qint64 offset : {0, 4, 6, 8})
+    QVERIFY2(!readAt(cache, offset).empty(), qPrintable(QString::number(offset)));
+
+  // Just read in that order, so 0 goes next.
+  cache.store(kKey, kPartition, 10, chunkOf(batches(10, 1)));
+  QVERIFY(readAt(cache, 0).empty());
+  QVERIFY(!readAt(cache, 4).empty());
+}
+
+void BatchCacheTest::corruptFile_data() {
+  QTest::addColumn<int>("position");
+
+  // Bytes of the header to flip; -1 cuts off the last byte instead.
+  QTest::newRow("magic") << 0;
+  QTest::newRow("version") << 4;
+  QTest::newRow("first offset") << 8;
+  QTest::newRow("next offset") << 16;
+  QTest::newRow("body size") << 24;
+  QTest::newRow("truncated") << -1;
+}
+
+// A file that does not match its name is a miss and goes away.
+void BatchCacheTest::corruptFile() {
+  QFETCH(int, position);
+
+  const std::string stored = batches(0, 2);
+  BatchCache(m_directory->path(), BatchCache::kDefaultBudget)
+      .store(kKey, kPartition, 0, chunkOf(stored));
+  const QStringList files = cacheFiles(m_directory->path());
+  QCOMPARE(files.size(), 1);
+
+  QFile file(files.first());
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  QByteArray bytes = file.readAll();
+  file.close();
+  QCOMPARE(bytes.size(), int(kHeaderSize) + int(stored.size()));
+  if (position < 0)
+    bytes.chop(1);
+  else
+    bytes[position] = static_cast<char>(bytes[position] ^ 0x40);
+  QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+  QCOMPARE(file.write(bytes), qint64(bytes.size()));
+  file.close();
+
+  BatchCache cache(m_directory->path(), BatchCache::kDefaultBudget);
+  QVERIFY(readAt(cache, 0).empty());
+  QVERIFY(!QFile::exists(files.first()));
+  QCOMPARE(cache.size(), qint64(0));
+
+  // Stored again, it reads back.
+  cache.store(kKey, kPartition, 0, chunkOf(stored));
+  QCOMPARE(readAt(cache, 0), stored);
+}
+
+QTEST_APPLESS_MAIN(BatchCacheTest)
+#include "tst_batchcache.moc"
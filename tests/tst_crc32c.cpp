@@ -0,0 +1,153 @@
+#include <QtTest>
+
+#include <cstdint>
+#include <string>
+
+#include "core/checksum/Crc32c.h"
+
+using namespace kafka;
+
+namespace {
+
+using Implementation = Crc32c::Implementation;
+
+constexpr Implementation kImplementations[] = {
+    Implementation::Portable,
+    Implementation::Sse42,
+    Implementation::Sse42Clmul,
+};
+
+// The SCSI Read (10) command PDU of RFC 3720, B.4.
+const unsigned char kReadCommand[48] = {
+    0x01, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00,
+    0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x18, 0x28, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+QByteArray counting(int size, bool up) {
+  QByteArray bytes(size, '\0');
+  for (int i = 0; i < size; ++i)
+    bytes[i] = static_cast<char>(up ? i : size - 1 - i);
+  return bytes;
+}
+
+// Not periodic, so a lane merged at the wrong distance changes the result.
+QByteArray noise(int size) {
+  QByteArray bytes(size, '\0');
+  quint32 state = 0x9e3779b9u;
+  for (int i = 0; i < size; ++i) {
+    state = state * 1664525u + 1013904223u;
+    bytes[i] = static_cast<char>(state >> 24);
+  }
+  return bytes;
+}
+
+QByteArray rowName(Implementation implementation, const char *what) {
+  return QByteArray(Crc32c::implementationName(implementation)) + ": " + what;
+}
+
+} // namespace
+
+/**
+ * Every implementation against the published vectors, whichever one the
+ * machine dispatches to, and the SIMD paths against the portable one
+ * around the lengths where they change lane width.
+ */
+class Crc32cTest : public QObject {
+  Q_OBJECT
+
+private slots:
+  void rfc3720_data();
+  void rfc3720();
+  void matchesPortable_data();
+  void matchesPortable();
+  void dispatch();
+};
+
+void Crc32cTest::rfc3720_data() {
+  QTest::addColumn<int>("implementation");
+  QTest::addColumn<QByteArray>("input");
+  QTest::addColumn<quint32>("expected");
+
+  for (Implementation implementation : kImplementations) {
+    const int id = static_cast<int>(implementation);
+    QTest::newRow(rowName(implementation, "32 zeros").constData())
+        << id << QByteArray(32, '\0') << quint32(0x8a9136aa);
+    QTest::newRow(rowName(implementation, "32 ones").constData())
+        << id << QByteArray(32, '\xff') << quint32(0x62a8ab43);
+    QTest::newRow(rowName(implementation, "incrementing").constData())
+        << id << counting(32, true) << quint32(0x46dd794e);
+    QTest::newRow(rowName(implementation, "decrementing").constData())
+        << id << counting(32, false) << quint32(0x113fdb5c);
+    QTest::newRow(rowName(implementation, "read command").constData())
+        << id << QByteArray(reinterpret_cast<const char *>(kReadCommand), sizeof(kReadCommand))
+        << quint32(0xd9963a56);
+    QTest::newRow(rowName(implementation, "123456789").constData())
+        << id << QByteArray("123456789") << quint32(0xe3069283);
+    QTest::newRow(rowName(implementation, "empty").constData())
+        << id << QByteArray() << quint32(0);
+  }
+}
+
+void Crc32cTest::rfc3720() {
+  QFETCH(int, implementation);
+  QFETCH(QByteArray, input);
+  QFETCH(quint32, expected);
+
+  const auto candidate = static_cast<Implementation>(implementation);
+  if (!Crc32c::isSupported(candidate))
+    QSKIP("Not supported by this CPU");
+  QCOMPARE(Crc32c::extendWith(candidate, 0, input.constData(),
+                              static_cast<std::size_t>(input.size())),
+           expected);
+}
+
+void Crc32cTest::matchesPortable_data() {
+  QTest::addColumn<int>("implementation");
+  QTest::addColumn<int>("size");
+
+  // Three 256-byte and three 8 KiB lanes are where the interleaved path
+  // takes over; either side of both, plus a length that uses all three.
+  const int sizes[] = {7, 767, 768, 769, 3 * 8192 - 1, 3 * 8192, 3 * 8192 + 3 * 256 + 5, 100003};
+  for (Implementation implementation : {Implementation::Sse42, Implementation::Sse42Clmul}) {
+    for (int size : sizes) {
+      const QByteArray name = rowName(implementation, QByteArray::number(size).constData());
+      QTest::newRow(name.constData()) << static_cast<int>(implementation) << size;
+    }
+  }
+}
+
+void Crc32cTest::matchesPortable() {
+  QFETCH(int, implementation);
+  QFETCH(int, size);
+
+  const auto candidate = static_cast<Implementation>(implementation);
+  if (!Crc32c::isSupported(candidate))
+    QSKIP("Not supported by this CPU");
+  const QByteArray bytes = noise(size + 8);
+  const auto length = static_cast<std::size_t>(size);
+  // Every start alignment, since the SIMD paths first step to 8 bytes.
+  for (int misalign = 0; misalign < 8; ++misalign) {
+    const char *data = bytes.constData() + misalign;
+    const quint32 portable = Crc32c::extendWith(Implementation::Portable, 0, data, length);
+    QCOMPARE(Crc32c::extendWith(candidate, 0, data, length), portable);
+
+    const std::size_t half = length / 2;
+    const quint32 first = Crc32c::extendWith(candidate, 0, data, half);
+    QCOMPARE(Crc32c::extendWith(candidate, first, data + half, length - half), portable);
+  }
+}
+
+void Crc32cTest::dispatch() {
+  const Implementation detected = Crc32c::implementation();
+  QVERIFY(Crc32c::isSupported(detected));
+  const QByteArray bytes = noise(3 * 8192 + 11);
+  QCOMPARE(Crc32c::compute(bytes.constData(), static_cast<std::size_t>(bytes.size())),
+           Crc32c::extendWith(Implementation::Portable, 0, bytes.constData(),
+                              static_cast<std::size_t>(bytes.size())));
+  QCOMPARE(Crc32c::compute(std::string_view("123456789")), quint32(0xe3069283));
+}
+
+QTEST_APPLESS_MAIN(Crc32cTest)
+#include "tst_crc32c.moc"
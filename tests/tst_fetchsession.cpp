@@ -0,0 +1,203 @@
+#include <QtTest>
+
+#include <memory>
+#include <string>
+
+#include "core/network/FetchSession.h"
+#include "core/network/KafkaClient.h"
+#include "core/network/KafkaSession.h"
+#include "core/protocol/RecordBatch.h"
+#include "mock/MockBroker.h"
+#include "mock/MockCluster.h"
+
+using namespace kafka;
+
+namespace {
+
+constexpr int kPartitions = 2000;
+constexpr int kChangedPerRound = 40;
+// How long the broker holds an empty fetch in lateAnswerIsDropped().
+constexpr qint32 kHeldMs = 1000;
+
+} // namespace
+
+/**
+ * A reader following 2000 partitions of which 40 got records since its
+ * last fetch, the case incremental fetch sessions (KIP-227) exist for.
+ */
+class FetchSessionTest : public QObject {
+  Q_OBJECT
+
+private slots:
+  void init();
+  void cleanup();
+
+  void incrementalRequestsAreSmall();
+  void recoversFromLostSession_data();
+  void recoversFromLostSession();
+  void lateAnswerIsDropped();
+
+private:
+  struct Round {
+    int requests = 0;
+    qint64 bytes = 0;
+  };
+
+  // Appends a record to the next kChangedPerRound partitions, fetches
+  // through the session and moves the targets past what came back.
+  bool fetchRound(Round *round);
+
+  std::unique_ptr<MockCluster> m_cluster;
+  std::unique_ptr<KafkaSession> m_session;
+  std::shared_ptr<FetchSessions> m_sessions;
+  QVector<FetchTarget> m_targets;
+  int m_round = 0;
+};
+
+void FetchSessionTest::init() {
+  m_cluster = std::make_unique<MockCluster>();
+  m_cluster->run(
+      [](MockBroker &broker) { broker.createTopic(QStringLiteral("tail"), kPartitions); });
+  m_session = std::make_unique<KafkaSession>();
+  m_session->client()->setBootstrapServers(m_cluster->bootstrapServers());
+  // Empty fetches are answered at once instead of being held.
+  m_session->client()->setFetchMaxWaitMs(0);
+  m_sessions = std::make_shared<FetchSessions>();
+  m_targets.resize(kPartitions);
+  for (int i = 0; i < kPartitions; ++i)
+    m_targets[i] = FetchTarget{TopicPartition{QStringLiteral("tail"), i}, 0};
+  m_round = 0;
+}
+
+void FetchSessionTest::cleanup() {
+  m_session.reset();
+  m_cluster.reset();
+}
+
+bool FetchSessionTest::fetchRound(Round *round) {
+  const int first = m_round * kChangedPerRound % kPartitions;
+  int requestsBefore = 0;
+  qint64 bytesBefore = 0;
+  m_cluster->run([&](MockBroker &broker) {
+    const std::string value = "record-" + std::to_string(m_round);
+    for (int i = first; i < first + kChangedPerRound; ++i)
+      broker.append(QStringLiteral("tail"), i, {RecordData{m_round, {}, value, {}}});
+    requestsBefore = broker.requestCount(ApiKey::Fetch);
+    bytesBefore = broker.requestBytes(ApiKey::Fetch);
+  });
+  ++m_round;
+
+  QVector<FetchedPartition> fetched;
+  QString error;
+  if (!m_session->client()->fetchSessionBlocking(m_sessions, m_targets, &fetched, &error)) {
+    qWarning("%s", qPrintable(error));
+    return false;
+  }
+
+  int withRecords = 0;
+  for (const FetchedPartition &partition : std::as_const(fetched)) {
+    if (partition.errorCode != 0)
+      return false;
+    BatchReader batches(partition.records());
+    RecordBatch batch;
+    while (batches.next(batch) == ParseStatus::Ok) {
+      FetchTarget &target = m_targets[partition.tp.partition];
+      target.offset = qMax(target.offset, batch.nextOffset());
+      ++withRecords;
+    }
+  }
+  if (withRecords != kChangedPerRound)
+    return false;
+
+  m_cluster->run([&](MockBroker &broker) {
+    round->requests = broker.requestCount(ApiKey::Fetch) - requestsBefore;
+    round->bytes = broker.requestBytes(ApiKey::Fetch) - bytesBefore;
+  });
+  return true;
+}
+
+void FetchSessionTest::incrementalRequestsAreSmall() {
+  Round full;
+  QVERIFY(fetchRound(&full));
+  QCOMPARE(full.requests, 1);
+
+  for (int i = 0; i < 5; ++i) {
+    Round incremental;
+    QVERIFY(fetchRound(&incremental));
+    QCOMPARE(incremental.requests, 1);
+    QVERIFY2(incremental.bytes * 10 < full.bytes,
+             qPrintable(QStringLiteral("incremental %1 bytes, full %2 bytes")
+                            .arg(incremental.bytes)
+                            .arg(full.bytes)));
+  }
+}
+
+void FetchSessionTest::recoversFromLostSession_data() {
+  QTest::addColumn<int>("error");
+
+  QTest::newRow("invalid epoch") << int(ErrorCode::InvalidFetchSessionEpoch);
+  QTest::newRow("session evicted") << int(ErrorCode::FetchSessionIdNotFound);
+}
+
+// The broker refuses the next incremental request; the client starts a
+// new session with a full request in the same call, and the calls after
+// it are incremental again.
+void FetchSessionTest::recoversFromLostSession() {
+  QFETCH(int, error);
+
+  Round full;
+  QVERIFY(fetchRound(&full));
+  Round incremental;
+  QVERIFY(fetchRound(&incremental));
+  QVERIFY(incremental.bytes * 10 < full.bytes);
+
+  m_cluster->run([&](MockBroker &broker) {
+    broker.injectError(ApiKey::Fetch, static_cast<ErrorCode>(error));
+  });
+  Round recovered;
+  QVERIFY(fetchRound(&recovered));
+  QCOMPARE(recovered.requests, 2);
+  // The refused incremental request, then a full one.
+  QVERIFY(recovered.bytes > full.bytes);
+  QVERIFY(recovered.bytes < full.bytes + 2 * incremental.bytes);
+
+  for (int i = 0; i < 3; ++i) {
+    Round after;
+    QVERIFY(fetchRound(&after));
+    QCOMPARE(after.requests, 1);
+    QVERIFY(after.bytes * 10 < full.bytes);
+  }
+}
+
+// The broker holds an empty fetch past the caller's timeout and answers
+// it later. That answer must not move the session on behind the caller's
+// back: the next call starts over with a full request, and the ones after
+// it are incremental again.
+void FetchSessionTest::lateAnswerIsDropped() {
+  Round full;
+  QVERIFY(fetchRound(&full));
+
+  m_session->client()->setFetchMaxWaitMs(kHeldMs);
+  QVector<FetchedPartition> fetched;
+  QString error;
+  QVERIFY(!m_session->client()->fetchSessionBlocking(m_sessions, m_targets, &fetched, &error,
+                                                     /*timeoutMs=*/100));
+  QTest::qWait(kHeldMs + 500);
+  m_session->client()->setFetchMaxWaitMs(0);
+
+  Round restarted;
+  QVERIFY(fetchRound(&restarted));
+  QCOMPARE(restarted.requests, 1);
+  QVERIFY2(restarted.bytes * 2 > full.bytes,
+           qPrintable(QStringLiteral("restarted %1 bytes, full %2 bytes")
+                          .arg(restarted.bytes)
+                          .arg(full.bytes)));
+
+  Round after;
+  QVERIFY(fetchRound(&after));
+  QCOMPARE(after.requests, 1);
+  QVERIFY(after.bytes * 10 < full.bytes);
+}
+
+QTEST_GUILESS_MAIN(FetchSessionTest)
+#include "tst_fetchsession.moc"
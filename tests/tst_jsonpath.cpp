@@ -0,0 +1,153 @@
+#include <QtTest>
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "core/json/JsonPath.h"
+
+using namespace kafka;
+
+namespace {
+
+std::string_view viewOf(const QByteArray &bytes) {
+  return std::string_view(bytes.constData(), static_cast<std::size_t>(bytes.size()));
+}
+
+} // namespace
+
+class JsonPathTest : public QObject {
+  Q_OBJECT
+
+private slots:
+  void extract_data();
+  void extract();
+  void unescape_data();
+  void unescape();
+  void rejects_data();
+  void rejects();
+};
+
+void JsonPathTest::extract_data() {
+  QTest::addColumn<QString>("path");
+  QTest::addColumn<QByteArray>("document");
+  QTest::addColumn<int>("type");
+  QTest::addColumn<QByteArray>("raw");
+
+  // Everything before the value is skipped by bracket depth; brackets and
+  // quotes inside skipped strings must not count.
+  QTest::newRow("after nested containers")
+      << "$.b" << QByteArray(R"({"a":{"x":[1,{"y":[]}],"z":{}},"b":2})")
+      << int(JsonValue::Number) << QByteArray("2");
+  QTest::newRow("brackets in a skipped string")
+      << "$.b" << QByteArray(R"({"a":{"s":"]}[{"},"b":true})") << int(JsonValue::Boolean)
+      << QByteArray("true");
+  QTest::newRow("escaped quote in a skipped string")
+      << "$.b" << QByteArray(R"({"a":"x\"},\"b\":0","b":"y"})") << int(JsonValue::String)
+      << QByteArray(R"("y")");
+  QTest::newRow("escaped backslash before a quote")
+      << "$.b" << QByteArray(R"({"a":"\\","b":1})") << int(JsonValue::Number)
+      << QByteArray("1");
+  QTest::newRow("three backslashes before a quote")
+      << "$.b" << QByteArray(R"({"a":"\\\"","b":1})") << int(JsonValue::Number)
+      << QByteArray("1");
+  QTest::newRow("escaped member name")
+      << "$.ab" << QByteArray(R"({"a\"b":0,"ab":5})") << int(JsonValue::Number)
+      << QByteArray("5");
+  QTest::newRow("member name matched unescaped")
+      << "$.ab" << QByteArray(R"({"a\u0062":5})") << int(JsonValue::Number) << QByteArray("5");
+  QTest::newRow("quoted member") << "$['a b'].c" << QByteArray(R"({"a b":{"c":null}})")
+                                 << int(JsonValue::Null) << QByteArray("null");
+  QTest::newRow("index past nested elements")
+      << "$.items[2].id" << QByteArray(R"({"items":[{"id":1},[1,[2,[3]]],{"id":"x\"y"}]})")
+      << int(JsonValue::String) << QByteArray(R"("x\"y")");
+  QTest::newRow("whitespace") << "$.a[1]" << QByteArray("{ \"a\" :\n[ 1 ,\t-2.5e3 ] }")
+                              << int(JsonValue::Number) << QByteArray("-2.5e3");
+  QTest::newRow("object value, as written")
+      << "$.a" << QByteArray(R"({"a":{"x":"}","y":[{}]},"b":1})") << int(JsonValue::Object)
+      << QByteArray(R"({"x":"}","y":[{}]})");
+  QTest::newRow("root") << "$" << QByteArray(R"( [1,2] )") << int(JsonValue::Array)
+                        << QByteArray("[1,2]");
+
+  QTest::newRow("missing member") << "$.c" << QByteArray(R"({"a":1,"b":{"c":2}})")
+                                  << int(JsonValue::Missing) << QByteArray();
+  QTest::newRow("index out of range") << "$[3]" << QByteArray("[1,2,3]")
+                                      << int(JsonValue::Missing) << QByteArray();
+  QTest::newRow("member of an array") << "$.a" << QByteArray("[1]") << int(JsonValue::Missing)
+                                      << QByteArray();
+  QTest::newRow("empty object") << "$.a" << QByteArray("{}") << int(JsonValue::Missing)
+                                << QByteArray();
+  QTest::newRow("truncated before the value")
+      << "$.b" << QByteArray(R"({"a":{"x":"}")") << int(JsonValue::Missing) << QByteArray();
+  QTest::newRow("unterminated string value")
+      << "$.a" << QByteArray(R"({"a":"abc\")") << int(JsonValue::Missing) << QByteArray();
+  QTest::newRow("not JSON") << "$.a" << QByteArray("plain text") << int(JsonValue::Missing)
+                            << QByteArray();
+}
+
+void JsonPathTest::extract() {
+  QFETCH(QString, path);
+  QFETCH(QByteArray, document);
+  QFETCH(int, type);
+  QFETCH(QByteArray, raw);
+
+  QString error;
+  const std::shared_ptr<const JsonPath> compiled = JsonPath::compile(path, &error);
+  QVERIFY2(compiled, qPrintable(error));
+  const JsonValue value = compiled->extract(viewOf(document));
+  QCOMPARE(int(value.type), type);
+  QCOMPARE(QByteArray(value.raw.data(), static_cast<int>(value.raw.size())), raw);
+}
+
+void JsonPathTest::unescape_data() {
+  QTest::addColumn<QByteArray>("raw");
+  QTest::addColumn<int>("maxBytes");
+  QTest::addColumn<bool>("ok");
+  QTest::addColumn<QByteArray>("text");
+
+  QTest::newRow("plain") << QByteArray("abc") << 100 << true << QByteArray("abc");
+  QTest::newRow("short escapes") << QByteArray(R"(\"\\\/\b\f\n\r\t)") << 100 << true
+                                 << QByteArray("\"\\/\b\f\n\r\t");
+  QTest::newRow("two-byte") << QByteArray(R"(\u00e9)") << 100 << true << QByteArray("\xc3\xa9");
+  QTest::newRow("surrogate pair") << QByteArray(R"(\ud83d\ude00)") << 100 << true
+                                  << QByteArray("\xf0\x9f\x98\x80");
+  QTest::newRow("lone surrogate") << QByteArray(R"(\ud83dx)") << 100 << true
+                                  << QByteArray("\xef\xbf\xbdx");
+  QTest::newRow("stops at maxBytes") << QByteArray("abcdef") << 3 << true << QByteArray("abc");
+  QTest::newRow("unknown escape") << QByteArray(R"(a\x)") << 100 << false << QByteArray("a");
+  QTest::newRow("short \\u") << QByteArray(R"(\u12)") << 100 << false << QByteArray();
+  QTest::newRow("trailing backslash") << QByteArray("a\\") << 100 << false << QByteArray("a");
+}
+
+void JsonPathTest::unescape() {
+  QFETCH(QByteArray, raw);
+  QFETCH(int, maxBytes);
+  QFETCH(bool, ok);
+  QFETCH(QByteArray, text);
+
+  std::string out;
+  QCOMPARE(JsonPath::unescape(viewOf(raw), static_cast<std::size_t>(maxBytes), &out), ok);
+  QCOMPARE(QByteArray::fromStdString(out), text);
+}
+
+void JsonPathTest::rejects_data() {
+  QTest::addColumn<QString>("path");
+
+  QTest::newRow("no $") << "a.b";
+  QTest::newRow("recursive descent") << "$..a";
+  QTest::newRow("wildcard") << "$.*";
+  QTest::newRow("empty member") << "$.a.";
+  QTest::newRow("negative index") << "$[-1]";
+  QTest::newRow("unclosed subscript") << "$['a'";
+  QTest::newRow("stray character") << "$a";
+}
+
+void JsonPathTest::rejects() {
+  QFETCH(QString, path);
+  QString error;
+  QVERIFY(!JsonPath::compile(path, &error));
+  QVERIFY(!error.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(JsonPathTest)
+#include "tst_jsonpath.moc"
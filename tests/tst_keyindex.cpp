@@ -0,0 +1,193 @@
+#include <QDir>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/index/KeyIndex.h"
+#include "core/protocol/RecordBatch.h"
+#include "core/source/BatchSource.h"
+
+using namespace kafka;
+
+namespace {
+
+// Two eight-byte keys with the same 64-bit FNV-1a hash.
+const std::string kCollidingA("\x81\x3a\xf6\xc1\xe1\x87\x87\x6b", 8);
+const std::string kCollidingB("\x58\xf1\x0f\xe9\x0f\x9d\x07\x50", 8);
+
+/** One partition of uncompressed batches held in memory. */
+class MemorySource final : public BatchSource {
+public:
+  /** Appends @p keys as one batch; an empty key is a null key. */
+  void append(const std::vector<std::string> &keys) {
+    RecordBatchBuilder builder(m_end);
+    for (const std::string &key : keys) {
+      RecordData record;
+      record.timestamp = m_end;
+      if (!key.empty())
+        record.key = key;
+      record.value = "value";
+      builder.append(record);
+      ++m_end;
+    }
+    m_batches.push_back(builder.build());
+  }
+
+  qint64 end() const { return m_end; }
+
+  QString description() const override { return QStringLiteral("memory"); }
+  QString topic() const override { return QStringLiteral("memory"); }
+  QVector<qint32> partitions() override { return {0}; }
+  QString persistentKey() override { return QStringLiteral("memory"); }
+
+  bool offsetRange(qint32, OffsetRange *range, QString *) override {
+    *range = OffsetRange{0, m_end};
+    return true;
+  }
+
+  // Hands out one batch per read, so every update walks several chunks.
+  bool read(qint32, qint64 offset, qint32, BatchChunk *chunk, QString *) override {
+    for (const std::string &bytes : m_batches) {
+      RecordBatch batch;
+      if (RecordBatch::parse(bytes, batch) == ParseStatus::Ok && batch.nextOffset() > offset) {
+        chunk->bytes = bytes;
+        return true;
+      }
+    }
+    *chunk = BatchChunk();
+    return true;
+  }
+
+  bool offsetForTimestamp(qint32, qint64, qint64 *offset, QString *) override {
+    *offset = m_end;
+    return true;
+  }
+
+private:
+  std::vector<std::string> m_batches;
+  qint64 m_end = 0;
+};
+
+int runFiles(const QString &directory) {
+  return QDir(directory).entryList({QStringLiteral("*.run")}, QDir::Files).size();
+}
+
+} // namespace
+
+class KeyIndexTest : public QObject {
+  Q_OBJECT
+
+private slots:
+  void init();
+
+  void keysCollide();
+  void lookupReturnsCollidingKeys();
+  void mergeKeepsEveryRun();
+  void recreatedTopicStartsOver();
+
+private:
+  bool update(KeyIndex &index);
+
+  QTemporaryDir m_directory;
+  std::unique_ptr<MemorySource> m_source;
+  // Where each key went, in the order it was appended.
+  QVector<qint64> m_a;
+  QVector<qint64> m_b;
+  QVector<qint64> m_other;
+};
+
+void KeyIndexTest::init() {
+  QVERIFY(m_directory.isValid());
+  QString error;
+  QVERIFY2(KeyIndex(m_directory.path()).clear(&error), qPrintable(error));
+  m_source = std::make_unique<MemorySource>();
+  m_a.clear();
+  m_b.clear();
+  m_other.clear();
+}
+
+bool KeyIndexTest::update(KeyIndex &index) {
+  QString error;
+  const bool ok = index.update(*m_source, 0, KeyIndex::Progress(), &error);
+  if (!ok)
+    qWarning("update: %s", qPrintable(error));
+  return ok;
+}
+
+// Guards the constants above: without a real collision the tests below
+// would pass without exercising anything.
+void KeyIndexTest::keysCollide() {
+  QVERIFY(kCollidingA != kCollidingB);
+  QCOMPARE(KeyIndex::hashKey(kCollidingA), KeyIndex::hashKey(kCollidingB));
+  QVERIFY(KeyIndex::hashKey(kCollidingA) != KeyIndex::hashKey("other"));
+}
+
+void KeyIndexTest::lookupReturnsCollidingKeys() {
+  for (int batch = 0; batch < 3; ++batch) {
+    const qint64 base = m_source->end();
+    m_source->append({kCollidingA, "other", std::string(), kCollidingB, kCollidingA});
+    m_a << base << base + 4;
+    m_other << base + 1;
+    m_b << base + 3;
+  }
+  KeyIndex index(m_directory.path());
+  QVERIFY(update(index));
+  QCOMPARE(index.indexedUntil(), m_source->end());
+
+  QVector<qint64> both = m_a + m_b;
+  std::sort(both.begin(), both.end());
+  QString error;
+  // A hash names both keys; telling them apart is the caller's job.
+  QCOMPARE(index.lookup(kCollidingA, &error), both);
+  QCOMPARE(index.lookup(kCollidingB, &error), both);
+  QCOMPARE(index.lookup("other", &error), m_other);
+  QVERIFY(index.lookup("missing", &error).isEmpty());
+  QVERIFY(error.isEmpty());
+}
+
+// Each update indexes only the new batch and writes it as a run; the one
+// past kMaxRuns merges them all.
+void KeyIndexTest::mergeKeepsEveryRun() {
+  KeyIndex index(m_directory.path());
+  for (int round = 0; round <= KeyIndex::kMaxRuns; ++round) {
+    const qint64 base = m_source->end();
+    m_source->append({round % 2 == 0 ? kCollidingA : kCollidingB, "other", kCollidingA});
+    (round % 2 == 0 ? m_a : m_b) << base;
+    m_other << base + 1;
+    m_a << base + 2;
+    QVERIFY(update(index));
+    QCOMPARE(runFiles(m_directory.path()), round < KeyIndex::kMaxRuns ? round + 1 : 1);
+  }
+  QCOMPARE(index.indexedUntil(), m_source->end());
+
+  QVector<qint64> both = m_a + m_b;
+  std::sort(both.begin(), both.end());
+  QString error;
+  QCOMPARE(index.lookup(kCollidingB, &error), both);
+  QCOMPARE(index.lookup("other", &error), m_other);
+
+  // Nothing new: no empty run is written.
+  QVERIFY(update(index));
+  QCOMPARE(runFiles(m_directory.path()), 1);
+  QCOMPARE(index.lookup(kCollidingA, &error), both);
+}
+
+void KeyIndexTest::recreatedTopicStartsOver() {
+  m_source->append({kCollidingA, kCollidingA, kCollidingA, kCollidingA});
+  KeyIndex index(m_directory.path());
+  QVERIFY(update(index));
+
+  m_source = std::make_unique<MemorySource>();
+  m_source->append({"other", kCollidingB});
+  QVERIFY(update(index));
+  QCOMPARE(index.indexedUntil(), qint64(2));
+  QString error;
+  QCOMPARE(index.lookup(kCollidingA, &error), QVector<qint64>{1});
+}
+
+QTEST_APPLESS_MAIN(KeyIndexTest)
+#include "tst_keyindex.moc"
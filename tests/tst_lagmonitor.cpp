@@ -0,0 +1,175 @@
+#include <QtTest>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/groups/LagMonitor.h"
+#include "core/network/KafkaClient.h"
+#include "core/network/KafkaSession.h"
+#include "mock/MockBroker.h"
+#include "mock/MockCluster.h"
+
+using namespace kafka;
+
+namespace {
+
+constexpr int kEndOffset = 10;
+
+QString topicOf(int broker) { return QStringLiteral("topic-%1").arg(broker); }
+QString groupOf(int broker, int group) {
+  return QStringLiteral("group-%1-%2").arg(broker).arg(group);
+}
+
+// Every broker leads one topic and coordinates @p groupsPerBroker groups,
+// each of which committed on partition 0 of every topic.
+void populate(MockCluster &cluster, int groupsPerBroker) {
+  const std::string value = "v";
+  for (int b = 0; b < cluster.size(); ++b) {
+    cluster.run(
+        [&](MockBroker &broker) {
+          broker.createTopic(topicOf(b), 2);
+          std::vector<RecordData> records(kEndOffset, RecordData{0, {}, value, {}});
+          broker.append(topicOf(b), 0, records);
+          for (int g = 0; g < groupsPerBroker; ++g) {
+            for (int t = 0; t < cluster.size(); ++t)
+              broker.commitOffset(groupOf(b, g), topicOf(t), 0, g % kEndOffset);
+          }
+        },
+        b);
+  }
+}
+
+// Requests with @p key that broker @p index has received.
+int requestsTo(MockCluster &cluster, int index, ApiKey key) {
+  int count = 0;
+  cluster.run([&](MockBroker &broker) { count = broker.requestCount(key); }, index);
+  return count;
+}
+
+// Refreshes @p monitor and waits for its delta.
+bool refreshed(LagMonitor &monitor, LagDelta *delta) {
+  bool done = false;
+  QString error;
+  const auto updated = QObject::connect(&monitor, &LagMonitor::updated,
+                                        [&](const LagDelta &received) {
+                                          *delta = received;
+                                          done = true;
+                                        });
+  const auto failed = QObject::connect(&monitor, &LagMonitor::failed, [&](const QString &e) {
+    error = e;
+    done = true;
+  });
+  monitor.refresh();
+  const bool answered = QTest::qWaitFor([&]() { return done; }, 20000);
+  QObject::disconnect(updated);
+  QObject::disconnect(failed);
+  return answered && error.isEmpty();
+}
+
+} // namespace
+
+class LagMonitorTest : public QObject {
+  Q_OBJECT
+
+private slots:
+  void requestsScaleWithBrokers_data();
+  void requestsScaleWithBrokers();
+  void secondRefreshReportsOnlyTheDifference();
+};
+
+void LagMonitorTest::requestsScaleWithBrokers_data() {
+  QTest::addColumn<int>("brokers");
+  QTest::addColumn<int>("groupsPerBroker");
+
+  QTest::newRow("1 broker, 2 groups") << 1 << 2;
+  QTest::newRow("1 broker, 200 groups") << 1 << 200;
+  QTest::newRow("3 brokers, 2 groups") << 3 << 2;
+  QTest::newRow("3 brokers, 200 groups") << 3 << 200;
+}
+
+// Per broker: one ListGroups, one OffsetFetch for up to
+// KafkaClient::kGroupsPerOffsetFetch groups and one ListOffsets as leader.
+void LagMonitorTest::requestsScaleWithBrokers() {
+  QFETCH(int, brokers);
+  QFETCH(int, groupsPerBroker);
+
+  MockCluster cluster(brokers);
+  QCOMPARE(cluster.size(), brokers);
+  populate(cluster, groupsPerBroker);
+  KafkaSession session;
+  session.client()->setBootstrapServers(cluster.bootstrapServers());
+  LagMonitor monitor(session.client());
+
+  LagDelta delta;
+  QVERIFY(refreshed(monitor, &delta));
+  QVERIFY2(delta.errors.isEmpty(), qPrintable(delta.errors.join(QLatin1Char('\n'))));
+  QCOMPARE(delta.groupCount, brokers * groupsPerBroker);
+  QCOMPARE(delta.rowCount, brokers * groupsPerBroker * brokers);
+  QCOMPARE(delta.changed.size(), delta.rowCount);
+
+  // What the brokers saw, not what the client thinks it sent.
+  const int offsetFetches =
+      (groupsPerBroker + KafkaClient::kGroupsPerOffsetFetch - 1) /
+      KafkaClient::kGroupsPerOffsetFetch;
+  int received = 0;
+  for (int b = 0; b < brokers; ++b) {
+    const int listGroups = requestsTo(cluster, b, ApiKey::ListGroups);
+    const int offsetFetch = requestsTo(cluster, b, ApiKey::OffsetFetch);
+    const int listOffsets = requestsTo(cluster, b, ApiKey::ListOffsets);
+    QCOMPARE(listGroups, 1);
+    QCOMPARE(offsetFetch, offsetFetches);
+    QCOMPARE(listOffsets, 1);
+    received += listGroups + offsetFetch + listOffsets;
+  }
+  QCOMPARE(delta.requestCount, received);
+
+  for (const LagRow &row : std::as_const(delta.changed)) {
+    QCOMPARE(row.errorCode, qint16(0));
+    QCOMPARE(row.endOffset, qint64(kEndOffset));
+    QCOMPARE(row.coordinator, row.group.section(QLatin1Char('-'), 1, 1).toInt());
+  }
+}
+
+void LagMonitorTest::secondRefreshReportsOnlyTheDifference() {
+  constexpr int kBrokers = 3;
+  constexpr int kGroupsPerBroker = 20;
+  MockCluster cluster(kBrokers);
+  QCOMPARE(cluster.size(), kBrokers);
+  populate(cluster, kGroupsPerBroker);
+  KafkaSession session;
+  session.client()->setBootstrapServers(cluster.bootstrapServers());
+  LagMonitor monitor(session.client());
+
+  LagDelta delta;
+  QVERIFY(refreshed(monitor, &delta));
+  const int rowCount = delta.rowCount;
+  QCOMPARE(delta.changed.size(), rowCount);
+
+  // One group moves on one partition; another, on a different
+  // coordinator, disappears with all its rows.
+  cluster.run(
+      [&](MockBroker &broker) {
+        broker.commitOffset(groupOf(1, 3), topicOf(2), 0, kEndOffset);
+      },
+      1);
+  cluster.run([&](MockBroker &broker) { broker.deleteGroup(groupOf(2, 5)); }, 2);
+
+  QVERIFY(refreshed(monitor, &delta));
+  QCOMPARE(delta.rowCount, rowCount - kBrokers);
+  QCOMPARE(delta.changed.size(), 1);
+  QCOMPARE(delta.changed.first().group, groupOf(1, 3));
+  QCOMPARE(delta.changed.first().tp, (TopicPartition{topicOf(2), 0}));
+  QCOMPARE(delta.changed.first().lag(), qint64(0));
+  QCOMPARE(delta.removed.size(), kBrokers);
+  for (const LagKey &key : std::as_const(delta.removed))
+    QCOMPARE(key.group, groupOf(2, 5));
+
+  QVERIFY(refreshed(monitor, &delta));
+  QVERIFY(delta.changed.isEmpty());
+  QVERIFY(delta.removed.isEmpty());
+  QCOMPARE(delta.rowCount, rowCount - kBrokers);
+}
+
+QTEST_GUILESS_MAIN(LagMonitorTest)
+#include "tst_lagmonitor.moc"
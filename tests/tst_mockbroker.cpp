@@ -0,0 +1,245 @@
+#include <QtTest>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/network/KafkaClient.h"
+#include "core/network/KafkaSession.h"
+#include "core/protocol/RecordBatch.h"
+#include "core/source/KafkaBatchSource.h"
+#include "mock/MockBroker.h"
+#include "mock/MockCluster.h"
+
+using namespace kafka;
+
+namespace {
+
+// Values of every record in @p partition, in offset order.
+std::vector<std::string> valuesOf(const FetchedPartition &partition) {
+  std::vector<std::string> values;
+  BatchReader batches(partition.records());
+  RecordBatch batch;
+  while (batches.next(batch) == ParseStatus::Ok) {
+    RecordReader records(batch, batch.recordsSection());
+    Record record;
+    while (records.next(record)) {
+      if (record.offset >= partition.fetchOffset)
+        values.emplace_back(record.value);
+    }
+  }
+  return values;
+}
+
+} // namespace
+
+class MockBrokerTest : public QObject {
+  Q_OBJECT
+
+private slots:
+  void init();
+  void cleanup();
+
+  void metadataListsTopicsAndLeader();
+  void metadataCarriesTopicIds();
+  void negotiatesOffsetFetchVersion();
+  void pipelinesFetchOverOneConnection();
+  void listsOffsetsByTimestamp();
+
+private:
+  std::unique_ptr<MockCluster> m_cluster;
+  std::unique_ptr<KafkaSession> m_session;
+};
+
+void MockBrokerTest::init() {
+  m_cluster = std::make_unique<MockCluster>();
+  QVERIFY(!m_cluster->bootstrapServers().isEmpty());
+  m_session = std::make_unique<KafkaSession>();
+  m_session->client()->setBootstrapServers(m_cluster->bootstrapServers());
+}
+
+void MockBrokerTest::cleanup() {
+  m_session.reset();
+  m_cluster.reset();
+}
+
+void MockBrokerTest::metadataListsTopicsAndLeader() {
+  quint16 port = 0;
+  m_cluster->run([&](MockBroker &broker) {
+    broker.createTopic(QStringLiteral("orders"), 3);
+    broker.createTopic(QStringLiteral("audit"), 1);
+    port = broker.port();
+  });
+
+  ClusterMetadata metadata;
+  QString error;
+  QVERIFY2(m_session->client()->metadataBlocking(&metadata, &error), qPrintable(error));
+  QCOMPARE(metadata.brokers.size(), 1);
+  QCOMPARE(metadata.brokers.first().nodeId, 0);
+  QCOMPARE(metadata.brokers.first().port, port);
+  QCOMPARE(metadata.controllerId, 0);
+
+  const TopicInfo *orders = metadata.topic(QStringLiteral("orders"));
+  QVERIFY(orders);
+  QCOMPARE(orders->partitions.size(), 3);
+  QVERIFY(metadata.topic(QStringLiteral("audit")));
+  QVERIFY(!metadata.topic(QStringLiteral("missing")));
+  for (int i = 0; i < 3; ++i)
+    QCOMPARE(metadata.leaderFor(TopicPartition{QStringLiteral("orders"), i}), 0);
+}
+
+// Metadata v10 names a topic by id as well, so one created again under the
+// same name no longer shares the batch cache key; before v10 there is no id.
+void MockBrokerTest::metadataCarriesTopicIds() {
+  const QString topic = QStringLiteral("orders");
+  auto topicId = [&]() {
+    // Reconnect so the metadata is asked for again.
+    m_session->client()->setBootstrapServers(m_cluster->bootstrapServers());
+    ClusterMetadata metadata;
+    QString error;
+    if (!m_session->client()->metadataBlocking(&metadata, &error) || !metadata.topic(topic))
+      return QUuid();
+    return metadata.topic(topic)->topicId;
+  };
+  auto persistentKey = [&]() {
+    return KafkaBatchSource(m_session->client(), topic).persistentKey();
+  };
+
+  m_cluster->run([&](MockBroker &broker) { broker.createTopic(topic, 2); });
+  const QUuid first = topicId();
+  QVERIFY(!first.isNull());
+  const QString key = persistentKey();
+  QVERIFY2(key.endsWith(first.toString(QUuid::WithoutBraces)), qPrintable(key));
+
+  m_cluster->run([&](MockBroker &broker) {
+    broker.deleteTopic(topic);
+    broker.createTopic(topic, 2);
+  });
+  const QUuid second = topicId();
+  QVERIFY(!second.isNull());
+  QVERIFY(second != first);
+  QVERIFY(persistentKey() != key);
+
+  m_cluster->run([&](MockBroker &broker) { broker.setMaxVersion(ApiKey::Metadata, 9); });
+  QVERIFY(topicId().isNull());
+  QCOMPARE(persistentKey(), key.left(key.lastIndexOf(QLatin1Char('/'))));
+}
+
+// OffsetFetch v8 carries many groups per request; a broker that only
+// advertises v7 gets one request per group.
+void MockBrokerTest::negotiatesOffsetFetchVersion() {
+  constexpr int kGroups = 6;
+  m_cluster->run([&](MockBroker &broker) {
+    broker.createTopic(QStringLiteral("orders"), 2);
+    for (int i = 0; i < kGroups; ++i)
+      broker.commitOffset(QStringLiteral("group-%1").arg(i), QStringLiteral("orders"), i % 2, i);
+  });
+
+  GroupOffsetsSnapshot snapshot;
+  QString error;
+  QVERIFY2(m_session->client()->groupOffsetsBlocking(&snapshot, &error), qPrintable(error));
+  QCOMPARE(snapshot.groups.size(), kGroups);
+  QCOMPARE(snapshot.requestCount, 2);
+  int apiVersions = 0;
+  m_cluster->run([&](MockBroker &broker) {
+    apiVersions = broker.requestCount(ApiKey::ApiVersions);
+    broker.setMaxVersion(ApiKey::OffsetFetch, 7);
+  });
+  QVERIFY(apiVersions >= 1);
+
+  // Reconnect so the capped versions are negotiated.
+  m_session->client()->setBootstrapServers(m_cluster->bootstrapServers());
+  snapshot = GroupOffsetsSnapshot();
+  QVERIFY2(m_session->client()->groupOffsetsBlocking(&snapshot, &error), qPrintable(error));
+  QCOMPARE(snapshot.groups.size(), kGroups);
+  QCOMPARE(snapshot.requestCount, 1 + kGroups);
+  for (const GroupOffsets &group : std::as_const(snapshot.groups)) {
+    QCOMPARE(group.errorCode, qint16(0));
+    QCOMPARE(group.offsets.size(), 1);
+    QCOMPARE(group.offsets.first().offset, group.groupId.mid(6).toLongLong());
+  }
+  int apiVersionsAfter = 0;
+  m_cluster->run(
+      [&](MockBroker &broker) { apiVersionsAfter = broker.requestCount(ApiKey::ApiVersions); });
+  QVERIFY(apiVersionsAfter > apiVersions);
+}
+
+void MockBrokerTest::pipelinesFetchOverOneConnection() {
+  constexpr int kPartitions = 8;
+  constexpr int kMaxInFlight = 4;
+  const std::string value(64, 'v');
+  m_cluster->run([&](MockBroker &broker) {
+    broker.createTopic(QStringLiteral("events"), kPartitions);
+    for (int partition = 0; partition < kPartitions; ++partition) {
+      for (int batch = 0; batch <= partition; ++batch)
+        broker.append(QStringLiteral("events"), partition, {RecordData{batch, {}, value, {}}});
+    }
+  });
+
+  KafkaClient *client = m_session->client();
+  client->setMaxInFlightPerBroker(kMaxInFlight);
+  client->setFetchMaxWaitMs(0);
+  ClusterMetadata metadata;
+  QString error;
+  QVERIFY2(client->metadataBlocking(&metadata, &error), qPrintable(error));
+
+  int fetchesBefore = 0;
+  m_cluster->run([&](MockBroker &broker) { fetchesBefore = broker.requestCount(ApiKey::Fetch); });
+
+  QVector<FetchTarget> targets;
+  for (int partition = 0; partition < kPartitions; ++partition)
+    targets.append(FetchTarget{TopicPartition{QStringLiteral("events"), partition}, 0});
+  QVector<FetchedPartition> fetched;
+  QVERIFY2(client->fetchBlocking(targets, &fetched, &error), qPrintable(error));
+
+  int fetchesAfter = 0;
+  m_cluster->run([&](MockBroker &broker) { fetchesAfter = broker.requestCount(ApiKey::Fetch); });
+  QCOMPARE(fetchesAfter - fetchesBefore, kMaxInFlight);
+  QCOMPARE(fetched.size(), kPartitions);
+  QSet<int> seen;
+  for (const FetchedPartition &partition : std::as_const(fetched)) {
+    QCOMPARE(partition.errorCode, qint16(0));
+    QCOMPARE(partition.highWatermark, qint64(partition.tp.partition + 1));
+    QCOMPARE(valuesOf(partition).size(), std::size_t(partition.tp.partition + 1));
+    seen.insert(partition.tp.partition);
+  }
+  QCOMPARE(seen.size(), kPartitions);
+}
+
+void MockBrokerTest::listsOffsetsByTimestamp() {
+  m_cluster->run([&](MockBroker &broker) {
+    broker.createTopic(QStringLiteral("clicks"), 1);
+    broker.append(QStringLiteral("clicks"), 0,
+                  {RecordData{1000, {}, "a", {}}, RecordData{2000, {}, "b", {}}});
+    broker.append(QStringLiteral("clicks"), 0, {RecordData{3000, {}, "c", {}}});
+  });
+
+  KafkaClient *client = m_session->client();
+  const QVector<TopicPartition> partitions = {TopicPartition{QStringLiteral("clicks"), 0},
+                                              TopicPartition{QStringLiteral("clicks"), 7}};
+  auto offsetAt = [&](qint64 timestamp, qint16 *errorCode) {
+    QVector<PartitionOffset> offsets;
+    QString error;
+    if (!client->listOffsetsBlocking(partitions, timestamp, &offsets, &error))
+      return qint64(-100);
+    qint64 offset = -100;
+    for (const PartitionOffset &result : std::as_const(offsets)) {
+      if (result.tp.partition == 0)
+        offset = result.offset;
+      else
+        *errorCode = result.errorCode;
+    }
+    return offset;
+  };
+
+  qint16 missing = 0;
+  QCOMPARE(offsetAt(kEarliestTimestamp, &missing), qint64(0));
+  QVERIFY(missing != 0);
+  QCOMPARE(offsetAt(kLatestTimestamp, &missing), qint64(3));
+  QCOMPARE(offsetAt(1500, &missing), qint64(1));
+  QCOMPARE(offsetAt(3000, &missing), qint64(2));
+  QCOMPARE(offsetAt(9000, &missing), qint64(-1));
+}
+
+QTEST_GUILESS_MAIN(MockBrokerTest)
+#include "tst_mockbroker.moc"
@@ -0,0 +1,175 @@
+#include <QtTest>
+
+#include <memory>
+#include <string>
+
+#include "core/filter/RecordFilter.h"
+#include "core/protocol/RecordBatch.h"
+#include "core/protocol/Wire.h"
+
+using namespace kafka;
+
+namespace {
+
+constexpr qint32 kPartition = 3;
+constexpr qint64 kNow = 1700000000000;
+
+// One record every row is evaluated against; the strings back its views.
+struct Sample {
+  Sample() {
+    WireWriter writer;
+    writer.writeVarint(6);
+    writer.writeRaw("tenant");
+    writer.writeVarint(4);
+    writer.writeRaw("acme");
+    headers = writer.take();
+
+    record.offset = 7;
+    record.timestamp = kNow - 1000;
+    record.key = key;
+    record.value = value;
+    record.headers = headers;
+    record.headerCount = 1;
+    record.encoded = value;
+  }
+
+  std::string key = "k1";
+  std::string value = R"({"amount": 1500, "note": "a\nb", "tags": ["x"]})";
+  std::string headers;
+  Record record;
+};
+
+bool matches(const QString &expression) {
+  QString error;
+  const std::shared_ptr<const RecordFilter> filter =
+      RecordFilter::compile(expression, kNow, &error);
+  if (!filter) {
+    qWarning("%s: %s", qPrintable(expression), qPrintable(error));
+    return false;
+  }
+  static const Sample sample;
+  RecordFilter::Evaluator evaluator(filter);
+  return evaluator.matches(kPartition, sample.record);
+}
+
+qint64 timestampBound(const QString &expression) {
+  QString error;
+  const std::shared_ptr<const RecordFilter> filter =
+      RecordFilter::compile(expression, kNow, &error);
+  return filter ? filter->minTimestamp() : -1;
+}
+
+} // namespace
+
+class RecordFilterTest : public QObject {
+  Q_OBJECT
+
+private slots:
+  void precedence_data();
+  void precedence();
+  void shortCircuit_data();
+  void shortCircuit();
+  void stringEscapes_data();
+  void stringEscapes();
+  void minTimestamp_data();
+  void minTimestamp();
+};
+
+void RecordFilterTest::precedence_data() {
+  QTest::addColumn<QString>("expression");
+  QTest::addColumn<bool>("expected");
+
+  // The record: offset 7, partition 3, key "k1", ts one second ago.
+  QTest::newRow("&& binds tighter than ||") << "offset == 7 || offset == 1 && partition == 0"
+                                            << true;
+  QTest::newRow("parentheses first") << "(offset == 7 || offset == 1) && partition == 0"
+                                     << false;
+  QTest::newRow("! over a comparison") << "! offset == 1" << true;
+  QTest::newRow("! over &&, parenthesised") << "!(offset == 7 && partition == 3)" << false;
+  QTest::newRow("+ before ==") << "offset + 1 == 8" << true;
+  QTest::newRow("- is left associative") << "10 - 2 - 1 == offset" << true;
+  QTest::newRow("keywords") << "offset == 1 or not partition == 1 and key == \"k1\"" << true;
+  QTest::newRow("now and durations") << "ts > now - 5s && ts < now" << true;
+  QTest::newRow("header and JSON") << "header[\"tenant\"] == 'acme' && $.amount > 1000"
+                                   << true;
+  QTest::newRow("missing field, !=") << "header[\"region\"] != 'eu'" << false;
+}
+
+void RecordFilterTest::precedence() {
+  QFETCH(QString, expression);
+  QFETCH(bool, expected);
+  QCOMPARE(matches(expression), expected);
+}
+
+// Each || and && leaves the deciding operand on the stack and jumps past
+// the rest; a bad jump target shows up as a wrong result further along.
+void RecordFilterTest::shortCircuit_data() {
+  QTest::addColumn<QString>("expression");
+  QTest::addColumn<bool>("expected");
+
+  QTest::newRow("first of three ||") << "offset == 7 || offset == 1 || offset == 2" << true;
+  QTest::newRow("last of three ||") << "offset == 1 || offset == 2 || offset == 7" << true;
+  QTest::newRow("none of three ||") << "offset == 1 || offset == 2 || offset == 3" << false;
+  QTest::newRow("first of three && fails") << "offset == 1 && offset == 7 && partition == 3"
+                                           << false;
+  QTest::newRow("last of three && fails") << "offset == 7 && partition == 3 && key == 'x'"
+                                          << false;
+  QTest::newRow("all of three &&") << "offset == 7 && partition == 3 && key == 'k1'" << true;
+  QTest::newRow("|| decided, then &&") << "(offset == 7 || $.missing > 1) && partition == 3"
+                                       << true;
+  QTest::newRow("&& decided, then ||") << "(offset == 1 && $.amount > 1) || partition == 3"
+                                       << true;
+  QTest::newRow("decided left, ! after") << "!(offset == 7 || partition == 1) || key == 'x'"
+                                         << false;
+}
+
+void RecordFilterTest::shortCircuit() {
+  QFETCH(QString, expression);
+  QFETCH(bool, expected);
+  QCOMPARE(matches(expression), expected);
+}
+
+void RecordFilterTest::stringEscapes_data() {
+  QTest::addColumn<QString>("expression");
+  QTest::addColumn<bool>("expected");
+
+  QTest::newRow("\\n is a newline") << R"($.note == "a\nb")" << true;
+  QTest::newRow("\\n is not n") << R"($.note == "anb")" << false;
+  QTest::newRow("escaped quote") << R"(key != "k\"1" && key == 'k\1')" << true;
+  QTest::newRow("tab") << R"("a\tb" contains "\t" && !("atb" contains "\t"))" << true;
+  QTest::newRow("escaped backslash") << R"("\\n" contains "n" && !("\n" contains "n"))"
+                                     << true;
+}
+
+void RecordFilterTest::stringEscapes() {
+  QFETCH(QString, expression);
+  QFETCH(bool, expected);
+  QCOMPARE(matches(expression), expected);
+}
+
+void RecordFilterTest::minTimestamp_data() {
+  QTest::addColumn<QString>("expression");
+  QTest::addColumn<qint64>("expected");
+
+  QTest::newRow("ts >") << "ts > 1000" << qint64(1000);
+  QTest::newRow("tightest conjunct") << "ts >= 1000 && offset > 5 && ts > 2000" << qint64(2000);
+  QTest::newRow("reversed") << "3000 <= ts" << qint64(3000);
+  QTest::newRow("now") << "ts > now - 1s" << kNow - 1000;
+  QTest::newRow("top-level || drops it") << "ts > 1000 || offset == 1"
+                                         << RecordFilter::kNoTimestampBound;
+  QTest::newRow("|| after && drops it") << "ts > 1000 && key == 'a' || offset == 1"
+                                        << RecordFilter::kNoTimestampBound;
+  QTest::newRow("|| in parentheses keeps it") << "ts > 1000 && (offset == 1 || offset == 2)"
+                                              << qint64(1000);
+  QTest::newRow("under !") << "!(ts < 1000)" << RecordFilter::kNoTimestampBound;
+  QTest::newRow("upper bound only") << "ts < 1000" << RecordFilter::kNoTimestampBound;
+}
+
+void RecordFilterTest::minTimestamp() {
+  QFETCH(QString, expression);
+  QFETCH(qint64, expected);
+  QCOMPARE(timestampBound(expression), expected);
+}
+
+QTEST_APPLESS_MAIN(RecordFilterTest)
+#include "tst_recordfilter.moc"
@@ -0,0 +1,174 @@
+#include <QtTest>
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "core/schema/AvroDecoder.h"
+#include "core/schema/ProtobufDecoder.h"
+
+using namespace kafka;
+
+namespace {
+
+const char kOrderSchema[] = R"({
+  "type": "record", "name": "Order", "namespace": "shop",
+  "fields": [
+    {"name": "id", "type": "long"},
+    {"name": "name", "type": "string"},
+    {"name": "tags", "type": {"type": "array", "items": "string"}},
+    {"name": "note", "type": ["null", "string"]},
+    {"name": "status",
+     "type": {"type": "enum", "name": "Status", "symbols": ["NEW", "SHIPPED"]}},
+    {"name": "counts", "type": {"type": "map", "values": "int"}}
+  ]
+})";
+
+const char kOrderProto[] = R"(
+syntax = "proto3";
+package shop;
+
+message Order {
+  int64 id = 1;
+  string name = 2;
+  repeated int32 values = 3;
+  Status status = 4;
+  map<string, int32> counts = 5;
+  Item item = 6;
+
+  message Item {
+    sint32 delta = 1;
+  }
+}
+
+enum Status {
+  UNKNOWN = 0;
+  SHIPPED = 1;
+}
+)";
+
+std::string_view viewOf(const QByteArray &bytes) {
+  return std::string_view(bytes.constData(), static_cast<std::size_t>(bytes.size()));
+}
+
+} // namespace
+
+/**
+ * Payloads are written out byte by byte in hex, as the encoding rules
+ * give them, so a decoder is checked against the format rather than
+ * against an encoder sharing its mistakes.
+ */
+class SchemaDecoderTest : public QObject {
+  Q_OBJECT
+
+private slots:
+  void avro_data();
+  void avro();
+  void protobuf_data();
+  void protobuf();
+};
+
+void SchemaDecoderTest::avro_data() {
+  QTest::addColumn<QByteArray>("schema");
+  QTest::addColumn<QByteArray>("payload");
+  QTest::addColumn<bool>("ok");
+  QTest::addColumn<QByteArray>("json");
+
+  // id 1, "ab", one block of one tag, the string branch, SHIPPED, {"k": -3}.
+  QTest::newRow("record")
+      << QByteArray(kOrderSchema)
+      << QByteArray::fromHex("02 04 6162 02 02 78 00 02 02 6e 02 02 02 6b 05 00") << true
+      << QByteArray(R"({"id":1,"name":"ab","tags":["x"],"note":"n",)"
+                    R"("status":"SHIPPED","counts":{"k":-3}})");
+  QTest::newRow("null branch, empty array and map")
+      << QByteArray(kOrderSchema) << QByteArray::fromHex("01 00 00 00 00 00")
+      << true
+      << QByteArray(R"({"id":-1,"name":"","tags":[],"note":null,"status":"NEW","counts":{}})");
+  // A negative count is followed by the block's size in bytes.
+  QTest::newRow("sized blocks") << QByteArray(R"({"type":"array","items":"int"})")
+                                << QByteArray::fromHex("03 04 02 04 01 02 05 00") << true
+                                << QByteArray("[1,2,-3]");
+  QTest::newRow("bare primitive") << QByteArray(R"("double")")
+                                  << QByteArray::fromHex("000000000000f83f") << true
+                                  << QByteArray("1.5");
+  // Zigzag of INT64_MIN: negating it would overflow.
+  QTest::newRow("INT64_MIN block count")
+      << QByteArray(R"({"type":"array","items":"int"})")
+      << QByteArray::fromHex("ffffffffffffffffff01 00 00") << false << QByteArray();
+  QTest::newRow("count beyond the payload")
+      << QByteArray(R"({"type":"array","items":"int"})") << QByteArray::fromHex("7e 02")
+      << false << QByteArray();
+  QTest::newRow("truncated string") << QByteArray(R"("string")") << QByteArray::fromHex("0a 61")
+                                    << false << QByteArray();
+  QTest::newRow("union branch out of range")
+      << QByteArray(R"(["null","int"])") << QByteArray::fromHex("04") << false << QByteArray();
+}
+
+void SchemaDecoderTest::avro() {
+  QFETCH(QByteArray, schema);
+  QFETCH(QByteArray, payload);
+  QFETCH(bool, ok);
+  QFETCH(QByteArray, json);
+
+  QString error;
+  const std::shared_ptr<const AvroDecoder> decoder = AvroDecoder::compile(schema, &error);
+  QVERIFY2(decoder, qPrintable(error));
+  std::string out;
+  QCOMPARE(decoder->decode(viewOf(payload), &out, &error), ok);
+  if (ok)
+    QCOMPARE(QByteArray::fromStdString(out), json);
+  else
+    QVERIFY(!error.isEmpty());
+}
+
+void SchemaDecoderTest::protobuf_data() {
+  QTest::addColumn<QByteArray>("payload");
+  QTest::addColumn<bool>("ok");
+  QTest::addColumn<QByteArray>("json");
+
+  // Each payload starts with the message index list; a lone 0 is [0].
+  QTest::newRow("every kind of field")
+      << QByteArray::fromHex("00 08 9601 12 02 6162 1a 03 010203 20 01"
+                             " 2a 05 0a016b 1007 32 02 0803")
+      << true
+      << QByteArray(R"({"id":150,"name":"ab","values":[1,2,3],"status":"SHIPPED",)"
+                    R"("counts":{"k":7},"item":{"delta":-2}})");
+  QTest::newRow("packed and unpacked runs mixed")
+      << QByteArray::fromHex("00 1a 02 0102 18 03 1a 01 04") << true
+      << QByteArray(R"({"values":[1,2,3,4]})");
+  QTest::newRow("empty packed runs")
+      << QByteArray::fromHex("00 1a 00 1a 02 0506 1a 00 18 07 1a 00") << true
+      << QByteArray(R"({"values":[5,6,7]})");
+  QTest::newRow("only an empty packed run")
+      << QByteArray::fromHex("00 1a 00") << true << QByteArray(R"({"values":[]})");
+  QTest::newRow("unknown enum value") << QByteArray::fromHex("00 20 05") << true
+                                      << QByteArray(R"({"status":5})");
+  QTest::newRow("nested message by index path")
+      << QByteArray::fromHex("04 00 00 08 04") << true << QByteArray(R"({"delta":2})");
+  QTest::newRow("last singular occurrence wins")
+      << QByteArray::fromHex("00 08 01 08 02") << true << QByteArray(R"({"id":2})");
+  QTest::newRow("truncated packed run") << QByteArray::fromHex("00 1a 01 81") << false
+                                        << QByteArray();
+  QTest::newRow("wrong wire type") << QByteArray::fromHex("00 15 00000000") << false
+                                   << QByteArray();
+}
+
+void SchemaDecoderTest::protobuf() {
+  QFETCH(QByteArray, payload);
+  QFETCH(bool, ok);
+  QFETCH(QByteArray, json);
+
+  QString error;
+  const std::shared_ptr<const ProtobufDecoder> decoder =
+      ProtobufDecoder::compile(QString::fromLatin1(kOrderProto), &error);
+  QVERIFY2(decoder, qPrintable(error));
+  std::string out;
+  QCOMPARE(decoder->decode(viewOf(payload), &out, &error), ok);
+  if (ok)
+    QCOMPARE(QByteArray::fromStdString(out), json);
+  else
+    QVERIFY(!error.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(SchemaDecoderTest)
+#include "tst_schemadecoder.moc"
@@ -0,0 +1,84 @@
+#include <QtTest>
+
+#include <limits>
+
+#include "core/stats/Sketches.h"
+
+using namespace kafka;
+
+namespace {
+
+constexpr qint64 kMaxTimestamp = std::numeric_limits<qint64>::max();
+
+quint64 total(const TimeSeries &series) {
+  quint64 sum = 0;
+  for (int i = 0; i < series.bucketCount(); ++i)
+    sum += series.count(i);
+  return sum;
+}
+
+} // namespace
+
+class TimeSeriesTest : public QObject {
+  Q_OBJECT
+
+private slots:
+  void keepsRecentTimestampsFine();
+  void extremeTimestamps_data();
+  void extremeTimestamps();
+  void mergesExtremeSeries();
+};
+
+void TimeSeriesTest::keepsRecentTimestampsFine() {
+  constexpr qint64 kStart = 1700000000000;
+  TimeSeries series;
+  for (qint64 second = 0; second < TimeSeries::kBuckets; ++second)
+    series.add(kStart + second * 1000 + 500);
+  QCOMPARE(series.width(), TimeSeries::kBaseWidthMs);
+  QCOMPARE(series.origin(), kStart);
+  QCOMPARE(series.bucketCount(), TimeSeries::kBuckets);
+  QCOMPARE(total(series), quint64(TimeSeries::kBuckets));
+}
+
+void TimeSeriesTest::extremeTimestamps_data() {
+  QTest::addColumn<QVector<qint64>>("timestamps");
+
+  QTest::newRow("max, then 0") << QVector<qint64>{kMaxTimestamp, 0, 5};
+  QTest::newRow("0, then max") << QVector<qint64>{0, kMaxTimestamp, kMaxTimestamp - 1};
+  QTest::newRow("now, then max") << QVector<qint64>{1700000000000, kMaxTimestamp, 1};
+  QTest::newRow("max twice") << QVector<qint64>{kMaxTimestamp, kMaxTimestamp - 999};
+}
+
+// Used to overflow computing the span, then double the width to 0.
+void TimeSeriesTest::extremeTimestamps() {
+  QFETCH(QVector<qint64>, timestamps);
+
+  TimeSeries series;
+  for (qint64 timestamp : std::as_const(timestamps))
+    series.add(timestamp);
+  series.add(-1);
+  series.add(std::numeric_limits<qint64>::min());
+
+  QCOMPARE(total(series), quint64(timestamps.size()));
+  QVERIFY(series.width() <= TimeSeries::kMaxWidthMs);
+  QVERIFY(series.origin() >= 0);
+  QVERIFY(series.bucketCount() <= TimeSeries::kBuckets);
+}
+
+void TimeSeriesTest::mergesExtremeSeries() {
+  TimeSeries low;
+  low.add(0);
+  low.add(1000);
+  TimeSeries high;
+  high.add(kMaxTimestamp);
+  high.add(0);
+
+  low.merge(high);
+  QCOMPARE(low.width(), TimeSeries::kMaxWidthMs);
+  QCOMPARE(total(low), quint64(4));
+  high.merge(low);
+  QCOMPARE(total(high), quint64(6));
+}
+
+QTEST_APPLESS_MAIN(TimeSeriesTest)
+#include "tst_timeseries.moc"